@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""
+Hemlock Benchmark Runner
+
+Runs every benchmarks/*.hml program under one or more backends, reports the
+median wall-clock time and peak RSS, and compares the results against a
+checked-in baseline (benchmarks/baseline.json).
+
+Backends:
+    interp    ./hemlock file.hml
+    compiled  ./hemlockc -O2 file.hml -o bin && ./bin
+    hmlc      ./hemlock --bundle file.hml -o file.hmlc && ./hemlock file.hmlc
+
+Every benchmark prints a deterministic checksum; the runner verifies that all
+backends produce the same output so a fast-but-wrong backend is caught.
+
+Usage:
+    python3 benchmarks/run_benchmarks.py                    # interp + compiled
+    python3 benchmarks/run_benchmarks.py --backends interp,compiled,hmlc
+    python3 benchmarks/run_benchmarks.py --filter fib --runs 10
+    python3 benchmarks/run_benchmarks.py --update-baseline  # rewrite baseline.json
+
+Exit status is 1 if any benchmark regressed beyond the threshold, failed to
+run, or produced mismatched output.
+"""
+
+import argparse
+import json
+import os
+import platform
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+ROOT_DIR = os.path.dirname(SCRIPT_DIR)
+DEFAULT_BASELINE = os.path.join(SCRIPT_DIR, "baseline.json")
+ALL_BACKENDS = ["interp", "compiled", "hmlc"]
+
+# Colors (disabled when not writing to a terminal)
+if sys.stdout.isatty():
+    RED, GREEN, YELLOW, BLUE, DIM, NC = (
+        "\033[0;31m", "\033[0;32m", "\033[1;33m", "\033[0;34m", "\033[2m", "\033[0m")
+else:
+    RED = GREEN = YELLOW = BLUE = DIM = NC = ""
+
+
+def rss_to_kb(ru_maxrss):
+    """ru_maxrss is kilobytes on Linux and bytes on macOS."""
+    if platform.system() == "Darwin":
+        return ru_maxrss // 1024
+    return ru_maxrss
+
+
+def read_hwm_kb(pid):
+    """Peak RSS of a running process from /proc (Linux), or None.
+
+    ru_maxrss from wait4() is not usable on Linux: exec() folds the forking
+    parent's high-water mark into the child, so every benchmark would report
+    at least the runner's own footprint.
+    """
+    try:
+        with open("/proc/%d/status" % pid) as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1])
+    except (OSError, ValueError):
+        pass
+    return None
+
+
+def run_once(cmd, timeout):
+    """Run cmd, returning (elapsed_ms, peak_rss_kb, exit_code, output)."""
+    env = dict(os.environ)
+    env["LD_LIBRARY_PATH"] = ROOT_DIR + os.pathsep + env.get("LD_LIBRARY_PATH", "")
+    out = tempfile.TemporaryFile()
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, cwd=ROOT_DIR, stdout=out, stderr=subprocess.STDOUT, env=env)
+    deadline = start + timeout
+    hwm_kb = None
+    while True:
+        sample = read_hwm_kb(proc.pid)
+        if sample is not None:
+            hwm_kb = sample
+        pid, status, rusage = os.wait4(proc.pid, os.WNOHANG)
+        if pid != 0:
+            break
+        if time.perf_counter() > deadline:
+            proc.kill()
+            pid, status, rusage = os.wait4(proc.pid, 0)
+            out.close()
+            return None, None, 124, "[TIMEOUT after %ds]" % timeout
+        time.sleep(0.001)
+    elapsed_ms = (time.perf_counter() - start) * 1000.0
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    out.seek(0)
+    output = out.read().decode("utf-8", errors="replace")
+    out.close()
+    peak_kb = hwm_kb if hwm_kb is not None else rss_to_kb(rusage.ru_maxrss)
+    return elapsed_ms, peak_kb, proc.returncode, output
+
+
+def prepare(backend, bench_path, name, workdir, args):
+    """Build whatever the backend needs and return the command to run."""
+    if backend == "interp":
+        return [args.hemlock, bench_path]
+    if backend == "compiled":
+        exe = os.path.join(workdir, name)
+        result = subprocess.run(
+            [args.hemlockc, "-O2", bench_path, "-o", exe],
+            cwd=ROOT_DIR, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        if result.returncode != 0:
+            raise RuntimeError("hemlockc failed:\n" + result.stdout.decode(errors="replace"))
+        return [exe]
+    if backend == "hmlc":
+        hmlc = os.path.join(workdir, name + ".hmlc")
+        result = subprocess.run(
+            [args.hemlock, "--bundle", bench_path, "-o", hmlc],
+            cwd=ROOT_DIR, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        if result.returncode != 0:
+            raise RuntimeError("hemlock --bundle failed:\n" + result.stdout.decode(errors="replace"))
+        return [args.hemlock, hmlc]
+    raise ValueError("unknown backend: " + backend)
+
+
+def compare(value, base, threshold):
+    """Return (delta_fraction, regressed) comparing value against base."""
+    if base is None or base <= 0:
+        return None, False
+    delta = (value - base) / base
+    return delta, delta > threshold
+
+
+def format_delta(delta, regressed):
+    if delta is None:
+        return DIM + "   new" + NC
+    color = RED if regressed else (GREEN if delta < 0 else "")
+    return "%s%+6.1f%%%s" % (color, delta * 100.0, NC if color else "")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run Hemlock benchmarks")
+    parser.add_argument("--backends", default="interp,compiled",
+                        help="comma-separated list of: " + ",".join(ALL_BACKENDS))
+    parser.add_argument("--runs", type=int, default=5, help="runs per benchmark (median is reported)")
+    parser.add_argument("--filter", default=None, help="only run benchmarks whose name contains this")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="baseline JSON file")
+    parser.add_argument("--threshold", type=float, default=None,
+                        help="allowed slowdown/growth as a fraction (default: baseline's, else 0.25)")
+    parser.add_argument("--update-baseline", action="store_true", help="write results to the baseline file")
+    parser.add_argument("--json", default=None, help="also write results to this JSON file")
+    parser.add_argument("--timeout", type=int, default=120, help="per-run timeout in seconds")
+    parser.add_argument("--hemlock", default=os.path.join(ROOT_DIR, "hemlock"))
+    parser.add_argument("--hemlockc", default=os.path.join(ROOT_DIR, "hemlockc"))
+    args = parser.parse_args()
+
+    backends = [b.strip() for b in args.backends.split(",") if b.strip()]
+    for b in backends:
+        if b not in ALL_BACKENDS:
+            parser.error("unknown backend '%s' (expected one of %s)" % (b, ", ".join(ALL_BACKENDS)))
+    if not os.path.isfile(args.hemlock):
+        print(RED + "Error: interpreter not found at " + args.hemlock + NC)
+        print("Run 'make' first.")
+        return 1
+    if "compiled" in backends and not os.path.isfile(args.hemlockc):
+        print(RED + "Error: compiler not found at " + args.hemlockc + NC)
+        print("Run 'make compiler' first.")
+        return 1
+
+    baseline = {}
+    if os.path.isfile(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+    threshold = args.threshold
+    if threshold is None:
+        threshold = baseline.get("threshold", 0.25)
+    base_results = baseline.get("benchmarks", {})
+
+    benches = sorted(f[:-4] for f in os.listdir(SCRIPT_DIR) if f.endswith(".hml"))
+    if args.filter:
+        benches = [b for b in benches if args.filter in b]
+
+    print("======================================")
+    print("      Hemlock Benchmark Suite")
+    print("======================================")
+    print("")
+    print("Backends: %s   Runs: %d   Threshold: %.0f%%" % (", ".join(backends), args.runs, threshold * 100))
+    print("")
+    print("%-18s %-9s %10s %8s %10s %8s" % ("benchmark", "backend", "median", "delta", "peak RSS", "delta"))
+    print("-" * 68)
+
+    results = {}
+    failures = []
+    workdir = tempfile.mkdtemp(prefix="hemlock_bench_")
+    try:
+        for name in benches:
+            bench_path = os.path.join("benchmarks", name + ".hml")
+            results[name] = {}
+            reference_output = None
+            for backend in backends:
+                try:
+                    cmd = prepare(backend, bench_path, name, workdir, args)
+                except RuntimeError as e:
+                    print("%-18s %-9s %s" % (name, backend, RED + "build failed" + NC))
+                    failures.append("%s/%s: %s" % (name, backend, e))
+                    continue
+
+                times, rss = [], []
+                error = None
+                for _ in range(args.runs):
+                    elapsed, peak, code, output = run_once(cmd, args.timeout)
+                    if code != 0:
+                        error = "exit %d: %s" % (code, output.strip()[:200])
+                        break
+                    if reference_output is None:
+                        reference_output = output
+                    elif output != reference_output:
+                        error = "output differs from %s" % backends[0]
+                        break
+                    times.append(elapsed)
+                    rss.append(peak)
+                if error:
+                    print("%-18s %-9s %s" % (name, backend, RED + "failed" + NC))
+                    failures.append("%s/%s: %s" % (name, backend, error))
+                    continue
+
+                median_ms = statistics.median(times)
+                peak_kb = max(rss)
+                results[name][backend] = {"median_ms": round(median_ms, 2), "peak_rss_kb": peak_kb}
+
+                base = base_results.get(name, {}).get(backend, {})
+                t_delta, t_reg = compare(median_ms, base.get("median_ms"), threshold)
+                m_delta, m_reg = compare(peak_kb, base.get("peak_rss_kb"), threshold)
+                print("%-18s %-9s %8.1fms %s %8.1fMB %s" % (
+                    name, backend, median_ms, format_delta(t_delta, t_reg),
+                    peak_kb / 1024.0, format_delta(m_delta, m_reg)))
+                if t_reg and not args.update_baseline:
+                    failures.append("%s/%s: time %.1fms vs baseline %.1fms (%+.1f%%)" % (
+                        name, backend, median_ms, base["median_ms"], t_delta * 100))
+                if m_reg and not args.update_baseline:
+                    failures.append("%s/%s: peak RSS %dKB vs baseline %dKB (%+.1f%%)" % (
+                        name, backend, peak_kb, base["peak_rss_kb"], m_delta * 100))
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    report = {
+        "threshold": threshold,
+        "runs": args.runs,
+        "machine": "%s %s" % (platform.system(), platform.machine()),
+        "benchmarks": results,
+    }
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write("\n")
+    if args.update_baseline:
+        # Keep baseline entries for benchmarks/backends not run this time
+        merged = dict(base_results)
+        for name, per_backend in results.items():
+            merged.setdefault(name, {}).update(per_backend)
+        report["benchmarks"] = merged
+        with open(args.baseline, "w") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("")
+        print(GREEN + "✓ Baseline written to " + os.path.relpath(args.baseline, ROOT_DIR) + NC)
+
+    print("")
+    if failures:
+        print(RED + "======================================")
+        print("        Regressions / Failures")
+        print("======================================" + NC)
+        for f in failures:
+            print("  " + RED + "✗" + NC + " " + f)
+        print("")
+        return 1
+    print(GREEN + "No regressions beyond %.0f%% 🎉" % (threshold * 100) + NC)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
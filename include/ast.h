@@ -146,6 +146,13 @@ struct Expr {
             Type *rest_param_type;  // Type of rest parameter, NULL if none
             Type *return_type;
             Stmt *body;
+            // Set by the interpreter's resolver. A flat closure copies just
+            // the variables it uses from enclosing function and block scopes
+            // instead of retaining the whole defining environment chain.
+            int is_flat;
+            int num_captures;
+            char **capture_names;
+            ResolvedVar *captures;  // Where each one lives at the definition site
         } function;
         struct {
             Expr **elements;
@@ -329,6 +336,7 @@ struct Stmt {
         } switch_stmt;
         struct {
             Expr *call;              // Function call expression to defer
+            Expr *bound_call;        // The call over operands evaluated at the defer, or NULL
         } defer_stmt;
         struct {
             int is_namespace;        // 1 for "import * as", 0 for named imports
@@ -414,6 +422,7 @@ Stmt* stmt_try(Stmt *try_block, char *catch_param, Stmt *catch_block, Stmt *fina
 Stmt* stmt_throw(Expr *value);
 Stmt* stmt_switch(Expr *expr, Expr **case_values, Stmt **case_bodies, int num_cases);
 Stmt* stmt_defer(Expr *call);
+Expr* expr_defer_binding(Expr *call);
 Stmt* stmt_import_named(char **import_names, char **import_aliases, int num_imports, const char *module_path);
 Stmt* stmt_import_namespace(const char *namespace_name, const char *module_path);
 Stmt* stmt_import_star(const char *module_path);
@@ -40,6 +40,45 @@
 // Maximum signal number for signal handlers (POSIX standard)
 #define HML_MAX_SIGNAL 64
 
+// Cycle collector: container allocations (objects, arrays, closures)
+// between automatic collections. After each collection the threshold is
+// raised to the number of containers it traced, so total tracing work stays
+// proportional to allocation.
+#define HML_GC_INITIAL_THRESHOLD 10000
+
+// ========== PROFILER LIMITS ==========
+
+// Default sampling rate for --profile (samples per second of CPU time)
+#define HML_PROFILE_DEFAULT_HZ 1000
+
+// Deepest stack recorded per sample (leaf-most frames are kept)
+#define HML_PROFILE_MAX_DEPTH 128
+
+// Preallocated sample buffer size in pointer slots (8MB on 64-bit)
+// Samples taken after the buffer fills are counted as dropped
+#define HML_PROFILE_BUFFER_SLOTS (1 << 20)
+
+// Functions shown in the end-of-run profile table
+#define HML_PROFILE_TOP_N 20
+
+// Folded stack output file when --profile is given without a path
+#define HML_PROFILE_DEFAULT_OUTPUT "hemlock-profile.folded"
+
+// Heap profiler (--heap-profile): record the call stack of every Nth
+// allocation per thread
+#define HML_HEAP_SAMPLE_INTERVAL 64
+
+// Bytes of string content shown per string in heap_snapshot() output
+#define HML_HEAP_PREVIEW_LENGTH 40
+
+// Concurrency tracing (--trace): events per buffer chunk, and the most
+// events kept per thread (later events are counted as dropped)
+#define HML_TRACE_CHUNK_EVENTS 4096
+#define HML_TRACE_MAX_EVENTS_PER_THREAD (1 << 20)
+
+// Trace-event JSON output file when --trace is given without a path
+#define HML_TRACE_DEFAULT_OUTPUT "hemlock-trace.json"
+
 // ========== COMPILER LIMITS ==========
 
 // Buffer size for mangled names (module prefix + symbol name)
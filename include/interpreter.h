@@ -29,6 +29,7 @@ typedef enum {
     VAL_FILE,           // File handle
     VAL_SOCKET,         // Socket handle
     VAL_WEBSOCKET,      // WebSocket handle (client or server connection)
+    VAL_WRITER,         // Buffered writer (BufferedWriter from @stdlib/fs)
     VAL_TYPE,           // Represents a type (for sizeof, talloc, etc.)
     VAL_BUILTIN_FN,
     VAL_FUNCTION,       // User-defined function
@@ -60,6 +61,7 @@ typedef struct {
     int capacity;
     int ref_count;       // Reference count for memory management
     _Atomic int freed;   // Atomic flag: 1 if freed via free(), 0 otherwise
+    int mapped;          // 1 if data is a private file mapping (mmap_file)
 } Buffer;
 
 // Array struct (dynamic array)
@@ -70,6 +72,7 @@ typedef struct {
     int ref_count;       // Reference count for memory management
     Type *element_type;  // Optional: type constraint for array elements (NULL = untyped)
     _Atomic int freed;   // Atomic flag: 1 if freed via free(), 0 otherwise
+    int gc_buffered;     // Index + 1 in the cycle collector's buffer, 0 = none
 } Array;
 
 // File handle struct
@@ -78,6 +81,9 @@ typedef struct {
     char *path;         // File path (for error messages)
     char *mode;         // Mode string ("r", "w", etc.)
     int closed;         // 1 if closed, 0 if open
+    char *stdio_buf;    // Read buffer handed to setvbuf (NULL = stdio default)
+    char *line_buf;     // Reused by read_line() and lines()
+    size_t line_cap;
 } FileHandle;
 
 // Socket handle struct
@@ -103,6 +109,17 @@ typedef struct {
     int ref_count;       // Reference count for memory management
 } WebSocketHandle;
 
+// Buffered writer struct (output waiting to go to a file or descriptor)
+typedef struct {
+    char *data;          // Pending output
+    int length;          // Bytes pending
+    int capacity;
+    FileHandle *file;    // Target file, or NULL to write to fd
+    int fd;              // Target descriptor when file is NULL
+    int closed;          // Whether close() has been called
+    int ref_count;       // Reference count for memory management
+} WriterHandle;
+
 // Object struct (JavaScript-style object)
 typedef struct {
     char *type_name;  // NULL for anonymous
@@ -112,6 +129,7 @@ typedef struct {
     int capacity;
     int ref_count;       // Reference count for memory management
     _Atomic int freed;   // Atomic flag: 1 if freed via free(), 0 otherwise
+    int gc_buffered;     // Index + 1 in the cycle collector's buffer, 0 = none
     // Hash table for O(1) field lookup (linear probing)
     int *hash_table;     // Array of field indices, -1 = empty slot
     int hash_capacity;   // Size of hash table (usually 2x num_fields)
@@ -133,6 +151,7 @@ typedef struct {
     Environment *closure_env;  // CAPTURED ENVIRONMENT
     int ref_count;             // Reference count for memory management
     int is_bound;              // If true, this is a bound method (don't free param arrays)
+    int gc_buffered;           // Index + 1 in the cycle collector's buffer, 0 = none
 } Function;
 
 // Task states
@@ -230,6 +249,7 @@ typedef struct Value {
         FileHandle *as_file;
         SocketHandle *as_socket;
         WebSocketHandle *as_websocket;
+        WriterHandle *as_writer;
         Object *as_object;
         TypeKind as_type;
         BuiltinFn as_builtin_fn;
@@ -255,6 +275,8 @@ typedef struct Environment {
     int hash_capacity;   // Size of hash table (usually 2x capacity)
     // Borrowed names optimization: bit flags (1 = borrowed, don't free)
     unsigned int borrowed_flags;  // Bit flags for first 32 names
+    int gc_buffered;     // Index + 1 in the cycle collector's buffer, 0 = none
+    int gc_captured;     // 1 once a closure captured this env or a descendant
 } Environment;
 
 // Public interface
@@ -10,6 +10,10 @@
  * When a variable reference (EXPR_IDENT) or assignment (EXPR_ASSIGN) is encountered,
  * the resolver looks up the variable and stores the resolution info directly
  * in the AST node.
+ *
+ * resolve_program() makes two passes. The first also works out which
+ * function expressions can be flat closures, and the second resolves their
+ * bodies against a scope holding just their captures.
  */
 
 #ifndef HEMLOCK_RESOLVER_H
@@ -23,19 +27,61 @@
  */
 typedef struct ResolverScope {
     char **names;              // Variable names defined in this scope
+    int *bindings;             // Binding id of each variable (index into binding_flags)
     int count;                 // Number of variables
     int capacity;              // Allocated capacity
+    int first_function;        // Functions recorded before this scope was entered
     struct ResolverScope *parent;  // Enclosing scope
 } ResolverScope;
 
+/*
+ * What the analysis pass learns about one function expression: the variables
+ * it uses from enclosing non-global scopes (its captures) and the names it
+ * uses that no scope had defined yet. A function whose captures are never
+ * reassigned becomes a flat closure; anything else keeps its defining
+ * environment chain.
+ */
+typedef struct {
+    Expr *expr;
+    int param_depth;           // Scope depth of the function's parameters
+    const char **captures;
+    int *capture_bindings;
+    int num_captures;
+    int capture_capacity;
+    const char **unresolved;
+    int num_unresolved;
+    int unresolved_capacity;
+    int keep_chain;            // 1 if it must retain its defining environment chain
+} ResolverFunction;
+
 /*
  * Resolver context - maintains the scope stack during resolution.
  */
 typedef struct {
     ResolverScope *current;    // Current innermost scope
     int scope_depth;           // Current nesting depth (0 = global)
+    int flatten;               // 1 on the final pass, which resolves flat closures
+                               // against their capture scope
+
+    // Analysis pass state
+    ResolverFunction *functions;    // Every function expression seen so far
+    int num_functions;
+    int function_capacity;
+    int *active;               // Indexes of the functions being resolved, innermost last
+    int num_active;
+    int active_capacity;
+    unsigned char *binding_flags;   // RESOLVER_BINDING_* per binding id
+    int num_bindings;
+    int binding_capacity;
+    const char **dynamic_names;     // Names the runtime defines outside the resolver's scopes
+    int num_dynamic;
+    int dynamic_capacity;
+    int ref_args;              // 1 if a bare variable argument may be a ref argument
 } ResolverContext;
 
+#define RESOLVER_BINDING_ASSIGNED 1   // Assigned, incremented or decremented
+#define RESOLVER_BINDING_PASSED   2   // Passed bare as a call argument
+
 /*
  * Create a new resolver context.
  */
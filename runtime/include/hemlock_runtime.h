@@ -25,6 +25,15 @@ void hml_runtime_cleanup(void);
 // Get command-line arguments as Hemlock array
 HmlValue hml_get_args(void);
 
+// Give stdout a size-byte buffer (line-buffered on a TTY) and stop print()
+// from flushing after every line; stdio flushes it at exit. hemlockc
+// --stdout-buffer emits this, and HEMLOCK_STDOUT_BUFFER=<size> enables it
+// in any binary.
+void hml_stdout_buffer(int64_t size);
+
+// Parse a byte count with an optional K/M/G suffix; -1 if malformed
+int64_t hml_parse_size(const char *text);
+
 // ========== SANDBOX CONFIGURATION ==========
 
 // Sandbox restriction flags (must match hemlock_limits.h)
@@ -217,6 +226,15 @@ HmlValue hml_exec(HmlValue command);
 HmlValue hml_exec_with_args(HmlValue command, HmlValue args_array);
 HmlValue hml_exec_argv(HmlValue args_array);
 
+// Subprocesses (builtins_process.c)
+HmlValue hml_exec_capture(char **argv, const char *fn_name);
+HmlValue hml_spawn_process(HmlValue argv, HmlValue options);
+HmlValue hml_process_wait(HmlValue pid, HmlValue timeout_ms);
+HmlValue hml_run_many(HmlValue cmds, HmlValue concurrency);
+HmlValue hml_builtin_spawn_process(HmlClosureEnv *env, HmlValue argv, HmlValue options);
+HmlValue hml_builtin_process_wait(HmlClosureEnv *env, HmlValue pid, HmlValue timeout_ms);
+HmlValue hml_builtin_run_many(HmlClosureEnv *env, HmlValue cmds, HmlValue concurrency);
+
 // Environment builtin wrappers
 HmlValue hml_builtin_getenv(HmlClosureEnv *env, HmlValue name);
 HmlValue hml_builtin_setenv(HmlClosureEnv *env, HmlValue name, HmlValue value);
@@ -288,6 +306,8 @@ HmlValue hml_string_replace(HmlValue str, HmlValue old, HmlValue new_str);
 HmlValue hml_string_replace_all(HmlValue str, HmlValue old, HmlValue new_str);
 HmlValue hml_string_repeat(HmlValue str, HmlValue count);
 HmlValue hml_string_concat_many(HmlValue arr);  // Concatenate array of strings
+HmlValue hml_string_interpolate(const char *const *lits, const int *lit_lens,
+                                const HmlValue *vals, int count);  // `a${x}b` templates
 
 // String index access (returns rune)
 HmlValue hml_string_index(HmlValue str, HmlValue index);
@@ -298,6 +318,21 @@ HmlValue hml_string_chars(HmlValue str);   // Returns array of runes
 HmlValue hml_string_bytes(HmlValue str);   // Returns array of u8 bytes
 HmlValue hml_string_to_bytes(HmlValue str); // Converts string to buffer
 
+// String builder: a buffer of appended bytes (__sb_* builtins)
+HmlValue hml_sb_new(HmlValue capacity);
+HmlValue hml_sb_append(HmlValue sb, HmlValue val);
+HmlValue hml_sb_append_byte(HmlValue sb, HmlValue byte);
+HmlValue hml_sb_to_string(HmlValue sb);
+HmlValue hml_builtin_sb_new(HmlClosureEnv *env, HmlValue capacity);
+HmlValue hml_builtin_sb_append(HmlClosureEnv *env, HmlValue sb, HmlValue val);
+HmlValue hml_builtin_sb_append_byte(HmlClosureEnv *env, HmlValue sb, HmlValue byte);
+HmlValue hml_builtin_sb_to_string(HmlClosureEnv *env, HmlValue sb);
+
+// Buffered writer: BufferedWriter from @stdlib/fs (__bw_new builtin)
+HmlValue hml_bw_new(HmlValue target, HmlValue capacity);
+HmlValue hml_writer_method(HmlValue writer, const char *method, HmlValue *args, int num_args);
+HmlValue hml_builtin_bw_new(HmlClosureEnv *env, HmlValue target, HmlValue capacity);
+
 // ========== ARRAY OPERATIONS ==========
 
 void hml_array_push(HmlValue arr, HmlValue val);
@@ -393,12 +428,17 @@ typedef struct HmlExceptionContext {
     jmp_buf exception_buf;
     HmlValue exception_value;
     int is_active;
+    int profile_depth;  // Profiler shadow stack depth to restore when caught
     struct HmlExceptionContext *prev;
 } HmlExceptionContext;
 
 // Exception stack management
 HmlExceptionContext* hml_exception_push(void);
 void hml_exception_pop(void);
+// Caller-owned contexts (a function's defer frame): no allocation, and
+// leaving also drops any contexts a return left above it
+void hml_exception_enter(HmlExceptionContext *ctx);
+HmlValue hml_exception_leave(HmlExceptionContext *ctx);
 __attribute__((noreturn)) void hml_throw(HmlValue exception_value);
 HmlValue hml_exception_get_value(void);
 
@@ -417,6 +457,33 @@ void hml_defer_push_call_with_args(HmlValue fn, HmlValue *args, int num_args);
 void hml_defer_pop_and_execute(void);
 void hml_defer_execute_all(void);
 
+// Defers inside a function run when it exits. Those outside loops live in
+// fixed slots of the function's frame; a function with a defer in a loop
+// keeps them in a list instead. Each call is a callee (or method receiver)
+// and its arguments, all evaluated at the defer.
+typedef struct {
+    const char *method;   // Method name for a method call, NULL for a plain call
+    int first;            // Index of the callee (or receiver) in values
+    int num_args;         // Arguments following it in values
+} HmlDeferCall;
+
+typedef struct {
+    HmlDeferCall *calls;
+    HmlValue *values;
+    int count;
+    int capacity;
+    int num_values;
+    int values_capacity;
+} HmlDeferList;
+
+// Run a deferred call and release its callee and arguments
+void hml_defer_run(HmlValue callee, const char *method, HmlValue *args, int num_args);
+// Add a call to a list, taking over the references to callee and args
+void hml_defer_list_push(HmlDeferList *list, HmlValue callee, const char *method,
+                         HmlValue *args, int num_args);
+// Run a list's calls last-in first-out and free it
+void hml_defer_list_run(HmlDeferList *list);
+
 // ========== ASYNC/CONCURRENCY ==========
 
 // Task management
@@ -441,6 +508,7 @@ HmlValue hml_poll(HmlValue fds, HmlValue timeout);
 // ========== FILE I/O ==========
 
 HmlValue hml_open(HmlValue path, HmlValue mode);
+HmlValue hml_file_from_fd(int fd, const char *mode, const char *name);
 HmlValue hml_file_read(HmlValue file, HmlValue size);
 HmlValue hml_file_read_all(HmlValue file);
 HmlValue hml_file_write(HmlValue file, HmlValue data);
@@ -449,6 +517,16 @@ HmlValue hml_file_tell(HmlValue file);
 void hml_file_close(HmlValue file);
 HmlValue hml_file_read_bytes(HmlValue file, HmlValue size);
 HmlValue hml_file_write_bytes(HmlValue file, HmlValue data);
+HmlValue hml_file_read_line(HmlValue file);
+HmlValue hml_file_lines(HmlValue file);
+HmlValue hml_mmap_file(HmlValue path);
+
+// Kernel-assisted copies (file_transfer.c). Return the number of bytes moved,
+// or -1 with errno set.
+int64_t hml_fd_copy(int src_fd, int dest_fd);
+// At most count bytes from src_fd's current offset; fewer if it ends first
+int64_t hml_fd_copy_n(int src_fd, int dest_fd, int64_t count);
+int64_t hml_fd_send_file(int sock_fd, int file_fd, int64_t offset, int64_t count, int nonblocking);
 
 // ========== FILESYSTEM OPERATIONS ==========
 
@@ -468,6 +546,40 @@ HmlValue hml_file_stat(HmlValue path);
 HmlValue hml_make_dir(HmlValue path, HmlValue mode);
 HmlValue hml_remove_dir(HmlValue path);
 HmlValue hml_list_dir(HmlValue path);
+
+// Directory walking (builtins_walk.c)
+HmlValue hml_walk_dir(HmlValue root, HmlValue options);
+HmlValue hml_walk_open(HmlValue root, HmlValue options);
+HmlValue hml_walk_next(HmlValue handle);
+HmlValue hml_walk_close(HmlValue handle);
+HmlValue hml_builtin_walk_dir(HmlClosureEnv *env, HmlValue root, HmlValue options);
+HmlValue hml_builtin_walk_open(HmlClosureEnv *env, HmlValue root, HmlValue options);
+HmlValue hml_builtin_walk_next(HmlClosureEnv *env, HmlValue handle);
+HmlValue hml_builtin_walk_close(HmlClosureEnv *env, HmlValue handle);
+
+// Tar archives (builtins_tar.c)
+HmlValue hml_tar_writer_open(HmlValue target, HmlValue gzip_level);
+HmlValue hml_tar_writer_add(HmlValue handle, HmlValue name, HmlValue content, HmlValue mode,
+                            HmlValue type, HmlValue linkname);
+HmlValue hml_tar_writer_add_path(HmlValue handle, HmlValue path, HmlValue name);
+HmlValue hml_tar_writer_close(HmlValue handle);
+HmlValue hml_tar_reader_open(HmlValue source);
+HmlValue hml_tar_reader_next(HmlValue handle);
+HmlValue hml_tar_reader_read(HmlValue handle, HmlValue max);
+HmlValue hml_tar_reader_extract(HmlValue handle, HmlValue dest);
+HmlValue hml_tar_reader_extract_into(HmlValue handle, HmlValue dest_dir);
+HmlValue hml_tar_reader_close(HmlValue handle);
+HmlValue hml_builtin_tar_writer_open(HmlClosureEnv *env, HmlValue target, HmlValue gzip_level);
+HmlValue hml_builtin_tar_writer_add(HmlClosureEnv *env, HmlValue handle, HmlValue name, HmlValue content,
+                                    HmlValue mode, HmlValue type, HmlValue linkname);
+HmlValue hml_builtin_tar_writer_add_path(HmlClosureEnv *env, HmlValue handle, HmlValue path, HmlValue name);
+HmlValue hml_builtin_tar_writer_close(HmlClosureEnv *env, HmlValue handle);
+HmlValue hml_builtin_tar_reader_open(HmlClosureEnv *env, HmlValue source);
+HmlValue hml_builtin_tar_reader_next(HmlClosureEnv *env, HmlValue handle);
+HmlValue hml_builtin_tar_reader_read(HmlClosureEnv *env, HmlValue handle, HmlValue max);
+HmlValue hml_builtin_tar_reader_extract(HmlClosureEnv *env, HmlValue handle, HmlValue dest);
+HmlValue hml_builtin_tar_reader_extract_into(HmlClosureEnv *env, HmlValue handle, HmlValue dest_dir);
+HmlValue hml_builtin_tar_reader_close(HmlClosureEnv *env, HmlValue handle);
 HmlValue hml_cwd(void);
 HmlValue hml_chdir(HmlValue path);
 HmlValue hml_absolute_path(HmlValue path);
@@ -549,6 +661,7 @@ HmlValue hml_dirent_name(HmlValue ptr);
 HmlValue hml_string_to_cstr(HmlValue str);
 HmlValue hml_cstr_to_string(HmlValue ptr);
 HmlValue hml_string_from_bytes(HmlValue arg);
+HmlValue hml_utf8_valid(HmlValue arg);
 
 // Internal helper builtin wrappers
 HmlValue hml_builtin_read_u32(HmlClosureEnv *env, HmlValue ptr);
@@ -559,6 +672,22 @@ HmlValue hml_builtin_dirent_name(HmlClosureEnv *env, HmlValue ptr);
 HmlValue hml_builtin_string_to_cstr(HmlClosureEnv *env, HmlValue str);
 HmlValue hml_builtin_cstr_to_string(HmlClosureEnv *env, HmlValue ptr);
 HmlValue hml_builtin_string_from_bytes(HmlClosureEnv *env, HmlValue arg);
+HmlValue hml_builtin_utf8_valid(HmlClosureEnv *env, HmlValue arg);
+
+// Base64, hex and percent codecs over strings and buffers (builtins_encoding.c)
+HmlValue hml_base64_encode(HmlValue input);
+HmlValue hml_base64_decode(HmlValue input);
+HmlValue hml_hex_encode(HmlValue input);
+HmlValue hml_hex_decode(HmlValue input);
+HmlValue hml_percent_encode(HmlValue input, HmlValue escape, HmlValue space_plus, HmlValue upper);
+HmlValue hml_percent_decode(HmlValue input, HmlValue plus_space);
+HmlValue hml_builtin_base64_encode(HmlClosureEnv *env, HmlValue input);
+HmlValue hml_builtin_base64_decode(HmlClosureEnv *env, HmlValue input);
+HmlValue hml_builtin_hex_encode(HmlClosureEnv *env, HmlValue input);
+HmlValue hml_builtin_hex_decode(HmlClosureEnv *env, HmlValue input);
+HmlValue hml_builtin_percent_encode(HmlClosureEnv *env, HmlValue input, HmlValue escape,
+                                    HmlValue space_plus, HmlValue upper);
+HmlValue hml_builtin_percent_decode(HmlClosureEnv *env, HmlValue input, HmlValue plus_space);
 
 // ========== DNS/NETWORKING OPERATIONS ==========
 
@@ -579,9 +708,14 @@ void hml_socket_close(HmlValue socket_val);
 
 // Socket I/O
 HmlValue hml_socket_send(HmlValue socket_val, HmlValue data);
+HmlValue hml_socket_send_file(HmlValue socket_val, HmlValue path, HmlValue offset, HmlValue length);
 HmlValue hml_socket_recv(HmlValue socket_val, HmlValue size);
 HmlValue hml_socket_sendto(HmlValue socket_val, HmlValue address, HmlValue port, HmlValue data);
 HmlValue hml_socket_recvfrom(HmlValue socket_val, HmlValue size);
+HmlValue hml_socket_recv_into(HmlValue socket_val, HmlValue buf, HmlValue offset, HmlValue length);
+HmlValue hml_socket_recv_many(HmlValue socket_val, HmlValue count, HmlValue size);
+HmlValue hml_socket_send_many(HmlValue socket_val, HmlValue packets);
+HmlValue hml_socket_send_parts(HmlValue socket_val, HmlValue parts);
 
 // Socket options
 void hml_socket_setsockopt(HmlValue socket_val, HmlValue level, HmlValue option, HmlValue value);
@@ -817,6 +951,15 @@ HmlValue hml_lws_response_redirect(HmlValue resp);
 // Get response body as binary buffer (preserves null bytes)
 HmlValue hml_lws_response_body_binary(HmlValue resp);
 
+// Pooled HTTP client: one lws context and service thread per client
+HmlValue hml_lws_http_client_new(HmlValue max_per_host, HmlValue timeout_ms);
+HmlValue hml_lws_http_client_submit(HmlValue client, HmlValue method, HmlValue url, HmlValue body, HmlValue content_type);
+HmlValue hml_lws_http_client_wait(HmlValue request);
+HmlValue hml_lws_http_client_close(HmlValue client);
+HmlValue hml_lws_http_stream_open(HmlValue client, HmlValue method, HmlValue url, HmlValue body, HmlValue content_type);
+HmlValue hml_lws_http_stream_read(HmlValue handle, HmlValue max);
+HmlValue hml_lws_http_stream_close(HmlValue handle);
+
 // Builtin wrappers for function-as-value
 HmlValue hml_builtin_lws_http_get(HmlClosureEnv *env, HmlValue url);
 HmlValue hml_builtin_lws_http_post(HmlClosureEnv *env, HmlValue url, HmlValue body, HmlValue content_type);
@@ -827,6 +970,13 @@ HmlValue hml_builtin_lws_response_headers(HmlClosureEnv *env, HmlValue resp);
 HmlValue hml_builtin_lws_response_free(HmlClosureEnv *env, HmlValue resp);
 HmlValue hml_builtin_lws_response_redirect(HmlClosureEnv *env, HmlValue resp);
 HmlValue hml_builtin_lws_response_body_binary(HmlClosureEnv *env, HmlValue resp);
+HmlValue hml_builtin_lws_http_client_new(HmlClosureEnv *env, HmlValue max_per_host, HmlValue timeout_ms);
+HmlValue hml_builtin_lws_http_client_submit(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url, HmlValue body, HmlValue content_type);
+HmlValue hml_builtin_lws_http_client_wait(HmlClosureEnv *env, HmlValue request);
+HmlValue hml_builtin_lws_http_client_close(HmlClosureEnv *env, HmlValue client);
+HmlValue hml_builtin_lws_http_stream_open(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url, HmlValue body, HmlValue content_type);
+HmlValue hml_builtin_lws_http_stream_read(HmlClosureEnv *env, HmlValue handle, HmlValue max);
+HmlValue hml_builtin_lws_http_stream_close(HmlClosureEnv *env, HmlValue handle);
 
 // WebSocket client functions
 HmlValue hml_lws_ws_connect(HmlValue url);
@@ -945,6 +1095,201 @@ HmlValue hml_builtin_set_stack_limit(HmlClosureEnv *env, HmlValue limit);
     hml_g_call_depth--; \
 } while(0)
 
+// ========== SAMPLING PROFILER (hemlockc --profile) ==========
+
+// Shadow stack slots per thread (power of two). Deeper stacks wrap around so
+// the leaf-most frames are always the ones recorded.
+#define HML_PROFILE_STACK_SIZE 128
+
+// Thread-local shadow stack of function names, read by the SIGPROF handler
+extern __thread const char *hml_g_profile_frames[HML_PROFILE_STACK_SIZE];
+extern __thread int hml_g_profile_depth;
+
+// Start sampling; folded stacks are written to output_path at exit
+void hml_profiler_start(const char *output_path);
+
+// Emitted around every function body when compiled with --profile.
+// The signal fence keeps the name store ahead of the depth bump so a
+// sample taken in between never sees a stale slot.
+#define HML_PROFILE_ENTER(name) do { \
+    hml_g_profile_frames[hml_g_profile_depth & (HML_PROFILE_STACK_SIZE - 1)] = (name); \
+    __atomic_signal_fence(__ATOMIC_SEQ_CST); \
+    hml_g_profile_depth++; \
+} while(0)
+
+#define HML_PROFILE_EXIT() do { \
+    hml_g_profile_depth--; \
+} while(0)
+
+// ========== HEAP PROFILER (HEMLOCK_HEAP_PROFILE=1) ==========
+
+// Every Nth allocation per thread records its shadow-stack call site
+#define HML_HEAP_SAMPLE_INTERVAL 64
+
+typedef enum {
+    HML_HEAP_KIND_STRING,
+    HML_HEAP_KIND_ARRAY,
+    HML_HEAP_KIND_OBJECT,
+    HML_HEAP_KIND_BUFFER,
+    HML_HEAP_KIND_COUNT
+} HmlHeapKind;
+
+// Nonzero once hml_heap_profiler_init() saw HEMLOCK_HEAP_PROFILE
+extern int hml_g_heap_tracking;
+
+void hml_heap_profiler_init(void);
+void hml_heap_track_alloc(void *ptr, HmlHeapKind kind, size_t bytes);
+void hml_heap_track_free(void *ptr);
+
+// Hooks for value constructors and free paths: one branch when tracking is off
+#define HML_HEAP_TRACK_ALLOC(ptr, kind, bytes) do { \
+    if (__builtin_expect(hml_g_heap_tracking, 0)) hml_heap_track_alloc((ptr), (kind), (bytes)); \
+} while(0)
+
+#define HML_HEAP_TRACK_FREE(ptr) do { \
+    if (__builtin_expect(hml_g_heap_tracking, 0)) hml_heap_track_free(ptr); \
+} while(0)
+
+// heap_stats() / heap_snapshot(path) builtins
+HmlValue hml_heap_stats(void);
+HmlValue hml_heap_snapshot(HmlValue path);
+HmlValue hml_builtin_heap_stats(HmlClosureEnv *env);
+HmlValue hml_builtin_heap_snapshot(HmlClosureEnv *env, HmlValue path);
+
+// ========== CONCURRENCY TRACER (HEMLOCK_TRACE=FILE) ==========
+
+// hml_trace_record() flags
+#define HML_TRACE_INSTANT 0x1   // Point event; otherwise a span from start to now
+#define HML_TRACE_ARG_PTR 0x2   // Write the argument as a hex address
+
+// Nonzero once hml_trace_init() saw HEMLOCK_TRACE
+extern int hml_g_trace_enabled;
+
+void hml_trace_init(void);
+uint64_t hml_trace_now(void);
+void hml_trace_thread_start(const char *label, int id);
+void hml_trace_record(const char *cat, const char *name, uint64_t start,
+                      const char *arg_name, int64_t arg, int flags);
+void hml_trace_blocked(uint64_t blocked_at, void *channel);
+
+// Start timestamp for a span, or 0 when tracing is off
+#define HML_TRACE_NOW() (__builtin_expect(hml_g_trace_enabled, 0) ? hml_trace_now() : 0)
+#define HML_TRACE_SPAN(cat, name, start, arg_name, arg) do { \
+    if (__builtin_expect(hml_g_trace_enabled, 0)) hml_trace_record((cat), (name), (start), (arg_name), (int64_t)(arg), 0); \
+} while (0)
+#define HML_TRACE_CHANNEL_SPAN(name, start, channel) do { \
+    if (__builtin_expect(hml_g_trace_enabled, 0)) \
+        hml_trace_record("channel", (name), (start), "channel", (int64_t)(intptr_t)(channel), HML_TRACE_ARG_PTR); \
+} while (0)
+#define HML_TRACE_INSTANT_EVENT(cat, name, arg_name, arg) do { \
+    if (__builtin_expect(hml_g_trace_enabled, 0)) hml_trace_record((cat), (name), 0, (arg_name), (int64_t)(arg), HML_TRACE_INSTANT); \
+} while (0)
+
+// Around condition-variable wait loops: BEGIN inside the loop marks the
+// first wait, END after the loop records the block span and the wake-up
+#define HML_TRACE_BLOCK_BEGIN(blocked_at) do { \
+    if (__builtin_expect(hml_g_trace_enabled, 0) && !(blocked_at)) (blocked_at) = hml_trace_now(); \
+} while (0)
+#define HML_TRACE_BLOCK_END(blocked_at, channel) do { \
+    if (blocked_at) { hml_trace_blocked((blocked_at), (channel)); (blocked_at) = 0; } \
+} while (0)
+
+// ========== CYCLE COLLECTOR ==========
+
+// Container allocations between automatic collections; raised to the
+// number of containers traced after each collection
+#define HML_GC_INITIAL_THRESHOLD 10000
+
+typedef enum {
+    HML_GC_KIND_OBJECT,
+    HML_GC_KIND_ARRAY
+} HmlGCKind;
+
+// Container allocations since the last collection, and the count that
+// triggers the next one
+extern int hml_g_gc_allocations;
+extern int hml_g_gc_threshold;
+
+// Buffer a container whose refcount dropped to a nonzero value; unbuffer
+// one that is being freed
+void hml_gc_buffer_candidate(void *ptr, HmlGCKind kind);
+void hml_gc_forget(void *ptr, HmlGCKind kind);
+
+// Collection only runs while no spawned task is running
+void hml_gc_task_started(void);
+void hml_gc_task_finished(void);
+void hml_gc_collect_if_due(void);
+
+// gc_buffered holds the container's buffer index + 1, so already buffered
+// containers skip the call
+#define HML_GC_POSSIBLE_ROOT(ptr, kind) do { \
+    if (!(ptr)->gc_buffered) hml_gc_buffer_candidate((ptr), (kind)); \
+} while (0)
+#define HML_GC_FORGET(ptr, kind) do { \
+    if ((ptr)->gc_buffered) hml_gc_forget((ptr), (kind)); \
+} while (0)
+#define HML_GC_NOTE_ALLOCATION() do { \
+    if (__builtin_expect(++hml_g_gc_allocations >= hml_g_gc_threshold, 0)) hml_gc_collect_if_due(); \
+} while (0)
+
+// gc_collect() / gc_stats() builtins
+HmlValue hml_gc_collect(void);
+HmlValue hml_gc_stats(void);
+HmlValue hml_builtin_gc_collect(HmlClosureEnv *env);
+HmlValue hml_builtin_gc_stats(HmlClosureEnv *env);
+
+// ========== SLAB ALLOCATOR ==========
+
+// Largest block served by the slab; bigger requests must use malloc
+#define HML_SLAB_MAX_SIZE 64
+
+// String headers take a fixed block; strings shorter than
+// HML_STRING_INLINE_CAPACITY keep their bytes right after the header
+#define HML_STRING_BLOCK_SIZE 48
+#define HML_STRING_INLINE_CAPACITY (HML_STRING_BLOCK_SIZE - (int)sizeof(HmlString))
+#define HML_STRING_IS_INLINE(str) ((str)->data == (char *)((str) + 1))
+
+typedef struct {
+    int enabled;            // 0 when built with AddressSanitizer
+    long allocs;
+    long frees;
+    long inline_strings;    // Strings created with inline data
+    long depot_blocks;      // Free blocks in the shared depot
+    long reserved_bytes;    // Chunk memory obtained from malloc
+} HmlSlabStats;
+
+// size must be at most HML_SLAB_MAX_SIZE; free with the same size
+void *hml_slab_alloc(size_t size);
+void hml_slab_free(void *ptr, size_t size);
+void hml_slab_note_inline_string(void);
+void hml_slab_get_stats(HmlSlabStats *out);
+
+// String header with room for length bytes plus the terminator
+HmlString *hml_string_alloc(int length);
+
+// alloc_stats() builtin
+HmlValue hml_alloc_stats(void);
+HmlValue hml_builtin_alloc_stats(HmlClosureEnv *env);
+
+// ========== VISITED SET (cycle detection) ==========
+
+#define HML_VISITED_INLINE_CAPACITY 16
+
+// Open-addressing hash set of object/array pointers for serialize() and
+// printing. The inline slots cover small graphs without allocating.
+typedef struct {
+    void **keys;        // NULL marks an empty slot
+    int count;
+    int capacity;       // Power of two, at most half full
+    void *inline_keys[HML_VISITED_INLINE_CAPACITY];
+} HmlVisitedSet;
+
+void hml_visited_init(HmlVisitedSet *set);
+void hml_visited_destroy(HmlVisitedSet *set);
+int hml_visited_contains(HmlVisitedSet *set, void *ptr);
+int hml_visited_add(HmlVisitedSet *set, void *ptr);  // Returns 0 if already present
+void hml_visited_remove(HmlVisitedSet *set, void *ptr);
+
 // ========== ATOMIC OPERATIONS ==========
 
 // i32 atomic operations
@@ -22,6 +22,7 @@ typedef struct HmlFileHandle HmlFileHandle;
 typedef struct HmlTask HmlTask;
 typedef struct HmlChannel HmlChannel;
 typedef struct HmlSocket HmlSocket;
+typedef struct HmlWriter HmlWriter;
 
 // Task states
 typedef enum {
@@ -55,6 +56,7 @@ typedef enum {
     HML_VAL_TASK,
     HML_VAL_CHANNEL,
     HML_VAL_SOCKET,
+    HML_VAL_WRITER,
     HML_VAL_NULL,
 } HmlValueType;
 
@@ -89,6 +91,7 @@ typedef struct HmlValue {
         HmlTask *as_task;
         HmlChannel *as_channel;
         HmlSocket *as_socket;
+        HmlWriter *as_writer;
     } as;
 } HmlValue;
 
@@ -108,6 +111,7 @@ struct HmlBuffer {
     int capacity;
     int ref_count;
     _Atomic int freed;   // Atomic flag: 1 if freed via free(), 0 otherwise
+    int mapped;          // 1 if data is a private file mapping (mmap_file)
 };
 
 // Array struct (dynamic array)
@@ -118,6 +122,7 @@ struct HmlArray {
     int ref_count;
     HmlValueType element_type;  // HML_VAL_NULL for untyped
     _Atomic int freed;   // Atomic flag: 1 if freed via free(), 0 otherwise
+    int gc_buffered;     // Index + 1 in the cycle collector's buffer, 0 = none
 };
 
 // Object struct (JavaScript-style)
@@ -129,6 +134,7 @@ struct HmlObject {
     int capacity;
     int ref_count;
     _Atomic int freed;   // Atomic flag: 1 if freed via free(), 0 otherwise
+    int gc_buffered;     // Index + 1 in the cycle collector's buffer, 0 = none
 };
 
 // Function struct (user-defined or closure)
@@ -149,6 +155,9 @@ struct HmlFileHandle {
     char *path;
     char *mode;
     int closed;
+    char *stdio_buf;        // Read buffer handed to setvbuf (NULL = stdio default)
+    char *line_buf;         // Reused by read_line() and lines()
+    size_t line_cap;
 };
 
 // Task (async)
@@ -199,6 +208,17 @@ struct HmlSocket {
     int nonblocking;        // 1 if in non-blocking mode
 };
 
+// Buffered writer (BufferedWriter from @stdlib/fs)
+struct HmlWriter {
+    char *data;             // Pending output
+    int length;             // Bytes pending
+    int capacity;
+    HmlFileHandle *file;    // Target file, or NULL to write to fd
+    int fd;                 // Target descriptor when file is NULL
+    int closed;             // 1 after close()
+    int ref_count;
+};
+
 // Type definition for duck typing
 typedef struct HmlTypeField {
     char *name;
@@ -250,6 +270,7 @@ void hml_function_set_name(HmlValue fn, const char *name);
 
 HmlValue hml_val_builtin_fn(HmlBuiltinFn fn);
 HmlValue hml_val_socket(HmlSocket *sock);
+HmlValue hml_val_writer(HmlWriter *writer);
 
 // ========== REFERENCE COUNTING ==========
 
@@ -461,7 +482,7 @@ static inline int hml_needs_refcount(HmlValue val) {
     return val.type == HML_VAL_STRING || val.type == HML_VAL_BUFFER ||
            val.type == HML_VAL_ARRAY || val.type == HML_VAL_OBJECT ||
            val.type == HML_VAL_FUNCTION || val.type == HML_VAL_TASK ||
-           val.type == HML_VAL_CHANNEL;
+           val.type == HML_VAL_CHANNEL || val.type == HML_VAL_WRITER;
 }
 
 // Fast path: array[i32] access (bounds checked, skip retain for primitives)
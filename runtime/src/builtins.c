@@ -16,6 +16,7 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
 #include <dirent.h>
@@ -156,6 +157,46 @@ void hml_runtime_init(int argc, char **argv) {
     g_argv = argv;
     g_exception_stack = NULL;
     g_defer_stack = NULL;
+    hml_heap_profiler_init();
+    hml_trace_init();
+
+    const char *stdout_env = getenv("HEMLOCK_STDOUT_BUFFER");
+    if (stdout_env && stdout_env[0]) {
+        int64_t size = hml_parse_size(stdout_env);
+        if (size > 0) {
+            hml_stdout_buffer(size);
+        }
+    }
+}
+
+// Set once stdout has its own buffer; print() then leaves flushing to stdio
+static int g_stdout_buffered = 0;
+
+void hml_stdout_buffer(int64_t size) {
+    // setvbuf ignores the size when stdio allocates the buffer itself
+    char *buf = malloc((size_t)size);
+    if (!buf) return;
+    int mode = isatty(STDOUT_FILENO) ? _IOLBF : _IOFBF;
+    if (setvbuf(stdout, buf, mode, (size_t)size) != 0) {
+        free(buf);
+        return;
+    }
+    g_stdout_buffered = 1;
+}
+
+int64_t hml_parse_size(const char *text) {
+    char *end;
+    errno = 0;
+    long long n = strtoll(text, &end, 10);
+    if (errno != 0 || end == text || n < 0) return -1;
+    switch (*end) {
+        case 'k': case 'K': n *= 1024LL; end++; break;
+        case 'm': case 'M': n *= 1024LL * 1024; end++; break;
+        case 'g': case 'G': n *= 1024LL * 1024 * 1024; end++; break;
+        default: break;
+    }
+    if (*end == 'b' || *end == 'B') end++;
+    return *end == '\0' ? (int64_t)n : -1;
 }
 
 void hml_runtime_cleanup(void) {
@@ -184,7 +225,7 @@ HmlValue hml_get_args(void) {
 // ========== UTF-8 ENCODING ==========
 
 // Encode a Unicode codepoint to UTF-8, returns the number of bytes written
-static int utf8_encode_rune(uint32_t codepoint, char *out) {
+int utf8_encode_rune(uint32_t codepoint, char *out) {
     if (codepoint < 0x80) {
         out[0] = (char)codepoint;
         return 1;
@@ -208,6 +249,30 @@ static int utf8_encode_rune(uint32_t codepoint, char *out) {
 
 // ========== PRINT IMPLEMENTATION ==========
 
+static void print_value_to(FILE *out, HmlValue val);
+
+// Print an array, showing one already on the path from the outermost array
+// as [...] so self-referencing arrays terminate
+static void print_array_to(FILE *out, HmlArray *arr, HmlVisitedSet *path) {
+    if (!hml_visited_add(path, arr)) {
+        fprintf(out, "[...]");
+        return;
+    }
+    fprintf(out, "[");
+    for (int i = 0; i < arr->length; i++) {
+        if (i > 0) fprintf(out, ", ");
+        // Print all elements consistently (no special quotes for strings)
+        HmlValue elem = arr->elements[i];
+        if (elem.type == HML_VAL_ARRAY && elem.as.as_array) {
+            print_array_to(out, elem.as.as_array, path);
+        } else {
+            print_value_to(out, elem);
+        }
+    }
+    fprintf(out, "]");
+    hml_visited_remove(path, arr);
+}
+
 // Helper to print a value to a file
 static void print_value_to(FILE *out, HmlValue val) {
     switch (val.type) {
@@ -276,13 +341,10 @@ static void print_value_to(FILE *out, HmlValue val) {
             break;
         case HML_VAL_ARRAY:
             if (val.as.as_array) {
-                fprintf(out, "[");
-                for (int i = 0; i < val.as.as_array->length; i++) {
-                    if (i > 0) fprintf(out, ", ");
-                    // Print all elements consistently (no special quotes for strings)
-                    print_value_to(out, val.as.as_array->elements[i]);
-                }
-                fprintf(out, "]");
+                HmlVisitedSet path;
+                hml_visited_init(&path);
+                print_array_to(out, val.as.as_array, &path);
+                hml_visited_destroy(&path);
             } else {
                 fprintf(out, "[]");
             }
@@ -306,6 +368,9 @@ static void print_value_to(FILE *out, HmlValue val) {
         case HML_VAL_FILE:
             fprintf(out, "<file>");
             break;
+        case HML_VAL_WRITER:
+            fprintf(out, "<writer>");
+            break;
         default:
             fprintf(out, "<unknown>");
             break;
@@ -314,8 +379,10 @@ static void print_value_to(FILE *out, HmlValue val) {
 
 void hml_print(HmlValue val) {
     print_value_to(stdout, val);
-    printf("\n");
-    fflush(stdout);
+    putchar('\n');
+    if (!g_stdout_buffered) {
+        fflush(stdout);
+    }
 }
 
 void hml_eprint(HmlValue val) {
@@ -815,6 +882,7 @@ done_warning:
     ccmd[cmd_str->length] = '\0';
 
     // Open pipe to read command output (uses shell - vulnerable to injection)
+    fflush(stdout);  // Keep buffered output ahead of anything the shell prints
     FILE *pipe = popen(ccmd, "r");
     if (!pipe) {
         fprintf(stderr, "Runtime error: Failed to execute command '%s': %s\n", ccmd, strerror(errno));
@@ -893,7 +961,7 @@ done_warning:
 
 // exec_argv() - Safe command execution without shell interpretation
 // Takes an array of strings: [program, arg1, arg2, ...]
-// Uses fork/execvp directly, preventing shell injection attacks
+// Spawns the program directly, preventing shell injection attacks
 HmlValue hml_exec_argv(HmlValue args_array) {
     // SANDBOX: Check if process spawning is allowed
     if (hml_sandbox_check(HML_SANDBOX_RESTRICT_PROCESS)) {
@@ -934,190 +1002,12 @@ HmlValue hml_exec_argv(HmlValue args_array) {
     }
     argv[arr->length] = NULL;
 
-    // Create pipes for stdout and stderr
-    int stdout_pipe[2];
-    int stderr_pipe[2];
-    if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0) {
-        for (int64_t i = 0; i < arr->length; i++) free(argv[i]);
-        free(argv);
-        hml_runtime_error("exec_argv() pipe creation failed: %s", strerror(errno));
-    }
-
-    pid_t pid = fork();
-    if (pid < 0) {
-        for (int64_t i = 0; i < arr->length; i++) free(argv[i]);
-        free(argv);
-        close(stdout_pipe[0]); close(stdout_pipe[1]);
-        close(stderr_pipe[0]); close(stderr_pipe[1]);
-        hml_runtime_error("exec_argv() fork failed: %s", strerror(errno));
-    }
-
-    if (pid == 0) {
-        // Child process
-        close(stdout_pipe[0]);  // Close read end
-        close(stderr_pipe[0]);
-        dup2(stdout_pipe[1], STDOUT_FILENO);
-        dup2(stderr_pipe[1], STDERR_FILENO);
-        close(stdout_pipe[1]);
-        close(stderr_pipe[1]);
-
-        execvp(argv[0], argv);
-        // If execvp returns, it failed
-        fprintf(stderr, "exec_argv() failed to execute '%s': %s\n", argv[0], strerror(errno));
-        _exit(127);
-    }
-
-    // Parent process
-    close(stdout_pipe[1]);  // Close write end
-    close(stderr_pipe[1]);
-
-    // Free argv in parent (child has its own copy after fork)
-    for (int64_t i = 0; i < arr->length; i++) free(argv[i]);
-    free(argv);
-
-    // Read output from child (both stdout and stderr using poll to avoid deadlock)
-    char *output_buffer = NULL;
-    size_t output_size = 0;
-    size_t output_capacity = 4096;
-    output_buffer = malloc(output_capacity);
-
-    char *stderr_buffer = NULL;
-    size_t stderr_size = 0;
-    size_t stderr_capacity = 4096;
-    stderr_buffer = malloc(stderr_capacity);
-
-    if (!output_buffer || !stderr_buffer) {
-        free(output_buffer);
-        free(stderr_buffer);
-        close(stdout_pipe[0]);
-        close(stderr_pipe[0]);
-        hml_runtime_error("exec_argv() memory allocation failed");
-    }
-
-    struct pollfd fds[2];
-    fds[0].fd = stdout_pipe[0];
-    fds[0].events = POLLIN;
-    fds[1].fd = stderr_pipe[0];
-    fds[1].events = POLLIN;
-
-    int open_fds = 2;
-    char chunk[4096];
-
-    while (open_fds > 0) {
-        int ret = poll(fds, 2, -1);
-        if (ret < 0) {
-            if (errno == EINTR) continue;
-            break;
-        }
-
-        // Read from stdout if available
-        if (fds[0].revents & (POLLIN | POLLHUP)) {
-            ssize_t bytes_read = read(stdout_pipe[0], chunk, sizeof(chunk));
-            if (bytes_read > 0) {
-                while (output_size + (size_t)bytes_read > output_capacity) {
-                    if (output_capacity > SIZE_MAX / 2) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec_argv() output too large");
-                    }
-                    output_capacity *= 2;
-                    char *new_buffer = realloc(output_buffer, output_capacity);
-                    if (!new_buffer) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec_argv() memory allocation failed");
-                    }
-                    output_buffer = new_buffer;
-                }
-                memcpy(output_buffer + output_size, chunk, (size_t)bytes_read);
-                output_size += (size_t)bytes_read;
-            } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                fds[0].fd = -1;  // Stop polling this fd
-                open_fds--;
-            }
-        }
-
-        // Read from stderr if available
-        if (fds[1].revents & (POLLIN | POLLHUP)) {
-            ssize_t bytes_read = read(stderr_pipe[0], chunk, sizeof(chunk));
-            if (bytes_read > 0) {
-                while (stderr_size + (size_t)bytes_read > stderr_capacity) {
-                    if (stderr_capacity > SIZE_MAX / 2) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec_argv() stderr too large");
-                    }
-                    stderr_capacity *= 2;
-                    char *new_buffer = realloc(stderr_buffer, stderr_capacity);
-                    if (!new_buffer) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec_argv() memory allocation failed");
-                    }
-                    stderr_buffer = new_buffer;
-                }
-                memcpy(stderr_buffer + stderr_size, chunk, (size_t)bytes_read);
-                stderr_size += (size_t)bytes_read;
-            } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                fds[1].fd = -1;  // Stop polling this fd
-                open_fds--;
-            }
-        }
-    }
-    close(stdout_pipe[0]);
-    close(stderr_pipe[0]);
-
-    // Wait for child
-    int status;
-    waitpid(pid, &status, 0);
-    int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
-
-    // Ensure null termination for stdout
-    if (output_size >= output_capacity) {
-        char *new_buffer = realloc(output_buffer, output_size + 1);
-        if (!new_buffer) {
-            free(output_buffer);
-            free(stderr_buffer);
-            hml_runtime_error("exec_argv() memory allocation failed");
-        }
-        output_buffer = new_buffer;
-    }
-    output_buffer[output_size] = '\0';
-
-    // Ensure null termination for stderr
-    if (stderr_size >= stderr_capacity) {
-        char *new_buffer = realloc(stderr_buffer, stderr_size + 1);
-        if (!new_buffer) {
-            free(output_buffer);
-            free(stderr_buffer);
-            hml_runtime_error("exec_argv() memory allocation failed");
-        }
-        stderr_buffer = new_buffer;
-    }
-    stderr_buffer[stderr_size] = '\0';
-
-    // Create result object
-    HmlValue result = hml_val_object();
-    hml_object_set_field(result, "output", hml_val_string(output_buffer));
-    hml_object_set_field(result, "stderr", hml_val_string(stderr_buffer));
-    hml_object_set_field(result, "exit_code", hml_val_i32(exit_code));
-    free(output_buffer);
-    free(stderr_buffer);
-
-    return result;
+    return hml_exec_capture(argv, "exec_argv");
 }
 
 // exec_with_args() - Safe command execution with separate command and args
 // Takes command string and array of string arguments
-// Uses fork/execvp directly, preventing shell injection attacks
+// Spawns the program directly, preventing shell injection attacks
 HmlValue hml_exec_with_args(HmlValue command, HmlValue args_array) {
     if (command.type != HML_VAL_STRING || !command.as.as_string) {
         hml_runtime_error("exec() first argument must be a string");
@@ -1164,185 +1054,7 @@ HmlValue hml_exec_with_args(HmlValue command, HmlValue args_array) {
     }
     argv[arr->length + 1] = NULL;
 
-    // Create pipes for stdout and stderr
-    int stdout_pipe[2];
-    int stderr_pipe[2];
-    if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0) {
-        for (int64_t i = 0; i <= arr->length; i++) free(argv[i]);
-        free(argv);
-        hml_runtime_error("exec() pipe creation failed: %s", strerror(errno));
-    }
-
-    pid_t pid = fork();
-    if (pid < 0) {
-        for (int64_t i = 0; i <= arr->length; i++) free(argv[i]);
-        free(argv);
-        close(stdout_pipe[0]); close(stdout_pipe[1]);
-        close(stderr_pipe[0]); close(stderr_pipe[1]);
-        hml_runtime_error("exec() fork failed: %s", strerror(errno));
-    }
-
-    if (pid == 0) {
-        // Child process
-        close(stdout_pipe[0]);  // Close read end
-        close(stderr_pipe[0]);
-        dup2(stdout_pipe[1], STDOUT_FILENO);
-        dup2(stderr_pipe[1], STDERR_FILENO);
-        close(stdout_pipe[1]);
-        close(stderr_pipe[1]);
-
-        execvp(argv[0], argv);
-        // If execvp returns, it failed
-        fprintf(stderr, "exec() failed to execute '%s': %s\n", argv[0], strerror(errno));
-        _exit(127);
-    }
-
-    // Parent process
-    close(stdout_pipe[1]);  // Close write end
-    close(stderr_pipe[1]);
-
-    // Free argv in parent (child has its own copy after fork)
-    for (int64_t i = 0; i <= arr->length; i++) free(argv[i]);
-    free(argv);
-
-    // Read output from child (both stdout and stderr using poll to avoid deadlock)
-    char *output_buffer = NULL;
-    size_t output_size = 0;
-    size_t output_capacity = 4096;
-    output_buffer = malloc(output_capacity);
-
-    char *stderr_buffer = NULL;
-    size_t stderr_size = 0;
-    size_t stderr_capacity = 4096;
-    stderr_buffer = malloc(stderr_capacity);
-
-    if (!output_buffer || !stderr_buffer) {
-        free(output_buffer);
-        free(stderr_buffer);
-        close(stdout_pipe[0]);
-        close(stderr_pipe[0]);
-        hml_runtime_error("exec() memory allocation failed");
-    }
-
-    struct pollfd fds[2];
-    fds[0].fd = stdout_pipe[0];
-    fds[0].events = POLLIN;
-    fds[1].fd = stderr_pipe[0];
-    fds[1].events = POLLIN;
-
-    int open_fds = 2;
-    char chunk[4096];
-
-    while (open_fds > 0) {
-        int ret = poll(fds, 2, -1);
-        if (ret < 0) {
-            if (errno == EINTR) continue;
-            break;
-        }
-
-        // Read from stdout if available
-        if (fds[0].revents & (POLLIN | POLLHUP)) {
-            ssize_t bytes_read = read(stdout_pipe[0], chunk, sizeof(chunk));
-            if (bytes_read > 0) {
-                while (output_size + (size_t)bytes_read > output_capacity) {
-                    if (output_capacity > SIZE_MAX / 2) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec() output too large");
-                    }
-                    output_capacity *= 2;
-                    char *new_buffer = realloc(output_buffer, output_capacity);
-                    if (!new_buffer) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec() memory allocation failed");
-                    }
-                    output_buffer = new_buffer;
-                }
-                memcpy(output_buffer + output_size, chunk, (size_t)bytes_read);
-                output_size += (size_t)bytes_read;
-            } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                fds[0].fd = -1;  // Stop polling this fd
-                open_fds--;
-            }
-        }
-
-        // Read from stderr if available
-        if (fds[1].revents & (POLLIN | POLLHUP)) {
-            ssize_t bytes_read = read(stderr_pipe[0], chunk, sizeof(chunk));
-            if (bytes_read > 0) {
-                while (stderr_size + (size_t)bytes_read > stderr_capacity) {
-                    if (stderr_capacity > SIZE_MAX / 2) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec() stderr too large");
-                    }
-                    stderr_capacity *= 2;
-                    char *new_buffer = realloc(stderr_buffer, stderr_capacity);
-                    if (!new_buffer) {
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        hml_runtime_error("exec() memory allocation failed");
-                    }
-                    stderr_buffer = new_buffer;
-                }
-                memcpy(stderr_buffer + stderr_size, chunk, (size_t)bytes_read);
-                stderr_size += (size_t)bytes_read;
-            } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                fds[1].fd = -1;  // Stop polling this fd
-                open_fds--;
-            }
-        }
-    }
-    close(stdout_pipe[0]);
-    close(stderr_pipe[0]);
-
-    // Wait for child
-    int status;
-    waitpid(pid, &status, 0);
-    int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
-
-    // Ensure null termination for stdout
-    if (output_size >= output_capacity) {
-        char *new_buffer = realloc(output_buffer, output_size + 1);
-        if (!new_buffer) {
-            free(output_buffer);
-            free(stderr_buffer);
-            hml_runtime_error("exec() memory allocation failed");
-        }
-        output_buffer = new_buffer;
-    }
-    output_buffer[output_size] = '\0';
-
-    // Ensure null termination for stderr
-    if (stderr_size >= stderr_capacity) {
-        char *new_buffer = realloc(stderr_buffer, stderr_size + 1);
-        if (!new_buffer) {
-            free(output_buffer);
-            free(stderr_buffer);
-            hml_runtime_error("exec() memory allocation failed");
-        }
-        stderr_buffer = new_buffer;
-    }
-    stderr_buffer[stderr_size] = '\0';
-
-    // Create result object
-    HmlValue result = hml_val_object();
-    hml_object_set_field(result, "output", hml_val_string(output_buffer));
-    hml_object_set_field(result, "stderr", hml_val_string(stderr_buffer));
-    hml_object_set_field(result, "exit_code", hml_val_i32(exit_code));
-    free(output_buffer);
-    free(stderr_buffer);
-
-    return result;
+    return hml_exec_capture(argv, "exec");
 }
 
 // Math operations moved to builtins_math.c
@@ -1429,6 +1141,8 @@ HmlValue hml_fork(void) {
         hml_sandbox_error("process forking");
     }
 
+    // Buffered output would otherwise be written by both processes
+    fflush(NULL);
     pid_t pid = fork();
     return hml_val_i32((int32_t)pid);
 }
@@ -1968,6 +1682,18 @@ static int encode_utf8(uint32_t cp, char *out) {
     }
 }
 
+// Grow a string's data to new_capacity; inline data moves out to the heap
+static char *string_grow_data(HmlString *s, int new_capacity) {
+    if (!HML_STRING_IS_INLINE(s)) {
+        return realloc(s->data, new_capacity);
+    }
+    char *data = malloc(new_capacity);
+    if (data) {
+        memcpy(data, s->data, s->length + 1);
+    }
+    return data;
+}
+
 // OPTIMIZATION: In-place string append for pattern "x = x + y"
 // If the left string has refcount == 1, we can mutate it in place
 // This turns O(n²) repeated concatenation into O(n) amortized
@@ -2003,7 +1729,7 @@ HmlValue hml_string_append_inplace(HmlValue *dest, HmlValue src) {
             if (new_capacity < new_len + 1) new_capacity = new_len + 1;
             if (new_capacity < 32) new_capacity = 32;
 
-            char *new_data = realloc(sd->data, new_capacity);
+            char *new_data = string_grow_data(sd, new_capacity);
             if (!new_data) {
                 HmlValue result = hml_string_concat(*dest, src);
                 hml_release(dest);
@@ -2039,7 +1765,7 @@ HmlValue hml_string_append_inplace(HmlValue *dest, HmlValue src) {
         if (new_capacity < new_len + 1) new_capacity = new_len + 1;
         if (new_capacity < 32) new_capacity = 32;  // Minimum capacity
 
-        char *new_data = realloc(sd->data, new_capacity);
+        char *new_data = string_grow_data(sd, new_capacity);
         if (!new_data) {
             // Allocation failed - fall back to regular concat
             if (src.type != HML_VAL_STRING) hml_release(&str_src);
@@ -2072,12 +1798,12 @@ HmlValue hml_string_concat(HmlValue a, HmlValue b) {
         HmlString *sb = b.as.as_string;
         int total = sa->length + sb->length;
 
-        char *result = malloc(total + 1);
-        memcpy(result, sa->data, sa->length);
-        memcpy(result + sa->length, sb->data, sb->length);
-        result[total] = '\0';
+        HmlString *result = hml_string_alloc(total);
+        memcpy(result->data, sa->data, sa->length);
+        memcpy(result->data + sa->length, sb->data, sb->length);
+        result->data[total] = '\0';
 
-        return hml_val_string_owned(result, total, total + 1);
+        return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = result };
     }
 
     // Convert both to strings
@@ -2253,24 +1979,32 @@ void hml_free(HmlValue ptr_or_buffer) {
         }
     } else if (ptr_or_buffer.type == HML_VAL_BUFFER) {
         if (ptr_or_buffer.as.as_buffer) {
-            if (ptr_or_buffer.as.as_buffer->data) {
-                free(ptr_or_buffer.as.as_buffer->data);
+            HML_HEAP_TRACK_FREE(ptr_or_buffer.as.as_buffer);
+            HmlBuffer *buf = ptr_or_buffer.as.as_buffer;
+            if (buf->mapped) {
+                munmap(buf->data, (size_t)buf->capacity);
+            } else if (buf->data) {
+                free(buf->data);
             }
-            free(ptr_or_buffer.as.as_buffer);
+            hml_slab_free(ptr_or_buffer.as.as_buffer, sizeof(HmlBuffer));
         }
     } else if (ptr_or_buffer.type == HML_VAL_ARRAY) {
         if (ptr_or_buffer.as.as_array) {
             HmlArray *arr = ptr_or_buffer.as.as_array;
+            HML_HEAP_TRACK_FREE(arr);
+            HML_GC_FORGET(arr, HML_GC_KIND_ARRAY);
             // Release all elements
             for (int i = 0; i < arr->length; i++) {
                 hml_release(&arr->elements[i]);
             }
             free(arr->elements);
-            free(arr);
+            hml_slab_free(arr, sizeof(HmlArray));
         }
     } else if (ptr_or_buffer.type == HML_VAL_OBJECT) {
         if (ptr_or_buffer.as.as_object) {
             HmlObject *obj = ptr_or_buffer.as.as_object;
+            HML_HEAP_TRACK_FREE(obj);
+            HML_GC_FORGET(obj, HML_GC_KIND_OBJECT);
             // Release all field values and free names
             for (int i = 0; i < obj->num_fields; i++) {
                 hml_release(&obj->field_values[i]);
@@ -2279,7 +2013,7 @@ void hml_free(HmlValue ptr_or_buffer) {
             free(obj->field_names);
             free(obj->field_values);
             if (obj->type_name) free(obj->type_name);
-            free(obj);
+            hml_slab_free(obj, sizeof(HmlObject));
         }
     } else if (ptr_or_buffer.type == HML_VAL_NULL) {
         // free(null) is a safe no-op (like C's free(NULL))
@@ -2605,6 +2339,7 @@ HmlExceptionContext* hml_exception_push(void) {
     HmlExceptionContext *ctx = malloc(sizeof(HmlExceptionContext));
     ctx->is_active = 1;
     ctx->exception_value = hml_val_null();
+    ctx->profile_depth = hml_g_profile_depth;
     ctx->prev = g_exception_stack;
     g_exception_stack = ctx;
     return ctx;
@@ -2630,9 +2365,30 @@ void hml_throw(HmlValue exception_value) {
 
     g_exception_stack->exception_value = exception_value;
     hml_retain(&g_exception_stack->exception_value);
+    // Frames unwound by the longjmp never run HML_PROFILE_EXIT
+    hml_g_profile_depth = g_exception_stack->profile_depth;
     longjmp(g_exception_stack->exception_buf, 1);
 }
 
+void hml_exception_enter(HmlExceptionContext *ctx) {
+    ctx->is_active = 1;
+    ctx->exception_value = hml_val_null();
+    ctx->profile_depth = hml_g_profile_depth;
+    ctx->prev = g_exception_stack;
+    g_exception_stack = ctx;
+}
+
+// Hands back the caught exception (null if none); the caller owns it
+HmlValue hml_exception_leave(HmlExceptionContext *ctx) {
+    while (g_exception_stack && g_exception_stack != ctx) {
+        hml_exception_pop();
+    }
+    if (g_exception_stack == ctx) {
+        g_exception_stack = ctx->prev;
+    }
+    return ctx->exception_value;
+}
+
 HmlValue hml_exception_get_value(void) {
     if (g_exception_stack) {
         HmlValue v = g_exception_stack->exception_value;
@@ -2729,6 +2485,56 @@ void hml_defer_push_call_with_args(HmlValue fn, HmlValue *args, int num_args) {
     hml_defer_push(hml_defer_call_with_args_wrapper, call);
 }
 
+void hml_defer_run(HmlValue callee, const char *method, HmlValue *args, int num_args) {
+    HmlValue result = method ? hml_call_method(callee, method, args, num_args)
+                             : hml_call_function(callee, args, num_args);
+    hml_release(&result);
+    hml_release(&callee);
+    for (int i = 0; i < num_args; i++) {
+        hml_release(&args[i]);
+    }
+}
+
+void hml_defer_list_push(HmlDeferList *list, HmlValue callee, const char *method,
+                         HmlValue *args, int num_args) {
+    if (list->count >= list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->calls = realloc(list->calls, sizeof(HmlDeferCall) * list->capacity);
+    }
+    if (list->num_values + num_args + 1 > list->values_capacity) {
+        int cap = list->values_capacity ? list->values_capacity * 2 : 16;
+        while (cap < list->num_values + num_args + 1) cap *= 2;
+        list->values = realloc(list->values, sizeof(HmlValue) * cap);
+        list->values_capacity = cap;
+    }
+    if (!list->calls || !list->values) {
+        hml_runtime_error("defer: memory allocation failed");
+    }
+    HmlDeferCall *call = &list->calls[list->count++];
+    call->method = method;
+    call->first = list->num_values;
+    call->num_args = num_args;
+    list->values[list->num_values++] = callee;
+    for (int i = 0; i < num_args; i++) {
+        list->values[list->num_values++] = args[i];
+    }
+}
+
+void hml_defer_list_run(HmlDeferList *list) {
+    while (list->count > 0) {
+        HmlDeferCall call = list->calls[--list->count];
+        list->num_values = call.first;
+        hml_defer_run(list->values[call.first], call.method,
+                      &list->values[call.first + 1], call.num_args);
+    }
+    free(list->calls);
+    free(list->values);
+    list->calls = NULL;
+    list->values = NULL;
+    list->capacity = 0;
+    list->values_capacity = 0;
+}
+
 // ========== FUNCTION CALLS ==========
 
 // Pre-created null value for fast padding (avoids repeated function calls)
@@ -3036,6 +2842,12 @@ HmlValue hml_call_method(HmlValue obj, const char *method, HmlValue *args, int n
         if (strcmp(method, "tell") == 0 && num_args == 0) {
             return hml_file_tell(obj);
         }
+        if (strcmp(method, "read_line") == 0 && num_args == 0) {
+            return hml_file_read_line(obj);
+        }
+        if (strcmp(method, "lines") == 0 && num_args == 0) {
+            return hml_file_lines(obj);
+        }
         if (strcmp(method, "close") == 0 && num_args == 0) {
             hml_file_close(obj);
             return hml_val_null();
@@ -3088,12 +2900,31 @@ HmlValue hml_call_method(HmlValue obj, const char *method, HmlValue *args, int n
         if (strcmp(method, "recv") == 0 && num_args == 1) {
             return hml_socket_recv(obj, args[0]);
         }
+        if (strcmp(method, "send_file") == 0 && num_args >= 1 && num_args <= 3) {
+            return hml_socket_send_file(obj, args[0],
+                                        num_args >= 2 ? args[1] : hml_val_null(),
+                                        num_args == 3 ? args[2] : hml_val_null());
+        }
         if (strcmp(method, "sendto") == 0 && num_args == 3) {
             return hml_socket_sendto(obj, args[0], args[1], args[2]);
         }
         if (strcmp(method, "recvfrom") == 0 && num_args == 1) {
             return hml_socket_recvfrom(obj, args[0]);
         }
+        if (strcmp(method, "recv_into") == 0 && num_args >= 1 && num_args <= 3) {
+            return hml_socket_recv_into(obj, args[0],
+                                        num_args >= 2 ? args[1] : hml_val_null(),
+                                        num_args == 3 ? args[2] : hml_val_null());
+        }
+        if (strcmp(method, "recv_many") == 0 && num_args == 2) {
+            return hml_socket_recv_many(obj, args[0], args[1]);
+        }
+        if (strcmp(method, "send_many") == 0 && num_args == 1) {
+            return hml_socket_send_many(obj, args[0]);
+        }
+        if (strcmp(method, "send_parts") == 0 && num_args == 1) {
+            return hml_socket_send_parts(obj, args[0]);
+        }
         if (strcmp(method, "setsockopt") == 0 && num_args == 3) {
             hml_socket_setsockopt(obj, args[0], args[1], args[2]);
             return hml_val_null();
@@ -3113,6 +2944,11 @@ HmlValue hml_call_method(HmlValue obj, const char *method, HmlValue *args, int n
         hml_runtime_error("Socket has no method '%s'", method);
     }
 
+    // Handle buffered writer methods
+    if (obj.type == HML_VAL_WRITER) {
+        return hml_writer_method(obj, method, args, num_args);
+    }
+
     // Handle object methods
     if (obj.type != HML_VAL_OBJECT || !obj.as.as_object) {
         hml_runtime_error("Cannot call method '%s' on non-object (type: %s)",
@@ -3159,6 +2995,45 @@ HmlValue hml_call_method(HmlValue obj, const char *method, HmlValue *args, int n
 
 // ========== FILE I/O ==========
 
+// stdio buffer for files opened for reading; read_line() scans it with memchr
+#define HML_FILE_READ_BUFFER_SIZE (64 * 1024)
+
+// Wrap an open stream as a file value
+static HmlValue hml_file_wrap(FILE *fp, const char *path, const char *mode) {
+    HmlFileHandle *fh = malloc(sizeof(HmlFileHandle));
+    fh->fp = fp;
+    fh->path = strdup(path);
+    fh->mode = strdup(mode);
+    fh->closed = 0;
+    fh->stdio_buf = NULL;
+    fh->line_buf = NULL;
+    fh->line_cap = 0;
+
+    // Larger reads mean fewer syscalls for read_line() and lines()
+    if (mode[0] == 'r') {
+        fh->stdio_buf = malloc(HML_FILE_READ_BUFFER_SIZE);
+        if (fh->stdio_buf && setvbuf(fp, fh->stdio_buf, _IOFBF, HML_FILE_READ_BUFFER_SIZE) != 0) {
+            free(fh->stdio_buf);
+            fh->stdio_buf = NULL;
+        }
+    }
+
+    HmlValue result;
+    result.type = HML_VAL_FILE;
+    result.as.as_file = fh;
+    return result;
+}
+
+// Wrap a descriptor (such as a pipe end) as a file value; closing the file
+// closes fd. Returns null with errno set if fd cannot be opened as a stream.
+HmlValue hml_file_from_fd(int fd, const char *mode, const char *name) {
+    FILE *fp = fdopen(fd, mode);
+    if (!fp) {
+        return hml_val_null();
+    }
+    return hml_file_wrap(fp, name, mode);
+}
+
 HmlValue hml_open(HmlValue path, HmlValue mode) {
     if (path.type != HML_VAL_STRING) {
         fprintf(stderr, "Error: open() expects string path\n");
@@ -3190,16 +3065,7 @@ HmlValue hml_open(HmlValue path, HmlValue mode) {
         exit(1);
     }
 
-    HmlFileHandle *fh = malloc(sizeof(HmlFileHandle));
-    fh->fp = fp;
-    fh->path = strdup(path_str);
-    fh->mode = strdup(mode_str);
-    fh->closed = 0;
-
-    HmlValue result;
-    result.type = HML_VAL_FILE;
-    result.as.as_file = fh;
-    return result;
+    return hml_file_wrap(fp, path_str, mode_str);
 }
 
 HmlValue hml_file_read(HmlValue file, HmlValue size) {
@@ -3386,7 +3252,137 @@ void hml_file_close(HmlValue file) {
     if (!fh->closed) {
         fclose((FILE*)fh->fp);
         fh->closed = 1;
+        free(fh->stdio_buf);
+        fh->stdio_buf = NULL;
+        free(fh->line_buf);
+        fh->line_buf = NULL;
+        fh->line_cap = 0;
+    }
+}
+
+// Read the next line into the handle's line buffer, without the trailing
+// "\n" or "\r\n". Returns the line length, or -1 at end of file.
+static long file_next_line(HmlFileHandle *fh) {
+    ssize_t read = getdelim(&fh->line_buf, &fh->line_cap, '\n', (FILE*)fh->fp);
+    if (read == -1) {
+        if (ferror((FILE*)fh->fp)) {
+            hml_runtime_error("Read error on file '%s': %s", fh->path, strerror(errno));
+        }
+        return -1;
+    }
+    if (read > 0 && fh->line_buf[read - 1] == '\n') read--;
+    if (read > 0 && fh->line_buf[read - 1] == '\r') read--;
+    if (read > INT_MAX - 1) {
+        hml_runtime_error("Line too long in file '%s'", fh->path);
+    }
+    return (long)read;
+}
+
+static HmlValue file_line_value(HmlFileHandle *fh, int length) {
+    HmlString *str = hml_string_alloc(length);
+    if (length > 0) memcpy(str->data, fh->line_buf, length);
+    str->data[length] = '\0';
+    HmlValue result;
+    result.type = HML_VAL_STRING;
+    result.as.as_string = str;
+    return result;
+}
+
+HmlValue hml_file_read_line(HmlValue file) {
+    if (file.type != HML_VAL_FILE) {
+        hml_runtime_error("read_line() expects file object");
+    }
+    HmlFileHandle *fh = file.as.as_file;
+    if (fh->closed) {
+        hml_runtime_error("Cannot read from closed file '%s'", fh->path);
+    }
+
+    long len = file_next_line(fh);
+    if (len < 0) return hml_val_null();
+    return file_line_value(fh, (int)len);
+}
+
+HmlValue hml_file_lines(HmlValue file) {
+    if (file.type != HML_VAL_FILE) {
+        hml_runtime_error("lines() expects file object");
+    }
+    HmlFileHandle *fh = file.as.as_file;
+    if (fh->closed) {
+        hml_runtime_error("Cannot read from closed file '%s'", fh->path);
+    }
+
+    HmlValue lines = hml_val_array();
+    long len;
+    while ((len = file_next_line(fh)) >= 0) {
+        HmlValue line = file_line_value(fh, (int)len);
+        hml_array_push(lines, line);
+        hml_release(&line);
+    }
+    return lines;
+}
+
+// A whole file as a private, writable buffer. Writes are copy-on-write: they
+// change only the buffer and never reach the file.
+HmlValue hml_mmap_file(HmlValue path) {
+    if (path.type != HML_VAL_STRING) {
+        hml_runtime_error("mmap_file() expects 1 string argument (path)");
+    }
+    const char *path_str = path.as.as_string->data;
+
+    if (!hml_sandbox_path_allowed(path_str, 0)) {
+        hml_sandbox_error("file read outside sandbox root");
+    }
+
+    int fd = open(path_str, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        hml_runtime_error("Failed to open '%s': %s", path_str, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        hml_runtime_error("Failed to stat '%s': %s", path_str, strerror(err));
+    }
+    if (!S_ISREG(st.st_mode)) {
+        close(fd);
+        hml_runtime_error("mmap_file() requires a regular file: '%s'", path_str);
+    }
+    if (st.st_size > INT_MAX) {
+        close(fd);
+        hml_runtime_error("File '%s' is too large to map (limit is 2GB)", path_str);
+    }
+
+    int size = (int)st.st_size;
+    void *data;
+    int mapped = 0;
+    if (size == 0) {
+        // Zero-length mappings are not allowed
+        data = malloc(1);
+    } else {
+        data = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            hml_runtime_error("Failed to map '%s': %s", path_str, strerror(err));
+        }
+        posix_madvise(data, (size_t)size, POSIX_MADV_SEQUENTIAL);
+        mapped = 1;
     }
+    close(fd);
+
+    HmlBuffer *buf = hml_slab_alloc(sizeof(HmlBuffer));
+    buf->data = data;
+    buf->length = size;
+    buf->capacity = size;
+    buf->ref_count = 1;
+    atomic_store(&buf->freed, 0);
+    buf->mapped = mapped;
+    HML_HEAP_TRACK_ALLOC(buf, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer));
+
+    HmlValue result;
+    result.type = HML_VAL_BUFFER;
+    result.as.as_buffer = buf;
+    return result;
 }
 
 HmlValue hml_file_read_bytes(HmlValue file, HmlValue size) {
@@ -3413,12 +3409,14 @@ HmlValue hml_file_read_bytes(HmlValue file, HmlValue size) {
 
     if (read_size <= 0) {
         // Return empty buffer
-        HmlBuffer *buf = malloc(sizeof(HmlBuffer));
+        HmlBuffer *buf = hml_slab_alloc(sizeof(HmlBuffer));
         buf->data = malloc(1);
         buf->length = 0;
         buf->capacity = 0;
         buf->ref_count = 1;
         atomic_store(&buf->freed, 0);
+        buf->mapped = 0;
+        HML_HEAP_TRACK_ALLOC(buf, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer) + (size_t)buf->capacity);
         return (HmlValue){ .type = HML_VAL_BUFFER, .as.as_buffer = buf };
     }
 
@@ -3436,12 +3434,14 @@ HmlValue hml_file_read_bytes(HmlValue file, HmlValue size) {
         exit(1);
     }
 
-    HmlBuffer *buf = malloc(sizeof(HmlBuffer));
+    HmlBuffer *buf = hml_slab_alloc(sizeof(HmlBuffer));
     buf->data = data;
     buf->length = (int)bytes_read;
     buf->capacity = read_size;
     buf->ref_count = 1;
     atomic_store(&buf->freed, 0);
+    buf->mapped = 0;
+    HML_HEAP_TRACK_ALLOC(buf, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer) + (size_t)buf->capacity);
 
     return (HmlValue){ .type = HML_VAL_BUFFER, .as.as_buffer = buf };
 }
@@ -3883,35 +3883,32 @@ HmlValue hml_copy_file(HmlValue src_path, HmlValue dest_path) {
         exit(1);
     }
 
-    FILE *src_fp = fopen(src_path.as.as_string->data, "rb");
-    if (!src_fp) {
+    int src_fd = open(src_path.as.as_string->data, O_RDONLY | O_CLOEXEC);
+    if (src_fd < 0) {
         fprintf(stderr, "Error: Failed to open source '%s': %s\n",
             src_path.as.as_string->data, strerror(errno));
         exit(1);
     }
 
-    FILE *dest_fp = fopen(dest_path.as.as_string->data, "wb");
-    if (!dest_fp) {
-        fclose(src_fp);
+    int dest_fd = open(dest_path.as.as_string->data, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (dest_fd < 0) {
+        close(src_fd);
         fprintf(stderr, "Error: Failed to open destination '%s': %s\n",
             dest_path.as.as_string->data, strerror(errno));
         exit(1);
     }
 
-    char buffer[8192];
-    size_t n;
-    while ((n = fread(buffer, 1, sizeof(buffer), src_fp)) > 0) {
-        if (fwrite(buffer, 1, n, dest_fp) != n) {
-            fclose(src_fp);
-            fclose(dest_fp);
-            fprintf(stderr, "Error: Failed to write to '%s': %s\n",
-                dest_path.as.as_string->data, strerror(errno));
-            exit(1);
-        }
+    // Copy in the kernel where possible (see file_transfer.c)
+    if (hml_fd_copy(src_fd, dest_fd) < 0 || close(dest_fd) != 0) {
+        int err = errno;
+        close(src_fd);
+        close(dest_fd);
+        fprintf(stderr, "Error: Failed to write to '%s': %s\n",
+            dest_path.as.as_string->data, strerror(err));
+        exit(1);
     }
 
-    fclose(src_fp);
-    fclose(dest_fp);
+    close(src_fd);
     return hml_val_null();
 }
 
@@ -4954,6 +4951,7 @@ HmlValue hml_builtin_string_from_bytes(HmlClosureEnv *env, HmlValue arg) {
 #ifdef HML_HAVE_LIBWEBSOCKETS
 
 #include <libwebsockets.h>
+#include <pthread.h>
 
 // HTTP response structure
 typedef struct {
@@ -5541,6 +5539,746 @@ HmlValue hml_lws_response_body_binary(HmlValue resp_val) {
     return buf;
 }
 
+// ========== POOLED HTTP CLIENT ==========
+//
+// An HttpClient owns one lws context and one service thread. Every request
+// made through it runs on that thread, so TLS sessions cached by the
+// context are reused and several requests can be on the wire at once.
+// Requests are pipelined onto an idle kept-alive connection to their host
+// when there is one (LCCSCF_PIPELINE). At most max_per_host run against a
+// host at a time; the rest wait in the client's queue.
+//
+// A streamed request (__lws_http_stream_open) hands its body to the reader
+// in chunks instead of collecting it. Once HML_HTTP_STREAM_HIGH_WATER bytes are
+// queued the connection stops reading (lws_rx_flow_control) until the
+// reader drains the queue below HML_HTTP_STREAM_LOW_WATER, so a download of any
+// size holds at most about a megabyte.
+//
+// Each wait - for a response, for a stream's headers, or for the next piece
+// of a streamed body - gives up after the client's timeout_ms.
+
+#define HML_HTTP_STREAM_HIGH_WATER (1024 * 1024)
+#define HML_HTTP_STREAM_LOW_WATER (256 * 1024)
+
+typedef struct hml_http_client hml_http_client_t;
+
+typedef struct hml_http_host {
+    char name[256];
+    int port;
+    int ssl;
+    int active;                 // Requests started and not yet finished
+    struct hml_http_host *next;
+} hml_http_host_t;
+
+typedef struct hml_http_chunk {
+    size_t len;
+    size_t offset;              // Bytes already handed to the reader
+    struct hml_http_chunk *next;
+    char data[];
+} hml_http_chunk_t;
+
+typedef struct hml_http_job {
+    hml_http_client_t *client;
+    hml_http_host_t *host;
+    char path[512];
+    char method[16];
+    char *body;
+    size_t body_len;
+    char *content_type;
+    hml_http_response_t *resp;
+    int connecting;             // Inside lws_client_connect_via_info()
+    int body_sent;
+    int done;
+    int abandoned;              // The waiter gave up; whoever finishes frees it
+    struct hml_http_job *next;      // Pending queue link
+
+    // Streamed requests only
+    int streaming;
+    int headers_ready;
+    int paused;                 // Reading is off until the reader catches up
+    int cancelled;              // The reader closed the stream early
+    int readers;                // Threads waiting in __lws_http_stream_read()
+    struct lws *wsi;            // Service thread only
+    hml_http_chunk_t *chunks_head;
+    hml_http_chunk_t *chunks_tail;
+    size_t queued;
+    struct hml_http_job *stream_next;  // Link in the client's live streams
+} hml_http_job_t;
+
+struct hml_http_client {
+    struct lws_context *context;
+    pthread_t service_thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t done_cond;
+    volatile int shutdown;
+    int max_per_host;
+    int timeout_ms;                 // Limit on each wait for response data
+    hml_http_job_t *pending_head;
+    hml_http_job_t *pending_tail;
+    hml_http_job_t *streams;        // Streamed requests still on the wire
+    hml_http_host_t *hosts;
+};
+
+static void hml_http_response_free(hml_http_response_t *resp) {
+    if (!resp) return;
+    free(resp->body);
+    free(resp->redirect_url);
+    free(resp->headers);
+    free(resp);
+}
+
+static void hml_http_job_free(hml_http_job_t *job) {
+    hml_http_chunk_t *chunk = job->chunks_head;
+    while (chunk) {
+        hml_http_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    hml_http_response_free(job->resp);
+    free(job->body);
+    free(job->content_type);
+    free(job);
+}
+
+// Called on the service thread once a request has a final outcome
+static void hml_http_job_finish(hml_http_job_t *job, struct lws *wsi) {
+    if (wsi) {
+        // Later callbacks for this transaction must not touch the job
+        lws_set_wsi_user(wsi, NULL);
+    }
+    hml_http_client_t *client = job->client;
+    pthread_mutex_lock(&client->mutex);
+    if (job->done) {
+        pthread_mutex_unlock(&client->mutex);
+        return;
+    }
+    job->done = 1;
+    job->host->active--;
+    if (job->streaming) {
+        job->wsi = NULL;
+        hml_http_job_t **link = &client->streams;
+        while (*link && *link != job) link = &(*link)->stream_next;
+        if (*link) *link = job->stream_next;
+    }
+    int release = job->abandoned && !job->connecting;
+    pthread_cond_broadcast(&client->done_cond);
+    pthread_mutex_unlock(&client->mutex);
+    if (release) {
+        hml_http_job_free(job);
+    }
+    // A slot on this host is free again
+    if (!client->shutdown) {
+        lws_cancel_service(client->context);
+    }
+}
+
+// Start every queued request whose host is below its connection limit
+static void hml_http_client_start_pending(hml_http_client_t *client) {
+    for (;;) {
+        pthread_mutex_lock(&client->mutex);
+        hml_http_job_t *prev = NULL;
+        hml_http_job_t *job = client->pending_head;
+        while (job && job->host->active >= client->max_per_host) {
+            prev = job;
+            job = job->next;
+        }
+        if (!job || client->shutdown) {
+            pthread_mutex_unlock(&client->mutex);
+            return;
+        }
+        if (prev) prev->next = job->next;
+        else client->pending_head = job->next;
+        if (client->pending_tail == job) client->pending_tail = prev;
+        job->next = NULL;
+        // The first request to a host may reuse an idle kept-alive
+        // connection; requests beyond it open connections of their own
+        int reuse = job->host->active == 0;
+        job->host->active++;
+        job->connecting = 1;
+        if (job->streaming) {
+            job->stream_next = client->streams;
+            client->streams = job;
+        }
+        pthread_mutex_unlock(&client->mutex);
+
+        struct lws_client_connect_info connect_info;
+        memset(&connect_info, 0, sizeof(connect_info));
+        connect_info.context = client->context;
+        connect_info.address = job->host->name;
+        connect_info.port = job->host->port;
+        connect_info.path = job->path;
+        connect_info.host = job->host->name;
+        connect_info.origin = job->host->name;
+        connect_info.method = job->method;
+        connect_info.protocol = "http";
+        connect_info.userdata = job;
+
+        // Redirects are followed at the hemlock layer
+        connect_info.ssl_connection = LCCSCF_HTTP_NO_FOLLOW_REDIRECT;
+        if (reuse) {
+            connect_info.ssl_connection |= LCCSCF_PIPELINE;
+        }
+        if (job->host->ssl) {
+            connect_info.ssl_connection |= LCCSCF_USE_SSL;
+        }
+
+        struct lws *wsi = lws_client_connect_via_info(&connect_info);
+
+        pthread_mutex_lock(&client->mutex);
+        job->connecting = 0;
+        int finished = job->done;
+        int release = finished && job->abandoned;
+        pthread_mutex_unlock(&client->mutex);
+        if (release) {
+            hml_http_job_free(job);
+        } else if (!wsi && !finished) {
+            job->resp->failed = 1;
+            hml_http_job_finish(job, NULL);
+        }
+    }
+}
+
+// Queue a received chunk for the reader; stop reading when it falls behind
+static int hml_http_stream_push(hml_http_job_t *job, struct lws *wsi, const void *data, size_t len) {
+    hml_http_client_t *client = job->client;
+    hml_http_chunk_t *chunk = malloc(sizeof(hml_http_chunk_t) + len);
+    if (!chunk) {
+        job->resp->failed = 1;
+        return -1;
+    }
+    memcpy(chunk->data, data, len);
+    chunk->len = len;
+    chunk->offset = 0;
+    chunk->next = NULL;
+
+    job->wsi = wsi;
+    pthread_mutex_lock(&client->mutex);
+    // The reader sets cancelled under the mutex from its own thread
+    if (job->cancelled) {
+        pthread_mutex_unlock(&client->mutex);
+        free(chunk);
+        return -1;
+    }
+    if (job->chunks_tail) job->chunks_tail->next = chunk;
+    else job->chunks_head = chunk;
+    job->chunks_tail = chunk;
+    job->queued += len;
+    if (job->queued >= HML_HTTP_STREAM_HIGH_WATER && !job->paused) {
+        job->paused = 1;
+        lws_rx_flow_control(wsi, 0);
+    }
+    pthread_cond_broadcast(&client->done_cond);
+    pthread_mutex_unlock(&client->mutex);
+    return 0;
+}
+
+// Resume streams whose reader caught up and drop those it closed
+static void hml_http_client_service_streams(hml_http_client_t *client) {
+    pthread_mutex_lock(&client->mutex);
+    for (hml_http_job_t *job = client->streams; job; job = job->stream_next) {
+        if (!job->wsi) continue;
+        if (job->cancelled) {
+            lws_set_timeout(job->wsi, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_ASYNC);
+        } else if (job->paused && job->queued <= HML_HTTP_STREAM_LOW_WATER) {
+            job->paused = 0;
+            lws_rx_flow_control(job->wsi, 1);
+        }
+    }
+    pthread_mutex_unlock(&client->mutex);
+}
+
+static int hml_http_client_callback(struct lws *wsi, enum lws_callback_reasons reason,
+                                void *user, void *in, size_t len) {
+    hml_http_job_t *job = (hml_http_job_t *)user;
+
+    switch (reason) {
+        case LWS_CALLBACK_EVENT_WAIT_CANCELLED: {
+            // Woken by a submit, a finished request or a stream reader
+            hml_http_client_t *client = (hml_http_client_t *)lws_context_user(lws_get_context(wsi));
+            if (client) {
+                hml_http_client_service_streams(client);
+                hml_http_client_start_pending(client);
+            }
+            return 0;
+        }
+
+        case LWS_CALLBACK_ESTABLISHED_CLIENT_HTTP:
+            if (!job) return 0;
+            hml_http_callback(wsi, reason, job->resp, in, len);
+            if (job->streaming) {
+                job->wsi = wsi;
+                pthread_mutex_lock(&job->client->mutex);
+                job->headers_ready = 1;
+                pthread_cond_broadcast(&job->client->done_cond);
+                pthread_mutex_unlock(&job->client->mutex);
+            }
+            return 0;
+
+        case LWS_CALLBACK_RECEIVE_CLIENT_HTTP_READ:
+            if (job && job->streaming) {
+                return hml_http_stream_push(job, wsi, in, len);
+            }
+            return hml_http_callback(wsi, reason, job ? job->resp : NULL, in, len);
+
+        case LWS_CALLBACK_CLIENT_APPEND_HANDSHAKE_HEADER:
+            if (!job) return 0;
+            hml_http_callback(wsi, reason, job->resp, in, len);
+            if (job->body_len > 0) {
+                unsigned char **p = (unsigned char **)in;
+                unsigned char *end = (*p) + len;
+                char length[32];
+                snprintf(length, sizeof(length), "%zu", job->body_len);
+                if (lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_CONTENT_TYPE,
+                        (unsigned char *)job->content_type, (int)strlen(job->content_type), p, end) ||
+                    lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_CONTENT_LENGTH,
+                        (unsigned char *)length, (int)strlen(length), p, end)) {
+                    return -1;
+                }
+                lws_client_http_body_pending(wsi, 1);
+                lws_callback_on_writable(wsi);
+            }
+            return 0;
+
+        case LWS_CALLBACK_CLIENT_HTTP_WRITEABLE:
+            if (job && job->body_len > 0 && !job->body_sent) {
+                unsigned char *buf = malloc(LWS_PRE + job->body_len);
+                if (!buf) return -1;
+                memcpy(buf + LWS_PRE, job->body, job->body_len);
+                job->body_sent = 1;
+                lws_client_http_body_pending(wsi, 0);
+                int n = lws_write(wsi, buf + LWS_PRE, job->body_len, LWS_WRITE_HTTP_FINAL);
+                free(buf);
+                if (n < 0) return -1;
+            }
+            return 0;
+
+        case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+        case LWS_CALLBACK_COMPLETED_CLIENT_HTTP:
+        case LWS_CALLBACK_CLOSED_CLIENT_HTTP:
+            if (!job) return 0;
+            hml_http_callback(wsi, reason, job->resp, in, len);
+            hml_http_job_finish(job, wsi);
+            return 0;
+
+        default:
+            return hml_http_callback(wsi, reason, job ? job->resp : NULL, in, len);
+    }
+}
+
+static void *hml_http_client_service_thread(void *arg) {
+    hml_http_client_t *client = (hml_http_client_t *)arg;
+    while (!client->shutdown) {
+        lws_service(client->context, 50);
+    }
+    return NULL;
+}
+
+static hml_http_host_t *hml_http_client_host(hml_http_client_t *client, const char *name, int port, int ssl) {
+    for (hml_http_host_t *host = client->hosts; host; host = host->next) {
+        if (host->port == port && host->ssl == ssl && strcmp(host->name, name) == 0) {
+            return host;
+        }
+    }
+    hml_http_host_t *host = calloc(1, sizeof(hml_http_host_t));
+    if (!host) return NULL;
+    snprintf(host->name, sizeof(host->name), "%s", name);
+    host->port = port;
+    host->ssl = ssl;
+    host->next = client->hosts;
+    client->hosts = host;
+    return host;
+}
+
+// When a wait that starts now times out
+static void hml_http_client_deadline(hml_http_client_t *client, struct timespec *deadline) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += client->timeout_ms / 1000;
+    deadline->tv_nsec += (long)(client->timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+// __lws_http_client_new(max_per_host: i32, timeout_ms: i32): ptr
+HmlValue hml_lws_http_client_new(HmlValue max_per_host, HmlValue timeout_ms) {
+    if (!hml_is_integer(max_per_host) || !hml_is_integer(timeout_ms)) {
+        hml_runtime_error("__lws_http_client_new() expects 2 integer arguments (max_per_host, timeout_ms)");
+    }
+    if (hml_to_i32(timeout_ms) <= 0) {
+        hml_runtime_error("HttpClient timeout_ms must be positive");
+    }
+
+    hml_http_client_t *client = calloc(1, sizeof(hml_http_client_t));
+    if (!client) {
+        hml_runtime_error("Failed to allocate HTTP client");
+    }
+    client->max_per_host = hml_to_i32(max_per_host);
+    if (client->max_per_host < 1) client->max_per_host = 1;
+    client->timeout_ms = hml_to_i32(timeout_ms);
+
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.options = LWS_SERVER_OPTION_DO_SSL_GLOBAL_INIT;
+    info.port = CONTEXT_PORT_NO_LISTEN;
+    info.max_http_header_data = 16384;
+    info.user = client;
+
+    static const struct lws_protocols protocols[] = {
+        { "http", hml_http_client_callback, 0, 16384, 0, NULL, 0 },
+        { NULL, NULL, 0, 0, 0, NULL, 0 }
+    };
+    info.protocols = protocols;
+
+    client->context = lws_create_context(&info);
+    if (!client->context) {
+        free(client);
+        hml_runtime_error("Failed to create libwebsockets context");
+    }
+
+    pthread_mutex_init(&client->mutex, NULL);
+    pthread_cond_init(&client->done_cond, NULL);
+    if (pthread_create(&client->service_thread, NULL, hml_http_client_service_thread, client) != 0) {
+        lws_context_destroy(client->context);
+        pthread_mutex_destroy(&client->mutex);
+        pthread_cond_destroy(&client->done_cond);
+        free(client);
+        hml_runtime_error("Failed to start HTTP client thread");
+    }
+
+    return hml_val_ptr(client);
+}
+
+// Build a request and put it on the client's queue; NULL with *error set on failure
+static hml_http_job_t *hml_http_client_queue(hml_http_client_t *client, const char *method, const char *url,
+                                     const char *body, size_t body_len, const char *content_type,
+                                     int streaming, const char **error) {
+    char host[256], path[512];
+    int port, ssl;
+
+    if (strlen(method) >= sizeof(((hml_http_job_t *)0)->method)) {
+        *error = "HTTP method too long";
+        return NULL;
+    }
+    if (hml_parse_url(url, host, &port, path, &ssl) < 0) {
+        *error = "Invalid URL format";
+        return NULL;
+    }
+
+    *error = "Failed to allocate request";
+    hml_http_job_t *job = calloc(1, sizeof(hml_http_job_t));
+    hml_http_response_t *resp = calloc(1, sizeof(hml_http_response_t));
+    if (!job || !resp) {
+        free(job);
+        free(resp);
+        return NULL;
+    }
+    job->client = client;
+    job->resp = resp;
+    job->streaming = streaming;
+    snprintf(job->path, sizeof(job->path), "%s", path);
+    snprintf(job->method, sizeof(job->method), "%s", method);
+    job->body_len = body_len;
+    job->body = body_len > 0 ? strndup(body, body_len) : NULL;
+    job->content_type = strdup(content_type);
+    resp->body_capacity = 4096;
+    resp->body = malloc(resp->body_capacity);
+    if ((body_len > 0 && !job->body) || !job->content_type || !resp->body) {
+        hml_http_job_free(job);
+        return NULL;
+    }
+    resp->body[0] = '\0';
+
+    pthread_mutex_lock(&client->mutex);
+    job->host = hml_http_client_host(client, host, port, ssl);
+    if (!job->host || client->shutdown) {
+        if (client->shutdown) *error = "HTTP client is closed";
+        pthread_mutex_unlock(&client->mutex);
+        hml_http_job_free(job);
+        return NULL;
+    }
+    if (client->pending_tail) client->pending_tail->next = job;
+    else client->pending_head = job;
+    client->pending_tail = job;
+    pthread_mutex_unlock(&client->mutex);
+
+    // The service thread starts it from LWS_CALLBACK_EVENT_WAIT_CANCELLED
+    lws_cancel_service(client->context);
+    return job;
+}
+
+// Give up on an unfinished request: a queued one is freed now, one on the
+// wire is freed by the service thread when it finishes. Called with the
+// client's mutex held; releases it.
+static void hml_http_job_abandon(hml_http_job_t *job) {
+    hml_http_client_t *client = job->client;
+    hml_http_job_t *prev = NULL;
+    hml_http_job_t *it = client->pending_head;
+    while (it && it != job) {
+        prev = it;
+        it = it->next;
+    }
+    if (it) {
+        if (prev) prev->next = job->next;
+        else client->pending_head = job->next;
+        if (client->pending_tail == job) client->pending_tail = prev;
+        pthread_mutex_unlock(&client->mutex);
+        hml_http_job_free(job);
+        return;
+    }
+    job->abandoned = 1;
+    pthread_mutex_unlock(&client->mutex);
+}
+
+// __lws_http_client_submit(client, method, url, body, content_type): ptr
+// Queues a request and returns at once; __lws_http_client_wait() collects it
+HmlValue hml_lws_http_client_submit(HmlValue client_val, HmlValue method_val, HmlValue url_val,
+                                    HmlValue body_val, HmlValue content_type_val) {
+    if (client_val.type != HML_VAL_PTR || !client_val.as.as_ptr ||
+        method_val.type != HML_VAL_STRING || url_val.type != HML_VAL_STRING ||
+        body_val.type != HML_VAL_STRING || content_type_val.type != HML_VAL_STRING) {
+        hml_runtime_error("__lws_http_client_submit() expects (client, method, url, body, content_type)");
+    }
+
+    const char *error;
+    hml_http_job_t *job = hml_http_client_queue((hml_http_client_t *)client_val.as.as_ptr,
+                                                method_val.as.as_string->data, url_val.as.as_string->data,
+                                                body_val.as.as_string->data, body_val.as.as_string->length,
+                                                content_type_val.as.as_string->data, 0, &error);
+    if (!job) {
+        hml_runtime_error("%s", error);
+    }
+    return hml_val_ptr(job);
+}
+
+// __lws_http_client_wait(request: ptr): ptr
+// Blocks until a submitted request finishes; returns a response for the
+// __lws_response_* accessors
+HmlValue hml_lws_http_client_wait(HmlValue job_val) {
+    if (job_val.type != HML_VAL_PTR || !job_val.as.as_ptr) {
+        hml_runtime_error("__lws_http_client_wait() expects 1 argument (request)");
+    }
+
+    hml_http_job_t *job = (hml_http_job_t *)job_val.as.as_ptr;
+    hml_http_client_t *client = job->client;
+
+    struct timespec deadline;
+    hml_http_client_deadline(client, &deadline);
+
+    pthread_mutex_lock(&client->mutex);
+    int rc = 0;
+    while (!job->done && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&client->done_cond, &client->mutex, &deadline);
+    }
+    if (!job->done) {
+        hml_http_job_abandon(job);
+        hml_runtime_error("HTTP request failed or timed out");
+    }
+    pthread_mutex_unlock(&client->mutex);
+
+    hml_http_response_t *resp = job->resp;
+    job->resp = NULL;
+    hml_http_job_free(job);
+    if (resp->failed) {
+        hml_http_response_free(resp);
+        hml_runtime_error("HTTP request failed or timed out");
+    }
+    return hml_val_ptr(resp);
+}
+
+// Free a closed stream, or leave it to the service thread if it is still on
+// the wire. Called with the client's mutex held; releases it.
+static void hml_http_stream_free(hml_http_job_t *job) {
+    hml_http_client_t *client = job->client;
+    if (job->done) {
+        pthread_mutex_unlock(&client->mutex);
+        hml_http_job_free(job);
+        return;
+    }
+    hml_http_job_abandon(job);
+    lws_cancel_service(client->context);
+}
+
+// Stop a streamed request. A reader blocked on another thread is woken and
+// frees the job on its way out; otherwise it is freed here.
+static void hml_http_stream_release(hml_http_job_t *job) {
+    hml_http_client_t *client = job->client;
+    pthread_mutex_lock(&client->mutex);
+    job->cancelled = 1;
+    if (job->readers > 0) {
+        pthread_cond_broadcast(&client->done_cond);
+        pthread_mutex_unlock(&client->mutex);
+        lws_cancel_service(client->context);
+        return;
+    }
+    hml_http_stream_free(job);
+}
+
+// __lws_http_stream_open(client, method, url, body, content_type): object
+// Starts a streamed request and waits for its response headers. Returns
+// { handle, status_code, headers, redirect }
+HmlValue hml_lws_http_stream_open(HmlValue client_val, HmlValue method_val, HmlValue url_val,
+                                  HmlValue body_val, HmlValue content_type_val) {
+    if (client_val.type != HML_VAL_PTR || !client_val.as.as_ptr ||
+        method_val.type != HML_VAL_STRING || url_val.type != HML_VAL_STRING ||
+        body_val.type != HML_VAL_STRING || content_type_val.type != HML_VAL_STRING) {
+        hml_runtime_error("__lws_http_stream_open() expects (client, method, url, body, content_type)");
+    }
+
+    hml_http_client_t *client = (hml_http_client_t *)client_val.as.as_ptr;
+    const char *error;
+    hml_http_job_t *job = hml_http_client_queue(client, method_val.as.as_string->data, url_val.as.as_string->data,
+                                                body_val.as.as_string->data, body_val.as.as_string->length,
+                                                content_type_val.as.as_string->data, 1, &error);
+    if (!job) {
+        hml_runtime_error("%s", error);
+    }
+
+    struct timespec deadline;
+    hml_http_client_deadline(client, &deadline);
+
+    pthread_mutex_lock(&client->mutex);
+    int rc = 0;
+    while (!job->headers_ready && !job->done && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&client->done_cond, &client->mutex, &deadline);
+    }
+    int ready = job->headers_ready && !job->resp->failed;
+    pthread_mutex_unlock(&client->mutex);
+    if (!ready) {
+        hml_http_stream_release(job);
+        hml_runtime_error("HTTP request failed or timed out");
+    }
+
+    // Headers are written once, before headers_ready is set
+    hml_http_response_t *resp = job->resp;
+    HmlValue result = hml_val_object();
+    HmlValue handle = hml_val_ptr(job);
+    HmlValue status = hml_val_i32(resp->status_code);
+    HmlValue headers = hml_val_string(resp->headers ? resp->headers : "");
+    HmlValue redirect = resp->redirect_url ? hml_val_string(resp->redirect_url) : hml_val_null();
+    hml_object_set_field(result, "handle", handle);
+    hml_object_set_field(result, "status_code", status);
+    hml_object_set_field(result, "headers", headers);
+    hml_object_set_field(result, "redirect", redirect);
+    hml_release(&headers);
+    hml_release(&redirect);
+    return result;
+}
+
+// __lws_http_stream_read(handle: ptr, max: i32): buffer
+// Waits for body data and returns up to max bytes; an empty buffer means
+// the body is complete
+HmlValue hml_lws_http_stream_read(HmlValue handle_val, HmlValue max_val) {
+    if (handle_val.type != HML_VAL_PTR || !handle_val.as.as_ptr || !hml_is_integer(max_val)) {
+        hml_runtime_error("__lws_http_stream_read() expects (handle, max)");
+    }
+
+    hml_http_job_t *job = (hml_http_job_t *)handle_val.as.as_ptr;
+    hml_http_client_t *client = job->client;
+    int max = hml_to_i32(max_val);
+    if (max <= 0) {
+        hml_runtime_error("__lws_http_stream_read() max must be positive");
+    }
+
+    struct timespec deadline;
+    hml_http_client_deadline(client, &deadline);
+
+    pthread_mutex_lock(&client->mutex);
+    int rc = 0;
+    job->readers++;
+    while (!job->chunks_head && !job->done && !job->cancelled && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&client->done_cond, &client->mutex, &deadline);
+    }
+    job->readers--;
+    if (job->cancelled) {
+        // Closed while waiting; the last reader out frees the job
+        if (job->readers == 0) {
+            hml_http_stream_free(job);
+        } else {
+            pthread_mutex_unlock(&client->mutex);
+        }
+        hml_runtime_error("HTTP body stream is closed");
+    }
+    if (!job->chunks_head && (!job->done || job->resp->failed)) {
+        pthread_mutex_unlock(&client->mutex);
+        hml_runtime_error("HTTP request failed or timed out");
+    }
+
+    size_t len = job->queued < (size_t)max ? job->queued : (size_t)max;
+    HmlValue result = hml_val_buffer((int)len);
+    char *data = (char *)result.as.as_buffer->data;
+    size_t copied = 0;
+    while (copied < len) {
+        hml_http_chunk_t *chunk = job->chunks_head;
+        size_t take = chunk->len - chunk->offset;
+        if (take > len - copied) take = len - copied;
+        memcpy(data + copied, chunk->data + chunk->offset, take);
+        copied += take;
+        chunk->offset += take;
+        if (chunk->offset == chunk->len) {
+            job->chunks_head = chunk->next;
+            if (!job->chunks_head) job->chunks_tail = NULL;
+            free(chunk);
+        }
+    }
+    job->queued -= len;
+    int resume = job->paused && job->queued <= HML_HTTP_STREAM_LOW_WATER;
+    pthread_mutex_unlock(&client->mutex);
+    if (resume) {
+        lws_cancel_service(client->context);
+    }
+    return result;
+}
+
+// __lws_http_stream_close(handle: ptr): null
+// Drops the rest of the body; safe to call after the body is complete
+HmlValue hml_lws_http_stream_close(HmlValue handle_val) {
+    if (handle_val.type != HML_VAL_PTR) {
+        hml_runtime_error("__lws_http_stream_close() expects 1 argument (handle)");
+    }
+    if (handle_val.as.as_ptr) {
+        hml_http_stream_release((hml_http_job_t *)handle_val.as.as_ptr);
+    }
+    return hml_val_null();
+}
+
+// __lws_http_client_close(client: ptr): null
+// Closes the client's connections; call once no requests are outstanding
+HmlValue hml_lws_http_client_close(HmlValue client_val) {
+    if (client_val.type != HML_VAL_PTR) {
+        hml_runtime_error("__lws_http_client_close() expects 1 argument (client)");
+    }
+
+    hml_http_client_t *client = (hml_http_client_t *)client_val.as.as_ptr;
+    if (!client) return hml_val_null();
+
+    pthread_mutex_lock(&client->mutex);
+    client->shutdown = 1;
+    hml_http_job_t *pending = client->pending_head;
+    client->pending_head = client->pending_tail = NULL;
+    pthread_mutex_unlock(&client->mutex);
+
+    lws_cancel_service(client->context);
+    pthread_join(client->service_thread, NULL);
+    lws_context_destroy(client->context);
+
+    while (pending) {
+        hml_http_job_t *next = pending->next;
+        hml_http_job_free(pending);
+        pending = next;
+    }
+    hml_http_host_t *host = client->hosts;
+    while (host) {
+        hml_http_host_t *next = host->next;
+        free(host);
+        host = next;
+    }
+    pthread_mutex_destroy(&client->mutex);
+    pthread_cond_destroy(&client->done_cond);
+    free(client);
+    return hml_val_null();
+}
+
 // Builtin wrappers
 HmlValue hml_builtin_lws_http_get(HmlClosureEnv *env, HmlValue url) {
     (void)env;
@@ -5557,6 +6295,43 @@ HmlValue hml_builtin_lws_http_request(HmlClosureEnv *env, HmlValue method, HmlVa
     return hml_lws_http_request(method, url, body, content_type);
 }
 
+HmlValue hml_builtin_lws_http_client_new(HmlClosureEnv *env, HmlValue max_per_host, HmlValue timeout_ms) {
+    (void)env;
+    return hml_lws_http_client_new(max_per_host, timeout_ms);
+}
+
+HmlValue hml_builtin_lws_http_client_submit(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url,
+                                            HmlValue body, HmlValue content_type) {
+    (void)env;
+    return hml_lws_http_client_submit(client, method, url, body, content_type);
+}
+
+HmlValue hml_builtin_lws_http_client_wait(HmlClosureEnv *env, HmlValue request) {
+    (void)env;
+    return hml_lws_http_client_wait(request);
+}
+
+HmlValue hml_builtin_lws_http_client_close(HmlClosureEnv *env, HmlValue client) {
+    (void)env;
+    return hml_lws_http_client_close(client);
+}
+
+HmlValue hml_builtin_lws_http_stream_open(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url,
+                                          HmlValue body, HmlValue content_type) {
+    (void)env;
+    return hml_lws_http_stream_open(client, method, url, body, content_type);
+}
+
+HmlValue hml_builtin_lws_http_stream_read(HmlClosureEnv *env, HmlValue handle, HmlValue max) {
+    (void)env;
+    return hml_lws_http_stream_read(handle, max);
+}
+
+HmlValue hml_builtin_lws_http_stream_close(HmlClosureEnv *env, HmlValue handle) {
+    (void)env;
+    return hml_lws_http_stream_close(handle);
+}
+
 HmlValue hml_builtin_lws_response_status(HmlClosureEnv *env, HmlValue resp) {
     (void)env;
     return hml_lws_response_status(resp);
@@ -6337,6 +7112,43 @@ HmlValue hml_lws_http_request(HmlValue method_val, HmlValue url_val, HmlValue bo
     hml_runtime_error("HTTP support not available (libwebsockets not installed)");
 }
 
+HmlValue hml_lws_http_client_new(HmlValue max_per_host, HmlValue timeout_ms) {
+    (void)max_per_host; (void)timeout_ms;
+    hml_runtime_error("HTTP support not available (libwebsockets not installed)");
+}
+
+HmlValue hml_lws_http_client_submit(HmlValue client, HmlValue method, HmlValue url,
+                                    HmlValue body, HmlValue content_type) {
+    (void)client; (void)method; (void)url; (void)body; (void)content_type;
+    hml_runtime_error("HTTP support not available (libwebsockets not installed)");
+}
+
+HmlValue hml_lws_http_client_wait(HmlValue request) {
+    (void)request;
+    hml_runtime_error("HTTP support not available (libwebsockets not installed)");
+}
+
+HmlValue hml_lws_http_client_close(HmlValue client) {
+    (void)client;
+    return hml_val_null();
+}
+
+HmlValue hml_lws_http_stream_open(HmlValue client, HmlValue method, HmlValue url,
+                                  HmlValue body, HmlValue content_type) {
+    (void)client; (void)method; (void)url; (void)body; (void)content_type;
+    hml_runtime_error("HTTP support not available (libwebsockets not installed)");
+}
+
+HmlValue hml_lws_http_stream_read(HmlValue handle, HmlValue max) {
+    (void)handle; (void)max;
+    hml_runtime_error("HTTP support not available (libwebsockets not installed)");
+}
+
+HmlValue hml_lws_http_stream_close(HmlValue handle) {
+    (void)handle;
+    return hml_val_null();
+}
+
 HmlValue hml_lws_response_status(HmlValue resp_val) {
     (void)resp_val;
     hml_runtime_error("HTTP support not available (libwebsockets not installed)");
@@ -6382,6 +7194,43 @@ HmlValue hml_builtin_lws_http_request(HmlClosureEnv *env, HmlValue method, HmlVa
     return hml_lws_http_request(method, url, body, content_type);
 }
 
+HmlValue hml_builtin_lws_http_client_new(HmlClosureEnv *env, HmlValue max_per_host, HmlValue timeout_ms) {
+    (void)env;
+    return hml_lws_http_client_new(max_per_host, timeout_ms);
+}
+
+HmlValue hml_builtin_lws_http_client_submit(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url,
+                                            HmlValue body, HmlValue content_type) {
+    (void)env;
+    return hml_lws_http_client_submit(client, method, url, body, content_type);
+}
+
+HmlValue hml_builtin_lws_http_client_wait(HmlClosureEnv *env, HmlValue request) {
+    (void)env;
+    return hml_lws_http_client_wait(request);
+}
+
+HmlValue hml_builtin_lws_http_client_close(HmlClosureEnv *env, HmlValue client) {
+    (void)env;
+    return hml_lws_http_client_close(client);
+}
+
+HmlValue hml_builtin_lws_http_stream_open(HmlClosureEnv *env, HmlValue client, HmlValue method, HmlValue url,
+                                          HmlValue body, HmlValue content_type) {
+    (void)env;
+    return hml_lws_http_stream_open(client, method, url, body, content_type);
+}
+
+HmlValue hml_builtin_lws_http_stream_read(HmlClosureEnv *env, HmlValue handle, HmlValue max) {
+    (void)env;
+    return hml_lws_http_stream_read(handle, max);
+}
+
+HmlValue hml_builtin_lws_http_stream_close(HmlClosureEnv *env, HmlValue handle) {
+    (void)env;
+    return hml_lws_http_stream_close(handle);
+}
+
 HmlValue hml_builtin_lws_response_status(HmlClosureEnv *env, HmlValue resp) {
     (void)env;
     return hml_lws_response_status(resp);
@@ -254,13 +254,15 @@ HmlValue hml_array_slice(HmlValue arr, HmlValue start, HmlValue end) {
     if (s > e) s = e;
 
     int new_len = e - s;
-    HmlArray *result = malloc(sizeof(HmlArray));
+    HmlArray *result = hml_slab_alloc(sizeof(HmlArray));
     result->ref_count = 1;
     result->length = new_len;
     result->capacity = (new_len > 0) ? new_len : 1;
     result->elements = malloc(result->capacity * sizeof(HmlValue));
     result->element_type = HML_VAL_NULL;
     atomic_store(&result->freed, 0);  // Not freed
+    result->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(result, HML_HEAP_KIND_ARRAY, sizeof(HmlArray) + (size_t)result->capacity * sizeof(HmlValue));
 
     for (int i = 0; i < new_len; i++) {
         result->elements[i] = a->elements[s + i];
@@ -329,13 +331,15 @@ HmlValue hml_array_concat(HmlValue arr1, HmlValue arr2) {
     HmlArray *a2 = arr2.as.as_array;
     int new_len = a1->length + a2->length;
 
-    HmlArray *result = malloc(sizeof(HmlArray));
+    HmlArray *result = hml_slab_alloc(sizeof(HmlArray));
     result->ref_count = 1;
     result->length = new_len;
     result->capacity = (new_len > 0) ? new_len : 1;
     result->elements = malloc(result->capacity * sizeof(HmlValue));
     result->element_type = HML_VAL_NULL;
     atomic_store(&result->freed, 0);  // Not freed
+    result->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(result, HML_HEAP_KIND_ARRAY, sizeof(HmlArray) + (size_t)result->capacity * sizeof(HmlValue));
 
     for (int i = 0; i < a1->length; i++) {
         result->elements[i] = a1->elements[i];
@@ -75,6 +75,8 @@ static void* task_thread_wrapper(void* arg) {
     pthread_mutex_lock((pthread_mutex_t*)task->mutex);
     task->state = HML_TASK_RUNNING;
     pthread_mutex_unlock((pthread_mutex_t*)task->mutex);
+    hml_trace_thread_start("task", task->id);
+    uint64_t trace_start_ns = HML_TRACE_NOW();
 
     // Get function info
     HmlFunction *fn = task->function.as.as_function;
@@ -83,6 +85,7 @@ static void* task_thread_wrapper(void* arg) {
 
     // Call function with arguments using libffi (supports unlimited arguments)
     HmlValue result = call_hemlock_function_ffi(fn_ptr, closure_env, task->args, task->num_args);
+    HML_TRACE_SPAN("task", "run", trace_start_ns, "task", task->id);
 
     // Store result and mark as completed
     pthread_mutex_lock((pthread_mutex_t*)task->mutex);
@@ -91,6 +94,7 @@ static void* task_thread_wrapper(void* arg) {
     pthread_cond_signal((pthread_cond_t*)task->cond);
     pthread_mutex_unlock((pthread_mutex_t*)task->mutex);
 
+    hml_gc_task_finished();
     return NULL;
 }
 
@@ -136,7 +140,9 @@ HmlValue hml_spawn(HmlValue fn, HmlValue *args, int num_args) {
 
     // Create thread
     task->thread = malloc(sizeof(pthread_t));
+    hml_gc_task_started();
     pthread_create((pthread_t*)task->thread, NULL, task_thread_wrapper, task);
+    HML_TRACE_INSTANT_EVENT("task", "spawn", "task", task->id);
 
     // Return task value
     HmlValue result;
@@ -161,6 +167,7 @@ HmlValue hml_join(HmlValue task_val) {
     }
 
     // Wait for task to complete
+    uint64_t trace_start_ns = HML_TRACE_NOW();
     pthread_mutex_lock((pthread_mutex_t*)task->mutex);
     while (task->state != HML_TASK_COMPLETED) {
         pthread_cond_wait((pthread_cond_t*)task->cond, (pthread_mutex_t*)task->mutex);
@@ -170,6 +177,7 @@ HmlValue hml_join(HmlValue task_val) {
     // Join the thread
     pthread_join(*(pthread_t*)task->thread, NULL);
     task->joined = 1;
+    HML_TRACE_SPAN("task", "join", trace_start_ns, "task", task->id);
 
     // Return result (retained)
     HmlValue result = task->result;
@@ -194,6 +202,7 @@ void hml_detach(HmlValue task_val) {
 
     task->detached = 1;
     pthread_detach(*(pthread_t*)task->thread);
+    HML_TRACE_INSTANT_EVENT("task", "detach", "task", task->id);
 }
 
 // task_debug_info(task) - Print debug information about a task
@@ -282,7 +291,7 @@ HmlValue hml_channel(int32_t capacity) {
     return result;
 }
 
-void hml_channel_send(HmlValue channel, HmlValue value) {
+static void channel_send(HmlValue channel, HmlValue value) {
     if (channel.type != HML_VAL_CHANNEL) {
         hml_runtime_error("send() expects a channel");
     }
@@ -307,9 +316,12 @@ void hml_channel_send(HmlValue channel, HmlValue value) {
         pthread_cond_signal((pthread_cond_t*)ch->not_empty);
 
         // Wait for receiver to pick up the value
+        uint64_t blocked_at = 0;
         while (ch->sender_waiting && !ch->closed) {
+            HML_TRACE_BLOCK_BEGIN(blocked_at);
             pthread_cond_wait((pthread_cond_t*)ch->rendezvous, (pthread_mutex_t*)ch->mutex);
         }
+        HML_TRACE_BLOCK_END(blocked_at, ch);
 
         // Check if we were woken because channel closed
         if (ch->closed && ch->sender_waiting) {
@@ -325,9 +337,12 @@ void hml_channel_send(HmlValue channel, HmlValue value) {
     }
 
     // Buffered channel - wait while buffer is full
+    uint64_t blocked_at = 0;
     while (ch->count >= ch->capacity && !ch->closed) {
+        HML_TRACE_BLOCK_BEGIN(blocked_at);
         pthread_cond_wait((pthread_cond_t*)ch->not_full, (pthread_mutex_t*)ch->mutex);
     }
+    HML_TRACE_BLOCK_END(blocked_at, ch);
 
     // Check again if closed after waking up
     if (ch->closed) {
@@ -345,7 +360,13 @@ void hml_channel_send(HmlValue channel, HmlValue value) {
     pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
 }
 
-HmlValue hml_channel_recv(HmlValue channel) {
+void hml_channel_send(HmlValue channel, HmlValue value) {
+    uint64_t trace_start_ns = HML_TRACE_NOW();
+    channel_send(channel, value);
+    HML_TRACE_CHANNEL_SPAN("send", trace_start_ns, channel.as.as_channel);
+}
+
+static HmlValue channel_recv(HmlValue channel) {
     if (channel.type != HML_VAL_CHANNEL) {
         hml_runtime_error("recv() expects a channel");
     }
@@ -357,9 +378,12 @@ HmlValue hml_channel_recv(HmlValue channel) {
     if (ch->capacity == 0) {
         // Unbuffered channel - rendezvous with sender
         // Wait for sender to have data available
+        uint64_t blocked_at = 0;
         while (!ch->sender_waiting && !ch->closed) {
+            HML_TRACE_BLOCK_BEGIN(blocked_at);
             pthread_cond_wait((pthread_cond_t*)ch->not_empty, (pthread_mutex_t*)ch->mutex);
         }
+        HML_TRACE_BLOCK_END(blocked_at, ch);
 
         // If channel is closed and no sender waiting, return null
         if (!ch->sender_waiting && ch->closed) {
@@ -380,9 +404,12 @@ HmlValue hml_channel_recv(HmlValue channel) {
     }
 
     // Buffered channel - wait while buffer is empty
+    uint64_t blocked_at = 0;
     while (ch->count == 0 && !ch->closed) {
+        HML_TRACE_BLOCK_BEGIN(blocked_at);
         pthread_cond_wait((pthread_cond_t*)ch->not_empty, (pthread_mutex_t*)ch->mutex);
     }
+    HML_TRACE_BLOCK_END(blocked_at, ch);
 
     if (ch->count == 0 && ch->closed) {
         pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
@@ -400,8 +427,15 @@ HmlValue hml_channel_recv(HmlValue channel) {
     return value;
 }
 
+HmlValue hml_channel_recv(HmlValue channel) {
+    uint64_t trace_start_ns = HML_TRACE_NOW();
+    HmlValue result = channel_recv(channel);
+    HML_TRACE_CHANNEL_SPAN("recv", trace_start_ns, channel.as.as_channel);
+    return result;
+}
+
 // channel.recv_timeout(timeout_ms) - receive with timeout, returns null on timeout
-HmlValue hml_channel_recv_timeout(HmlValue channel, HmlValue timeout_val) {
+static HmlValue channel_recv_timeout(HmlValue channel, HmlValue timeout_val) {
     if (channel.type != HML_VAL_CHANNEL) {
         hml_runtime_error("recv_timeout() expects a channel");
     }
@@ -424,14 +458,18 @@ HmlValue hml_channel_recv_timeout(HmlValue channel, HmlValue timeout_val) {
     if (ch->capacity == 0) {
         // Unbuffered channel with timeout - rendezvous with sender
         // Wait for sender to have data available (with timeout)
+        uint64_t blocked_at = 0;
         while (!ch->sender_waiting && !ch->closed) {
+            HML_TRACE_BLOCK_BEGIN(blocked_at);
             int rc = pthread_cond_timedwait((pthread_cond_t*)ch->not_empty,
                                             (pthread_mutex_t*)ch->mutex, &deadline);
             if (rc == ETIMEDOUT) {
                 pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+                HML_TRACE_BLOCK_END(blocked_at, ch);
                 return hml_val_null();  // Timeout
             }
         }
+        HML_TRACE_BLOCK_END(blocked_at, ch);
 
         // If channel is closed and no sender waiting, return null
         if (!ch->sender_waiting && ch->closed) {
@@ -452,14 +490,18 @@ HmlValue hml_channel_recv_timeout(HmlValue channel, HmlValue timeout_val) {
     }
 
     // Buffered channel - wait while buffer is empty
+    uint64_t blocked_at = 0;
     while (ch->count == 0 && !ch->closed) {
+        HML_TRACE_BLOCK_BEGIN(blocked_at);
         int rc = pthread_cond_timedwait((pthread_cond_t*)ch->not_empty,
                                         (pthread_mutex_t*)ch->mutex, &deadline);
         if (rc == ETIMEDOUT) {
             pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+            HML_TRACE_BLOCK_END(blocked_at, ch);
             return hml_val_null();  // Timeout
         }
     }
+    HML_TRACE_BLOCK_END(blocked_at, ch);
 
     if (ch->count == 0 && ch->closed) {
         pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
@@ -477,8 +519,15 @@ HmlValue hml_channel_recv_timeout(HmlValue channel, HmlValue timeout_val) {
     return value;
 }
 
+HmlValue hml_channel_recv_timeout(HmlValue channel, HmlValue timeout_val) {
+    uint64_t trace_start_ns = HML_TRACE_NOW();
+    HmlValue result = channel_recv_timeout(channel, timeout_val);
+    HML_TRACE_CHANNEL_SPAN("recv_timeout", trace_start_ns, channel.as.as_channel);
+    return result;
+}
+
 // channel.send_timeout(value, timeout_ms) - send with timeout, returns bool (true if sent)
-HmlValue hml_channel_send_timeout(HmlValue channel, HmlValue value, HmlValue timeout_val) {
+static HmlValue channel_send_timeout(HmlValue channel, HmlValue value, HmlValue timeout_val) {
     if (channel.type != HML_VAL_CHANNEL) {
         hml_runtime_error("send_timeout() expects a channel");
     }
@@ -514,7 +563,9 @@ HmlValue hml_channel_send_timeout(HmlValue channel, HmlValue value, HmlValue tim
         pthread_cond_signal((pthread_cond_t*)ch->not_empty);
 
         // Wait for receiver to pick up the value (with timeout)
+        uint64_t blocked_at = 0;
         while (ch->sender_waiting && !ch->closed) {
+            HML_TRACE_BLOCK_BEGIN(blocked_at);
             int rc = pthread_cond_timedwait((pthread_cond_t*)ch->rendezvous,
                                             (pthread_mutex_t*)ch->mutex, &deadline);
             if (rc == ETIMEDOUT) {
@@ -523,9 +574,11 @@ HmlValue hml_channel_send_timeout(HmlValue channel, HmlValue value, HmlValue tim
                 hml_release(ch->unbuffered_value);
                 *(ch->unbuffered_value) = hml_val_null();
                 pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+                HML_TRACE_BLOCK_END(blocked_at, ch);
                 return hml_val_bool(0);  // Timeout - send failed
             }
         }
+        HML_TRACE_BLOCK_END(blocked_at, ch);
 
         // Check if we were woken because channel closed
         if (ch->closed && ch->sender_waiting) {
@@ -541,14 +594,18 @@ HmlValue hml_channel_send_timeout(HmlValue channel, HmlValue value, HmlValue tim
     }
 
     // Buffered channel - wait while buffer is full
+    uint64_t blocked_at = 0;
     while (ch->count >= ch->capacity && !ch->closed) {
+        HML_TRACE_BLOCK_BEGIN(blocked_at);
         int rc = pthread_cond_timedwait((pthread_cond_t*)ch->not_full,
                                         (pthread_mutex_t*)ch->mutex, &deadline);
         if (rc == ETIMEDOUT) {
             pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
+            HML_TRACE_BLOCK_END(blocked_at, ch);
             return hml_val_bool(0);  // Timeout - send failed
         }
     }
+    HML_TRACE_BLOCK_END(blocked_at, ch);
 
     // Check again if closed after waking up
     if (ch->closed) {
@@ -568,7 +625,14 @@ HmlValue hml_channel_send_timeout(HmlValue channel, HmlValue value, HmlValue tim
     return hml_val_bool(1);  // Success
 }
 
-void hml_channel_close(HmlValue channel) {
+HmlValue hml_channel_send_timeout(HmlValue channel, HmlValue value, HmlValue timeout_val) {
+    uint64_t trace_start_ns = HML_TRACE_NOW();
+    HmlValue result = channel_send_timeout(channel, value, timeout_val);
+    HML_TRACE_CHANNEL_SPAN("send_timeout", trace_start_ns, channel.as.as_channel);
+    return result;
+}
+
+static void channel_close(HmlValue channel) {
     if (channel.type != HML_VAL_CHANNEL) {
         return;
     }
@@ -585,6 +649,12 @@ void hml_channel_close(HmlValue channel) {
     pthread_mutex_unlock((pthread_mutex_t*)ch->mutex);
 }
 
+void hml_channel_close(HmlValue channel) {
+    uint64_t trace_start_ns = HML_TRACE_NOW();
+    channel_close(channel);
+    HML_TRACE_CHANNEL_SPAN("close", trace_start_ns, channel.as.as_channel);
+}
+
 // select(channels, timeout_ms?) - wait on multiple channels
 HmlValue hml_select(HmlValue channels, HmlValue timeout) {
     if (channels.type != HML_VAL_ARRAY) {
@@ -624,6 +694,7 @@ HmlValue hml_select(HmlValue channels, HmlValue timeout) {
     }
 
     // Polling loop
+    uint64_t trace_start_ns = HML_TRACE_NOW();
     while (1) {
         // Check each channel for available data
         for (int i = 0; i < arr->length; i++) {
@@ -647,6 +718,7 @@ HmlValue hml_select(HmlValue channels, HmlValue timeout) {
                 HmlValue result = hml_val_object();
                 hml_object_set_field(result, "channel", arr->elements[i]);
                 hml_object_set_field(result, "value", msg);
+                HML_TRACE_SPAN("channel", "select", trace_start_ns, "channels", arr->length);
                 return result;
             }
 
@@ -657,6 +729,7 @@ HmlValue hml_select(HmlValue channels, HmlValue timeout) {
                 HmlValue result = hml_val_object();
                 hml_object_set_field(result, "channel", arr->elements[i]);
                 hml_object_set_field(result, "value", hml_val_null());
+                HML_TRACE_SPAN("channel", "select", trace_start_ns, "channels", arr->length);
                 return result;
             }
 
@@ -669,6 +742,7 @@ HmlValue hml_select(HmlValue channels, HmlValue timeout) {
             clock_gettime(CLOCK_REALTIME, &now);
             if (now.tv_sec > deadline_ptr->tv_sec ||
                 (now.tv_sec == deadline_ptr->tv_sec && now.tv_nsec >= deadline_ptr->tv_nsec)) {
+                HML_TRACE_SPAN("channel", "select", trace_start_ns, "channels", arr->length);
                 return hml_val_null();  // Timeout
             }
         }
@@ -467,7 +467,7 @@ HmlValue hml_builtin_hash_md5(HmlClosureEnv *env, HmlValue input) {
 
 // Helper: Create an object with keypair fields
 static HmlValue create_keypair_object(void *pkey) {
-    HmlObject *obj = malloc(sizeof(HmlObject));
+    HmlObject *obj = hml_slab_alloc(sizeof(HmlObject));
     obj->type_name = NULL;
     obj->capacity = 2;
     obj->field_names = malloc(sizeof(char*) * 2);
@@ -475,6 +475,8 @@ static HmlValue create_keypair_object(void *pkey) {
     obj->num_fields = 0;
     obj->ref_count = 1;
     atomic_store(&obj->freed, 0);
+    obj->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(obj, HML_HEAP_KIND_OBJECT, sizeof(HmlObject) + (size_t)obj->capacity * (sizeof(HmlValue) + sizeof(char*)));
 
     obj->field_names[0] = strdup("private_key");
     obj->field_values[0] = hml_val_ptr(pkey);
@@ -0,0 +1,172 @@
+/*
+ * Hemlock Runtime Library - Encoding Builtins
+ *
+ * Base64, hex and percent-encoding over strings and buffers for
+ * @stdlib/encoding, @stdlib/url and @stdlib/http. Each result is allocated
+ * once at its final size and filled by the kernels in str_kernels.c.
+ * Decoded bytes become a string as-is, like __string_from_bytes().
+ */
+
+#include "builtins_internal.h"
+
+// Bytes of a string or buffer argument
+static const unsigned char *codec_input(HmlValue val, size_t *len, const char *fn_name) {
+    if (val.type == HML_VAL_STRING && val.as.as_string) {
+        *len = (size_t)val.as.as_string->length;
+        return (const unsigned char *)val.as.as_string->data;
+    }
+    if (val.type == HML_VAL_BUFFER && val.as.as_buffer && !atomic_load(&val.as.as_buffer->freed)) {
+        HmlBuffer *buf = val.as.as_buffer;
+        *len = buf->data ? (size_t)buf->length : 0;
+        return (const unsigned char *)buf->data;
+    }
+    hml_runtime_error("%s() requires a string or buffer", fn_name);
+}
+
+static char *codec_alloc(size_t len, const char *fn_name) {
+    if (len >= INT32_MAX) {
+        hml_runtime_error("%s() result too large", fn_name);
+    }
+    char *out = malloc(len + 1);
+    if (!out) {
+        hml_runtime_error("%s() memory allocation failed", fn_name);
+    }
+    return out;
+}
+
+static HmlValue codec_result(char *out, size_t len) {
+    out[len] = '\0';
+    return hml_val_string_owned(out, (int)len, (int)len + 1);
+}
+
+// Copy of data without spaces, tabs and line breaks, or NULL if it has none
+static char *strip_whitespace(const unsigned char *data, size_t *len) {
+    size_t i = 0;
+    while (i < *len && data[i] != ' ' && data[i] != '\n' && data[i] != '\r' && data[i] != '\t') i++;
+    if (i == *len) return NULL;
+    char *clean = malloc(*len);
+    if (!clean) return NULL;
+    memcpy(clean, data, i);
+    size_t n = i;
+    for (; i < *len; i++) {
+        unsigned char c = data[i];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') clean[n++] = (char)c;
+    }
+    *len = n;
+    return clean;
+}
+
+HmlValue hml_base64_encode(HmlValue input) {
+    size_t len;
+    const unsigned char *data = codec_input(input, &len, "__base64_encode");
+    size_t out_len = (len + 2) / 3 * 4;
+    char *out = codec_alloc(out_len, "__base64_encode");
+    hml_str_base64_encode(out, data, len);
+    return codec_result(out, out_len);
+}
+
+// Whitespace is ignored, as in wrapped MIME bodies
+HmlValue hml_base64_decode(HmlValue input) {
+    size_t len;
+    const unsigned char *data = codec_input(input, &len, "__base64_decode");
+    char *clean = strip_whitespace(data, &len);
+    const char *src = clean ? clean : (const char *)data;
+    if (len % 4 != 0) {
+        free(clean);
+        hml_runtime_error("Invalid Base64 string: length must be multiple of 4");
+    }
+    char *out = codec_alloc(len / 4 * 3, "__base64_decode");
+    long n = hml_str_base64_decode((unsigned char *)out, src, len);
+    free(clean);
+    if (n < 0) {
+        free(out);
+        hml_runtime_error(n == HML_CODEC_BAD_PADDING ? "Invalid Base64 string: unexpected padding"
+                                                     : "Invalid Base64 string: invalid character");
+    }
+    return codec_result(out, (size_t)n);
+}
+
+HmlValue hml_hex_encode(HmlValue input) {
+    size_t len;
+    const unsigned char *data = codec_input(input, &len, "__hex_encode");
+    char *out = codec_alloc(len * 2, "__hex_encode");
+    hml_str_hex_encode(out, data, len);
+    return codec_result(out, len * 2);
+}
+
+HmlValue hml_hex_decode(HmlValue input) {
+    size_t len;
+    const unsigned char *data = codec_input(input, &len, "__hex_decode");
+    char *clean = strip_whitespace(data, &len);
+    const char *src = clean ? clean : (const char *)data;
+    if (len % 2 != 0) {
+        free(clean);
+        hml_runtime_error("Invalid hex string: length must be even");
+    }
+    char *out = codec_alloc(len / 2, "__hex_decode");
+    long n = hml_str_hex_decode((unsigned char *)out, src, len);
+    free(clean);
+    if (n < 0) {
+        free(out);
+        hml_runtime_error("Invalid hex string: invalid character");
+    }
+    return codec_result(out, (size_t)n);
+}
+
+// Escape the characters of escape, or with a null escape everything but the
+// RFC 3986 unreserved characters
+HmlValue hml_percent_encode(HmlValue input, HmlValue escape, HmlValue space_plus, HmlValue upper) {
+    size_t len;
+    const unsigned char *data = codec_input(input, &len, "__percent_encode");
+
+    unsigned char classes[256];
+    if (escape.type == HML_VAL_NULL) {
+        memset(classes, HML_PERCENT_ESCAPE, sizeof(classes));
+        for (int c = 'A'; c <= 'Z'; c++) classes[c] = HML_PERCENT_KEEP;
+        for (int c = 'a'; c <= 'z'; c++) classes[c] = HML_PERCENT_KEEP;
+        for (int c = '0'; c <= '9'; c++) classes[c] = HML_PERCENT_KEEP;
+        classes['-'] = classes['_'] = classes['.'] = classes['~'] = HML_PERCENT_KEEP;
+    } else if (escape.type == HML_VAL_STRING && escape.as.as_string) {
+        memset(classes, HML_PERCENT_KEEP, sizeof(classes));
+        HmlString *set = escape.as.as_string;
+        for (int i = 0; i < set->length; i++) {
+            classes[(unsigned char)set->data[i]] = HML_PERCENT_ESCAPE;
+        }
+    } else {
+        hml_runtime_error("__percent_encode() escape must be a string or null");
+    }
+    if (hml_to_bool(space_plus) && classes[' '] == HML_PERCENT_ESCAPE) {
+        classes[' '] = HML_PERCENT_PLUS;
+    }
+
+    size_t out_len = hml_str_percent_encoded_length(data, len, classes);
+    char *out = codec_alloc(out_len, "__percent_encode");
+    hml_str_percent_encode(out, data, len, classes, hml_to_bool(upper));
+    return codec_result(out, out_len);
+}
+
+HmlValue hml_percent_decode(HmlValue input, HmlValue plus_space) {
+    size_t len;
+    const unsigned char *data = codec_input(input, &len, "__percent_decode");
+    char *out = codec_alloc(len, "__percent_decode");
+    long n = hml_str_percent_decode((unsigned char *)out, (const char *)data, len, hml_to_bool(plus_space));
+    if (n < 0) {
+        free(out);
+        hml_runtime_error(n == HML_CODEC_TRUNCATED
+                              ? "Invalid URL encoding: incomplete percent sequence"
+                              : "Invalid URL encoding: invalid hex digits in percent sequence");
+    }
+    return codec_result(out, (size_t)n);
+}
+
+DEFINE_BUILTIN_WRAPPER_1(base64_encode)
+DEFINE_BUILTIN_WRAPPER_1(base64_decode)
+DEFINE_BUILTIN_WRAPPER_1(hex_encode)
+DEFINE_BUILTIN_WRAPPER_1(hex_decode)
+DEFINE_BUILTIN_WRAPPER_2(percent_decode)
+
+HmlValue hml_builtin_percent_encode(HmlClosureEnv *env, HmlValue input, HmlValue escape,
+                                    HmlValue space_plus, HmlValue upper) {
+    (void)env;
+    return hml_percent_encode(input, escape, space_plus, upper);
+}
@@ -96,6 +96,42 @@ HmlValue make_int_result(HmlValueType result_type, int64_t value);
 // UTF-8 encoder (used by string operations)
 int encode_utf8(uint32_t cp, char *out);
 
+// ========== STRING KERNELS (defined in str_kernels.c) ==========
+
+int hml_str_find(const char *hay, int hay_len, const char *needle, int needle_len);
+int hml_str_count(const char *hay, int hay_len, const char *needle, int needle_len);
+void hml_str_ascii_upper(char *dst, const char *src, int len);
+void hml_str_ascii_lower(char *dst, const char *src, int len);
+int hml_utf8_count_codepoints(const char *data, int byte_length);
+int hml_utf8_validate(const char *data, int byte_length);
+int hml_utf8_is_ascii(const char *data, int byte_length);
+
+// Codec errors (negative results of the decoders)
+#define HML_CODEC_BAD_CHAR (-1)
+#define HML_CODEC_BAD_PADDING (-2)
+#define HML_CODEC_TRUNCATED (-3)
+
+// Percent-encoding byte classes
+#define HML_PERCENT_KEEP 0
+#define HML_PERCENT_ESCAPE 1
+#define HML_PERCENT_PLUS 2
+
+size_t hml_str_base64_encode(char *dst, const unsigned char *src, size_t len);
+long hml_str_base64_decode(unsigned char *dst, const char *src, size_t len);
+void hml_str_hex_encode(char *dst, const unsigned char *src, size_t len);
+long hml_str_hex_decode(unsigned char *dst, const char *src, size_t len);
+size_t hml_str_percent_encoded_length(const unsigned char *src, size_t len, const unsigned char *classes);
+void hml_str_percent_encode(char *dst, const unsigned char *src, size_t len,
+                            const unsigned char *classes, int upper);
+long hml_str_percent_decode(unsigned char *dst, const char *src, size_t len, int plus_space);
+
+// Room for any formatted number: a 20-digit u64 or a "%g" double
+#define HML_NUMBER_MAX 32
+
+int hml_str_format_u64(char *dst, uint64_t v);
+int hml_str_format_i64(char *dst, int64_t v);
+int hml_str_format_f64(char *dst, double v);
+
 // ========== BUILTIN WRAPPER MACRO ==========
 
 // Macro to reduce boilerplate for simple 1-arg builtin wrappers
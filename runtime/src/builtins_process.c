@@ -0,0 +1,588 @@
+/*
+ * Subprocess builtins
+ *
+ * Compiled-program counterpart of the interpreter's process builtins.
+ * Children are started with posix_spawnp() (clone(CLONE_VM | CLONE_VFORK)
+ * under glibc), so launching does not copy the program's address space, and
+ * every pipe end is close-on-exec so concurrent spawns never leak each
+ * other's descriptors. exec_argv(), exec(cmd, args) and run_many() share one
+ * poll loop that drains every running child's stdout and stderr.
+ */
+
+#define _GNU_SOURCE
+#include "builtins_internal.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+#define CAPTURE_CHUNK 65536
+
+// Where one of the child's standard streams goes
+typedef enum {
+    STDIO_PIPE,
+    STDIO_INHERIT,
+    STDIO_NULL,
+    STDIO_STDOUT,   // stderr only: share the stdout pipe
+} StdioMode;
+
+typedef struct {
+    pid_t pid;
+    int fds[3];     // Parent's ends of the stdin/stdout/stderr pipes, -1 if not piped
+} Spawned;
+
+static void close_pair(int p[2]) {
+    if (p[0] >= 0) close(p[0]);
+    if (p[1] >= 0) close(p[1]);
+}
+
+// Start argv[0] (searched on PATH). Returns 0, or an errno value from pipe
+// creation or posix_spawnp(); glibc reports exec failures here as well.
+static int process_spawn(char *const argv[], const char *cwd, char *const envp[],
+                         const StdioMode modes[3], Spawned *out) {
+    // The child may write to our stdout: put what print() has buffered
+    // (--stdout-buffer, or stdout redirected) ahead of it
+    fflush(stdout);
+    int pipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    for (int i = 0; i < 3; i++) {
+        if (modes[i] == STDIO_PIPE && pipe2(pipes[i], O_CLOEXEC) != 0) {
+            int err = errno;
+            for (int j = 0; j < i; j++) close_pair(pipes[j]);
+            return err;
+        }
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    int err = 0;
+    for (int i = 0; i < 3 && err == 0; i++) {
+        switch (modes[i]) {
+            case STDIO_PIPE:
+                // Child reads stdin's read end and writes the others' write ends
+                err = posix_spawn_file_actions_adddup2(&actions, pipes[i][i == 0 ? 0 : 1], i);
+                break;
+            case STDIO_NULL:
+                err = posix_spawn_file_actions_addopen(&actions, i, "/dev/null", O_RDWR, 0);
+                break;
+            case STDIO_STDOUT:
+                err = posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, i);
+                break;
+            case STDIO_INHERIT:
+                break;
+        }
+    }
+    if (err == 0 && cwd) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+        err = posix_spawn_file_actions_addchdir_np(&actions, cwd);
+#else
+        err = ENOSYS;
+#endif
+    }
+
+    // Tasks may run with signals blocked, and SIGPIPE may be ignored for
+    // sockets; the child starts from a clean slate either way
+    if (err == 0) {
+        sigset_t mask, defaults;
+        sigemptyset(&mask);
+        sigemptyset(&defaults);
+        sigaddset(&defaults, SIGPIPE);
+        posix_spawnattr_setsigmask(&attr, &mask);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+        err = posix_spawnp(&out->pid, argv[0], &actions, &attr, argv, envp ? envp : environ);
+    }
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    for (int i = 0; i < 3; i++) {
+        if (modes[i] != STDIO_PIPE) {
+            out->fds[i] = -1;
+            continue;
+        }
+        int parent_end = i == 0 ? 1 : 0;
+        close(pipes[i][1 - parent_end]);
+        if (err != 0) {
+            close(pipes[i][parent_end]);
+            out->fds[i] = -1;
+        } else {
+            out->fds[i] = pipes[i][parent_end];
+        }
+    }
+    return err;
+}
+
+// Exit code as exec() reports it: the status, or -1 if killed by a signal
+static int exit_code_of(int status) {
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+#ifdef SYS_pidfd_open
+static int pidfd_open(pid_t pid) {
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+}
+#endif
+
+// Wait up to timeout_ms (< 0 = forever) for pid to exit. Returns 1 and sets
+// *status once it has, 0 on timeout, -1 on error.
+static int process_wait(pid_t pid, int timeout_ms, int *status) {
+    for (;;) {
+        pid_t r = waitpid(pid, status, timeout_ms < 0 ? 0 : WNOHANG);
+        if (r == pid) return 1;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        break;
+    }
+    if (timeout_ms == 0) return 0;
+
+#ifdef SYS_pidfd_open
+    // A pidfd becomes readable when the process exits, so the wait is a
+    // single poll() rather than a sleep loop
+    int pidfd = pidfd_open(pid);
+    if (pidfd >= 0) {
+        struct pollfd pfd = { .fd = pidfd, .events = POLLIN };
+        int ready;
+        do {
+            ready = poll(&pfd, 1, timeout_ms);
+        } while (ready < 0 && errno == EINTR);
+        close(pidfd);
+        if (ready <= 0) return ready == 0 ? 0 : -1;
+        pid_t r;
+        do {
+            r = waitpid(pid, status, 0);
+        } while (r < 0 && errno == EINTR);
+        return r == pid ? 1 : -1;
+    }
+#endif
+
+    // No pidfd: poll waitpid with a backoff capped at 20ms
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long delay_us = 500;
+    for (;;) {
+        pid_t r = waitpid(pid, status, WNOHANG);
+        if (r == pid) return 1;
+        if (r < 0 && errno != EINTR) return -1;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (elapsed_ms >= timeout_ms) return 0;
+        struct timespec ts = { 0, delay_us * 1000 };
+        nanosleep(&ts, NULL);
+        if (delay_us < 20000) delay_us *= 2;
+    }
+}
+
+// ========== CAPTURED RUNS ==========
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} ByteBuf;
+
+typedef struct {
+    char **argv;
+    Spawned proc;
+    ByteBuf out;
+    ByteBuf err;
+    int exit_code;
+} Capture;
+
+static int bytebuf_append(ByteBuf *b, const char *data, size_t len) {
+    if (b->len + len + 1 > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (b->len + len + 1 > cap) cap *= 2;
+        char *grown = realloc(b->data, cap);
+        if (!grown) return -1;
+        b->data = grown;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    b->data[b->len] = '\0';
+    return 0;
+}
+
+// Start one captured child. A command that cannot be executed finishes
+// immediately with exit code 127 and the reason on stderr, as a shell would.
+static int capture_start(Capture *c, StdioMode stdin_mode, const char *fn_name) {
+    const StdioMode modes[3] = { stdin_mode, STDIO_PIPE, STDIO_PIPE };
+    int err = process_spawn(c->argv, NULL, NULL, modes, &c->proc);
+    if (err == EAGAIN || err == ENOMEM || err == EMFILE || err == ENFILE) {
+        errno = err;
+        return -1;
+    }
+    if (err != 0) {
+        char msg[512];
+        int n = snprintf(msg, sizeof(msg), "%s() failed to execute '%s': %s\n",
+                         fn_name, c->argv[0], strerror(err));
+        if (bytebuf_append(&c->err, msg, (size_t)n < sizeof(msg) ? (size_t)n : sizeof(msg) - 1) != 0) {
+            errno = ENOMEM;
+            return -1;
+        }
+        c->exit_code = 127;
+        c->proc.pid = -1;
+    }
+    return 0;
+}
+
+// Run every command, at most concurrency at a time, collecting stdout,
+// stderr and the exit code of each. Returns 0, or -1 with errno set if a
+// child could not be started or output could not be stored; children
+// already started are still reaped.
+static int capture_run(Capture *caps, int count, int concurrency, StdioMode stdin_mode,
+                       const char *fn_name) {
+    if (concurrency < 1) concurrency = 1;
+    struct pollfd *pfds = malloc(sizeof(struct pollfd) * (size_t)concurrency * 2);
+    int *owner = malloc(sizeof(int) * (size_t)concurrency * 2);
+    char *chunk = malloc(CAPTURE_CHUNK);
+    if (!pfds || !owner || !chunk) {
+        free(pfds);
+        free(owner);
+        free(chunk);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    int next = 0, running = 0, failed = 0, saved_errno = 0;
+    int *active = malloc(sizeof(int) * (size_t)concurrency);
+    if (!active) {
+        free(pfds);
+        free(owner);
+        free(chunk);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (;;) {
+        while (!failed && running < concurrency && next < count) {
+            Capture *c = &caps[next];
+            if (capture_start(c, stdin_mode, fn_name) != 0) {
+                failed = 1;
+                saved_errno = errno;
+                break;
+            }
+            if (c->proc.pid > 0) active[running++] = next;
+            next++;
+        }
+        if (running == 0) break;
+
+        int n = 0;
+        for (int i = 0; i < running; i++) {
+            Capture *c = &caps[active[i]];
+            for (int s = 1; s <= 2; s++) {
+                if (c->proc.fds[s] >= 0) {
+                    pfds[n].fd = c->proc.fds[s];
+                    pfds[n].events = POLLIN;
+                    owner[n] = active[i] * 2 + (s - 1);
+                    n++;
+                }
+            }
+        }
+
+        if (n > 0 && poll(pfds, (nfds_t)n, -1) < 0 && errno != EINTR) {
+            failed = 1;
+            saved_errno = errno;
+            n = 0;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            Capture *c = &caps[owner[i] / 2];
+            int s = owner[i] % 2 + 1;
+            ssize_t got = read(pfds[i].fd, chunk, CAPTURE_CHUNK);
+            if (got > 0) {
+                if (bytebuf_append(s == 1 ? &c->out : &c->err, chunk, (size_t)got) != 0) {
+                    failed = 1;
+                    saved_errno = ENOMEM;
+                }
+            } else if (got == 0 || errno != EINTR) {
+                close(c->proc.fds[s]);
+                c->proc.fds[s] = -1;
+            }
+        }
+
+        // Reap children whose output has closed
+        for (int i = 0; i < running; ) {
+            Capture *c = &caps[active[i]];
+            if (failed) {
+                if (c->proc.fds[1] >= 0) { close(c->proc.fds[1]); c->proc.fds[1] = -1; }
+                if (c->proc.fds[2] >= 0) { close(c->proc.fds[2]); c->proc.fds[2] = -1; }
+            }
+            if (c->proc.fds[1] < 0 && c->proc.fds[2] < 0) {
+                int status;
+                c->exit_code = process_wait(c->proc.pid, -1, &status) == 1 ? exit_code_of(status) : -1;
+                active[i] = active[--running];
+            } else {
+                i++;
+            }
+        }
+        if (failed && running == 0) break;
+    }
+
+    free(active);
+    free(pfds);
+    free(owner);
+    free(chunk);
+    if (failed) {
+        errno = saved_errno;
+        return -1;
+    }
+    return 0;
+}
+
+static void capture_free(Capture *c) {
+    if (c->argv) {
+        for (int i = 0; c->argv[i]; i++) free(c->argv[i]);
+        free(c->argv);
+    }
+    free(c->out.data);
+    free(c->err.data);
+}
+
+static HmlValue take_bytebuf(ByteBuf *b) {
+    if (!b->data) return hml_val_string("");
+    HmlValue v = hml_val_string_owned(b->data, (int)b->len, (int)b->cap);
+    b->data = NULL;
+    return v;
+}
+
+static void set_field(HmlValue obj, const char *name, HmlValue val) {
+    hml_object_set_field(obj, name, val);
+    hml_release(&val);
+}
+
+// { output, stderr, exit_code }, the shape exec() returns
+static HmlValue capture_result(Capture *c) {
+    HmlValue result = hml_val_object();
+    set_field(result, "output", take_bytebuf(&c->out));
+    set_field(result, "stderr", take_bytebuf(&c->err));
+    set_field(result, "exit_code", hml_val_i32(c->exit_code));
+    return result;
+}
+
+// NULL-terminated copy of an array of strings
+static char **argv_from_array(HmlArray *arr, const char *fn_name) {
+    char **argv = calloc((size_t)arr->length + 1, sizeof(char *));
+    if (!argv) {
+        hml_runtime_error("%s() memory allocation failed", fn_name);
+    }
+    for (int i = 0; i < arr->length; i++) {
+        HmlValue elem = arr->elements[i];
+        if (elem.type != HML_VAL_STRING || !elem.as.as_string) {
+            for (int j = 0; argv[j]; j++) free(argv[j]);
+            free(argv);
+            hml_runtime_error("%s() arguments must be strings", fn_name);
+        }
+        HmlString *s = elem.as.as_string;
+        argv[i] = malloc(s->length + 1);
+        memcpy(argv[i], s->data, s->length);
+        argv[i][s->length] = '\0';
+    }
+    return argv;
+}
+
+// Run argv to completion and return { output, stderr, exit_code }. Takes
+// ownership of argv. Used by exec_argv() and exec(cmd, args); the child
+// shares our stdin.
+HmlValue hml_exec_capture(char **argv, const char *fn_name) {
+    Capture cap = { .argv = argv };
+    if (capture_run(&cap, 1, 1, STDIO_INHERIT, fn_name) != 0) {
+        int err = errno;
+        char program[256];
+        snprintf(program, sizeof(program), "%s", argv[0]);
+        capture_free(&cap);
+        hml_runtime_error("%s() failed to start '%s': %s", fn_name, program, strerror(err));
+    }
+    HmlValue result = capture_result(&cap);
+    capture_free(&cap);
+    return result;
+}
+
+// ========== BUILTINS ==========
+
+static HmlValue option_field(HmlValue options, const char *name) {
+    if (options.type != HML_VAL_OBJECT) return hml_val_null();
+    return hml_object_get_field(options, name);
+}
+
+static int parse_stdio(HmlValue v, int stream, StdioMode *mode) {
+    if (v.type == HML_VAL_NULL) {
+        *mode = STDIO_PIPE;
+        return 1;
+    }
+    if (v.type != HML_VAL_STRING) return 0;
+    const char *s = v.as.as_string->data;
+    if (strcmp(s, "pipe") == 0) *mode = STDIO_PIPE;
+    else if (strcmp(s, "inherit") == 0) *mode = STDIO_INHERIT;
+    else if (strcmp(s, "null") == 0) *mode = STDIO_NULL;
+    else if (strcmp(s, "stdout") == 0 && stream == 2) *mode = STDIO_STDOUT;
+    else return 0;
+    return 1;
+}
+
+// "KEY=value" strings from an object
+static char **envp_from_object(HmlObject *obj) {
+    char **envp = calloc((size_t)obj->num_fields + 1, sizeof(char *));
+    if (!envp) {
+        hml_runtime_error("spawn() memory allocation failed");
+    }
+    for (int i = 0; i < obj->num_fields; i++) {
+        HmlValue value = hml_to_string(obj->field_values[i]);
+        const char *text = value.type == HML_VAL_STRING ? value.as.as_string->data : "";
+        size_t len = strlen(obj->field_names[i]) + strlen(text) + 2;
+        envp[i] = malloc(len);
+        snprintf(envp[i], len, "%s=%s", obj->field_names[i], text);
+        hml_release(&value);
+    }
+    return envp;
+}
+
+static void free_strings(char **strs) {
+    if (!strs) return;
+    for (int i = 0; strs[i]; i++) free(strs[i]);
+    free(strs);
+}
+
+// __spawn_process(argv, [options]) - start a child without waiting for it.
+// Options: cwd, env (object, replaces the environment), and stdin, stdout,
+// stderr: "pipe" (default), "inherit", "null"; stderr may also be "stdout".
+// Returns { pid, stdin, stdout, stderr } with a file for each piped stream.
+HmlValue hml_spawn_process(HmlValue argv_val, HmlValue options) {
+    if (hml_sandbox_check(HML_SANDBOX_RESTRICT_PROCESS)) {
+        hml_sandbox_error("command execution");
+    }
+    if (argv_val.type != HML_VAL_ARRAY || !argv_val.as.as_array || argv_val.as.as_array->length == 0) {
+        hml_runtime_error("spawn() expects a non-empty array of strings and optional options");
+    }
+    if (options.type != HML_VAL_NULL && options.type != HML_VAL_OBJECT) {
+        hml_runtime_error("spawn() options must be an object");
+    }
+
+    static const char *stream_names[3] = { "stdin", "stdout", "stderr" };
+    StdioMode modes[3];
+    for (int i = 0; i < 3; i++) {
+        HmlValue v = option_field(options, stream_names[i]);
+        int ok = parse_stdio(v, i, &modes[i]);
+        hml_release(&v);
+        if (!ok) {
+            hml_runtime_error("spawn() option '%s' must be \"pipe\", \"inherit\" or \"null\"%s",
+                              stream_names[i], i == 2 ? " or \"stdout\"" : "");
+        }
+    }
+
+    HmlValue cwd = option_field(options, "cwd");
+    HmlValue env = option_field(options, "env");
+    if (cwd.type != HML_VAL_NULL && cwd.type != HML_VAL_STRING) {
+        hml_runtime_error("spawn() option 'cwd' must be a string");
+    }
+    if (env.type != HML_VAL_NULL && env.type != HML_VAL_OBJECT) {
+        hml_runtime_error("spawn() option 'env' must be an object");
+    }
+
+    char **argv = argv_from_array(argv_val.as.as_array, "spawn");
+    char **envp = env.type == HML_VAL_OBJECT ? envp_from_object(env.as.as_object) : NULL;
+
+    Spawned proc;
+    int err = process_spawn(argv, cwd.type == HML_VAL_STRING ? cwd.as.as_string->data : NULL,
+                            envp, modes, &proc);
+    free_strings(envp);
+    hml_release(&cwd);
+    hml_release(&env);
+    if (err != 0) {
+        char program[256];
+        snprintf(program, sizeof(program), "%s", argv[0]);
+        free_strings(argv);
+        hml_runtime_error("spawn() failed to execute '%s': %s", program, strerror(err));
+    }
+    free_strings(argv);
+
+    HmlValue result = hml_val_object();
+    set_field(result, "pid", hml_val_i32((int32_t)proc.pid));
+    for (int i = 0; i < 3; i++) {
+        HmlValue stream = hml_val_null();
+        if (proc.fds[i] >= 0) {
+            char name[64];
+            snprintf(name, sizeof(name), "<%s of %d>", stream_names[i], (int)proc.pid);
+            stream = hml_file_from_fd(proc.fds[i], i == 0 ? "w" : "r", name);
+            if (stream.type == HML_VAL_NULL) close(proc.fds[i]);
+        }
+        set_field(result, stream_names[i], stream);
+    }
+    return result;
+}
+
+// __process_wait(pid, [timeout_ms]) - exit code of a spawned child once it
+// exits (-1 if killed by a signal), or null if timeout_ms passes first
+HmlValue hml_process_wait(HmlValue pid_val, HmlValue timeout) {
+    if (!hml_is_integer_type(pid_val) || (timeout.type != HML_VAL_NULL && !hml_is_integer_type(timeout))) {
+        hml_runtime_error("process_wait() expects (pid, [timeout_ms])");
+    }
+    pid_t pid = (pid_t)hml_to_i32(pid_val);
+    int timeout_ms = timeout.type == HML_VAL_NULL ? -1 : hml_to_i32(timeout);
+
+    int status;
+    int r = process_wait(pid, timeout_ms, &status);
+    if (r < 0) {
+        hml_runtime_error("process_wait(%d) failed: %s", (int)pid, strerror(errno));
+    }
+    return r == 0 ? hml_val_null() : hml_val_i32(exit_code_of(status));
+}
+
+// __run_many(cmds, concurrency) - run each argv array in cmds with at most
+// concurrency children at once; results are in cmds order. Children read
+// stdin from /dev/null.
+HmlValue hml_run_many(HmlValue cmds_val, HmlValue concurrency) {
+    if (hml_sandbox_check(HML_SANDBOX_RESTRICT_PROCESS)) {
+        hml_sandbox_error("command execution");
+    }
+    if (cmds_val.type != HML_VAL_ARRAY || !cmds_val.as.as_array || !hml_is_integer_type(concurrency)) {
+        hml_runtime_error("run_many() expects (commands, concurrency)");
+    }
+    HmlArray *cmds = cmds_val.as.as_array;
+    for (int i = 0; i < cmds->length; i++) {
+        HmlValue cmd = cmds->elements[i];
+        if (cmd.type != HML_VAL_ARRAY || !cmd.as.as_array || cmd.as.as_array->length == 0) {
+            hml_runtime_error("run_many() commands must be non-empty arrays of strings");
+        }
+    }
+
+    Capture *caps = calloc((size_t)cmds->length + 1, sizeof(Capture));
+    if (!caps) {
+        hml_runtime_error("run_many() memory allocation failed");
+    }
+    for (int i = 0; i < cmds->length; i++) {
+        caps[i].argv = argv_from_array(cmds->elements[i].as.as_array, "run_many");
+    }
+    if (capture_run(caps, cmds->length, hml_to_i32(concurrency), STDIO_NULL, "run_many") != 0) {
+        int err = errno;
+        for (int i = 0; i < cmds->length; i++) capture_free(&caps[i]);
+        free(caps);
+        hml_runtime_error("run_many() failed to start a command: %s", strerror(err));
+    }
+
+    HmlValue result = hml_val_array();
+    for (int i = 0; i < cmds->length; i++) {
+        HmlValue r = capture_result(&caps[i]);
+        hml_array_push(result, r);
+        hml_release(&r);
+        capture_free(&caps[i]);
+    }
+    free(caps);
+    return result;
+}
+
+DEFINE_BUILTIN_WRAPPER_2(spawn_process)
+DEFINE_BUILTIN_WRAPPER_2(process_wait)
+DEFINE_BUILTIN_WRAPPER_2(run_many)
@@ -17,39 +17,6 @@
 
 // ========== OPTIMIZED SERIALIZATION (JSON) ==========
 
-// Visited set for cycle detection
-typedef struct HmlVisitedSet {
-    void **items;
-    int count;
-    int capacity;
-} HmlVisitedSet;
-
-static void visited_init(HmlVisitedSet *set) {
-    set->items = NULL;
-    set->count = 0;
-    set->capacity = 0;
-}
-
-static void visited_free(HmlVisitedSet *set) {
-    free(set->items);
-}
-
-static int visited_contains(HmlVisitedSet *set, void *ptr) {
-    for (int i = 0; i < set->count; i++) {
-        if (set->items[i] == ptr) return 1;
-    }
-    return 0;
-}
-
-static void visited_add(HmlVisitedSet *set, void *ptr) {
-    if (set->count >= set->capacity) {
-        int new_cap = (set->capacity == 0) ? 16 : set->capacity * 2;
-        set->items = realloc(set->items, new_cap * sizeof(void*));
-        set->capacity = new_cap;
-    }
-    set->items[set->count++] = ptr;
-}
-
 // JSON StringBuilder - accumulates output in a single growing buffer
 typedef struct {
     char *data;
@@ -210,10 +177,9 @@ static int serialize_to_buffer_impl(HmlValue val, HmlJsonBuffer *buf, HmlVisited
                 return 1;
             }
 
-            if (visited_contains(visited, obj)) {
+            if (!hml_visited_add(visited, obj)) {
                 hml_runtime_error("serialize() detected circular reference");
             }
-            visited_add(visited, obj);
 
             hjbuf_append_char(buf, '{');
 
@@ -239,10 +205,9 @@ static int serialize_to_buffer_impl(HmlValue val, HmlJsonBuffer *buf, HmlVisited
                 return 1;
             }
 
-            if (visited_contains(visited, arr)) {
+            if (!hml_visited_add(visited, arr)) {
                 hml_runtime_error("serialize() detected circular reference");
             }
-            visited_add(visited, arr);
 
             hjbuf_append_char(buf, '[');
 
@@ -265,14 +230,14 @@ static int serialize_to_buffer_impl(HmlValue val, HmlJsonBuffer *buf, HmlVisited
 
 HmlValue hml_serialize(HmlValue val) {
     HmlVisitedSet visited;
-    visited_init(&visited);
+    hml_visited_init(&visited);
 
     HmlJsonBuffer buf;
     hjbuf_init(&buf, 256);
 
     serialize_to_buffer_impl(val, &buf, &visited);
 
-    visited_free(&visited);
+    hml_visited_destroy(&visited);
 
     hjbuf_append_char(&buf, '\0');
     return hml_val_string_owned(buf.data, buf.len - 1, buf.capacity);
@@ -496,7 +461,7 @@ static HmlValue json_parse_object(HmlJSONParser *p) {
     if (p->input[p->pos] == '}') {
         p->pos++;
         // Build empty object directly
-        HmlObject *obj = malloc(sizeof(HmlObject));
+        HmlObject *obj = hml_slab_alloc(sizeof(HmlObject));
         obj->type_name = NULL;
         obj->field_names = field_names;
         obj->field_values = field_values;
@@ -504,6 +469,8 @@ static HmlValue json_parse_object(HmlJSONParser *p) {
         obj->capacity = capacity;
         obj->ref_count = 1;
         atomic_store(&obj->freed, 0);
+        obj->gc_buffered = 0;
+        HML_HEAP_TRACK_ALLOC(obj, HML_HEAP_KIND_OBJECT, sizeof(HmlObject) + (size_t)obj->capacity * (sizeof(HmlValue) + sizeof(char*)));
         HmlValue result;
         result.type = HML_VAL_OBJECT;
         result.as.as_object = obj;
@@ -575,7 +542,7 @@ static HmlValue json_parse_object(HmlJSONParser *p) {
     p->pos++;
 
     // Build object directly with pre-populated arrays
-    HmlObject *obj = malloc(sizeof(HmlObject));
+    HmlObject *obj = hml_slab_alloc(sizeof(HmlObject));
     obj->type_name = NULL;
     obj->field_names = field_names;
     obj->field_values = field_values;
@@ -583,6 +550,8 @@ static HmlValue json_parse_object(HmlJSONParser *p) {
     obj->capacity = capacity;
     obj->ref_count = 1;
     atomic_store(&obj->freed, 0);
+    obj->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(obj, HML_HEAP_KIND_OBJECT, sizeof(HmlObject) + (size_t)obj->capacity * (sizeof(HmlValue) + sizeof(char*)));
 
     HmlValue result;
     result.type = HML_VAL_OBJECT;
@@ -606,13 +575,15 @@ static HmlValue json_parse_array(HmlJSONParser *p) {
     if (p->input[p->pos] == ']') {
         p->pos++;
         // Build empty array directly
-        HmlArray *arr = malloc(sizeof(HmlArray));
+        HmlArray *arr = hml_slab_alloc(sizeof(HmlArray));
         arr->elements = elements;
         arr->length = 0;
         arr->capacity = capacity;
         arr->ref_count = 1;
         arr->element_type = HML_VAL_NULL;
         atomic_store(&arr->freed, 0);
+        arr->gc_buffered = 0;
+        HML_HEAP_TRACK_ALLOC(arr, HML_HEAP_KIND_ARRAY, sizeof(HmlArray) + (size_t)arr->capacity * sizeof(HmlValue));
         HmlValue result;
         result.type = HML_VAL_ARRAY;
         result.as.as_array = arr;
@@ -657,13 +628,15 @@ static HmlValue json_parse_array(HmlJSONParser *p) {
     p->pos++;
 
     // Build array directly with pre-populated elements
-    HmlArray *arr = malloc(sizeof(HmlArray));
+    HmlArray *arr = hml_slab_alloc(sizeof(HmlArray));
     arr->elements = elements;
     arr->length = length;
     arr->capacity = capacity;
     arr->ref_count = 1;
     arr->element_type = HML_VAL_NULL;
     atomic_store(&arr->freed, 0);
+    arr->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(arr, HML_HEAP_KIND_ARRAY, sizeof(HmlArray) + (size_t)arr->capacity * sizeof(HmlValue));
 
     HmlValue result;
     result.type = HML_VAL_ARRAY;
@@ -4,7 +4,9 @@
  * TCP/UDP sockets, DNS resolution, and low-level networking.
  */
 
+#define _GNU_SOURCE
 #include "builtins_internal.h"
+#include <sys/uio.h>
 
 // ========== SOCKET OPERATIONS ==========
 
@@ -205,6 +207,58 @@ HmlValue hml_socket_send(HmlValue socket_val, HmlValue data) {
     return hml_val_i32((int32_t)sent);
 }
 
+// socket.send_file(path, offset?, length?) -> i64 (bytes sent)
+HmlValue hml_socket_send_file(HmlValue socket_val, HmlValue path, HmlValue offset, HmlValue length) {
+    if (socket_val.type != HML_VAL_SOCKET || !socket_val.as.as_socket) {
+        hml_runtime_error("send_file() expects a socket");
+    }
+    HmlSocket *sock = socket_val.as.as_socket;
+
+    if (path.type != HML_VAL_STRING || !path.as.as_string) {
+        hml_runtime_error("send_file() expects (path, [offset], [length])");
+    }
+    if ((offset.type != HML_VAL_NULL && !hml_is_integer(offset)) ||
+        (length.type != HML_VAL_NULL && !hml_is_integer(length))) {
+        hml_runtime_error("send_file() offset and length must be integers");
+    }
+    if (sock->closed) {
+        hml_runtime_error("Cannot send on closed socket");
+    }
+
+    const char *path_str = path.as.as_string->data;
+    if (!hml_sandbox_path_allowed(path_str, 0)) {
+        hml_sandbox_error("file read outside sandbox root");
+    }
+
+    int fd = open(path_str, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        hml_runtime_error("Failed to open '%s': %s", path_str, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        hml_runtime_error("send_file() requires a regular file: '%s'", path_str);
+    }
+
+    int64_t off = offset.type == HML_VAL_NULL ? 0 : hml_val_to_int64(offset);
+    int64_t len = length.type == HML_VAL_NULL ? -1 : hml_val_to_int64(length);
+    if (off < 0 || off > (int64_t)st.st_size) {
+        close(fd);
+        hml_runtime_error("send_file() offset %lld is outside '%s'", (long long)off, path_str);
+    }
+    if (len < 0 || len > (int64_t)st.st_size - off) {
+        len = (int64_t)st.st_size - off;
+    }
+
+    int64_t sent = hml_fd_send_file(sock->fd, fd, off, len, sock->nonblocking);
+    int err = errno;
+    close(fd);
+    if (sent < 0) {
+        hml_runtime_error("Failed to send file '%s': %s", path_str, strerror(err));
+    }
+    return hml_val_i64(sent);
+}
+
 // socket.recv(size) -> buffer
 HmlValue hml_socket_recv(HmlValue socket_val, HmlValue size) {
     if (socket_val.type != HML_VAL_SOCKET || !socket_val.as.as_socket) {
@@ -228,12 +282,14 @@ HmlValue hml_socket_recv(HmlValue socket_val, HmlValue size) {
         hml_runtime_error("Failed to receive data: %s", strerror(errno));
     }
 
-    HmlBuffer *hbuf = malloc(sizeof(HmlBuffer));
+    HmlBuffer *hbuf = hml_slab_alloc(sizeof(HmlBuffer));
     hbuf->data = buf;
     hbuf->length = (int)received;
     hbuf->capacity = sz;
     hbuf->ref_count = 1;
     atomic_store(&hbuf->freed, 0);  // Not freed
+    hbuf->mapped = 0;
+    HML_HEAP_TRACK_ALLOC(hbuf, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer) + (size_t)hbuf->capacity);
 
     HmlValue result;
     result.type = HML_VAL_BUFFER;
@@ -322,12 +378,14 @@ HmlValue hml_socket_recvfrom(HmlValue socket_val, HmlValue size) {
     }
 
     // Create buffer for data
-    HmlBuffer *hbuf = malloc(sizeof(HmlBuffer));
+    HmlBuffer *hbuf = hml_slab_alloc(sizeof(HmlBuffer));
     hbuf->data = buf;
     hbuf->length = (int)received;
     hbuf->capacity = sz;
     hbuf->ref_count = 1;
     atomic_store(&hbuf->freed, 0);  // Not freed
+    hbuf->mapped = 0;
+    HML_HEAP_TRACK_ALLOC(hbuf, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer) + (size_t)hbuf->capacity);
 
     // Get source address and port
     char addr_str[INET_ADDRSTRLEN];
@@ -347,6 +405,379 @@ HmlValue hml_socket_recvfrom(HmlValue socket_val, HmlValue size) {
     return result;
 }
 
+// ========== BATCHED AND VECTORED I/O ==========
+
+// Most datagrams recv_many() returns from one call
+#define SOCKET_BATCH_MAX 1024
+
+static HmlSocket *socket_arg(HmlValue socket_val, const char *fn_name, const char *verb) {
+    if (socket_val.type != HML_VAL_SOCKET || !socket_val.as.as_socket) {
+        hml_runtime_error("%s() expects a socket", fn_name);
+    }
+    HmlSocket *sock = socket_val.as.as_socket;
+    if (sock->closed) {
+        hml_runtime_error("Cannot %s on closed socket", verb);
+    }
+    return sock;
+}
+
+// Fill dest with address:port for the socket's family; 0 if the address is invalid
+static int socket_dest_addr(HmlSocket *sock, const char *address, int port,
+                            struct sockaddr_storage *dest, socklen_t *dest_len) {
+    memset(dest, 0, sizeof(*dest));
+    if (sock->domain == AF_INET6) {
+        struct sockaddr_in6 *a6 = (struct sockaddr_in6 *)dest;
+        a6->sin6_family = AF_INET6;
+        a6->sin6_port = htons(port);
+        *dest_len = sizeof(*a6);
+        return inet_pton(AF_INET6, address, &a6->sin6_addr) == 1;
+    }
+    struct sockaddr_in *a4 = (struct sockaddr_in *)dest;
+    a4->sin_family = AF_INET;
+    a4->sin_port = htons(port);
+    *dest_len = sizeof(*a4);
+    return inet_pton(AF_INET, address, &a4->sin_addr) == 1;
+}
+
+// Bytes of a string or buffer value; 0 if it is neither
+static int socket_bytes(HmlValue v, const void **data, size_t *len) {
+    if (v.type == HML_VAL_STRING && v.as.as_string) {
+        *data = v.as.as_string->data;
+        *len = v.as.as_string->length;
+        return 1;
+    }
+    if (v.type == HML_VAL_BUFFER && v.as.as_buffer) {
+        *data = v.as.as_buffer->data;
+        *len = v.as.as_buffer->length;
+        return 1;
+    }
+    return 0;
+}
+
+// { data, address, port } as recvfrom() returns it, data copied at its exact length
+static HmlValue socket_datagram(const void *data, int len, struct sockaddr_storage *src, socklen_t src_len) {
+    char addr_str[INET6_ADDRSTRLEN] = "";
+    int src_port = 0;
+    if (src_len > 0 && src->ss_family == AF_INET6) {
+        struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)src;
+        inet_ntop(AF_INET6, &addr6->sin6_addr, addr_str, sizeof(addr_str));
+        src_port = ntohs(addr6->sin6_port);
+    } else if (src_len > 0 && src->ss_family == AF_INET) {
+        struct sockaddr_in *addr4 = (struct sockaddr_in *)src;
+        inet_ntop(AF_INET, &addr4->sin_addr, addr_str, sizeof(addr_str));
+        src_port = ntohs(addr4->sin_port);
+    }
+
+    HmlValue bytes = hml_val_buffer(len);
+    if (len > 0) memcpy(bytes.as.as_buffer->data, data, len);
+    HmlValue address = hml_val_string(addr_str);
+    HmlValue port = hml_val_i32(src_port);
+
+    HmlValue result = hml_val_object();
+    hml_object_set_field(result, "data", bytes);
+    hml_object_set_field(result, "address", address);
+    hml_object_set_field(result, "port", port);
+    hml_release(&bytes);
+    hml_release(&address);
+    return result;
+}
+
+// socket.recv_into(buf, offset?, length?) -> i32 | null
+// Receives into buf at offset without allocating; 0 at end of stream, null
+// if the socket is non-blocking and no data is ready
+HmlValue hml_socket_recv_into(HmlValue socket_val, HmlValue buf_val, HmlValue offset, HmlValue length) {
+    HmlSocket *sock = socket_arg(socket_val, "recv_into", "recv");
+    if (buf_val.type != HML_VAL_BUFFER || !buf_val.as.as_buffer ||
+        (offset.type != HML_VAL_NULL && !hml_is_integer(offset)) ||
+        (length.type != HML_VAL_NULL && !hml_is_integer(length))) {
+        hml_runtime_error("recv_into() expects (buffer, [offset], [length])");
+    }
+
+    HmlBuffer *buf = buf_val.as.as_buffer;
+    int off = offset.type == HML_VAL_NULL ? 0 : hml_to_i32(offset);
+    if (off < 0 || off > buf->length) {
+        hml_runtime_error("recv_into() offset %d is outside the buffer (length %d)", off, buf->length);
+    }
+    int len = length.type == HML_VAL_NULL ? buf->length - off : hml_to_i32(length);
+    if (len < 0 || len > buf->length - off) {
+        len = buf->length - off;
+    }
+
+    ssize_t received;
+    do {
+        received = recv(sock->fd, (char *)buf->data + off, len, 0);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        if (sock->nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return hml_val_null();
+        }
+        hml_runtime_error("Failed to receive data: %s", strerror(errno));
+    }
+    return hml_val_i32((int32_t)received);
+}
+
+// socket.recv_many(count, size) -> array of { data, address, port }
+// Waits for one datagram, then takes up to count - 1 more already queued,
+// with one recvmmsg() call into a shared scratch area
+HmlValue hml_socket_recv_many(HmlValue socket_val, HmlValue count_val, HmlValue size_val) {
+    HmlSocket *sock = socket_arg(socket_val, "recv_many", "recv");
+    if (!hml_is_integer(count_val) || !hml_is_integer(size_val)) {
+        hml_runtime_error("recv_many() expects 2 integer arguments (count, size)");
+    }
+    int count = hml_to_i32(count_val);
+    int size = hml_to_i32(size_val);
+    if (count <= 0 || size <= 0) {
+        hml_runtime_error("recv_many() count and size must be positive");
+    }
+    if (count > SOCKET_BATCH_MAX) count = SOCKET_BATCH_MAX;
+    if ((size_t)count * (size_t)size > (size_t)INT_MAX) {
+        hml_runtime_error("recv_many() count * size is too large");
+    }
+
+    char *scratch = malloc((size_t)count * size);
+    struct sockaddr_storage *addrs = malloc(sizeof(struct sockaddr_storage) * count);
+    if (!scratch || !addrs) {
+        free(scratch);
+        free(addrs);
+        hml_runtime_error("Memory allocation failed");
+    }
+
+    int received = 0;
+    int err = 0;
+    socklen_t addr_lens[SOCKET_BATCH_MAX];
+    int lens[SOCKET_BATCH_MAX];
+#ifdef __linux__
+    struct mmsghdr *msgs = calloc(count, sizeof(struct mmsghdr));
+    struct iovec *iovs = malloc(sizeof(struct iovec) * count);
+    if (!msgs || !iovs) {
+        free(msgs);
+        free(iovs);
+        free(scratch);
+        free(addrs);
+        hml_runtime_error("Memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        iovs[i].iov_base = scratch + (size_t)i * size;
+        iovs[i].iov_len = size;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+    int n;
+    do {
+        n = recvmmsg(sock->fd, msgs, count, MSG_WAITFORONE, NULL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        err = errno;
+    } else {
+        received = n;
+        for (int i = 0; i < n; i++) {
+            lens[i] = (int)msgs[i].msg_len;
+            addr_lens[i] = msgs[i].msg_hdr.msg_namelen;
+        }
+    }
+    free(msgs);
+    free(iovs);
+#else
+    // One blocking recvfrom, then drain what is queued without waiting
+    while (received < count) {
+        addr_lens[received] = sizeof(struct sockaddr_storage);
+        ssize_t got = recvfrom(sock->fd, scratch + (size_t)received * size, size,
+                               received == 0 ? 0 : MSG_DONTWAIT,
+                               (struct sockaddr *)&addrs[received], &addr_lens[received]);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (received == 0) err = errno;
+            break;
+        }
+        lens[received++] = (int)got;
+    }
+#endif
+
+    if (err != 0 && !(sock->nonblocking && (err == EAGAIN || err == EWOULDBLOCK))) {
+        free(scratch);
+        free(addrs);
+        hml_runtime_error("Failed to receive datagrams: %s", strerror(err));
+    }
+
+    HmlValue result = hml_val_array();
+    for (int i = 0; i < received; i++) {
+        HmlValue packet = socket_datagram(scratch + (size_t)i * size, lens[i], &addrs[i], addr_lens[i]);
+        hml_array_push(result, packet);
+        hml_release(&packet);
+    }
+    free(scratch);
+    free(addrs);
+    return result;
+}
+
+// socket.send_many(packets) -> i32 (packets sent)
+// A packet is a string or buffer (connected sockets) or { address, port, data }
+HmlValue hml_socket_send_many(HmlValue socket_val, HmlValue packets_val) {
+    HmlSocket *sock = socket_arg(socket_val, "send_many", "send");
+    if (packets_val.type != HML_VAL_ARRAY || !packets_val.as.as_array) {
+        hml_runtime_error("send_many() expects 1 argument (array of packets)");
+    }
+    HmlArray *packets = packets_val.as.as_array;
+    int count = (int)packets->length;
+    if (count == 0) return hml_val_i32(0);
+
+    struct iovec *iovs = malloc(sizeof(struct iovec) * count);
+    struct sockaddr_storage *dests = malloc(sizeof(struct sockaddr_storage) * count);
+    socklen_t *dest_lens = malloc(sizeof(socklen_t) * count);
+    if (!iovs || !dests || !dest_lens) {
+        free(iovs);
+        free(dests);
+        free(dest_lens);
+        hml_runtime_error("Memory allocation failed");
+    }
+
+    for (int i = 0; i < count; i++) {
+        HmlValue packet = packets->elements[i];
+        HmlValue data = packet;
+        dest_lens[i] = 0;
+        if (packet.type == HML_VAL_OBJECT) {
+            HmlValue address = hml_object_get_field(packet, "address");
+            HmlValue port = hml_object_get_field(packet, "port");
+            data = hml_object_get_field(packet, "data");
+            int ok = address.type == HML_VAL_STRING && hml_is_integer(port) &&
+                     socket_dest_addr(sock, address.as.as_string->data, hml_to_i32(port),
+                                      &dests[i], &dest_lens[i]);
+            hml_release(&address);
+            hml_release(&port);
+            if (!ok) {
+                hml_release(&data);
+                free(iovs);
+                free(dests);
+                free(dest_lens);
+                hml_runtime_error("send_many() packet %d needs a valid address, port and data", i);
+            }
+        }
+        const void *bytes;
+        size_t len;
+        int is_bytes = socket_bytes(data, &bytes, &len);
+        if (packet.type == HML_VAL_OBJECT) {
+            // The packet object still holds data, so bytes stays valid
+            hml_release(&data);
+        }
+        if (!is_bytes) {
+            free(iovs);
+            free(dests);
+            free(dest_lens);
+            hml_runtime_error("send_many() packet data must be string or buffer");
+        }
+        iovs[i].iov_base = (void *)bytes;
+        iovs[i].iov_len = len;
+    }
+
+    int sent = 0;
+    int err = 0;
+#ifdef __linux__
+    struct mmsghdr *msgs = calloc(count, sizeof(struct mmsghdr));
+    if (!msgs) {
+        free(iovs);
+        free(dests);
+        free(dest_lens);
+        hml_runtime_error("Memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = dest_lens[i] ? &dests[i] : NULL;
+        msgs[i].msg_hdr.msg_namelen = dest_lens[i];
+    }
+    while (sent < count) {
+        int n = sendmmsg(sock->fd, msgs + sent, count - sent, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        sent += n;
+    }
+    free(msgs);
+#else
+    while (sent < count) {
+        ssize_t n = sendto(sock->fd, iovs[sent].iov_base, iovs[sent].iov_len, 0,
+                           dest_lens[sent] ? (struct sockaddr *)&dests[sent] : NULL, dest_lens[sent]);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        sent++;
+    }
+#endif
+    free(iovs);
+    free(dests);
+    free(dest_lens);
+
+    if (err != 0 && !(sock->nonblocking && (err == EAGAIN || err == EWOULDBLOCK))) {
+        hml_runtime_error("Failed to send datagrams: %s", strerror(err));
+    }
+    return hml_val_i32(sent);
+}
+
+// socket.send_parts(parts) -> i64 (bytes sent)
+// Sends strings and buffers back to back with vectored sendmsg() calls
+HmlValue hml_socket_send_parts(HmlValue socket_val, HmlValue parts_val) {
+    HmlSocket *sock = socket_arg(socket_val, "send_parts", "send");
+    if (parts_val.type != HML_VAL_ARRAY || !parts_val.as.as_array) {
+        hml_runtime_error("send_parts() expects 1 argument (array of strings or buffers)");
+    }
+    HmlArray *parts = parts_val.as.as_array;
+    int count = (int)parts->length;
+    if (count == 0) return hml_val_i64(0);
+
+    struct iovec *iovs = malloc(sizeof(struct iovec) * count);
+    if (!iovs) {
+        hml_runtime_error("Memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        const void *bytes;
+        size_t len;
+        if (!socket_bytes(parts->elements[i], &bytes, &len)) {
+            free(iovs);
+            hml_runtime_error("send_parts() parts must be strings or buffers");
+        }
+        iovs[i].iov_base = (void *)bytes;
+        iovs[i].iov_len = len;
+    }
+
+    int64_t total = 0;
+    int first = 0;
+    int err = 0;
+    while (first < count) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iovs + first;
+        msg.msg_iovlen = count - first < IOV_MAX ? count - first : IOV_MAX;
+        ssize_t n = sendmsg(sock->fd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        total += n;
+        // Skip what was sent, trimming a partially sent part
+        while (first < count && (size_t)n >= iovs[first].iov_len) {
+            n -= iovs[first].iov_len;
+            first++;
+        }
+        if (first < count) {
+            iovs[first].iov_base = (char *)iovs[first].iov_base + n;
+            iovs[first].iov_len -= n;
+        }
+    }
+    free(iovs);
+
+    if (err != 0 && !(sock->nonblocking && (err == EAGAIN || err == EWOULDBLOCK))) {
+        hml_runtime_error("Failed to send data: %s", strerror(err));
+    }
+    return hml_val_i64(total);
+}
+
 // socket.setsockopt(level, option, value)
 void hml_socket_setsockopt(HmlValue socket_val, HmlValue level, HmlValue option, HmlValue value) {
     if (socket_val.type != HML_VAL_SOCKET || !socket_val.as.as_socket) {
@@ -8,6 +8,8 @@
  * - replace, replace_all, repeat
  * - concat3, concat4, concat5, concat_many
  * - UTF-8 operations (chars, bytes, rune_at, char_count)
+ * - String builder (__sb_* builtins)
+ * - String interpolation
  * - Buffer operations
  */
 
@@ -15,13 +17,20 @@
 
 // ========== STRING METHODS ==========
 
+// New string holding a copy of len bytes (inline when short)
+static HmlValue string_from_span(const char *data, int len) {
+    HmlString *result = hml_string_alloc(len);
+    memcpy(result->data, data, len);
+    result->data[len] = '\0';
+    return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = result };
+}
+
 HmlValue hml_string_length(HmlValue str) {
     if (str.type != HML_VAL_STRING || !str.as.as_string) {
         return hml_val_i32(0);
     }
-    HmlString *s = str.as.as_string;
-    // For now, return byte length (UTF-8 codepoint counting can be added later)
-    return hml_val_i32(s->length);
+    // Codepoints, like the interpreter; the count is cached on the string
+    return hml_string_char_count(str);
 }
 
 HmlValue hml_string_byte_length(HmlValue str) {
@@ -105,15 +114,7 @@ HmlValue hml_string_find(HmlValue str, HmlValue needle) {
     HmlString *s = str.as.as_string;
     HmlString *n = needle.as.as_string;
 
-    if (n->length == 0) return hml_val_i32(0);
-    if (n->length > s->length) return hml_val_i32(-1);
-
-    for (int i = 0; i <= s->length - n->length; i++) {
-        if (memcmp(s->data + i, n->data, n->length) == 0) {
-            return hml_val_i32(i);
-        }
-    }
-    return hml_val_i32(-1);
+    return hml_val_i32(hml_str_find(s->data, s->length, n->data, n->length));
 }
 
 HmlValue hml_string_contains(HmlValue str, HmlValue needle) {
@@ -135,36 +136,21 @@ HmlValue hml_string_split(HmlValue str, HmlValue delimiter) {
     if (d->length == 0) {
         // Split into individual characters
         for (int i = 0; i < s->length; i++) {
-            char *c = malloc(2);
-            c[0] = s->data[i];
-            c[1] = '\0';
-            HmlValue part_val = hml_val_string_owned(c, 1, 2);
-            hml_array_push(result, part_val);
+            hml_array_push(result, string_from_span(s->data + i, 1));
         }
         return result;
     }
 
     int start = 0;
-    for (int i = 0; i <= s->length - d->length; i++) {
-        if (memcmp(s->data + i, d->data, d->length) == 0) {
-            int len = i - start;
-            char *part = malloc(len + 1);
-            memcpy(part, s->data + start, len);
-            part[len] = '\0';
-            HmlValue part_val = hml_val_string_owned(part, len, len + 1);
-            hml_array_push(result, part_val);
-            i += d->length - 1;
-            start = i + 1;
-        }
+    for (;;) {
+        int at = hml_str_find(s->data + start, s->length - start, d->data, d->length);
+        if (at < 0) break;
+        hml_array_push(result, string_from_span(s->data + start, at));
+        start += at + d->length;
     }
 
     // Add remaining part
-    int len = s->length - start;
-    char *part = malloc(len + 1);
-    memcpy(part, s->data + start, len);
-    part[len] = '\0';
-    HmlValue part_val = hml_val_string_owned(part, len, len + 1);
-    hml_array_push(result, part_val);
+    hml_array_push(result, string_from_span(s->data + start, s->length - start));
 
     return result;
 }
@@ -188,12 +174,7 @@ HmlValue hml_string_trim(HmlValue str) {
     }
 
     int len = end - start + 1;
-    if (len <= 0) return hml_val_string("");
-
-    char *result = malloc(len + 1);
-    memcpy(result, s->data + start, len);
-    result[len] = '\0';
-    return hml_val_string_owned(result, len, len + 1);
+    return string_from_span(s->data + start, len > 0 ? len : 0);
 }
 
 HmlValue hml_string_to_upper(HmlValue str) {
@@ -201,17 +182,11 @@ HmlValue hml_string_to_upper(HmlValue str) {
         return hml_val_string("");
     }
     HmlString *s = str.as.as_string;
-    char *result = malloc(s->length + 1);
-    for (int i = 0; i < s->length; i++) {
-        char c = s->data[i];
-        if (c >= 'a' && c <= 'z') {
-            result[i] = c - 32;
-        } else {
-            result[i] = c;
-        }
-    }
-    result[s->length] = '\0';
-    return hml_val_string_owned(result, s->length, s->length + 1);
+    HmlString *result = hml_string_alloc(s->length);
+    hml_str_ascii_upper(result->data, s->data, s->length);
+    result->data[s->length] = '\0';
+    result->char_length = s->char_length;
+    return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = result };
 }
 
 HmlValue hml_string_to_lower(HmlValue str) {
@@ -219,17 +194,11 @@ HmlValue hml_string_to_lower(HmlValue str) {
         return hml_val_string("");
     }
     HmlString *s = str.as.as_string;
-    char *result = malloc(s->length + 1);
-    for (int i = 0; i < s->length; i++) {
-        char c = s->data[i];
-        if (c >= 'A' && c <= 'Z') {
-            result[i] = c + 32;
-        } else {
-            result[i] = c;
-        }
-    }
-    result[s->length] = '\0';
-    return hml_val_string_owned(result, s->length, s->length + 1);
+    HmlString *result = hml_string_alloc(s->length);
+    hml_str_ascii_lower(result->data, s->data, s->length);
+    result->data[s->length] = '\0';
+    result->char_length = s->char_length;
+    return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = result };
 }
 
 HmlValue hml_string_starts_with(HmlValue str, HmlValue prefix) {
@@ -270,28 +239,23 @@ HmlValue hml_string_replace(HmlValue str, HmlValue old, HmlValue new_str) {
         return str;
     }
 
-    // Find first occurrence
-    int pos = -1;
-    for (int i = 0; i <= s->length - o->length; i++) {
-        if (memcmp(s->data + i, o->data, o->length) == 0) {
-            pos = i;
-            break;
-        }
-    }
-
+    int pos = hml_str_find(s->data, s->length, o->data, o->length);
     if (pos == -1) {
         hml_retain(&str);
         return str;
     }
+    if (n->length - o->length > INT_MAX - s->length) {
+        hml_runtime_error("replace() result too large");
+    }
 
     int new_len = s->length - o->length + n->length;
-    char *result = malloc(new_len + 1);
-    memcpy(result, s->data, pos);
-    memcpy(result + pos, n->data, n->length);
-    memcpy(result + pos + n->length, s->data + pos + o->length, s->length - pos - o->length);
-    result[new_len] = '\0';
+    HmlString *result = hml_string_alloc(new_len);
+    memcpy(result->data, s->data, pos);
+    memcpy(result->data + pos, n->data, n->length);
+    memcpy(result->data + pos + n->length, s->data + pos + o->length, s->length - pos - o->length);
+    result->data[new_len] = '\0';
 
-    return hml_val_string_owned(result, new_len, new_len + 1);
+    return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = result };
 }
 
 HmlValue hml_string_replace_all(HmlValue str, HmlValue old, HmlValue new_str) {
@@ -309,36 +273,34 @@ HmlValue hml_string_replace_all(HmlValue str, HmlValue old, HmlValue new_str) {
         return str;
     }
 
-    // Count occurrences
-    int count = 0;
-    for (int i = 0; i <= s->length - o->length; i++) {
-        if (memcmp(s->data + i, o->data, o->length) == 0) {
-            count++;
-            i += o->length - 1;
-        }
-    }
-
+    int count = hml_str_count(s->data, s->length, o->data, o->length);
     if (count == 0) {
         hml_retain(&str);
         return str;
     }
 
-    int new_len = s->length - (count * o->length) + (count * n->length);
-    char *result = malloc(new_len + 1);
-    int result_pos = 0;
+    int64_t new_len64 = (int64_t)s->length + (int64_t)count * (n->length - o->length);
+    if (new_len64 > INT_MAX - 1) {
+        hml_runtime_error("replace_all() result too large");
+    }
 
-    for (int i = 0; i < s->length; ) {
-        if (i <= s->length - o->length && memcmp(s->data + i, o->data, o->length) == 0) {
-            memcpy(result + result_pos, n->data, n->length);
-            result_pos += n->length;
-            i += o->length;
-        } else {
-            result[result_pos++] = s->data[i++];
-        }
+    // Copy the text between matches, then the replacement
+    int new_len = (int)new_len64;
+    HmlString *result = hml_string_alloc(new_len);
+    int result_pos = 0;
+    int i = 0;
+    for (int k = 0; k < count; k++) {
+        int at = i + hml_str_find(s->data + i, s->length - i, o->data, o->length);
+        memcpy(result->data + result_pos, s->data + i, at - i);
+        result_pos += at - i;
+        memcpy(result->data + result_pos, n->data, n->length);
+        result_pos += n->length;
+        i = at + o->length;
     }
-    result[new_len] = '\0';
+    memcpy(result->data + result_pos, s->data + i, s->length - i);
+    result->data[new_len] = '\0';
 
-    return hml_val_string_owned(result, new_len, new_len + 1);
+    return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = result };
 }
 
 HmlValue hml_string_repeat(HmlValue str, HmlValue count) {
@@ -610,9 +572,10 @@ void hml_string_index_assign(HmlValue str, HmlValue index, HmlValue val) {
         new_data[new_total] = '\0';
 
         // Replace string data
-        free(s->data);
+        if (!HML_STRING_IS_INLINE(s)) free(s->data);
         s->data = new_data;
         s->length = new_total;
+        s->capacity = new_total + 1;
         s->char_length = -1;  // Invalidate cached character count
     }
 }
@@ -659,15 +622,8 @@ HmlValue hml_string_char_count(HmlValue str) {
         return hml_val_i32(s->char_length);
     }
 
-    // Count UTF-8 codepoints
-    int count = 0;
-    int byte_pos = 0;
-    while (byte_pos < s->length) {
-        byte_pos += utf8_char_len((unsigned char)s->data[byte_pos]);
-        count++;
-    }
-
-    // Cache the result
+    // Count UTF-8 codepoints and cache the result
+    int count = hml_utf8_count_codepoints(s->data, s->length);
     s->char_length = count;
     return hml_val_i32(count);
 }
@@ -748,16 +704,274 @@ HmlValue hml_string_to_bytes(HmlValue str) {
     }
 
     HmlString *s = str.as.as_string;
-    HmlBuffer *buf = malloc(sizeof(HmlBuffer));
+    HmlBuffer *buf = hml_slab_alloc(sizeof(HmlBuffer));
     buf->data = malloc(s->length);
     memcpy(buf->data, s->data, s->length);
     buf->length = s->length;
     buf->capacity = s->length;
     buf->ref_count = 1;
+    atomic_store(&buf->freed, 0);
+    buf->mapped = 0;
+    HML_HEAP_TRACK_ALLOC(buf, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer) + (size_t)buf->capacity);
 
     return (HmlValue){ .type = HML_VAL_BUFFER, .as.as_buffer = buf };
 }
 
+// True if a string's or buffer's bytes are valid UTF-8
+HmlValue hml_utf8_valid(HmlValue arg) {
+    if (arg.type == HML_VAL_STRING && arg.as.as_string) {
+        HmlString *s = arg.as.as_string;
+        return hml_val_bool(hml_utf8_validate(s->data, s->length));
+    }
+    if (arg.type == HML_VAL_BUFFER && arg.as.as_buffer) {
+        HmlBuffer *buf = arg.as.as_buffer;
+        return hml_val_bool(!buf->data || hml_utf8_validate(buf->data, buf->length));
+    }
+    hml_runtime_error("__utf8_valid() requires a string or buffer");
+}
+
+HmlValue hml_builtin_utf8_valid(HmlClosureEnv *env, HmlValue arg) {
+    (void)env;
+    return hml_utf8_valid(arg);
+}
+
+// ========== STRING BUILDER ==========
+
+// A string builder is a buffer whose length is the number of bytes appended
+// so far, always with room for a terminator so the bytes can become a
+// string without copying. StringBuilder in @stdlib/fmt wraps these.
+
+static HmlBuffer *sb_arg(HmlValue sb, const char *fn_name) {
+    if (sb.type != HML_VAL_BUFFER || !sb.as.as_buffer || atomic_load(&sb.as.as_buffer->freed) ||
+        sb.as.as_buffer->mapped) {
+        hml_runtime_error("%s() requires a string builder buffer", fn_name);
+    }
+    return sb.as.as_buffer;
+}
+
+// Ensure room for extra more bytes plus the terminator
+static void sb_reserve(HmlBuffer *buf, int extra) {
+    if (buf->length > INT_MAX - 1 - extra) {
+        hml_runtime_error("String builder too large");
+    }
+    int needed = buf->length + extra + 1;
+    if (needed <= buf->capacity) {
+        return;
+    }
+    int new_capacity = buf->capacity < INT_MAX / 2 ? buf->capacity * 2 : INT_MAX;
+    if (new_capacity < needed) new_capacity = needed;
+    if (new_capacity < 32) new_capacity = 32;
+    char *data = realloc(buf->data, new_capacity);
+    if (!data) {
+        hml_runtime_error("String builder allocation failed");
+    }
+    buf->data = data;
+    buf->capacity = new_capacity;
+}
+
+static void sb_write(HmlBuffer *buf, const char *bytes, int len) {
+    sb_reserve(buf, len);
+    memcpy((char *)buf->data + buf->length, bytes, len);
+    buf->length += len;
+}
+
+HmlValue hml_sb_new(HmlValue capacity) {
+    int cap = hml_to_i32(capacity);
+    if (cap < 0) cap = 0;
+    HmlValue result = hml_val_buffer(cap + 1);
+    if (result.type == HML_VAL_BUFFER) {
+        result.as.as_buffer->length = 0;
+    }
+    return result;
+}
+
+HmlValue hml_sb_append(HmlValue sb, HmlValue val) {
+    HmlBuffer *buf = sb_arg(sb, "__sb_append");
+    if (val.type == HML_VAL_STRING && val.as.as_string) {
+        sb_write(buf, val.as.as_string->data, val.as.as_string->length);
+    } else if (val.type == HML_VAL_RUNE) {
+        char bytes[4];
+        int len = utf8_encode(bytes, val.as.as_rune);
+        sb_write(buf, bytes, len);
+    } else {
+        // Objects and arrays append their JSON form
+        HmlValue str = (val.type == HML_VAL_OBJECT || val.type == HML_VAL_ARRAY)
+            ? hml_serialize(val) : hml_to_string(val);
+        sb_write(buf, str.as.as_string->data, str.as.as_string->length);
+        hml_release(&str);
+    }
+    return hml_val_null();
+}
+
+HmlValue hml_sb_append_byte(HmlValue sb, HmlValue byte) {
+    HmlBuffer *buf = sb_arg(sb, "__sb_append_byte");
+    char b = (char)(hml_to_i32(byte) & 0xFF);
+    sb_write(buf, &b, 1);
+    return hml_val_null();
+}
+
+// Long contents are handed to the string without copying; the builder is
+// left empty either way
+HmlValue hml_sb_to_string(HmlValue sb) {
+    HmlBuffer *buf = sb_arg(sb, "__sb_to_string");
+    int length = buf->length;
+    if (length < HML_STRING_INLINE_CAPACITY) {
+        // Fits inline; keep the builder's storage for reuse
+        HmlString *str = hml_string_alloc(length);
+        if (length > 0) memcpy(str->data, buf->data, length);
+        str->data[length] = '\0';
+        buf->length = 0;
+        return (HmlValue){ .type = HML_VAL_STRING, .as.as_string = str };
+    }
+
+    sb_reserve(buf, 0);
+    char *data = buf->data;
+    data[length] = '\0';
+    HmlValue result = hml_val_string_owned(data, length, buf->capacity);
+    buf->data = NULL;
+    buf->length = 0;
+    buf->capacity = 0;
+    return result;
+}
+
+HmlValue hml_builtin_sb_new(HmlClosureEnv *env, HmlValue capacity) {
+    (void)env;
+    return hml_sb_new(capacity);
+}
+
+HmlValue hml_builtin_sb_append(HmlClosureEnv *env, HmlValue sb, HmlValue val) {
+    (void)env;
+    return hml_sb_append(sb, val);
+}
+
+HmlValue hml_builtin_sb_append_byte(HmlClosureEnv *env, HmlValue sb, HmlValue byte) {
+    (void)env;
+    return hml_sb_append_byte(sb, byte);
+}
+
+HmlValue hml_builtin_sb_to_string(HmlClosureEnv *env, HmlValue sb) {
+    (void)env;
+    return hml_sb_to_string(sb);
+}
+
+// ========== STRING INTERPOLATION ==========
+
+// Interpolated strings are formatted into a stack buffer, which moves to
+// the heap once it fills up
+#define INTERP_STACK_SIZE 256
+
+typedef struct {
+    char *data;
+    int length;
+    int capacity;
+    char stack[INTERP_STACK_SIZE];
+} InterpBuf;
+
+// Ensure room for extra more bytes plus the terminator
+static void interp_reserve(InterpBuf *out, int extra) {
+    if (out->length > INT_MAX - 1 - extra) {
+        hml_runtime_error("String concatenation overflow - result too large");
+    }
+    int needed = out->length + extra + 1;
+    if (needed <= out->capacity) {
+        return;
+    }
+    int new_capacity = out->capacity < INT_MAX / 2 ? out->capacity * 2 : INT_MAX;
+    if (new_capacity < needed) new_capacity = needed;
+    char *data;
+    if (out->data == out->stack) {
+        data = malloc(new_capacity);
+        if (data) memcpy(data, out->stack, out->length);
+    } else {
+        data = realloc(out->data, new_capacity);
+    }
+    if (!data) {
+        hml_runtime_error("Memory allocation failed");
+    }
+    out->data = data;
+    out->capacity = new_capacity;
+}
+
+static void interp_write(InterpBuf *out, const char *bytes, int len) {
+    interp_reserve(out, len);
+    memcpy(out->data + out->length, bytes, len);
+    out->length += len;
+}
+
+// Append a value as hml_to_string() would write it
+static void interp_append_value(InterpBuf *out, HmlValue val) {
+    switch (val.type) {
+        case HML_VAL_STRING:
+            if (val.as.as_string) {
+                interp_write(out, val.as.as_string->data, val.as.as_string->length);
+            }
+            return;
+        case HML_VAL_RUNE:
+            if (val.as.as_rune != 0) {
+                interp_reserve(out, 4);
+                out->length += utf8_encode(out->data + out->length, val.as.as_rune);
+            }
+            return;
+        case HML_VAL_BOOL:
+            if (val.as.as_bool) {
+                interp_write(out, "true", 4);
+            } else {
+                interp_write(out, "false", 5);
+            }
+            return;
+        case HML_VAL_NULL:
+            interp_write(out, "null", 4);
+            return;
+        case HML_VAL_I8: case HML_VAL_I16: case HML_VAL_I32: case HML_VAL_I64:
+        case HML_VAL_U8: case HML_VAL_U16: case HML_VAL_U32:
+            // Numbers are formatted in place
+            interp_reserve(out, HML_NUMBER_MAX);
+            out->length += hml_str_format_i64(out->data + out->length, hml_to_i64(val));
+            return;
+        case HML_VAL_U64:
+            interp_reserve(out, HML_NUMBER_MAX);
+            out->length += hml_str_format_u64(out->data + out->length, val.as.as_u64);
+            return;
+        case HML_VAL_F32: case HML_VAL_F64:
+            interp_reserve(out, HML_NUMBER_MAX);
+            out->length += hml_str_format_f64(out->data + out->length,
+                val.type == HML_VAL_F32 ? (double)val.as.as_f32 : val.as.as_f64);
+            return;
+        default: {
+            HmlValue str = hml_to_string(val);
+            interp_write(out, str.as.as_string->data, str.as.as_string->length);
+            hml_release(&str);
+            return;
+        }
+    }
+}
+
+// lits[0] vals[0] lits[1] ... vals[count - 1] lits[count] as one string, the
+// way chained string + value would build it. Short results are copied into
+// inline string storage; heap buffers are handed to the string as they are.
+HmlValue hml_string_interpolate(const char *const *lits, const int *lit_lens,
+                                const HmlValue *vals, int count) {
+    InterpBuf out;
+    out.data = out.stack;
+    out.length = 0;
+    out.capacity = INTERP_STACK_SIZE;
+
+    for (int i = 0; i < count; i++) {
+        interp_write(&out, lits[i], lit_lens[i]);
+        interp_append_value(&out, vals[i]);
+    }
+    interp_write(&out, lits[count], lit_lens[count]);
+
+    int length = out.length;
+    if (length < HML_STRING_INLINE_CAPACITY || out.data == out.stack) {
+        HmlValue result = string_from_span(out.data, length);
+        if (out.data != out.stack) free(out.data);
+        return result;
+    }
+    out.data[length] = '\0';
+    return hml_val_string_owned(out.data, length, out.capacity);
+}
+
 // ========== BUFFER OPERATIONS ==========
 
 // Buffer indexing
@@ -27,7 +27,9 @@ void hml_sleep(HmlValue seconds) {
     struct timespec ts;
     ts.tv_sec = (time_t)secs;
     ts.tv_nsec = (long)((secs - ts.tv_sec) * 1e9);
+    uint64_t trace_start_ns = HML_TRACE_NOW();
     nanosleep(&ts, NULL);
+    HML_TRACE_SPAN("time", "sleep", trace_start_ns, "ms", (int64_t)(secs * 1000));
 }
 
 // ========== DATETIME FUNCTIONS ==========
@@ -0,0 +1,257 @@
+/*
+ * Hemlock Runtime Library - Buffered Writer Builtins
+ *
+ * A buffered writer is a fixed-capacity buffer of output waiting to go to a
+ * file or file descriptor. Values are formatted straight into the buffer
+ * (numbers with no intermediate string), and the buffer is written out in
+ * one call when the next value does not fit. Values larger than the buffer
+ * are written through directly. BufferedWriter in @stdlib/fs returns one
+ * of these; hml_call_method() dispatches its methods here.
+ */
+
+#include "builtins_internal.h"
+
+#define BW_MIN_CAPACITY 64
+
+// Where a writer's bytes go: a stdio stream, or a raw descriptor
+typedef struct {
+    FILE *fp;
+    int fd;
+} BwTarget;
+
+// Files and descriptors 1 and 2 go through stdio so output stays ordered
+// with print() and eprint()
+static BwTarget bw_target(HmlWriter *writer) {
+    BwTarget target = { NULL, writer->fd };
+    if (writer->file) {
+        if (writer->file->closed) {
+            hml_runtime_error("Cannot write to closed file '%s'", writer->file->path);
+        }
+        target.fp = (FILE *)writer->file->fp;
+    } else if (writer->fd == STDOUT_FILENO) {
+        target.fp = stdout;
+    } else if (writer->fd == STDERR_FILENO) {
+        target.fp = stderr;
+    }
+    return target;
+}
+
+static void bw_emit(BwTarget *target, const char *data, size_t len) {
+    if (target->fp) {
+        if (fwrite(data, 1, len, target->fp) != len) {
+            hml_runtime_error("BufferedWriter write failed: %s", strerror(errno));
+        }
+        return;
+    }
+    while (len > 0) {
+        ssize_t n = write(target->fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            hml_runtime_error("BufferedWriter write failed: %s", strerror(errno));
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+static void bw_drain(HmlWriter *writer, BwTarget *target) {
+    if (writer->length == 0) return;
+    int length = writer->length;
+    writer->length = 0;
+    bw_emit(target, writer->data, (size_t)length);
+}
+
+// Make room for len more bytes, draining the buffer if it is too full
+static void bw_reserve(HmlWriter *writer, BwTarget *target, int len) {
+    if (writer->capacity - writer->length < len) {
+        bw_drain(writer, target);
+    }
+}
+
+static void bw_put(HmlWriter *writer, BwTarget *target, const char *bytes, int len) {
+    bw_reserve(writer, target, len);
+    if (len > writer->capacity) {
+        bw_emit(target, bytes, (size_t)len);
+        return;
+    }
+    memcpy(writer->data + writer->length, bytes, len);
+    writer->length += len;
+}
+
+// Append a value the way string + value would; buffers append their raw bytes
+static void bw_put_value(HmlWriter *writer, BwTarget *target, HmlValue val) {
+    char *dst;
+    int n;
+    switch (val.type) {
+        case HML_VAL_STRING:
+            if (val.as.as_string) {
+                bw_put(writer, target, val.as.as_string->data, val.as.as_string->length);
+            }
+            return;
+        case HML_VAL_BUFFER:
+            if (val.as.as_buffer) {
+                bw_put(writer, target, val.as.as_buffer->data, val.as.as_buffer->length);
+            }
+            return;
+        case HML_VAL_RUNE: {
+            char bytes[4];
+            int len = utf8_encode_rune(val.as.as_rune, bytes);
+            bw_put(writer, target, bytes, len);
+            return;
+        }
+        case HML_VAL_BOOL:
+            if (val.as.as_bool) {
+                bw_put(writer, target, "true", 4);
+            } else {
+                bw_put(writer, target, "false", 5);
+            }
+            return;
+        case HML_VAL_NULL:
+            bw_put(writer, target, "null", 4);
+            return;
+        case HML_VAL_I8: case HML_VAL_I16: case HML_VAL_I32: case HML_VAL_I64:
+        case HML_VAL_U8: case HML_VAL_U16: case HML_VAL_U32: case HML_VAL_U64:
+        case HML_VAL_F32: case HML_VAL_F64:
+            // Numbers are formatted in place, as hml_to_string() would
+            bw_reserve(writer, target, HML_NUMBER_MAX);
+            dst = writer->data + writer->length;
+            if (val.type == HML_VAL_F64) {
+                n = hml_str_format_f64(dst, val.as.as_f64);
+            } else if (val.type == HML_VAL_F32) {
+                n = hml_str_format_f64(dst, val.as.as_f32);
+            } else if (val.type == HML_VAL_U64) {
+                n = hml_str_format_u64(dst, val.as.as_u64);
+            } else {
+                n = hml_str_format_i64(dst, hml_to_i64(val));
+            }
+            writer->length += n;
+            return;
+        default: {
+            // Objects and arrays append their JSON form
+            HmlValue str = (val.type == HML_VAL_OBJECT || val.type == HML_VAL_ARRAY)
+                ? hml_serialize(val) : hml_to_string(val);
+            bw_put(writer, target, str.as.as_string->data, str.as.as_string->length);
+            hml_release(&str);
+            return;
+        }
+    }
+}
+
+
+// Writer for an open file or a descriptor, buffering up to capacity bytes
+HmlValue hml_bw_new(HmlValue target, HmlValue capacity) {
+    HmlFileHandle *file = NULL;
+    int fd = -1;
+    if (target.type == HML_VAL_FILE && target.as.as_file) {
+        file = target.as.as_file;
+        if (file->closed) {
+            hml_runtime_error("Cannot write to closed file '%s'", file->path);
+        }
+        if (file->mode[0] == 'r' && strchr(file->mode, '+') == NULL) {
+            hml_runtime_error("Cannot write to file '%s' opened in read-only mode", file->path);
+        }
+    } else if (hml_is_integer(target)) {
+        fd = hml_to_i32(target);
+        if (fd < 0) {
+            hml_runtime_error("BufferedWriter() invalid file descriptor %d", fd);
+        }
+        if (fd != STDOUT_FILENO && fd != STDERR_FILENO &&
+            hml_sandbox_check(HML_SANDBOX_RESTRICT_FILE_WRITE)) {
+            hml_sandbox_error("writing to file descriptors");
+        }
+    } else {
+        hml_runtime_error("BufferedWriter() target must be a file or file descriptor");
+    }
+
+    int cap = hml_to_i32(capacity);
+    if (cap < BW_MIN_CAPACITY) cap = BW_MIN_CAPACITY;
+
+    HmlWriter *writer = malloc(sizeof(HmlWriter));
+    char *data = malloc((size_t)cap);
+    if (!writer || !data) {
+        free(writer);
+        free(data);
+        hml_runtime_error("Memory allocation failed");
+    }
+    writer->data = data;
+    writer->length = 0;
+    writer->capacity = cap;
+    writer->file = file;
+    writer->fd = fd;
+    writer->closed = 0;
+    writer->ref_count = 1;
+    return hml_val_writer(writer);
+}
+
+// Write out everything buffered and flush the stream
+static void bw_flush(HmlWriter *writer, BwTarget *target) {
+    bw_drain(writer, target);
+    if (target->fp && fflush(target->fp) != 0) {
+        hml_runtime_error("BufferedWriter flush failed: %s", strerror(errno));
+    }
+}
+
+HmlValue hml_writer_method(HmlValue obj, const char *method, HmlValue *args, int num_args) {
+    HmlWriter *writer = obj.as.as_writer;
+
+    // Bytes waiting to be written
+    if (strcmp(method, "buffered") == 0 && num_args == 0) {
+        return hml_val_i32(writer->length);
+    }
+    if (strcmp(method, "close") == 0 && num_args == 0) {
+        // Flushes, but leaves the target open; closing twice is a no-op
+        if (!writer->closed) {
+            BwTarget t = bw_target(writer);
+            writer->closed = 1;
+            bw_flush(writer, &t);
+        }
+        return hml_val_null();
+    }
+
+    if (writer->closed) {
+        hml_runtime_error("Cannot use closed BufferedWriter");
+    }
+    BwTarget t = bw_target(writer);
+
+    if (strcmp(method, "write") == 0 && num_args == 1) {
+        bw_put_value(writer, &t, args[0]);
+        return hml_val_null();
+    }
+    if (strcmp(method, "write_line") == 0 && num_args <= 1) {
+        if (num_args == 1) bw_put_value(writer, &t, args[0]);
+        bw_put(writer, &t, "\n", 1);
+        return hml_val_null();
+    }
+    // The values separated by separator (default ","), then a newline
+    if (strcmp(method, "write_fields") == 0 && (num_args == 1 || num_args == 2)) {
+        if (args[0].type != HML_VAL_ARRAY || !args[0].as.as_array ||
+            (num_args == 2 && (args[1].type != HML_VAL_STRING || !args[1].as.as_string))) {
+            hml_runtime_error("write_fields() expects an array and an optional separator string");
+        }
+        HmlArray *arr = args[0].as.as_array;
+        const char *sep = ",";
+        int sep_len = 1;
+        if (num_args == 2) {
+            sep = args[1].as.as_string->data;
+            sep_len = args[1].as.as_string->length;
+        }
+        for (int i = 0; i < arr->length; i++) {
+            if (i > 0) bw_put(writer, &t, sep, sep_len);
+            bw_put_value(writer, &t, arr->elements[i]);
+        }
+        bw_put(writer, &t, "\n", 1);
+        return hml_val_null();
+    }
+    if (strcmp(method, "flush") == 0 && num_args == 0) {
+        bw_flush(writer, &t);
+        return hml_val_null();
+    }
+
+    hml_runtime_error("BufferedWriter has no method '%s'", method);
+    return hml_val_null();
+}
+
+HmlValue hml_builtin_bw_new(HmlClosureEnv *env, HmlValue target, HmlValue capacity) {
+    (void)env;
+    return hml_bw_new(target, capacity);
+}
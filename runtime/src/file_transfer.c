@@ -0,0 +1,167 @@
+/*
+ * Kernel-assisted file transfer
+ *
+ * copy_file(), socket.send_file() and tar archiving move data between
+ * descriptors without bringing it into user space where the kernel allows
+ * it: copy_file_range between files (which can share extents on
+ * filesystems that support it), then sendfile. Other systems, or descriptor pairs the kernel rejects, fall
+ * back to a read/write loop through one large buffer.
+ */
+
+#define _GNU_SOURCE
+#include "../include/hemlock_runtime.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#define TRANSFER_CHUNK (1L << 30)
+#define TRANSFER_BUFFER_SIZE (256 * 1024)
+
+// The kernel cannot transfer between this pair of descriptors
+static int transfer_unsupported(int err) {
+    return err == ENOSYS || err == EINVAL || err == EXDEV ||
+           err == EOPNOTSUPP || err == EPERM;
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int64_t hml_fd_copy(int src_fd, int dest_fd) {
+    return hml_fd_copy_n(src_fd, dest_fd, INT64_MAX);
+}
+
+int64_t hml_fd_copy_n(int src_fd, int dest_fd, int64_t count) {
+    int64_t total = 0;
+
+#ifdef __linux__
+    // copy_file_range returns 0 for files whose size the kernel does not
+    // know (procfs, sysfs), so an empty first result falls through to read()
+    while (total < count) {
+        int64_t want = count - total;
+        ssize_t n = copy_file_range(src_fd, NULL, dest_fd, NULL, want > TRANSFER_CHUNK ? TRANSFER_CHUNK : (size_t)want, 0);
+        if (n > 0) {
+            total += n;
+            continue;
+        }
+        if (n == 0) {
+            if (total > 0) return total;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (total == 0 && transfer_unsupported(errno)) break;
+        return -1;
+    }
+    if (total == count) return total;
+
+    while (total < count) {
+        int64_t want = count - total;
+        ssize_t n = sendfile(dest_fd, src_fd, NULL, want > TRANSFER_CHUNK ? TRANSFER_CHUNK : (size_t)want);
+        if (n > 0) {
+            total += n;
+            continue;
+        }
+        if (n == 0) {
+            if (total > 0) return total;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (total == 0 && transfer_unsupported(errno)) break;
+        return -1;
+    }
+    if (total == count) return total;
+#endif
+
+    char *buffer = malloc(TRANSFER_BUFFER_SIZE);
+    if (!buffer) {
+        errno = ENOMEM;
+        return -1;
+    }
+    while (total < count) {
+        int64_t want = count - total;
+        ssize_t n = read(src_fd, buffer, want > TRANSFER_BUFFER_SIZE ? TRANSFER_BUFFER_SIZE : (size_t)want);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free(buffer);
+            return -1;
+        }
+        if (write_all(dest_fd, buffer, (size_t)n) != 0) {
+            free(buffer);
+            return -1;
+        }
+        total += n;
+    }
+    free(buffer);
+    return total;
+}
+
+int64_t hml_fd_send_file(int sock_fd, int file_fd, int64_t offset, int64_t count, int nonblocking) {
+    int64_t total = 0;
+
+#ifdef __linux__
+    off_t off = (off_t)offset;
+    while (total < count) {
+        int64_t want = count - total;
+        ssize_t n = sendfile(sock_fd, file_fd, &off, want > TRANSFER_CHUNK ? TRANSFER_CHUNK : (size_t)want);
+        if (n > 0) {
+            total += n;
+            continue;
+        }
+        if (n == 0) return total;  // File ended early
+        if (errno == EINTR) continue;
+        if (nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) return total;
+        if (total == 0 && transfer_unsupported(errno)) break;
+        return -1;
+    }
+    if (total == count) return total;
+#endif
+
+    char *buffer = malloc(TRANSFER_BUFFER_SIZE);
+    if (!buffer) {
+        errno = ENOMEM;
+        return -1;
+    }
+    while (total < count) {
+        int64_t want = count - total;
+        ssize_t n = pread(file_fd, buffer, want > TRANSFER_BUFFER_SIZE ? TRANSFER_BUFFER_SIZE : (size_t)want,
+                          (off_t)(offset + total));
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free(buffer);
+            return -1;
+        }
+        ssize_t done = 0;
+        while (done < n) {
+            ssize_t sent = send(sock_fd, buffer + done, (size_t)(n - done), 0);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    free(buffer);
+                    return total + done;
+                }
+                free(buffer);
+                return -1;
+            }
+            done += sent;
+        }
+        total += n;
+    }
+    free(buffer);
+    return total;
+}
@@ -0,0 +1,426 @@
+/*
+ * Hemlock Runtime Library - Cycle Collector
+ *
+ * Compiled-program counterpart of the interpreter's trial-deletion cycle
+ * collector (src/backends/interpreter/gc.c). hml_release() buffers an
+ * object or array whose refcount drops to a nonzero value; a collection
+ * traces the graph reachable from the buffered containers, subtracts the
+ * references that come from inside it, keeps everything still reachable
+ * from an externally referenced container and frees the rest.
+ *
+ * Only objects and arrays are traced. Compiled closures never release
+ * their environment (see function_free in value.c), so a function is a
+ * leaf here and anything its environment holds counts as external.
+ *
+ * Collections run from gc_collect() and automatically once
+ * hml_g_gc_threshold containers have been allocated since the last one,
+ * but only while no task is running.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+int hml_g_gc_allocations = 0;
+int hml_g_gc_threshold = HML_GC_INITIAL_THRESHOLD;
+
+static pthread_mutex_t gc_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int gc_live_tasks = 0;
+
+// Candidate buffer: tagged pointers (see GC_TAG), NULL = forgotten. Each
+// container's gc_buffered holds its index + 1, so forgetting is O(1).
+static void **gc_buffer = NULL;
+static int gc_buffer_count = 0;
+static int gc_buffer_capacity = 0;
+static int gc_buffer_holes = 0;
+
+static long gc_collections = 0;
+static long gc_collected = 0;
+static int gc_last_traced = 0;
+static double gc_pause_ms = 0.0;
+
+// Containers are at least 8-byte aligned, so the kind fits in the low bit
+#define GC_TAG(ptr, kind) ((void*)((uintptr_t)(ptr) | (uintptr_t)(kind)))
+#define GC_UNTAG_PTR(tagged) ((void*)((uintptr_t)(tagged) & ~(uintptr_t)1))
+#define GC_UNTAG_KIND(tagged) ((HmlGCKind)((uintptr_t)(tagged) & 1))
+
+// ========== CANDIDATE BUFFER ==========
+
+static int *gc_flag(void *ptr, HmlGCKind kind) {
+    if (kind == HML_GC_KIND_OBJECT) return &((HmlObject*)ptr)->gc_buffered;
+    return &((HmlArray*)ptr)->gc_buffered;
+}
+
+// With no task running only this thread touches the buffer
+static int gc_lock_buffer(void) {
+    if (atomic_load(&gc_live_tasks) == 0) return 0;
+    pthread_mutex_lock(&gc_lock);
+    return 1;
+}
+
+static void gc_unlock_buffer(int locked) {
+    if (locked) pthread_mutex_unlock(&gc_lock);
+}
+
+// Squeeze out forgotten slots, renumbering the survivors
+static void gc_buffer_compact(void) {
+    int live = 0;
+    for (int i = 0; i < gc_buffer_count; i++) {
+        void *tagged = gc_buffer[i];
+        if (!tagged) continue;
+        gc_buffer[live++] = tagged;
+        *gc_flag(GC_UNTAG_PTR(tagged), GC_UNTAG_KIND(tagged)) = live;
+    }
+    gc_buffer_count = live;
+    gc_buffer_holes = 0;
+}
+
+void hml_gc_buffer_candidate(void *ptr, HmlGCKind kind) {
+    int *flag = gc_flag(ptr, kind);
+    int locked = gc_lock_buffer();
+    if (!*flag) {
+        if (gc_buffer_count == gc_buffer_capacity) {
+            if (gc_buffer_holes > gc_buffer_count / 2) {
+                gc_buffer_compact();
+            } else {
+                int new_capacity = gc_buffer_capacity ? gc_buffer_capacity * 2 : 256;
+                void **new_buffer = realloc(gc_buffer, sizeof(void*) * (size_t)new_capacity);
+                if (!new_buffer) {
+                    fprintf(stderr, "Runtime error: Failed to allocate cycle collector buffer\n");
+                    exit(1);
+                }
+                gc_buffer = new_buffer;
+                gc_buffer_capacity = new_capacity;
+            }
+        }
+        gc_buffer[gc_buffer_count++] = GC_TAG(ptr, kind);
+        *flag = gc_buffer_count;
+    }
+    gc_unlock_buffer(locked);
+}
+
+void hml_gc_forget(void *ptr, HmlGCKind kind) {
+    int *flag = gc_flag(ptr, kind);
+    int locked = gc_lock_buffer();
+    int slot = *flag;
+    if (slot) {
+        gc_buffer[slot - 1] = NULL;
+        gc_buffer_holes++;
+        *flag = 0;
+        // Containers are usually freed in the reverse order they were buffered
+        while (gc_buffer_count > 0 && !gc_buffer[gc_buffer_count - 1]) {
+            gc_buffer_count--;
+            gc_buffer_holes--;
+        }
+    }
+    gc_unlock_buffer(locked);
+}
+
+void hml_gc_task_started(void) {
+    atomic_fetch_add(&gc_live_tasks, 1);
+}
+
+void hml_gc_task_finished(void) {
+    atomic_fetch_sub(&gc_live_tasks, 1);
+}
+
+// ========== TRACED GRAPH ==========
+
+typedef struct {
+    void *ptr;
+    HmlGCKind kind;
+    int refs;       // Refcount minus references from inside the graph
+    int reachable;  // Reachable from outside the graph
+} GCNode;
+
+typedef struct {
+    GCNode *nodes;
+    int count;
+    int capacity;
+    int *index;         // Open-addressing map: slot -> node index + 1 (0 = empty)
+    int index_capacity;
+    int *stack;         // Worklist of node indices
+    int stack_count;
+    int stack_capacity;
+} GCGraph;
+
+static void *gc_realloc(void *p, size_t size) {
+    p = realloc(p, size);
+    if (!p) {
+        fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+        exit(1);
+    }
+    return p;
+}
+
+static inline size_t gc_slot(void *ptr, int capacity) {
+    uint64_t h = ((uint64_t)(uintptr_t)ptr >> 3) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 32) & (size_t)(capacity - 1);
+}
+
+static int gc_lookup(GCGraph *g, void *ptr) {
+    size_t mask = (size_t)g->index_capacity - 1;
+    for (size_t i = gc_slot(ptr, g->index_capacity); g->index[i]; i = (i + 1) & mask) {
+        if (g->nodes[g->index[i] - 1].ptr == ptr) return g->index[i] - 1;
+    }
+    return -1;
+}
+
+static void gc_index_insert(GCGraph *g, int node) {
+    size_t mask = (size_t)g->index_capacity - 1;
+    size_t i = gc_slot(g->nodes[node].ptr, g->index_capacity);
+    while (g->index[i]) i = (i + 1) & mask;
+    g->index[i] = node + 1;
+}
+
+static void gc_push(GCGraph *g, int node) {
+    if (g->stack_count == g->stack_capacity) {
+        g->stack_capacity *= 2;
+        g->stack = gc_realloc(g->stack, sizeof(int) * (size_t)g->stack_capacity);
+    }
+    g->stack[g->stack_count++] = node;
+}
+
+// Add a container to the graph (if new) and queue it for tracing
+static void gc_add(GCGraph *g, void *ptr, HmlGCKind kind) {
+    if (gc_lookup(g, ptr) >= 0) return;
+
+    if (g->count == g->capacity) {
+        g->capacity *= 2;
+        g->nodes = gc_realloc(g->nodes, sizeof(GCNode) * (size_t)g->capacity);
+    }
+    if ((g->count + 1) * 2 > g->index_capacity) {
+        free(g->index);
+        g->index_capacity *= 2;
+        g->index = calloc((size_t)g->index_capacity, sizeof(int));
+        if (!g->index) {
+            fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+            exit(1);
+        }
+        for (int i = 0; i < g->count; i++) gc_index_insert(g, i);
+    }
+
+    int node = g->count++;
+    g->nodes[node].ptr = ptr;
+    g->nodes[node].kind = kind;
+    g->nodes[node].refs = kind == HML_GC_KIND_OBJECT ? ((HmlObject*)ptr)->ref_count
+                                                      : ((HmlArray*)ptr)->ref_count;
+    g->nodes[node].reachable = 0;
+    gc_index_insert(g, node);
+    gc_push(g, node);
+}
+
+typedef enum { GC_DISCOVER, GC_SUBTRACT, GC_MARK } GCPhase;
+
+static void gc_edge(GCGraph *g, GCPhase phase, HmlValue v) {
+    void *child;
+    HmlGCKind kind;
+    if (v.type == HML_VAL_OBJECT && v.as.as_object) {
+        child = v.as.as_object;
+        kind = HML_GC_KIND_OBJECT;
+    } else if (v.type == HML_VAL_ARRAY && v.as.as_array) {
+        child = v.as.as_array;
+        kind = HML_GC_KIND_ARRAY;
+    } else {
+        return;
+    }
+
+    if (phase == GC_DISCOVER) {
+        gc_add(g, child, kind);
+        return;
+    }
+    int node = gc_lookup(g, child);
+    if (node < 0) return;
+    if (phase == GC_SUBTRACT) {
+        g->nodes[node].refs--;
+    } else if (!g->nodes[node].reachable) {
+        g->nodes[node].reachable = 1;
+        gc_push(g, node);
+    }
+}
+
+// Visit every value a container holds a refcount on
+static void gc_children(GCGraph *g, GCPhase phase, int node) {
+    if (g->nodes[node].kind == HML_GC_KIND_OBJECT) {
+        HmlObject *obj = g->nodes[node].ptr;
+        for (int i = 0; i < obj->num_fields; i++) gc_edge(g, phase, obj->field_values[i]);
+    } else {
+        HmlArray *arr = g->nodes[node].ptr;
+        for (int i = 0; i < arr->length; i++) gc_edge(g, phase, arr->elements[i]);
+    }
+}
+
+// ========== COLLECTION ==========
+
+static HmlValue gc_node_value(GCNode *n) {
+    HmlValue v;
+    if (n->kind == HML_GC_KIND_OBJECT) {
+        v.type = HML_VAL_OBJECT;
+        v.as.as_object = n->ptr;
+    } else {
+        v.type = HML_VAL_ARRAY;
+        v.as.as_array = n->ptr;
+    }
+    return v;
+}
+
+static int gc_run(void) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    GCGraph g;
+    g.capacity = 256;
+    g.count = 0;
+    g.nodes = gc_realloc(NULL, sizeof(GCNode) * (size_t)g.capacity);
+    g.index_capacity = 512;
+    g.index = calloc((size_t)g.index_capacity, sizeof(int));
+    g.stack_capacity = 256;
+    g.stack_count = 0;
+    g.stack = gc_realloc(NULL, sizeof(int) * (size_t)g.stack_capacity);
+    if (!g.index) {
+        fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+        exit(1);
+    }
+
+    // Take the candidates; anything released from here on is buffered anew
+    for (int i = 0; i < gc_buffer_count; i++) {
+        void *tagged = gc_buffer[i];
+        if (!tagged) continue;
+        *gc_flag(GC_UNTAG_PTR(tagged), GC_UNTAG_KIND(tagged)) = 0;
+        gc_add(&g, GC_UNTAG_PTR(tagged), GC_UNTAG_KIND(tagged));
+    }
+    gc_buffer_count = 0;
+    gc_buffer_holes = 0;
+
+    // 1. Trace the graph reachable from the candidates
+    while (g.stack_count > 0) {
+        gc_children(&g, GC_DISCOVER, g.stack[--g.stack_count]);
+    }
+
+    // 2. Subtract internal references
+    for (int i = 0; i < g.count; i++) {
+        gc_children(&g, GC_SUBTRACT, i);
+    }
+
+    // 3. Keep everything reachable from an externally referenced container
+    for (int i = 0; i < g.count; i++) {
+        if (g.nodes[i].refs > 0) {
+            g.nodes[i].reachable = 1;
+            gc_push(&g, i);
+        }
+    }
+    while (g.stack_count > 0) {
+        gc_children(&g, GC_MARK, g.stack[--g.stack_count]);
+    }
+
+    // 4. Free the rest: hold each one, drop what it holds, then drop the
+    // holds so the normal free path runs exactly once per container
+    int freed = 0;
+    for (int i = 0; i < g.count; i++) {
+        if (!g.nodes[i].reachable) {
+            g.nodes[freed++] = g.nodes[i];
+        }
+    }
+    for (int i = 0; i < freed; i++) {
+        HmlValue v = gc_node_value(&g.nodes[i]);
+        hml_retain(&v);
+    }
+    for (int i = 0; i < freed; i++) {
+        if (g.nodes[i].kind == HML_GC_KIND_OBJECT) {
+            HmlObject *obj = g.nodes[i].ptr;
+            for (int j = 0; j < obj->num_fields; j++) {
+                HmlValue v = obj->field_values[j];
+                obj->field_values[j] = hml_val_null();
+                hml_release(&v);
+            }
+        } else {
+            HmlArray *arr = g.nodes[i].ptr;
+            for (int j = 0; j < arr->length; j++) {
+                HmlValue v = arr->elements[j];
+                arr->elements[j] = hml_val_null();
+                hml_release(&v);
+            }
+        }
+    }
+    for (int i = 0; i < freed; i++) {
+        HmlValue v = gc_node_value(&g.nodes[i]);
+        hml_release(&v);
+    }
+
+    gc_last_traced = g.count;
+    gc_collections++;
+    gc_collected += freed;
+    hml_g_gc_allocations = 0;
+    hml_g_gc_threshold = g.count > HML_GC_INITIAL_THRESHOLD ? g.count : HML_GC_INITIAL_THRESHOLD;
+
+    free(g.nodes);
+    free(g.index);
+    free(g.stack);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    gc_pause_ms += (double)(end.tv_sec - start.tv_sec) * 1000.0 +
+                   (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+    return freed;
+}
+
+// Set while a collection runs, so a collection is never nested in another
+static int gc_running = 0;
+
+static int gc_collect_now(void) {
+    if (atomic_load(&gc_live_tasks) > 0) return -1;
+    if (gc_running) return 0;
+    gc_running = 1;
+    int freed = gc_run();
+    gc_running = 0;
+    return freed;
+}
+
+void hml_gc_collect_if_due(void) {
+    if (atomic_load(&gc_live_tasks) > 0) {
+        // Try again after another threshold's worth of allocations
+        hml_g_gc_allocations = 0;
+        return;
+    }
+    gc_collect_now();
+}
+
+// ========== BUILTINS ==========
+
+static void gc_set_field(HmlValue obj, const char *name, HmlValue val) {
+    hml_object_set_field(obj, name, val);
+    hml_release(&val);
+}
+
+HmlValue hml_gc_collect(void) {
+    int freed = gc_collect_now();
+    return hml_val_i32(freed > 0 ? freed : 0);
+}
+
+HmlValue hml_gc_stats(void) {
+    pthread_mutex_lock(&gc_lock);
+    int candidates = gc_buffer_count - gc_buffer_holes;
+    pthread_mutex_unlock(&gc_lock);
+
+    HmlValue result = hml_val_object();
+    gc_set_field(result, "collections", hml_val_i64(gc_collections));
+    gc_set_field(result, "collected", hml_val_i64(gc_collected));
+    gc_set_field(result, "candidates", hml_val_i32(candidates));
+    gc_set_field(result, "traced", hml_val_i32(gc_last_traced));
+    gc_set_field(result, "threshold", hml_val_i32(hml_g_gc_threshold));
+    gc_set_field(result, "pause_ms", hml_val_f64(gc_pause_ms));
+    return result;
+}
+
+HmlValue hml_builtin_gc_collect(HmlClosureEnv *env) {
+    (void)env;
+    return hml_gc_collect();
+}
+
+HmlValue hml_builtin_gc_stats(HmlClosureEnv *env) {
+    (void)env;
+    return hml_gc_stats();
+}
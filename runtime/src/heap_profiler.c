@@ -0,0 +1,605 @@
+/*
+ * Hemlock Runtime Library - Allocation / Heap Profiler
+ *
+ * Compiled-program counterpart of the interpreter's heap profiler, enabled
+ * by running the binary with HEMLOCK_HEAP_PROFILE=1. The value constructors
+ * and free paths call HML_HEAP_TRACK_ALLOC / HML_HEAP_TRACK_FREE, a single
+ * predictable branch while tracking is off.
+ *
+ * Every live string, array, object and buffer is kept in a pointer-keyed
+ * hash table with its kind and size. Every HML_HEAP_SAMPLE_INTERVAL-th
+ * allocation per thread records the allocating call stack, taken from the
+ * profiler shadow stack; binaries built without `--profile` have no shadow
+ * stack and attribute everything to <main> / <task>.
+ *
+ * heap_stats() and heap_snapshot(path) produce the same shapes as under
+ * `hemlock --heap-profile`.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEAP_TOP_N 20
+#define HEAP_MAX_DEPTH 64
+#define HEAP_PREVIEW_LENGTH 40
+
+int hml_g_heap_tracking = 0;
+
+typedef struct {
+    void *ptr;          // NULL = empty slot
+    size_t bytes;       // Size at allocation time
+    uint32_t site;      // Index + 1 into sites, 0 = allocation was not sampled
+    uint8_t kind;       // HmlHeapKind
+} HeapRecord;
+
+typedef struct {
+    long live;
+    long live_bytes;
+    long allocs;
+    long alloc_bytes;
+} HeapKindStats;
+
+typedef struct {
+    char *stack;        // Folded call stack, "<main>;caller;callee"
+    long allocs;
+    long bytes;
+    long live;
+    long live_bytes;
+} HeapSiteStats;
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static HeapRecord *records = NULL;
+static size_t record_capacity = 0;   // Power of two
+static size_t record_count = 0;
+
+static HeapKindStats kind_stats[HML_HEAP_KIND_COUNT];
+static long live_bytes_total = 0;
+static long peak_bytes_total = 0;
+
+static HeapSiteStats *sites = NULL;
+static int site_count = 0;
+static int site_capacity = 0;
+static int *site_index = NULL;       // Open addressing: site position + 1, 0 = empty
+static int site_index_capacity = 0;  // Power of two
+
+// Set on the thread that enabled tracking; every other thread is a task
+static __thread int heap_is_main_thread = 0;
+static __thread int sample_countdown = HML_HEAP_SAMPLE_INTERVAL;
+
+static const char *kind_names[HML_HEAP_KIND_COUNT] = {"string", "array", "object", "buffer"};
+
+// ========== POINTER TABLE ==========
+
+static size_t ptr_hash(void *ptr) {
+    uintptr_t p = (uintptr_t)ptr >> 4;  // malloc results are 16-byte aligned
+    return (size_t)(p * 0x9E3779B97F4A7C15ULL);
+}
+
+static void records_grow(void) {
+    size_t old_capacity = record_capacity;
+    HeapRecord *old = records;
+
+    record_capacity = old_capacity == 0 ? 1024 : old_capacity * 2;
+    records = calloc(record_capacity, sizeof(HeapRecord));
+    if (!records) {
+        fprintf(stderr, "Fatal error: Failed to grow heap profiler table\n");
+        exit(1);
+    }
+    size_t mask = record_capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].ptr) {
+            size_t slot = ptr_hash(old[i].ptr) & mask;
+            while (records[slot].ptr) slot = (slot + 1) & mask;
+            records[slot] = old[i];
+        }
+    }
+    free(old);
+}
+
+static HeapRecord* records_find(void *ptr) {
+    if (record_capacity == 0) return NULL;
+    size_t mask = record_capacity - 1;
+    size_t slot = ptr_hash(ptr) & mask;
+    while (records[slot].ptr) {
+        if (records[slot].ptr == ptr) return &records[slot];
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+// Linear probing delete with backward shift (no tombstones)
+static void records_remove(HeapRecord *rec) {
+    size_t mask = record_capacity - 1;
+    size_t hole = (size_t)(rec - records);
+    size_t slot = hole;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (!records[slot].ptr) break;
+        size_t home = ptr_hash(records[slot].ptr) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            records[hole] = records[slot];
+            hole = slot;
+        }
+    }
+    records[hole].ptr = NULL;
+    record_count--;
+}
+
+// ========== ALLOCATION SITES ==========
+
+static uint32_t site_hash(const char *s) {
+    uint32_t h = 5381;
+    while (*s) h = ((h << 5) + h) + (unsigned char)*s++;
+    return h;
+}
+
+static void site_index_rebuild(void) {
+    site_index_capacity = site_index_capacity == 0 ? 256 : site_index_capacity * 2;
+    free(site_index);
+    site_index = calloc(site_index_capacity, sizeof(int));
+    int mask = site_index_capacity - 1;
+    for (int i = 0; i < site_count; i++) {
+        int slot = (int)(site_hash(sites[i].stack) & mask);
+        while (site_index[slot]) slot = (slot + 1) & mask;
+        site_index[slot] = i + 1;
+    }
+}
+
+// Takes ownership of stack. Returns site position + 1.
+static uint32_t site_intern(char *stack) {
+    if ((site_count + 1) * 2 > site_index_capacity) {
+        site_index_rebuild();
+    }
+    int mask = site_index_capacity - 1;
+    int slot = (int)(site_hash(stack) & mask);
+    while (site_index[slot]) {
+        int pos = site_index[slot] - 1;
+        if (strcmp(sites[pos].stack, stack) == 0) {
+            free(stack);
+            return (uint32_t)pos + 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (site_count >= site_capacity) {
+        site_capacity = site_capacity == 0 ? 64 : site_capacity * 2;
+        sites = realloc(sites, sizeof(HeapSiteStats) * site_capacity);
+    }
+    HeapSiteStats *site = &sites[site_count];
+    memset(site, 0, sizeof(*site));
+    site->stack = stack;
+    site_index[slot] = ++site_count;
+    return (uint32_t)site_count;
+}
+
+// Fold the shadow stack into "<main>;caller;callee" (only populated under --profile)
+static char* capture_stack(void) {
+    const char *label = heap_is_main_thread ? "<main>" : "<task>";
+    int depth = hml_g_profile_depth;
+    int first = 0;
+    if (depth > HML_PROFILE_STACK_SIZE) first = depth - HML_PROFILE_STACK_SIZE;
+    if (depth - first > HEAP_MAX_DEPTH) first = depth - HEAP_MAX_DEPTH;
+
+    size_t len = strlen(label);
+    for (int i = first; i < depth; i++) {
+        const char *name = hml_g_profile_frames[i & (HML_PROFILE_STACK_SIZE - 1)];
+        len += 1 + strlen(name ? name : "<anonymous>");
+    }
+    char *out = malloc(len + 1);
+    if (!out) return NULL;
+    size_t pos = strlen(label);
+    memcpy(out, label, pos);
+    for (int i = first; i < depth; i++) {
+        const char *name = hml_g_profile_frames[i & (HML_PROFILE_STACK_SIZE - 1)];
+        if (!name) name = "<anonymous>";
+        size_t n = strlen(name);
+        out[pos++] = ';';
+        memcpy(out + pos, name, n);
+        pos += n;
+    }
+    out[pos] = '\0';
+    return out;
+}
+
+// ========== TRACKING HOOKS ==========
+
+// Remove a record's contribution to the live counters (lock held)
+static void record_uncount(HeapRecord *rec) {
+    kind_stats[rec->kind].live--;
+    kind_stats[rec->kind].live_bytes -= (long)rec->bytes;
+    live_bytes_total -= (long)rec->bytes;
+    if (rec->site) {
+        HeapSiteStats *site = &sites[rec->site - 1];
+        site->live--;
+        site->live_bytes -= (long)rec->bytes;
+    }
+}
+
+void hml_heap_track_alloc(void *ptr, HmlHeapKind kind, size_t bytes) {
+    if (!ptr) return;
+
+    // Capture outside the lock; only sampled allocations pay for it
+    char *stack = NULL;
+    if (--sample_countdown <= 0) {
+        sample_countdown = HML_HEAP_SAMPLE_INTERVAL;
+        stack = capture_stack();
+    }
+
+    pthread_mutex_lock(&heap_lock);
+    if ((record_count + 1) * 2 > record_capacity) {
+        records_grow();
+    }
+    size_t mask = record_capacity - 1;
+    size_t slot = ptr_hash(ptr) & mask;
+    while (records[slot].ptr && records[slot].ptr != ptr) slot = (slot + 1) & mask;
+    HeapRecord *rec = &records[slot];
+    if (rec->ptr) {
+        // Address reused after a free path that is not hooked; drop the stale entry
+        record_uncount(rec);
+    } else {
+        record_count++;
+    }
+
+    rec->ptr = ptr;
+    rec->kind = (uint8_t)kind;
+    rec->bytes = bytes;
+    rec->site = 0;
+    if (stack) {
+        rec->site = site_intern(stack);
+        HeapSiteStats *site = &sites[rec->site - 1];
+        site->allocs++;
+        site->bytes += (long)bytes;
+        site->live++;
+        site->live_bytes += (long)bytes;
+    }
+
+    kind_stats[kind].live++;
+    kind_stats[kind].live_bytes += (long)bytes;
+    kind_stats[kind].allocs++;
+    kind_stats[kind].alloc_bytes += (long)bytes;
+    live_bytes_total += (long)bytes;
+    if (live_bytes_total > peak_bytes_total) peak_bytes_total = live_bytes_total;
+    pthread_mutex_unlock(&heap_lock);
+}
+
+void hml_heap_track_free(void *ptr) {
+    if (!ptr) return;
+
+    pthread_mutex_lock(&heap_lock);
+    HeapRecord *rec = records_find(ptr);
+    if (rec) {
+        record_uncount(rec);
+        records_remove(rec);
+    }
+    pthread_mutex_unlock(&heap_lock);
+}
+
+// ========== STATS ==========
+
+static int compare_site_live_bytes(const void *a, const void *b) {
+    const HeapSiteStats *sa = a;
+    const HeapSiteStats *sb = b;
+    if (sa->live_bytes != sb->live_bytes) return sa->live_bytes < sb->live_bytes ? 1 : -1;
+    if (sa->bytes != sb->bytes) return sa->bytes < sb->bytes ? 1 : -1;
+    return strcmp(sa->stack, sb->stack);
+}
+
+// Copy the counters and the top sites by live bytes out from under the lock
+static void heap_copy_stats(HeapKindStats out[HML_HEAP_KIND_COUNT], long *peak_bytes,
+                            HeapSiteStats **top_sites, int *num_sites) {
+    pthread_mutex_lock(&heap_lock);
+    memcpy(out, kind_stats, sizeof(kind_stats));
+    *peak_bytes = peak_bytes_total;
+
+    HeapSiteStats *copy = NULL;
+    int n = site_count;
+    if (n > 0) {
+        copy = malloc(sizeof(HeapSiteStats) * n);
+        for (int i = 0; i < n; i++) {
+            copy[i] = sites[i];
+            copy[i].stack = strdup(sites[i].stack);
+        }
+    }
+    pthread_mutex_unlock(&heap_lock);
+
+    if (copy) {
+        qsort(copy, n, sizeof(HeapSiteStats), compare_site_live_bytes);
+        for (int i = HEAP_TOP_N; i < n; i++) free(copy[i].stack);
+        if (n > HEAP_TOP_N) n = HEAP_TOP_N;
+    }
+    *top_sites = copy;
+    *num_sites = n;
+}
+
+static void heap_sites_free(HeapSiteStats *top_sites, int num_sites) {
+    for (int i = 0; i < num_sites; i++) free(top_sites[i].stack);
+    free(top_sites);
+}
+
+// Set a field and drop the local reference (hml_object_set_field retains)
+static void heap_set_field(HmlValue obj, const char *name, HmlValue val) {
+    hml_object_set_field(obj, name, val);
+    hml_release(&val);
+}
+
+HmlValue hml_heap_stats(void) {
+    HeapKindStats stats[HML_HEAP_KIND_COUNT];
+    long peak = 0;
+    HeapSiteStats *top = NULL;
+    int num_top = 0;
+    heap_copy_stats(stats, &peak, &top, &num_top);
+
+    long live_objects = 0, live_bytes = 0, total_allocs = 0;
+    HmlValue by_type = hml_val_object();
+    for (int k = 0; k < HML_HEAP_KIND_COUNT; k++) {
+        live_objects += stats[k].live;
+        live_bytes += stats[k].live_bytes;
+        total_allocs += stats[k].allocs;
+
+        HmlValue entry = hml_val_object();
+        heap_set_field(entry, "live", hml_val_i64(stats[k].live));
+        heap_set_field(entry, "bytes", hml_val_i64(stats[k].live_bytes));
+        heap_set_field(entry, "allocs", hml_val_i64(stats[k].allocs));
+        heap_set_field(entry, "alloc_bytes", hml_val_i64(stats[k].alloc_bytes));
+        heap_set_field(by_type, kind_names[k], entry);
+    }
+
+    HmlValue site_list = hml_val_array();
+    for (int i = 0; i < num_top; i++) {
+        HmlValue site = hml_val_object();
+        heap_set_field(site, "stack", hml_val_string(top[i].stack));
+        heap_set_field(site, "allocs", hml_val_i64(top[i].allocs));
+        heap_set_field(site, "bytes", hml_val_i64(top[i].bytes));
+        heap_set_field(site, "live", hml_val_i64(top[i].live));
+        heap_set_field(site, "live_bytes", hml_val_i64(top[i].live_bytes));
+        hml_array_push(site_list, site);
+    }
+    heap_sites_free(top, num_top);
+
+    HmlValue result = hml_val_object();
+    heap_set_field(result, "enabled", hml_val_bool(hml_g_heap_tracking));
+    heap_set_field(result, "live_objects", hml_val_i64(live_objects));
+    heap_set_field(result, "live_bytes", hml_val_i64(live_bytes));
+    heap_set_field(result, "peak_bytes", hml_val_i64(peak));
+    heap_set_field(result, "total_allocs", hml_val_i64(total_allocs));
+    heap_set_field(result, "by_type", by_type);
+    heap_set_field(result, "sample_interval", hml_val_i32(HML_HEAP_SAMPLE_INTERVAL));
+    heap_set_field(result, "sites", site_list);
+    return result;
+}
+
+// ========== SNAPSHOT ==========
+
+static void write_json_string(FILE *out, const char *s, int max_len) {
+    fputc('"', out);
+    // A truncated preview still ends on a UTF-8 character boundary
+    for (int i = 0; s[i] && (max_len < 0 || i < max_len || ((unsigned char)s[i] & 0xC0) == 0x80); i++) {
+        unsigned char c = (unsigned char)s[i];
+        switch (c) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (c < 0x20) fprintf(out, "\\u%04x", c);
+                else fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Current size of a live value (its allocation-time size may have grown since)
+static size_t record_current_bytes(HeapRecord *rec) {
+    switch (rec->kind) {
+        case HML_HEAP_KIND_STRING:
+            return sizeof(HmlString) + (size_t)((HmlString*)rec->ptr)->capacity;
+        case HML_HEAP_KIND_ARRAY:
+            return sizeof(HmlArray) + (size_t)((HmlArray*)rec->ptr)->capacity * sizeof(HmlValue);
+        case HML_HEAP_KIND_OBJECT:
+            return sizeof(HmlObject) +
+                   (size_t)((HmlObject*)rec->ptr)->capacity * (sizeof(HmlValue) + sizeof(char*));
+        case HML_HEAP_KIND_BUFFER:
+            return sizeof(HmlBuffer) + (size_t)((HmlBuffer*)rec->ptr)->capacity;
+        default:
+            return rec->bytes;
+    }
+}
+
+static void* value_heap_ptr(HmlValue v) {
+    switch (v.type) {
+        case HML_VAL_STRING: return v.as.as_string;
+        case HML_VAL_ARRAY:  return v.as.as_array;
+        case HML_VAL_OBJECT: return v.as.as_object;
+        case HML_VAL_BUFFER: return v.as.as_buffer;
+        default:             return NULL;
+    }
+}
+
+typedef struct {
+    size_t child;   // Record slot of the referenced value
+    size_t parent;  // Record slot of the container
+} HeapEdge;
+
+static int compare_edges(const void *a, const void *b) {
+    const HeapEdge *ea = a;
+    const HeapEdge *eb = b;
+    if (ea->child != eb->child) return ea->child < eb->child ? -1 : 1;
+    if (ea->parent != eb->parent) return ea->parent < eb->parent ? -1 : 1;
+    return 0;
+}
+
+// Write all live values and their referrers as JSON; returns 0 or an errno value
+static int heap_write_snapshot(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return errno ? errno : EIO;
+
+    pthread_mutex_lock(&heap_lock);
+
+    long *ids = malloc(sizeof(long) * (record_capacity ? record_capacity : 1));
+    long next_id = 1;
+    for (size_t i = 0; i < record_capacity; i++) {
+        ids[i] = records[i].ptr ? next_id++ : 0;
+    }
+
+    HeapEdge *edges = NULL;
+    size_t edge_count = 0, edge_capacity = 0;
+    for (size_t i = 0; i < record_capacity; i++) {
+        HeapRecord *rec = &records[i];
+        if (!rec->ptr) continue;
+        HmlValue *values = NULL;
+        int n = 0;
+        if (rec->kind == HML_HEAP_KIND_ARRAY) {
+            values = ((HmlArray*)rec->ptr)->elements;
+            n = ((HmlArray*)rec->ptr)->length;
+        } else if (rec->kind == HML_HEAP_KIND_OBJECT) {
+            values = ((HmlObject*)rec->ptr)->field_values;
+            n = ((HmlObject*)rec->ptr)->num_fields;
+        }
+        for (int j = 0; j < n; j++) {
+            void *child_ptr = value_heap_ptr(values[j]);
+            if (!child_ptr) continue;
+            HeapRecord *child = records_find(child_ptr);
+            if (!child) continue;
+            if (edge_count >= edge_capacity) {
+                edge_capacity = edge_capacity == 0 ? 1024 : edge_capacity * 2;
+                edges = realloc(edges, sizeof(HeapEdge) * edge_capacity);
+            }
+            edges[edge_count].child = (size_t)(child - records);
+            edges[edge_count].parent = i;
+            edge_count++;
+        }
+    }
+    if (edge_count > 0) {
+        qsort(edges, edge_count, sizeof(HeapEdge), compare_edges);
+    }
+
+    fprintf(out, "{\n  \"live_objects\": %zu,\n  \"live_bytes\": %ld,\n  \"peak_bytes\": %ld,\n",
+            record_count, live_bytes_total, peak_bytes_total);
+    fprintf(out, "  \"sample_interval\": %d,\n  \"objects\": [", HML_HEAP_SAMPLE_INTERVAL);
+
+    int first_object = 1;
+    size_t e = 0;
+    for (size_t i = 0; i < record_capacity; i++) {
+        HeapRecord *rec = &records[i];
+        if (!rec->ptr) continue;
+
+        int ref_count = 0;
+        switch (rec->kind) {
+            case HML_HEAP_KIND_STRING: ref_count = ((HmlString*)rec->ptr)->ref_count; break;
+            case HML_HEAP_KIND_ARRAY:  ref_count = ((HmlArray*)rec->ptr)->ref_count; break;
+            case HML_HEAP_KIND_OBJECT: ref_count = ((HmlObject*)rec->ptr)->ref_count; break;
+            case HML_HEAP_KIND_BUFFER: ref_count = ((HmlBuffer*)rec->ptr)->ref_count; break;
+        }
+
+        fprintf(out, "%s\n    {\"id\": %ld, \"type\": \"%s\", \"bytes\": %zu, \"refcount\": %d",
+                first_object ? "" : ",", ids[i], kind_names[rec->kind],
+                record_current_bytes(rec), ref_count);
+        first_object = 0;
+
+        if (rec->kind == HML_HEAP_KIND_OBJECT && ((HmlObject*)rec->ptr)->type_name) {
+            fputs(", \"class\": ", out);
+            write_json_string(out, ((HmlObject*)rec->ptr)->type_name, -1);
+        } else if (rec->kind == HML_HEAP_KIND_STRING && ((HmlString*)rec->ptr)->data) {
+            fputs(", \"preview\": ", out);
+            write_json_string(out, ((HmlString*)rec->ptr)->data, HEAP_PREVIEW_LENGTH);
+        }
+
+        fputs(", \"site\": ", out);
+        if (rec->site) {
+            write_json_string(out, sites[rec->site - 1].stack, -1);
+        } else {
+            fputs("null", out);
+        }
+
+        fputs(", \"referrers\": [", out);
+        while (e < edge_count && edges[e].child < i) e++;
+        int first_ref = 1;
+        size_t last_parent = (size_t)-1;
+        for (; e < edge_count && edges[e].child == i; e++) {
+            if (edges[e].parent == last_parent) continue;  // Same container, several slots
+            last_parent = edges[e].parent;
+            fprintf(out, "%s%ld", first_ref ? "" : ", ", ids[edges[e].parent]);
+            first_ref = 0;
+        }
+        fputs("]}", out);
+    }
+    fputs("\n  ]\n}\n", out);
+
+    pthread_mutex_unlock(&heap_lock);
+
+    free(edges);
+    free(ids);
+    int failed = ferror(out);
+    if (fclose(out) != 0 || failed) return EIO;
+    return 0;
+}
+
+HmlValue hml_heap_snapshot(HmlValue path) {
+    if (path.type != HML_VAL_STRING || !path.as.as_string) {
+        hml_runtime_error("heap_snapshot() expects 1 string argument (path)");
+    }
+    if (!hml_g_heap_tracking) {
+        hml_runtime_error("heap_snapshot() requires heap profiling (run with HEMLOCK_HEAP_PROFILE=1)");
+    }
+    const char *file = path.as.as_string->data;
+    int err = heap_write_snapshot(file);
+    if (err != 0) {
+        hml_runtime_error("heap_snapshot() failed to write '%s': %s", file, strerror(err));
+    }
+    return hml_val_null();
+}
+
+HmlValue hml_builtin_heap_stats(HmlClosureEnv *env) {
+    (void)env;
+    return hml_heap_stats();
+}
+
+HmlValue hml_builtin_heap_snapshot(HmlClosureEnv *env, HmlValue path) {
+    (void)env;
+    return hml_heap_snapshot(path);
+}
+
+// ========== LIFECYCLE ==========
+
+static void heap_profiler_report(void) {
+    HeapKindStats stats[HML_HEAP_KIND_COUNT];
+    long peak = 0;
+    HeapSiteStats *top = NULL;
+    int num_top = 0;
+    heap_copy_stats(stats, &peak, &top, &num_top);
+
+    long live = 0;
+    for (int k = 0; k < HML_HEAP_KIND_COUNT; k++) live += stats[k].live_bytes;
+
+    fflush(stdout);  // Keep program output ahead of the summary
+    fprintf(stderr, "\n=== Heap profile: %ld bytes live at exit, %ld peak ===\n", live, peak);
+    fprintf(stderr, "%-8s %10s %12s %10s %12s\n", "type", "live", "live bytes", "allocs", "alloc bytes");
+    for (int k = 0; k < HML_HEAP_KIND_COUNT; k++) {
+        fprintf(stderr, "%-8s %10ld %12ld %10ld %12ld\n", kind_names[k],
+                stats[k].live, stats[k].live_bytes, stats[k].allocs, stats[k].alloc_bytes);
+    }
+    if (num_top > 0) {
+        fprintf(stderr, "\nSampled allocation sites (1 in %d), by live bytes:\n", HML_HEAP_SAMPLE_INTERVAL);
+        fprintf(stderr, "%10s %12s %10s  %s\n", "live", "live bytes", "allocs", "stack");
+        for (int i = 0; i < num_top; i++) {
+            fprintf(stderr, "%10ld %12ld %10ld  %s\n",
+                    top[i].live, top[i].live_bytes, top[i].allocs, top[i].stack);
+        }
+    }
+    heap_sites_free(top, num_top);
+}
+
+void hml_heap_profiler_init(void) {
+    const char *env = getenv("HEMLOCK_HEAP_PROFILE");
+    if (!env || !env[0] || strcmp(env, "0") == 0) return;
+    if (hml_g_heap_tracking) return;
+    heap_is_main_thread = 1;
+    hml_g_heap_tracking = 1;
+    atexit(heap_profiler_report);
+}
@@ -0,0 +1,255 @@
+/*
+ * Hemlock Runtime Library - Slab Allocator
+ *
+ * Compiled-program counterpart of the interpreter's slab allocator
+ * (src/backends/interpreter/slab.c). Value headers and short strings with
+ * their bytes inline come from 16-byte size classes up to
+ * HML_SLAB_MAX_SIZE instead of malloc.
+ *
+ * Each thread pops and pushes its own free lists without locking; lists
+ * refill from and spill to a shared depot in batches, and a thread's
+ * blocks go back to the depot when it exits. Chunks are never returned to
+ * the system. AddressSanitizer builds use plain malloc/free.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLAB_CLASS_SIZE 16
+#define SLAB_NUM_CLASSES (HML_SLAB_MAX_SIZE / SLAB_CLASS_SIZE)
+#define SLAB_CHUNK_SIZE (64 * 1024)
+#define SLAB_BATCH 64
+#define SLAB_CACHE_MAX 512
+
+#if defined(__SANITIZE_ADDRESS__)
+#define SLAB_DISABLED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SLAB_DISABLED 1
+#endif
+#endif
+
+typedef struct SlabBlock {
+    struct SlabBlock *next;
+} SlabBlock;
+
+typedef struct SlabCache {
+    SlabBlock *free_list[SLAB_NUM_CLASSES];
+    int free_count[SLAB_NUM_CLASSES];
+    long allocs;                // Written by the owning thread only
+    long frees;
+    long inline_strings;
+    struct SlabCache *next;     // Registry of live thread caches
+    struct SlabCache *prev;
+} SlabCache;
+
+static pthread_mutex_t slab_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t slab_key;
+static pthread_once_t slab_key_once = PTHREAD_ONCE_INIT;
+static __thread SlabCache *slab_cache = NULL;
+
+// Shared state, guarded by slab_lock
+static SlabBlock *slab_depot[SLAB_NUM_CLASSES];
+static int slab_depot_count[SLAB_NUM_CLASSES];
+static char *slab_chunk_cursor = NULL;
+static size_t slab_chunk_left = 0;
+static size_t slab_reserved = 0;
+static SlabCache *slab_caches = NULL;
+static long slab_retired_allocs = 0;   // Counters of exited threads
+static long slab_retired_frees = 0;
+static long slab_retired_inline = 0;
+
+// Per-thread counters are read by hml_slab_get_stats() from other threads
+#define SLAB_COUNT(cache, field) \
+    __atomic_store_n(&(cache)->field, (cache)->field + 1, __ATOMIC_RELAXED)
+
+static inline int slab_class(size_t size) {
+    return (int)((size + SLAB_CLASS_SIZE - 1) / SLAB_CLASS_SIZE) - 1;
+}
+
+// Move up to n blocks from the depot or a fresh chunk into the cache.
+// Called with slab_lock held.
+static void slab_refill_locked(SlabCache *cache, int cls, int n) {
+    size_t block_size = (size_t)(cls + 1) * SLAB_CLASS_SIZE;
+    while (n > 0 && slab_depot[cls]) {
+        SlabBlock *b = slab_depot[cls];
+        slab_depot[cls] = b->next;
+        slab_depot_count[cls]--;
+        b->next = cache->free_list[cls];
+        cache->free_list[cls] = b;
+        cache->free_count[cls]++;
+        n--;
+    }
+    while (n > 0) {
+        if (slab_chunk_left < block_size) {
+            // The tail of the old chunk (less than one block) is dropped
+            char *chunk = malloc(SLAB_CHUNK_SIZE);
+            if (!chunk) return;
+            slab_chunk_cursor = chunk;
+            slab_chunk_left = SLAB_CHUNK_SIZE;
+            slab_reserved += SLAB_CHUNK_SIZE;
+        }
+        SlabBlock *b = (SlabBlock *)slab_chunk_cursor;
+        slab_chunk_cursor += block_size;
+        slab_chunk_left -= block_size;
+        b->next = cache->free_list[cls];
+        cache->free_list[cls] = b;
+        cache->free_count[cls]++;
+        n--;
+    }
+}
+
+// Return n blocks of a class from the cache to the depot.
+// Called with slab_lock held.
+static void slab_spill_locked(SlabCache *cache, int cls, int n) {
+    while (n > 0 && cache->free_list[cls]) {
+        SlabBlock *b = cache->free_list[cls];
+        cache->free_list[cls] = b->next;
+        cache->free_count[cls]--;
+        b->next = slab_depot[cls];
+        slab_depot[cls] = b;
+        slab_depot_count[cls]++;
+        n--;
+    }
+}
+
+static void slab_thread_exit(void *arg) {
+    SlabCache *cache = arg;
+    pthread_mutex_lock(&slab_lock);
+    for (int cls = 0; cls < SLAB_NUM_CLASSES; cls++) {
+        slab_spill_locked(cache, cls, cache->free_count[cls]);
+    }
+    slab_retired_allocs += cache->allocs;
+    slab_retired_frees += cache->frees;
+    slab_retired_inline += cache->inline_strings;
+    if (cache->prev) cache->prev->next = cache->next;
+    else slab_caches = cache->next;
+    if (cache->next) cache->next->prev = cache->prev;
+    pthread_mutex_unlock(&slab_lock);
+    free(cache);
+    slab_cache = NULL;  // Later destructors on this thread start a new cache
+}
+
+static void slab_make_key(void) {
+    pthread_key_create(&slab_key, slab_thread_exit);
+}
+
+static SlabCache *slab_thread_cache(void) {
+    SlabCache *cache = slab_cache;
+    if (__builtin_expect(cache != NULL, 1)) return cache;
+
+    cache = calloc(1, sizeof(SlabCache));
+    if (!cache) {
+        fprintf(stderr, "Runtime error: Memory allocation failed\n");
+        exit(1);
+    }
+    pthread_once(&slab_key_once, slab_make_key);
+    pthread_setspecific(slab_key, cache);
+    pthread_mutex_lock(&slab_lock);
+    cache->next = slab_caches;
+    if (slab_caches) slab_caches->prev = cache;
+    slab_caches = cache;
+    pthread_mutex_unlock(&slab_lock);
+    slab_cache = cache;
+    return cache;
+}
+
+void *hml_slab_alloc(size_t size) {
+#ifdef SLAB_DISABLED
+    return malloc(size);
+#else
+    SlabCache *cache = slab_thread_cache();
+    int cls = slab_class(size);
+    SlabBlock *b = cache->free_list[cls];
+    if (__builtin_expect(b == NULL, 0)) {
+        pthread_mutex_lock(&slab_lock);
+        slab_refill_locked(cache, cls, SLAB_BATCH);
+        pthread_mutex_unlock(&slab_lock);
+        b = cache->free_list[cls];
+        if (!b) return NULL;
+    }
+    cache->free_list[cls] = b->next;
+    cache->free_count[cls]--;
+    SLAB_COUNT(cache, allocs);
+    return b;
+#endif
+}
+
+void hml_slab_free(void *ptr, size_t size) {
+#ifdef SLAB_DISABLED
+    (void)size;
+    free(ptr);
+#else
+    if (!ptr) return;
+    SlabCache *cache = slab_thread_cache();
+    int cls = slab_class(size);
+    SlabBlock *b = ptr;
+    b->next = cache->free_list[cls];
+    cache->free_list[cls] = b;
+    SLAB_COUNT(cache, frees);
+    if (__builtin_expect(++cache->free_count[cls] > SLAB_CACHE_MAX, 0)) {
+        pthread_mutex_lock(&slab_lock);
+        slab_spill_locked(cache, cls, SLAB_CACHE_MAX / 2);
+        pthread_mutex_unlock(&slab_lock);
+    }
+#endif
+}
+
+void hml_slab_note_inline_string(void) {
+#ifndef SLAB_DISABLED
+    SlabCache *cache = slab_thread_cache();
+    SLAB_COUNT(cache, inline_strings);
+#endif
+}
+
+void hml_slab_get_stats(HmlSlabStats *out) {
+    memset(out, 0, sizeof(*out));
+#ifndef SLAB_DISABLED
+    out->enabled = 1;
+#endif
+    pthread_mutex_lock(&slab_lock);
+    out->allocs = slab_retired_allocs;
+    out->frees = slab_retired_frees;
+    out->inline_strings = slab_retired_inline;
+    for (SlabCache *c = slab_caches; c; c = c->next) {
+        out->allocs += __atomic_load_n(&c->allocs, __ATOMIC_RELAXED);
+        out->frees += __atomic_load_n(&c->frees, __ATOMIC_RELAXED);
+        out->inline_strings += __atomic_load_n(&c->inline_strings, __ATOMIC_RELAXED);
+    }
+    for (int cls = 0; cls < SLAB_NUM_CLASSES; cls++) {
+        out->depot_blocks += slab_depot_count[cls];
+    }
+    out->reserved_bytes = (long)slab_reserved;
+    pthread_mutex_unlock(&slab_lock);
+}
+
+// ========== BUILTINS ==========
+
+static void slab_set_field(HmlValue obj, const char *name, HmlValue val) {
+    hml_object_set_field(obj, name, val);
+    hml_release(&val);
+}
+
+HmlValue hml_alloc_stats(void) {
+    HmlSlabStats stats;
+    hml_slab_get_stats(&stats);
+
+    HmlValue result = hml_val_object();
+    slab_set_field(result, "enabled", hml_val_bool(stats.enabled));
+    slab_set_field(result, "allocs", hml_val_i64(stats.allocs));
+    slab_set_field(result, "frees", hml_val_i64(stats.frees));
+    slab_set_field(result, "live", hml_val_i64(stats.allocs - stats.frees));
+    slab_set_field(result, "inline_strings", hml_val_i64(stats.inline_strings));
+    slab_set_field(result, "depot_blocks", hml_val_i64(stats.depot_blocks));
+    slab_set_field(result, "reserved_bytes", hml_val_i64(stats.reserved_bytes));
+    return result;
+}
+
+HmlValue hml_builtin_alloc_stats(HmlClosureEnv *env) {
+    (void)env;
+    return hml_alloc_stats();
+}
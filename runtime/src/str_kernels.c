@@ -0,0 +1,967 @@
+/*
+ * Hemlock Runtime Library - String Kernels
+ *
+ * Compiled-program counterpart of the interpreter's string kernels
+ * (src/backends/interpreter/str_kernels.c): substring search, ASCII case
+ * folding, UTF-8 counting and validation, the base64, hex and percent
+ * codecs, and number formatting for string interpolation. Each has a scalar
+ * version and most have SSE2 and/or AVX2 versions on x86-64. The level is
+ * picked once from the CPU features and capped by HEMLOCK_SIMD=off|sse2|avx2.
+ *
+ * Substring search filters candidates with the needle's first and last
+ * bytes a block at a time and verifies them with memcmp, switching to the
+ * two-way algorithm when false candidates pile up.
+ */
+
+#include "builtins_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STR_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+enum { SIMD_SCALAR = 0, SIMD_SSE2 = 1, SIMD_AVX2 = 2 };
+
+static int simd_level_cached = -1;
+
+static int simd_detect(void) {
+    int level = SIMD_SCALAR;
+#ifdef STR_KERNELS_X86
+    level = SIMD_SSE2;  // Part of the x86-64 baseline
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) level = SIMD_AVX2;
+#endif
+    const char *env = getenv("HEMLOCK_SIMD");
+    if (env) {
+        int cap = level;
+        if (strcmp(env, "off") == 0 || strcmp(env, "scalar") == 0) cap = SIMD_SCALAR;
+        else if (strcmp(env, "sse2") == 0) cap = SIMD_SSE2;
+        if (cap < level) level = cap;
+    }
+    return level;
+}
+
+// Detection is idempotent, so racing threads at most repeat it
+static inline int simd_level(void) {
+    int level = __atomic_load_n(&simd_level_cached, __ATOMIC_RELAXED);
+    if (__builtin_expect(level < 0, 0)) {
+        level = simd_detect();
+        __atomic_store_n(&simd_level_cached, level, __ATOMIC_RELAXED);
+    }
+    return level;
+}
+
+// ========== TWO-WAY SEARCH ==========
+
+// Critical factorization of the needle (Crochemore-Perrin). Returns the
+// split position and stores the period of the right half in *period.
+static size_t critical_factorization(const unsigned char *n, size_t m, size_t *period) {
+    size_t max_suffix = SIZE_MAX, j = 0, k = 1, p = 1;
+    while (j + k < m) {
+        unsigned char a = n[j + k];
+        unsigned char b = n[max_suffix + k];
+        if (a < b) {
+            j += k; k = 1; p = j - max_suffix;
+        } else if (a == b) {
+            if (k != p) k++;
+            else { j += p; k = 1; }
+        } else {
+            max_suffix = j++; k = p = 1;
+        }
+    }
+    *period = p;
+
+    size_t max_suffix_rev = SIZE_MAX;
+    j = 0; k = p = 1;
+    while (j + k < m) {
+        unsigned char a = n[j + k];
+        unsigned char b = n[max_suffix_rev + k];
+        if (b < a) {
+            j += k; k = 1; p = j - max_suffix_rev;
+        } else if (a == b) {
+            if (k != p) k++;
+            else { j += p; k = 1; }
+        } else {
+            max_suffix_rev = j++; k = p = 1;
+        }
+    }
+
+    if (max_suffix_rev + 1 < max_suffix + 1) return max_suffix + 1;
+    *period = p;
+    return max_suffix_rev + 1;
+}
+
+// Two-way search of h[0..hl) for n[0..m), m >= 1. Linear time, O(1) space.
+static const unsigned char *two_way_find(const unsigned char *h, size_t hl,
+                                         const unsigned char *n, size_t m) {
+    if (m > hl) return NULL;
+    size_t period;
+    size_t suffix = critical_factorization(n, m, &period);
+    size_t i, j = 0;
+
+    if (memcmp(n, n + period, suffix) == 0) {
+        // Periodic needle: remember how much of the left half is known to match
+        size_t memory = 0;
+        while (j <= hl - m) {
+            i = suffix > memory ? suffix : memory;
+            while (i < m && n[i] == h[i + j]) i++;
+            if (i >= m) {
+                i = suffix - 1;
+                while (memory < i + 1 && n[i] == h[i + j]) i--;
+                if (i + 1 < memory + 1) return h + j;
+                j += period;
+                memory = m - period;
+            } else {
+                j += i - suffix + 1;
+                memory = 0;
+            }
+        }
+    } else {
+        period = (suffix > m - suffix ? suffix : m - suffix) + 1;
+        while (j <= hl - m) {
+            i = suffix;
+            while (i < m && n[i] == h[i + j]) i++;
+            if (i >= m) {
+                i = suffix - 1;
+                while (i != SIZE_MAX && n[i] == h[i + j]) i--;
+                if (i == SIZE_MAX) return h + j;
+                j += period;
+            } else {
+                j += i - suffix + 1;
+            }
+        }
+    }
+    return NULL;
+}
+
+// ========== SUBSTRING SEARCH ==========
+
+// Candidates may cost this many verified bytes (plus a multiple of the
+// distance scanned) before the search falls back to two-way
+#define FIND_VERIFY_SLACK 1024
+
+static int find_scalar(const unsigned char *h, size_t hl, const unsigned char *n, size_t m) {
+    size_t last = hl - m;
+    size_t work = 0;
+    size_t i = 0;
+    while (i <= last) {
+        const unsigned char *p = memchr(h + i, n[0], last - i + 1);
+        if (!p) return -1;
+        i = (size_t)(p - h);
+        if (memcmp(p + 1, n + 1, m - 1) == 0) return (int)i;
+        work += m;
+        if (work > 2 * i + FIND_VERIFY_SLACK) {
+            const unsigned char *r = two_way_find(h + i, hl - i, n, m);
+            return r ? (int)(r - h) : -1;
+        }
+        i++;
+    }
+    return -1;
+}
+
+#ifdef STR_KERNELS_X86
+
+// Finish a block search at position i: two-way when the filter keeps
+// producing false candidates, otherwise a scalar scan of the short tail
+static int find_tail(const unsigned char *h, size_t hl, const unsigned char *n, size_t m,
+                     size_t i, int degenerate) {
+    if (i > hl - m) return -1;
+    if (degenerate) {
+        const unsigned char *r = two_way_find(h + i, hl - i, n, m);
+        return r ? (int)(r - h) : -1;
+    }
+    int r = find_scalar(h + i, hl - i, n, m);
+    return r < 0 ? -1 : (int)i + r;
+}
+
+// Check the candidates in mask (bit k = position i + k) for a full match
+#define FIND_VERIFY(mask)                                                    \
+    while (mask) {                                                           \
+        size_t pos = i + (size_t)__builtin_ctz(mask);                        \
+        if (memcmp(h + pos + 1, n + 1, m - 2) == 0) return (int)pos;         \
+        work += m;                                                           \
+        mask &= mask - 1;                                                    \
+    }
+
+static int find_sse2(const unsigned char *h, size_t hl, const unsigned char *n, size_t m) {
+    const __m128i first = _mm_set1_epi8((char)n[0]);
+    const __m128i last = _mm_set1_epi8((char)n[m - 1]);
+    size_t work = 0;
+    size_t i = 0;
+    // Block at i reads h[i .. i + m - 1 + 16)
+    while (i + m - 1 + 16 <= hl) {
+        __m128i bf = _mm_loadu_si128((const __m128i *)(h + i));
+        __m128i bl = _mm_loadu_si128((const __m128i *)(h + i + m - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last)));
+        FIND_VERIFY(mask);
+        i += 16;
+        if (work > 2 * i + FIND_VERIFY_SLACK) return find_tail(h, hl, n, m, i, 1);
+    }
+    return find_tail(h, hl, n, m, i, 0);
+}
+
+__attribute__((target("avx2")))
+static int find_avx2(const unsigned char *h, size_t hl, const unsigned char *n, size_t m) {
+    const __m256i first = _mm256_set1_epi8((char)n[0]);
+    const __m256i last = _mm256_set1_epi8((char)n[m - 1]);
+    size_t work = 0;
+    size_t i = 0;
+    while (i + m - 1 + 32 <= hl) {
+        __m256i bf = _mm256_loadu_si256((const __m256i *)(h + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i *)(h + i + m - 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last)));
+        FIND_VERIFY(mask);
+        i += 32;
+        if (work > 2 * i + FIND_VERIFY_SLACK) return find_tail(h, hl, n, m, i, 1);
+    }
+    return find_tail(h, hl, n, m, i, 0);
+}
+
+#undef FIND_VERIFY
+#endif
+
+// Byte offset of the first occurrence of needle in hay, or -1. An empty
+// needle matches at 0.
+int hml_str_find(const char *hay, int hay_len, const char *needle, int needle_len) {
+    if (needle_len <= 0) return 0;
+    if (needle_len > hay_len) return -1;
+    const unsigned char *h = (const unsigned char *)hay;
+    const unsigned char *n = (const unsigned char *)needle;
+    size_t hl = (size_t)hay_len, m = (size_t)needle_len;
+
+    if (m == 1) {
+        const unsigned char *p = memchr(h, n[0], hl);
+        return p ? (int)(p - h) : -1;
+    }
+#ifdef STR_KERNELS_X86
+    switch (simd_level()) {
+        case SIMD_AVX2: return find_avx2(h, hl, n, m);
+        case SIMD_SSE2: return find_sse2(h, hl, n, m);
+        default: break;
+    }
+#endif
+    return find_scalar(h, hl, n, m);
+}
+
+// Number of non-overlapping occurrences of needle (needle_len > 0)
+int hml_str_count(const char *hay, int hay_len, const char *needle, int needle_len) {
+    int count = 0;
+    int pos = 0;
+    while (pos <= hay_len - needle_len) {
+        int at = hml_str_find(hay + pos, hay_len - pos, needle, needle_len);
+        if (at < 0) break;
+        count++;
+        pos += at + needle_len;
+    }
+    return count;
+}
+
+// ========== ASCII CASE FOLDING ==========
+
+// Copy len bytes from src to dst, flipping the case of bytes in [lo, lo+25]
+static void case_scalar(char *dst, const char *src, size_t len, unsigned char lo) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)src[i];
+        dst[i] = (char)((unsigned char)(c - lo) < 26 ? c ^ 0x20 : c);
+    }
+}
+
+#ifdef STR_KERNELS_X86
+// Adding (128 - lo) moves [lo, lo+25] to the bottom of the signed range, so
+// one signed compare finds the letters to flip
+static size_t case_sse2(char *dst, const char *src, size_t len, unsigned char lo) {
+    const __m128i shift = _mm_set1_epi8((char)(128 - lo));
+    const __m128i limit = _mm_set1_epi8((char)(-128 + 26));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i is_letter = _mm_cmplt_epi8(_mm_add_epi8(x, shift), limit);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(x, _mm_and_si128(is_letter, flip)));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t case_avx2(char *dst, const char *src, size_t len, unsigned char lo) {
+    const __m256i shift = _mm256_set1_epi8((char)(128 - lo));
+    const __m256i limit = _mm256_set1_epi8((char)(-128 + 26));
+    const __m256i flip = _mm256_set1_epi8(0x20);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i is_letter = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(x, shift));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(x, _mm256_and_si256(is_letter, flip)));
+    }
+    return i;
+}
+#endif
+
+static void case_fold(char *dst, const char *src, int len, unsigned char lo) {
+    size_t done = 0;
+#ifdef STR_KERNELS_X86
+    switch (simd_level()) {
+        case SIMD_AVX2: done = case_avx2(dst, src, (size_t)len, lo); break;
+        case SIMD_SSE2: done = case_sse2(dst, src, (size_t)len, lo); break;
+        default: break;
+    }
+#endif
+    case_scalar(dst + done, src + done, (size_t)len - done, lo);
+}
+
+// dst may equal src
+void hml_str_ascii_upper(char *dst, const char *src, int len) {
+    case_fold(dst, src, len, 'a');
+}
+
+void hml_str_ascii_lower(char *dst, const char *src, int len) {
+    case_fold(dst, src, len, 'A');
+}
+
+// ========== UTF-8 COUNTING AND VALIDATION ==========
+
+// Continuation bytes are 10xxxxxx, i.e. below -64 as signed chars
+static size_t count_continuations_scalar(const char *data, size_t len) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++) {
+        count += (signed char)data[i] < -64;
+    }
+    return count;
+}
+
+#ifdef STR_KERNELS_X86
+static size_t count_continuations_sse2(const char *data, size_t len, size_t *done) {
+    const __m128i bound = _mm_set1_epi8(-64);
+    size_t count = 0, i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(data + i));
+        count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(bound, x)));
+    }
+    *done = i;
+    return count;
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t count_continuations_avx2(const char *data, size_t len, size_t *done) {
+    const __m256i bound = _mm256_set1_epi8(-64);
+    size_t count = 0, i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(data + i));
+        count += (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpgt_epi8(bound, x)));
+    }
+    *done = i;
+    return count;
+}
+
+// Length of the all-ASCII prefix of data[0..len), in whole blocks
+static size_t ascii_prefix_sse2(const char *data, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(data + i)))) break;
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t ascii_prefix_avx2(const char *data, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)(data + i)))) break;
+    }
+    return i;
+}
+#endif
+
+static size_t ascii_prefix(const char *data, size_t len) {
+    size_t i = 0;
+#ifdef STR_KERNELS_X86
+    switch (simd_level()) {
+        case SIMD_AVX2: i = ascii_prefix_avx2(data, len); break;
+        case SIMD_SSE2: i = ascii_prefix_sse2(data, len); break;
+        default: break;
+    }
+#endif
+    while (i < len && (signed char)data[i] >= 0) i++;
+    return i;
+}
+
+// Count codepoints (bytes that are not continuation bytes)
+int hml_utf8_count_codepoints(const char *data, int byte_length) {
+    size_t len = byte_length > 0 ? (size_t)byte_length : 0;
+    size_t done = 0, continuations = 0;
+#ifdef STR_KERNELS_X86
+    switch (simd_level()) {
+        case SIMD_AVX2: continuations = count_continuations_avx2(data, len, &done); break;
+        case SIMD_SSE2: continuations = count_continuations_sse2(data, len, &done); break;
+        default: break;
+    }
+#endif
+    continuations += count_continuations_scalar(data + done, len - done);
+    return (int)(len - continuations);
+}
+
+// Length of the valid multi-byte sequence at s[0..len), or 0. Rejects
+// overlong forms, surrogates and codepoints above U+10FFFF (RFC 3629).
+static int utf8_sequence_length(const unsigned char *s, size_t len) {
+    unsigned char b = s[0];
+    int n;
+    unsigned char lo = 0x80, hi = 0xBF;  // Range of the second byte
+    if (b >= 0xC2 && b <= 0xDF) {
+        n = 2;
+    } else if (b >= 0xE0 && b <= 0xEF) {
+        n = 3;
+        if (b == 0xE0) lo = 0xA0;
+        else if (b == 0xED) hi = 0x9F;
+    } else if (b >= 0xF0 && b <= 0xF4) {
+        n = 4;
+        if (b == 0xF0) lo = 0x90;
+        else if (b == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    if ((size_t)n > len) return 0;
+    if (s[1] < lo || s[1] > hi) return 0;
+    for (int k = 2; k < n; k++) {
+        if ((s[k] & 0xC0) != 0x80) return 0;
+    }
+    return n;
+}
+
+#ifdef STR_KERNELS_X86
+// Lookup-table validation (Keiser & Lemire, "Validating UTF-8 In Less Than
+// One Instruction Per Byte"). Each byte pair is classified by three 16-entry
+// tables indexed by nibbles; a nonzero AND means an error of that kind.
+#define UTF8_TOO_SHORT  (1 << 0)
+#define UTF8_TOO_LONG   (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE  (1 << 3)
+#define UTF8_SURROGATE  (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS  (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define TABLE16(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// The 32 bytes ending n bytes before the start of input
+#define UTF8_PREV(input, prev_input, n) \
+    _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - (n))
+
+__attribute__((target("avx2")))
+static __m256i utf8_block_errors(__m256i input, __m256i prev_input) {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i prev1 = UTF8_PREV(input, prev_input, 1);
+
+    const __m256i byte_1_high_table = TABLE16(
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+    const __m256i byte_1_low_table = TABLE16(
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        UTF8_CARRY,
+        UTF8_CARRY,
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+    const __m256i byte_2_high_table = TABLE16(
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+    __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table,
+        _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+    __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table,
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    // Third and fourth bytes of 3- and 4-byte sequences must be continuations
+    __m256i prev2 = UTF8_PREV(input, prev_input, 2);
+    __m256i prev3 = UTF8_PREV(input, prev_input, 3);
+    __m256i is_third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i is_fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must_continue = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_continue, special);
+}
+
+__attribute__((target("avx2")))
+static int utf8_validate_avx2(const unsigned char *s, size_t len) {
+    // Nonzero where a sequence starting in the last three bytes runs past them
+    const __m256i incomplete_max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+    __m256i error = _mm256_setzero_si256();
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+    for (;;) {
+        __m256i input;
+        int last = i + 32 > len;
+        if (!last) {
+            input = _mm256_loadu_si256((const __m256i *)(s + i));
+        } else {
+            // Zero padding is ASCII, so a sequence cut off at the end fails
+            unsigned char tail[32] = {0};
+            memcpy(tail, s + i, len - i);
+            input = _mm256_loadu_si256((const __m256i *)tail);
+        }
+        if (_mm256_movemask_epi8(input) == 0) {
+            error = _mm256_or_si256(error, prev_incomplete);
+            prev_incomplete = _mm256_setzero_si256();
+        } else {
+            error = _mm256_or_si256(error, utf8_block_errors(input, prev_input));
+            prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+        }
+        prev_input = input;
+        if (last) break;
+        i += 32;
+    }
+    return _mm256_testz_si256(error, error);
+}
+
+#undef UTF8_PREV
+#undef TABLE16
+#endif
+
+// Validate UTF-8: lookup tables on AVX2, otherwise ASCII runs are skipped a
+// block at a time and multi-byte sequences checked one by one
+int hml_utf8_validate(const char *data, int byte_length) {
+    const unsigned char *s = (const unsigned char *)data;
+    size_t len = byte_length > 0 ? (size_t)byte_length : 0;
+#ifdef STR_KERNELS_X86
+    if (simd_level() == SIMD_AVX2) return utf8_validate_avx2(s, len);
+#endif
+    size_t i = 0;
+    while (i < len) {
+        i += ascii_prefix(data + i, len - i);
+        // Multi-byte run, up to the next ASCII byte
+        while (i < len && s[i] >= 0x80) {
+            int n = utf8_sequence_length(s + i, len - i);
+            if (n == 0) return 0;
+            i += (size_t)n;
+        }
+    }
+    return 1;
+}
+
+int hml_utf8_is_ascii(const char *data, int byte_length) {
+    size_t len = byte_length > 0 ? (size_t)byte_length : 0;
+    return ascii_prefix(data, len) == len;
+}
+
+// ========== BASE64, HEX AND PERCENT CODECS ==========
+
+static const char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of each base64 character; 64 marks '=', 0xFF anything else
+static const unsigned char BASE64_VALUES[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 64, 255, 255,
+    255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
+    255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+static const char HEX_LOWER[] = "0123456789abcdef";
+static const char HEX_UPPER[] = "0123456789ABCDEF";
+
+// Value of each hex digit (either case), -1 for anything else
+static const signed char HEX_VALUES[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+#ifdef STR_KERNELS_X86
+// Base64 with AVX2 (Mula and Lemire): each step turns 24 input bytes into 32
+// characters. The bytes are shuffled so every 32-bit lane holds one 3-byte
+// group, the four 6-bit fields are moved into separate bytes with two
+// multiplies, and a 16-entry table maps each field's range to its offset
+// from the ASCII character.
+__attribute__((target("avx2")))
+static size_t base64_encode_avx2(char *dst, const unsigned char *src, size_t len) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        5, 4, 6, 5, 8, 7, 9, 8, 11, 10, 12, 11, 14, 13, 15, 14,
+        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i offsets = _mm256_setr_epi8(
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    size_t i = 0, o = 0;
+    // Every load starts 4 bytes before the group it encodes, so the first
+    // one is rotated into place instead. That first load reads 32 bytes
+    // from src, not 28, so shorter inputs are left to the scalar loop.
+    if (len < 32) return 0;
+    for (; i + 28 <= len; i += 24, o += 32) {
+        __m256i in;
+        if (i == 0) {
+            in = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)src),
+                                             _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+        } else {
+            in = _mm256_loadu_si256((const __m256i *)(src + i - 4));
+        }
+        in = _mm256_shuffle_epi8(in, shuffle);
+        __m256i hi = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                                        _mm256_set1_epi32(0x04000040));
+        __m256i lo = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                                        _mm256_set1_epi32(0x01000010));
+        __m256i fields = _mm256_or_si256(hi, lo);
+        __m256i range = _mm256_subs_epu8(fields, _mm256_set1_epi8(51));
+        range = _mm256_sub_epi8(range, _mm256_cmpgt_epi8(fields, _mm256_set1_epi8(25)));
+        __m256i out = _mm256_add_epi8(fields, _mm256_shuffle_epi8(offsets, range));
+        _mm256_storeu_si256((__m256i *)(dst + o), out);
+    }
+    return i;
+}
+
+// Decodes 32 characters at a time while they are all in the alphabet; the
+// nibble tables flag anything else (padding, whitespace, bad characters),
+// which stops the loop and leaves the rest to the scalar decoder. Stores
+// are 32 bytes wide, so the loop also stops 44 characters from the end.
+__attribute__((target("avx2")))
+static size_t base64_decode_avx2(unsigned char *dst, const char *src, size_t len) {
+    const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0, o = 0;
+    for (; i + 44 <= len; i += 32, o += 24) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_2f);
+        __m256i lo_nibbles = _mm256_and_si256(in, mask_2f);
+        __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        if (!_mm256_testz_si256(lo, hi)) break;
+        __m256i roll = _mm256_shuffle_epi8(lut_roll,
+                                           _mm256_add_epi8(_mm256_cmpeq_epi8(in, mask_2f), hi_nibbles));
+        __m256i values = _mm256_add_epi8(in, roll);
+        // Merge four 6-bit values into 24 bits per lane, then pack the lanes
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        merged = _mm256_shuffle_epi8(merged, pack);
+        merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+        _mm256_storeu_si256((__m256i *)(dst + o), merged);
+    }
+    return i;
+}
+
+// Hex digits for 32 bytes at a time: each nibble indexes the digit table,
+// then the high and low digits are interleaved
+__attribute__((target("avx2")))
+static size_t hex_encode_avx2(char *dst, const unsigned char *src, size_t len) {
+    const __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)HEX_LOWER));
+    const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(in, 4), low_nibble));
+        __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(in, low_nibble));
+        __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+    return i;
+}
+#endif
+
+// Standard base64 with '=' padding into dst, which holds 4 * ceil(len / 3)
+// characters. Returns the number written.
+size_t hml_str_base64_encode(char *dst, const unsigned char *src, size_t len) {
+    size_t i = 0, o = 0;
+#ifdef STR_KERNELS_X86
+    if (simd_level() == SIMD_AVX2) {
+        i = base64_encode_avx2(dst, src, len);
+        o = i / 3 * 4;
+    }
+#endif
+    for (; i + 3 <= len; i += 3, o += 4) {
+        uint32_t group = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) | src[i + 2];
+        dst[o] = BASE64_ALPHABET[group >> 18];
+        dst[o + 1] = BASE64_ALPHABET[(group >> 12) & 63];
+        dst[o + 2] = BASE64_ALPHABET[(group >> 6) & 63];
+        dst[o + 3] = BASE64_ALPHABET[group & 63];
+    }
+    if (i < len) {
+        uint32_t group = (uint32_t)src[i] << 16;
+        if (i + 1 < len) group |= (uint32_t)src[i + 1] << 8;
+        dst[o] = BASE64_ALPHABET[group >> 18];
+        dst[o + 1] = BASE64_ALPHABET[(group >> 12) & 63];
+        dst[o + 2] = i + 1 < len ? BASE64_ALPHABET[(group >> 6) & 63] : '=';
+        dst[o + 3] = '=';
+        o += 4;
+    }
+    return o;
+}
+
+// Decode base64 without whitespace (len a multiple of 4) into dst, which
+// holds len / 4 * 3 bytes. Each group of four may end in "=" or "==".
+// Returns the number of bytes written, HML_CODEC_BAD_PADDING when a group
+// starts with padding, or HML_CODEC_BAD_CHAR.
+long hml_str_base64_decode(unsigned char *dst, const char *src, size_t len) {
+    const unsigned char *s = (const unsigned char *)src;
+    size_t i = 0, o = 0;
+#ifdef STR_KERNELS_X86
+    if (simd_level() == SIMD_AVX2) {
+        i = base64_decode_avx2(dst, src, len);
+        o = i / 4 * 3;
+    }
+#endif
+    for (; i + 4 <= len; i += 4) {
+        int v1 = BASE64_VALUES[s[i]], v2 = BASE64_VALUES[s[i + 1]];
+        int v3 = BASE64_VALUES[s[i + 2]], v4 = BASE64_VALUES[s[i + 3]];
+        if (v1 == 64 || v2 == 64) return HML_CODEC_BAD_PADDING;
+        if (v1 == 0xFF || v2 == 0xFF) return HML_CODEC_BAD_CHAR;
+        dst[o++] = (unsigned char)((v1 << 2) | (v2 >> 4));
+        if (v3 == 64) {
+            // "x=" is not a valid ending
+            if (v4 != 64) return HML_CODEC_BAD_CHAR;
+            continue;
+        }
+        if (v3 == 0xFF) return HML_CODEC_BAD_CHAR;
+        dst[o++] = (unsigned char)((v2 << 4) | (v3 >> 2));
+        if (v4 == 64) continue;
+        if (v4 == 0xFF) return HML_CODEC_BAD_CHAR;
+        dst[o++] = (unsigned char)((v3 << 6) | v4);
+    }
+    return (long)o;
+}
+
+// Two lowercase hex digits per byte into dst, which holds 2 * len characters
+void hml_str_hex_encode(char *dst, const unsigned char *src, size_t len) {
+    size_t i = 0;
+#ifdef STR_KERNELS_X86
+    if (simd_level() == SIMD_AVX2) i = hex_encode_avx2(dst, src, len);
+#endif
+    for (; i < len; i++) {
+        dst[2 * i] = HEX_LOWER[src[i] >> 4];
+        dst[2 * i + 1] = HEX_LOWER[src[i] & 15];
+    }
+}
+
+// Decode an even number of hex digits (either case) into len / 2 bytes.
+// Returns the number written or HML_CODEC_BAD_CHAR.
+long hml_str_hex_decode(unsigned char *dst, const char *src, size_t len) {
+    const unsigned char *s = (const unsigned char *)src;
+    for (size_t i = 0; i + 2 <= len; i += 2) {
+        int hi = HEX_VALUES[s[i]], lo = HEX_VALUES[s[i + 1]];
+        if (hi < 0 || lo < 0) return HML_CODEC_BAD_CHAR;
+        dst[i / 2] = (unsigned char)((hi << 4) | lo);
+    }
+    return (long)(len / 2);
+}
+
+// Percent-encoding is driven by a 256-entry class table: HML_PERCENT_KEEP
+// bytes are copied, HML_PERCENT_ESCAPE bytes become %XX and
+// HML_PERCENT_PLUS bytes (the space, in form encoding) become '+'.
+size_t hml_str_percent_encoded_length(const unsigned char *src, size_t len, const unsigned char *classes) {
+    size_t out = len;
+    for (size_t i = 0; i < len; i++) {
+        out += (size_t)(classes[src[i]] == HML_PERCENT_ESCAPE) * 2;
+    }
+    return out;
+}
+
+// dst holds hml_str_percent_encoded_length() characters
+void hml_str_percent_encode(char *dst, const unsigned char *src, size_t len,
+                            const unsigned char *classes, int upper) {
+    const char *digits = upper ? HEX_UPPER : HEX_LOWER;
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = src[i];
+        switch (classes[c]) {
+            case HML_PERCENT_KEEP:
+                dst[o++] = (char)c;
+                break;
+            case HML_PERCENT_PLUS:
+                dst[o++] = '+';
+                break;
+            default:
+                dst[o] = '%';
+                dst[o + 1] = digits[c >> 4];
+                dst[o + 2] = digits[c & 15];
+                o += 3;
+                break;
+        }
+    }
+}
+
+// Decode %XX escapes (and '+' as a space when plus_space is set) into dst,
+// which holds len bytes. Returns the number written, HML_CODEC_TRUNCATED
+// for a '%' without two characters after it, or HML_CODEC_BAD_CHAR.
+long hml_str_percent_decode(unsigned char *dst, const char *src, size_t len, int plus_space) {
+    const unsigned char *s = (const unsigned char *)src;
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = s[i];
+        if (c == '%') {
+            if (i + 2 >= len) return HML_CODEC_TRUNCATED;
+            int hi = HEX_VALUES[s[i + 1]], lo = HEX_VALUES[s[i + 2]];
+            if (hi < 0 || lo < 0) return HML_CODEC_BAD_CHAR;
+            dst[o++] = (unsigned char)((hi << 4) | lo);
+            i += 2;
+        } else if (c == '+' && plus_space) {
+            dst[o++] = ' ';
+        } else {
+            dst[o++] = c;
+        }
+    }
+    return (long)o;
+}
+
+// ========== NUMBER FORMATTING ==========
+
+// "00" through "99", so the digits come out two per division
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// 1e-4 through 1e9; POW10[4 + e] is 10^e
+static const double POW10[14] = {
+    1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+// Decimal digits of v; returns the number written (at most 20)
+int hml_str_format_u64(char *dst, uint64_t v) {
+    char tmp[20];
+    int pos = 20;
+    while (v >= 100) {
+        unsigned pair = (unsigned)(v % 100);
+        v /= 100;
+        pos -= 2;
+        memcpy(tmp + pos, DIGIT_PAIRS + pair * 2, 2);
+    }
+    if (v >= 10) {
+        pos -= 2;
+        memcpy(tmp + pos, DIGIT_PAIRS + v * 2, 2);
+    } else {
+        tmp[--pos] = (char)('0' + v);
+    }
+    memcpy(dst, tmp + pos, 20 - pos);
+    return 20 - pos;
+}
+
+int hml_str_format_i64(char *dst, int64_t v) {
+    if (v < 0) {
+        dst[0] = '-';
+        return 1 + hml_str_format_u64(dst + 1, 0 - (uint64_t)v);
+    }
+    return hml_str_format_u64(dst, (uint64_t)v);
+}
+
+// v exactly as printf's "%g" writes it, into dst of HML_NUMBER_MAX bytes;
+// returns the length. Values that print without an exponent (1e-4 <= |v| <
+// 1e6) are rounded to six significant digits with one multiply; the rest,
+// and the rare products too close to a rounding tie to call, go to snprintf.
+int hml_str_format_f64(char *dst, double v) {
+    double a = v < 0 ? -v : v;
+    if (a == 0) {
+        if (signbit(v)) {
+            memcpy(dst, "-0", 2);
+            return 2;
+        }
+        dst[0] = '0';
+        return 1;
+    }
+    if (a >= POW10[0] && a < POW10[10]) {
+        int e = 5;
+        while (a < POW10[4 + e]) e--;
+        int prec = 5 - e;
+        double scaled = a * POW10[4 + prec];
+        double whole = floor(scaled);
+        double frac = scaled - whole;
+        // The product is within about 1e-10 of a * 10^prec
+        if (fabs(frac - 0.5) > 1e-6) {
+            uint64_t digits = (uint64_t)whole + (frac > 0.5);
+            if (digits >= 100000 && digits < 1000000) {
+                uint64_t unit = (uint64_t)POW10[4 + prec];
+                int n = 0;
+                if (v < 0) dst[n++] = '-';
+                n += hml_str_format_u64(dst + n, digits / unit);
+                uint64_t rest = digits % unit;
+                if (rest != 0) {
+                    // Fraction digits with the trailing zeros dropped
+                    int len = prec;
+                    while (rest % 10 == 0) {
+                        rest /= 10;
+                        len--;
+                    }
+                    dst[n++] = '.';
+                    for (int i = len - 1; i >= 0; i--) {
+                        dst[n + i] = (char)('0' + rest % 10);
+                        rest /= 10;
+                    }
+                    n += len;
+                }
+                return n;
+            }
+        }
+    }
+    return snprintf(dst, HML_NUMBER_MAX, "%g", v);
+}
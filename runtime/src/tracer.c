@@ -0,0 +1,217 @@
+/*
+ * Hemlock Runtime Library - Concurrency Tracer
+ *
+ * Compiled-program counterpart of `hemlock --trace`, enabled by running the
+ * binary with HEMLOCK_TRACE=FILE. Task and channel operations record spawn,
+ * join, detach, send/recv/close, the time spent blocked inside them (block)
+ * and the moment a blocked thread resumes (wake), select and sleep. At exit
+ * the events are written to FILE in the Chrome trace-event JSON format.
+ *
+ * Each thread appends to its own list of fixed-size chunks, so recording
+ * takes no lock; chunk counts are published with release stores and read
+ * back with acquire loads by the exit-time writer.
+ */
+
+#include "../include/hemlock_runtime.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TRACE_CHUNK_EVENTS 4096
+#define TRACE_MAX_EVENTS_PER_THREAD (1 << 20)
+
+int hml_g_trace_enabled = 0;
+
+typedef struct {
+    const char *cat;        // Static strings only: events outlive the AST
+    const char *name;
+    const char *arg_name;   // NULL = no args
+    int64_t arg;
+    uint64_t ts;            // ns since the trace started
+    uint64_t dur;           // ns, complete events only
+    uint8_t flags;          // HML_TRACE_INSTANT, HML_TRACE_ARG_PTR
+} TraceEvent;
+
+typedef struct TraceChunk {
+    TraceEvent events[TRACE_CHUNK_EVENTS];
+    atomic_int count;
+    _Atomic(struct TraceChunk*) next;
+} TraceChunk;
+
+typedef struct TraceThread {
+    int tid;
+    char name[32];
+    TraceChunk *head;       // Never changes once the thread is registered
+    TraceChunk *tail;       // Owner thread only
+    long total;             // Owner thread only
+    atomic_long dropped;
+    struct TraceThread *next;
+} TraceThread;
+
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceThread *trace_threads = NULL;
+static int trace_next_tid = 1;
+static const char *trace_output_path = NULL;
+static struct timespec trace_epoch;
+
+static __thread TraceThread *trace_self = NULL;
+
+// ========== RECORDING ==========
+
+uint64_t hml_trace_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ns = (int64_t)(now.tv_sec - trace_epoch.tv_sec) * 1000000000LL +
+                 (now.tv_nsec - trace_epoch.tv_nsec);
+    return ns > 0 ? (uint64_t)ns : 1;  // 0 is reserved for "not started"
+}
+
+static TraceThread* trace_register(const char *label, int id) {
+    TraceThread *t = calloc(1, sizeof(TraceThread));
+    TraceChunk *chunk = calloc(1, sizeof(TraceChunk));
+    if (!t || !chunk) {
+        free(t);
+        free(chunk);
+        return NULL;
+    }
+    t->head = chunk;
+    t->tail = chunk;
+
+    pthread_mutex_lock(&trace_lock);
+    t->tid = trace_next_tid++;
+    if (id > 0) {
+        snprintf(t->name, sizeof(t->name), "%s %d", label, id);
+    } else if (label) {
+        snprintf(t->name, sizeof(t->name), "%s", label);
+    } else {
+        snprintf(t->name, sizeof(t->name), "thread %d", t->tid);
+    }
+    t->next = trace_threads;
+    trace_threads = t;
+    pthread_mutex_unlock(&trace_lock);
+
+    trace_self = t;
+    return t;
+}
+
+void hml_trace_thread_start(const char *label, int id) {
+    if (!hml_g_trace_enabled) return;
+    trace_register(label, id);
+}
+
+void hml_trace_record(const char *cat, const char *name, uint64_t start,
+                  const char *arg_name, int64_t arg, int flags) {
+    if (!hml_g_trace_enabled) return;
+    uint64_t now = hml_trace_now();
+
+    TraceThread *t = trace_self ? trace_self : trace_register(NULL, 0);
+    if (!t) return;
+    if (t->total >= TRACE_MAX_EVENTS_PER_THREAD) {
+        atomic_fetch_add_explicit(&t->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    TraceChunk *chunk = t->tail;
+    int index = atomic_load_explicit(&chunk->count, memory_order_relaxed);
+    if (index >= TRACE_CHUNK_EVENTS) {
+        TraceChunk *fresh = calloc(1, sizeof(TraceChunk));
+        if (!fresh) {
+            atomic_fetch_add_explicit(&t->dropped, 1, memory_order_relaxed);
+            return;
+        }
+        atomic_store_explicit(&chunk->next, fresh, memory_order_release);
+        t->tail = chunk = fresh;
+        index = 0;
+    }
+
+    TraceEvent *ev = &chunk->events[index];
+    ev->cat = cat;
+    ev->name = name;
+    ev->arg_name = arg_name;
+    ev->arg = arg;
+    ev->flags = (uint8_t)flags;
+    if (flags & HML_TRACE_INSTANT) {
+        ev->ts = now;
+        ev->dur = 0;
+    } else {
+        ev->ts = start;
+        ev->dur = now > start ? now - start : 0;
+    }
+    atomic_store_explicit(&chunk->count, index + 1, memory_order_release);
+    t->total++;
+}
+
+void hml_trace_blocked(uint64_t blocked_at, void *channel) {
+    hml_trace_record("channel", "block", blocked_at, "channel", (int64_t)(intptr_t)channel, HML_TRACE_ARG_PTR);
+    hml_trace_record("channel", "wake", 0, "channel", (int64_t)(intptr_t)channel, HML_TRACE_INSTANT | HML_TRACE_ARG_PTR);
+}
+
+// ========== OUTPUT ==========
+
+static void trace_write(void) {
+    // Stop recording; threads still running may lose their last events
+    hml_g_trace_enabled = 0;
+
+    FILE *out = fopen(trace_output_path, "w");
+    if (!out) {
+        fprintf(stderr, "Warning: Could not write trace to '%s'\n", trace_output_path);
+        return;
+    }
+
+    pthread_mutex_lock(&trace_lock);
+    long events = 0, dropped = 0;
+    fputs("{\"traceEvents\": [\n", out);
+    fputs("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"hemlock\"}}", out);
+    for (TraceThread *t = trace_threads; t; t = t->next) {
+        fprintf(out, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+                t->tid, t->name);
+        fprintf(out, ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"sort_index\": %d}}",
+                t->tid, t->tid);
+        dropped += atomic_load(&t->dropped);
+
+        for (TraceChunk *c = t->head; c; c = atomic_load_explicit(&c->next, memory_order_acquire)) {
+            int n = atomic_load_explicit(&c->count, memory_order_acquire);
+            for (int i = 0; i < n; i++) {
+                TraceEvent *ev = &c->events[i];
+                fprintf(out, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f",
+                        ev->name, ev->cat, t->tid, ev->ts / 1000.0);
+                if (ev->flags & HML_TRACE_INSTANT) {
+                    fputs(", \"ph\": \"i\", \"s\": \"t\"", out);
+                } else {
+                    fprintf(out, ", \"ph\": \"X\", \"dur\": %.3f", ev->dur / 1000.0);
+                }
+                if (ev->arg_name) {
+                    if (ev->flags & HML_TRACE_ARG_PTR) {
+                        fprintf(out, ", \"args\": {\"%s\": \"0x%llx\"}", ev->arg_name,
+                                (unsigned long long)(uintptr_t)ev->arg);
+                    } else {
+                        fprintf(out, ", \"args\": {\"%s\": %lld}", ev->arg_name, (long long)ev->arg);
+                    }
+                }
+                fputc('}', out);
+                events++;
+            }
+        }
+    }
+    fprintf(out, "\n],\n\"displayTimeUnit\": \"ms\",\n\"otherData\": {\"events\": %ld, \"dropped\": %ld}}\n",
+            events, dropped);
+    pthread_mutex_unlock(&trace_lock);
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Warning: Could not write trace to '%s'\n", trace_output_path);
+    }
+}
+
+void hml_trace_init(void) {
+    const char *path = getenv("HEMLOCK_TRACE");
+    if (!path || !path[0] || hml_g_trace_enabled) return;
+    trace_output_path = path;
+    clock_gettime(CLOCK_MONOTONIC, &trace_epoch);
+    hml_g_trace_enabled = 1;
+    trace_register("main", 0);
+    atexit(trace_write);
+}
@@ -10,6 +10,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdatomic.h>
+#include <limits.h>
+#include <sys/mman.h>
 
 // ========== VALUE CONSTRUCTORS ==========
 
@@ -105,7 +107,7 @@ static void init_ascii_strings(void) {
         ascii_strings[i]->length = 1;
         ascii_strings[i]->char_length = 1;
         ascii_strings[i]->capacity = 2;
-        ascii_strings[i]->ref_count = 1000000;  // Immortal - never freed
+        ascii_strings[i]->ref_count = 1;  // The table's own reference; never freed
     }
     initialized = 1;
 }
@@ -116,40 +118,59 @@ HmlValue hml_val_string(const char *str) {
 
     int len = (str != NULL) ? strlen(str) : 0;
 
-    // Fast path: single ASCII character - return pre-allocated string
+    // Fast path: single ASCII character - return pre-allocated string. Each
+    // caller gets its own reference, so releases can never free the shared one
     if (len == 1 && (unsigned char)str[0] < 128) {
         init_ascii_strings();
         v.as.as_string = ascii_strings[(unsigned char)str[0]];
+        v.as.as_string->ref_count++;
         return v;
     }
 
-    int capacity = len + 1;
-
-    HmlString *s = malloc(sizeof(HmlString));
-    s->data = malloc(capacity);
+    HmlString *s = hml_string_alloc(len);
     if (str != NULL) {
         memcpy(s->data, str, len);
     }
     s->data[len] = '\0';
-    s->length = len;
-    s->char_length = -1;  // Uncalculated
-    s->capacity = capacity;
-    s->ref_count = 1;
 
     v.as.as_string = s;
     return v;
 }
 
+HmlString *hml_string_alloc(int length) {
+    HmlString *s = hml_slab_alloc(HML_STRING_BLOCK_SIZE);
+    if (!s) {
+        hml_runtime_error("Memory allocation failed");
+    }
+    if (length < HML_STRING_INLINE_CAPACITY) {
+        s->data = (char *)(s + 1);
+        s->capacity = HML_STRING_INLINE_CAPACITY;
+        hml_slab_note_inline_string();
+    } else {
+        s->capacity = length + 1;
+        s->data = malloc(s->capacity);
+        if (!s->data) {
+            hml_runtime_error("Memory allocation failed");
+        }
+    }
+    s->length = length;
+    s->char_length = -1;  // Uncalculated
+    s->ref_count = 1;
+    HML_HEAP_TRACK_ALLOC(s, HML_HEAP_KIND_STRING, sizeof(HmlString) + (size_t)s->capacity);
+    return s;
+}
+
 HmlValue hml_val_string_owned(char *str, int length, int capacity) {
     HmlValue v;
     v.type = HML_VAL_STRING;
 
-    HmlString *s = malloc(sizeof(HmlString));
+    HmlString *s = hml_slab_alloc(HML_STRING_BLOCK_SIZE);
     s->data = str;
     s->length = length;
     s->char_length = -1;
     s->capacity = capacity;
     s->ref_count = 1;
+    HML_HEAP_TRACK_ALLOC(s, HML_HEAP_KIND_STRING, sizeof(HmlString) + (size_t)capacity);
 
     v.as.as_string = s;
     return v;
@@ -170,19 +191,21 @@ HmlValue hml_val_ptr(void *ptr) {
 }
 
 HmlValue hml_val_buffer(int size) {
-    HmlBuffer *b = malloc(sizeof(HmlBuffer));
+    HmlBuffer *b = hml_slab_alloc(sizeof(HmlBuffer));
     if (!b) {
         return hml_val_null();
     }
     b->data = calloc(size, 1);  // Zero-initialized
     if (!b->data) {
-        free(b);
+        hml_slab_free(b, sizeof(HmlBuffer));
         return hml_val_null();
     }
     b->length = size;
     b->capacity = size;
     b->ref_count = 1;
     atomic_store(&b->freed, 0);  // Not freed
+    b->mapped = 0;
+    HML_HEAP_TRACK_ALLOC(b, HML_HEAP_KIND_BUFFER, sizeof(HmlBuffer) + (size_t)size);
 
     HmlValue v;
     v.type = HML_VAL_BUFFER;
@@ -194,13 +217,16 @@ HmlValue hml_val_array(void) {
     HmlValue v;
     v.type = HML_VAL_ARRAY;
 
-    HmlArray *a = malloc(sizeof(HmlArray));
+    HmlArray *a = hml_slab_alloc(sizeof(HmlArray));
     a->elements = NULL;
     a->length = 0;
     a->capacity = 0;
     a->ref_count = 1;
     a->element_type = HML_VAL_NULL;  // Untyped
     atomic_store(&a->freed, 0);  // Not freed
+    a->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(a, HML_HEAP_KIND_ARRAY, sizeof(HmlArray));
+    HML_GC_NOTE_ALLOCATION();
 
     v.as.as_array = a;
     return v;
@@ -210,7 +236,7 @@ HmlValue hml_val_object(void) {
     HmlValue v;
     v.type = HML_VAL_OBJECT;
 
-    HmlObject *o = malloc(sizeof(HmlObject));
+    HmlObject *o = hml_slab_alloc(sizeof(HmlObject));
     o->type_name = NULL;
     o->field_names = NULL;
     o->field_values = NULL;
@@ -218,6 +244,9 @@ HmlValue hml_val_object(void) {
     o->capacity = 0;
     o->ref_count = 1;
     atomic_store(&o->freed, 0);  // Not freed
+    o->gc_buffered = 0;
+    HML_HEAP_TRACK_ALLOC(o, HML_HEAP_KIND_OBJECT, sizeof(HmlObject));
+    HML_GC_NOTE_ALLOCATION();
 
     v.as.as_object = o;
     return v;
@@ -341,6 +370,13 @@ HmlValue hml_val_socket(HmlSocket *sock) {
     return v;
 }
 
+HmlValue hml_val_writer(HmlWriter *writer) {
+    HmlValue v;
+    v.type = HML_VAL_WRITER;
+    v.as.as_writer = writer;
+    return v;
+}
+
 // ========== REFERENCE COUNTING ==========
 
 void hml_retain(HmlValue *val) {
@@ -368,6 +404,9 @@ void hml_retain(HmlValue *val) {
         case HML_VAL_TASK:
             if (val->as.as_task) val->as.as_task->ref_count++;
             break;
+        case HML_VAL_WRITER:
+            if (val->as.as_writer) val->as.as_writer->ref_count++;
+            break;
         default:
             break;  // Primitive types don't need reference counting
     }
@@ -375,31 +414,41 @@ void hml_retain(HmlValue *val) {
 
 static void string_free(HmlString *str) {
     if (str) {
-        free(str->data);
-        free(str);
+        HML_HEAP_TRACK_FREE(str);
+        if (!HML_STRING_IS_INLINE(str)) free(str->data);
+        hml_slab_free(str, HML_STRING_BLOCK_SIZE);
     }
 }
 
 static void buffer_free(HmlBuffer *buf) {
     if (buf) {
-        free(buf->data);
-        free(buf);
+        HML_HEAP_TRACK_FREE(buf);
+        if (buf->mapped) {
+            munmap(buf->data, (size_t)buf->capacity);
+        } else {
+            free(buf->data);
+        }
+        hml_slab_free(buf, sizeof(HmlBuffer));
     }
 }
 
 static void array_free(HmlArray *arr) {
     if (arr) {
+        HML_HEAP_TRACK_FREE(arr);
+        HML_GC_FORGET(arr, HML_GC_KIND_ARRAY);
         // Release all elements
         for (int i = 0; i < arr->length; i++) {
             hml_release(&arr->elements[i]);
         }
         free(arr->elements);
-        free(arr);
+        hml_slab_free(arr, sizeof(HmlArray));
     }
 }
 
 static void object_free(HmlObject *obj) {
     if (obj) {
+        HML_HEAP_TRACK_FREE(obj);
+        HML_GC_FORGET(obj, HML_GC_KIND_OBJECT);
         // Free field names and release field values
         for (int i = 0; i < obj->num_fields; i++) {
             free(obj->field_names[i]);
@@ -408,7 +457,15 @@ static void object_free(HmlObject *obj) {
         free(obj->field_names);
         free(obj->field_values);
         free(obj->type_name);
-        free(obj);
+        hml_slab_free(obj, sizeof(HmlObject));
+    }
+}
+
+// Pending output is dropped: only flush() and close() write it out
+static void writer_free(HmlWriter *writer) {
+    if (writer) {
+        free(writer->data);
+        free(writer);
     }
 }
 
@@ -448,6 +505,8 @@ void hml_release(HmlValue *val) {
                 val->as.as_array->ref_count--;
                 if (val->as.as_array->ref_count <= 0) {
                     array_free(val->as.as_array);
+                } else {
+                    HML_GC_POSSIBLE_ROOT(val->as.as_array, HML_GC_KIND_ARRAY);
                 }
                 val->as.as_array = NULL;
             }
@@ -457,6 +516,8 @@ void hml_release(HmlValue *val) {
                 val->as.as_object->ref_count--;
                 if (val->as.as_object->ref_count <= 0) {
                     object_free(val->as.as_object);
+                } else {
+                    HML_GC_POSSIBLE_ROOT(val->as.as_object, HML_GC_KIND_OBJECT);
                 }
                 val->as.as_object = NULL;
             }
@@ -470,6 +531,15 @@ void hml_release(HmlValue *val) {
                 val->as.as_function = NULL;
             }
             break;
+        case HML_VAL_WRITER:
+            if (val->as.as_writer) {
+                val->as.as_writer->ref_count--;
+                if (val->as.as_writer->ref_count <= 0) {
+                    writer_free(val->as.as_writer);
+                }
+                val->as.as_writer = NULL;
+            }
+            break;
         default:
             break;  // Primitive types don't need reference counting
     }
@@ -711,6 +781,7 @@ const char* hml_type_name(HmlValueType type) {
         case HML_VAL_TASK:    return "task";
         case HML_VAL_CHANNEL: return "channel";
         case HML_VAL_SOCKET:  return "socket";
+        case HML_VAL_WRITER:  return "writer";
         case HML_VAL_NULL:    return "null";
         default:              return "unknown";
     }
@@ -782,3 +853,90 @@ void hml_closure_env_set(HmlClosureEnv *env, int index, HmlValue val) {
         hml_retain(&env->captured[index]);
     }
 }
+
+// ========== VISITED SET ==========
+
+// Linear probing over a power-of-two table. Keys are never NULL, so NULL
+// marks an empty slot and removal shifts the rest of the probe run back
+// instead of leaving tombstones.
+
+static inline int visited_home(const HmlVisitedSet *set, void *ptr) {
+    uint64_t h = (uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ULL;
+    return (int)(h >> 32) & (set->capacity - 1);
+}
+
+// Slot holding ptr, or the empty slot where it would go
+static inline int visited_find(const HmlVisitedSet *set, void *ptr) {
+    int mask = set->capacity - 1;
+    int slot = visited_home(set, ptr);
+    while (set->keys[slot] && set->keys[slot] != ptr) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void hml_visited_init(HmlVisitedSet *set) {
+    set->keys = set->inline_keys;
+    set->count = 0;
+    set->capacity = HML_VISITED_INLINE_CAPACITY;
+    memset(set->inline_keys, 0, sizeof(set->inline_keys));
+}
+
+void hml_visited_destroy(HmlVisitedSet *set) {
+    if (set->keys != set->inline_keys) free(set->keys);
+    set->keys = set->inline_keys;
+    set->count = 0;
+}
+
+static void visited_grow(HmlVisitedSet *set) {
+    if (set->capacity > INT_MAX / 2) {
+        hml_runtime_error("Visited set capacity overflow");
+    }
+    int old_capacity = set->capacity;
+    void **old_keys = set->keys;
+
+    set->capacity = old_capacity * 2;
+    set->keys = calloc((size_t)set->capacity, sizeof(void*));
+    if (!set->keys) {
+        hml_runtime_error("Memory allocation failed during visited set growth");
+    }
+    for (int i = 0; i < old_capacity; i++) {
+        if (old_keys[i]) {
+            set->keys[visited_find(set, old_keys[i])] = old_keys[i];
+        }
+    }
+    if (old_keys != set->inline_keys) free(old_keys);
+}
+
+int hml_visited_contains(HmlVisitedSet *set, void *ptr) {
+    return set->keys[visited_find(set, ptr)] != NULL;
+}
+
+int hml_visited_add(HmlVisitedSet *set, void *ptr) {
+    int slot = visited_find(set, ptr);
+    if (set->keys[slot]) return 0;
+    if ((set->count + 1) * 2 > set->capacity) {
+        visited_grow(set);
+        slot = visited_find(set, ptr);
+    }
+    set->keys[slot] = ptr;
+    set->count++;
+    return 1;
+}
+
+void hml_visited_remove(HmlVisitedSet *set, void *ptr) {
+    int mask = set->capacity - 1;
+    int hole = visited_find(set, ptr);
+    if (!set->keys[hole]) return;
+
+    // Move each later entry of the run whose home is at or before the hole
+    for (int next = (hole + 1) & mask; set->keys[next]; next = (next + 1) & mask) {
+        int home = visited_home(set, set->keys[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            set->keys[hole] = set->keys[next];
+            hole = next;
+        }
+    }
+    set->keys[hole] = NULL;
+    set->count--;
+}
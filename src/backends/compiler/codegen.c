@@ -41,8 +41,7 @@ CodegenContext* codegen_new(FILE *output) {
     ctx->func_params = NULL;
     ctx->num_func_params = 0;
     ctx->func_param_is_ref = NULL;
-    ctx->defer_stack = NULL;
-    ctx->defer_scope_depth = 0;
+    ctx->defer_frame = NULL;
     ctx->current_closure = NULL;
     ctx->shared_env_name = NULL;
     ctx->shared_env_vars = NULL;
@@ -88,7 +87,9 @@ CodegenContext* codegen_new(FILE *output) {
     ctx->type_ctx = NULL;  // Set by caller (main.c) if type checking enabled
     ctx->optimize = 1;  // Enable optimization by default
     ctx->stack_check = 1;  // Enable stack checking by default (can be overridden by caller)
-    ctx->has_defers = 0;  // Track if any defers exist in current function
+    ctx->profile = 0;
+    ctx->profile_output = NULL;
+    ctx->stdout_buffer = 0;
     ctx->tail_call_func_name = NULL;  // Tail call optimization tracking
     ctx->tail_call_label = NULL;
     ctx->tail_call_func_expr = NULL;
@@ -125,7 +126,7 @@ void codegen_free(CodegenContext *ctx) {
         }
 
         // Free defers
-        codegen_defer_clear(ctx);
+        codegen_defer_frame_free(ctx->defer_frame);
 
         // Free last closure tracking
         if (ctx->last_closure_captured) {
@@ -949,44 +950,261 @@ void codegen_pop_scope(CodegenContext *ctx) {
 
 // ========== DEFER SUPPORT ==========
 
-void codegen_defer_push(CodegenContext *ctx, Expr *expr) {
-    DeferEntry *entry = malloc(sizeof(DeferEntry));
-    entry->expr = expr;
-    entry->next = ctx->defer_stack;
-    entry->scope_depth = 0;  // Not currently used
-    ctx->defer_stack = entry;
+// Slot frames track which defers ran in a 32-bit mask
+#define DEFER_MAX_SLOT_DEFERS 32
+
+typedef struct {
+    Stmt **defers;
+    int count;
+    int capacity;
+    int in_loop;      // Some defer is inside a loop
+} DeferScan;
+
+// Collect the defer statements of a function body. Nested functions are
+// expressions, so their defers are never reached.
+static void defer_scan_stmt(DeferScan *scan, Stmt *stmt, int loop_depth) {
+    if (!stmt) return;
+    switch (stmt->type) {
+        case STMT_DEFER:
+            if (scan->count >= scan->capacity) {
+                scan->capacity = scan->capacity ? scan->capacity * 2 : 4;
+                scan->defers = realloc(scan->defers, sizeof(Stmt*) * scan->capacity);
+            }
+            scan->defers[scan->count++] = stmt;
+            if (loop_depth > 0) scan->in_loop = 1;
+            break;
+        case STMT_BLOCK:
+            for (int i = 0; i < stmt->as.block.count; i++) {
+                defer_scan_stmt(scan, stmt->as.block.statements[i], loop_depth);
+            }
+            break;
+        case STMT_IF:
+            defer_scan_stmt(scan, stmt->as.if_stmt.then_branch, loop_depth);
+            defer_scan_stmt(scan, stmt->as.if_stmt.else_branch, loop_depth);
+            break;
+        case STMT_WHILE:
+            defer_scan_stmt(scan, stmt->as.while_stmt.body, loop_depth + 1);
+            break;
+        case STMT_FOR:
+            defer_scan_stmt(scan, stmt->as.for_loop.body, loop_depth + 1);
+            break;
+        case STMT_FOR_IN:
+            defer_scan_stmt(scan, stmt->as.for_in.body, loop_depth + 1);
+            break;
+        case STMT_TRY:
+            defer_scan_stmt(scan, stmt->as.try_stmt.try_block, loop_depth);
+            defer_scan_stmt(scan, stmt->as.try_stmt.catch_block, loop_depth);
+            defer_scan_stmt(scan, stmt->as.try_stmt.finally_block, loop_depth);
+            break;
+        case STMT_SWITCH:
+            for (int i = 0; i < stmt->as.switch_stmt.num_cases; i++) {
+                defer_scan_stmt(scan, stmt->as.switch_stmt.case_bodies[i], loop_depth);
+            }
+            break;
+        default:
+            break;
+    }
 }
 
-void codegen_defer_execute_all(CodegenContext *ctx) {
-    // Generate code for all current defers in LIFO order
-    // Note: We iterate without consuming so multiple returns can use the same defers
-    DeferEntry *entry = ctx->defer_stack;
-    while (entry) {
-        // Generate code to execute the deferred expression
-        codegen_writeln(ctx, "// Deferred call");
-        char *value = codegen_expr(ctx, entry->expr);
-        codegen_writeln(ctx, "hml_release(&%s);", value);
-        free(value);
+// The callee of a deferred call, or its receiver for a method call
+static Expr *defer_target(Expr *call, const char **method) {
+    *method = NULL;
+    if (call->type != EXPR_CALL) return call;
+    Expr *func = call->as.call.func;
+    if (func->type == EXPR_GET_PROPERTY) {
+        *method = func->as.get_property.property;
+        return func->as.get_property.object;
+    }
+    return func;
+}
+
+static int defer_num_args(Stmt *stmt) {
+    Expr *call = stmt->as.defer_stmt.call;
+    return call->type == EXPR_CALL ? call->as.call.num_args : 0;
+}
 
-        entry = entry->next;
+void codegen_defer_frame_free(DeferFrame *frame) {
+    if (!frame) return;
+    free(frame->defers);
+    free(frame->exit_label);
+    free(frame->return_var);
+    free(frame->has_return_var);
+    free(frame);
+}
+
+int codegen_is_defer_exit(CodegenContext *ctx, const char *label) {
+    return ctx->defer_frame && strcmp(label, ctx->defer_frame->exit_label) == 0;
+}
+
+void codegen_defer_frame_begin(CodegenContext *ctx, Expr *func) {
+    DeferScan scan = {0};
+    defer_scan_stmt(&scan, func->as.function.body, 0);
+    if (scan.count == 0) {
+        ctx->defer_frame = NULL;
+        return;
+    }
+
+    DeferFrame *frame = calloc(1, sizeof(DeferFrame));
+    frame->defers = scan.defers;
+    frame->num_defers = scan.count;
+    frame->use_list = scan.in_loop || scan.count > DEFER_MAX_SLOT_DEFERS;
+    for (int i = 0; i < scan.count; i++) {
+        frame->num_slots += 1 + defer_num_args(scan.defers[i]);
+    }
+    frame->exit_label = codegen_label(ctx);
+    frame->return_var = codegen_temp(ctx);
+    frame->has_return_var = codegen_temp(ctx);
+    ctx->defer_frame = frame;
+
+    if (frame->use_list) {
+        codegen_writeln(ctx, "HmlDeferList _defer_list = {0};");
+    } else {
+        // Written inside the setjmp region and read after a longjmp
+        codegen_writeln(ctx, "HmlValue _defer_slots[%d];", frame->num_slots);
+        codegen_writeln(ctx, "volatile uint32_t _defer_ran = 0;");
+    }
+    codegen_writeln(ctx, "HmlValue %s = hml_val_null();", frame->return_var);
+    codegen_writeln(ctx, "int %s = 0;", frame->has_return_var);
+    codegen_writeln(ctx, "int _defer_threw = 0;");
+    codegen_writeln(ctx, "HmlExceptionContext _defer_ex;");
+    codegen_writeln(ctx, "hml_exception_enter(&_defer_ex);");
+    codegen_writeln(ctx, "if (setjmp(_defer_ex.exception_buf) == 0) {");
+    codegen_indent_inc(ctx);
+
+    // Returns in the body store their value and jump to the exit label
+    codegen_push_try_finally(ctx, frame->exit_label, frame->return_var, frame->has_return_var);
+}
+
+void codegen_defer_stmt(CodegenContext *ctx, Stmt *stmt) {
+    DeferFrame *frame = ctx->defer_frame;
+    int index = 0;
+    int slot = 0;
+    while (frame->defers[index] != stmt) {
+        slot += 1 + defer_num_args(frame->defers[index]);
+        index++;
+    }
+
+    // The callee (or receiver) and arguments are evaluated now; the frame
+    // takes over the references
+    Expr *call = stmt->as.defer_stmt.call;
+    const char *method;
+    Expr *target = defer_target(call, &method);
+    int num_args = defer_num_args(stmt);
+
+    // Deferred calls go through hml_call_function, which passes values
+    if (!method && target->type == EXPR_IDENT && codegen_is_main_func(ctx, target->as.ident.name)) {
+        int *param_is_ref = codegen_get_main_func_param_is_ref(ctx, target->as.ident.name);
+        int num_params = codegen_get_main_func_params(ctx, target->as.ident.name);
+        for (int i = 0; param_is_ref && i < num_params && i < num_args; i++) {
+            if (param_is_ref[i]) {
+                codegen_error(ctx, call->line, "cannot defer a call to '%s', which takes ref parameters",
+                              target->as.ident.name);
+                return;
+            }
+        }
+    }
+    char *target_val = codegen_expr(ctx, target);
+    char **arg_vals = num_args > 0 ? malloc(sizeof(char*) * num_args) : NULL;
+    for (int i = 0; i < num_args; i++) {
+        arg_vals[i] = codegen_expr(ctx, call->as.call.args[i]);
+    }
+
+    if (frame->use_list) {
+        codegen_writeln(ctx, "{");
+        codegen_indent_inc(ctx);
+        if (num_args > 0) {
+            codegen_writeln(ctx, "HmlValue _defer_args[%d];", num_args);
+            for (int i = 0; i < num_args; i++) {
+                codegen_writeln(ctx, "_defer_args[%d] = %s;", i, arg_vals[i]);
+            }
+        }
+        if (method) {
+            codegen_writeln(ctx, "hml_defer_list_push(&_defer_list, %s, \"%s\", %s, %d);",
+                          target_val, method, num_args > 0 ? "_defer_args" : "NULL", num_args);
+        } else {
+            codegen_writeln(ctx, "hml_defer_list_push(&_defer_list, %s, NULL, %s, %d);",
+                          target_val, num_args > 0 ? "_defer_args" : "NULL", num_args);
+        }
+        codegen_indent_dec(ctx);
+        codegen_writeln(ctx, "}");
+    } else {
+        codegen_writeln(ctx, "_defer_slots[%d] = %s;", slot, target_val);
+        for (int i = 0; i < num_args; i++) {
+            codegen_writeln(ctx, "_defer_slots[%d] = %s;", slot + 1 + i, arg_vals[i]);
+        }
+        codegen_writeln(ctx, "_defer_ran |= 1u << %d;", index);
+    }
+
+    for (int i = 0; i < num_args; i++) {
+        free(arg_vals[i]);
     }
+    free(arg_vals);
+    free(target_val);
 }
 
-void codegen_defer_clear(CodegenContext *ctx) {
-    while (ctx->defer_stack) {
-        DeferEntry *entry = ctx->defer_stack;
-        ctx->defer_stack = entry->next;
-        free(entry);
+void codegen_defer_frame_end(CodegenContext *ctx) {
+    DeferFrame *frame = ctx->defer_frame;
+    if (!frame) return;
+    codegen_pop_try_finally(ctx);
+
+    codegen_indent_dec(ctx);
+    codegen_writeln(ctx, "} else {");
+    codegen_writeln(ctx, "    _defer_threw = 1;");
+    codegen_writeln(ctx, "}");
+    codegen_writeln(ctx, "%s:;", frame->exit_label);
+    codegen_writeln(ctx, "HmlValue _defer_exception = hml_exception_leave(&_defer_ex);");
+
+    // Run the defers inline, last first
+    if (frame->use_list) {
+        codegen_writeln(ctx, "hml_defer_list_run(&_defer_list);");
+    } else {
+        int slot = frame->num_slots;
+        for (int i = frame->num_defers - 1; i >= 0; i--) {
+            const char *method;
+            int num_args = defer_num_args(frame->defers[i]);
+            defer_target(frame->defers[i]->as.defer_stmt.call, &method);
+            slot -= 1 + num_args;
+            char args[32];
+            if (num_args > 0) {
+                snprintf(args, sizeof(args), "&_defer_slots[%d]", slot + 1);
+            } else {
+                snprintf(args, sizeof(args), "NULL");
+            }
+            if (method) {
+                codegen_writeln(ctx, "if (_defer_ran & (1u << %d)) hml_defer_run(_defer_slots[%d], \"%s\", %s, %d);",
+                              i, slot, method, args, num_args);
+            } else {
+                codegen_writeln(ctx, "if (_defer_ran & (1u << %d)) hml_defer_run(_defer_slots[%d], NULL, %s, %d);",
+                              i, slot, args, num_args);
+            }
+        }
+    }
+
+    codegen_writeln(ctx, "if (_defer_threw) {");
+    codegen_writeln(ctx, "    hml_throw(_defer_exception);");
+    codegen_writeln(ctx, "}");
+    codegen_writeln(ctx, "if (%s) {", frame->has_return_var);
+    codegen_indent_inc(ctx);
+    if (ctx->stack_check) {
+        codegen_writeln(ctx, "HML_CALL_EXIT();");
+    }
+    if (ctx->profile) {
+        codegen_writeln(ctx, "HML_PROFILE_EXIT();");
     }
+    codegen_writeln(ctx, "return %s;", frame->return_var);
+    codegen_indent_dec(ctx);
+    codegen_writeln(ctx, "}");
+
+    codegen_defer_frame_free(frame);
+    ctx->defer_frame = NULL;
 }
 
 // ========== FUNCTION GENERATION STATE ==========
 
 void funcgen_save_state(CodegenContext *ctx, FuncGenState *state) {
     state->num_locals = ctx->num_locals;
-    state->defer_stack = ctx->defer_stack;
+    state->defer_frame = ctx->defer_frame;
     state->in_function = ctx->in_function;
-    state->has_defers = ctx->has_defers;
     state->module = ctx->current_module;
     state->closure = ctx->current_closure;
     state->tail_call_func_name = ctx->tail_call_func_name;
@@ -994,9 +1212,8 @@ void funcgen_save_state(CodegenContext *ctx, FuncGenState *state) {
     state->tail_call_func_expr = ctx->tail_call_func_expr;
 
     // Initialize for new function
-    ctx->defer_stack = NULL;
+    ctx->defer_frame = NULL;
     ctx->in_function = 1;
-    ctx->has_defers = 0;
     ctx->last_closure_env_id = -1;
     ctx->tail_call_func_name = NULL;
     ctx->tail_call_label = NULL;
@@ -1004,11 +1221,10 @@ void funcgen_save_state(CodegenContext *ctx, FuncGenState *state) {
 }
 
 void funcgen_restore_state(CodegenContext *ctx, FuncGenState *state) {
-    codegen_defer_clear(ctx);
-    ctx->defer_stack = state->defer_stack;
+    codegen_defer_frame_free(ctx->defer_frame);
+    ctx->defer_frame = state->defer_frame;
     ctx->num_locals = state->num_locals;
     ctx->in_function = state->in_function;
-    ctx->has_defers = state->has_defers;
     ctx->current_module = state->module;
     ctx->current_closure = state->closure;
     // Free any allocated tail call labels
@@ -1114,6 +1330,7 @@ void funcgen_generate_body(CodegenContext *ctx, Expr *func) {
         type_check_analyze_block_for_unboxing(ctx->type_ctx, func->as.function.body);
     }
 
+    codegen_defer_frame_begin(ctx, func);
     if (func->as.function.body->type == STMT_BLOCK) {
         for (int i = 0; i < func->as.function.body->as.block.count; i++) {
             codegen_stmt(ctx, func->as.function.body->as.block.statements[i]);
@@ -1121,6 +1338,7 @@ void funcgen_generate_body(CodegenContext *ctx, Expr *func) {
     } else {
         codegen_stmt(ctx, func->as.function.body);
     }
+    codegen_defer_frame_end(ctx);
 }
 
 // ========== TYPE MAPPING HELPERS ==========
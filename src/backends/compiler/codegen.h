@@ -13,15 +13,23 @@
 
 // Forward declaration for closure info
 typedef struct ClosureInfo ClosureInfo;
-typedef struct DeferEntry DeferEntry;
+typedef struct DeferFrame DeferFrame;
 typedef struct CompiledModule CompiledModule;
 typedef struct ModuleCache ModuleCache;
 
-// Deferred expression entry for LIFO execution
-struct DeferEntry {
-    Expr *expr;           // The expression to defer
-    DeferEntry *next;     // Next entry (forms a stack)
-    int scope_depth;      // Scope depth when this defer was added
+// The defers of the function being generated. A defer outside any loop runs
+// at most once per call, so it gets fixed slots in the frame for its callee
+// (or method receiver) and arguments; a function with a defer inside a loop
+// keeps all of its defers in a runtime list instead. Either way they run at
+// the function's single exit label.
+struct DeferFrame {
+    Stmt **defers;        // Defer statements of the body, in source order
+    int num_defers;
+    int num_slots;        // Slot values across all defers (slot frames)
+    int use_list;         // 1 if the defers go in a runtime list
+    char *exit_label;     // Where returns go to run the defers
+    char *return_var;     // Value being returned
+    char *has_return_var; // Set when a return (rather than the end) got there
 };
 
 // Closure information for anonymous functions
@@ -116,8 +124,7 @@ typedef struct {
     int *func_param_is_ref; // Which params are ref (pass-by-reference)
 
     // Defer support
-    DeferEntry *defer_stack;  // Stack of deferred expressions (LIFO)
-    int defer_scope_depth;    // Current scope depth for defer tracking
+    DeferFrame *defer_frame;  // Defers of the current function, NULL if none
 
     // Current closure being generated (for mutable captured variable support)
     ClosureInfo *current_closure;  // NULL if not in a closure body
@@ -191,9 +198,9 @@ typedef struct {
     TypeCheckContext *type_ctx;   // Type check context (NULL if --no-type-check)
     int optimize;                 // Optimization level (0 = none, 1+ = optimize)
     int stack_check;              // Enable stack overflow checking (1 = on, 0 = off)
-
-    // Defer optimization tracking
-    int has_defers;               // Whether any defer statements exist in current function
+    int profile;                  // Emit profiler shadow stack (hemlockc --profile)
+    const char *profile_output;   // Folded stack file written by the profiled binary
+    long long stdout_buffer;      // stdout buffer size (hemlockc --stdout-buffer, 0 = off)
 
     // Tail call optimization tracking
     char *tail_call_func_name;    // Current function name if tail-recursive, NULL otherwise
@@ -301,14 +308,22 @@ void codegen_pop_scope(CodegenContext *ctx);
 
 // ========== DEFER SUPPORT ==========
 
-// Push a deferred expression onto the defer stack
-void codegen_defer_push(CodegenContext *ctx, Expr *expr);
+// Open the defer frame of a function body that has defers: slot or list
+// storage, and an exception context so the defers also run on a throw
+void codegen_defer_frame_begin(CodegenContext *ctx, Expr *func);
+
+// Close the frame: the exit label, the defers in LIFO order, then a rethrow
+// or the pending return
+void codegen_defer_frame_end(CodegenContext *ctx);
+
+// Generate a defer statement inside a function's defer frame
+void codegen_defer_stmt(CodegenContext *ctx, Stmt *stmt);
 
-// Generate code to execute all defers in LIFO order (and clear the stack)
-void codegen_defer_execute_all(CodegenContext *ctx);
+// Free a defer frame without generating code (for cleanup)
+void codegen_defer_frame_free(DeferFrame *frame);
 
-// Clear the defer stack without generating code (for cleanup)
-void codegen_defer_clear(CodegenContext *ctx);
+// Whether label is the current function's defer exit
+int codegen_is_defer_exit(CodegenContext *ctx, const char *label);
 
 // ========== CLOSURE ANALYSIS ==========
 
@@ -164,6 +164,39 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
             return result;
         }
 
+        // Handle heap_stats builtin
+        if (strcmp(fn_name, "heap_stats") == 0 && expr->as.call.num_args == 0) {
+            codegen_writeln(ctx, "HmlValue %s = hml_heap_stats();", result);
+            return result;
+        }
+
+        // Handle heap_snapshot builtin
+        if (strcmp(fn_name, "heap_snapshot") == 0 && expr->as.call.num_args == 1) {
+            char *path = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_heap_snapshot(%s);", result, path);
+            codegen_writeln(ctx, "hml_release(&%s);", path);
+            free(path);
+            return result;
+        }
+
+        // Handle gc_collect builtin
+        if (strcmp(fn_name, "gc_collect") == 0 && expr->as.call.num_args == 0) {
+            codegen_writeln(ctx, "HmlValue %s = hml_gc_collect();", result);
+            return result;
+        }
+
+        // Handle gc_stats builtin
+        if (strcmp(fn_name, "gc_stats") == 0 && expr->as.call.num_args == 0) {
+            codegen_writeln(ctx, "HmlValue %s = hml_gc_stats();", result);
+            return result;
+        }
+
+        // Handle alloc_stats builtin
+        if (strcmp(fn_name, "alloc_stats") == 0 && expr->as.call.num_args == 0) {
+            codegen_writeln(ctx, "HmlValue %s = hml_alloc_stats();", result);
+            return result;
+        }
+
         // Handle exec builtin for command execution (1 arg: shell mode, 2 args: safe mode)
         if ((strcmp(fn_name, "exec") == 0 || strcmp(fn_name, "__exec") == 0) && expr->as.call.num_args == 1) {
             char *cmd = codegen_expr(ctx, expr->as.call.args[0]);
@@ -210,6 +243,15 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
             return result;
         }
 
+        // Handle mmap_file builtin
+        if (strcmp(fn_name, "mmap_file") == 0 && expr->as.call.num_args == 1) {
+            char *path = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_mmap_file(%s);", result, path);
+            codegen_writeln(ctx, "hml_release(&%s);", path);
+            free(path);
+            return result;
+        }
+
         // Handle spawn builtin for async
         if (strcmp(fn_name, "spawn") == 0 && expr->as.call.num_args >= 1) {
             char *fn_val = codegen_expr(ctx, expr->as.call.args[0]);
@@ -1752,6 +1794,41 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
             return result;
         }
 
+        // __tar_writer_* / __tar_reader_* - tar archive handles (stdlib/compression.hml)
+        if (strncmp(fn_name, "__tar_", 6) == 0) {
+            static const struct { const char *name; const char *fn; int num_args; } tar_builtins[] = {
+                { "__tar_writer_open", "hml_tar_writer_open", 2 },
+                { "__tar_writer_add", "hml_tar_writer_add", 6 },
+                { "__tar_writer_add_path", "hml_tar_writer_add_path", 3 },
+                { "__tar_writer_close", "hml_tar_writer_close", 1 },
+                { "__tar_reader_open", "hml_tar_reader_open", 1 },
+                { "__tar_reader_next", "hml_tar_reader_next", 1 },
+                { "__tar_reader_read", "hml_tar_reader_read", 2 },
+                { "__tar_reader_extract", "hml_tar_reader_extract", 2 },
+                { "__tar_reader_extract_into", "hml_tar_reader_extract_into", 2 },
+                { "__tar_reader_close", "hml_tar_reader_close", 1 },
+            };
+            for (size_t t = 0; t < sizeof(tar_builtins) / sizeof(tar_builtins[0]); t++) {
+                if (strcmp(fn_name, tar_builtins[t].name) != 0 ||
+                    expr->as.call.num_args != tar_builtins[t].num_args) {
+                    continue;
+                }
+                char *args[6];
+                char arg_list[256] = "";
+                for (int a = 0; a < tar_builtins[t].num_args; a++) {
+                    args[a] = codegen_expr(ctx, expr->as.call.args[a]);
+                    if (a > 0) strcat(arg_list, ", ");
+                    strncat(arg_list, args[a], sizeof(arg_list) - strlen(arg_list) - 3);
+                }
+                codegen_writeln(ctx, "HmlValue %s = %s(%s);", result, tar_builtins[t].fn, arg_list);
+                for (int a = 0; a < tar_builtins[t].num_args; a++) {
+                    codegen_writeln(ctx, "hml_release(&%s);", args[a]);
+                    free(args[a]);
+                }
+                return result;
+            }
+        }
+
         // ========== STRING UTILITY BUILTINS ==========
 
         // to_string(value)
@@ -1806,6 +1883,148 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
             return result;
         }
 
+        // __utf8_valid(value) - check a string's or buffer's bytes are valid UTF-8
+        if (strcmp(fn_name, "__utf8_valid") == 0 && expr->as.call.num_args == 1) {
+            char *arg = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_utf8_valid(%s);", result, arg);
+            codegen_writeln(ctx, "hml_release(&%s);", arg);
+            free(arg);
+            return result;
+        }
+
+        // __base64_* / __hex_* / __percent_* - encoding kernels (stdlib/encoding.hml)
+        if (strncmp(fn_name, "__base64_", 9) == 0 || strncmp(fn_name, "__hex_", 6) == 0 ||
+            strncmp(fn_name, "__percent_", 10) == 0) {
+            static const struct { const char *name; const char *fn; int num_args; } codec_builtins[] = {
+                { "__base64_encode", "hml_base64_encode", 1 },
+                { "__base64_decode", "hml_base64_decode", 1 },
+                { "__hex_encode", "hml_hex_encode", 1 },
+                { "__hex_decode", "hml_hex_decode", 1 },
+                { "__percent_encode", "hml_percent_encode", 4 },
+                { "__percent_decode", "hml_percent_decode", 2 },
+            };
+            for (size_t c = 0; c < sizeof(codec_builtins) / sizeof(codec_builtins[0]); c++) {
+                if (strcmp(fn_name, codec_builtins[c].name) != 0 ||
+                    expr->as.call.num_args != codec_builtins[c].num_args) {
+                    continue;
+                }
+                char *args[4];
+                char arg_list[256] = "";
+                for (int a = 0; a < codec_builtins[c].num_args; a++) {
+                    args[a] = codegen_expr(ctx, expr->as.call.args[a]);
+                    if (a > 0) strcat(arg_list, ", ");
+                    strncat(arg_list, args[a], sizeof(arg_list) - strlen(arg_list) - 3);
+                }
+                codegen_writeln(ctx, "HmlValue %s = %s(%s);", result, codec_builtins[c].fn, arg_list);
+                for (int a = 0; a < codec_builtins[c].num_args; a++) {
+                    codegen_writeln(ctx, "hml_release(&%s);", args[a]);
+                    free(args[a]);
+                }
+                return result;
+            }
+        }
+
+        // __sb_new(capacity) / __sb_to_string(sb) - string builder (stdlib/fmt.hml)
+        if (strcmp(fn_name, "__sb_new") == 0 && expr->as.call.num_args == 1) {
+            char *cap = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_sb_new(%s);", result, cap);
+            codegen_writeln(ctx, "hml_release(&%s);", cap);
+            free(cap);
+            return result;
+        }
+        if (strcmp(fn_name, "__sb_to_string") == 0 && expr->as.call.num_args == 1) {
+            char *sb = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_sb_to_string(%s);", result, sb);
+            codegen_writeln(ctx, "hml_release(&%s);", sb);
+            free(sb);
+            return result;
+        }
+
+        // __sb_append(sb, value) / __sb_append_byte(sb, byte)
+        if ((strcmp(fn_name, "__sb_append") == 0 || strcmp(fn_name, "__sb_append_byte") == 0) &&
+            expr->as.call.num_args == 2) {
+            char *sb = codegen_expr(ctx, expr->as.call.args[0]);
+            char *val = codegen_expr(ctx, expr->as.call.args[1]);
+            codegen_writeln(ctx, "HmlValue %s = %s(%s, %s);", result,
+                            strcmp(fn_name, "__sb_append") == 0 ? "hml_sb_append" : "hml_sb_append_byte",
+                            sb, val);
+            codegen_writeln(ctx, "hml_release(&%s);", sb);
+            codegen_writeln(ctx, "hml_release(&%s);", val);
+            free(sb);
+            free(val);
+            return result;
+        }
+
+        // __bw_new(target, capacity) - buffered writer (stdlib/fs.hml)
+        if (strcmp(fn_name, "__bw_new") == 0 && expr->as.call.num_args == 2) {
+            char *target = codegen_expr(ctx, expr->as.call.args[0]);
+            char *cap = codegen_expr(ctx, expr->as.call.args[1]);
+            codegen_writeln(ctx, "HmlValue %s = hml_bw_new(%s, %s);", result, target, cap);
+            codegen_writeln(ctx, "hml_release(&%s);", target);
+            codegen_writeln(ctx, "hml_release(&%s);", cap);
+            free(target);
+            free(cap);
+            return result;
+        }
+
+        // __walk_dir(root, options?) / __walk_open(root, options?) - directory walker (stdlib/fs.hml)
+        if ((strcmp(fn_name, "__walk_dir") == 0 || strcmp(fn_name, "__walk_open") == 0) &&
+            (expr->as.call.num_args == 1 || expr->as.call.num_args == 2)) {
+            char *root = codegen_expr(ctx, expr->as.call.args[0]);
+            char *options = expr->as.call.num_args == 2 ? codegen_expr(ctx, expr->as.call.args[1]) : NULL;
+            codegen_writeln(ctx, "HmlValue %s = %s(%s, %s);", result,
+                            strcmp(fn_name, "__walk_dir") == 0 ? "hml_walk_dir" : "hml_walk_open",
+                            root, options ? options : "hml_val_null()");
+            codegen_writeln(ctx, "hml_release(&%s);", root);
+            free(root);
+            if (options) {
+                codegen_writeln(ctx, "hml_release(&%s);", options);
+                free(options);
+            }
+            return result;
+        }
+
+        // __walk_next(handle) / __walk_close(handle)
+        if ((strcmp(fn_name, "__walk_next") == 0 || strcmp(fn_name, "__walk_close") == 0) &&
+            expr->as.call.num_args == 1) {
+            char *handle = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = %s(%s);", result,
+                            strcmp(fn_name, "__walk_next") == 0 ? "hml_walk_next" : "hml_walk_close",
+                            handle);
+            codegen_writeln(ctx, "hml_release(&%s);", handle);
+            free(handle);
+            return result;
+        }
+
+        // __spawn_process(argv, options?) / __process_wait(pid, timeout_ms?) (stdlib/process.hml)
+        if ((strcmp(fn_name, "__spawn_process") == 0 || strcmp(fn_name, "__process_wait") == 0) &&
+            (expr->as.call.num_args == 1 || expr->as.call.num_args == 2)) {
+            char *first = codegen_expr(ctx, expr->as.call.args[0]);
+            char *second = expr->as.call.num_args == 2 ? codegen_expr(ctx, expr->as.call.args[1]) : NULL;
+            codegen_writeln(ctx, "HmlValue %s = %s(%s, %s);", result,
+                            strcmp(fn_name, "__spawn_process") == 0 ? "hml_spawn_process" : "hml_process_wait",
+                            first, second ? second : "hml_val_null()");
+            codegen_writeln(ctx, "hml_release(&%s);", first);
+            free(first);
+            if (second) {
+                codegen_writeln(ctx, "hml_release(&%s);", second);
+                free(second);
+            }
+            return result;
+        }
+
+        // __run_many(cmds, concurrency)
+        if (strcmp(fn_name, "__run_many") == 0 && expr->as.call.num_args == 2) {
+            char *cmds = codegen_expr(ctx, expr->as.call.args[0]);
+            char *concurrency = codegen_expr(ctx, expr->as.call.args[1]);
+            codegen_writeln(ctx, "HmlValue %s = hml_run_many(%s, %s);", result, cmds, concurrency);
+            codegen_writeln(ctx, "hml_release(&%s);", cmds);
+            codegen_writeln(ctx, "hml_release(&%s);", concurrency);
+            free(cmds);
+            free(concurrency);
+            return result;
+        }
+
         // string_concat_many(array)
         if (strcmp(fn_name, "string_concat_many") == 0 && expr->as.call.num_args == 1) {
             char *arr = codegen_expr(ctx, expr->as.call.args[0]);
@@ -1943,6 +2162,101 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
             return result;
         }
 
+        // __lws_http_client_new(max_per_host, timeout_ms)
+        if (strcmp(fn_name, "__lws_http_client_new") == 0 && expr->as.call.num_args == 2) {
+            char *max_per_host = codegen_expr(ctx, expr->as.call.args[0]);
+            char *timeout_ms = codegen_expr(ctx, expr->as.call.args[1]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_client_new(%s, %s);", result, max_per_host, timeout_ms);
+            codegen_writeln(ctx, "hml_release(&%s);", max_per_host);
+            codegen_writeln(ctx, "hml_release(&%s);", timeout_ms);
+            free(max_per_host);
+            free(timeout_ms);
+            return result;
+        }
+
+        // __lws_http_client_submit(client, method, url, body, content_type)
+        if (strcmp(fn_name, "__lws_http_client_submit") == 0 && expr->as.call.num_args == 5) {
+            char *client = codegen_expr(ctx, expr->as.call.args[0]);
+            char *method = codegen_expr(ctx, expr->as.call.args[1]);
+            char *url = codegen_expr(ctx, expr->as.call.args[2]);
+            char *body = codegen_expr(ctx, expr->as.call.args[3]);
+            char *content_type = codegen_expr(ctx, expr->as.call.args[4]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_client_submit(%s, %s, %s, %s, %s);",
+                            result, client, method, url, body, content_type);
+            codegen_writeln(ctx, "hml_release(&%s);", client);
+            codegen_writeln(ctx, "hml_release(&%s);", method);
+            codegen_writeln(ctx, "hml_release(&%s);", url);
+            codegen_writeln(ctx, "hml_release(&%s);", body);
+            codegen_writeln(ctx, "hml_release(&%s);", content_type);
+            free(client);
+            free(method);
+            free(url);
+            free(body);
+            free(content_type);
+            return result;
+        }
+
+        // __lws_http_client_wait(request)
+        if (strcmp(fn_name, "__lws_http_client_wait") == 0 && expr->as.call.num_args == 1) {
+            char *request = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_client_wait(%s);", result, request);
+            codegen_writeln(ctx, "hml_release(&%s);", request);
+            free(request);
+            return result;
+        }
+
+        // __lws_http_client_close(client)
+        if (strcmp(fn_name, "__lws_http_client_close") == 0 && expr->as.call.num_args == 1) {
+            char *client = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_client_close(%s);", result, client);
+            codegen_writeln(ctx, "hml_release(&%s);", client);
+            free(client);
+            return result;
+        }
+
+        // __lws_http_stream_open(client, method, url, body, content_type)
+        if (strcmp(fn_name, "__lws_http_stream_open") == 0 && expr->as.call.num_args == 5) {
+            char *client = codegen_expr(ctx, expr->as.call.args[0]);
+            char *method = codegen_expr(ctx, expr->as.call.args[1]);
+            char *url = codegen_expr(ctx, expr->as.call.args[2]);
+            char *body = codegen_expr(ctx, expr->as.call.args[3]);
+            char *content_type = codegen_expr(ctx, expr->as.call.args[4]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_stream_open(%s, %s, %s, %s, %s);",
+                            result, client, method, url, body, content_type);
+            codegen_writeln(ctx, "hml_release(&%s);", client);
+            codegen_writeln(ctx, "hml_release(&%s);", method);
+            codegen_writeln(ctx, "hml_release(&%s);", url);
+            codegen_writeln(ctx, "hml_release(&%s);", body);
+            codegen_writeln(ctx, "hml_release(&%s);", content_type);
+            free(client);
+            free(method);
+            free(url);
+            free(body);
+            free(content_type);
+            return result;
+        }
+
+        // __lws_http_stream_read(handle, max)
+        if (strcmp(fn_name, "__lws_http_stream_read") == 0 && expr->as.call.num_args == 2) {
+            char *handle = codegen_expr(ctx, expr->as.call.args[0]);
+            char *max = codegen_expr(ctx, expr->as.call.args[1]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_stream_read(%s, %s);", result, handle, max);
+            codegen_writeln(ctx, "hml_release(&%s);", handle);
+            codegen_writeln(ctx, "hml_release(&%s);", max);
+            free(handle);
+            free(max);
+            return result;
+        }
+
+        // __lws_http_stream_close(handle)
+        if (strcmp(fn_name, "__lws_http_stream_close") == 0 && expr->as.call.num_args == 1) {
+            char *handle = codegen_expr(ctx, expr->as.call.args[0]);
+            codegen_writeln(ctx, "HmlValue %s = hml_lws_http_stream_close(%s);", result, handle);
+            codegen_writeln(ctx, "hml_release(&%s);", handle);
+            free(handle);
+            return result;
+        }
+
         // __lws_response_free(resp)
         if (strcmp(fn_name, "__lws_response_free") == 0 && expr->as.call.num_args == 1) {
             char *resp = codegen_expr(ctx, expr->as.call.args[0]);
@@ -2696,9 +3010,12 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
             codegen_writeln(ctx, "if (%s.type == HML_VAL_STRING) {", obj_val);
             codegen_writeln(ctx, "    %s = hml_string_contains(%s, %s);",
                           result, obj_val, arg_temps[0]);
-            codegen_writeln(ctx, "} else {");
+            codegen_writeln(ctx, "} else if (%s.type == HML_VAL_ARRAY) {", obj_val);
             codegen_writeln(ctx, "    %s = hml_array_contains(%s, %s);",
                           result, obj_val, arg_temps[0]);
+            codegen_writeln(ctx, "} else {");
+            codegen_writeln(ctx, "    HmlValue _contains_args[1] = {%s};", arg_temps[0]);
+            codegen_writeln(ctx, "    %s = hml_call_method(%s, \"contains\", _contains_args, 1);", result, obj_val);
             codegen_writeln(ctx, "}");
         // String-only methods
         } else if (strcmp(method, "substr") == 0 && expr->as.call.num_args == 2) {
@@ -2829,32 +3146,48 @@ char* codegen_expr_call(CodegenContext *ctx, Expr *expr, char *result) {
         } else if (strcmp(method, "clear") == 0 && expr->as.call.num_args == 0) {
             codegen_writeln(ctx, "hml_array_clear(%s);", obj_val);
             codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
-        // File methods
+        // File methods; read() and write() on anything else (an object's
+        // own method) are dispatched
         } else if (strcmp(method, "read") == 0 && (expr->as.call.num_args == 0 || expr->as.call.num_args == 1)) {
+            codegen_writeln(ctx, "HmlValue %s;", result);
+            codegen_writeln(ctx, "if (%s.type == HML_VAL_FILE) {", obj_val);
             if (expr->as.call.num_args == 1) {
-                codegen_writeln(ctx, "HmlValue %s = hml_file_read(%s, %s);",
-                              result, obj_val, arg_temps[0]);
+                codegen_writeln(ctx, "    %s = hml_file_read(%s, %s);", result, obj_val, arg_temps[0]);
+                codegen_writeln(ctx, "} else {");
+                codegen_writeln(ctx, "    HmlValue _read_args[1] = {%s};", arg_temps[0]);
+                codegen_writeln(ctx, "    %s = hml_call_method(%s, \"read\", _read_args, 1);", result, obj_val);
             } else {
-                codegen_writeln(ctx, "HmlValue %s = hml_file_read_all(%s);", result, obj_val);
+                codegen_writeln(ctx, "    %s = hml_file_read_all(%s);", result, obj_val);
+                codegen_writeln(ctx, "} else {");
+                codegen_writeln(ctx, "    %s = hml_call_method(%s, \"read\", NULL, 0);", result, obj_val);
             }
+            codegen_writeln(ctx, "}");
         } else if (strcmp(method, "write") == 0 && expr->as.call.num_args == 1) {
-            codegen_writeln(ctx, "HmlValue %s = hml_file_write(%s, %s);",
-                          result, obj_val, arg_temps[0]);
+            codegen_writeln(ctx, "HmlValue %s;", result);
+            codegen_writeln(ctx, "if (%s.type == HML_VAL_FILE) {", obj_val);
+            codegen_writeln(ctx, "    %s = hml_file_write(%s, %s);", result, obj_val, arg_temps[0]);
+            codegen_writeln(ctx, "} else {");
+            codegen_writeln(ctx, "    HmlValue _write_args[1] = {%s};", arg_temps[0]);
+            codegen_writeln(ctx, "    %s = hml_call_method(%s, \"write\", _write_args, 1);", result, obj_val);
+            codegen_writeln(ctx, "}");
         } else if (strcmp(method, "seek") == 0 && expr->as.call.num_args == 1) {
             codegen_writeln(ctx, "HmlValue %s = hml_file_seek(%s, %s);",
                           result, obj_val, arg_temps[0]);
         } else if (strcmp(method, "tell") == 0 && expr->as.call.num_args == 0) {
             codegen_writeln(ctx, "HmlValue %s = hml_file_tell(%s);", result, obj_val);
         } else if (strcmp(method, "close") == 0 && expr->as.call.num_args == 0) {
-            // Handle file.close(), channel.close(), and socket.close()
+            // Handle file.close(), channel.close(), and socket.close();
+            // anything else (an object's own close method) is dispatched
+            codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
             codegen_writeln(ctx, "if (%s.type == HML_VAL_FILE) {", obj_val);
             codegen_writeln(ctx, "    hml_file_close(%s);", obj_val);
             codegen_writeln(ctx, "} else if (%s.type == HML_VAL_CHANNEL) {", obj_val);
             codegen_writeln(ctx, "    hml_channel_close(%s);", obj_val);
             codegen_writeln(ctx, "} else if (%s.type == HML_VAL_SOCKET) {", obj_val);
             codegen_writeln(ctx, "    hml_socket_close(%s);", obj_val);
+            codegen_writeln(ctx, "} else {");
+            codegen_writeln(ctx, "    %s = hml_call_method(%s, \"close\", NULL, 0);", result, obj_val);
             codegen_writeln(ctx, "}");
-            codegen_writeln(ctx, "HmlValue %s = hml_val_null();", result);
         } else if (strcmp(method, "map") == 0 && expr->as.call.num_args == 1) {
             codegen_writeln(ctx, "HmlValue %s = hml_array_map(%s, %s);",
                           result, obj_val, arg_temps[0]);
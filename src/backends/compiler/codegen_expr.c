@@ -1182,8 +1182,8 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
             char *value = codegen_expr(ctx, expr->as.set_property.value);
             codegen_writeln(ctx, "hml_object_set_field(%s, \"%s\", %s);",
                           obj, expr->as.set_property.property, value);
+            // The result takes over the value temp's reference
             codegen_writeln(ctx, "HmlValue %s = %s;", result, value);
-            codegen_writeln(ctx, "hml_retain(&%s);", result);
             codegen_writeln(ctx, "hml_release(&%s);", obj);
             free(obj);
             free(value);
@@ -1331,8 +1331,8 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
                 codegen_indent_dec(ctx);
                 codegen_writeln(ctx, "}");
             }
+            // The result takes over the value temp's reference
             codegen_writeln(ctx, "HmlValue %s = %s;", result, value);
-            codegen_writeln(ctx, "hml_retain_if_needed(&%s);", result);
             codegen_writeln(ctx, "hml_release_if_needed(&%s);", obj);
             codegen_writeln(ctx, "hml_release_if_needed(&%s);", idx);
             free(obj);
@@ -1782,34 +1782,50 @@ char* codegen_expr(CodegenContext *ctx, Expr *expr) {
         }
 
         case EXPR_STRING_INTERPOLATION: {
-            // Build the string by concatenating parts
-            codegen_writeln(ctx, "HmlValue %s = hml_val_string(\"\");", result);
-
-            for (int i = 0; i <= expr->as.string_interpolation.num_parts; i++) {
-                // Add string part (there are num_parts+1 string parts)
-                if (expr->as.string_interpolation.string_parts[i] &&
-                    strlen(expr->as.string_interpolation.string_parts[i]) > 0) {
-                    char *escaped = codegen_escape_string(expr->as.string_interpolation.string_parts[i]);
-                    char *part_temp = codegen_temp(ctx);
-                    codegen_writeln(ctx, "HmlValue %s = hml_val_string(\"%s\");", part_temp, escaped);
-                    codegen_writeln(ctx, "HmlValue _concat%d = hml_string_concat(%s, %s);", ctx->temp_counter, result, part_temp);
-                    codegen_writeln(ctx, "hml_release(&%s);", result);
-                    codegen_writeln(ctx, "hml_release(&%s);", part_temp);
-                    codegen_writeln(ctx, "%s = _concat%d;", result, ctx->temp_counter);
-                    free(escaped);
-                    free(part_temp);
-                }
+            // Evaluate the expression parts in order, then build the string
+            // from them and the literal parts in one call
+            int num_parts = expr->as.string_interpolation.num_parts;
+            char **string_parts = expr->as.string_interpolation.string_parts;
+            if (num_parts == 0) {
+                char *escaped = codegen_escape_string(string_parts[0]);
+                codegen_writeln(ctx, "HmlValue %s = hml_val_string(\"%s\");", result, escaped);
+                free(escaped);
+                break;
+            }
 
-                // Add expression part (there are num_parts expression parts)
-                if (i < expr->as.string_interpolation.num_parts) {
-                    char *expr_val = codegen_expr(ctx, expr->as.string_interpolation.expr_parts[i]);
-                    codegen_writeln(ctx, "HmlValue _concat%d = hml_string_concat(%s, %s);", ctx->temp_counter, result, expr_val);
-                    codegen_writeln(ctx, "hml_release(&%s);", result);
-                    codegen_writeln(ctx, "hml_release(&%s);", expr_val);
-                    codegen_writeln(ctx, "%s = _concat%d;", result, ctx->temp_counter);
-                    free(expr_val);
-                }
+            char **part_vals = malloc(sizeof(char*) * num_parts);
+            for (int i = 0; i < num_parts; i++) {
+                part_vals[i] = codegen_expr(ctx, expr->as.string_interpolation.expr_parts[i]);
+            }
+
+            codegen_indent(ctx);
+            fprintf(ctx->output, "static const char *const %s_lits[] = { ", result);
+            for (int i = 0; i <= num_parts; i++) {
+                char *escaped = codegen_escape_string(string_parts[i]);
+                fprintf(ctx->output, "%s\"%s\"", i > 0 ? ", " : "", escaped);
+                free(escaped);
+            }
+            fprintf(ctx->output, " };\n");
+            codegen_indent(ctx);
+            fprintf(ctx->output, "static const int %s_lens[] = { ", result);
+            for (int i = 0; i <= num_parts; i++) {
+                fprintf(ctx->output, "%s%zu", i > 0 ? ", " : "", strlen(string_parts[i]));
+            }
+            fprintf(ctx->output, " };\n");
+            codegen_indent(ctx);
+            fprintf(ctx->output, "HmlValue %s_vals[] = { ", result);
+            for (int i = 0; i < num_parts; i++) {
+                fprintf(ctx->output, "%s%s", i > 0 ? ", " : "", part_vals[i]);
+            }
+            fprintf(ctx->output, " };\n");
+
+            codegen_writeln(ctx, "HmlValue %s = hml_string_interpolate(%s_lits, %s_lens, %s_vals, %d);",
+                            result, result, result, result, num_parts);
+            for (int i = 0; i < num_parts; i++) {
+                codegen_writeln(ctx, "hml_release(&%s);", part_vals[i]);
+                free(part_vals[i]);
             }
+            free(part_vals);
             break;
         }
 
@@ -261,6 +261,20 @@ char* codegen_expr_ident(CodegenContext *ctx, Expr *expr, char *result) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_remove_dir, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__list_dir") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_list_dir, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__walk_dir") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_walk_dir, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__walk_open") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_walk_open, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__walk_next") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_walk_next, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__walk_close") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_walk_close, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__spawn_process") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_spawn_process, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__process_wait") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_process_wait, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__run_many") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_run_many, 2, 2, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__cwd") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_cwd, 0, 0, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__chdir") == 0) {
@@ -307,6 +321,26 @@ char* codegen_expr_ident(CodegenContext *ctx, Expr *expr, char *result) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_crc32, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__adler32") == 0 || strcmp(expr->as.ident.name, "adler32") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_adler32, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_writer_open") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_writer_open, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_writer_add") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_writer_add, 6, 6, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_writer_add_path") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_writer_add_path, 3, 3, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_writer_close") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_writer_close, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_reader_open") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_reader_open, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_reader_next") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_reader_next, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_reader_read") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_reader_read, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_reader_extract") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_reader_extract, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_reader_extract_into") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_reader_extract_into, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__tar_reader_close") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_tar_reader_close, 1, 1, 0);", result);
     // Internal helper builtins
     } else if (strcmp(expr->as.ident.name, "__read_u32") == 0 || strcmp(expr->as.ident.name, "read_u32") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_read_u32, 1, 1, 0);", result);
@@ -324,6 +358,30 @@ char* codegen_expr_ident(CodegenContext *ctx, Expr *expr, char *result) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_cstr_to_string, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__string_from_bytes") == 0 || strcmp(expr->as.ident.name, "string_from_bytes") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_string_from_bytes, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__utf8_valid") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_utf8_valid, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__base64_encode") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_base64_encode, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__base64_decode") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_base64_decode, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__hex_encode") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hex_encode, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__hex_decode") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_hex_decode, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__percent_encode") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_percent_encode, 4, 4, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__percent_decode") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_percent_decode, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__sb_new") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_sb_new, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__sb_append") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_sb_append, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__sb_append_byte") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_sb_append_byte, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__sb_to_string") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_sb_to_string, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__bw_new") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_bw_new, 2, 2, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__to_string") == 0 || strcmp(expr->as.ident.name, "to_string") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_to_string, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__string_byte_length") == 0 || strcmp(expr->as.ident.name, "string_byte_length") == 0) {
@@ -346,6 +404,20 @@ char* codegen_expr_ident(CodegenContext *ctx, Expr *expr, char *result) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_response_headers, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__lws_response_free") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_response_free, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_client_new") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_client_new, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_client_submit") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_client_submit, 5, 5, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_client_wait") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_client_wait, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_client_close") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_client_close, 1, 1, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_stream_open") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_stream_open, 5, 5, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_stream_read") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_stream_read, 2, 2, 0);", result);
+    } else if (strcmp(expr->as.ident.name, "__lws_http_stream_close") == 0) {
+        codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_http_stream_close, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__lws_response_redirect") == 0) {
         codegen_writeln(ctx, "HmlValue %s = hml_val_function((void*)hml_builtin_lws_response_redirect, 1, 1, 0);", result);
     } else if (strcmp(expr->as.ident.name, "__lws_response_body_binary") == 0) {
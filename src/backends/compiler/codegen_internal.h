@@ -57,9 +57,8 @@ void membuf_free(MemBuffer *buf);
 // State saved when entering a function body (for nested functions and closures)
 typedef struct {
     int num_locals;           // Saved ctx->num_locals
-    DeferEntry *defer_stack;  // Saved ctx->defer_stack
+    DeferFrame *defer_frame;  // Saved ctx->defer_frame
     int in_function;          // Saved ctx->in_function
-    int has_defers;           // Saved ctx->has_defers
     CompiledModule *module;   // Saved ctx->current_module (for closures)
     ClosureInfo *closure;     // Saved ctx->current_closure
     char *tail_call_func_name;  // Saved tail call optimization state
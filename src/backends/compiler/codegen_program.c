@@ -72,6 +72,10 @@ void codegen_function_decl(CodegenContext *ctx, Expr *func, const char *name) {
     if (ctx->stack_check) {
         codegen_writeln(ctx, "HML_CALL_ENTER();");
     }
+    // Shadow stack for the sampling profiler (hemlockc --profile)
+    if (ctx->profile) {
+        codegen_writeln(ctx, "HML_PROFILE_ENTER(\"%s\");", name);
+    }
 
     // OPTIMIZATION: Tail call elimination
     // Check if function is tail recursive and set up for tail call optimization
@@ -91,16 +95,13 @@ void codegen_function_decl(CodegenContext *ctx, Expr *func, const char *name) {
     // Generate body
     funcgen_generate_body(ctx, func);
 
-    // Execute defers before implicit return
-    codegen_defer_execute_all(ctx);
-    if (ctx->has_defers) {
-        codegen_writeln(ctx, "hml_defer_execute_all();");
-    }
-
     // Decrement call depth and return
     if (ctx->stack_check) {
         codegen_writeln(ctx, "HML_CALL_EXIT();");
     }
+    if (ctx->profile) {
+        codegen_writeln(ctx, "HML_PROFILE_EXIT();");
+    }
     codegen_writeln(ctx, "return hml_val_null();");
 
     codegen_indent_dec(ctx);
@@ -199,6 +200,9 @@ void codegen_closure_impl(CodegenContext *ctx, ClosureInfo *closure) {
     if (ctx->stack_check) {
         codegen_writeln(ctx, "HML_CALL_ENTER();");
     }
+    if (ctx->profile) {
+        codegen_writeln(ctx, "HML_PROFILE_ENTER(\"<anonymous>\");");
+    }
 
     // Set up shared environment for nested closures
     funcgen_setup_shared_env(ctx, func, closure);
@@ -206,12 +210,6 @@ void codegen_closure_impl(CodegenContext *ctx, ClosureInfo *closure) {
     // Generate body
     funcgen_generate_body(ctx, func);
 
-    // Execute defers before implicit return
-    codegen_defer_execute_all(ctx);
-    if (ctx->has_defers) {
-        codegen_writeln(ctx, "hml_defer_execute_all();");
-    }
-
     // Release captured variables before return
     for (int i = 0; i < closure->num_captured; i++) {
         codegen_writeln(ctx, "hml_release(&%s);", closure->captured_vars[i]);
@@ -221,6 +219,9 @@ void codegen_closure_impl(CodegenContext *ctx, ClosureInfo *closure) {
     if (ctx->stack_check) {
         codegen_writeln(ctx, "HML_CALL_EXIT();");
     }
+    if (ctx->profile) {
+        codegen_writeln(ctx, "HML_PROFILE_EXIT();");
+    }
     codegen_writeln(ctx, "return hml_val_null();");
 
     codegen_indent_dec(ctx);
@@ -442,8 +443,6 @@ void codegen_module_funcs(CodegenContext *ctx, CompiledModule *module, MemBuffer
             funcgen_setup_shared_env(ctx, func, NULL);
             funcgen_generate_body(ctx, func);
 
-            // Execute defers and return
-            codegen_defer_execute_all(ctx);
             codegen_writeln(ctx, "return hml_val_null();");
 
             // Restore state
@@ -731,6 +730,14 @@ void codegen_program(CodegenContext *ctx, Stmt **stmts, int stmt_count) {
     codegen_write(ctx, "int main(int argc, char **argv) {\n");
     codegen_indent_inc(ctx);
     codegen_writeln(ctx, "hml_runtime_init(argc, argv);");
+    if (ctx->stdout_buffer > 0) {
+        codegen_writeln(ctx, "hml_stdout_buffer(%lldLL);", ctx->stdout_buffer);
+    }
+
+    // Start the sampling profiler before any user code runs
+    if (ctx->profile) {
+        codegen_writeln(ctx, "hml_profiler_start(\"%s\");", ctx->profile_output);
+    }
 
     // Initialize sandbox if enabled
     if (ctx->sandbox_flags != 0) {
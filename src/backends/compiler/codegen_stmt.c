@@ -207,6 +207,9 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
 
         case STMT_FOR: {
             ctx->loop_depth++;
+            // The loop variables are block-scoped: closures in the body
+            // capture each iteration's values
+            codegen_push_scope(ctx);
 
             // OPTIMIZATION: Analyze loop for unboxable counter
             if (ctx->type_ctx) {
@@ -236,6 +239,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 // Declare native counter
                 codegen_writeln(ctx, "int32_t %s = %d;", safe_name, init_val);
                 codegen_add_local(ctx, counter_name);
+                scope_add_var(ctx->current_scope, counter_name);
 
                 // Create continue label
                 char *continue_label = codegen_label(ctx);
@@ -383,6 +387,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 codegen_pop_for_continue(ctx);
                 free(continue_label);
             }
+            codegen_pop_scope(ctx);
             ctx->loop_depth--;
             break;
         }
@@ -391,6 +396,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             // Generate for-in loop for arrays, objects, or strings
             // for (let val in iterable) or for (let key, val in iterable)
             ctx->loop_depth++;
+            codegen_push_scope(ctx);
             codegen_writeln(ctx, "{");
             codegen_indent_inc(ctx);
 
@@ -447,6 +453,8 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             }
             codegen_writeln(ctx, "HmlValue %s;", safe_value_var);
             codegen_add_local(ctx, stmt->as.for_in.value_var);
+            scope_add_var(ctx->current_scope, stmt->as.for_in.key_var);
+            scope_add_var(ctx->current_scope, stmt->as.for_in.value_var);
 
             // Handle object iteration
             codegen_writeln(ctx, "if (%s.type == HML_VAL_OBJECT) {", iter_val);
@@ -509,6 +517,7 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
             codegen_writeln(ctx, "}");
             codegen_pop_for_continue(ctx);
             free(continue_label);
+            codegen_pop_scope(ctx);
             ctx->loop_depth--;
 
             free(iter_val);
@@ -563,29 +572,11 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                     codegen_writeln(ctx, "%s = hml_val_null();", ret_var);
                 }
                 codegen_writeln(ctx, "%s = 1;", has_ret);
-                codegen_writeln(ctx, "hml_exception_pop();");
-                codegen_writeln(ctx, "goto %s;", finally_label);
-            } else if (ctx->defer_stack) {
-                // We have defers - need to save return value, execute defers, then return
-                char *ret_val = codegen_temp(ctx);
-                if (stmt->as.return_stmt.value) {
-                    char *value = codegen_expr(ctx, stmt->as.return_stmt.value);
-                    codegen_writeln(ctx, "HmlValue %s = %s;", ret_val, value);
-                    free(value);
-                } else {
-                    codegen_writeln(ctx, "HmlValue %s = hml_val_null();", ret_val);
-                }
-                // Execute all defers in LIFO order
-                codegen_defer_execute_all(ctx);
-                // Execute any runtime defers (from loops) - only if this function has defers
-                if (ctx->has_defers) {
-                    codegen_writeln(ctx, "hml_defer_execute_all();");
+                // The defer frame's exit leaves its own exception context
+                if (!codegen_is_defer_exit(ctx, finally_label)) {
+                    codegen_writeln(ctx, "hml_exception_pop();");
                 }
-                if (ctx->stack_check) {
-                    codegen_writeln(ctx, "HML_CALL_EXIT();");
-                }
-                codegen_writeln(ctx, "return %s;", ret_val);
-                free(ret_val);
+                codegen_writeln(ctx, "goto %s;", finally_label);
             } else {
                 // No defers or try-finally - check for tail call optimization
                 // OPTIMIZATION: If returning a tail call to the current function,
@@ -624,23 +615,21 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 } else if (stmt->as.return_stmt.value) {
                     // Regular return with value
                     char *value = codegen_expr(ctx, stmt->as.return_stmt.value);
-                    // Execute any runtime defers (from loops) - only if this function has defers
-                    if (ctx->has_defers) {
-                        codegen_writeln(ctx, "hml_defer_execute_all();");
-                    }
                     if (ctx->stack_check) {
                         codegen_writeln(ctx, "HML_CALL_EXIT();");
                     }
+                    if (ctx->profile) {
+                        codegen_writeln(ctx, "HML_PROFILE_EXIT();");
+                    }
                     codegen_writeln(ctx, "return %s;", value);
                     free(value);
                 } else {
-                    // Execute any runtime defers (from loops) - only if this function has defers
-                    if (ctx->has_defers) {
-                        codegen_writeln(ctx, "hml_defer_execute_all();");
-                    }
                     if (ctx->stack_check) {
                         codegen_writeln(ctx, "HML_CALL_EXIT();");
                     }
+                    if (ctx->profile) {
+                        codegen_writeln(ctx, "HML_PROFILE_EXIT();");
+                    }
                     codegen_writeln(ctx, "return hml_val_null();");
                 }
             }
@@ -769,14 +758,24 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
                 if (needs_return_tracking) {
                     codegen_writeln(ctx, "if (%s) {", has_return_var);
                     codegen_indent_inc(ctx);
-                    // Execute any runtime defers (from loops) - only if this function has defers
-                    if (ctx->has_defers) {
-                        codegen_writeln(ctx, "hml_defer_execute_all();");
-                    }
-                    if (ctx->stack_check) {
-                        codegen_writeln(ctx, "HML_CALL_EXIT();");
+                    const char *outer_label = codegen_get_finally_label(ctx);
+                    if (outer_label) {
+                        // An enclosing finally (or the function's defers) runs first
+                        codegen_writeln(ctx, "%s = %s;", codegen_get_return_value_var(ctx), return_value_var);
+                        codegen_writeln(ctx, "%s = 1;", codegen_get_has_return_var(ctx));
+                        if (!codegen_is_defer_exit(ctx, outer_label)) {
+                            codegen_writeln(ctx, "hml_exception_pop();");
+                        }
+                        codegen_writeln(ctx, "goto %s;", outer_label);
+                    } else {
+                        if (ctx->stack_check) {
+                            codegen_writeln(ctx, "HML_CALL_EXIT();");
+                        }
+                        if (ctx->profile) {
+                            codegen_writeln(ctx, "HML_PROFILE_EXIT();");
+                        }
+                        codegen_writeln(ctx, "return %s;", return_value_var);
                     }
-                    codegen_writeln(ctx, "return %s;", return_value_var);
                     codegen_indent_dec(ctx);
                     codegen_writeln(ctx, "}");
 
@@ -793,10 +792,6 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
 
         case STMT_THROW: {
             char *value = codegen_expr(ctx, stmt->as.throw_stmt.value);
-            // Execute defers before throwing (they must run)
-            if (ctx->defer_stack) {
-                codegen_defer_execute_all(ctx);
-            }
             codegen_writeln(ctx, "hml_throw(%s);", value);
             free(value);
             break;
@@ -894,11 +889,12 @@ void codegen_stmt(CodegenContext *ctx, Stmt *stmt) {
         }
 
         case STMT_DEFER: {
-            ctx->has_defers = 1;  // Mark that this function has defers
-            // Always use runtime defer stack - this correctly handles:
-            // - Defers inside loops
-            // - Defers inside conditionals (if/else branches)
-            // - Nested control flow
+            // Inside a function the defer goes in the function's defer frame
+            if (ctx->defer_frame) {
+                codegen_defer_stmt(ctx, stmt);
+                break;
+            }
+            // At the top level it goes on the runtime defer stack, run at exit
             if (stmt->as.defer_stmt.call->type == EXPR_CALL) {
                 // Get the function being called and its arguments
                 Expr *call_expr = stmt->as.defer_stmt.call;
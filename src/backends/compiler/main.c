@@ -11,6 +11,7 @@
 #include <unistd.h>
 #include <sys/wait.h>
 #include <limits.h>
+#include <errno.h>
 #include "../../include/lexer.h"
 #include "../../include/parser.h"
 #include "../../include/ast.h"
@@ -178,6 +179,8 @@ typedef struct {
     int check_only;              // Only type check, don't compile
     int static_link;             // Static link all libraries for standalone binary
     int stack_check;             // Enable stack overflow checking (default: on)
+    const char *profile;         // Build with sampling profiler; folded stack output path (NULL = off)
+    long long stdout_buffer;     // Buffer stdout with this many bytes (0 = flush every print)
     int sandbox;                 // Enable sandbox mode (restrict FFI, network, process, file writes)
     const char *sandbox_root;    // Optional sandbox root directory for file access
 } Options;
@@ -202,6 +205,11 @@ static void print_usage(const char *progname) {
     fprintf(stderr, "  --strict-types  Strict type checking (warn on implicit any)\n");
     fprintf(stderr, "  --no-stack-check  Disable stack overflow checking (faster, but no protection)\n");
     fprintf(stderr, "  --static        Static link all libraries (standalone binary)\n");
+    fprintf(stderr, "  --profile[=F]   Build with sampling CPU profiler; the binary writes folded\n");
+    fprintf(stderr, "                  stacks to F (default: hemlock-profile.folded) on exit\n");
+    fprintf(stderr, "  --stdout-buffer=<size>\n");
+    fprintf(stderr, "                  Buffer stdout (e.g. 64K, 1M) instead of flushing every\n");
+    fprintf(stderr, "                  print; flushed on exit, and per line on a TTY\n");
     fprintf(stderr, "  --sandbox [DIR] Enable sandbox mode (restrict FFI, network, process, file writes)\n");
     fprintf(stderr, "                  If DIR provided, restricts file reads to that directory\n");
     fprintf(stderr, "  -v, --verbose   Verbose output\n");
@@ -209,6 +217,22 @@ static void print_usage(const char *progname) {
     fprintf(stderr, "  --version       Show version\n");
 }
 
+// Parse a byte count with an optional K/M/G suffix; -1 if malformed
+static long long parse_size(const char *text) {
+    char *end;
+    errno = 0;
+    long long n = strtoll(text, &end, 10);
+    if (errno != 0 || end == text || n < 0) return -1;
+    switch (*end) {
+        case 'k': case 'K': n *= 1024LL; end++; break;
+        case 'm': case 'M': n *= 1024LL * 1024; end++; break;
+        case 'g': case 'G': n *= 1024LL * 1024 * 1024; end++; break;
+        default: break;
+    }
+    if (*end == 'b' || *end == 'B') end++;
+    return *end == '\0' ? n : -1;
+}
+
 static Options parse_args(int argc, char **argv) {
     Options opts = {
         .input_file = NULL,
@@ -229,6 +253,8 @@ static Options parse_args(int argc, char **argv) {
         .check_only = 0,
         .static_link = 0,
         .stack_check = 1,        // Stack overflow checking ON by default
+        .profile = NULL,
+        .stdout_buffer = 0,
         .sandbox = 0,
         .sandbox_root = NULL
     };
@@ -270,6 +296,16 @@ static Options parse_args(int argc, char **argv) {
             opts.static_link = 1;
         } else if (strcmp(argv[i], "--no-stack-check") == 0) {
             opts.stack_check = 0;
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            opts.profile = HML_PROFILE_DEFAULT_OUTPUT;
+        } else if (strncmp(argv[i], "--profile=", 10) == 0 && argv[i][10] != '\0') {
+            opts.profile = argv[i] + 10;
+        } else if (strncmp(argv[i], "--stdout-buffer=", 16) == 0) {
+            opts.stdout_buffer = parse_size(argv[i] + 16);
+            if (opts.stdout_buffer <= 0) {
+                fprintf(stderr, "Invalid --stdout-buffer size: %s\n", argv[i] + 16);
+                exit(1);
+            }
         } else if (strcmp(argv[i], "--sandbox") == 0) {
             opts.sandbox = 1;
             // Check if next argument is an optional directory (not a flag and not a .hml file)
@@ -673,6 +709,9 @@ int main(int argc, char **argv) {
     codegen_set_module_cache(ctx, module_cache);
     ctx->type_ctx = type_ctx;  // Pass type context for unboxing hints
     ctx->stack_check = opts.stack_check;  // Pass stack check setting
+    ctx->profile = opts.profile != NULL;
+    ctx->profile_output = opts.profile;
+    ctx->stdout_buffer = opts.stdout_buffer;
     // Note: ctx->optimize is already set in codegen_new() based on optimization level
     // Don't override it here - the type context is just for unboxing hints
 
@@ -817,7 +817,7 @@ CheckedType* type_check_infer_expr(TypeCheckContext *ctx, Expr *expr) {
                 "ptr_read_u16", "ptr_read_u32", "ptr_read_u64", "ptr_write_i8",
                 "ptr_write_i16", "ptr_write_i32", "ptr_write_i64", "ptr_write_f32",
                 "ptr_write_f64", "ptr_write_u8", "ptr_write_u16", "ptr_write_u32",
-                "ptr_write_u64", "ptr_null", "sizeof", "talloc", "open", "read_line",
+                "ptr_write_u64", "ptr_null", "sizeof", "talloc", "open", "mmap_file", "read_line",
                 "panic", "throw", "spawn", "join", "detach", "channel", "signal",
                 "raise", "apply", "exec", "wait", "kill", "fork", "sleep", "exit",
                 "atomic_load_i32", "atomic_store_i32", "atomic_add_i32", "atomic_sub_i32",
@@ -982,6 +982,7 @@ CheckedType* type_check_infer_expr(TypeCheckContext *ctx, Expr *expr) {
                 if (strcmp(name, "alloc") == 0) return checked_type_primitive(CHECKED_PTR);
                 if (strcmp(name, "buffer") == 0) return checked_type_primitive(CHECKED_BUFFER);
                 if (strcmp(name, "open") == 0) return checked_type_primitive(CHECKED_FILE);
+                if (strcmp(name, "mmap_file") == 0) return checked_type_primitive(CHECKED_BUFFER);
                 if (strcmp(name, "channel") == 0) return checked_type_primitive(CHECKED_CHANNEL);
                 if (strcmp(name, "spawn") == 0) return checked_type_primitive(CHECKED_TASK);
                 if (strcmp(name, "read_line") == 0) {
@@ -0,0 +1,298 @@
+/*
+ * Buffered writer values
+ *
+ * A buffered writer is a fixed-capacity buffer of output waiting to go to a
+ * file or file descriptor. Values are formatted straight into the buffer
+ * (numbers with no intermediate string), and the buffer is written out in
+ * one call when the next value does not fit, so emitting many small values
+ * costs one write per buffer instead of one per value. Values larger than
+ * the buffer are written through directly. BufferedWriter in @stdlib/fs
+ * returns one of these; its methods are dispatched here like file methods.
+ */
+
+#include "internal.h"
+#include "../io/internal.h"
+#include <errno.h>
+#include <unistd.h>
+
+#define BW_MIN_CAPACITY 64
+
+// Where a writer's bytes go: a stdio stream, or a raw descriptor
+typedef struct {
+    FILE *fp;
+    int fd;
+} BwTarget;
+
+// Files and descriptors 1 and 2 go through stdio so output stays ordered
+// with print() and eprint()
+static int bw_target(WriterHandle *writer, BwTarget *target, ExecutionContext *ctx) {
+    target->fp = NULL;
+    target->fd = writer->fd;
+    if (writer->file) {
+        if (writer->file->closed) {
+            runtime_error(ctx, "Cannot write to closed file '%s'", writer->file->path);
+            return 0;
+        }
+        target->fp = writer->file->fp;
+    } else if (writer->fd == STDOUT_FILENO) {
+        target->fp = stdout;
+    } else if (writer->fd == STDERR_FILENO) {
+        target->fp = stderr;
+    }
+    return 1;
+}
+
+static int bw_emit(BwTarget *target, const char *data, size_t len, ExecutionContext *ctx) {
+    if (target->fp) {
+        if (fwrite(data, 1, len, target->fp) != len) {
+            runtime_error(ctx, "BufferedWriter write failed: %s", strerror(errno));
+            return 0;
+        }
+        return 1;
+    }
+    while (len > 0) {
+        ssize_t n = write(target->fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            runtime_error(ctx, "BufferedWriter write failed: %s", strerror(errno));
+            return 0;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static int bw_drain(WriterHandle *writer, BwTarget *target, ExecutionContext *ctx) {
+    if (writer->length == 0) return 1;
+    int ok = bw_emit(target, writer->data, (size_t)writer->length, ctx);
+    writer->length = 0;
+    return ok;
+}
+
+// Make room for len more bytes, draining the buffer if it is too full
+static int bw_reserve(WriterHandle *writer, BwTarget *target, int len, ExecutionContext *ctx) {
+    if (writer->capacity - writer->length >= len) return 1;
+    return bw_drain(writer, target, ctx);
+}
+
+static int bw_put(WriterHandle *writer, BwTarget *target, const char *bytes, int len, ExecutionContext *ctx) {
+    if (!bw_reserve(writer, target, len, ctx)) return 0;
+    if (len > writer->capacity) {
+        return bw_emit(target, bytes, (size_t)len, ctx);
+    }
+    memcpy(writer->data + writer->length, bytes, len);
+    writer->length += len;
+    return 1;
+}
+
+// Append a value the way string + value would; buffers append their raw bytes
+static int bw_put_value(WriterHandle *writer, BwTarget *target, Value val, ExecutionContext *ctx) {
+    switch (val.type) {
+        case VAL_STRING:
+            return bw_put(writer, target, val.as.as_string->data, val.as.as_string->length, ctx);
+        case VAL_BUFFER:
+            return bw_put(writer, target, val.as.as_buffer->data, val.as.as_buffer->length, ctx);
+        case VAL_RUNE: {
+            char bytes[4];
+            int len = utf8_encode(val.as.as_rune, bytes);
+            return bw_put(writer, target, bytes, len, ctx);
+        }
+        case VAL_BOOL:
+            return val.as.as_bool ? bw_put(writer, target, "true", 4, ctx)
+                                  : bw_put(writer, target, "false", 5, ctx);
+        case VAL_NULL:
+            return bw_put(writer, target, "null", 4, ctx);
+        case VAL_I8: case VAL_I16: case VAL_I32: case VAL_I64:
+        case VAL_U8: case VAL_U16: case VAL_U32: case VAL_U64:
+        case VAL_F32: case VAL_F64:
+            // Numbers are formatted in place, as value_to_string() would
+            if (!bw_reserve(writer, target, STR_NUMBER_MAX, ctx)) return 0;
+            writer->length += value_format_number(val, writer->data + writer->length);
+            return 1;
+        case VAL_OBJECT:
+        case VAL_ARRAY: {
+            // Same JSON form as string + object
+            VisitedSet visited;
+            visited_set_init(&visited);
+            char *json = serialize_value(val, &visited, ctx);
+            visited_set_destroy(&visited);
+            if (!json) return 0;
+            int ok = bw_put(writer, target, json, (int)strlen(json), ctx);
+            free(json);
+            return ok;
+        }
+        default: {
+            char *str = value_to_string(val);
+            int ok = bw_put(writer, target, str, (int)strlen(str), ctx);
+            free(str);
+            return ok;
+        }
+    }
+}
+
+// ========== WRITER VALUE ==========
+
+// Empty writer for file, or for fd when file is NULL (NULL if out of memory)
+WriterHandle *writer_new(FileHandle *file, int fd, int capacity) {
+    WriterHandle *writer = malloc(sizeof(WriterHandle));
+    char *data = malloc((size_t)capacity);
+    if (!writer || !data) {
+        free(writer);
+        free(data);
+        return NULL;
+    }
+    writer->data = data;
+    writer->length = 0;
+    writer->capacity = capacity;
+    writer->file = file;
+    writer->fd = fd;
+    writer->closed = 0;
+    writer->ref_count = 1;
+    return writer;
+}
+
+Value val_writer(WriterHandle *writer) {
+    Value v = {0};
+    v.type = VAL_WRITER;
+    v.as.as_writer = writer;
+    return v;
+}
+
+// Pending output is dropped: only flush() and close() write it out
+void writer_free(WriterHandle *writer) {
+    if (!writer) return;
+    free(writer->data);
+    free(writer);
+}
+
+void writer_retain(WriterHandle *writer) {
+    if (writer) {
+        __atomic_add_fetch(&writer->ref_count, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void writer_release(WriterHandle *writer) {
+    if (writer) {
+        int old_count = __atomic_sub_fetch(&writer->ref_count, 1, __ATOMIC_SEQ_CST);
+        if (old_count == 0) {
+            writer_free(writer);
+        }
+    }
+}
+
+// __bw_new(target, capacity) - writer for an open file or a descriptor,
+// buffering up to capacity bytes
+Value builtin_bw_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[1])) {
+        runtime_error(ctx, "__bw_new() expects 2 arguments (target, capacity)");
+        return val_null();
+    }
+    FileHandle *file = NULL;
+    int fd = -1;
+    if (args[0].type == VAL_FILE) {
+        file = args[0].as.as_file;
+        if (file->closed) {
+            runtime_error(ctx, "Cannot write to closed file '%s'", file->path);
+            return val_null();
+        }
+        if (file->mode[0] == 'r' && strchr(file->mode, '+') == NULL) {
+            runtime_error(ctx, "Cannot write to file '%s' opened in read-only mode", file->path);
+            return val_null();
+        }
+    } else if (is_integer(args[0])) {
+        fd = value_to_int(args[0]);
+        if (fd < 0) {
+            runtime_error(ctx, "BufferedWriter() invalid file descriptor %d", fd);
+            return val_null();
+        }
+        if (fd != STDOUT_FILENO && fd != STDERR_FILENO &&
+            sandbox_is_restricted(ctx, HML_SANDBOX_RESTRICT_FILE_WRITE)) {
+            runtime_error(ctx, "BufferedWriter() writing to file descriptors is not allowed in sandbox mode");
+            return val_null();
+        }
+    } else {
+        runtime_error(ctx, "BufferedWriter() target must be a file or file descriptor");
+        return val_null();
+    }
+
+    int capacity = value_to_int(args[1]);
+    if (capacity < BW_MIN_CAPACITY) capacity = BW_MIN_CAPACITY;
+
+    WriterHandle *writer = writer_new(file, fd, capacity);
+    if (!writer) {
+        runtime_error(ctx, "Memory allocation failed");
+        return val_null();
+    }
+    return val_writer(writer);
+}
+
+// ========== WRITER METHODS ==========
+
+// Write out everything buffered and flush the stream
+static void bw_flush(WriterHandle *writer, BwTarget *target, ExecutionContext *ctx) {
+    if (bw_drain(writer, target, ctx) && target->fp && fflush(target->fp) != 0) {
+        runtime_error(ctx, "BufferedWriter flush failed: %s", strerror(errno));
+    }
+}
+
+Value call_writer_method(WriterHandle *writer, const char *method, Value *args, int num_args, ExecutionContext *ctx) {
+    // Bytes waiting to be written
+    if (strcmp(method, "buffered") == 0 && num_args == 0) {
+        return val_i32(writer->length);
+    }
+    if (strcmp(method, "close") == 0 && num_args == 0) {
+        // Flushes, but leaves the target open; closing twice is a no-op
+        BwTarget target;
+        if (!writer->closed && bw_target(writer, &target, ctx)) {
+            bw_flush(writer, &target, ctx);
+        }
+        writer->closed = 1;
+        return val_null();
+    }
+
+    BwTarget target;
+    if (writer->closed) {
+        runtime_error(ctx, "Cannot use closed BufferedWriter");
+        return val_null();
+    }
+    if (!bw_target(writer, &target, ctx)) return val_null();
+
+    if (strcmp(method, "write") == 0 && num_args == 1) {
+        bw_put_value(writer, &target, args[0], ctx);
+        return val_null();
+    }
+    if (strcmp(method, "write_line") == 0 && num_args <= 1) {
+        if (num_args == 0 || bw_put_value(writer, &target, args[0], ctx)) {
+            bw_put(writer, &target, "\n", 1, ctx);
+        }
+        return val_null();
+    }
+    // The values separated by separator (default ","), then a newline
+    if (strcmp(method, "write_fields") == 0 && (num_args == 1 || num_args == 2)) {
+        if (args[0].type != VAL_ARRAY || (num_args == 2 && args[1].type != VAL_STRING)) {
+            runtime_error(ctx, "write_fields() expects an array and an optional separator string");
+            return val_null();
+        }
+        Array *values = args[0].as.as_array;
+        const char *sep = ",";
+        int sep_len = 1;
+        if (num_args == 2) {
+            sep = args[1].as.as_string->data;
+            sep_len = args[1].as.as_string->length;
+        }
+        for (int i = 0; i < values->length; i++) {
+            if (i > 0 && !bw_put(writer, &target, sep, sep_len, ctx)) return val_null();
+            if (!bw_put_value(writer, &target, values->elements[i], ctx)) return val_null();
+        }
+        bw_put(writer, &target, "\n", 1, ctx);
+        return val_null();
+    }
+    if (strcmp(method, "flush") == 0 && num_args == 0) {
+        bw_flush(writer, &target, ctx);
+        return val_null();
+    }
+
+    runtime_error(ctx, "BufferedWriter has no method '%s'", method);
+    return val_null();
+}
@@ -15,6 +15,12 @@ static void* task_thread_wrapper(void* arg) {
     sigfillset(&set);
     pthread_sigmask(SIG_BLOCK, &set, NULL);
 
+    // Under --profile, let the sampler see this task's call stack
+    profiler_thread_start(task->ctx);
+    heap_profiler_thread_start(task->ctx);
+    trace_thread_start("task", task->id);
+    uint64_t trace_start_ns = TRACE_NOW();
+
     // Mark as running (thread-safe)
     pthread_mutex_lock((pthread_mutex_t*)task->task_mutex);
     task->state = TASK_RUNNING;
@@ -37,12 +43,14 @@ static void* task_thread_wrapper(void* arg) {
 
     // Execute function body
     eval_stmt(fn->body, func_env, task->ctx);
+    profiler_thread_stop();
+    TRACE_SPAN("task", "run", trace_start_ns, "task", task->id);
 
     // Get return value
     Value result = val_null();
-    if (task->ctx->return_state.is_returning) {
+    if (task->ctx->flow.is_returning) {
         result = task->ctx->return_state.return_value;
-        task->ctx->return_state.is_returning = 0;
+        task->ctx->flow.is_returning = 0;
     }
 
     // Store result and mark as completed (thread-safe)
@@ -61,6 +69,7 @@ static void* task_thread_wrapper(void* arg) {
         task_release(task);
     }
 
+    gc_task_finished();
     return NULL;
 }
 
@@ -114,12 +123,14 @@ Value builtin_spawn(Value *args, int num_args, ExecutionContext *ctx) {
         exit(1);
     }
 
-    // Create thread to execute task
+    // Create thread to execute task (the collector pauses until it finishes)
+    gc_task_started();
     int rc = pthread_create((pthread_t*)task->thread, NULL, task_thread_wrapper, task);
     if (rc != 0) {
         fprintf(stderr, "Runtime error: Failed to create thread: %d\n", rc);
         exit(1);
     }
+    TRACE_INSTANT_EVENT("task", "spawn", "task", task_id);
 
     return val_task(task);
 }
@@ -160,6 +171,7 @@ Value builtin_join(Value *args, int num_args, ExecutionContext *ctx) {
     pthread_mutex_unlock((pthread_mutex_t*)task->task_mutex);
 
     // Wait for thread to complete (outside of mutex to avoid deadlock)
+    uint64_t trace_start_ns = TRACE_NOW();
     if (task->thread) {
         int rc = pthread_join(*(pthread_t*)task->thread, NULL);
         if (rc != 0) {
@@ -167,14 +179,16 @@ Value builtin_join(Value *args, int num_args, ExecutionContext *ctx) {
             return val_null();
         }
     }
+    TRACE_SPAN("task", "join", trace_start_ns, "task", task->id);
 
     // Access exception state and result (thread-safe)
     pthread_mutex_lock((pthread_mutex_t*)task->task_mutex);
 
     // Check if task threw an exception
-    if (task->ctx->exception_state.is_throwing) {
+    if (task->ctx->flow.is_throwing) {
         // Re-throw the exception in the current context
         ctx->exception_state = task->ctx->exception_state;
+        ctx->flow.is_throwing = 1;
         pthread_mutex_unlock((pthread_mutex_t*)task->task_mutex);
         return val_null();
     }
@@ -244,6 +258,7 @@ Value builtin_detach(Value *args, int num_args, ExecutionContext *ctx) {
                 return val_null();
             }
         }
+        TRACE_INSTANT_EVENT("task", "detach", "task", t->id);
 
         return val_null();
     }
@@ -292,8 +307,10 @@ Value builtin_detach(Value *args, int num_args, ExecutionContext *ctx) {
         task_retain(task);  // ref_count: 1 -> 2
 
         // Create thread to execute task
+        gc_task_started();
         int rc = pthread_create((pthread_t*)task->thread, NULL, task_thread_wrapper, task);
         if (rc != 0) {
+            gc_task_finished();
             runtime_error(ctx, "Failed to create thread: %d", rc);
             free(task->thread);
             task_release(task);  // Release our temporary reference
@@ -308,6 +325,8 @@ Value builtin_detach(Value *args, int num_args, ExecutionContext *ctx) {
             task_release(task);  // Release our temporary reference
             return val_null();
         }
+        TRACE_INSTANT_EVENT("task", "spawn", "task", task_id);
+        TRACE_INSTANT_EVENT("task", "detach", "task", task_id);
 
         // Release our temporary reference - worker thread will clean up when done
         // ref_count: 2 -> 1 (worker thread holds the remaining reference)
@@ -396,6 +415,7 @@ Value builtin_select(Value *args, int num_args, ExecutionContext *ctx) {
 
     // Polling loop with sleep
     // Check all channels, if none ready, sleep briefly and retry
+    uint64_t trace_start_ns = TRACE_NOW();
     while (1) {
         // Check each channel for available data
         for (int i = 0; i < channels->length; i++) {
@@ -426,6 +446,7 @@ Value builtin_select(Value *args, int num_args, ExecutionContext *ctx) {
                 result->field_values[1] = msg;
                 result->num_fields = 2;
 
+                TRACE_SPAN("channel", "select", trace_start_ns, "channels", channels->length);
                 return val_object(result);
             }
 
@@ -443,6 +464,7 @@ Value builtin_select(Value *args, int num_args, ExecutionContext *ctx) {
                 result->field_values[1] = val_null();
                 result->num_fields = 2;
 
+                TRACE_SPAN("channel", "select", trace_start_ns, "channels", channels->length);
                 return val_object(result);
             }
 
@@ -455,6 +477,7 @@ Value builtin_select(Value *args, int num_args, ExecutionContext *ctx) {
             clock_gettime(CLOCK_REALTIME, &now);
             if (now.tv_sec > deadline_ptr->tv_sec ||
                 (now.tv_sec == deadline_ptr->tv_sec && now.tv_nsec >= deadline_ptr->tv_nsec)) {
+                TRACE_SPAN("channel", "select", trace_start_ns, "channels", channels->length);
                 return val_null();  // Timeout
             }
         }
@@ -497,7 +520,7 @@ Value builtin_task_debug_info(Value *args, int num_args, ExecutionContext *ctx)
     printf("Detached: %s\n", task->detached ? "true" : "false");
     printf("Ref Count: %d\n", task->ref_count);
     printf("Has Result: %s\n", task->result ? "true" : "false");
-    printf("Exception: %s\n", task->ctx->exception_state.is_throwing ? "true" : "false");
+    printf("Exception: %s\n", task->ctx->flow.is_throwing ? "true" : "false");
     printf("======================\n");
 
     pthread_mutex_unlock((pthread_mutex_t*)task->task_mutex);
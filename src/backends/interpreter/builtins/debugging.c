@@ -86,6 +86,9 @@ Value builtin_typeof(Value *args, int num_args, ExecutionContext *ctx) {
         case VAL_CHANNEL:
             type_name = "channel";
             break;
+        case VAL_WRITER:
+            type_name = "writer";
+            break;
         default:
             type_name = "unknown";
             break;
@@ -160,7 +163,7 @@ Value builtin_assert(Value *args, int num_args, ExecutionContext *ctx) {
         // Retain the exception value so it survives past environment cleanups during unwinding
         value_retain(exception_msg);
         ctx->exception_state.exception_value = exception_msg;
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
     }
 
     return val_null();
@@ -230,3 +233,136 @@ Value builtin_get_stack_limit(Value *args, int num_args, ExecutionContext *ctx)
 
     return val_i32(ctx->max_stack_depth);
 }
+
+// Append a named field to an object built by the heap_stats() helpers
+static void heap_stats_field(Object *obj, const char *name, Value value) {
+    obj->field_names[obj->num_fields] = strdup(name);
+    obj->field_values[obj->num_fields] = value;
+    obj->num_fields++;
+}
+
+Value builtin_heap_stats(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;  // Unused
+    if (num_args != 0) {
+        runtime_error(ctx, "heap_stats() expects no arguments");
+        return val_null();
+    }
+
+    HeapKindStats stats[HEAP_KIND_COUNT];
+    long peak = 0;
+    HeapSiteStats *top = NULL;
+    int num_top = 0;
+    heap_profiler_stats(stats, &peak, &top, &num_top, HML_PROFILE_TOP_N);
+
+    long live_objects = 0, live_bytes = 0, total_allocs = 0;
+    Object *by_type = object_new(NULL, HEAP_KIND_COUNT);
+    for (int k = 0; k < HEAP_KIND_COUNT; k++) {
+        live_objects += stats[k].live;
+        live_bytes += stats[k].live_bytes;
+        total_allocs += stats[k].allocs;
+
+        Object *entry = object_new(NULL, 4);
+        heap_stats_field(entry, "live", val_i64(stats[k].live));
+        heap_stats_field(entry, "bytes", val_i64(stats[k].live_bytes));
+        heap_stats_field(entry, "allocs", val_i64(stats[k].allocs));
+        heap_stats_field(entry, "alloc_bytes", val_i64(stats[k].alloc_bytes));
+        heap_stats_field(by_type, heap_kind_name((HeapKind)k), val_object(entry));
+    }
+
+    Array *sites = array_new();
+    for (int i = 0; i < num_top; i++) {
+        Object *site = object_new(NULL, 5);
+        heap_stats_field(site, "stack", val_string(top[i].stack));
+        heap_stats_field(site, "allocs", val_i64(top[i].allocs));
+        heap_stats_field(site, "bytes", val_i64(top[i].bytes));
+        heap_stats_field(site, "live", val_i64(top[i].live));
+        heap_stats_field(site, "live_bytes", val_i64(top[i].live_bytes));
+        Value site_val = val_object(site);
+        array_push(sites, site_val);
+        VALUE_RELEASE(site_val);
+    }
+    heap_sites_free(top, num_top);
+
+    Object *result = object_new(NULL, 8);
+    heap_stats_field(result, "enabled", val_bool(heap_tracking_enabled));
+    heap_stats_field(result, "live_objects", val_i64(live_objects));
+    heap_stats_field(result, "live_bytes", val_i64(live_bytes));
+    heap_stats_field(result, "peak_bytes", val_i64(peak));
+    heap_stats_field(result, "total_allocs", val_i64(total_allocs));
+    heap_stats_field(result, "by_type", val_object(by_type));
+    heap_stats_field(result, "sample_interval", val_i32(HML_HEAP_SAMPLE_INTERVAL));
+    heap_stats_field(result, "sites", val_array(sites));
+    return val_object(result);
+}
+
+Value builtin_heap_snapshot(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_STRING) {
+        runtime_error(ctx, "heap_snapshot() expects 1 string argument (path)");
+        return val_null();
+    }
+    if (!heap_tracking_enabled) {
+        runtime_error(ctx, "heap_snapshot() requires heap profiling (run with --heap-profile or HEMLOCK_HEAP_PROFILE=1)");
+        return val_null();
+    }
+
+    const char *path = args[0].as.as_string->data;
+    int err = heap_profiler_snapshot(path);
+    if (err != 0) {
+        runtime_error(ctx, "heap_snapshot() failed to write '%s': %s", path, strerror(err));
+        return val_null();
+    }
+    return val_null();
+}
+
+Value builtin_gc_collect(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;  // Unused
+    if (num_args != 0) {
+        runtime_error(ctx, "gc_collect() expects no arguments");
+        return val_null();
+    }
+
+    // Nothing is collected while tasks are running
+    int freed = gc_collect();
+    return val_i32(freed > 0 ? freed : 0);
+}
+
+Value builtin_gc_stats(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;  // Unused
+    if (num_args != 0) {
+        runtime_error(ctx, "gc_stats() expects no arguments");
+        return val_null();
+    }
+
+    GCStats stats;
+    gc_get_stats(&stats);
+
+    Object *result = object_new(NULL, 6);
+    heap_stats_field(result, "collections", val_i64(stats.collections));
+    heap_stats_field(result, "collected", val_i64(stats.collected));
+    heap_stats_field(result, "candidates", val_i32(stats.candidates));
+    heap_stats_field(result, "traced", val_i32(stats.traced));
+    heap_stats_field(result, "threshold", val_i32(stats.threshold));
+    heap_stats_field(result, "pause_ms", val_f64(stats.pause_ms));
+    return val_object(result);
+}
+
+Value builtin_alloc_stats(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args;  // Unused
+    if (num_args != 0) {
+        runtime_error(ctx, "alloc_stats() expects no arguments");
+        return val_null();
+    }
+
+    SlabStats stats;
+    slab_get_stats(&stats);
+
+    Object *result = object_new(NULL, 7);
+    heap_stats_field(result, "enabled", val_bool(stats.enabled));
+    heap_stats_field(result, "allocs", val_i64(stats.allocs));
+    heap_stats_field(result, "frees", val_i64(stats.frees));
+    heap_stats_field(result, "live", val_i64(stats.allocs - stats.frees));
+    heap_stats_field(result, "inline_strings", val_i64(stats.inline_strings));
+    heap_stats_field(result, "depot_blocks", val_i64(stats.depot_blocks));
+    heap_stats_field(result, "reserved_bytes", val_i64(stats.reserved_bytes));
+    return val_object(result);
+}
@@ -41,7 +41,7 @@ Value builtin_make_dir(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to create directory '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -81,7 +81,7 @@ Value builtin_remove_dir(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to remove directory '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -122,7 +122,7 @@ Value builtin_list_dir(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to open directory '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -151,7 +151,7 @@ Value builtin_cwd(Value *args, int num_args, ExecutionContext *ctx) {
     char buffer[PATH_MAX];
     if (getcwd(buffer, sizeof(buffer)) == NULL) {
         ctx->exception_state.exception_value = val_string(strerror(errno));
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -183,7 +183,7 @@ Value builtin_chdir(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to change directory to '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -217,7 +217,7 @@ Value builtin_absolute_path(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to resolve path '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
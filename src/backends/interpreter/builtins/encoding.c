@@ -0,0 +1,217 @@
+/*
+ * Encoding builtins
+ *
+ * Base64, hex and percent-encoding over strings and buffers for
+ * @stdlib/encoding, @stdlib/url and @stdlib/http. The output size is known
+ * (or counted) up front, so each call allocates its result once and the
+ * kernels in str_kernels.c write straight into it. Decoded bytes become a
+ * string as-is, like __string_from_bytes().
+ */
+
+#include "internal.h"
+
+// Bytes of a string or buffer argument
+static int codec_input(Value val, const unsigned char **data, size_t *len,
+                       const char *fn_name, ExecutionContext *ctx) {
+    if (val.type == VAL_STRING) {
+        *data = (const unsigned char *)val.as.as_string->data;
+        *len = (size_t)val.as.as_string->length;
+        return 1;
+    }
+    if (val.type == VAL_BUFFER && !atomic_load(&val.as.as_buffer->freed)) {
+        *data = (const unsigned char *)val.as.as_buffer->data;
+        *len = val.as.as_buffer->data ? (size_t)val.as.as_buffer->length : 0;
+        return 1;
+    }
+    runtime_error(ctx, "%s() requires a string or buffer", fn_name);
+    return 0;
+}
+
+static char *codec_alloc(size_t len, const char *fn_name, ExecutionContext *ctx) {
+    if (len >= INT32_MAX) {
+        runtime_error(ctx, "%s() result too large", fn_name);
+        return NULL;
+    }
+    char *out = malloc(len + 1);
+    if (!out) {
+        runtime_error(ctx, "%s() memory allocation failed", fn_name);
+    }
+    return out;
+}
+
+static Value codec_result(char *out, size_t len) {
+    out[len] = '\0';
+    return val_string_take(out, (int)len, (int)len + 1);
+}
+
+// Copy of data without spaces, tabs and line breaks, or NULL if it has none
+static char *strip_whitespace(const unsigned char *data, size_t *len) {
+    size_t i = 0;
+    while (i < *len && data[i] != ' ' && data[i] != '\n' && data[i] != '\r' && data[i] != '\t') i++;
+    if (i == *len) return NULL;
+    char *clean = malloc(*len);
+    if (!clean) return NULL;
+    memcpy(clean, data, i);
+    size_t n = i;
+    for (; i < *len; i++) {
+        unsigned char c = data[i];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') clean[n++] = (char)c;
+    }
+    *len = n;
+    return clean;
+}
+
+// __base64_encode(input) - standard base64 with '=' padding
+Value builtin_base64_encode(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__base64_encode() expects 1 argument (string or buffer)");
+        return val_null();
+    }
+    const unsigned char *data;
+    size_t len;
+    if (!codec_input(args[0], &data, &len, "__base64_encode", ctx)) return val_null();
+    size_t out_len = (len + 2) / 3 * 4;
+    char *out = codec_alloc(out_len, "__base64_encode", ctx);
+    if (!out) return val_null();
+    str_base64_encode(out, data, len);
+    return codec_result(out, out_len);
+}
+
+// __base64_decode(input) - decode base64, ignoring whitespace
+Value builtin_base64_decode(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__base64_decode() expects 1 argument (string or buffer)");
+        return val_null();
+    }
+    const unsigned char *data;
+    size_t len;
+    if (!codec_input(args[0], &data, &len, "__base64_decode", ctx)) return val_null();
+    char *clean = strip_whitespace(data, &len);
+    const char *src = clean ? clean : (const char *)data;
+    if (len % 4 != 0) {
+        free(clean);
+        runtime_error(ctx, "Invalid Base64 string: length must be multiple of 4");
+        return val_null();
+    }
+    char *out = codec_alloc(len / 4 * 3, "__base64_decode", ctx);
+    if (!out) {
+        free(clean);
+        return val_null();
+    }
+    long n = str_base64_decode((unsigned char *)out, src, len);
+    free(clean);
+    if (n < 0) {
+        free(out);
+        runtime_error(ctx, n == STR_CODEC_BAD_PADDING ? "Invalid Base64 string: unexpected padding"
+                                                      : "Invalid Base64 string: invalid character");
+        return val_null();
+    }
+    return codec_result(out, (size_t)n);
+}
+
+// __hex_encode(input) - two lowercase hex digits per byte
+Value builtin_hex_encode(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__hex_encode() expects 1 argument (string or buffer)");
+        return val_null();
+    }
+    const unsigned char *data;
+    size_t len;
+    if (!codec_input(args[0], &data, &len, "__hex_encode", ctx)) return val_null();
+    char *out = codec_alloc(len * 2, "__hex_encode", ctx);
+    if (!out) return val_null();
+    str_hex_encode(out, data, len);
+    return codec_result(out, len * 2);
+}
+
+// __hex_decode(input) - decode hex digits of either case, ignoring whitespace
+Value builtin_hex_decode(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__hex_decode() expects 1 argument (string or buffer)");
+        return val_null();
+    }
+    const unsigned char *data;
+    size_t len;
+    if (!codec_input(args[0], &data, &len, "__hex_decode", ctx)) return val_null();
+    char *clean = strip_whitespace(data, &len);
+    const char *src = clean ? clean : (const char *)data;
+    if (len % 2 != 0) {
+        free(clean);
+        runtime_error(ctx, "Invalid hex string: length must be even");
+        return val_null();
+    }
+    char *out = codec_alloc(len / 2, "__hex_decode", ctx);
+    if (!out) {
+        free(clean);
+        return val_null();
+    }
+    long n = str_hex_decode((unsigned char *)out, src, len);
+    free(clean);
+    if (n < 0) {
+        free(out);
+        runtime_error(ctx, "Invalid hex string: invalid character");
+        return val_null();
+    }
+    return codec_result(out, (size_t)n);
+}
+
+// __percent_encode(input, escape, space_plus, upper) - percent-encode the
+// characters of the escape string, or with a null escape everything but the
+// RFC 3986 unreserved characters. space_plus writes a space that would be
+// escaped as '+'; upper picks the case of the hex digits.
+Value builtin_percent_encode(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 4 || (args[1].type != VAL_STRING && args[1].type != VAL_NULL)) {
+        runtime_error(ctx, "__percent_encode() expects 4 arguments (input, escape string or null, space_plus, upper)");
+        return val_null();
+    }
+    const unsigned char *data;
+    size_t len;
+    if (!codec_input(args[0], &data, &len, "__percent_encode", ctx)) return val_null();
+
+    unsigned char classes[256];
+    if (args[1].type == VAL_NULL) {
+        memset(classes, STR_PERCENT_ESCAPE, sizeof(classes));
+        for (int c = 'A'; c <= 'Z'; c++) classes[c] = STR_PERCENT_KEEP;
+        for (int c = 'a'; c <= 'z'; c++) classes[c] = STR_PERCENT_KEEP;
+        for (int c = '0'; c <= '9'; c++) classes[c] = STR_PERCENT_KEEP;
+        classes['-'] = classes['_'] = classes['.'] = classes['~'] = STR_PERCENT_KEEP;
+    } else {
+        memset(classes, STR_PERCENT_KEEP, sizeof(classes));
+        String *escape = args[1].as.as_string;
+        for (int i = 0; i < escape->length; i++) {
+            classes[(unsigned char)escape->data[i]] = STR_PERCENT_ESCAPE;
+        }
+    }
+    if (value_is_truthy(args[2]) && classes[' '] == STR_PERCENT_ESCAPE) {
+        classes[' '] = STR_PERCENT_PLUS;
+    }
+
+    size_t out_len = str_percent_encoded_length(data, len, classes);
+    char *out = codec_alloc(out_len, "__percent_encode", ctx);
+    if (!out) return val_null();
+    str_percent_encode(out, data, len, classes, value_is_truthy(args[3]));
+    return codec_result(out, out_len);
+}
+
+// __percent_decode(input, plus_space) - decode %XX escapes, and '+' as a
+// space when plus_space is true
+Value builtin_percent_decode(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "__percent_decode() expects 2 arguments (input, plus_space)");
+        return val_null();
+    }
+    const unsigned char *data;
+    size_t len;
+    if (!codec_input(args[0], &data, &len, "__percent_decode", ctx)) return val_null();
+    char *out = codec_alloc(len, "__percent_decode", ctx);
+    if (!out) return val_null();
+    long n = str_percent_decode((unsigned char *)out, (const char *)data, len, value_is_truthy(args[1]));
+    if (n < 0) {
+        free(out);
+        runtime_error(ctx, n == STR_CODEC_TRUNCATED
+                               ? "Invalid URL encoding: incomplete percent sequence"
+                               : "Invalid URL encoding: invalid hex digits in percent sequence");
+        return val_null();
+    }
+    return codec_result(out, (size_t)n);
+}
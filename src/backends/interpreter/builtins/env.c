@@ -144,7 +144,7 @@ Value builtin_exec(Value *args, int num_args, ExecutionContext *ctx) {
         exit(1);
     }
 
-    // If second argument is provided, use fork/execvp (safe, no shell)
+    // If second argument is provided, spawn the program directly (safe, no shell)
     if (num_args == 2) {
         if (args[1].type != VAL_ARRAY) {
             fprintf(stderr, "Runtime error: exec() second argument must be an array of strings\n");
@@ -192,208 +192,7 @@ Value builtin_exec(Value *args, int num_args, ExecutionContext *ctx) {
         }
         argv[arr->length + 1] = NULL;
 
-        // Create pipes for stdout and stderr
-        int stdout_pipe[2];
-        int stderr_pipe[2];
-        if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0) {
-            char error_msg[256];
-            snprintf(error_msg, sizeof(error_msg), "exec() pipe creation failed: %s", strerror(errno));
-            for (int i = 0; i <= arr->length; i++) free(argv[i]);
-            free(argv);
-            ctx->exception_state.exception_value = val_string(error_msg);
-            ctx->exception_state.is_throwing = 1;
-            return val_null();
-        }
-
-        pid_t pid = fork();
-        if (pid < 0) {
-            char error_msg[256];
-            snprintf(error_msg, sizeof(error_msg), "exec() fork failed: %s", strerror(errno));
-            for (int i = 0; i <= arr->length; i++) free(argv[i]);
-            free(argv);
-            close(stdout_pipe[0]); close(stdout_pipe[1]);
-            close(stderr_pipe[0]); close(stderr_pipe[1]);
-            ctx->exception_state.exception_value = val_string(error_msg);
-            ctx->exception_state.is_throwing = 1;
-            return val_null();
-        }
-
-        if (pid == 0) {
-            // Child process
-            close(stdout_pipe[0]);  // Close read end
-            close(stderr_pipe[0]);
-            dup2(stdout_pipe[1], STDOUT_FILENO);
-            dup2(stderr_pipe[1], STDERR_FILENO);
-            close(stdout_pipe[1]);
-            close(stderr_pipe[1]);
-
-            execvp(argv[0], argv);
-            // If execvp returns, it failed
-            fprintf(stderr, "exec() failed to execute '%s': %s\n", argv[0], strerror(errno));
-            _exit(127);
-        }
-
-        // Parent process
-        close(stdout_pipe[1]);  // Close write end
-        close(stderr_pipe[1]);
-
-        // Free argv in parent (child has its own copy after fork)
-        for (int i = 0; i <= arr->length; i++) free(argv[i]);
-        free(argv);
-
-        // Read output from child (both stdout and stderr using poll to avoid deadlock)
-        char *output_buffer = NULL;
-        size_t output_size = 0;
-        size_t output_capacity = 4096;
-        output_buffer = malloc(output_capacity);
-
-        char *stderr_buffer = NULL;
-        size_t stderr_size = 0;
-        size_t stderr_capacity = 4096;
-        stderr_buffer = malloc(stderr_capacity);
-
-        if (!output_buffer || !stderr_buffer) {
-            fprintf(stderr, "Runtime error: exec() memory allocation failed\n");
-            free(output_buffer);
-            free(stderr_buffer);
-            close(stdout_pipe[0]);
-            close(stderr_pipe[0]);
-            exit(1);
-        }
-
-        struct pollfd fds[2];
-        fds[0].fd = stdout_pipe[0];
-        fds[0].events = POLLIN;
-        fds[1].fd = stderr_pipe[0];
-        fds[1].events = POLLIN;
-
-        int open_fds = 2;
-        char chunk[4096];
-
-        while (open_fds > 0) {
-            int ret = poll(fds, 2, -1);
-            if (ret < 0) {
-                if (errno == EINTR) continue;
-                break;
-            }
-
-            // Read from stdout if available
-            if (fds[0].revents & (POLLIN | POLLHUP)) {
-                ssize_t bytes_read = read(stdout_pipe[0], chunk, sizeof(chunk));
-                if (bytes_read > 0) {
-                    while (output_size + (size_t)bytes_read > output_capacity) {
-                        if (output_capacity > SIZE_MAX / 2) {
-                            fprintf(stderr, "Runtime error: exec() output too large\n");
-                            free(output_buffer);
-                            free(stderr_buffer);
-                            close(stdout_pipe[0]);
-                            close(stderr_pipe[0]);
-                            exit(1);
-                        }
-                        output_capacity *= 2;
-                        char *new_buffer = realloc(output_buffer, output_capacity);
-                        if (!new_buffer) {
-                            fprintf(stderr, "Runtime error: exec() memory allocation failed\n");
-                            free(output_buffer);
-                            free(stderr_buffer);
-                            close(stdout_pipe[0]);
-                            close(stderr_pipe[0]);
-                            exit(1);
-                        }
-                        output_buffer = new_buffer;
-                    }
-                    memcpy(output_buffer + output_size, chunk, (size_t)bytes_read);
-                    output_size += (size_t)bytes_read;
-                } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                    fds[0].fd = -1;  // Stop polling this fd
-                    open_fds--;
-                }
-            }
-
-            // Read from stderr if available
-            if (fds[1].revents & (POLLIN | POLLHUP)) {
-                ssize_t bytes_read = read(stderr_pipe[0], chunk, sizeof(chunk));
-                if (bytes_read > 0) {
-                    while (stderr_size + (size_t)bytes_read > stderr_capacity) {
-                        if (stderr_capacity > SIZE_MAX / 2) {
-                            fprintf(stderr, "Runtime error: exec() stderr too large\n");
-                            free(output_buffer);
-                            free(stderr_buffer);
-                            close(stdout_pipe[0]);
-                            close(stderr_pipe[0]);
-                            exit(1);
-                        }
-                        stderr_capacity *= 2;
-                        char *new_buffer = realloc(stderr_buffer, stderr_capacity);
-                        if (!new_buffer) {
-                            fprintf(stderr, "Runtime error: exec() memory allocation failed\n");
-                            free(output_buffer);
-                            free(stderr_buffer);
-                            close(stdout_pipe[0]);
-                            close(stderr_pipe[0]);
-                            exit(1);
-                        }
-                        stderr_buffer = new_buffer;
-                    }
-                    memcpy(stderr_buffer + stderr_size, chunk, (size_t)bytes_read);
-                    stderr_size += (size_t)bytes_read;
-                } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                    fds[1].fd = -1;  // Stop polling this fd
-                    open_fds--;
-                }
-            }
-        }
-        close(stdout_pipe[0]);
-        close(stderr_pipe[0]);
-
-        // Wait for child
-        int status;
-        waitpid(pid, &status, 0);
-        int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
-
-        // Ensure null termination for stdout
-        if (output_size >= output_capacity) {
-            char *new_buffer = realloc(output_buffer, output_size + 1);
-            if (!new_buffer) {
-                fprintf(stderr, "Runtime error: exec() memory allocation failed\n");
-                free(output_buffer);
-                free(stderr_buffer);
-                exit(1);
-            }
-            output_buffer = new_buffer;
-            output_capacity = output_size + 1;
-        }
-        output_buffer[output_size] = '\0';
-
-        // Ensure null termination for stderr
-        if (stderr_size >= stderr_capacity) {
-            char *new_buffer = realloc(stderr_buffer, stderr_size + 1);
-            if (!new_buffer) {
-                fprintf(stderr, "Runtime error: exec() memory allocation failed\n");
-                free(output_buffer);
-                free(stderr_buffer);
-                exit(1);
-            }
-            stderr_buffer = new_buffer;
-            stderr_capacity = stderr_size + 1;
-        }
-        stderr_buffer[stderr_size] = '\0';
-
-        // Create result object
-        Object *result = object_new(NULL, 3);
-        result->field_names[0] = strdup("output");
-        result->field_values[0] = val_string_take(output_buffer, output_size, output_capacity);
-        result->num_fields++;
-
-        result->field_names[1] = strdup("stderr");
-        result->field_values[1] = val_string_take(stderr_buffer, stderr_size, stderr_capacity);
-        result->num_fields++;
-
-        result->field_names[2] = strdup("exit_code");
-        result->field_values[2] = val_i32(exit_code);
-        result->num_fields++;
-
-        return val_object(result);
+        return exec_capture(argv, "exec", ctx);
     }
 
     // Single argument: use popen (shell mode)
@@ -422,13 +221,14 @@ done_warning:
     ccmd[command->length] = '\0';
 
     // Open pipe to read command output (uses shell - vulnerable to injection)
+    fflush(stdout);  // Keep buffered output ahead of anything the shell prints
     FILE *pipe = popen(ccmd, "r");
     if (!pipe) {
         char error_msg[512];
         snprintf(error_msg, sizeof(error_msg), "Failed to execute command '%s': %s", ccmd, strerror(errno));
         free(ccmd);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -510,7 +310,7 @@ done_warning:
 
 // exec_argv() - Safe command execution without shell interpretation
 // Takes an array of strings: [program, arg1, arg2, ...]
-// Uses fork/execvp directly, preventing shell injection attacks
+// Spawns the program directly, preventing shell injection attacks
 Value builtin_exec_argv(Value *args, int num_args, ExecutionContext *ctx) {
     // SANDBOX: Check if process spawning is allowed
     if (sandbox_is_restricted(ctx, HML_SANDBOX_RESTRICT_PROCESS)) {
@@ -561,208 +361,7 @@ Value builtin_exec_argv(Value *args, int num_args, ExecutionContext *ctx) {
     }
     argv[arr->length] = NULL;
 
-    // Create pipes for stdout and stderr
-    int stdout_pipe[2];
-    int stderr_pipe[2];
-    if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0) {
-        char error_msg[256];
-        snprintf(error_msg, sizeof(error_msg), "exec_argv() pipe creation failed: %s", strerror(errno));
-        for (int i = 0; i < arr->length; i++) free(argv[i]);
-        free(argv);
-        ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
-        return val_null();
-    }
-
-    pid_t pid = fork();
-    if (pid < 0) {
-        char error_msg[256];
-        snprintf(error_msg, sizeof(error_msg), "exec_argv() fork failed: %s", strerror(errno));
-        for (int i = 0; i < arr->length; i++) free(argv[i]);
-        free(argv);
-        close(stdout_pipe[0]); close(stdout_pipe[1]);
-        close(stderr_pipe[0]); close(stderr_pipe[1]);
-        ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
-        return val_null();
-    }
-
-    if (pid == 0) {
-        // Child process
-        close(stdout_pipe[0]);  // Close read end
-        close(stderr_pipe[0]);
-        dup2(stdout_pipe[1], STDOUT_FILENO);
-        dup2(stderr_pipe[1], STDERR_FILENO);
-        close(stdout_pipe[1]);
-        close(stderr_pipe[1]);
-
-        execvp(argv[0], argv);
-        // If execvp returns, it failed
-        fprintf(stderr, "exec_argv() failed to execute '%s': %s\n", argv[0], strerror(errno));
-        _exit(127);
-    }
-
-    // Parent process
-    close(stdout_pipe[1]);  // Close write end
-    close(stderr_pipe[1]);
-
-    // Free argv in parent (child has its own copy after fork)
-    for (int i = 0; i < arr->length; i++) free(argv[i]);
-    free(argv);
-
-    // Read output from child (both stdout and stderr using poll to avoid deadlock)
-    char *output_buffer = NULL;
-    size_t output_size = 0;
-    size_t output_capacity = 4096;
-    output_buffer = malloc(output_capacity);
-
-    char *stderr_buffer = NULL;
-    size_t stderr_size = 0;
-    size_t stderr_capacity = 4096;
-    stderr_buffer = malloc(stderr_capacity);
-
-    if (!output_buffer || !stderr_buffer) {
-        fprintf(stderr, "Runtime error: exec_argv() memory allocation failed\n");
-        free(output_buffer);
-        free(stderr_buffer);
-        close(stdout_pipe[0]);
-        close(stderr_pipe[0]);
-        exit(1);
-    }
-
-    struct pollfd fds[2];
-    fds[0].fd = stdout_pipe[0];
-    fds[0].events = POLLIN;
-    fds[1].fd = stderr_pipe[0];
-    fds[1].events = POLLIN;
-
-    int open_fds = 2;
-    char chunk[4096];
-
-    while (open_fds > 0) {
-        int ret = poll(fds, 2, -1);
-        if (ret < 0) {
-            if (errno == EINTR) continue;
-            break;
-        }
-
-        // Read from stdout if available
-        if (fds[0].revents & (POLLIN | POLLHUP)) {
-            ssize_t bytes_read = read(stdout_pipe[0], chunk, sizeof(chunk));
-            if (bytes_read > 0) {
-                while (output_size + (size_t)bytes_read > output_capacity) {
-                    if (output_capacity > SIZE_MAX / 2) {
-                        fprintf(stderr, "Runtime error: exec_argv() output too large\n");
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        exit(1);
-                    }
-                    output_capacity *= 2;
-                    char *new_buffer = realloc(output_buffer, output_capacity);
-                    if (!new_buffer) {
-                        fprintf(stderr, "Runtime error: exec_argv() memory allocation failed\n");
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        exit(1);
-                    }
-                    output_buffer = new_buffer;
-                }
-                memcpy(output_buffer + output_size, chunk, (size_t)bytes_read);
-                output_size += (size_t)bytes_read;
-            } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                fds[0].fd = -1;  // Stop polling this fd
-                open_fds--;
-            }
-        }
-
-        // Read from stderr if available
-        if (fds[1].revents & (POLLIN | POLLHUP)) {
-            ssize_t bytes_read = read(stderr_pipe[0], chunk, sizeof(chunk));
-            if (bytes_read > 0) {
-                while (stderr_size + (size_t)bytes_read > stderr_capacity) {
-                    if (stderr_capacity > SIZE_MAX / 2) {
-                        fprintf(stderr, "Runtime error: exec_argv() stderr too large\n");
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        exit(1);
-                    }
-                    stderr_capacity *= 2;
-                    char *new_buffer = realloc(stderr_buffer, stderr_capacity);
-                    if (!new_buffer) {
-                        fprintf(stderr, "Runtime error: exec_argv() memory allocation failed\n");
-                        free(output_buffer);
-                        free(stderr_buffer);
-                        close(stdout_pipe[0]);
-                        close(stderr_pipe[0]);
-                        exit(1);
-                    }
-                    stderr_buffer = new_buffer;
-                }
-                memcpy(stderr_buffer + stderr_size, chunk, (size_t)bytes_read);
-                stderr_size += (size_t)bytes_read;
-            } else if (bytes_read == 0 || (bytes_read < 0 && errno != EINTR)) {
-                fds[1].fd = -1;  // Stop polling this fd
-                open_fds--;
-            }
-        }
-    }
-    close(stdout_pipe[0]);
-    close(stderr_pipe[0]);
-
-    // Wait for child
-    int status;
-    waitpid(pid, &status, 0);
-    int exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
-
-    // Ensure null termination for stdout
-    if (output_size >= output_capacity) {
-        char *new_buffer = realloc(output_buffer, output_size + 1);
-        if (!new_buffer) {
-            fprintf(stderr, "Runtime error: exec_argv() memory allocation failed\n");
-            free(output_buffer);
-            free(stderr_buffer);
-            exit(1);
-        }
-        output_buffer = new_buffer;
-        output_capacity = output_size + 1;
-    }
-    output_buffer[output_size] = '\0';
-
-    // Ensure null termination for stderr
-    if (stderr_size >= stderr_capacity) {
-        char *new_buffer = realloc(stderr_buffer, stderr_size + 1);
-        if (!new_buffer) {
-            fprintf(stderr, "Runtime error: exec_argv() memory allocation failed\n");
-            free(output_buffer);
-            free(stderr_buffer);
-            exit(1);
-        }
-        stderr_buffer = new_buffer;
-        stderr_capacity = stderr_size + 1;
-    }
-    stderr_buffer[stderr_size] = '\0';
-
-    // Create result object
-    Object *result = object_new(NULL, 3);
-    result->field_names[0] = strdup("output");
-    result->field_values[0] = val_string_take(output_buffer, output_size, output_capacity);
-    result->num_fields++;
-
-    result->field_names[1] = strdup("stderr");
-    result->field_values[1] = val_string_take(stderr_buffer, stderr_size, stderr_capacity);
-    result->num_fields++;
-
-    result->field_names[2] = strdup("exit_code");
-    result->field_values[2] = val_i32(exit_code);
-    result->num_fields++;
-
-    return val_object(result);
+    return exec_capture(argv, "exec_argv", ctx);
 }
 
 Value builtin_getppid(Value *args, int num_args, ExecutionContext *ctx) {
@@ -832,7 +431,7 @@ Value builtin_kill(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "kill(%d, %d) failed: %s", pid, sig, strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -853,12 +452,14 @@ Value builtin_fork(Value *args, int num_args, ExecutionContext *ctx) {
         exit(1);
     }
 
+    // Buffered output would otherwise be written by both processes
+    fflush(NULL);
     pid_t pid = fork();
     if (pid < 0) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "fork() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -878,7 +479,7 @@ Value builtin_wait(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "wait() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -918,7 +519,7 @@ Value builtin_waitpid(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "waitpid(%d, %d) failed: %s", pid, options, strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
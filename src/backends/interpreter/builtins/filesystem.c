@@ -65,7 +65,7 @@ Value builtin_read_file(Value *args, int num_args, ExecutionContext *ctx) {
         }
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -76,7 +76,7 @@ Value builtin_read_file(Value *args, int num_args, ExecutionContext *ctx) {
         close(fd);
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -150,7 +150,7 @@ Value builtin_write_file(Value *args, int num_args, ExecutionContext *ctx) {
         }
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -162,7 +162,7 @@ Value builtin_write_file(Value *args, int num_args, ExecutionContext *ctx) {
         close(fd);
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -220,7 +220,7 @@ Value builtin_append_file(Value *args, int num_args, ExecutionContext *ctx) {
         }
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -231,7 +231,7 @@ Value builtin_append_file(Value *args, int num_args, ExecutionContext *ctx) {
         close(fd);
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -266,7 +266,7 @@ Value builtin_remove_file(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to remove file '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -305,7 +305,7 @@ Value builtin_rename(Value *args, int num_args, ExecutionContext *ctx) {
         free(old_cpath);
         free(new_cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -351,19 +351,7 @@ Value builtin_copy_file(Value *args, int num_args, ExecutionContext *ctx) {
         free(src_cpath);
         free(dest_cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
-        return val_null();
-    }
-
-    FILE *src_fp = fdopen(src_fd, "rb");
-    if (!src_fp) {
-        char error_msg[512];
-        snprintf(error_msg, sizeof(error_msg), "Failed to open source file '%s': %s", src_cpath, strerror(errno));
-        close(src_fd);
-        free(src_cpath);
-        free(dest_cpath);
-        ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -376,46 +364,37 @@ Value builtin_copy_file(Value *args, int num_args, ExecutionContext *ctx) {
         } else {
             snprintf(error_msg, sizeof(error_msg), "Failed to open destination file '%s': %s", dest_cpath, strerror(errno));
         }
-        fclose(src_fp);
+        close(src_fd);
         free(src_cpath);
         free(dest_cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
-    FILE *dest_fp = fdopen(dest_fd, "wb");
-    if (!dest_fp) {
+    // Copy in the kernel where possible (see file_transfer.c)
+    if (fd_copy(src_fd, dest_fd) < 0) {
         char error_msg[512];
-        snprintf(error_msg, sizeof(error_msg), "Failed to open destination file '%s': %s", dest_cpath, strerror(errno));
-        fclose(src_fp);
+        snprintf(error_msg, sizeof(error_msg), "Failed to copy '%s' to '%s': %s", src_cpath, dest_cpath, strerror(errno));
+        close(src_fd);
         close(dest_fd);
         free(src_cpath);
         free(dest_cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
-    // Copy in chunks
-    char buffer[8192];
-    size_t n;
-    while ((n = fread(buffer, 1, sizeof(buffer), src_fp)) > 0) {
-        if (fwrite(buffer, 1, n, dest_fp) != n) {
-            char error_msg[512];
-            snprintf(error_msg, sizeof(error_msg), "Failed to write to '%s': %s", dest_cpath, strerror(errno));
-            fclose(src_fp);
-            fclose(dest_fp);
-            free(src_cpath);
-            free(dest_cpath);
-            ctx->exception_state.exception_value = val_string(error_msg);
-            ctx->exception_state.is_throwing = 1;
-            return val_null();
-        }
+    close(src_fd);
+    if (close(dest_fd) != 0) {
+        char error_msg[512];
+        snprintf(error_msg, sizeof(error_msg), "Failed to write to '%s': %s", dest_cpath, strerror(errno));
+        free(src_cpath);
+        free(dest_cpath);
+        ctx->exception_state.exception_value = val_string(error_msg);
+        ctx->flow.is_throwing = 1;
+        return val_null();
     }
-
-    fclose(src_fp);
-    fclose(dest_fp);
     free(src_cpath);
     free(dest_cpath);
     return val_null();
@@ -509,7 +488,7 @@ Value builtin_file_stat(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(error_msg, sizeof(error_msg), "Failed to stat '%s': %s", cpath, strerror(errno));
         free(cpath);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -59,6 +59,11 @@ Value builtin_assert(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_panic(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_set_stack_limit(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_get_stack_limit(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_heap_stats(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_heap_snapshot(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_gc_collect(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_gc_stats(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_alloc_stats(Value *args, int num_args, ExecutionContext *ctx);
 
 // Math builtins (math.c)
 Value builtin_sin(Value *args, int num_args, ExecutionContext *ctx);
@@ -121,6 +126,12 @@ Value builtin_wait(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_waitpid(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_abort(Value *args, int num_args, ExecutionContext *ctx);
 
+// Subprocess builtins (process.c)
+Value exec_capture(char **argv, const char *fn_name, ExecutionContext *ctx);
+Value builtin_spawn_process(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_process_wait(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_run_many(Value *args, int num_args, ExecutionContext *ctx);
+
 // Signal handling builtins (signals.c)
 Value builtin_signal(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_raise(Value *args, int num_args, ExecutionContext *ctx);
@@ -145,6 +156,13 @@ Value builtin_is_file(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_is_dir(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_file_stat(Value *args, int num_args, ExecutionContext *ctx);
 
+// Kernel-assisted copies (file_transfer.c). Return the number of bytes moved,
+// or -1 with errno set.
+int64_t fd_copy(int src_fd, int dest_fd);
+// At most count bytes from src_fd's current offset; fewer if it ends first
+int64_t fd_copy_n(int src_fd, int dest_fd, int64_t count);
+int64_t fd_send_file(int sock_fd, int file_fd, int64_t offset, int64_t count, int nonblocking);
+
 // Directory builtins (directories.c)
 Value builtin_make_dir(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_remove_dir(Value *args, int num_args, ExecutionContext *ctx);
@@ -153,6 +171,24 @@ Value builtin_cwd(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_chdir(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_absolute_path(Value *args, int num_args, ExecutionContext *ctx);
 
+// Tar archive builtins (tar.c)
+Value builtin_tar_writer_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_writer_add(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_writer_add_path(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_writer_close(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_reader_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_reader_next(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_reader_read(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_reader_extract(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_reader_extract_into(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_tar_reader_close(Value *args, int num_args, ExecutionContext *ctx);
+
+// Directory walking builtins (walk.c)
+Value builtin_walk_dir(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_walk_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_walk_next(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_walk_close(Value *args, int num_args, ExecutionContext *ctx);
+
 // I/O helper builtins (io_helpers.c)
 Value builtin_print(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_string_concat_many(Value *args, int num_args, ExecutionContext *ctx);
@@ -166,6 +202,30 @@ Value builtin_dirent_name(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_string_to_cstr(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_cstr_to_string(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_string_from_bytes(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_utf8_valid(Value *args, int num_args, ExecutionContext *ctx);
+
+// Encoding builtins (encoding.c)
+Value builtin_base64_encode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_base64_decode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hex_encode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_hex_decode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_percent_encode(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_percent_decode(Value *args, int num_args, ExecutionContext *ctx);
+
+// String builder builtins (string_builder.c)
+Value builtin_sb_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_sb_append(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_sb_append_byte(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_sb_to_string(Value *args, int num_args, ExecutionContext *ctx);
+
+// Buffered writer builtins (buffered_writer.c)
+Value builtin_bw_new(Value *args, int num_args, ExecutionContext *ctx);
+WriterHandle *writer_new(FileHandle *file, int fd, int capacity);
+Value val_writer(WriterHandle *writer);
+void writer_free(WriterHandle *writer);
+void writer_retain(WriterHandle *writer);
+void writer_release(WriterHandle *writer);
+Value call_writer_method(WriterHandle *writer, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 
 // Networking builtins (net.c)
 Value builtin_socket_create(Value *args, int num_args, ExecutionContext *ctx);
@@ -187,6 +247,13 @@ Value builtin_lws_response_body_binary(Value *args, int num_args, ExecutionConte
 Value builtin_lws_response_headers(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_lws_response_redirect(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_lws_response_free(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_client_new(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_client_submit(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_client_wait(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_client_close(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_stream_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_stream_read(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_lws_http_stream_close(Value *args, int num_args, ExecutionContext *ctx);
 // WebSocket builtins
 Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_lws_ws_send_text(Value *args, int num_args, ExecutionContext *ctx);
@@ -196,6 +196,24 @@ Value builtin_string_from_bytes(Value *args, int num_args, ExecutionContext *ctx
     return val_string_take(data, length, length + 1);
 }
 
+// __utf8_valid(value) - true if a string's or buffer's bytes are valid UTF-8
+Value builtin_utf8_valid(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__utf8_valid() expects 1 argument (string or buffer)");
+        return val_null();
+    }
+    if (args[0].type == VAL_STRING) {
+        String *str = args[0].as.as_string;
+        return val_bool(utf8_validate(str->data, str->length));
+    }
+    if (args[0].type == VAL_BUFFER) {
+        Buffer *buf = args[0].as.as_buffer;
+        return val_bool(!buf->data || utf8_validate(buf->data, buf->length));
+    }
+    runtime_error(ctx, "__utf8_valid() requires a string or buffer");
+    return val_null();
+}
+
 // apply(fn, args_array) - Call a function with an array of arguments
 // This allows calling functions with dynamic argument counts
 Value builtin_apply(Value *args, int num_args, ExecutionContext *ctx) {
@@ -287,7 +305,7 @@ Value builtin_apply(Value *args, int num_args, ExecutionContext *ctx) {
             // Type check if parameter has type annotation
             if (fn->param_types[i]) {
                 arg_value = convert_to_type(arg_value, fn->param_types[i], call_env, ctx);
-                if (ctx->exception_state.is_throwing) {
+                if (ctx->flow.is_throwing) {
                     env_release(call_env);
                     if (call_args) free(call_args);
                     return val_null();
@@ -311,12 +329,12 @@ Value builtin_apply(Value *args, int num_args, ExecutionContext *ctx) {
         }
 
         // Execute function body
-        ctx->return_state.is_returning = 0;
+        ctx->flow.is_returning = 0;
         eval_stmt(fn->body, call_env, ctx);
 
         // Get return value
-        result = ctx->return_state.is_returning ? ctx->return_state.return_value : val_null();
-        ctx->return_state.is_returning = 0;
+        result = ctx->flow.is_returning ? ctx->return_state.return_value : val_null();
+        ctx->flow.is_returning = 0;
 
         // Clean up
         env_release(call_env);
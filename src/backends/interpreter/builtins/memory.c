@@ -1,5 +1,6 @@
 #include "internal.h"
 #include <stdatomic.h>
+#include <sys/mman.h>
 
 // Helper: Get the size of a type
 int get_type_size(TypeKind kind) {
@@ -94,8 +95,15 @@ Value builtin_free(Value *args, int num_args, ExecutionContext *ctx) {
             exit(1);
         }
 
+        HEAP_TRACK_FREE(buf);
+
         // Free the internal data but keep the struct alive for cleanup to check freed flag
-        free(buf->data);
+        if (buf->mapped) {
+            munmap(buf->data, (size_t)buf->capacity);
+            buf->mapped = 0;
+        } else {
+            free(buf->data);
+        }
         buf->data = NULL;
         buf->length = 0;
         buf->capacity = 0;
@@ -113,6 +121,8 @@ Value builtin_free(Value *args, int num_args, ExecutionContext *ctx) {
             exit(1);
         }
 
+        HEAP_TRACK_FREE(obj);
+
         // Release all field values (decrements their ref_counts)
         for (int i = 0; i < obj->num_fields; i++) {
             value_release(obj->field_values[i]);
@@ -139,6 +149,8 @@ Value builtin_free(Value *args, int num_args, ExecutionContext *ctx) {
             exit(1);
         }
 
+        HEAP_TRACK_FREE(arr);
+
         // Release all elements (decrements their ref_counts)
         for (int i = 0; i < arr->length; i++) {
             value_release(arr->elements[i]);
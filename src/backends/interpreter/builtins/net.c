@@ -1,5 +1,8 @@
+#define _GNU_SOURCE
 #include "internal.h"
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <limits.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -26,7 +29,7 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
     ctx->exception_state.exception_value = val_string(buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -349,6 +352,56 @@ Value socket_method_send(SocketHandle *sock, Value *args, int num_args, Executio
     return val_i32((int32_t)sent);
 }
 
+// socket.send_file(path: string, offset?: i64, length?: i64) -> i64 (bytes sent)
+// Sends length bytes of the file starting at offset (default: the rest of the
+// file) with sendfile, so the data never passes through user space.
+Value socket_method_send_file(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args < 1 || num_args > 3 || args[0].type != VAL_STRING) {
+        return throw_runtime_error(ctx, "send_file() expects (path, [offset], [length])");
+    }
+    if ((num_args >= 2 && !is_integer(args[1])) || (num_args == 3 && !is_integer(args[2]))) {
+        return throw_runtime_error(ctx, "send_file() offset and length must be integers");
+    }
+
+    if (sock->closed) {
+        return throw_runtime_error(ctx, "Cannot send on closed socket");
+    }
+
+    const char *path = args[0].as.as_string->data;
+    if (!sandbox_path_allowed(ctx, path, 0)) {
+        sandbox_error(ctx, "file read outside sandbox root");
+        return val_null();
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return throw_runtime_error(ctx, "Failed to open '%s': %s", path, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return throw_runtime_error(ctx, "send_file() requires a regular file: '%s'", path);
+    }
+
+    int64_t offset = num_args >= 2 ? value_to_int64(args[1]) : 0;
+    int64_t length = num_args == 3 ? value_to_int64(args[2]) : -1;
+    if (offset < 0 || offset > (int64_t)st.st_size) {
+        close(fd);
+        return throw_runtime_error(ctx, "send_file() offset %lld is outside '%s'", (long long)offset, path);
+    }
+    if (length < 0 || length > (int64_t)st.st_size - offset) {
+        length = (int64_t)st.st_size - offset;
+    }
+
+    int64_t sent = fd_send_file(sock->fd, fd, offset, length, sock->nonblocking);
+    int err = errno;
+    close(fd);
+    if (sent < 0) {
+        return throw_runtime_error(ctx, "Failed to send file '%s': %s", path, strerror(err));
+    }
+    return val_i64(sent);
+}
+
 // socket.recv(size: i32) -> buffer | null (null if non-blocking and no data)
 Value socket_method_recv(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
@@ -366,12 +419,14 @@ Value socket_method_recv(SocketHandle *sock, Value *args, int num_args, Executio
     int size = value_to_int(args[0]);
     if (size <= 0) {
         // Return empty buffer
-        Buffer *buf = malloc(sizeof(Buffer));
+        Buffer *buf = slab_alloc(sizeof(Buffer));
         buf->data = malloc(1);
         buf->length = 0;
         buf->capacity = 0;
         buf->ref_count = 1;  // Start with 1 - caller owns the first reference
         atomic_store(&buf->freed, 0);  // Not freed
+        buf->mapped = 0;
+        HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
         return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
     }
 
@@ -395,22 +450,26 @@ Value socket_method_recv(SocketHandle *sock, Value *args, int num_args, Executio
     if (received == 0) {
         free(data);
         // Return empty buffer to indicate EOF
-        Buffer *buf = malloc(sizeof(Buffer));
+        Buffer *buf = slab_alloc(sizeof(Buffer));
         buf->data = malloc(1);
         buf->length = 0;
         buf->capacity = 0;
         buf->ref_count = 1;
         atomic_store(&buf->freed, 0);  // Not freed
+        buf->mapped = 0;
+        HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
         return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
     }
 
-    Buffer *buf = malloc(sizeof(Buffer));
+    Buffer *buf = slab_alloc(sizeof(Buffer));
     buf->data = data;
     buf->length = (int)received;
     buf->capacity = size;
     buf->ref_count = 1;  // Start with 1 - caller owns the first reference
     atomic_store(&buf->freed, 0);  // Not freed
+    buf->mapped = 0;
 
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
     return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
 }
 
@@ -522,12 +581,14 @@ Value socket_method_recvfrom(SocketHandle *sock, Value *args, int num_args, Exec
     }
 
     // Create buffer with received data
-    Buffer *buf = malloc(sizeof(Buffer));
+    Buffer *buf = slab_alloc(sizeof(Buffer));
     buf->data = data;
     buf->length = (int)received;
     buf->capacity = size;
     buf->ref_count = 1;  // Start with 1 - caller owns the first reference
     atomic_store(&buf->freed, 0);  // Not freed
+    buf->mapped = 0;
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
 
     // Get source address and port based on address family
     char addr_str[INET6_ADDRSTRLEN];
@@ -566,6 +627,398 @@ Value socket_method_recvfrom(SocketHandle *sock, Value *args, int num_args, Exec
     return val_object(result);
 }
 
+// ========== BATCHED AND VECTORED I/O ==========
+
+// Most datagrams recv_many() returns from one call
+#define SOCKET_BATCH_MAX 1024
+
+// Fill dest with address:port for the socket's family; 0 if the address is invalid
+static int socket_dest_addr(SocketHandle *sock, const char *address, int port,
+                            struct sockaddr_storage *dest, socklen_t *dest_len) {
+    memset(dest, 0, sizeof(*dest));
+    if (sock->domain == AF_INET6) {
+        struct sockaddr_in6 *a6 = (struct sockaddr_in6 *)dest;
+        a6->sin6_family = AF_INET6;
+        a6->sin6_port = htons(port);
+        *dest_len = sizeof(*a6);
+        return inet_pton(AF_INET6, address, &a6->sin6_addr) == 1;
+    }
+    struct sockaddr_in *a4 = (struct sockaddr_in *)dest;
+    a4->sin_family = AF_INET;
+    a4->sin_port = htons(port);
+    *dest_len = sizeof(*a4);
+    return inet_pton(AF_INET, address, &a4->sin_addr) == 1;
+}
+
+// Bytes of a string or buffer value; 0 if it is neither
+static int socket_bytes(Value v, const void **data, size_t *len) {
+    if (v.type == VAL_STRING) {
+        *data = v.as.as_string->data;
+        *len = v.as.as_string->length;
+        return 1;
+    }
+    if (v.type == VAL_BUFFER) {
+        *data = v.as.as_buffer->data;
+        *len = v.as.as_buffer->length;
+        return 1;
+    }
+    return 0;
+}
+
+// A buffer holding exactly len bytes copied from data
+static Value socket_buffer_copy(const void *data, int len) {
+    if (len > 0) {
+        Value v = val_buffer(len);
+        memcpy(v.as.as_buffer->data, data, len);
+        return v;
+    }
+    Buffer *buf = slab_alloc(sizeof(Buffer));
+    buf->data = malloc(1);
+    buf->length = 0;
+    buf->capacity = 0;
+    buf->ref_count = 1;
+    atomic_store(&buf->freed, 0);
+    buf->mapped = 0;
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer));
+    return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
+}
+
+// { data, address, port } as recvfrom() returns it
+static Value socket_datagram(const void *data, int len, struct sockaddr_storage *src, socklen_t src_len) {
+    char addr_str[INET6_ADDRSTRLEN] = "";
+    int src_port = 0;
+    if (src_len > 0 && src->ss_family == AF_INET6) {
+        struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)src;
+        inet_ntop(AF_INET6, &addr6->sin6_addr, addr_str, sizeof(addr_str));
+        src_port = ntohs(addr6->sin6_port);
+    } else if (src_len > 0 && src->ss_family == AF_INET) {
+        struct sockaddr_in *addr4 = (struct sockaddr_in *)src;
+        inet_ntop(AF_INET, &addr4->sin_addr, addr_str, sizeof(addr_str));
+        src_port = ntohs(addr4->sin_port);
+    }
+
+    Object *result = object_new(NULL, 3);
+    result->field_names[0] = strdup("data");
+    result->field_values[0] = socket_buffer_copy(data, len);
+    result->field_names[1] = strdup("address");
+    result->field_values[1] = val_string(addr_str);
+    result->field_names[2] = strdup("port");
+    result->field_values[2] = val_i32(src_port);
+    result->num_fields = 3;
+    return val_object(result);
+}
+
+// socket.recv_into(buf: buffer, offset?: i32, length?: i32) -> i32 | null
+// Receives into buf at offset (up to length bytes, default the rest of buf)
+// without allocating. Returns the byte count, 0 at end of stream, or null if
+// the socket is non-blocking and no data is ready.
+Value socket_method_recv_into(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args < 1 || num_args > 3 || args[0].type != VAL_BUFFER ||
+        (num_args >= 2 && !is_integer(args[1])) || (num_args == 3 && !is_integer(args[2]))) {
+        return throw_runtime_error(ctx, "recv_into() expects (buffer, [offset], [length])");
+    }
+    if (sock->closed) {
+        return throw_runtime_error(ctx, "Cannot recv on closed socket");
+    }
+
+    Buffer *buf = args[0].as.as_buffer;
+    int offset = num_args >= 2 ? value_to_int(args[1]) : 0;
+    if (offset < 0 || offset > buf->length) {
+        return throw_runtime_error(ctx, "recv_into() offset %d is outside the buffer (length %d)",
+                                   offset, buf->length);
+    }
+    int length = num_args == 3 ? value_to_int(args[2]) : buf->length - offset;
+    if (length < 0 || length > buf->length - offset) {
+        length = buf->length - offset;
+    }
+
+    ssize_t received;
+    do {
+        received = recv(sock->fd, (char *)buf->data + offset, length, 0);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        if (sock->nonblocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return val_null();
+        }
+        return throw_runtime_error(ctx, "Failed to receive data: %s", strerror(errno));
+    }
+    return val_i32((int32_t)received);
+}
+
+// socket.recv_many(count: i32, size: i32) -> array of { data, address, port }
+// Waits for one datagram, then takes up to count - 1 more that are already
+// queued, with one recvmmsg() call. Each datagram is received into a shared
+// scratch area and copied into a buffer of its exact length. Returns [] if
+// the socket is non-blocking and nothing is queued.
+Value socket_method_recv_many(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[0]) || !is_integer(args[1])) {
+        return throw_runtime_error(ctx, "recv_many() expects 2 integer arguments (count, size)");
+    }
+    if (sock->closed) {
+        return throw_runtime_error(ctx, "Cannot recv on closed socket");
+    }
+    int count = value_to_int(args[0]);
+    int size = value_to_int(args[1]);
+    if (count <= 0 || size <= 0) {
+        return throw_runtime_error(ctx, "recv_many() count and size must be positive");
+    }
+    if (count > SOCKET_BATCH_MAX) count = SOCKET_BATCH_MAX;
+    if ((size_t)count * (size_t)size > (size_t)INT_MAX) {
+        return throw_runtime_error(ctx, "recv_many() count * size is too large");
+    }
+
+    char *scratch = malloc((size_t)count * size);
+    struct sockaddr_storage *addrs = malloc(sizeof(struct sockaddr_storage) * count);
+    if (!scratch || !addrs) {
+        free(scratch);
+        free(addrs);
+        return throw_runtime_error(ctx, "Memory allocation failed");
+    }
+
+    int received = 0;
+    int err = 0;
+    socklen_t addr_lens[SOCKET_BATCH_MAX];
+    int lens[SOCKET_BATCH_MAX];
+#ifdef __linux__
+    struct mmsghdr *msgs = calloc(count, sizeof(struct mmsghdr));
+    struct iovec *iovs = malloc(sizeof(struct iovec) * count);
+    if (!msgs || !iovs) {
+        free(msgs);
+        free(iovs);
+        free(scratch);
+        free(addrs);
+        return throw_runtime_error(ctx, "Memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        iovs[i].iov_base = scratch + (size_t)i * size;
+        iovs[i].iov_len = size;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+    int n;
+    do {
+        n = recvmmsg(sock->fd, msgs, count, MSG_WAITFORONE, NULL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        err = errno;
+    } else {
+        received = n;
+        for (int i = 0; i < n; i++) {
+            lens[i] = (int)msgs[i].msg_len;
+            addr_lens[i] = msgs[i].msg_hdr.msg_namelen;
+        }
+    }
+    free(msgs);
+    free(iovs);
+#else
+    // One blocking recvfrom, then drain what is queued without waiting
+    while (received < count) {
+        addr_lens[received] = sizeof(struct sockaddr_storage);
+        ssize_t got = recvfrom(sock->fd, scratch + (size_t)received * size, size,
+                               received == 0 ? 0 : MSG_DONTWAIT,
+                               (struct sockaddr *)&addrs[received], &addr_lens[received]);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (received == 0) err = errno;
+            break;
+        }
+        lens[received++] = (int)got;
+    }
+#endif
+
+    Value result = val_null();
+    if (err != 0 && !(sock->nonblocking && (err == EAGAIN || err == EWOULDBLOCK))) {
+        throw_runtime_error(ctx, "Failed to receive datagrams: %s", strerror(err));
+    } else {
+        Array *arr = array_new();
+        for (int i = 0; i < received; i++) {
+            Value packet = socket_datagram(scratch + (size_t)i * size, lens[i], &addrs[i], addr_lens[i]);
+            array_push(arr, packet);
+            value_release(packet);
+        }
+        result = val_array(arr);
+    }
+    free(scratch);
+    free(addrs);
+    return result;
+}
+
+// socket.send_many(packets: array) -> i32 (packets sent)
+// Sends every packet with as few sendmmsg() calls as possible. A packet is a
+// string or buffer (connected sockets) or { address, port, data }. A
+// non-blocking socket may send fewer than all of them.
+Value socket_method_send_many(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_ARRAY) {
+        return throw_runtime_error(ctx, "send_many() expects 1 argument (array of packets)");
+    }
+    if (sock->closed) {
+        return throw_runtime_error(ctx, "Cannot send on closed socket");
+    }
+    Array *packets = args[0].as.as_array;
+    int count = packets->length;
+    if (count == 0) return val_i32(0);
+
+    struct iovec *iovs = malloc(sizeof(struct iovec) * count);
+    struct sockaddr_storage *dests = malloc(sizeof(struct sockaddr_storage) * count);
+    socklen_t *dest_lens = malloc(sizeof(socklen_t) * count);
+    if (!iovs || !dests || !dest_lens) {
+        free(iovs);
+        free(dests);
+        free(dest_lens);
+        return throw_runtime_error(ctx, "Memory allocation failed");
+    }
+
+    for (int i = 0; i < count; i++) {
+        Value packet = packets->elements[i];
+        Value data = packet;
+        dest_lens[i] = 0;
+        if (packet.type == VAL_OBJECT) {
+            Object *obj = packet.as.as_object;
+            int addr_idx = object_lookup_field(obj, "address");
+            int port_idx = object_lookup_field(obj, "port");
+            int data_idx = object_lookup_field(obj, "data");
+            if (addr_idx < 0 || port_idx < 0 || data_idx < 0 ||
+                obj->field_values[addr_idx].type != VAL_STRING || !is_integer(obj->field_values[port_idx])) {
+                free(iovs);
+                free(dests);
+                free(dest_lens);
+                return throw_runtime_error(ctx, "send_many() packet %d must have address, port and data", i);
+            }
+            const char *address = obj->field_values[addr_idx].as.as_string->data;
+            if (!socket_dest_addr(sock, address, value_to_int(obj->field_values[port_idx]),
+                                  &dests[i], &dest_lens[i])) {
+                free(iovs);
+                free(dests);
+                free(dest_lens);
+                return throw_runtime_error(ctx, "Invalid address: %s", address);
+            }
+            data = obj->field_values[data_idx];
+        }
+        const void *bytes;
+        size_t len;
+        if (!socket_bytes(data, &bytes, &len)) {
+            free(iovs);
+            free(dests);
+            free(dest_lens);
+            return throw_runtime_error(ctx, "send_many() packet data must be string or buffer");
+        }
+        iovs[i].iov_base = (void *)bytes;
+        iovs[i].iov_len = len;
+    }
+
+    int sent = 0;
+    int err = 0;
+#ifdef __linux__
+    struct mmsghdr *msgs = calloc(count, sizeof(struct mmsghdr));
+    if (!msgs) {
+        free(iovs);
+        free(dests);
+        free(dest_lens);
+        return throw_runtime_error(ctx, "Memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = dest_lens[i] ? &dests[i] : NULL;
+        msgs[i].msg_hdr.msg_namelen = dest_lens[i];
+    }
+    while (sent < count) {
+        int n = sendmmsg(sock->fd, msgs + sent, count - sent, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        sent += n;
+    }
+    free(msgs);
+#else
+    while (sent < count) {
+        ssize_t n = sendto(sock->fd, iovs[sent].iov_base, iovs[sent].iov_len, 0,
+                           dest_lens[sent] ? (struct sockaddr *)&dests[sent] : NULL, dest_lens[sent]);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        sent++;
+    }
+#endif
+    free(iovs);
+    free(dests);
+    free(dest_lens);
+
+    if (err != 0 && !(sock->nonblocking && (err == EAGAIN || err == EWOULDBLOCK))) {
+        return throw_runtime_error(ctx, "Failed to send datagrams: %s", strerror(err));
+    }
+    return val_i32(sent);
+}
+
+// socket.send_parts(parts: array) -> i64 (bytes sent)
+// Sends strings and buffers back to back with one vectored sendmsg() (as
+// writev would), without joining them first. Blocking sockets send
+// everything; a non-blocking socket stops when its send buffer is full.
+Value socket_method_send_parts(SocketHandle *sock, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_ARRAY) {
+        return throw_runtime_error(ctx, "send_parts() expects 1 argument (array of strings or buffers)");
+    }
+    if (sock->closed) {
+        return throw_runtime_error(ctx, "Cannot send on closed socket");
+    }
+    Array *parts = args[0].as.as_array;
+    int count = parts->length;
+    if (count == 0) return val_i64(0);
+
+    struct iovec *iovs = malloc(sizeof(struct iovec) * count);
+    if (!iovs) {
+        return throw_runtime_error(ctx, "Memory allocation failed");
+    }
+    for (int i = 0; i < count; i++) {
+        const void *bytes;
+        size_t len;
+        if (!socket_bytes(parts->elements[i], &bytes, &len)) {
+            free(iovs);
+            return throw_runtime_error(ctx, "send_parts() parts must be strings or buffers");
+        }
+        iovs[i].iov_base = (void *)bytes;
+        iovs[i].iov_len = len;
+    }
+
+    int64_t total = 0;
+    int first = 0;
+    int err = 0;
+    while (first < count) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iovs + first;
+        msg.msg_iovlen = count - first < IOV_MAX ? count - first : IOV_MAX;
+        ssize_t n = sendmsg(sock->fd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        total += n;
+        // Skip what was sent, trimming a partially sent part
+        while (first < count && (size_t)n >= iovs[first].iov_len) {
+            n -= iovs[first].iov_len;
+            first++;
+        }
+        if (first < count) {
+            iovs[first].iov_base = (char *)iovs[first].iov_base + n;
+            iovs[first].iov_len -= n;
+        }
+    }
+    free(iovs);
+
+    if (err != 0 && !(sock->nonblocking && (err == EAGAIN || err == EWOULDBLOCK))) {
+        return throw_runtime_error(ctx, "Failed to send data: %s", strerror(err));
+    }
+    return val_i64(total);
+}
+
 // ========== DNS RESOLUTION ==========
 
 // dns_resolve(hostname: string) -> string (IP address)
@@ -756,6 +1209,9 @@ Value call_socket_method(SocketHandle *sock, const char *method, Value *args, in
     if (strcmp(method, "send") == 0) {
         return socket_method_send(sock, args, num_args, ctx);
     }
+    if (strcmp(method, "send_file") == 0) {
+        return socket_method_send_file(sock, args, num_args, ctx);
+    }
     if (strcmp(method, "recv") == 0) {
         return socket_method_recv(sock, args, num_args, ctx);
     }
@@ -768,6 +1224,20 @@ Value call_socket_method(SocketHandle *sock, const char *method, Value *args, in
         return socket_method_recvfrom(sock, args, num_args, ctx);
     }
 
+    // Batched and vectored I/O
+    if (strcmp(method, "recv_into") == 0) {
+        return socket_method_recv_into(sock, args, num_args, ctx);
+    }
+    if (strcmp(method, "recv_many") == 0) {
+        return socket_method_recv_many(sock, args, num_args, ctx);
+    }
+    if (strcmp(method, "send_many") == 0) {
+        return socket_method_send_many(sock, args, num_args, ctx);
+    }
+    if (strcmp(method, "send_parts") == 0) {
+        return socket_method_send_parts(sock, args, num_args, ctx);
+    }
+
     // Socket options
     if (strcmp(method, "setsockopt") == 0) {
         return socket_method_setsockopt(sock, args, num_args, ctx);
@@ -806,21 +1276,21 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 2) {
         ctx->exception_state.exception_value = val_string("poll() expects 2 arguments (fds, timeout_ms)");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
     if (args[0].type != VAL_ARRAY) {
         ctx->exception_state.exception_value = val_string("poll() first argument must be array");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
     if (!is_integer(args[1])) {
         ctx->exception_state.exception_value = val_string("poll() second argument must be integer (timeout_ms)");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -837,7 +1307,7 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
     if (!pfds) {
         ctx->exception_state.exception_value = val_string("poll() memory allocation failed");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -847,7 +1317,7 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
         free(pfds);
         ctx->exception_state.exception_value = val_string("poll() memory allocation failed");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -859,7 +1329,7 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
             free(original_fds);
             ctx->exception_state.exception_value = val_string("poll() array elements must be objects with 'fd' and 'events'");
             value_retain(ctx->exception_state.exception_value);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             return val_null();
         }
 
@@ -882,7 +1352,7 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
             free(original_fds);
             ctx->exception_state.exception_value = val_string("poll() fd must be a socket or file");
             value_retain(ctx->exception_state.exception_value);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             return val_null();
         }
 
@@ -891,7 +1361,7 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
             free(original_fds);
             ctx->exception_state.exception_value = val_string("poll() events must be an integer");
             value_retain(ctx->exception_state.exception_value);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             return val_null();
         }
 
@@ -915,7 +1385,7 @@ Value builtin_poll(Value *args, int num_args, ExecutionContext *ctx) {
         snprintf(err_msg, sizeof(err_msg), "poll() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(err_msg);
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
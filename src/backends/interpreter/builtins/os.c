@@ -50,7 +50,7 @@ Value builtin_arch(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "arch() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -70,7 +70,7 @@ Value builtin_hostname(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "hostname() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -106,7 +106,7 @@ Value builtin_username(Value *args, int num_args, ExecutionContext *ctx) {
     char error_msg[256];
     snprintf(error_msg, sizeof(error_msg), "username() failed: could not determine username");
     ctx->exception_state.exception_value = val_string(error_msg);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -133,7 +133,7 @@ Value builtin_homedir(Value *args, int num_args, ExecutionContext *ctx) {
     char error_msg[256];
     snprintf(error_msg, sizeof(error_msg), "homedir() failed: could not determine home directory");
     ctx->exception_state.exception_value = val_string(error_msg);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -168,7 +168,7 @@ Value builtin_total_memory(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "total_memory() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     return val_i64((int64_t)info.totalram * (int64_t)info.mem_unit);
@@ -180,7 +180,7 @@ Value builtin_total_memory(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "total_memory() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     return val_i64(memsize);
@@ -192,7 +192,7 @@ Value builtin_total_memory(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "total_memory() failed: could not determine memory");
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     return val_i64((int64_t)pages * (int64_t)page_size);
@@ -213,7 +213,7 @@ Value builtin_free_memory(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "free_memory() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     // On Linux, freeram doesn't include buffers/cache, so we add them for "available" memory
@@ -231,7 +231,7 @@ Value builtin_free_memory(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "free_memory() failed: could not get page size");
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     
@@ -239,7 +239,7 @@ Value builtin_free_memory(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "free_memory() failed: could not get VM statistics");
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     
@@ -259,7 +259,7 @@ Value builtin_free_memory(Value *args, int num_args, ExecutionContext *ctx) {
     char error_msg[256];
     snprintf(error_msg, sizeof(error_msg), "free_memory() failed: could not determine free memory");
     ctx->exception_state.exception_value = val_string(error_msg);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 #endif
 }
@@ -277,7 +277,7 @@ Value builtin_os_version(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "os_version() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -297,7 +297,7 @@ Value builtin_os_name(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "os_name() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -349,7 +349,7 @@ Value builtin_uptime(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "uptime() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     return val_i64((int64_t)info.uptime);
@@ -362,7 +362,7 @@ Value builtin_uptime(Value *args, int num_args, ExecutionContext *ctx) {
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "uptime() failed: %s", strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
     time_t now = time(NULL);
@@ -372,7 +372,7 @@ Value builtin_uptime(Value *args, int num_args, ExecutionContext *ctx) {
     char error_msg[256];
     snprintf(error_msg, sizeof(error_msg), "uptime() not supported on this platform");
     ctx->exception_state.exception_value = val_string(error_msg);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 #endif
 }
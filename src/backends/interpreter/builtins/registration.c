@@ -22,10 +22,16 @@ static BuiltinInfo builtins[] = {
     {"string_concat_many", builtin_string_concat_many},
     {"eprint", builtin_eprint},
     {"open", builtin_open},
+    {"mmap_file", builtin_mmap_file},
     {"assert", builtin_assert},
     {"panic", builtin_panic},
     {"set_stack_limit", builtin_set_stack_limit},
     {"get_stack_limit", builtin_get_stack_limit},
+    {"heap_stats", builtin_heap_stats},
+    {"heap_snapshot", builtin_heap_snapshot},
+    {"gc_collect", builtin_gc_collect},
+    {"gc_stats", builtin_gc_stats},
+    {"alloc_stats", builtin_alloc_stats},
     {"exec", builtin_exec},
     {"exec_argv", builtin_exec_argv},
     {"spawn", builtin_spawn},
@@ -99,6 +105,9 @@ static BuiltinInfo builtins[] = {
     {"__wait", builtin_wait},
     {"__waitpid", builtin_waitpid},
     {"__abort", builtin_abort},
+    {"__spawn_process", builtin_spawn_process},
+    {"__process_wait", builtin_process_wait},
+    {"__run_many", builtin_run_many},
     // Internal helper builtins
     {"__read_u32", builtin_read_u32},
     {"__read_u64", builtin_read_u64},
@@ -108,6 +117,20 @@ static BuiltinInfo builtins[] = {
     {"__string_to_cstr", builtin_string_to_cstr},
     {"__cstr_to_string", builtin_cstr_to_string},
     {"__string_from_bytes", builtin_string_from_bytes},
+    {"__utf8_valid", builtin_utf8_valid},
+    // Encoding kernels (use stdlib/encoding.hml module for public API)
+    {"__base64_encode", builtin_base64_encode},
+    {"__base64_decode", builtin_base64_decode},
+    {"__hex_encode", builtin_hex_encode},
+    {"__hex_decode", builtin_hex_decode},
+    {"__percent_encode", builtin_percent_encode},
+    {"__percent_decode", builtin_percent_decode},
+    // String builder (use StringBuilder from stdlib/fmt.hml)
+    {"__sb_new", builtin_sb_new},
+    {"__sb_append", builtin_sb_append},
+    {"__sb_append_byte", builtin_sb_append_byte},
+    {"__sb_to_string", builtin_sb_to_string},
+    {"__bw_new", builtin_bw_new},
     // Internal file operations (use stdlib/fs.hml module for public API)
     {"__exists", builtin_exists},
     {"__read_file", builtin_read_file},
@@ -117,6 +140,10 @@ static BuiltinInfo builtins[] = {
     {"__make_dir", builtin_make_dir},
     {"__remove_dir", builtin_remove_dir},
     {"__list_dir", builtin_list_dir},
+    {"__walk_dir", builtin_walk_dir},
+    {"__walk_open", builtin_walk_open},
+    {"__walk_next", builtin_walk_next},
+    {"__walk_close", builtin_walk_close},
     // Internal file management (use stdlib/fs.hml module for public API)
     {"__remove_file", builtin_remove_file},
     {"__rename", builtin_rename},
@@ -140,6 +167,13 @@ static BuiltinInfo builtins[] = {
     {"__lws_response_headers", builtin_lws_response_headers},
     {"__lws_response_redirect", builtin_lws_response_redirect},
     {"__lws_response_free", builtin_lws_response_free},
+    {"__lws_http_client_new", builtin_lws_http_client_new},
+    {"__lws_http_client_submit", builtin_lws_http_client_submit},
+    {"__lws_http_client_wait", builtin_lws_http_client_wait},
+    {"__lws_http_client_close", builtin_lws_http_client_close},
+    {"__lws_http_stream_open", builtin_lws_http_stream_open},
+    {"__lws_http_stream_read", builtin_lws_http_stream_read},
+    {"__lws_http_stream_close", builtin_lws_http_stream_close},
     // WebSocket builtins
     {"__lws_ws_connect", builtin_lws_ws_connect},
     {"__lws_ws_send_text", builtin_lws_ws_send_text},
@@ -163,6 +197,16 @@ static BuiltinInfo builtins[] = {
     {"__zlib_compress_bound", builtin_zlib_compress_bound},
     {"__crc32", builtin_crc32},
     {"__adler32", builtin_adler32},
+    {"__tar_writer_open", builtin_tar_writer_open},
+    {"__tar_writer_add", builtin_tar_writer_add},
+    {"__tar_writer_add_path", builtin_tar_writer_add_path},
+    {"__tar_writer_close", builtin_tar_writer_close},
+    {"__tar_reader_open", builtin_tar_reader_open},
+    {"__tar_reader_next", builtin_tar_reader_next},
+    {"__tar_reader_read", builtin_tar_reader_read},
+    {"__tar_reader_extract", builtin_tar_reader_extract},
+    {"__tar_reader_extract_into", builtin_tar_reader_extract_into},
+    {"__tar_reader_close", builtin_tar_reader_close},
     // Cryptographic hash builtins (use stdlib/hash.hml module for public API)
     {"__sha256", builtin_sha256},
     {"__sha512", builtin_sha512},
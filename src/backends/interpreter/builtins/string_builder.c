@@ -0,0 +1,145 @@
+/*
+ * String builder builtins
+ *
+ * A string builder is a buffer whose length is the number of bytes
+ * appended so far. Appends grow its capacity geometrically, always leaving
+ * room for a terminator, so __sb_to_string() can hand the bytes to a new
+ * string without copying. The StringBuilder type in @stdlib/fmt wraps
+ * these.
+ */
+
+#include "internal.h"
+#include "../io/internal.h"
+#include <limits.h>
+
+// Ensure room for extra more bytes plus the terminator
+static int sb_reserve(Buffer *buf, int extra, ExecutionContext *ctx) {
+    if (buf->length > INT_MAX - 1 - extra) {
+        runtime_error(ctx, "String builder too large");
+        return 0;
+    }
+    int needed = buf->length + extra + 1;
+    if (needed <= buf->capacity) {
+        return 1;
+    }
+    int new_capacity = buf->capacity < INT_MAX / 2 ? buf->capacity * 2 : INT_MAX;
+    if (new_capacity < needed) new_capacity = needed;
+    if (new_capacity < 32) new_capacity = 32;
+    char *data = realloc(buf->data, new_capacity);
+    if (!data) {
+        runtime_error(ctx, "String builder allocation failed");
+        return 0;
+    }
+    buf->data = data;
+    buf->capacity = new_capacity;
+    return 1;
+}
+
+static Buffer *sb_arg(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_BUFFER || atomic_load(&val.as.as_buffer->freed) || val.as.as_buffer->mapped) {
+        runtime_error(ctx, "%s() requires a string builder buffer", fn_name);
+        return NULL;
+    }
+    return val.as.as_buffer;
+}
+
+static void sb_write(Buffer *buf, const char *bytes, int len, ExecutionContext *ctx) {
+    if (sb_reserve(buf, len, ctx)) {
+        memcpy((char *)buf->data + buf->length, bytes, len);
+        buf->length += len;
+    }
+}
+
+// __sb_new(capacity) - empty builder with room for capacity bytes
+Value builtin_sb_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || !is_integer(args[0])) {
+        runtime_error(ctx, "__sb_new() expects 1 integer argument (capacity)");
+        return val_null();
+    }
+    int capacity = value_to_int(args[0]);
+    if (capacity < 0) capacity = 0;
+
+    Value result = val_buffer(capacity + 1);
+    if (result.type == VAL_BUFFER) {
+        result.as.as_buffer->length = 0;
+    }
+    return result;
+}
+
+// __sb_append(sb, value) - append a value as string + value would
+Value builtin_sb_append(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2) {
+        runtime_error(ctx, "__sb_append() expects 2 arguments (builder, value)");
+        return val_null();
+    }
+    Buffer *buf = sb_arg(args[0], "__sb_append", ctx);
+    if (!buf) return val_null();
+
+    Value val = args[1];
+    if (val.type == VAL_STRING) {
+        sb_write(buf, val.as.as_string->data, val.as.as_string->length, ctx);
+    } else if (val.type == VAL_RUNE) {
+        char bytes[4];
+        int len = utf8_encode(val.as.as_rune, bytes);
+        sb_write(buf, bytes, len, ctx);
+    } else if (val.type == VAL_OBJECT || val.type == VAL_ARRAY) {
+        // Same JSON form as string + object
+        VisitedSet visited;
+        visited_set_init(&visited);
+        char *json = serialize_value(val, &visited, ctx);
+        visited_set_destroy(&visited);
+        if (json) {
+            sb_write(buf, json, strlen(json), ctx);
+            free(json);
+        }
+    } else {
+        char *str = value_to_string(val);
+        sb_write(buf, str, strlen(str), ctx);
+        free(str);
+    }
+    return val_null();
+}
+
+// __sb_append_byte(sb, byte) - append one raw byte
+Value builtin_sb_append_byte(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[1])) {
+        runtime_error(ctx, "__sb_append_byte() expects 2 arguments (builder, byte)");
+        return val_null();
+    }
+    Buffer *buf = sb_arg(args[0], "__sb_append_byte", ctx);
+    if (!buf) return val_null();
+
+    char byte = (char)(value_to_int(args[1]) & 0xFF);
+    sb_write(buf, &byte, 1, ctx);
+    return val_null();
+}
+
+// __sb_to_string(sb) - the builder's contents as a string; the builder is
+// left empty. Long contents are handed over without copying.
+Value builtin_sb_to_string(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__sb_to_string() expects 1 argument (builder)");
+        return val_null();
+    }
+    Buffer *buf = sb_arg(args[0], "__sb_to_string", ctx);
+    if (!buf) return val_null();
+
+    int length = buf->length;
+    if (length < STRING_INLINE_CAPACITY) {
+        // Fits inline; keep the builder's storage for reuse
+        String *str = string_alloc(length);
+        if (length > 0) memcpy(str->data, buf->data, length);
+        str->data[length] = '\0';
+        buf->length = 0;
+        return (Value){ .type = VAL_STRING, .as.as_string = str };
+    }
+
+    if (!sb_reserve(buf, 0, ctx)) return val_null();
+    char *data = buf->data;
+    data[length] = '\0';
+    Value result = val_string_take(data, length, buf->capacity);
+    buf->data = NULL;
+    buf->length = 0;
+    buf->capacity = 0;
+    return result;
+}
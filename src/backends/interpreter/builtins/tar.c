@@ -0,0 +1,1270 @@
+/*
+ * Tar archive builtins
+ *
+ * The __tar_writer_* and __tar_reader_* handles back TarWriter, TarReader,
+ * TarFileWriter and TarFileReader in @stdlib/compression. An archive is
+ * written to or read from a descriptor (or memory) one entry at a time,
+ * optionally through a gzip stream, so it never has to fit in memory and
+ * reading stops at the entry asked for. Headers are ustar, with a pax
+ * record for names that do not fit; GNU long names are understood when
+ * reading. Without gzip, file contents move between the archive and other
+ * files with the kernel-assisted copies in file_transfer.c.
+ */
+
+#define _GNU_SOURCE
+#include "internal.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#define TAR_BLOCK 512
+#define TAR_IO_SIZE (64 * 1024)
+// Largest GNU long name or pax header accepted when reading
+#define TAR_META_MAX (1024 * 1024)
+
+// ========== HEADERS ==========
+
+typedef struct {
+    char *name;
+    char *linkname;
+    int64_t size;
+    int64_t mtime;
+    int mode;
+    char type;
+} TarHeader;
+
+typedef struct {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+} TarBytes;
+
+static void tar_header_free(TarHeader *h) {
+    free(h->name);
+    free(h->linkname);
+    memset(h, 0, sizeof(*h));
+}
+
+// Append n zeroed bytes, returning where they start
+static unsigned char *tar_bytes_grow(TarBytes *b, size_t n) {
+    if (b->length + n > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity : 4096;
+        while (capacity < b->length + n) capacity *= 2;
+        unsigned char *data = realloc(b->data, capacity);
+        if (!data) return NULL;
+        b->data = data;
+        b->capacity = capacity;
+    }
+    unsigned char *start = b->data + b->length;
+    memset(start, 0, n);
+    b->length += n;
+    return start;
+}
+
+static int64_t tar_padding(int64_t size) {
+    return (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK;
+}
+
+static void tar_put_string(unsigned char *field, size_t width, const char *s, size_t len) {
+    memcpy(field, s, len < width ? len : width);
+}
+
+// Zero-padded octal filling the field but its final NUL. Values too big for
+// the field use the GNU base-256 form (sizes of 8GB and up)
+static void tar_put_number(unsigned char *field, int width, int64_t value) {
+    if (value < 0) value = 0;
+    if (value >= (int64_t)1 << (3 * (width - 1))) {
+        for (int i = width - 1; i > 0; i--) {
+            field[i] = (unsigned char)(value & 0xff);
+            value >>= 8;
+        }
+        field[0] = 0x80;
+        return;
+    }
+    char digits[24];
+    snprintf(digits, sizeof(digits), "%0*llo", width - 1, (unsigned long long)value);
+    memcpy(field, digits, (size_t)width - 1);
+}
+
+static int64_t tar_get_number(const unsigned char *field, int width) {
+    int64_t value = 0;
+    if (field[0] & 0x80) {
+        value = field[0] & 0x7f;
+        for (int i = 1; i < width; i++) value = (value << 8) | field[i];
+        return value;
+    }
+    int i = 0;
+    while (i < width && field[i] == ' ') i++;
+    for (; i < width && field[i] >= '0' && field[i] <= '7'; i++) {
+        value = value * 8 + (field[i] - '0');
+    }
+    return value;
+}
+
+// Sum of the header bytes with the checksum field counted as spaces
+static unsigned int tar_checksum(const unsigned char *block, int is_signed) {
+    unsigned int sum = 0;
+    for (int i = 0; i < TAR_BLOCK; i++) {
+        if (i >= 148 && i < 156) {
+            sum += ' ';
+        } else {
+            sum += is_signed ? (unsigned int)(signed char)block[i] : block[i];
+        }
+    }
+    return sum;
+}
+
+// Fill the fields every header has, then the magic and the checksum
+static void tar_seal(unsigned char *block, int mode, int64_t size, int64_t mtime, char type) {
+    tar_put_number(block + 100, 8, mode & 07777);
+    tar_put_number(block + 108, 8, 0);
+    tar_put_number(block + 116, 8, 0);
+    tar_put_number(block + 124, 12, size);
+    tar_put_number(block + 136, 12, mtime);
+    block[156] = (unsigned char)type;
+    memcpy(block + 257, "ustar", 6);
+    memcpy(block + 263, "00", 2);
+    char sum[8];
+    snprintf(sum, sizeof(sum), "%06o", tar_checksum(block, 0));
+    memcpy(block + 148, sum, 7);
+    block[155] = ' ';
+}
+
+// One "<length> key=value\n" pax record; the length counts its own digits
+static int tar_pax_record(TarBytes *out, const char *key, const char *value) {
+    size_t body = strlen(key) + strlen(value) + 3;
+    size_t digits = 1;
+    while (snprintf(NULL, 0, "%zu", body + digits) != (int)digits) digits++;
+    unsigned char *rec = tar_bytes_grow(out, body + digits + 1);
+    if (!rec) return -1;
+    snprintf((char *)rec, body + digits + 1, "%zu %s=%s\n", body + digits, key, value);
+    out->length--;  // Drop snprintf's NUL
+    return 0;
+}
+
+// The header block(s) for one entry. A name over 100 bytes goes in the
+// ustar prefix field when it splits at a '/', otherwise (or for a link
+// target over 100 bytes) a pax header carrying the full value comes first.
+static int tar_encode_header(TarBytes *out, const TarHeader *h) {
+    size_t name_len = strlen(h->name);
+    size_t link_len = h->linkname ? strlen(h->linkname) : 0;
+    size_t split = 0;
+    if (name_len > 100) {
+        for (size_t i = 1; i <= 155 && i < name_len; i++) {
+            if (h->name[i] == '/' && name_len - i - 1 <= 100 && name_len - i - 1 > 0) {
+                split = i;
+                break;
+            }
+        }
+    }
+
+    if ((name_len > 100 && split == 0) || link_len > 100) {
+        TarBytes pax = { 0 };
+        if ((name_len > 100 && split == 0 && tar_pax_record(&pax, "path", h->name) != 0) ||
+            (link_len > 100 && tar_pax_record(&pax, "linkpath", h->linkname) != 0)) {
+            free(pax.data);
+            return -1;
+        }
+        unsigned char *block = tar_bytes_grow(out, TAR_BLOCK + pax.length + tar_padding((int64_t)pax.length));
+        if (!block) {
+            free(pax.data);
+            return -1;
+        }
+        tar_put_string(block, 100, "././@PaxHeader", 14);
+        tar_seal(block, 0644, (int64_t)pax.length, h->mtime, 'x');
+        memcpy(block + TAR_BLOCK, pax.data, pax.length);
+        free(pax.data);
+    }
+
+    unsigned char *block = tar_bytes_grow(out, TAR_BLOCK);
+    if (!block) return -1;
+    if (split) {
+        tar_put_string(block + 345, 155, h->name, split);
+        tar_put_string(block, 100, h->name + split + 1, name_len - split - 1);
+    } else {
+        tar_put_string(block, 100, h->name, name_len);
+    }
+    if (h->linkname) tar_put_string(block + 157, 100, h->linkname, link_len);
+    tar_seal(block, h->mode, h->size, h->mtime, h->type);
+    return 0;
+}
+
+// 1 for a header, 0 for the all-zero block that ends an archive, -1 when
+// the checksum does not match
+static int tar_decode_header(const unsigned char *block, TarHeader *h) {
+    int empty = 1;
+    for (int i = 0; i < TAR_BLOCK && empty; i++) {
+        if (block[i]) empty = 0;
+    }
+    if (empty) return 0;
+
+    int64_t stored = tar_get_number(block + 148, 8);
+    if (stored != tar_checksum(block, 0) && stored != tar_checksum(block, 1)) return -1;
+
+    size_t name_len = strnlen((const char *)block, 100);
+    size_t prefix_len = 0;
+    if (memcmp(block + 257, "ustar", 6) == 0) {
+        prefix_len = strnlen((const char *)block + 345, 155);
+    }
+    h->name = malloc(prefix_len + name_len + 2);
+    if (!h->name) return -1;
+    char *p = h->name;
+    if (prefix_len) {
+        memcpy(p, block + 345, prefix_len);
+        p += prefix_len;
+        *p++ = '/';
+    }
+    memcpy(p, block, name_len);
+    p[name_len] = '\0';
+
+    h->linkname = strndup((const char *)block + 157, 100);
+    h->mode = (int)tar_get_number(block + 100, 8);
+    h->size = tar_get_number(block + 124, 12);
+    h->mtime = tar_get_number(block + 136, 12);
+    h->type = block[156] ? (char)block[156] : '0';
+    return 1;
+}
+
+// Apply the path, linkpath and size records of a pax header
+static void tar_apply_pax(const char *data, size_t len, TarHeader *ext) {
+    size_t pos = 0;
+    while (pos < len) {
+        char *end;
+        long rec_len = strtol(data + pos, &end, 10);
+        if (rec_len <= 0 || pos + (size_t)rec_len > len || *end != ' ') break;
+        const char *key = end + 1;
+        const char *rec_end = data + pos + rec_len - 1;  // The '\n'
+        const char *eq = memchr(key, '=', (size_t)(rec_end - key));
+        if (eq) {
+            size_t key_len = (size_t)(eq - key);
+            size_t value_len = (size_t)(rec_end - eq - 1);
+            if (key_len == 4 && memcmp(key, "path", 4) == 0) {
+                free(ext->name);
+                ext->name = strndup(eq + 1, value_len);
+            } else if (key_len == 8 && memcmp(key, "linkpath", 8) == 0) {
+                free(ext->linkname);
+                ext->linkname = strndup(eq + 1, value_len);
+            } else if (key_len == 4 && memcmp(key, "size", 4) == 0) {
+                ext->size = strtoll(eq + 1, NULL, 10);
+            }
+        }
+        pos += (size_t)rec_len;
+    }
+}
+
+// ========== WRITING ==========
+
+typedef struct {
+    int fd;                     // Archive descriptor, -1 when building in memory
+    int owns_fd;
+    TarBytes mem;               // The archive when building in memory
+    int gzip;
+    z_stream zs;
+    unsigned char *buf;         // Tar bytes waiting to be written, or deflate output
+    size_t buf_length;
+    char error[512];
+} TarWriter;
+
+static int tar_write_failed(TarWriter *w, const char *what) {
+    snprintf(w->error, sizeof(w->error), "%s: %s", what, strerror(errno));
+    return -1;
+}
+
+// Bytes in their final (possibly compressed) form
+static int tar_sink(TarWriter *w, const unsigned char *data, size_t len) {
+    if (w->fd < 0) {
+        unsigned char *dst = tar_bytes_grow(&w->mem, len);
+        if (!dst) return tar_write_failed(w, "Tar archive too large");
+        memcpy(dst, data, len);
+        return 0;
+    }
+    while (len > 0) {
+        ssize_t n = write(w->fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return tar_write_failed(w, "Tar write failed");
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int tar_flush(TarWriter *w) {
+    if (w->buf_length == 0) return 0;
+    size_t len = w->buf_length;
+    w->buf_length = 0;
+    return tar_sink(w, w->buf, len);
+}
+
+static int tar_deflate(TarWriter *w, const unsigned char *data, size_t len, int flush) {
+    w->zs.next_in = (Bytef *)data;
+    w->zs.avail_in = (uInt)len;
+    do {
+        if (w->buf_length == TAR_IO_SIZE && tar_flush(w) != 0) return -1;
+        w->zs.next_out = w->buf + w->buf_length;
+        w->zs.avail_out = (uInt)(TAR_IO_SIZE - w->buf_length);
+        int rc = deflate(&w->zs, flush);
+        w->buf_length = TAR_IO_SIZE - w->zs.avail_out;
+        if (rc == Z_STREAM_END) break;
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            snprintf(w->error, sizeof(w->error), "Tar gzip compression failed: %s",
+                     w->zs.msg ? w->zs.msg : "unknown error");
+            return -1;
+        }
+    } while (flush == Z_FINISH || w->zs.avail_in > 0 || w->zs.avail_out == 0);
+    return 0;
+}
+
+// Tar stream bytes, staged so small headers and files share one write
+static int tar_write(TarWriter *w, const unsigned char *data, size_t len) {
+    if (w->gzip) {
+        while (len > 0) {
+            size_t chunk = len > INT_MAX ? INT_MAX : len;
+            if (tar_deflate(w, data, chunk, Z_NO_FLUSH) != 0) return -1;
+            data += chunk;
+            len -= chunk;
+        }
+        return 0;
+    }
+    if (w->fd < 0) return tar_sink(w, data, len);
+    if (w->buf_length + len > TAR_IO_SIZE && tar_flush(w) != 0) return -1;
+    if (len >= TAR_IO_SIZE) return tar_sink(w, data, len);
+    memcpy(w->buf + w->buf_length, data, len);
+    w->buf_length += len;
+    return 0;
+}
+
+static int tar_write_padding(TarWriter *w, int64_t size) {
+    static const unsigned char zeros[TAR_BLOCK];
+    int64_t pad = tar_padding(size);
+    return pad ? tar_write(w, zeros, (size_t)pad) : 0;
+}
+
+static int tar_write_header(TarWriter *w, const TarHeader *h) {
+    TarBytes header = { 0 };
+    int rc = tar_encode_header(&header, h);
+    if (rc != 0) {
+        snprintf(w->error, sizeof(w->error), "Tar header for '%s' could not be allocated", h->name);
+    } else {
+        rc = tar_write(w, header.data, header.length);
+    }
+    free(header.data);
+    return rc;
+}
+
+static int tar_write_entry(TarWriter *w, const TarHeader *h, const unsigned char *data, size_t len) {
+    if (tar_write_header(w, h) != 0 || tar_write(w, data, len) != 0) return -1;
+    return tar_write_padding(w, (int64_t)len);
+}
+
+// Add a file, directory or symlink from disk. Without gzip the file's
+// contents are copied straight into the archive file by the kernel
+static int tar_add_path(TarWriter *w, const char *path, const char *name) {
+    struct stat st;
+    if (lstat(path, &st) != 0) {
+        snprintf(w->error, sizeof(w->error), "Cannot add '%s' to tar archive: %s", path, strerror(errno));
+        return -1;
+    }
+
+    TarHeader h = { 0 };
+    h.mode = (int)(st.st_mode & 07777);
+    h.mtime = (int64_t)st.st_mtime;
+    size_t name_len = strlen(name);
+    char target[PATH_MAX];
+    if (S_ISDIR(st.st_mode)) {
+        h.type = '5';
+        h.name = malloc(name_len + 2);
+        if (!h.name) return tar_write_failed(w, "Tar header allocation failed");
+        memcpy(h.name, name, name_len);
+        if (name_len == 0 || name[name_len - 1] != '/') h.name[name_len++] = '/';
+        h.name[name_len] = '\0';
+        int rc = tar_write_header(w, &h);
+        free(h.name);
+        return rc;
+    }
+    h.name = (char *)name;
+    if (S_ISLNK(st.st_mode)) {
+        ssize_t n = readlink(path, target, sizeof(target) - 1);
+        if (n < 0) {
+            snprintf(w->error, sizeof(w->error), "Cannot read link '%s': %s", path, strerror(errno));
+            return -1;
+        }
+        target[n] = '\0';
+        h.type = '2';
+        h.linkname = target;
+        return tar_write_header(w, &h);
+    }
+    if (!S_ISREG(st.st_mode)) {
+        snprintf(w->error, sizeof(w->error),
+                 "Cannot add '%s' to tar archive: not a regular file, directory or symlink", path);
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        snprintf(w->error, sizeof(w->error), "Cannot open '%s': %s", path, strerror(errno));
+        return -1;
+    }
+    h.type = '0';
+    h.size = (int64_t)st.st_size;
+    int64_t copied = 0;
+    int rc = tar_write_header(w, &h);
+    if (rc == 0 && !w->gzip && w->fd >= 0) {
+        rc = tar_flush(w);
+        if (rc == 0) {
+            copied = fd_copy_n(fd, w->fd, h.size);
+            if (copied < 0) rc = tar_write_failed(w, "Tar write failed");
+        }
+    } else if (rc == 0) {
+        unsigned char *chunk = malloc(TAR_IO_SIZE);
+        if (!chunk) rc = tar_write_failed(w, "Tar copy buffer allocation failed");
+        while (rc == 0 && copied < h.size) {
+            int64_t want = h.size - copied;
+            ssize_t n = read(fd, chunk, want > TAR_IO_SIZE ? TAR_IO_SIZE : (size_t)want);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                snprintf(w->error, sizeof(w->error), "Cannot read '%s': %s", path, strerror(errno));
+                rc = -1;
+            } else if (n == 0) {
+                break;
+            } else {
+                rc = tar_write(w, chunk, (size_t)n);
+                copied += n;
+            }
+        }
+        free(chunk);
+    }
+    close(fd);
+    if (rc == 0 && copied != h.size) {
+        // The header already promised h.size bytes
+        snprintf(w->error, sizeof(w->error), "'%s' changed size while being archived", path);
+        rc = -1;
+    }
+    return rc == 0 ? tar_write_padding(w, h.size) : rc;
+}
+
+// The two zero blocks that end an archive, then the gzip trailer
+static int tar_finish(TarWriter *w) {
+    static const unsigned char zeros[TAR_BLOCK * 2];
+    if (tar_write(w, zeros, sizeof(zeros)) != 0) return -1;
+    if (w->gzip && tar_deflate(w, NULL, 0, Z_FINISH) != 0) return -1;
+    return tar_flush(w);
+}
+
+static void tar_writer_free(TarWriter *w) {
+    if (w->gzip) deflateEnd(&w->zs);
+    if (w->owns_fd) close(w->fd);
+    free(w->buf);
+    free(w->mem.data);
+    free(w);
+}
+
+// ========== READING ==========
+
+typedef struct {
+    int fd;                     // Archive descriptor, -1 for an in-memory archive
+    Value source;               // The buffer an in-memory archive reads from
+    const unsigned char *mem;
+    size_t mem_length;
+    size_t mem_pos;
+    unsigned char peek[2];      // Bytes read to detect gzip, not yet consumed
+    int peek_length;
+    int gzip;
+    z_stream zs;
+    unsigned char *zbuf;        // Compressed input waiting for inflate
+    int zdone;
+    TarHeader entry;            // The current entry
+    int64_t remaining;          // Unread bytes of the current entry
+    int64_t padding;            // Zero padding after the current entry
+    int finished;
+    char error[512];
+} TarReader;
+
+// Archive bytes as stored (compressed or not)
+static ssize_t tar_source_read(TarReader *r, unsigned char *buf, size_t len) {
+    if (r->peek_length > 0) {
+        size_t n = (size_t)r->peek_length < len ? (size_t)r->peek_length : len;
+        memcpy(buf, r->peek, n);
+        memmove(r->peek, r->peek + n, (size_t)r->peek_length - n);
+        r->peek_length -= (int)n;
+        return (ssize_t)n;
+    }
+    if (r->fd < 0) {
+        size_t n = r->mem_length - r->mem_pos;
+        if (n > len) n = len;
+        memcpy(buf, r->mem + r->mem_pos, n);
+        r->mem_pos += n;
+        return (ssize_t)n;
+    }
+    for (;;) {
+        ssize_t n = read(r->fd, buf, len);
+        if (n >= 0) return n;
+        if (errno != EINTR) {
+            snprintf(r->error, sizeof(r->error), "Tar read failed: %s", strerror(errno));
+            return -1;
+        }
+    }
+}
+
+static ssize_t tar_inflate(TarReader *r, unsigned char *buf, size_t len) {
+    if (r->zdone) return 0;
+    if (len > INT_MAX) len = INT_MAX;
+    r->zs.next_out = buf;
+    r->zs.avail_out = (uInt)len;
+    while (r->zs.avail_out == len) {
+        if (r->zs.avail_in == 0) {
+            ssize_t n = tar_source_read(r, r->zbuf, TAR_IO_SIZE);
+            if (n < 0) return -1;
+            if (n == 0) {
+                snprintf(r->error, sizeof(r->error), "Truncated gzip stream in tar archive");
+                return -1;
+            }
+            r->zs.next_in = r->zbuf;
+            r->zs.avail_in = (uInt)n;
+        }
+        int rc = inflate(&r->zs, Z_NO_FLUSH);
+        if (rc == Z_STREAM_END) {
+            r->zdone = 1;
+            break;
+        }
+        if (rc != Z_OK) {
+            snprintf(r->error, sizeof(r->error), "Corrupt gzip stream in tar archive: %s",
+                     r->zs.msg ? r->zs.msg : "unknown error");
+            return -1;
+        }
+    }
+    return (ssize_t)(len - r->zs.avail_out);
+}
+
+// Tar stream bytes; fewer than len only at the end of the archive
+static ssize_t tar_read(TarReader *r, unsigned char *buf, size_t len) {
+    size_t total = 0;
+    while (total < len) {
+        ssize_t n = r->gzip ? tar_inflate(r, buf + total, len - total)
+                            : tar_source_read(r, buf + total, len - total);
+        if (n < 0) return -1;
+        if (n == 0) break;
+        total += (size_t)n;
+    }
+    return (ssize_t)total;
+}
+
+static int tar_skip(TarReader *r, int64_t n) {
+    if (n <= 0) return 0;
+    if (!r->gzip && r->fd < 0) {
+        r->mem_pos = (size_t)n > r->mem_length - r->mem_pos ? r->mem_length : r->mem_pos + (size_t)n;
+        return 0;
+    }
+    if (!r->gzip && r->peek_length == 0 && lseek(r->fd, (off_t)n, SEEK_CUR) >= 0) return 0;
+    unsigned char discard[TAR_BLOCK * 16];
+    while (n > 0) {
+        ssize_t got = tar_read(r, discard, n > (int64_t)sizeof(discard) ? sizeof(discard) : (size_t)n);
+        if (got < 0) return -1;
+        if (got == 0) break;  // The next header read reports the end
+        n -= got;
+    }
+    return 0;
+}
+
+// Contents of a GNU long name or pax header
+static char *tar_read_meta(TarReader *r, int64_t size) {
+    if (size > TAR_META_MAX) {
+        snprintf(r->error, sizeof(r->error), "Tar extended header too large (%lld bytes)", (long long)size);
+        return NULL;
+    }
+    char *data = malloc((size_t)size + 1);
+    if (!data) {
+        snprintf(r->error, sizeof(r->error), "Tar extended header allocation failed");
+        return NULL;
+    }
+    ssize_t n = tar_read(r, (unsigned char *)data, (size_t)size);
+    if (n != size) {
+        if (n >= 0) snprintf(r->error, sizeof(r->error), "Truncated tar archive");
+        free(data);
+        return NULL;
+    }
+    data[size] = '\0';
+    r->remaining = 0;
+    return data;
+}
+
+// Move to the next entry, skipping whatever is left of the current one.
+// 1 with r->entry filled in, 0 at the end of the archive, -1 on error
+static int tar_next(TarReader *r) {
+    TarHeader ext = { 0 };  // Values from GNU long name and pax headers
+    ext.size = -1;
+    tar_header_free(&r->entry);
+
+    while (!r->finished) {
+        if (tar_skip(r, r->remaining + r->padding) != 0) goto fail;
+        r->remaining = 0;
+        r->padding = 0;
+
+        unsigned char block[TAR_BLOCK];
+        ssize_t n = tar_read(r, block, TAR_BLOCK);
+        if (n < 0) goto fail;
+        if (n == 0) break;
+        if (n < TAR_BLOCK) {
+            snprintf(r->error, sizeof(r->error), "Truncated tar header");
+            goto fail;
+        }
+        int rc = tar_decode_header(block, &r->entry);
+        if (rc == 0) break;
+        if (rc < 0) {
+            snprintf(r->error, sizeof(r->error), "Invalid tar header (checksum mismatch)");
+            goto fail;
+        }
+        r->remaining = r->entry.size;
+        r->padding = tar_padding(r->entry.size);
+
+        char type = r->entry.type;
+        if (type == 'L' || type == 'K' || type == 'x' || type == 'g') {
+            char *data = tar_read_meta(r, r->entry.size);
+            if (!data) goto fail;
+            if (type == 'L') {
+                free(ext.name);
+                ext.name = data;
+            } else if (type == 'K') {
+                free(ext.linkname);
+                ext.linkname = data;
+            } else {
+                if (type == 'x') tar_apply_pax(data, (size_t)r->entry.size, &ext);
+                free(data);
+            }
+            tar_header_free(&r->entry);
+            continue;
+        }
+
+        if (ext.name) {
+            free(r->entry.name);
+            r->entry.name = ext.name;
+        }
+        if (ext.linkname) {
+            free(r->entry.linkname);
+            r->entry.linkname = ext.linkname;
+        }
+        if (ext.size >= 0) {
+            r->entry.size = ext.size;
+            r->remaining = ext.size;
+            r->padding = tar_padding(ext.size);
+        }
+        return 1;
+    }
+    r->finished = 1;
+    tar_header_free(&ext);
+    return 0;
+
+fail:
+    tar_header_free(&ext);
+    tar_header_free(&r->entry);
+    r->remaining = 0;
+    r->padding = 0;
+    return -1;
+}
+
+// Up to len bytes of the current entry
+static ssize_t tar_read_entry(TarReader *r, unsigned char *buf, size_t len) {
+    if ((int64_t)len > r->remaining) len = (size_t)r->remaining;
+    ssize_t n = tar_read(r, buf, len);
+    if (n < 0) return -1;
+    if ((size_t)n < len) {
+        snprintf(r->error, sizeof(r->error), "Truncated tar archive");
+        return -1;
+    }
+    r->remaining -= n;
+    return n;
+}
+
+// The rest of the current entry into dest_fd, kernel-side when the archive
+// is an uncompressed file
+static int tar_copy_entry(TarReader *r, int dest_fd) {
+    if (!r->gzip && r->fd >= 0 && r->peek_length == 0) {
+        int64_t n = fd_copy_n(r->fd, dest_fd, r->remaining);
+        if (n < 0) {
+            snprintf(r->error, sizeof(r->error), "Tar extract failed: %s", strerror(errno));
+            return -1;
+        }
+        if (n < r->remaining) {
+            snprintf(r->error, sizeof(r->error), "Truncated tar archive");
+            return -1;
+        }
+        r->remaining = 0;
+        return 0;
+    }
+    unsigned char *chunk = malloc(TAR_IO_SIZE);
+    if (!chunk) {
+        snprintf(r->error, sizeof(r->error), "Tar copy buffer allocation failed");
+        return -1;
+    }
+    while (r->remaining > 0) {
+        ssize_t n = tar_read_entry(r, chunk, TAR_IO_SIZE);
+        if (n < 0) break;
+        const unsigned char *p = chunk;
+        while (n > 0) {
+            ssize_t w = write(dest_fd, p, (size_t)n);
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0) {
+                snprintf(r->error, sizeof(r->error), "Tar extract failed: %s", strerror(errno));
+                free(chunk);
+                return -1;
+            }
+            p += w;
+            n -= w;
+        }
+    }
+    free(chunk);
+    return r->remaining == 0 ? 0 : -1;
+}
+
+// Create the directories above path that do not exist yet
+static int tar_make_parents(char *path) {
+    for (char *p = path + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        int rc = mkdir(path, 0755);
+        *p = '/';
+        if (rc != 0 && errno != EEXIST) return -1;
+    }
+    return 0;
+}
+
+// Write the current entry to dest: a file, a directory or a symlink
+static int tar_extract(TarReader *r, const char *dest) {
+    char *path = strdup(dest);
+    if (!path || tar_make_parents(path) != 0) {
+        snprintf(r->error, sizeof(r->error), "Cannot create directories for '%s': %s", dest, strerror(errno));
+        free(path);
+        return -1;
+    }
+    free(path);
+
+    TarHeader *h = &r->entry;
+    int mode = h->mode & 0777;
+    switch (h->type) {
+        case '5':
+            if (mkdir(dest, mode ? (mode_t)mode : 0755) != 0 && errno != EEXIST) break;
+            return 0;
+        case '2':
+            if (symlink(h->linkname ? h->linkname : "", dest) != 0) break;
+            return 0;
+        case '0':
+        case '7': {
+            // O_NOFOLLOW: never write through a symlink an earlier entry planted
+            int fd = open(dest, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, mode ? (mode_t)mode : 0644);
+            if (fd < 0) break;
+            int rc = tar_copy_entry(r, fd);
+            close(fd);
+            return rc;
+        }
+        default:
+            snprintf(r->error, sizeof(r->error), "Cannot extract '%s': unsupported tar entry type '%c'",
+                     h->name, h->type);
+            return -1;
+    }
+    snprintf(r->error, sizeof(r->error), "Cannot extract '%s': %s", dest, strerror(errno));
+    return -1;
+}
+
+// Report why a component of an entry name could not be opened as a
+// directory, naming a symlink in the way explicitly
+static int tar_component_error(TarReader *r, int at, const char *part) {
+    int err = errno;
+    struct stat st;
+    if (fstatat(at, part, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISLNK(st.st_mode)) {
+        snprintf(r->error, sizeof(r->error), "Refusing to extract '%s' through a symlink", r->entry.name);
+    } else {
+        snprintf(r->error, sizeof(r->error), "Cannot extract '%s': %s", r->entry.name, strerror(err));
+    }
+    return -1;
+}
+
+// Write the current entry under the directory dir_fd. Each component of
+// the name is opened relative to the one before it with O_NOFOLLOW, so a
+// symlink an earlier entry planted cannot carry a later one outside.
+static int tar_extract_at(TarReader *r, int dir_fd) {
+    TarHeader *h = &r->entry;
+    if (h->name[0] == '/') {
+        snprintf(r->error, sizeof(r->error), "Refusing to extract unsafe tar entry '%s'", h->name);
+        return -1;
+    }
+    char *name = strdup(h->name);
+    if (!name) {
+        snprintf(r->error, sizeof(r->error), "Tar name allocation failed");
+        return -1;
+    }
+
+    int at = dir_fd;
+    int rc = -1;
+    char *leaf = NULL;
+    char *save = NULL;
+    for (char *part = strtok_r(name, "/", &save); part; part = strtok_r(NULL, "/", &save)) {
+        if (strcmp(part, ".") == 0) continue;
+        if (strcmp(part, "..") == 0) {
+            snprintf(r->error, sizeof(r->error), "Refusing to extract unsafe tar entry '%s'", h->name);
+            goto done;
+        }
+        if (leaf) {
+            if (mkdirat(at, leaf, 0755) != 0 && errno != EEXIST) {
+                snprintf(r->error, sizeof(r->error), "Cannot extract '%s': %s", h->name, strerror(errno));
+                goto done;
+            }
+            int next = openat(at, leaf, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (next < 0) {
+                tar_component_error(r, at, leaf);
+                goto done;
+            }
+            if (at != dir_fd) close(at);
+            at = next;
+        }
+        leaf = part;
+    }
+
+    int mode = h->mode & 0777;
+    if (!leaf) {
+        // The name is the destination itself ("." or "./")
+        rc = 0;
+        if (h->type != '5') {
+            snprintf(r->error, sizeof(r->error), "Cannot extract '%s': not a file name", h->name);
+            rc = -1;
+        }
+        goto done;
+    }
+    switch (h->type) {
+        case '5':
+            if (mkdirat(at, leaf, mode ? (mode_t)mode : 0755) != 0 && errno != EEXIST) break;
+            rc = 0;
+            goto done;
+        case '2':
+            if (symlinkat(h->linkname ? h->linkname : "", at, leaf) != 0) break;
+            rc = 0;
+            goto done;
+        case '0':
+        case '7': {
+            int fd = openat(at, leaf, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC,
+                            mode ? (mode_t)mode : 0644);
+            if (fd < 0) {
+                tar_component_error(r, at, leaf);
+                goto done;
+            }
+            rc = tar_copy_entry(r, fd);
+            close(fd);
+            goto done;
+        }
+        default:
+            snprintf(r->error, sizeof(r->error), "Cannot extract '%s': unsupported tar entry type '%c'",
+                     h->name, h->type);
+            goto done;
+    }
+    snprintf(r->error, sizeof(r->error), "Cannot extract '%s': %s", h->name, strerror(errno));
+done:
+    if (at != dir_fd) close(at);
+    free(name);
+    return rc;
+}
+
+// Write the current entry under dest_dir, creating dest_dir if needed
+static int tar_extract_into(TarReader *r, const char *dest_dir) {
+    size_t len = strlen(dest_dir);
+    char *path = malloc(len + 2);
+    if (!path) {
+        snprintf(r->error, sizeof(r->error), "Tar path allocation failed");
+        return -1;
+    }
+    memcpy(path, dest_dir, len);
+    path[len] = '/';
+    path[len + 1] = '\0';
+    int rc = tar_make_parents(path);
+    free(path);
+    int dir_fd = rc == 0 ? open(dest_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+    if (dir_fd < 0) {
+        snprintf(r->error, sizeof(r->error), "Cannot open directory '%s': %s", dest_dir, strerror(errno));
+        return -1;
+    }
+    rc = tar_extract_at(r, dir_fd);
+    close(dir_fd);
+    return rc;
+}
+
+static void tar_reader_free(TarReader *r) {
+    if (r->gzip) inflateEnd(&r->zs);
+    if (r->fd >= 0) close(r->fd);
+    value_release(r->source);
+    tar_header_free(&r->entry);
+    free(r->zbuf);
+    free(r);
+}
+
+// ========== BUILTINS ==========
+
+static char *tar_cstring(Value val) {
+    return strndup(val.as.as_string->data, (size_t)val.as.as_string->length);
+}
+
+// An archive descriptor of our own for a Hemlock file, positioned where the
+// file's logical offset is
+static int tar_file_fd(FileHandle *file, int writing, const char *fn_name, ExecutionContext *ctx) {
+    if (file->closed) {
+        runtime_error(ctx, "%s() file '%s' is closed", fn_name, file->path);
+        return -1;
+    }
+    if (writing && file->mode[0] == 'r' && strchr(file->mode, '+') == NULL) {
+        runtime_error(ctx, "%s() file '%s' is opened read-only", fn_name, file->path);
+        return -1;
+    }
+    off_t offset = ftello(file->fp);
+    fflush(file->fp);
+    int fd = dup(fileno(file->fp));
+    if (fd < 0 || (offset >= 0 && lseek(fd, offset, SEEK_SET) < 0 && errno != ESPIPE)) {
+        runtime_error(ctx, "%s() cannot use file '%s': %s", fn_name, file->path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void *tar_handle(Value val, const char *fn_name, ExecutionContext *ctx) {
+    if (val.type != VAL_PTR || !val.as.as_ptr) {
+        runtime_error(ctx, "%s() expects a tar handle", fn_name);
+        return NULL;
+    }
+    return val.as.as_ptr;
+}
+
+// __tar_writer_open(target, gzip_level) - start an archive at target (a
+// path or a file), or in memory when target is null. gzip_level null
+// writes it uncompressed
+Value builtin_tar_writer_open(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || (args[1].type != VAL_NULL && !is_integer(args[1]))) {
+        runtime_error(ctx, "__tar_writer_open() expects 2 arguments (target, gzip level or null)");
+        return val_null();
+    }
+    int level = args[1].type == VAL_NULL ? -2 : value_to_int(args[1]);
+    if (level < -2 || level > 9) {
+        runtime_error(ctx, "Tar gzip level must be -1 to 9");
+        return val_null();
+    }
+
+    int fd = -1;
+    if (args[0].type == VAL_STRING) {
+        char *path = tar_cstring(args[0]);
+        if (!sandbox_path_allowed(ctx, path, 1)) {
+            free(path);
+            sandbox_error(ctx, "file write operations");
+            return val_null();
+        }
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            runtime_error(ctx, "Cannot create tar archive '%s': %s", path, strerror(errno));
+            free(path);
+            return val_null();
+        }
+        free(path);
+    } else if (args[0].type == VAL_FILE) {
+        fd = tar_file_fd(args[0].as.as_file, 1, "__tar_writer_open", ctx);
+        if (fd < 0) return val_null();
+    } else if (args[0].type != VAL_NULL) {
+        runtime_error(ctx, "__tar_writer_open() target must be a path, a file or null");
+        return val_null();
+    }
+
+    TarWriter *w = calloc(1, sizeof(TarWriter));
+    unsigned char *buf = malloc(TAR_IO_SIZE);
+    if (!w || !buf) {
+        free(w);
+        free(buf);
+        if (fd >= 0) close(fd);
+        runtime_error(ctx, "__tar_writer_open() memory allocation failed");
+        return val_null();
+    }
+    w->fd = fd;
+    w->owns_fd = fd >= 0;
+    w->buf = buf;
+    if (level != -2) {
+        if (deflateInit2(&w->zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            tar_writer_free(w);
+            runtime_error(ctx, "Tar gzip initialization failed");
+            return val_null();
+        }
+        w->gzip = 1;
+    }
+    return val_ptr(w);
+}
+
+// __tar_writer_add(handle, name, content, mode, type, linkname) - one entry
+// whose contents (a string, a buffer or null) are already in memory
+Value builtin_tar_writer_add(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 6 || args[1].type != VAL_STRING || !is_integer(args[3]) || args[4].type != VAL_RUNE ||
+        (args[5].type != VAL_NULL && args[5].type != VAL_STRING)) {
+        runtime_error(ctx, "__tar_writer_add() expects (handle, name, content, mode, type, linkname)");
+        return val_null();
+    }
+    TarWriter *w = tar_handle(args[0], "__tar_writer_add", ctx);
+    if (!w) return val_null();
+
+    const unsigned char *data = NULL;
+    size_t len = 0;
+    if (args[2].type == VAL_STRING) {
+        data = (const unsigned char *)args[2].as.as_string->data;
+        len = (size_t)args[2].as.as_string->length;
+    } else if (args[2].type == VAL_BUFFER) {
+        data = args[2].as.as_buffer->data;
+        len = (size_t)args[2].as.as_buffer->length;
+    } else if (args[2].type != VAL_NULL) {
+        runtime_error(ctx, "__tar_writer_add() content must be a string, buffer or null");
+        return val_null();
+    }
+
+    TarHeader h = { 0 };
+    h.name = tar_cstring(args[1]);
+    h.linkname = args[5].type == VAL_STRING ? tar_cstring(args[5]) : NULL;
+    h.mode = value_to_int(args[3]);
+    h.size = (int64_t)len;
+    h.type = (char)args[4].as.as_rune;
+    if (tar_write_entry(w, &h, data, len) != 0) {
+        runtime_error(ctx, "%s", w->error);
+    }
+    tar_header_free(&h);
+    return val_null();
+}
+
+// __tar_writer_add_path(handle, path, name) - a file, directory or symlink
+// from disk, stored as name
+Value builtin_tar_writer_add_path(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 3 || args[1].type != VAL_STRING || args[2].type != VAL_STRING) {
+        runtime_error(ctx, "__tar_writer_add_path() expects (handle, path, name)");
+        return val_null();
+    }
+    TarWriter *w = tar_handle(args[0], "__tar_writer_add_path", ctx);
+    if (!w) return val_null();
+
+    char *path = tar_cstring(args[1]);
+    char *name = tar_cstring(args[2]);
+    if (!sandbox_path_allowed(ctx, path, 0)) {
+        sandbox_error(ctx, "file read outside sandbox root");
+    } else if (tar_add_path(w, path, name) != 0) {
+        runtime_error(ctx, "%s", w->error);
+    }
+    free(path);
+    free(name);
+    return val_null();
+}
+
+// __tar_writer_close(handle) - end the archive and free the handle. Returns
+// the archive as a buffer when it was built in memory, otherwise null
+Value builtin_tar_writer_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__tar_writer_close() expects 1 argument (handle)");
+        return val_null();
+    }
+    TarWriter *w = tar_handle(args[0], "__tar_writer_close", ctx);
+    if (!w) return val_null();
+
+    Value result = val_null();
+    if (tar_finish(w) != 0) {
+        runtime_error(ctx, "%s", w->error);
+    } else if (w->fd < 0) {
+        result = val_buffer(w->mem.length > 0 ? (int)w->mem.length : 1);
+        if (result.type == VAL_BUFFER) {
+            memcpy(result.as.as_buffer->data, w->mem.data, w->mem.length);
+            result.as.as_buffer->length = (int)w->mem.length;
+        }
+    }
+    tar_writer_free(w);
+    return result;
+}
+
+// __tar_reader_open(source) - read the archive at a path, from a file, or
+// in a buffer. gzip compression is detected from the first bytes
+Value builtin_tar_reader_open(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__tar_reader_open() expects 1 argument (source)");
+        return val_null();
+    }
+    TarReader *r = calloc(1, sizeof(TarReader));
+    if (!r) {
+        runtime_error(ctx, "__tar_reader_open() memory allocation failed");
+        return val_null();
+    }
+    r->fd = -1;
+    r->source = val_null();
+
+    Value source = args[0];
+    if (source.type == VAL_STRING) {
+        char *path = tar_cstring(source);
+        if (!sandbox_path_allowed(ctx, path, 0)) {
+            free(path);
+            free(r);
+            sandbox_error(ctx, "file read outside sandbox root");
+            return val_null();
+        }
+        r->fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (r->fd < 0) {
+            runtime_error(ctx, "Cannot open tar archive '%s': %s", path, strerror(errno));
+            free(path);
+            free(r);
+            return val_null();
+        }
+        free(path);
+    } else if (source.type == VAL_FILE) {
+        r->fd = tar_file_fd(source.as.as_file, 0, "__tar_reader_open", ctx);
+        if (r->fd < 0) {
+            free(r);
+            return val_null();
+        }
+    } else if (source.type == VAL_BUFFER) {
+        value_retain(source);
+        r->source = source;
+        r->mem = source.as.as_buffer->data;
+        r->mem_length = (size_t)source.as.as_buffer->length;
+    } else {
+        free(r);
+        runtime_error(ctx, "__tar_reader_open() source must be a path, a file or a buffer");
+        return val_null();
+    }
+
+    // Peek at the gzip magic number
+    const unsigned char *magic = r->mem;
+    size_t magic_len = r->mem_length;
+    if (r->fd >= 0) {
+        while (r->peek_length < 2) {
+            ssize_t n = read(r->fd, r->peek + r->peek_length, (size_t)(2 - r->peek_length));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            r->peek_length += (int)n;
+        }
+        magic = r->peek;
+        magic_len = (size_t)r->peek_length;
+    }
+    if (magic_len >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        r->zbuf = malloc(TAR_IO_SIZE);
+        if (!r->zbuf || inflateInit2(&r->zs, 15 + 16) != Z_OK) {
+            tar_reader_free(r);
+            runtime_error(ctx, "Tar gzip initialization failed");
+            return val_null();
+        }
+        r->gzip = 1;
+    }
+    return val_ptr(r);
+}
+
+// __tar_reader_next(handle) - the next entry's header as
+// { name, size, mode, mtime, type, linkname }, or null at the end
+Value builtin_tar_reader_next(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__tar_reader_next() expects 1 argument (handle)");
+        return val_null();
+    }
+    TarReader *r = tar_handle(args[0], "__tar_reader_next", ctx);
+    if (!r) return val_null();
+
+    int rc = tar_next(r);
+    if (rc < 0) runtime_error(ctx, "%s", r->error);
+    if (rc <= 0) return val_null();
+
+    TarHeader *h = &r->entry;
+    Object *entry = object_new(NULL, 6);
+    entry->field_names[0] = strdup("name");
+    entry->field_values[0] = val_string(h->name);
+    entry->field_names[1] = strdup("size");
+    entry->field_values[1] = val_i64(h->size);
+    entry->field_names[2] = strdup("mode");
+    entry->field_values[2] = val_i32(h->mode);
+    entry->field_names[3] = strdup("mtime");
+    entry->field_values[3] = val_i64(h->mtime);
+    entry->field_names[4] = strdup("type");
+    entry->field_values[4] = val_rune((uint32_t)(unsigned char)h->type);
+    entry->field_names[5] = strdup("linkname");
+    entry->field_values[5] = h->linkname && h->linkname[0] ? val_string(h->linkname) : val_null();
+    entry->num_fields = 6;
+    return val_object(entry);
+}
+
+// __tar_reader_read(handle, max) - up to max bytes (max < 0: all) of the
+// current entry as a buffer; empty once the entry is used up
+Value builtin_tar_reader_read(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || !is_integer(args[1])) {
+        runtime_error(ctx, "__tar_reader_read() expects 2 arguments (handle, max)");
+        return val_null();
+    }
+    TarReader *r = tar_handle(args[0], "__tar_reader_read", ctx);
+    if (!r) return val_null();
+
+    int64_t want = value_to_int64(args[1]);
+    if (want < 0 || want > r->remaining) want = r->remaining;
+    if (want > INT_MAX) {
+        runtime_error(ctx, "Tar entry '%s' is too large to read at once", r->entry.name);
+        return val_null();
+    }
+    Value result = val_buffer(want > 0 ? (int)want : 1);
+    if (result.type != VAL_BUFFER) return result;
+    ssize_t n = want > 0 ? tar_read_entry(r, result.as.as_buffer->data, (size_t)want) : 0;
+    if (n < 0) {
+        value_release(result);
+        runtime_error(ctx, "%s", r->error);
+        return val_null();
+    }
+    result.as.as_buffer->length = (int)n;
+    return result;
+}
+
+// __tar_reader_extract(handle, dest) - write the current entry to dest,
+// creating missing parent directories
+Value builtin_tar_reader_extract(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[1].type != VAL_STRING) {
+        runtime_error(ctx, "__tar_reader_extract() expects 2 arguments (handle, dest)");
+        return val_null();
+    }
+    TarReader *r = tar_handle(args[0], "__tar_reader_extract", ctx);
+    if (!r) return val_null();
+    if (!r->entry.name) {
+        runtime_error(ctx, "No current tar entry to extract");
+        return val_null();
+    }
+
+    char *dest = tar_cstring(args[1]);
+    if (!sandbox_path_allowed(ctx, dest, 1)) {
+        sandbox_error(ctx, "file write operations");
+    } else if (tar_extract(r, dest) != 0) {
+        runtime_error(ctx, "%s", r->error);
+    }
+    free(dest);
+    return val_null();
+}
+
+// __tar_reader_extract_into(handle, dest_dir) - write the current entry
+// under dest_dir without following symlinks inside it
+Value builtin_tar_reader_extract_into(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[1].type != VAL_STRING) {
+        runtime_error(ctx, "__tar_reader_extract_into() expects 2 arguments (handle, dest_dir)");
+        return val_null();
+    }
+    TarReader *r = tar_handle(args[0], "__tar_reader_extract_into", ctx);
+    if (!r) return val_null();
+    if (!r->entry.name) {
+        runtime_error(ctx, "No current tar entry to extract");
+        return val_null();
+    }
+
+    char *dest_dir = tar_cstring(args[1]);
+    if (!sandbox_path_allowed(ctx, dest_dir, 1)) {
+        sandbox_error(ctx, "file write operations");
+    } else if (tar_extract_into(r, dest_dir) != 0) {
+        runtime_error(ctx, "%s", r->error);
+    }
+    free(dest_dir);
+    return val_null();
+}
+
+// __tar_reader_close(handle) - close the archive and free the handle
+Value builtin_tar_reader_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1) {
+        runtime_error(ctx, "__tar_reader_close() expects 1 argument (handle)");
+        return val_null();
+    }
+    TarReader *r = tar_handle(args[0], "__tar_reader_close", ctx);
+    if (r) tar_reader_free(r);
+    return val_null();
+}
@@ -48,7 +48,9 @@ Value builtin_sleep(Value *args, int num_args, ExecutionContext *ctx) {
     struct timespec req;
     req.tv_sec = (time_t)seconds;
     req.tv_nsec = (long)((seconds - req.tv_sec) * HML_NANOSECONDS_PER_SECOND);
+    uint64_t trace_start_ns = TRACE_NOW();
     nanosleep(&req, NULL);
+    TRACE_SPAN("time", "sleep", trace_start_ns, "ms", (int64_t)(seconds * HML_MILLISECONDS_PER_SECOND));
     return val_null();
 }
 
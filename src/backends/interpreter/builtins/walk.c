@@ -0,0 +1,623 @@
+/*
+ * Directory walking builtins
+ *
+ * __walk_dir() and the __walk_open/__walk_next/__walk_close handle back
+ * walk_dir() and walker() in @stdlib/fs, and glob() in @stdlib/glob.
+ * Directories are read with openat/fdopendir relative to the root, entry
+ * types come from d_type (fstatat only when it is missing or a symlink is
+ * followed), and a pool of worker threads shares a queue of directories.
+ * An optional glob pattern both filters the results and prunes
+ * subdirectories that cannot contain a match.
+ */
+
+#define _GNU_SOURCE
+#include "internal.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// ========== GLOB MATCHING ==========
+
+typedef struct {
+    const char *start;
+    int length;
+} WalkSegment;
+
+// Split a '/'-separated path into segments (empty segments are dropped)
+static int walk_split(const char *path, WalkSegment *segs, int max_segs) {
+    int count = 0;
+    const char *p = path;
+    while (*p) {
+        while (*p == '/') p++;
+        if (!*p) break;
+        const char *start = p;
+        while (*p && *p != '/') p++;
+        if (count < max_segs) {
+            segs[count].start = start;
+            segs[count].length = (int)(p - start);
+        }
+        count++;
+    }
+    return count;
+}
+
+// Decode one UTF-8 codepoint; ? and [...] match characters, not bytes
+static int walk_decode(const char *s, const char *end, uint32_t *cp) {
+    unsigned char c = (unsigned char)s[0];
+    int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 1;
+    if (s + len > end) len = 1;
+    if (len == 1) {
+        *cp = c;
+    } else {
+        uint32_t v = c & (0xFF >> (len + 1));
+        for (int i = 1; i < len; i++) v = (v << 6) | ((unsigned char)s[i] & 0x3F);
+        *cp = v;
+    }
+    return len;
+}
+
+// Match one path segment against one pattern segment (*, ?, [abc], [!a-z])
+static int walk_match_segment(const char *p, const char *pend, const char *t, const char *tend) {
+    while (p < pend) {
+        if (*p == '*') {
+            while (p < pend && *p == '*') p++;
+            if (p == pend) return 1;
+            for (; t <= tend; t++) {
+                if (walk_match_segment(p, pend, t, tend)) return 1;
+            }
+            return 0;
+        }
+        if (t >= tend) return 0;
+
+        uint32_t tc;
+        int tlen = walk_decode(t, tend, &tc);
+        if (*p == '?') {
+            p++;
+        } else if (*p == '[') {
+            p++;
+            int negate = 0;
+            if (p < pend && *p == '!') {
+                negate = 1;
+                p++;
+            }
+            int matched = 0;
+            int have_prev = 0;
+            uint32_t prev = 0;
+            while (p < pend && *p != ']') {
+                uint32_t c;
+                int clen = walk_decode(p, pend, &c);
+                if (c == '-' && have_prev && p + 1 < pend && p[1] != ']') {
+                    uint32_t hi;
+                    p += 1;
+                    p += walk_decode(p, pend, &hi);
+                    if (tc >= prev && tc <= hi) matched = 1;
+                    continue;
+                }
+                if (c == tc) matched = 1;
+                prev = c;
+                have_prev = 1;
+                p += clen;
+            }
+            if (p < pend) p++;  // Closing ]
+            if (matched == negate) return 0;
+        } else {
+            uint32_t pc;
+            int plen = walk_decode(p, pend, &pc);
+            if (pc != tc) return 0;
+            p += plen;
+        }
+        t += tlen;
+    }
+    return t == tend;
+}
+
+// Match path segments from ti against pattern segments from pi. With
+// prefix set, running out of path counts as a match: some entry below the
+// path could still match, so the walker descends into it.
+static int walk_match_segments(const WalkSegment *ps, int np, int pi,
+                               const WalkSegment *ts, int nt, int ti, int prefix) {
+    while (pi < np) {
+        if (ps[pi].length == 2 && ps[pi].start[0] == '*' && ps[pi].start[1] == '*') {
+            pi++;
+            if (pi >= np) return 1;
+            for (; ti <= nt; ti++) {
+                if (walk_match_segments(ps, np, pi, ts, nt, ti, prefix)) return 1;
+            }
+            return 0;
+        }
+        if (ti >= nt) return prefix;
+        if (!walk_match_segment(ps[pi].start, ps[pi].start + ps[pi].length,
+                                ts[ti].start, ts[ti].start + ts[ti].length)) {
+            return 0;
+        }
+        pi++;
+        ti++;
+    }
+    return !prefix && ti >= nt;
+}
+
+// ========== PARALLEL WALKER ==========
+
+#define WALK_MAX_SEGMENTS 256
+#define WALK_DEFAULT_THREADS 4
+#define WALK_MAX_THREADS 64
+#define WALK_DEFAULT_BATCH 1024
+
+// A directory on the path from the root to a task, shared by its subtasks
+// (follow_links only). A directory whose (dev, ino) is already on its own
+// path is a symlink loop; one reached by two unrelated paths is listed
+// under both.
+typedef struct WalkAncestor {
+    dev_t dev;
+    ino_t ino;
+    struct WalkAncestor *parent;
+    int refs;
+} WalkAncestor;
+
+typedef struct WalkTask {
+    char *rel;                  // Directory path relative to the root ("" = root)
+    int depth;
+    WalkAncestor *ancestors;    // Directories above this one; NULL at the root
+    struct WalkTask *next;
+} WalkTask;
+
+typedef struct {
+    char *pattern;              // NULL = every entry
+    WalkSegment pattern_segs[WALK_MAX_SEGMENTS];
+    int pattern_count;
+    int files;
+    int dirs;
+    int hidden;
+    int follow_links;
+    int max_depth;              // Deepest entry returned; < 0 = unlimited
+    int batch_size;
+
+    int root_fd;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;   // Tasks queued or walk finished
+    pthread_cond_t result_cond; // Results available or walk finished
+    WalkTask *queue_head;
+    WalkTask *queue_tail;
+    int active;                 // Tasks queued or being read
+    int cancelled;
+
+    char **results;
+    int result_count;
+    int result_capacity;
+
+    pthread_t *threads;
+    int num_threads;
+} DirWalk;
+
+static void walk_ancestor_release(WalkAncestor *a) {
+    while (a && __atomic_sub_fetch(&a->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        WalkAncestor *parent = a->parent;
+        free(a);
+        a = parent;
+    }
+}
+
+static void walk_task_free(WalkTask *task) {
+    walk_ancestor_release(task->ancestors);
+    free(task->rel);
+    free(task);
+}
+
+// Link the directory open on fd below the task's ancestors. Returns NULL if
+// it is already one of them (a symlink loop) or cannot be examined.
+static WalkAncestor *walk_enter(WalkTask *task, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return NULL;
+    for (WalkAncestor *a = task->ancestors; a; a = a->parent) {
+        if (a->dev == st.st_dev && a->ino == st.st_ino) return NULL;
+    }
+    WalkAncestor *self = malloc(sizeof(WalkAncestor));
+    if (!self) return NULL;
+    self->dev = st.st_dev;
+    self->ino = st.st_ino;
+    self->parent = task->ancestors;
+    self->refs = 1;
+    if (self->parent) __atomic_add_fetch(&self->parent->refs, 1, __ATOMIC_RELAXED);
+    return self;
+}
+
+// Move a worker's local results into the shared list. Called with lock held.
+static void walk_publish_locked(DirWalk *w, char **local, int *local_count) {
+    if (*local_count == 0) return;
+    if (w->result_count + *local_count > w->result_capacity) {
+        int cap = w->result_capacity ? w->result_capacity : 256;
+        while (cap < w->result_count + *local_count) cap *= 2;
+        char **grown = realloc(w->results, cap * sizeof(char *));
+        if (!grown) {
+            for (int i = 0; i < *local_count; i++) free(local[i]);
+            *local_count = 0;
+            return;
+        }
+        w->results = grown;
+        w->result_capacity = cap;
+    }
+    memcpy(w->results + w->result_count, local, *local_count * sizeof(char *));
+    w->result_count += *local_count;
+    *local_count = 0;
+    pthread_cond_signal(&w->result_cond);
+}
+
+// Read one directory: emit matching entries, return subdirectories to visit
+static WalkTask *walk_read_dir(DirWalk *w, WalkTask *task, char **local, int *local_count) {
+    int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (w->follow_links ? 0 : O_NOFOLLOW);
+    int fd = openat(w->root_fd, task->rel[0] ? task->rel : ".", flags);
+    if (fd < 0) return NULL;  // Unreadable directories are skipped
+    WalkAncestor *self = NULL;
+    if (w->follow_links && !(self = walk_enter(task, fd))) {
+        close(fd);
+        return NULL;
+    }
+    DIR *dir = fdopendir(fd);
+    if (!dir) {
+        walk_ancestor_release(self);
+        close(fd);
+        return NULL;
+    }
+
+    WalkTask *subdirs = NULL;
+    size_t rel_len = strlen(task->rel);
+    int depth = task->depth + 1;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        const char *name = de->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+        if (!w->hidden && name[0] == '.') continue;
+        if (__atomic_load_n(&w->cancelled, __ATOMIC_RELAXED)) break;
+
+        // d_type saves a stat per entry; filesystems that do not fill it
+        // in, and symlinks being followed, fall back to fstatat
+        int is_dir = 0;
+        if (de->d_type == DT_DIR) {
+            is_dir = 1;
+        } else if (de->d_type == DT_UNKNOWN || (de->d_type == DT_LNK && w->follow_links)) {
+            struct stat st;
+            if (fstatat(fd, name, &st, w->follow_links ? 0 : AT_SYMLINK_NOFOLLOW) == 0) {
+                is_dir = S_ISDIR(st.st_mode);
+            }
+        }
+
+        size_t name_len = strlen(name);
+        char *rel = malloc(rel_len + name_len + 2);
+        if (!rel) break;
+        if (rel_len > 0) {
+            memcpy(rel, task->rel, rel_len);
+            rel[rel_len] = '/';
+            memcpy(rel + rel_len + 1, name, name_len + 1);
+        } else {
+            memcpy(rel, name, name_len + 1);
+        }
+
+        WalkSegment segs[WALK_MAX_SEGMENTS];
+        int nsegs = 0;
+        if (w->pattern) {
+            nsegs = walk_split(rel, segs, WALK_MAX_SEGMENTS);
+            if (nsegs > WALK_MAX_SEGMENTS) nsegs = WALK_MAX_SEGMENTS;
+        }
+
+        int include = is_dir ? w->dirs : w->files;
+        if (include && w->pattern) {
+            include = walk_match_segments(w->pattern_segs, w->pattern_count, 0, segs, nsegs, 0, 0);
+        }
+        int descend = is_dir && (w->max_depth < 0 || depth < w->max_depth);
+        if (descend && w->pattern) {
+            descend = walk_match_segments(w->pattern_segs, w->pattern_count, 0, segs, nsegs, 0, 1);
+        }
+
+        if (descend) {
+            WalkTask *sub = malloc(sizeof(WalkTask));
+            if (sub) {
+                sub->rel = include ? strdup(rel) : rel;
+                sub->depth = depth;
+                sub->ancestors = self;
+                if (self) __atomic_add_fetch(&self->refs, 1, __ATOMIC_RELAXED);
+                sub->next = subdirs;
+                subdirs = sub;
+                if (!include) rel = NULL;
+            }
+        }
+        if (include) {
+            local[(*local_count)++] = rel;
+            if (*local_count == w->batch_size) {
+                pthread_mutex_lock(&w->lock);
+                walk_publish_locked(w, local, local_count);
+                pthread_mutex_unlock(&w->lock);
+            }
+        } else {
+            free(rel);
+        }
+    }
+    closedir(dir);
+    walk_ancestor_release(self);
+    return subdirs;
+}
+
+static void *walk_worker(void *arg) {
+    DirWalk *w = arg;
+    char **local = malloc(w->batch_size * sizeof(char *));
+    int local_count = 0;
+    if (!local) return NULL;
+
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (!w->queue_head && w->active > 0 && !w->cancelled) {
+            pthread_cond_wait(&w->work_cond, &w->lock);
+        }
+        if (w->cancelled || !w->queue_head) break;
+
+        WalkTask *task = w->queue_head;
+        w->queue_head = task->next;
+        if (!w->queue_head) w->queue_tail = NULL;
+        pthread_mutex_unlock(&w->lock);
+
+        WalkTask *subdirs = walk_read_dir(w, task, local, &local_count);
+        walk_task_free(task);
+
+        pthread_mutex_lock(&w->lock);
+        walk_publish_locked(w, local, &local_count);
+        int added = 0;
+        while (subdirs) {
+            WalkTask *next = subdirs->next;
+            subdirs->next = NULL;
+            if (w->queue_tail) w->queue_tail->next = subdirs;
+            else w->queue_head = subdirs;
+            w->queue_tail = subdirs;
+            subdirs = next;
+            added++;
+        }
+        w->active += added - 1;
+        if (added > 1 || w->active == 0) {
+            pthread_cond_broadcast(&w->work_cond);
+        } else if (added == 1) {
+            pthread_cond_signal(&w->work_cond);
+        }
+        if (w->active == 0) {
+            pthread_cond_broadcast(&w->result_cond);
+        }
+    }
+    pthread_mutex_unlock(&w->lock);
+    free(local);
+    return NULL;
+}
+
+static void walk_free(DirWalk *w) {
+    while (w->queue_head) {
+        WalkTask *next = w->queue_head->next;
+        walk_task_free(w->queue_head);
+        w->queue_head = next;
+    }
+    for (int i = 0; i < w->result_count; i++) free(w->results[i]);
+    free(w->results);
+    free(w->threads);
+    free(w->pattern);
+    if (w->root_fd >= 0) close(w->root_fd);
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->work_cond);
+    pthread_cond_destroy(&w->result_cond);
+    free(w);
+}
+
+// Start walking root on background threads. Returns NULL with errno set if
+// root cannot be opened.
+static DirWalk *walk_start(const char *root, const char *pattern, int files, int dirs, int hidden,
+                           int follow_links, int max_depth, int threads, int batch_size) {
+    DirWalk *w = calloc(1, sizeof(DirWalk));
+    if (!w) return NULL;
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->work_cond, NULL);
+    pthread_cond_init(&w->result_cond, NULL);
+    w->files = files;
+    w->dirs = dirs;
+    w->hidden = hidden;
+    w->follow_links = follow_links;
+    w->max_depth = max_depth;
+    w->batch_size = batch_size > 0 ? batch_size : WALK_DEFAULT_BATCH;
+    if (pattern) {
+        w->pattern = strdup(pattern);
+        w->pattern_count = walk_split(w->pattern, w->pattern_segs, WALK_MAX_SEGMENTS);
+        if (w->pattern_count > WALK_MAX_SEGMENTS) w->pattern_count = WALK_MAX_SEGMENTS;
+    }
+
+    w->root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (w->root_fd < 0) {
+        int err = errno;
+        walk_free(w);
+        errno = err;
+        return NULL;
+    }
+
+    WalkTask *task = malloc(sizeof(WalkTask));
+    task->rel = strdup("");
+    task->depth = 0;
+    task->ancestors = NULL;
+    task->next = NULL;
+    w->queue_head = w->queue_tail = task;
+    w->active = 1;
+
+    if (threads <= 0) threads = WALK_DEFAULT_THREADS;
+    if (threads > WALK_MAX_THREADS) threads = WALK_MAX_THREADS;
+    w->threads = malloc(threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&w->threads[w->num_threads], NULL, walk_worker, w) == 0) {
+            w->num_threads++;
+        }
+    }
+    if (w->num_threads == 0) {
+        walk_free(w);
+        errno = EAGAIN;
+        return NULL;
+    }
+    return w;
+}
+
+// Wait for the next batch of paths. Returns NULL when the walk is done.
+static char **walk_next(DirWalk *w, int *count) {
+    pthread_mutex_lock(&w->lock);
+    while (w->result_count == 0 && w->active > 0 && !w->cancelled) {
+        pthread_cond_wait(&w->result_cond, &w->lock);
+    }
+    int n = w->result_count < w->batch_size ? w->result_count : w->batch_size;
+    char **batch = NULL;
+    if (n > 0) {
+        batch = malloc(n * sizeof(char *));
+        if (batch) {
+            w->result_count -= n;
+            memcpy(batch, w->results + w->result_count, n * sizeof(char *));
+        } else {
+            n = 0;
+        }
+    }
+    pthread_mutex_unlock(&w->lock);
+    *count = n;
+    return batch;
+}
+
+// Stop the workers and free the walk
+static void walk_finish(DirWalk *w) {
+    pthread_mutex_lock(&w->lock);
+    w->cancelled = 1;
+    pthread_cond_broadcast(&w->work_cond);
+    pthread_mutex_unlock(&w->lock);
+    for (int i = 0; i < w->num_threads; i++) {
+        pthread_join(w->threads[i], NULL);
+    }
+    walk_free(w);
+}
+
+static int walk_compare(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// ========== BUILTINS ==========
+
+static Value walk_option(Value options, const char *name) {
+    if (options.type != VAL_OBJECT) return val_null();
+    Object *obj = options.as.as_object;
+    int idx = object_lookup_field(obj, name);
+    return idx >= 0 ? obj->field_values[idx] : val_null();
+}
+
+static int walk_bool_option(Value options, const char *name, int def) {
+    Value v = walk_option(options, name);
+    return v.type == VAL_BOOL ? v.as.as_bool : def;
+}
+
+static int walk_int_option(Value options, const char *name, int def) {
+    Value v = walk_option(options, name);
+    return is_integer(v) ? value_to_int(v) : def;
+}
+
+// Parse (root, options) and start a walk; NULL with an exception set on error
+static DirWalk *walk_begin(const char *fn_name, Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args < 1 || num_args > 2 || args[0].type != VAL_STRING) {
+        runtime_error(ctx, "%s() expects (root, [options])", fn_name);
+        return NULL;
+    }
+    Value options = num_args == 2 ? args[1] : val_null();
+    if (options.type != VAL_NULL && options.type != VAL_OBJECT) {
+        runtime_error(ctx, "%s() options must be an object", fn_name);
+        return NULL;
+    }
+
+    const char *root = args[0].as.as_string->data;
+    if (!sandbox_path_allowed(ctx, root, 0)) {
+        sandbox_error(ctx, "directory listing outside sandbox root");
+        return NULL;
+    }
+
+    Value pattern = walk_option(options, "pattern");
+    if (pattern.type != VAL_NULL && pattern.type != VAL_STRING) {
+        runtime_error(ctx, "%s() pattern must be a string", fn_name);
+        return NULL;
+    }
+
+    DirWalk *w = walk_start(root,
+                            pattern.type == VAL_STRING ? pattern.as.as_string->data : NULL,
+                            walk_bool_option(options, "files", 1),
+                            walk_bool_option(options, "dirs", 1),
+                            walk_bool_option(options, "hidden", 1),
+                            walk_bool_option(options, "follow_links", 0),
+                            walk_int_option(options, "max_depth", -1),
+                            walk_int_option(options, "threads", WALK_DEFAULT_THREADS),
+                            walk_int_option(options, "batch_size", WALK_DEFAULT_BATCH));
+    if (!w) {
+        runtime_error(ctx, "Failed to open directory '%s': %s", root, strerror(errno));
+    }
+    return w;
+}
+
+static Value walk_batch_array(char **paths, int count) {
+    Array *arr = array_new();
+    for (int i = 0; i < count; i++) {
+        Value path = val_string_take(paths[i], strlen(paths[i]), strlen(paths[i]) + 1);
+        array_push(arr, path);
+        value_release(path);
+    }
+    return val_array(arr);
+}
+
+// __walk_dir(root, options) - every matching path under root, sorted
+Value builtin_walk_dir(Value *args, int num_args, ExecutionContext *ctx) {
+    DirWalk *w = walk_begin("walk_dir", args, num_args, ctx);
+    if (!w) return val_null();
+
+    char **all = NULL;
+    int total = 0;
+    int capacity = 0;
+    char **batch;
+    int count;
+    while ((batch = walk_next(w, &count)) != NULL) {
+        if (total + count > capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            while (capacity < total + count) capacity *= 2;
+            all = realloc(all, capacity * sizeof(char *));
+        }
+        memcpy(all + total, batch, count * sizeof(char *));
+        total += count;
+        free(batch);
+    }
+    walk_finish(w);
+
+    qsort(all, total, sizeof(char *), walk_compare);
+    Value result = walk_batch_array(all, total);
+    free(all);
+    return result;
+}
+
+// __walk_open(root, options) - start a walk, returns a handle for __walk_next
+Value builtin_walk_open(Value *args, int num_args, ExecutionContext *ctx) {
+    DirWalk *w = walk_begin("walk_open", args, num_args, ctx);
+    if (!w) return val_null();
+    return val_ptr(w);
+}
+
+// __walk_next(handle) - next batch of paths (unordered), or null when done
+Value builtin_walk_next(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_PTR || !args[0].as.as_ptr) {
+        runtime_error(ctx, "walk_next() expects a walk handle");
+        return val_null();
+    }
+    int count;
+    char **batch = walk_next(args[0].as.as_ptr, &count);
+    if (!batch) return val_null();
+    Value result = walk_batch_array(batch, count);
+    free(batch);
+    return result;
+}
+
+// __walk_close(handle) - stop the walk and free it
+Value builtin_walk_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_PTR || !args[0].as.as_ptr) {
+        runtime_error(ctx, "walk_close() expects a walk handle");
+        return val_null();
+    }
+    walk_finish(args[0].as.as_ptr);
+    return val_null();
+}
@@ -42,6 +42,8 @@ void websocket_release(WebSocketHandle *ws) {
 
 #include <libwebsockets.h>
 #include <pthread.h>
+#include <errno.h>
+#include <time.h>
 
 // Suppress libwebsockets startup messages by default
 // Set LWS_VERBOSE=1 environment variable to enable verbose logging
@@ -297,13 +299,13 @@ Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx) {
     lws_init_logging();
 
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_http_get() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_STRING) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_http_get() expects string URL");
         return val_null();
     }
@@ -313,14 +315,14 @@ Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx) {
     int port, ssl;
 
     if (parse_url(url, host, &port, path, &ssl) < 0) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Invalid URL format");
         return val_null();
     }
 
     http_response_t *resp = calloc(1, sizeof(http_response_t));
     if (!resp) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate response");
         return val_null();
     }
@@ -329,7 +331,7 @@ Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx) {
     resp->body = malloc(resp->body_capacity);
     if (!resp->body) {
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate body buffer");
         return val_null();
     }
@@ -351,7 +353,7 @@ Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx) {
     if (!context) {
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create libwebsockets context");
         return val_null();
     }
@@ -385,7 +387,7 @@ Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx) {
         lws_context_destroy(context);
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to connect");
         return val_null();
     }
@@ -401,7 +403,7 @@ Value builtin_lws_http_get(Value *args, int num_args, ExecutionContext *ctx) {
     if (resp->failed || timeout <= 0) {
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("HTTP request failed or timed out");
         return val_null();
     }
@@ -420,13 +422,13 @@ Value builtin_lws_http_post(Value *args, int num_args, ExecutionContext *ctx) {
     lws_init_logging();
 
     if (num_args != 3) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_http_post() expects 3 arguments");
         return val_null();
     }
 
     if (args[0].type != VAL_STRING || args[1].type != VAL_STRING || args[2].type != VAL_STRING) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_http_post() expects string arguments");
         return val_null();
     }
@@ -439,14 +441,14 @@ Value builtin_lws_http_post(Value *args, int num_args, ExecutionContext *ctx) {
     int port, ssl;
 
     if (parse_url(url, host, &port, path, &ssl) < 0) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Invalid URL format");
         return val_null();
     }
 
     http_response_t *resp = calloc(1, sizeof(http_response_t));
     if (!resp) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate response");
         return val_null();
     }
@@ -455,7 +457,7 @@ Value builtin_lws_http_post(Value *args, int num_args, ExecutionContext *ctx) {
     resp->body = malloc(resp->body_capacity);
     if (!resp->body) {
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate body buffer");
         return val_null();
     }
@@ -477,7 +479,7 @@ Value builtin_lws_http_post(Value *args, int num_args, ExecutionContext *ctx) {
     if (!context) {
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create libwebsockets context");
         return val_null();
     }
@@ -516,7 +518,7 @@ Value builtin_lws_http_post(Value *args, int num_args, ExecutionContext *ctx) {
         lws_context_destroy(context);
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to connect");
         return val_null();
     }
@@ -532,7 +534,7 @@ Value builtin_lws_http_post(Value *args, int num_args, ExecutionContext *ctx) {
     if (resp->failed || timeout <= 0) {
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("HTTP request failed or timed out");
         return val_null();
     }
@@ -552,14 +554,14 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
     lws_init_logging();
 
     if (num_args != 4) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_http_request() expects 4 arguments (method, url, body, content_type)");
         return val_null();
     }
 
     if (args[0].type != VAL_STRING || args[1].type != VAL_STRING ||
         args[2].type != VAL_STRING || args[3].type != VAL_STRING) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_http_request() expects string arguments");
         return val_null();
     }
@@ -573,14 +575,14 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
     int port, ssl;
 
     if (parse_url(url, host, &port, path, &ssl) < 0) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Invalid URL format");
         return val_null();
     }
 
     http_response_t *resp = calloc(1, sizeof(http_response_t));
     if (!resp) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate response");
         return val_null();
     }
@@ -589,7 +591,7 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
     resp->body = malloc(resp->body_capacity);
     if (!resp->body) {
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate body buffer");
         return val_null();
     }
@@ -611,7 +613,7 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
     if (!context) {
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create libwebsockets context");
         return val_null();
     }
@@ -649,7 +651,7 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
         lws_context_destroy(context);
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to connect");
         return val_null();
     }
@@ -665,7 +667,7 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
     if (resp->failed || timeout <= 0) {
         free(resp->body);
         free(resp);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("HTTP request failed or timed out");
         return val_null();
     }
@@ -676,13 +678,13 @@ Value builtin_lws_http_request(Value *args, int num_args, ExecutionContext *ctx)
 // __lws_response_status(resp: ptr): i32
 Value builtin_lws_response_status(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_status() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_PTR) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_status() expects ptr");
         return val_null();
     }
@@ -698,13 +700,13 @@ Value builtin_lws_response_status(Value *args, int num_args, ExecutionContext *c
 // __lws_response_body(resp: ptr): string
 Value builtin_lws_response_body(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_body() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_PTR) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_body() expects ptr");
         return val_null();
     }
@@ -721,13 +723,13 @@ Value builtin_lws_response_body(Value *args, int num_args, ExecutionContext *ctx
 // Returns the response body as a binary buffer (preserves null bytes)
 Value builtin_lws_response_body_binary(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_body_binary() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_PTR) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_body_binary() expects ptr");
         return val_null();
     }
@@ -735,9 +737,9 @@ Value builtin_lws_response_body_binary(Value *args, int num_args, ExecutionConte
     http_response_t *resp = (http_response_t *)args[0].as.as_ptr;
     if (!resp || !resp->body || resp->body_len == 0) {
         // Return empty buffer
-        Buffer *buf = malloc(sizeof(Buffer));
+        Buffer *buf = slab_alloc(sizeof(Buffer));
         if (!buf) {
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             ctx->exception_state.exception_value = val_string("Memory allocation failed");
             return val_null();
         }
@@ -746,21 +748,23 @@ Value builtin_lws_response_body_binary(Value *args, int num_args, ExecutionConte
         buf->capacity = 1;
         buf->ref_count = 1;
         atomic_store(&buf->freed, 0);
+        buf->mapped = 0;
+        HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
         return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
     }
 
     // Create buffer with full binary data
-    Buffer *buf = malloc(sizeof(Buffer));
+    Buffer *buf = slab_alloc(sizeof(Buffer));
     if (!buf) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Memory allocation failed");
         return val_null();
     }
 
     buf->data = malloc(resp->body_len);
     if (!buf->data) {
-        free(buf);
-        ctx->exception_state.is_throwing = 1;
+        slab_free(buf, sizeof(Buffer));
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Memory allocation failed");
         return val_null();
     }
@@ -770,20 +774,22 @@ Value builtin_lws_response_body_binary(Value *args, int num_args, ExecutionConte
     buf->capacity = resp->body_len;
     buf->ref_count = 1;
     atomic_store(&buf->freed, 0);
+    buf->mapped = 0;
 
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
     return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
 }
 
 // __lws_response_headers(resp: ptr): string
 Value builtin_lws_response_headers(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_headers() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_PTR) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_headers() expects ptr");
         return val_null();
     }
@@ -799,13 +805,13 @@ Value builtin_lws_response_headers(Value *args, int num_args, ExecutionContext *
 // __lws_response_redirect(resp: ptr): string
 Value builtin_lws_response_redirect(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_redirect() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_PTR) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_redirect() expects ptr");
         return val_null();
     }
@@ -821,13 +827,13 @@ Value builtin_lws_response_redirect(Value *args, int num_args, ExecutionContext
 // __lws_response_free(resp: ptr): null
 Value builtin_lws_response_free(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_free() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_PTR) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_response_free() expects ptr");
         return val_null();
     }
@@ -843,6 +849,791 @@ Value builtin_lws_response_free(Value *args, int num_args, ExecutionContext *ctx
     return val_null();
 }
 
+// ========== POOLED HTTP CLIENT ==========
+//
+// An HttpClient owns one lws context and one service thread. Every request
+// made through it runs on that thread, so TLS sessions cached by the
+// context are reused and several requests can be on the wire at once.
+// Requests are pipelined onto an idle kept-alive connection to their host
+// when there is one (LCCSCF_PIPELINE). At most max_per_host run against a
+// host at a time; the rest wait in the client's queue.
+//
+// A streamed request (__lws_http_stream_open) hands its body to the reader
+// in chunks instead of collecting it. Once HTTP_STREAM_HIGH_WATER bytes are
+// queued the connection stops reading (lws_rx_flow_control) until the
+// reader drains the queue below HTTP_STREAM_LOW_WATER, so a download of any
+// size holds at most about a megabyte.
+//
+// Each wait - for a response, for a stream's headers, or for the next piece
+// of a streamed body - gives up after the client's timeout_ms.
+
+#define HTTP_STREAM_HIGH_WATER (1024 * 1024)
+#define HTTP_STREAM_LOW_WATER (256 * 1024)
+
+typedef struct http_client http_client_t;
+
+typedef struct http_host {
+    char name[256];
+    int port;
+    int ssl;
+    int active;                 // Requests started and not yet finished
+    struct http_host *next;
+} http_host_t;
+
+typedef struct http_chunk {
+    size_t len;
+    size_t offset;              // Bytes already handed to the reader
+    struct http_chunk *next;
+    char data[];
+} http_chunk_t;
+
+typedef struct http_job {
+    http_client_t *client;
+    http_host_t *host;
+    char path[512];
+    char method[16];
+    char *body;
+    size_t body_len;
+    char *content_type;
+    http_response_t *resp;
+    int connecting;             // Inside lws_client_connect_via_info()
+    int body_sent;
+    int done;
+    int abandoned;              // The waiter gave up; whoever finishes frees it
+    struct http_job *next;      // Pending queue link
+
+    // Streamed requests only
+    int streaming;
+    int headers_ready;
+    int paused;                 // Reading is off until the reader catches up
+    int cancelled;              // The reader closed the stream early
+    int readers;                // Threads waiting in __lws_http_stream_read()
+    struct lws *wsi;            // Service thread only
+    http_chunk_t *chunks_head;
+    http_chunk_t *chunks_tail;
+    size_t queued;
+    struct http_job *stream_next;  // Link in the client's live streams
+} http_job_t;
+
+struct http_client {
+    struct lws_context *context;
+    pthread_t service_thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t done_cond;
+    volatile int shutdown;
+    int max_per_host;
+    int timeout_ms;             // Limit on each wait for response data
+    http_job_t *pending_head;
+    http_job_t *pending_tail;
+    http_job_t *streams;        // Streamed requests still on the wire
+    http_host_t *hosts;
+};
+
+static void http_response_free(http_response_t *resp) {
+    if (!resp) return;
+    free(resp->body);
+    free(resp->redirect_url);
+    free(resp->headers);
+    free(resp);
+}
+
+static void http_job_free(http_job_t *job) {
+    http_chunk_t *chunk = job->chunks_head;
+    while (chunk) {
+        http_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    http_response_free(job->resp);
+    free(job->body);
+    free(job->content_type);
+    free(job);
+}
+
+// Called on the service thread once a request has a final outcome
+static void http_job_finish(http_job_t *job, struct lws *wsi) {
+    if (wsi) {
+        // Later callbacks for this transaction must not touch the job
+        lws_set_wsi_user(wsi, NULL);
+    }
+    http_client_t *client = job->client;
+    pthread_mutex_lock(&client->mutex);
+    if (job->done) {
+        pthread_mutex_unlock(&client->mutex);
+        return;
+    }
+    job->done = 1;
+    job->host->active--;
+    if (job->streaming) {
+        job->wsi = NULL;
+        http_job_t **link = &client->streams;
+        while (*link && *link != job) link = &(*link)->stream_next;
+        if (*link) *link = job->stream_next;
+    }
+    int release = job->abandoned && !job->connecting;
+    pthread_cond_broadcast(&client->done_cond);
+    pthread_mutex_unlock(&client->mutex);
+    if (release) {
+        http_job_free(job);
+    }
+    // A slot on this host is free again
+    if (!client->shutdown) {
+        lws_cancel_service(client->context);
+    }
+}
+
+// Start every queued request whose host is below its connection limit
+static void http_client_start_pending(http_client_t *client) {
+    for (;;) {
+        pthread_mutex_lock(&client->mutex);
+        http_job_t *prev = NULL;
+        http_job_t *job = client->pending_head;
+        while (job && job->host->active >= client->max_per_host) {
+            prev = job;
+            job = job->next;
+        }
+        if (!job || client->shutdown) {
+            pthread_mutex_unlock(&client->mutex);
+            return;
+        }
+        if (prev) prev->next = job->next;
+        else client->pending_head = job->next;
+        if (client->pending_tail == job) client->pending_tail = prev;
+        job->next = NULL;
+        // The first request to a host may reuse an idle kept-alive
+        // connection; requests beyond it open connections of their own
+        int reuse = job->host->active == 0;
+        job->host->active++;
+        job->connecting = 1;
+        if (job->streaming) {
+            job->stream_next = client->streams;
+            client->streams = job;
+        }
+        pthread_mutex_unlock(&client->mutex);
+
+        struct lws_client_connect_info connect_info;
+        memset(&connect_info, 0, sizeof(connect_info));
+        connect_info.context = client->context;
+        connect_info.address = job->host->name;
+        connect_info.port = job->host->port;
+        connect_info.path = job->path;
+        connect_info.host = job->host->name;
+        connect_info.origin = job->host->name;
+        connect_info.method = job->method;
+        connect_info.protocol = "http";
+        connect_info.userdata = job;
+
+        // Redirects are followed at the hemlock layer
+        connect_info.ssl_connection = LCCSCF_HTTP_NO_FOLLOW_REDIRECT;
+        if (reuse) {
+            connect_info.ssl_connection |= LCCSCF_PIPELINE;
+        }
+        if (job->host->ssl) {
+            connect_info.ssl_connection |= LCCSCF_USE_SSL;
+        }
+
+        struct lws *wsi = lws_client_connect_via_info(&connect_info);
+
+        pthread_mutex_lock(&client->mutex);
+        job->connecting = 0;
+        int finished = job->done;
+        int release = finished && job->abandoned;
+        pthread_mutex_unlock(&client->mutex);
+        if (release) {
+            http_job_free(job);
+        } else if (!wsi && !finished) {
+            job->resp->failed = 1;
+            http_job_finish(job, NULL);
+        }
+    }
+}
+
+// Queue a received chunk for the reader; stop reading when it falls behind
+static int http_stream_push(http_job_t *job, struct lws *wsi, const void *data, size_t len) {
+    http_client_t *client = job->client;
+    http_chunk_t *chunk = malloc(sizeof(http_chunk_t) + len);
+    if (!chunk) {
+        job->resp->failed = 1;
+        return -1;
+    }
+    memcpy(chunk->data, data, len);
+    chunk->len = len;
+    chunk->offset = 0;
+    chunk->next = NULL;
+
+    job->wsi = wsi;
+    pthread_mutex_lock(&client->mutex);
+    // The reader sets cancelled under the mutex from its own thread
+    if (job->cancelled) {
+        pthread_mutex_unlock(&client->mutex);
+        free(chunk);
+        return -1;
+    }
+    if (job->chunks_tail) job->chunks_tail->next = chunk;
+    else job->chunks_head = chunk;
+    job->chunks_tail = chunk;
+    job->queued += len;
+    if (job->queued >= HTTP_STREAM_HIGH_WATER && !job->paused) {
+        job->paused = 1;
+        lws_rx_flow_control(wsi, 0);
+    }
+    pthread_cond_broadcast(&client->done_cond);
+    pthread_mutex_unlock(&client->mutex);
+    return 0;
+}
+
+// Resume streams whose reader caught up and drop those it closed
+static void http_client_service_streams(http_client_t *client) {
+    pthread_mutex_lock(&client->mutex);
+    for (http_job_t *job = client->streams; job; job = job->stream_next) {
+        if (!job->wsi) continue;
+        if (job->cancelled) {
+            lws_set_timeout(job->wsi, PENDING_TIMEOUT_USER_OK, LWS_TO_KILL_ASYNC);
+        } else if (job->paused && job->queued <= HTTP_STREAM_LOW_WATER) {
+            job->paused = 0;
+            lws_rx_flow_control(job->wsi, 1);
+        }
+    }
+    pthread_mutex_unlock(&client->mutex);
+}
+
+static int http_client_callback(struct lws *wsi, enum lws_callback_reasons reason,
+                                void *user, void *in, size_t len) {
+    http_job_t *job = (http_job_t *)user;
+
+    switch (reason) {
+        case LWS_CALLBACK_EVENT_WAIT_CANCELLED: {
+            // Woken by a submit, a finished request or a stream reader
+            http_client_t *client = (http_client_t *)lws_context_user(lws_get_context(wsi));
+            if (client) {
+                http_client_service_streams(client);
+                http_client_start_pending(client);
+            }
+            return 0;
+        }
+
+        case LWS_CALLBACK_ESTABLISHED_CLIENT_HTTP:
+            if (!job) return 0;
+            http_callback(wsi, reason, job->resp, in, len);
+            if (job->streaming) {
+                job->wsi = wsi;
+                pthread_mutex_lock(&job->client->mutex);
+                job->headers_ready = 1;
+                pthread_cond_broadcast(&job->client->done_cond);
+                pthread_mutex_unlock(&job->client->mutex);
+            }
+            return 0;
+
+        case LWS_CALLBACK_RECEIVE_CLIENT_HTTP_READ:
+            if (job && job->streaming) {
+                return http_stream_push(job, wsi, in, len);
+            }
+            return http_callback(wsi, reason, job ? job->resp : NULL, in, len);
+
+        case LWS_CALLBACK_CLIENT_APPEND_HANDSHAKE_HEADER:
+            if (!job) return 0;
+            http_callback(wsi, reason, job->resp, in, len);
+            if (job->body_len > 0) {
+                unsigned char **p = (unsigned char **)in;
+                unsigned char *end = (*p) + len;
+                char length[32];
+                snprintf(length, sizeof(length), "%zu", job->body_len);
+                if (lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_CONTENT_TYPE,
+                        (unsigned char *)job->content_type, (int)strlen(job->content_type), p, end) ||
+                    lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_CONTENT_LENGTH,
+                        (unsigned char *)length, (int)strlen(length), p, end)) {
+                    return -1;
+                }
+                lws_client_http_body_pending(wsi, 1);
+                lws_callback_on_writable(wsi);
+            }
+            return 0;
+
+        case LWS_CALLBACK_CLIENT_HTTP_WRITEABLE:
+            if (job && job->body_len > 0 && !job->body_sent) {
+                unsigned char *buf = malloc(LWS_PRE + job->body_len);
+                if (!buf) return -1;
+                memcpy(buf + LWS_PRE, job->body, job->body_len);
+                job->body_sent = 1;
+                lws_client_http_body_pending(wsi, 0);
+                int n = lws_write(wsi, buf + LWS_PRE, job->body_len, LWS_WRITE_HTTP_FINAL);
+                free(buf);
+                if (n < 0) return -1;
+            }
+            return 0;
+
+        case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+        case LWS_CALLBACK_COMPLETED_CLIENT_HTTP:
+        case LWS_CALLBACK_CLOSED_CLIENT_HTTP:
+            if (!job) return 0;
+            http_callback(wsi, reason, job->resp, in, len);
+            http_job_finish(job, wsi);
+            return 0;
+
+        default:
+            return http_callback(wsi, reason, job ? job->resp : NULL, in, len);
+    }
+}
+
+static void *http_client_service_thread(void *arg) {
+    http_client_t *client = (http_client_t *)arg;
+    while (!client->shutdown) {
+        lws_service(client->context, 50);
+    }
+    return NULL;
+}
+
+static http_host_t *http_client_host(http_client_t *client, const char *name, int port, int ssl) {
+    for (http_host_t *host = client->hosts; host; host = host->next) {
+        if (host->port == port && host->ssl == ssl && strcmp(host->name, name) == 0) {
+            return host;
+        }
+    }
+    http_host_t *host = calloc(1, sizeof(http_host_t));
+    if (!host) return NULL;
+    snprintf(host->name, sizeof(host->name), "%s", name);
+    host->port = port;
+    host->ssl = ssl;
+    host->next = client->hosts;
+    client->hosts = host;
+    return host;
+}
+
+// When a wait that starts now times out
+static void http_client_deadline(http_client_t *client, struct timespec *deadline) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += client->timeout_ms / 1000;
+    deadline->tv_nsec += (long)(client->timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+static void http_client_throw(ExecutionContext *ctx, const char *message) {
+    ctx->flow.is_throwing = 1;
+    ctx->exception_state.exception_value = val_string(message);
+}
+
+// __lws_http_client_new(max_per_host: i32, timeout_ms: i32): ptr
+Value builtin_lws_http_client_new(Value *args, int num_args, ExecutionContext *ctx) {
+    if (sandbox_is_restricted(ctx, HML_SANDBOX_RESTRICT_NETWORK)) {
+        sandbox_error(ctx, "HTTP requests");
+        return val_null();
+    }
+
+    lws_init_logging();
+
+    if (num_args != 2 || !is_integer(args[0]) || !is_integer(args[1])) {
+        http_client_throw(ctx, "__lws_http_client_new() expects 2 integer arguments (max_per_host, timeout_ms)");
+        return val_null();
+    }
+    if (value_to_int(args[1]) <= 0) {
+        http_client_throw(ctx, "HttpClient timeout_ms must be positive");
+        return val_null();
+    }
+
+    http_client_t *client = calloc(1, sizeof(http_client_t));
+    if (!client) {
+        http_client_throw(ctx, "Failed to allocate HTTP client");
+        return val_null();
+    }
+    client->max_per_host = value_to_int(args[0]);
+    if (client->max_per_host < 1) client->max_per_host = 1;
+    client->timeout_ms = value_to_int(args[1]);
+
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.options = LWS_SERVER_OPTION_DO_SSL_GLOBAL_INIT;
+    info.port = CONTEXT_PORT_NO_LISTEN;
+    info.max_http_header_data = 16384;  // 16KB for large headers (e.g., GitHub API)
+    info.user = client;
+
+    static const struct lws_protocols protocols[] = {
+        { "http", http_client_callback, 0, 16384, 0, NULL, 0 },
+        { NULL, NULL, 0, 0, 0, NULL, 0 }
+    };
+    info.protocols = protocols;
+
+    client->context = lws_create_context(&info);
+    if (!client->context) {
+        free(client);
+        http_client_throw(ctx, "Failed to create libwebsockets context");
+        return val_null();
+    }
+
+    pthread_mutex_init(&client->mutex, NULL);
+    pthread_cond_init(&client->done_cond, NULL);
+    if (pthread_create(&client->service_thread, NULL, http_client_service_thread, client) != 0) {
+        lws_context_destroy(client->context);
+        pthread_mutex_destroy(&client->mutex);
+        pthread_cond_destroy(&client->done_cond);
+        free(client);
+        http_client_throw(ctx, "Failed to start HTTP client thread");
+        return val_null();
+    }
+
+    return val_ptr(client);
+}
+
+// Build a request and put it on the client's queue; NULL with *error set on failure
+static http_job_t *http_client_queue(http_client_t *client, const char *method, const char *url,
+                                     const char *body, size_t body_len, const char *content_type,
+                                     int streaming, const char **error) {
+    char host[256], path[512];
+    int port, ssl;
+
+    if (strlen(method) >= sizeof(((http_job_t *)0)->method)) {
+        *error = "HTTP method too long";
+        return NULL;
+    }
+    if (parse_url(url, host, &port, path, &ssl) < 0) {
+        *error = "Invalid URL format";
+        return NULL;
+    }
+
+    *error = "Failed to allocate request";
+    http_job_t *job = calloc(1, sizeof(http_job_t));
+    http_response_t *resp = calloc(1, sizeof(http_response_t));
+    if (!job || !resp) {
+        free(job);
+        free(resp);
+        return NULL;
+    }
+    job->client = client;
+    job->resp = resp;
+    job->streaming = streaming;
+    snprintf(job->path, sizeof(job->path), "%s", path);
+    snprintf(job->method, sizeof(job->method), "%s", method);
+    job->body_len = body_len;
+    job->body = body_len > 0 ? strndup(body, body_len) : NULL;
+    job->content_type = strdup(content_type);
+    resp->body_capacity = 4096;
+    resp->body = malloc(resp->body_capacity);
+    if ((body_len > 0 && !job->body) || !job->content_type || !resp->body) {
+        http_job_free(job);
+        return NULL;
+    }
+    resp->body[0] = '\0';
+
+    pthread_mutex_lock(&client->mutex);
+    job->host = http_client_host(client, host, port, ssl);
+    if (!job->host || client->shutdown) {
+        if (client->shutdown) *error = "HTTP client is closed";
+        pthread_mutex_unlock(&client->mutex);
+        http_job_free(job);
+        return NULL;
+    }
+    if (client->pending_tail) client->pending_tail->next = job;
+    else client->pending_head = job;
+    client->pending_tail = job;
+    pthread_mutex_unlock(&client->mutex);
+
+    // The service thread starts it from LWS_CALLBACK_EVENT_WAIT_CANCELLED
+    lws_cancel_service(client->context);
+    return job;
+}
+
+// Give up on an unfinished request: a queued one is freed now, one on the
+// wire is freed by the service thread when it finishes. Called with the
+// client's mutex held; releases it.
+static void http_job_abandon(http_job_t *job) {
+    http_client_t *client = job->client;
+    http_job_t *prev = NULL;
+    http_job_t *it = client->pending_head;
+    while (it && it != job) {
+        prev = it;
+        it = it->next;
+    }
+    if (it) {
+        if (prev) prev->next = job->next;
+        else client->pending_head = job->next;
+        if (client->pending_tail == job) client->pending_tail = prev;
+        pthread_mutex_unlock(&client->mutex);
+        http_job_free(job);
+        return;
+    }
+    job->abandoned = 1;
+    pthread_mutex_unlock(&client->mutex);
+}
+
+// __lws_http_client_submit(client: ptr, method: string, url: string, body: string, content_type: string): ptr
+// Queues a request and returns at once; __lws_http_client_wait() collects it
+Value builtin_lws_http_client_submit(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 5 || args[0].type != VAL_PTR || !args[0].as.as_ptr ||
+        args[1].type != VAL_STRING || args[2].type != VAL_STRING ||
+        args[3].type != VAL_STRING || args[4].type != VAL_STRING) {
+        http_client_throw(ctx, "__lws_http_client_submit() expects (client, method, url, body, content_type)");
+        return val_null();
+    }
+
+    const char *error;
+    http_job_t *job = http_client_queue((http_client_t *)args[0].as.as_ptr,
+                                        args[1].as.as_string->data, args[2].as.as_string->data,
+                                        args[3].as.as_string->data, args[3].as.as_string->length,
+                                        args[4].as.as_string->data, 0, &error);
+    if (!job) {
+        http_client_throw(ctx, error);
+        return val_null();
+    }
+    return val_ptr(job);
+}
+
+// __lws_http_client_wait(request: ptr): ptr
+// Blocks until a submitted request finishes; returns a response for the
+// __lws_response_* accessors
+Value builtin_lws_http_client_wait(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_PTR || !args[0].as.as_ptr) {
+        http_client_throw(ctx, "__lws_http_client_wait() expects 1 argument (request)");
+        return val_null();
+    }
+
+    http_job_t *job = (http_job_t *)args[0].as.as_ptr;
+    http_client_t *client = job->client;
+
+    struct timespec deadline;
+    http_client_deadline(client, &deadline);
+
+    pthread_mutex_lock(&client->mutex);
+    int rc = 0;
+    while (!job->done && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&client->done_cond, &client->mutex, &deadline);
+    }
+    if (!job->done) {
+        http_job_abandon(job);
+        http_client_throw(ctx, "HTTP request failed or timed out");
+        return val_null();
+    }
+    pthread_mutex_unlock(&client->mutex);
+
+    http_response_t *resp = job->resp;
+    job->resp = NULL;
+    http_job_free(job);
+    if (resp->failed) {
+        http_response_free(resp);
+        http_client_throw(ctx, "HTTP request failed or timed out");
+        return val_null();
+    }
+    return val_ptr(resp);
+}
+
+// Free a closed stream, or leave it to the service thread if it is still on
+// the wire. Called with the client's mutex held; releases it.
+static void http_stream_free(http_job_t *job) {
+    http_client_t *client = job->client;
+    if (job->done) {
+        pthread_mutex_unlock(&client->mutex);
+        http_job_free(job);
+        return;
+    }
+    http_job_abandon(job);
+    lws_cancel_service(client->context);
+}
+
+// Stop a streamed request. A reader blocked on another thread is woken and
+// frees the job on its way out; otherwise it is freed here.
+static void http_stream_release(http_job_t *job) {
+    http_client_t *client = job->client;
+    pthread_mutex_lock(&client->mutex);
+    job->cancelled = 1;
+    if (job->readers > 0) {
+        pthread_cond_broadcast(&client->done_cond);
+        pthread_mutex_unlock(&client->mutex);
+        lws_cancel_service(client->context);
+        return;
+    }
+    http_stream_free(job);
+}
+
+// __lws_http_stream_open(client: ptr, method: string, url: string, body: string, content_type: string): object
+// Starts a streamed request and waits for its response headers. Returns
+// { handle, status_code, headers, redirect }; read the body with
+// __lws_http_stream_read(handle, max) and finish with __lws_http_stream_close(handle).
+Value builtin_lws_http_stream_open(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 5 || args[0].type != VAL_PTR || !args[0].as.as_ptr ||
+        args[1].type != VAL_STRING || args[2].type != VAL_STRING ||
+        args[3].type != VAL_STRING || args[4].type != VAL_STRING) {
+        http_client_throw(ctx, "__lws_http_stream_open() expects (client, method, url, body, content_type)");
+        return val_null();
+    }
+
+    http_client_t *client = (http_client_t *)args[0].as.as_ptr;
+    const char *error;
+    http_job_t *job = http_client_queue(client, args[1].as.as_string->data, args[2].as.as_string->data,
+                                        args[3].as.as_string->data, args[3].as.as_string->length,
+                                        args[4].as.as_string->data, 1, &error);
+    if (!job) {
+        http_client_throw(ctx, error);
+        return val_null();
+    }
+
+    struct timespec deadline;
+    http_client_deadline(client, &deadline);
+
+    pthread_mutex_lock(&client->mutex);
+    int rc = 0;
+    while (!job->headers_ready && !job->done && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&client->done_cond, &client->mutex, &deadline);
+    }
+    int ready = job->headers_ready && !job->resp->failed;
+    pthread_mutex_unlock(&client->mutex);
+    if (!ready) {
+        http_stream_release(job);
+        http_client_throw(ctx, "HTTP request failed or timed out");
+        return val_null();
+    }
+
+    // Headers are written once, before headers_ready is set
+    http_response_t *resp = job->resp;
+    Object *result = object_new(NULL, 4);
+    result->field_names[0] = strdup("handle");
+    result->field_values[0] = val_ptr(job);
+    result->field_names[1] = strdup("status_code");
+    result->field_values[1] = val_i32(resp->status_code);
+    result->field_names[2] = strdup("headers");
+    result->field_values[2] = val_string(resp->headers ? resp->headers : "");
+    result->field_names[3] = strdup("redirect");
+    result->field_values[3] = resp->redirect_url ? val_string(resp->redirect_url) : val_null();
+    result->num_fields = 4;
+    return val_object(result);
+}
+
+// __lws_http_stream_read(handle: ptr, max: i32): buffer
+// Waits for body data and returns up to max bytes; an empty buffer means
+// the body is complete
+Value builtin_lws_http_stream_read(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 2 || args[0].type != VAL_PTR || !args[0].as.as_ptr || !is_integer(args[1])) {
+        http_client_throw(ctx, "__lws_http_stream_read() expects (handle, max)");
+        return val_null();
+    }
+
+    http_job_t *job = (http_job_t *)args[0].as.as_ptr;
+    http_client_t *client = job->client;
+    int max = value_to_int(args[1]);
+    if (max <= 0) {
+        http_client_throw(ctx, "__lws_http_stream_read() max must be positive");
+        return val_null();
+    }
+
+    struct timespec deadline;
+    http_client_deadline(client, &deadline);
+
+    pthread_mutex_lock(&client->mutex);
+    int rc = 0;
+    job->readers++;
+    while (!job->chunks_head && !job->done && !job->cancelled && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&client->done_cond, &client->mutex, &deadline);
+    }
+    job->readers--;
+    if (job->cancelled) {
+        // Closed while waiting; the last reader out frees the job
+        if (job->readers == 0) {
+            http_stream_free(job);
+        } else {
+            pthread_mutex_unlock(&client->mutex);
+        }
+        http_client_throw(ctx, "HTTP body stream is closed");
+        return val_null();
+    }
+    if (!job->chunks_head && (!job->done || job->resp->failed)) {
+        pthread_mutex_unlock(&client->mutex);
+        http_client_throw(ctx, "HTTP request failed or timed out");
+        return val_null();
+    }
+
+    size_t len = job->queued < (size_t)max ? job->queued : (size_t)max;
+    Buffer *buf = slab_alloc(sizeof(Buffer));
+    char *data = malloc(len > 0 ? len : 1);
+    if (!buf || !data) {
+        pthread_mutex_unlock(&client->mutex);
+        if (buf) slab_free(buf, sizeof(Buffer));
+        free(data);
+        http_client_throw(ctx, "Memory allocation failed");
+        return val_null();
+    }
+
+    size_t copied = 0;
+    while (copied < len) {
+        http_chunk_t *chunk = job->chunks_head;
+        size_t take = chunk->len - chunk->offset;
+        if (take > len - copied) take = len - copied;
+        memcpy(data + copied, chunk->data + chunk->offset, take);
+        copied += take;
+        chunk->offset += take;
+        if (chunk->offset == chunk->len) {
+            job->chunks_head = chunk->next;
+            if (!job->chunks_head) job->chunks_tail = NULL;
+            free(chunk);
+        }
+    }
+    job->queued -= len;
+    int resume = job->paused && job->queued <= HTTP_STREAM_LOW_WATER;
+    pthread_mutex_unlock(&client->mutex);
+    if (resume) {
+        lws_cancel_service(client->context);
+    }
+
+    buf->data = data;
+    buf->length = (int)len;
+    buf->capacity = len > 0 ? (int)len : 1;
+    buf->ref_count = 1;
+    atomic_store(&buf->freed, 0);
+    buf->mapped = 0;
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
+    return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
+}
+
+// __lws_http_stream_close(handle: ptr): null
+// Drops the rest of the body; safe to call after the body is complete
+Value builtin_lws_http_stream_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_PTR) {
+        http_client_throw(ctx, "__lws_http_stream_close() expects 1 argument (handle)");
+        return val_null();
+    }
+    if (args[0].as.as_ptr) {
+        http_stream_release((http_job_t *)args[0].as.as_ptr);
+    }
+    return val_null();
+}
+
+// __lws_http_client_close(client: ptr): null
+// Closes the client's connections; call once no requests are outstanding
+Value builtin_lws_http_client_close(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_PTR) {
+        http_client_throw(ctx, "__lws_http_client_close() expects 1 argument (client)");
+        return val_null();
+    }
+
+    http_client_t *client = (http_client_t *)args[0].as.as_ptr;
+    if (!client) return val_null();
+
+    pthread_mutex_lock(&client->mutex);
+    client->shutdown = 1;
+    http_job_t *pending = client->pending_head;
+    client->pending_head = client->pending_tail = NULL;
+    pthread_mutex_unlock(&client->mutex);
+
+    lws_cancel_service(client->context);
+    pthread_join(client->service_thread, NULL);
+    lws_context_destroy(client->context);
+
+    while (pending) {
+        http_job_t *next = pending->next;
+        http_job_free(pending);
+        pending = next;
+    }
+    http_host_t *host = client->hosts;
+    while (host) {
+        http_host_t *next = host->next;
+        free(host);
+        host = next;
+    }
+    pthread_mutex_destroy(&client->mutex);
+    pthread_cond_destroy(&client->done_cond);
+    free(client);
+    return val_null();
+}
+
 // ========== WEBSOCKET SUPPORT ==========
 
 typedef struct ws_message {
@@ -1145,13 +1936,13 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     lws_init_logging();
 
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_connect() expects 1 argument");
         return val_null();
     }
 
     if (args[0].type != VAL_STRING) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_connect() expects string URL");
         return val_null();
     }
@@ -1174,7 +1965,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
         if (colon && (!slash || colon < slash)) {
             size_t host_len = colon - rest;
             if (host_len >= 256) {
-                ctx->exception_state.is_throwing = 1;
+                ctx->flow.is_throwing = 1;
                 ctx->exception_state.exception_value = val_string("Host name too long");
                 return val_null();
             }
@@ -1188,7 +1979,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
         } else if (slash) {
             size_t host_len = slash - rest;
             if (host_len >= 256) {
-                ctx->exception_state.is_throwing = 1;
+                ctx->flow.is_throwing = 1;
                 ctx->exception_state.exception_value = val_string("Host name too long");
                 return val_null();
             }
@@ -1209,7 +2000,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
         if (colon && (!slash || colon < slash)) {
             size_t host_len = colon - rest;
             if (host_len >= 256) {
-                ctx->exception_state.is_throwing = 1;
+                ctx->flow.is_throwing = 1;
                 ctx->exception_state.exception_value = val_string("Host name too long");
                 return val_null();
             }
@@ -1223,7 +2014,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
         } else if (slash) {
             size_t host_len = slash - rest;
             if (host_len >= 256) {
-                ctx->exception_state.is_throwing = 1;
+                ctx->flow.is_throwing = 1;
                 ctx->exception_state.exception_value = val_string("Host name too long");
                 return val_null();
             }
@@ -1236,14 +2027,14 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
             host[255] = '\0';
         }
     } else {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Invalid WebSocket URL (must start with ws:// or wss://)");
         return val_null();
     }
 
     ws_connection_t *conn = calloc(1, sizeof(ws_connection_t));
     if (!conn) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate connection");
         return val_null();
     }
@@ -1263,7 +2054,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     conn->context = lws_create_context(&info);
     if (!conn->context) {
         free(conn);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create libwebsockets context");
         return val_null();
     }
@@ -1290,7 +2081,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     if (!lws_client_connect_via_info(&connect_info)) {
         lws_context_destroy(conn->context);
         free(conn);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to connect");
         return val_null();
     }
@@ -1304,7 +2095,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     if (conn->failed || conn->closed || !conn->established) {
         lws_context_destroy(conn->context);
         free(conn);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("WebSocket connection failed or timed out");
         return val_null();
     }
@@ -1315,7 +2106,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     if (pthread_create(&conn->service_thread, NULL, ws_service_thread, conn) != 0) {
         lws_context_destroy(conn->context);
         free(conn);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create service thread");
         return val_null();
     }
@@ -1324,7 +2115,7 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     WebSocketHandle *ws = calloc(1, sizeof(WebSocketHandle));
     if (!ws) {
         ws_connection_close(conn);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate WebSocket handle");
         return val_null();
     }
@@ -1342,13 +2133,13 @@ Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_ws_send_text(conn: websocket, text: string): i32
 Value builtin_lws_ws_send_text(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 2) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_send_text() expects 2 arguments");
         return val_null();
     }
 
     if (args[1].type != VAL_STRING) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_send_text() expects string as second argument");
         return val_null();
     }
@@ -1361,7 +2152,7 @@ Value builtin_lws_ws_send_text(Value *args, int num_args, ExecutionContext *ctx)
     } else if (args[0].type == VAL_PTR) {
         conn = (ws_connection_t *)args[0].as.as_ptr;
     } else {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_send_text() expects websocket or ptr");
         return val_null();
     }
@@ -1394,13 +2185,13 @@ Value builtin_lws_ws_send_text(Value *args, int num_args, ExecutionContext *ctx)
 // Sends binary data over a WebSocket connection
 Value builtin_lws_ws_send_binary(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 2) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_send_binary() expects 2 arguments");
         return val_null();
     }
 
     if (args[1].type != VAL_BUFFER) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_send_binary() expects buffer as second argument");
         return val_null();
     }
@@ -1413,7 +2204,7 @@ Value builtin_lws_ws_send_binary(Value *args, int num_args, ExecutionContext *ct
     } else if (args[0].type == VAL_PTR) {
         conn = (ws_connection_t *)args[0].as.as_ptr;
     } else {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_send_binary() expects websocket or ptr");
         return val_null();
     }
@@ -1445,7 +2236,7 @@ Value builtin_lws_ws_send_binary(Value *args, int num_args, ExecutionContext *ct
 // __lws_ws_recv(conn: websocket, timeout_ms: i32): ptr
 Value builtin_lws_ws_recv(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 2) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_recv() expects 2 arguments");
         return val_null();
     }
@@ -1458,7 +2249,7 @@ Value builtin_lws_ws_recv(Value *args, int num_args, ExecutionContext *ctx) {
     } else if (args[0].type == VAL_PTR) {
         conn = (ws_connection_t *)args[0].as.as_ptr;
     } else {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_recv() expects websocket or ptr as first argument");
         return val_null();
     }
@@ -1491,7 +2282,7 @@ Value builtin_lws_ws_recv(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_msg_type(msg: ptr): i32
 Value builtin_lws_msg_type(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_msg_type() expects 1 argument");
         return val_null();
     }
@@ -1511,7 +2302,7 @@ Value builtin_lws_msg_type(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_msg_text(msg: ptr): string
 Value builtin_lws_msg_text(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_msg_text() expects 1 argument");
         return val_null();
     }
@@ -1531,7 +2322,7 @@ Value builtin_lws_msg_text(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_msg_len(msg: ptr): i32
 Value builtin_lws_msg_len(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_msg_len() expects 1 argument");
         return val_null();
     }
@@ -1551,7 +2342,7 @@ Value builtin_lws_msg_len(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_msg_free(msg: ptr): null
 Value builtin_lws_msg_free(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_msg_free() expects 1 argument");
         return val_null();
     }
@@ -1572,7 +2363,7 @@ Value builtin_lws_msg_free(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_ws_close(conn: websocket): null
 Value builtin_lws_ws_close(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_close() expects 1 argument");
         return val_null();
     }
@@ -1596,7 +2387,7 @@ Value builtin_lws_ws_close(Value *args, int num_args, ExecutionContext *ctx) {
 // __lws_ws_is_closed(conn: websocket): i32
 Value builtin_lws_ws_is_closed(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_is_closed() expects 1 argument");
         return val_null();
     }
@@ -1626,13 +2417,13 @@ Value builtin_lws_ws_server_create(Value *args, int num_args, ExecutionContext *
     lws_init_logging();
 
     if (num_args != 2) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_server_create() expects 2 arguments");
         return val_null();
     }
 
     if (args[0].type != VAL_STRING) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_server_create() expects string host");
         return val_null();
     }
@@ -1642,7 +2433,7 @@ Value builtin_lws_ws_server_create(Value *args, int num_args, ExecutionContext *
 
     ws_server_t *server = calloc(1, sizeof(ws_server_t));
     if (!server) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate server");
         return val_null();
     }
@@ -1667,7 +2458,7 @@ Value builtin_lws_ws_server_create(Value *args, int num_args, ExecutionContext *
     if (!server->context) {
         pthread_mutex_destroy(&server->pending_mutex);
         free(server);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create server context");
         return val_null();
     }
@@ -1677,7 +2468,7 @@ Value builtin_lws_ws_server_create(Value *args, int num_args, ExecutionContext *
         lws_context_destroy(server->context);
         pthread_mutex_destroy(&server->pending_mutex);
         free(server);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to create service thread");
         return val_null();
     }
@@ -1686,7 +2477,7 @@ Value builtin_lws_ws_server_create(Value *args, int num_args, ExecutionContext *
     WebSocketHandle *ws = calloc(1, sizeof(WebSocketHandle));
     if (!ws) {
         ws_server_close_internal(server);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate WebSocket server handle");
         return val_null();
     }
@@ -1704,7 +2495,7 @@ Value builtin_lws_ws_server_create(Value *args, int num_args, ExecutionContext *
 // __lws_ws_server_accept(server: websocket, timeout_ms: i32): websocket
 Value builtin_lws_ws_server_accept(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 2) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_server_accept() expects 2 arguments");
         return val_null();
     }
@@ -1721,7 +2512,7 @@ Value builtin_lws_ws_server_accept(Value *args, int num_args, ExecutionContext *
     } else if (args[0].type == VAL_PTR) {
         server = (ws_server_t *)args[0].as.as_ptr;
     } else {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_server_accept() expects websocket server");
         return val_null();
     }
@@ -1770,7 +2561,7 @@ Value builtin_lws_ws_server_accept(Value *args, int num_args, ExecutionContext *
 // __lws_ws_server_close(server: websocket): null
 Value builtin_lws_ws_server_close(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("__lws_ws_server_close() expects 1 argument");
         return val_null();
     }
@@ -1863,6 +2654,48 @@ Value builtin_lws_response_free(Value *args, int num_args, ExecutionContext *ctx
     return val_null();
 }
 
+Value builtin_lws_http_client_new(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
+Value builtin_lws_http_client_submit(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
+Value builtin_lws_http_client_wait(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
+Value builtin_lws_http_client_close(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
+Value builtin_lws_http_stream_open(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
+Value builtin_lws_http_stream_read(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
+Value builtin_lws_http_stream_close(Value *args, int num_args, ExecutionContext *ctx) {
+    (void)args; (void)num_args;
+    runtime_error(ctx, "HTTP support not available (libwebsockets not installed)");
+    return val_null();
+}
+
 Value builtin_lws_ws_connect(Value *args, int num_args, ExecutionContext *ctx) {
     (void)args; (void)num_args;
     runtime_error(ctx, "WebSocket support not available (libwebsockets not installed)");
@@ -125,6 +125,9 @@ Environment* env_new(Environment *parent) {
         env->count = 0;
         env->ref_count = 1;
         env->borrowed_flags = 0;  // Clear borrowed flags
+        env->gc_buffered = 0;
+        env->gc_captured = 0;
+        env->gc_captured = 0;
         // Clear hash table using memset (faster than loop)
         memset(env->hash_table, 0xFF, sizeof(int) * env->hash_capacity);
         env->parent = parent;
@@ -178,6 +181,8 @@ Environment* env_new(Environment *parent) {
     // Initialize all slots to -1 (empty) using memset (faster than loop)
     memset(env->hash_table, 0xFF, sizeof(int) * env->hash_capacity);
     env->borrowed_flags = 0;  // Initialize borrowed flags
+    env->gc_buffered = 0;
+    env->gc_captured = 0;
     env->parent = parent;
     // Retain parent environment if it exists
     if (parent) {
@@ -214,10 +219,9 @@ static void value_break_cycles_internal(Value val, VisitedSet *visited) {
                     return;
                 }
                 // Check if already visited (cycle detection)
-                if (visited_set_contains(visited, obj)) {
+                if (!visited_set_add(visited, obj)) {
                     return;
                 }
-                visited_set_add(visited, obj);
 
                 // Recursively process all field values
                 for (int i = 0; i < obj->num_fields; i++) {
@@ -234,10 +238,9 @@ static void value_break_cycles_internal(Value val, VisitedSet *visited) {
                     return;
                 }
                 // Check if already visited (cycle detection)
-                if (visited_set_contains(visited, arr)) {
+                if (!visited_set_add(visited, arr)) {
                     return;
                 }
-                visited_set_add(visited, arr);
 
                 // Recursively process all elements
                 for (int i = 0; i < arr->length; i++) {
@@ -256,13 +259,14 @@ static void value_break_cycles_internal(Value val, VisitedSet *visited) {
 // This now works recursively, finding functions nested in objects/arrays
 // This should be called on global/top-level environments before final env_release
 void env_break_cycles(Environment *env) {
-    VisitedSet *visited = visited_set_new();
+    VisitedSet visited;
+    visited_set_init(&visited);
 
     for (int i = 0; i < env->count; i++) {
-        value_break_cycles_internal(env->values[i], visited);
+        value_break_cycles_internal(env->values[i], &visited);
     }
 
-    visited_set_free(visited);
+    visited_set_destroy(&visited);
 
     // NOTE: Do NOT clear manually_freed_pointers here!
     // It needs to persist until after env_free() is called
@@ -289,6 +293,8 @@ void env_clear(Environment *env) {
 }
 
 void env_free(Environment *env) {
+    GC_FORGET(env, GC_KIND_ENV);
+
     // Free all variable names and release values
     for (int i = 0; i < env->count; i++) {
         // Only free name if it's not borrowed (check bit flag)
@@ -328,6 +334,11 @@ void env_retain(Environment *env) {
 // Decrement reference count and free if it reaches 0 (thread-safe using atomic operations)
 void env_release(Environment *env) {
     if (env) {
+        // Only captured envs can be on a cycle, which keeps call frames off the lock
+        if (__atomic_load_n(&env->gc_captured, __ATOMIC_RELAXED) &&
+            __atomic_load_n(&env->ref_count, __ATOMIC_RELAXED) > 1) {
+            GC_POSSIBLE_ROOT(env, GC_KIND_ENV);
+        }
         int old_count = __atomic_sub_fetch(&env->ref_count, 1, __ATOMIC_SEQ_CST);
         if (old_count == 0) {
             env_free(env);
@@ -335,6 +346,17 @@ void env_release(Environment *env) {
     }
 }
 
+// Record that a closure holds env. Envs only point at their parents, so a
+// cycle through an env needs a closure capturing it or one of its
+// descendants; envs never marked here are skipped by the cycle collector.
+void env_mark_captured(Environment *env) {
+    // An already marked env has marked ancestors too
+    while (env && !__atomic_load_n(&env->gc_captured, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&env->gc_captured, 1, __ATOMIC_RELAXED);
+        env = env->parent;
+    }
+}
+
 // Rehash all entries into the hash table (called after growing)
 static void env_rehash(Environment *env) {
     // Clear hash table
@@ -494,7 +516,7 @@ void env_define(Environment *env, const char *name, Value value, int is_const, E
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "Variable '%s' already defined in this scope", name);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return;
     }
 
@@ -526,7 +548,7 @@ void env_define_borrowed(Environment *env, const char *name, Value value, int is
         char error_msg[256];
         snprintf(error_msg, sizeof(error_msg), "Variable '%s' already defined in this scope", name);
         ctx->exception_state.exception_value = val_string(error_msg);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return;
     }
 
@@ -572,6 +594,67 @@ void env_define_param(Environment *env, const char *name, uint32_t hash, Value v
     env_hash_insert_with_hash(env, hash, index);
 }
 
+// A new environment with env's parent and a copy of its variables in the
+// same slots. Loops use it to give closures that captured one iteration's
+// variables their own copy while the next iteration moves on.
+Environment* env_fork(Environment *env) {
+    Environment *copy = env_new(env->parent);
+    for (int i = 0; i < env->count; i++) {
+        if (copy->count >= copy->capacity) {
+            env_grow(copy);
+        }
+        int borrowed = i < 32 && (env->borrowed_flags & (1U << i));
+        copy->names[i] = borrowed ? env->names[i] : strdup(env->names[i]);
+        if (borrowed) {
+            copy->borrowed_flags |= (1U << i);
+        }
+        VALUE_RETAIN(env->values[i]);
+        copy->values[i] = env->values[i];
+        copy->is_const[i] = env->is_const[i];
+        copy->count++;
+        env_hash_insert(copy, copy->names[i], i);
+    }
+    return copy;
+}
+
+// The environment for a flat closure created in env: a copy of each captured
+// variable, read at its resolved (depth, slot) from env, under the global
+// environment at the root of env's chain. With nothing captured, the global
+// environment itself is returned (retained) and nothing is copied.
+Environment* env_capture(Environment *env, char **names, ResolvedVar *captures, int count) {
+    Environment *global = env;
+    while (global->parent) {
+        global = global->parent;
+    }
+    if (count == 0) {
+        env_retain(global);
+        return global;
+    }
+
+    Environment *closure_env = env_new(global);
+    for (int i = 0; i < count; i++) {
+        Environment *source = env;
+        for (int d = 0; d < captures[i].depth && source; d++) {
+            source = source->parent;
+        }
+        int found = source && captures[i].slot < source->count;
+        if (closure_env->count >= closure_env->capacity) {
+            env_grow(closure_env);
+        }
+        // Names live in the AST; only the first 32 slots can borrow them
+        closure_env->names[i] = i < 32 ? names[i] : strdup(names[i]);
+        if (i < 32) {
+            closure_env->borrowed_flags |= (1U << i);
+        }
+        closure_env->values[i] = found ? source->values[captures[i].slot] : val_null();
+        VALUE_RETAIN(closure_env->values[i]);
+        closure_env->is_const[i] = found ? source->is_const[captures[i].slot] : 0;
+        closure_env->count++;
+        env_hash_insert(closure_env, closure_env->names[i], i);
+    }
+    return closure_env;
+}
+
 // Set a variable (for reassignment or implicit definition in loops/functions)
 void env_set(Environment *env, const char *name, Value value, ExecutionContext *ctx) {
     // Fast path: check first variable (common for loop counters and function params)
@@ -596,7 +679,7 @@ void env_set(Environment *env, const char *name, Value value, ExecutionContext *
             char error_msg[256];
             snprintf(error_msg, sizeof(error_msg), "Cannot assign to const variable '%s'", name);
             ctx->exception_state.exception_value = val_string(error_msg);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             return;
         }
         // Release old value, retain new value
@@ -617,7 +700,7 @@ void env_set(Environment *env, const char *name, Value value, ExecutionContext *
                 char error_msg[256];
                 snprintf(error_msg, sizeof(error_msg), "Cannot assign to const variable '%s'", name);
                 ctx->exception_state.exception_value = val_string(error_msg);
-                ctx->exception_state.is_throwing = 1;
+                ctx->flow.is_throwing = 1;
                 return;
             }
             // Release old value, retain new value
@@ -675,7 +758,7 @@ Value env_get(Environment *env, const char *name, ExecutionContext *ctx) {
     char error_msg[256];
     snprintf(error_msg, sizeof(error_msg), "Undefined variable '%s'", name);
     ctx->exception_state.exception_value = val_string(error_msg);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();  // Return dummy value when exception is thrown
 }
 
@@ -758,3 +841,30 @@ int env_set_resolved(Environment *env, int depth, int slot, Value value, Executi
     target->values[slot] = value;
     return 1;
 }
+
+/*
+ * Storage of a variable that may be assigned, for updating its value in
+ * place. Returns NULL if the variable is const or not defined. The pointer
+ * is only valid until the next definition in that environment.
+ */
+Value *env_assignable_slot(Environment *env, const char *name) {
+    uint32_t hash = hash_string(name);
+    for (Environment *search_env = env; search_env != NULL; search_env = search_env->parent) {
+        int idx = env_lookup(search_env, name, hash);
+        if (idx >= 0) {
+            return search_env->is_const[idx] ? NULL : &search_env->values[idx];
+        }
+    }
+    return NULL;
+}
+
+Value *env_assignable_slot_resolved(Environment *env, int depth, int slot) {
+    Environment *target = env;
+    for (int i = 0; i < depth && target; i++) {
+        target = target->parent;
+    }
+    if (!target || slot < 0 || slot >= target->count || target->is_const[slot]) {
+        return NULL;
+    }
+    return &target->values[slot];
+}
@@ -174,7 +174,7 @@ FFILibrary* ffi_load_library(const char *path, ExecutionContext *ctx) {
     // SECURITY: Validate library path before loading
     const char *validation_error = validate_ffi_library_path(path);
     if (validation_error) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         char error_msg[512];
         snprintf(error_msg, sizeof(error_msg), "FFI security error: %s (path: %s)", validation_error, path);
         ctx->exception_state.exception_value = val_string(error_msg);
@@ -204,7 +204,7 @@ FFILibrary* ffi_load_library(const char *path, ExecutionContext *ctx) {
     void *handle = dlopen(actual_path, RTLD_LAZY);
     if (handle == NULL) {
         pthread_mutex_unlock(&ffi_cache_mutex);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         char error_msg[512];
         snprintf(error_msg, sizeof(error_msg), "Failed to load library '%s': %s", path, dlerror());
         ctx->exception_state.exception_value = val_string(error_msg);
@@ -224,7 +224,7 @@ FFILibrary* ffi_load_library(const char *path, ExecutionContext *ctx) {
             free(lib->path);
             free(lib);
             pthread_mutex_unlock(&ffi_cache_mutex);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             ctx->exception_state.exception_value = val_string("FFI library cache capacity overflow");
             return NULL;
         }
@@ -318,17 +318,15 @@ FFIStructType* ffi_register_struct(const char *name, char **field_names,
                     name, field_names[i]);
             return NULL;
         }
+        // Every typed define is offered here, and most are never passed to
+        // C: one with fields libffi cannot lay out (runes, nested types that
+        // are not structs) is quietly left unregistered
         TypeKind kind = field_types[i]->kind;
         if (kind == TYPE_CUSTOM_OBJECT) {
-            // Nested structs - check if already registered
             if (!ffi_lookup_struct(field_types[i]->type_name)) {
-                fprintf(stderr, "Error: Struct '%s' field '%s' uses unregistered struct type '%s'\n",
-                        name, field_names[i], field_types[i]->type_name);
                 return NULL;
             }
         } else if (!type_kind_to_ffi_type(kind)) {
-            fprintf(stderr, "Error: Struct '%s' field '%s' has unsupported FFI type\n",
-                    name, field_names[i]);
             return NULL;
         }
     }
@@ -399,7 +397,7 @@ FFIStructType* ffi_register_struct(const char *name, char **field_names,
 // Returns pointer to allocated struct memory (caller must free)
 void* ffi_object_to_struct(Value obj, FFIStructType *struct_type, ExecutionContext *ctx) {
     if (obj.type != VAL_OBJECT || !obj.as.as_object) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("FFI struct conversion requires an object");
         return NULL;
     }
@@ -414,7 +412,7 @@ void* ffi_object_to_struct(Value obj, FFIStructType *struct_type, ExecutionConte
         // Look up field in object
         int field_idx = object_lookup_field(o, field->name);
         if (field_idx < 0) {
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             char err[256];
             snprintf(err, sizeof(err), "FFI struct '%s' missing required field '%s'",
                      struct_type->name, field->name);
@@ -831,7 +829,7 @@ FFIFunction* ffi_declare_function(
     );
 
     if (status != FFI_OK) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         char err[512];
         snprintf(err, sizeof(err), "Failed to prepare FFI call interface for '%s'", name);
         ctx->exception_state.exception_value = val_string(err);
@@ -869,7 +867,7 @@ Value ffi_call_function(FFIFunction *func, Value *args, int num_args, ExecutionC
         func->func_ptr = dlsym(func->lib_handle, func->name);
         char *error_msg = dlerror();
         if (error_msg != NULL || func->func_ptr == NULL) {
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             char err[512];
             snprintf(err, sizeof(err), "FFI function '%s' not found in '%s'%s%s",
                      func->name, func->lib_path,
@@ -881,7 +879,7 @@ Value ffi_call_function(FFIFunction *func, Value *args, int num_args, ExecutionC
 
     // Validate argument count
     if (num_args != func->num_params) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         char err[256];
         snprintf(err, sizeof(err), "FFI function '%s' expects %d arguments, got %d",
                  func->name, func->num_params, num_args);
@@ -922,7 +920,7 @@ Value ffi_call_function(FFIFunction *func, Value *args, int num_args, ExecutionC
             } else {
                 // Slow path: struct needs heap allocation
                 void *heap_storage = hemlock_to_c_value(args[i], param_type, ctx);
-                if (ctx->exception_state.is_throwing) {
+                if (ctx->flow.is_throwing) {
                     // Cleanup already-allocated structs
                     for (int j = 0; j < i; j++) {
                         if (struct_storage[j]) free(struct_storage[j]);
@@ -1121,13 +1119,13 @@ static void ffi_callback_handler(ffi_cif *cif, void *ret, void **args, void *use
     eval_stmt(fn->body, func_env, ctx);
 
     // Handle return value
-    if (ctx->return_state.is_returning && cb->hemlock_return != NULL && cb->hemlock_return->kind != TYPE_VOID) {
+    if (ctx->flow.is_returning && cb->hemlock_return != NULL && cb->hemlock_return->kind != TYPE_VOID) {
         Value result = ctx->return_state.return_value;
         hemlock_to_c_storage(result, cb->hemlock_return, ret);
     }
 
     // Handle exceptions - we can't propagate them to C, so just print a warning
-    if (ctx->exception_state.is_throwing) {
+    if (ctx->flow.is_throwing) {
         fprintf(stderr, "Warning: Exception in FFI callback (cannot propagate to C): ");
         print_value(ctx->exception_state.exception_value);
         fprintf(stderr, "\n");
@@ -1144,7 +1142,7 @@ static void ffi_callback_handler(ffi_cif *cif, void *ret, void **args, void *use
 FFICallback* ffi_create_callback(Function *fn, Type **param_types, int num_params, Type *return_type, ExecutionContext *ctx) {
     FFICallback *cb = malloc(sizeof(FFICallback));
     if (!cb) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate FFI callback");
         return NULL;
     }
@@ -1177,7 +1175,7 @@ FFICallback* ffi_create_callback(Function *fn, Type **param_types, int num_param
 
     ffi_status status = ffi_prep_cif(cif, FFI_DEFAULT_ABI, num_params, ret_type, arg_types);
     if (status != FFI_OK) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to prepare FFI callback interface");
         function_release(fn);
         free(cb->hemlock_params);
@@ -1191,7 +1189,7 @@ FFICallback* ffi_create_callback(Function *fn, Type **param_types, int num_param
     void *code_ptr;
     ffi_closure *closure = ffi_closure_alloc(sizeof(ffi_closure), &code_ptr);
     if (!closure) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to allocate FFI closure");
         function_release(fn);
         free(cb->hemlock_params);
@@ -1207,7 +1205,7 @@ FFICallback* ffi_create_callback(Function *fn, Type **param_types, int num_param
     // Prepare the closure with our handler
     status = ffi_prep_closure_loc(closure, cif, ffi_callback_handler, cb, code_ptr);
     if (status != FFI_OK) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("Failed to prepare FFI closure");
         ffi_closure_free(closure);
         function_release(fn);
@@ -1232,7 +1230,7 @@ FFICallback* ffi_create_callback(Function *fn, Type **param_types, int num_param
             free(arg_types);
             free(cif);
             free(cb);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             ctx->exception_state.exception_value = val_string("FFI callback cache capacity overflow");
             return NULL;
         }
@@ -1461,7 +1459,7 @@ void execute_extern_fn(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
     pthread_mutex_unlock(&ffi_cache_mutex);
 
     if (current_lib == NULL) {
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         ctx->exception_state.exception_value = val_string("No library imported before extern declaration");
         return;
     }
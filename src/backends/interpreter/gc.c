@@ -0,0 +1,525 @@
+/*
+ * Hemlock Cycle Collector
+ *
+ * Reference counting frees everything except cycles: two objects pointing
+ * at each other, or a closure stored in the environment it captured. This
+ * is a synchronous trial-deletion collector in the style of Bacon and
+ * Rajan ("Concurrent Cycle Collection in Reference Counted Systems").
+ *
+ * A container whose refcount drops to a nonzero value may have just become
+ * the last external handle on a cycle, so *_release() adds it to a
+ * candidate buffer. A collection then:
+ *
+ *   1. traces everything reachable from the candidates (objects, arrays,
+ *      functions and environments) and copies each refcount;
+ *   2. subtracts the references that come from inside the traced graph;
+ *   3. marks everything reachable from a container that still has a
+ *      positive count, i.e. one referenced from outside the graph (a
+ *      variable in a live scope, the C stack, a task or channel);
+ *   4. frees the rest: those containers are only kept alive by each other.
+ *
+ * Collections run when gc_collect() is called and automatically once
+ * gc_threshold containers have been allocated since the last one, but only
+ * while no task is running, so no other thread can touch a refcount while
+ * the graph is traced. Values the collector does not trace (strings,
+ * buffers, tasks, channels, references) are treated as external holders,
+ * which can only keep more alive, never free too much.
+ */
+
+#include "internal.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int gc_allocations = 0;
+int gc_threshold = HML_GC_INITIAL_THRESHOLD;
+
+static pthread_mutex_t gc_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int gc_live_tasks = 0;
+
+// Candidate buffer: tagged pointers (see GC_TAG), NULL = forgotten. Each
+// container's gc_buffered holds its index + 1, so forgetting is O(1).
+static void **gc_buffer = NULL;
+static int gc_buffer_count = 0;
+static int gc_buffer_capacity = 0;
+static int gc_buffer_holes = 0;
+
+static long gc_collections = 0;
+static long gc_collected = 0;
+static int gc_last_traced = 0;
+static double gc_pause_ms = 0.0;
+
+// Containers are at least 8-byte aligned, so the kind fits in the low bits
+#define GC_TAG(ptr, kind) ((void*)((uintptr_t)(ptr) | (uintptr_t)(kind)))
+#define GC_UNTAG_PTR(tagged) ((void*)((uintptr_t)(tagged) & ~(uintptr_t)3))
+#define GC_UNTAG_KIND(tagged) ((GCKind)((uintptr_t)(tagged) & 3))
+
+// ========== CANDIDATE BUFFER ==========
+
+static int *gc_flag(void *ptr, GCKind kind) {
+    switch (kind) {
+        case GC_KIND_OBJECT: return &((Object*)ptr)->gc_buffered;
+        case GC_KIND_ARRAY: return &((Array*)ptr)->gc_buffered;
+        case GC_KIND_FUNCTION: return &((Function*)ptr)->gc_buffered;
+        case GC_KIND_ENV: return &((Environment*)ptr)->gc_buffered;
+    }
+    return NULL;
+}
+
+// With no task running only this thread touches the buffer; a task's
+// final gc_task_finished() orders its buffer updates before ours
+static int gc_lock_buffer(void) {
+    if (atomic_load(&gc_live_tasks) == 0) return 0;
+    pthread_mutex_lock(&gc_lock);
+    return 1;
+}
+
+static void gc_unlock_buffer(int locked) {
+    if (locked) pthread_mutex_unlock(&gc_lock);
+}
+
+// Squeeze out forgotten slots, renumbering the survivors
+static void gc_buffer_compact(void) {
+    int live = 0;
+    for (int i = 0; i < gc_buffer_count; i++) {
+        void *tagged = gc_buffer[i];
+        if (!tagged) continue;
+        gc_buffer[live++] = tagged;
+        *gc_flag(GC_UNTAG_PTR(tagged), GC_UNTAG_KIND(tagged)) = live;
+    }
+    gc_buffer_count = live;
+    gc_buffer_holes = 0;
+}
+
+void gc_buffer_candidate(void *ptr, GCKind kind) {
+    int *flag = gc_flag(ptr, kind);
+    int locked = gc_lock_buffer();
+    if (!*flag) {
+        if (gc_buffer_count == gc_buffer_capacity) {
+            if (gc_buffer_holes > gc_buffer_count / 2) {
+                gc_buffer_compact();
+            } else {
+                int new_capacity = gc_buffer_capacity ? gc_buffer_capacity * 2 : 256;
+                void **new_buffer = realloc(gc_buffer, sizeof(void*) * (size_t)new_capacity);
+                if (!new_buffer) {
+                    fprintf(stderr, "Runtime error: Failed to allocate cycle collector buffer\n");
+                    exit(1);
+                }
+                gc_buffer = new_buffer;
+                gc_buffer_capacity = new_capacity;
+            }
+        }
+        gc_buffer[gc_buffer_count++] = GC_TAG(ptr, kind);
+        __atomic_store_n(flag, gc_buffer_count, __ATOMIC_RELAXED);
+    }
+    gc_unlock_buffer(locked);
+}
+
+void gc_forget(void *ptr, GCKind kind) {
+    int *flag = gc_flag(ptr, kind);
+    int locked = gc_lock_buffer();
+    int slot = *flag;
+    if (slot) {
+        gc_buffer[slot - 1] = NULL;
+        gc_buffer_holes++;
+        __atomic_store_n(flag, 0, __ATOMIC_RELAXED);
+        // Containers are usually freed in the reverse order they were buffered
+        while (gc_buffer_count > 0 && !gc_buffer[gc_buffer_count - 1]) {
+            gc_buffer_count--;
+            gc_buffer_holes--;
+        }
+    }
+    gc_unlock_buffer(locked);
+}
+
+void gc_task_started(void) {
+    atomic_fetch_add(&gc_live_tasks, 1);
+}
+
+void gc_task_finished(void) {
+    atomic_fetch_sub(&gc_live_tasks, 1);
+}
+
+// ========== TRACED GRAPH ==========
+
+typedef struct {
+    void *ptr;
+    GCKind kind;
+    int refs;       // Refcount minus references from inside the graph
+    int reachable;  // Reachable from outside the graph
+} GCNode;
+
+typedef struct {
+    GCNode *nodes;
+    int count;
+    int capacity;
+    int *index;         // Open-addressing map: slot -> node index + 1 (0 = empty)
+    int index_capacity;
+    int *stack;         // Worklist of node indices
+    int stack_count;
+    int stack_capacity;
+} GCGraph;
+
+static void *gc_alloc(size_t size) {
+    void *p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+        exit(1);
+    }
+    return p;
+}
+
+static inline size_t gc_slot(void *ptr, int capacity) {
+    uint64_t h = ((uint64_t)(uintptr_t)ptr >> 3) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h >> 32) & (size_t)(capacity - 1);
+}
+
+static int gc_lookup(GCGraph *g, void *ptr) {
+    size_t mask = (size_t)g->index_capacity - 1;
+    for (size_t i = gc_slot(ptr, g->index_capacity); g->index[i]; i = (i + 1) & mask) {
+        if (g->nodes[g->index[i] - 1].ptr == ptr) return g->index[i] - 1;
+    }
+    return -1;
+}
+
+static void gc_index_insert(GCGraph *g, int node) {
+    size_t mask = (size_t)g->index_capacity - 1;
+    size_t i = gc_slot(g->nodes[node].ptr, g->index_capacity);
+    while (g->index[i]) i = (i + 1) & mask;
+    g->index[i] = node + 1;
+}
+
+static int gc_refcount(void *ptr, GCKind kind) {
+    switch (kind) {
+        case GC_KIND_OBJECT: return ((Object*)ptr)->ref_count;
+        case GC_KIND_ARRAY: return ((Array*)ptr)->ref_count;
+        case GC_KIND_FUNCTION: return ((Function*)ptr)->ref_count;
+        case GC_KIND_ENV: return ((Environment*)ptr)->ref_count;
+    }
+    return 0;
+}
+
+static void gc_push(GCGraph *g, int node) {
+    if (g->stack_count == g->stack_capacity) {
+        g->stack_capacity *= 2;
+        g->stack = realloc(g->stack, sizeof(int) * (size_t)g->stack_capacity);
+        if (!g->stack) {
+            fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+            exit(1);
+        }
+    }
+    g->stack[g->stack_count++] = node;
+}
+
+// Add a container to the graph (if new) and queue it for tracing
+static int gc_add(GCGraph *g, void *ptr, GCKind kind) {
+    int existing = gc_lookup(g, ptr);
+    if (existing >= 0) return existing;
+
+    if (g->count == g->capacity) {
+        g->capacity *= 2;
+        g->nodes = realloc(g->nodes, sizeof(GCNode) * (size_t)g->capacity);
+        if (!g->nodes) {
+            fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+            exit(1);
+        }
+    }
+    if ((g->count + 1) * 2 > g->index_capacity) {
+        free(g->index);
+        g->index_capacity *= 2;
+        g->index = calloc((size_t)g->index_capacity, sizeof(int));
+        if (!g->index) {
+            fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+            exit(1);
+        }
+        for (int i = 0; i < g->count; i++) gc_index_insert(g, i);
+    }
+
+    int node = g->count++;
+    g->nodes[node].ptr = ptr;
+    g->nodes[node].kind = kind;
+    g->nodes[node].refs = gc_refcount(ptr, kind);
+    g->nodes[node].reachable = 0;
+    gc_index_insert(g, node);
+    gc_push(g, node);
+    return node;
+}
+
+// Map a value to the container it references, if the collector traces it
+static int gc_value_container(Value v, void **ptr, GCKind *kind) {
+    switch (v.type) {
+        case VAL_OBJECT:
+            if (!v.as.as_object || atomic_load(&v.as.as_object->freed)) return 0;
+            *ptr = v.as.as_object;
+            *kind = GC_KIND_OBJECT;
+            return 1;
+        case VAL_ARRAY:
+            if (!v.as.as_array || atomic_load(&v.as.as_array->freed)) return 0;
+            *ptr = v.as.as_array;
+            *kind = GC_KIND_ARRAY;
+            return 1;
+        case VAL_FUNCTION:
+            if (!v.as.as_function) return 0;
+            *ptr = v.as.as_function;
+            *kind = GC_KIND_FUNCTION;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// The top-level env lives until the interpreter exits, so everything it
+// reaches is live; leaving it out of the graph keeps a collection from
+// tracing every global each time a closure's parent chain leads there
+static inline int gc_is_root(void *ptr, GCKind kind) {
+    return kind == GC_KIND_ENV && ((Environment*)ptr)->parent == NULL;
+}
+
+typedef enum { GC_DISCOVER, GC_SUBTRACT, GC_MARK } GCPhase;
+
+static void gc_edge(GCGraph *g, GCPhase phase, void *child, GCKind kind) {
+    if (gc_is_root(child, kind)) return;
+    if (phase == GC_DISCOVER) {
+        gc_add(g, child, kind);
+        return;
+    }
+    int node = gc_lookup(g, child);
+    if (node < 0) return;
+    if (phase == GC_SUBTRACT) {
+        g->nodes[node].refs--;
+    } else if (!g->nodes[node].reachable) {
+        g->nodes[node].reachable = 1;
+        gc_push(g, node);
+    }
+}
+
+// Visit every reference a container holds a refcount on
+static void gc_children(GCGraph *g, GCPhase phase, int node) {
+    void *ptr = g->nodes[node].ptr;
+    void *child;
+    GCKind kind;
+
+    switch (g->nodes[node].kind) {
+        case GC_KIND_OBJECT: {
+            Object *obj = ptr;
+            for (int i = 0; i < obj->num_fields; i++) {
+                if (gc_value_container(obj->field_values[i], &child, &kind)) gc_edge(g, phase, child, kind);
+            }
+            break;
+        }
+        case GC_KIND_ARRAY: {
+            Array *arr = ptr;
+            for (int i = 0; i < arr->length; i++) {
+                if (gc_value_container(arr->elements[i], &child, &kind)) gc_edge(g, phase, child, kind);
+            }
+            break;
+        }
+        case GC_KIND_FUNCTION: {
+            Function *fn = ptr;
+            if (fn->closure_env) gc_edge(g, phase, fn->closure_env, GC_KIND_ENV);
+            break;
+        }
+        case GC_KIND_ENV: {
+            Environment *env = ptr;
+            for (int i = 0; i < env->count; i++) {
+                if (gc_value_container(env->values[i], &child, &kind)) gc_edge(g, phase, child, kind);
+            }
+            if (env->parent) gc_edge(g, phase, env->parent, GC_KIND_ENV);
+            break;
+        }
+    }
+}
+
+// ========== FREEING GARBAGE ==========
+
+static Value gc_node_value(GCNode *n) {
+    switch (n->kind) {
+        case GC_KIND_OBJECT: return val_object(n->ptr);
+        case GC_KIND_ARRAY: return val_array(n->ptr);
+        case GC_KIND_FUNCTION: return val_function(n->ptr);
+        case GC_KIND_ENV: break;
+    }
+    return val_null();
+}
+
+static void gc_hold(GCNode *n) {
+    if (n->kind == GC_KIND_ENV) {
+        env_retain(n->ptr);
+    } else {
+        value_retain(gc_node_value(n));
+    }
+}
+
+static void gc_drop(GCNode *n) {
+    if (n->kind == GC_KIND_ENV) {
+        env_release(n->ptr);
+    } else {
+        value_release(gc_node_value(n));
+    }
+}
+
+// Release every reference a garbage container holds. Containers in the
+// garbage set are held by gc_hold(), so this never frees one of them and
+// the normal free path runs once the holds are dropped.
+static void gc_clear(GCNode *n) {
+    switch (n->kind) {
+        case GC_KIND_OBJECT: {
+            Object *obj = n->ptr;
+            for (int i = 0; i < obj->num_fields; i++) {
+                Value v = obj->field_values[i];
+                obj->field_values[i] = val_null();
+                VALUE_RELEASE(v);
+            }
+            break;
+        }
+        case GC_KIND_ARRAY: {
+            Array *arr = n->ptr;
+            for (int i = 0; i < arr->length; i++) {
+                Value v = arr->elements[i];
+                arr->elements[i] = val_null();
+                VALUE_RELEASE(v);
+            }
+            break;
+        }
+        case GC_KIND_FUNCTION: {
+            Function *fn = n->ptr;
+            Environment *env = fn->closure_env;
+            fn->closure_env = NULL;
+            env_release(env);
+            break;
+        }
+        case GC_KIND_ENV: {
+            Environment *env = n->ptr;
+            for (int i = 0; i < env->count; i++) {
+                Value v = env->values[i];
+                env->values[i] = val_null();
+                VALUE_RELEASE(v);
+            }
+            Environment *parent = env->parent;
+            env->parent = NULL;
+            env_release(parent);
+            break;
+        }
+    }
+}
+
+// ========== COLLECTION ==========
+
+static int gc_run(void) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    GCGraph g;
+    g.capacity = 256;
+    g.count = 0;
+    g.nodes = gc_alloc(sizeof(GCNode) * (size_t)g.capacity);
+    g.index_capacity = 512;
+    g.index = calloc((size_t)g.index_capacity, sizeof(int));
+    g.stack_capacity = 256;
+    g.stack_count = 0;
+    g.stack = gc_alloc(sizeof(int) * (size_t)g.stack_capacity);
+    if (!g.index) {
+        fprintf(stderr, "Runtime error: Memory allocation failed in cycle collector\n");
+        exit(1);
+    }
+
+    // Take the candidates; anything released from here on is buffered anew
+    pthread_mutex_lock(&gc_lock);
+    for (int i = 0; i < gc_buffer_count; i++) {
+        void *tagged = gc_buffer[i];
+        if (!tagged) continue;
+        void *ptr = GC_UNTAG_PTR(tagged);
+        GCKind kind = GC_UNTAG_KIND(tagged);
+        *gc_flag(ptr, kind) = 0;
+        if (kind == GC_KIND_OBJECT && atomic_load(&((Object*)ptr)->freed)) continue;
+        if (kind == GC_KIND_ARRAY && atomic_load(&((Array*)ptr)->freed)) continue;
+        if (gc_is_root(ptr, kind)) continue;
+        gc_add(&g, ptr, kind);
+    }
+    gc_buffer_count = 0;
+    gc_buffer_holes = 0;
+    pthread_mutex_unlock(&gc_lock);
+
+    // 1. Trace the graph reachable from the candidates
+    while (g.stack_count > 0) {
+        gc_children(&g, GC_DISCOVER, g.stack[--g.stack_count]);
+    }
+
+    // 2. Subtract internal references
+    for (int i = 0; i < g.count; i++) {
+        gc_children(&g, GC_SUBTRACT, i);
+    }
+
+    // 3. Keep everything reachable from an externally referenced container
+    for (int i = 0; i < g.count; i++) {
+        if (g.nodes[i].refs > 0) {
+            g.nodes[i].reachable = 1;
+            gc_push(&g, i);
+        }
+    }
+    while (g.stack_count > 0) {
+        gc_children(&g, GC_MARK, g.stack[--g.stack_count]);
+    }
+
+    // 4. Free the rest
+    int freed = 0;
+    for (int i = 0; i < g.count; i++) {
+        if (!g.nodes[i].reachable) {
+            g.nodes[freed++] = g.nodes[i];
+        }
+    }
+    for (int i = 0; i < freed; i++) gc_hold(&g.nodes[i]);
+    for (int i = 0; i < freed; i++) gc_clear(&g.nodes[i]);
+    for (int i = 0; i < freed; i++) gc_drop(&g.nodes[i]);
+
+    gc_last_traced = g.count;
+    gc_collections++;
+    gc_collected += freed;
+    __atomic_store_n(&gc_allocations, 0, __ATOMIC_RELAXED);
+    gc_threshold = g.count > HML_GC_INITIAL_THRESHOLD ? g.count : HML_GC_INITIAL_THRESHOLD;
+
+    free(g.nodes);
+    free(g.index);
+    free(g.stack);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    gc_pause_ms += (double)(end.tv_sec - start.tv_sec) * HML_MILLISECONDS_PER_SECOND +
+                   (double)(end.tv_nsec - start.tv_nsec) / 1e6;
+    return freed;
+}
+
+// Set while a collection runs, so a collection is never nested in another
+static int gc_running = 0;
+
+int gc_collect(void) {
+    if (atomic_load(&gc_live_tasks) > 0) return -1;
+    if (gc_running) return 0;
+    gc_running = 1;
+    int freed = gc_run();
+    gc_running = 0;
+    return freed;
+}
+
+void gc_collect_if_due(void) {
+    if (atomic_load(&gc_live_tasks) > 0) {
+        // Try again after another threshold's worth of allocations
+        __atomic_store_n(&gc_allocations, 0, __ATOMIC_RELAXED);
+        return;
+    }
+    gc_collect();
+}
+
+void gc_get_stats(GCStats *out) {
+    pthread_mutex_lock(&gc_lock);
+    out->candidates = gc_buffer_count - gc_buffer_holes;
+    pthread_mutex_unlock(&gc_lock);
+    out->collections = gc_collections;
+    out->collected = gc_collected;
+    out->traced = gc_last_traced;
+    out->threshold = gc_threshold;
+    out->pause_ms = gc_pause_ms;
+}
@@ -0,0 +1,544 @@
+/*
+ * Hemlock Allocation / Heap Profiler
+ *
+ * Opt-in tracking of refcounted heap values (String, Array, Object, Buffer),
+ * enabled with `hemlock --heap-profile` or HEMLOCK_HEAP_PROFILE=1.
+ *
+ * The constructors and *_free paths in values.c call HEAP_TRACK_ALLOC /
+ * HEAP_TRACK_FREE, which cost a single predictable branch while tracking is
+ * off. When on, every live value is kept in a pointer-keyed hash table with
+ * its kind, size and (for sampled allocations) the call stack that created
+ * it. Every HML_HEAP_SAMPLE_INTERVAL-th allocation per thread records its
+ * stack from the thread's CallStack, so per-site counts are statistical
+ * while per-type counts are exact.
+ *
+ * heap_stats() reports the counters; heap_snapshot(path) writes every live
+ * value and the containers that reference it as JSON, which is how values
+ * kept alive by reference cycles are found.
+ */
+
+#include "internal.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int heap_tracking_enabled = 0;
+
+typedef struct {
+    void *ptr;          // NULL = empty slot
+    size_t bytes;       // Size at allocation time
+    uint32_t site;      // Index + 1 into sites, 0 = allocation was not sampled
+    uint8_t kind;       // HeapKind
+} HeapRecord;
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static HeapRecord *records = NULL;
+static size_t record_capacity = 0;   // Power of two
+static size_t record_count = 0;
+
+static HeapKindStats kind_stats[HEAP_KIND_COUNT];
+static long live_bytes_total = 0;
+static long peak_bytes_total = 0;
+
+static HeapSiteStats *sites = NULL;
+static int site_count = 0;
+static int site_capacity = 0;
+static int *site_index = NULL;       // Open addressing: site position + 1, 0 = empty
+static int site_index_capacity = 0;  // Power of two
+
+// Each thread samples its own call stack
+static __thread CallStack *heap_thread_stack = NULL;
+static __thread const char *heap_thread_label = NULL;
+static __thread int sample_countdown = HML_HEAP_SAMPLE_INTERVAL;
+
+static const char *kind_names[HEAP_KIND_COUNT] = {"string", "array", "object", "buffer"};
+
+const char* heap_kind_name(HeapKind kind) {
+    return kind < HEAP_KIND_COUNT ? kind_names[kind] : "unknown";
+}
+
+// ========== POINTER TABLE ==========
+
+static size_t ptr_hash(void *ptr) {
+    uintptr_t p = (uintptr_t)ptr >> 4;  // malloc results are 16-byte aligned
+    return (size_t)(p * 0x9E3779B97F4A7C15ULL);
+}
+
+static void records_grow(void) {
+    size_t old_capacity = record_capacity;
+    HeapRecord *old = records;
+
+    record_capacity = old_capacity == 0 ? 1024 : old_capacity * HML_GROWTH_FACTOR;
+    records = calloc(record_capacity, sizeof(HeapRecord));
+    if (!records) {
+        fprintf(stderr, "Fatal error: Failed to grow heap profiler table\n");
+        exit(1);
+    }
+    size_t mask = record_capacity - 1;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].ptr) {
+            size_t slot = ptr_hash(old[i].ptr) & mask;
+            while (records[slot].ptr) slot = (slot + 1) & mask;
+            records[slot] = old[i];
+        }
+    }
+    free(old);
+}
+
+static HeapRecord* records_find(void *ptr) {
+    if (record_capacity == 0) return NULL;
+    size_t mask = record_capacity - 1;
+    size_t slot = ptr_hash(ptr) & mask;
+    while (records[slot].ptr) {
+        if (records[slot].ptr == ptr) return &records[slot];
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+// Linear probing delete with backward shift (no tombstones)
+static void records_remove(HeapRecord *rec) {
+    size_t mask = record_capacity - 1;
+    size_t hole = (size_t)(rec - records);
+    size_t slot = hole;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (!records[slot].ptr) break;
+        size_t home = ptr_hash(records[slot].ptr) & mask;
+        // Move the entry back if its home is not in (hole, slot]
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            records[hole] = records[slot];
+            hole = slot;
+        }
+    }
+    records[hole].ptr = NULL;
+    record_count--;
+}
+
+// ========== ALLOCATION SITES ==========
+
+static uint32_t site_hash(const char *s) {
+    uint32_t h = HML_DJB2_HASH_SEED;
+    while (*s) h = ((h << 5) + h) + (unsigned char)*s++;
+    return h;
+}
+
+static void site_index_rebuild(void) {
+    site_index_capacity = site_index_capacity == 0 ? 256 : site_index_capacity * HML_GROWTH_FACTOR;
+    free(site_index);
+    site_index = calloc(site_index_capacity, sizeof(int));
+    int mask = site_index_capacity - 1;
+    for (int i = 0; i < site_count; i++) {
+        int slot = (int)(site_hash(sites[i].stack) & mask);
+        while (site_index[slot]) slot = (slot + 1) & mask;
+        site_index[slot] = i + 1;
+    }
+}
+
+// Takes ownership of stack. Returns site position + 1.
+static uint32_t site_intern(char *stack) {
+    if ((site_count + 1) * 2 > site_index_capacity) {
+        site_index_rebuild();
+    }
+    int mask = site_index_capacity - 1;
+    int slot = (int)(site_hash(stack) & mask);
+    while (site_index[slot]) {
+        int pos = site_index[slot] - 1;
+        if (strcmp(sites[pos].stack, stack) == 0) {
+            free(stack);
+            return (uint32_t)pos + 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (site_count >= site_capacity) {
+        site_capacity = site_capacity == 0 ? 64 : site_capacity * HML_GROWTH_FACTOR;
+        sites = realloc(sites, sizeof(HeapSiteStats) * site_capacity);
+    }
+    HeapSiteStats *site = &sites[site_count];
+    memset(site, 0, sizeof(*site));
+    site->stack = stack;
+    site_index[slot] = ++site_count;
+    return (uint32_t)site_count;
+}
+
+// Fold the current thread's call stack into "<main>;caller;callee"
+static char* capture_stack(void) {
+    const char *label = heap_thread_label ? heap_thread_label : "<main>";
+    CallStack *stack = heap_thread_stack;
+    int count = stack ? stack->count : 0;
+    int first = count > HML_PROFILE_MAX_DEPTH ? count - HML_PROFILE_MAX_DEPTH : 0;
+
+    size_t len = strlen(label);
+    for (int i = first; i < count; i++) {
+        const char *name = stack->frames[i].function_name;
+        len += 1 + strlen(name ? name : "<anonymous>");
+    }
+    char *out = malloc(len + 1);
+    if (!out) return NULL;
+    size_t pos = strlen(label);
+    memcpy(out, label, pos);
+    for (int i = first; i < count; i++) {
+        const char *name = stack->frames[i].function_name;
+        if (!name) name = "<anonymous>";
+        size_t n = strlen(name);
+        out[pos++] = ';';
+        memcpy(out + pos, name, n);
+        pos += n;
+    }
+    out[pos] = '\0';
+    return out;
+}
+
+// ========== TRACKING HOOKS ==========
+
+// Remove a record's contribution to the live counters (lock held)
+static void record_uncount(HeapRecord *rec) {
+    kind_stats[rec->kind].live--;
+    kind_stats[rec->kind].live_bytes -= (long)rec->bytes;
+    live_bytes_total -= (long)rec->bytes;
+    if (rec->site) {
+        HeapSiteStats *site = &sites[rec->site - 1];
+        site->live--;
+        site->live_bytes -= (long)rec->bytes;
+    }
+}
+
+void heap_track_alloc(void *ptr, HeapKind kind, size_t bytes) {
+    if (!ptr) return;
+
+    // Capture outside the lock; only sampled allocations pay for it
+    char *stack = NULL;
+    if (--sample_countdown <= 0) {
+        sample_countdown = HML_HEAP_SAMPLE_INTERVAL;
+        stack = capture_stack();
+    }
+
+    pthread_mutex_lock(&heap_lock);
+    if ((record_count + 1) * 2 > record_capacity) {
+        records_grow();
+    }
+    size_t mask = record_capacity - 1;
+    size_t slot = ptr_hash(ptr) & mask;
+    while (records[slot].ptr && records[slot].ptr != ptr) slot = (slot + 1) & mask;
+    HeapRecord *rec = &records[slot];
+    if (rec->ptr) {
+        // Address reused after a free path that is not hooked; drop the stale entry
+        record_uncount(rec);
+    } else {
+        record_count++;
+    }
+
+    rec->ptr = ptr;
+    rec->kind = (uint8_t)kind;
+    rec->bytes = bytes;
+    rec->site = 0;
+    if (stack) {
+        rec->site = site_intern(stack);
+        HeapSiteStats *site = &sites[rec->site - 1];
+        site->allocs++;
+        site->bytes += (long)bytes;
+        site->live++;
+        site->live_bytes += (long)bytes;
+    }
+
+    kind_stats[kind].live++;
+    kind_stats[kind].live_bytes += (long)bytes;
+    kind_stats[kind].allocs++;
+    kind_stats[kind].alloc_bytes += (long)bytes;
+    live_bytes_total += (long)bytes;
+    if (live_bytes_total > peak_bytes_total) peak_bytes_total = live_bytes_total;
+    pthread_mutex_unlock(&heap_lock);
+}
+
+void heap_track_free(void *ptr) {
+    if (!ptr) return;
+
+    pthread_mutex_lock(&heap_lock);
+    // Values allocated before tracking started are simply not found
+    HeapRecord *rec = records_find(ptr);
+    if (rec) {
+        record_uncount(rec);
+        records_remove(rec);
+    }
+    pthread_mutex_unlock(&heap_lock);
+}
+
+// ========== STATS ==========
+
+static int compare_site_live_bytes(const void *a, const void *b) {
+    const HeapSiteStats *sa = a;
+    const HeapSiteStats *sb = b;
+    if (sa->live_bytes != sb->live_bytes) return sa->live_bytes < sb->live_bytes ? 1 : -1;
+    if (sa->bytes != sb->bytes) return sa->bytes < sb->bytes ? 1 : -1;
+    return strcmp(sa->stack, sb->stack);
+}
+
+void heap_profiler_stats(HeapKindStats out[HEAP_KIND_COUNT], long *peak_bytes,
+                         HeapSiteStats **top_sites, int *num_sites, int max_sites) {
+    pthread_mutex_lock(&heap_lock);
+    memcpy(out, kind_stats, sizeof(kind_stats));
+    *peak_bytes = peak_bytes_total;
+
+    // Copy sites so the caller can build Hemlock values without the lock held
+    // (building them allocates, which re-enters the tracker)
+    HeapSiteStats *copy = NULL;
+    int n = site_count;
+    if (n > 0) {
+        copy = malloc(sizeof(HeapSiteStats) * n);
+        for (int i = 0; i < n; i++) {
+            copy[i] = sites[i];
+            copy[i].stack = strdup(sites[i].stack);
+        }
+    }
+    pthread_mutex_unlock(&heap_lock);
+
+    if (copy) {
+        qsort(copy, n, sizeof(HeapSiteStats), compare_site_live_bytes);
+        for (int i = max_sites; i < n; i++) free(copy[i].stack);
+        if (n > max_sites) n = max_sites;
+    }
+    *top_sites = copy;
+    *num_sites = n;
+}
+
+void heap_sites_free(HeapSiteStats *top_sites, int num_sites) {
+    for (int i = 0; i < num_sites; i++) free(top_sites[i].stack);
+    free(top_sites);
+}
+
+// ========== SNAPSHOT ==========
+
+static void write_json_string(FILE *out, const char *s, int max_len) {
+    fputc('"', out);
+    // A truncated preview still ends on a UTF-8 character boundary
+    for (int i = 0; s[i] && (max_len < 0 || i < max_len || ((unsigned char)s[i] & 0xC0) == 0x80); i++) {
+        unsigned char c = (unsigned char)s[i];
+        switch (c) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (c < 0x20) fprintf(out, "\\u%04x", c);
+                else fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Current size of a live value (its allocation-time size may have grown since)
+static size_t record_current_bytes(HeapRecord *rec) {
+    switch (rec->kind) {
+        case HEAP_KIND_STRING: {
+            String *s = rec->ptr;
+            return sizeof(String) + (size_t)s->capacity;
+        }
+        case HEAP_KIND_ARRAY: {
+            Array *a = rec->ptr;
+            return sizeof(Array) + (size_t)a->capacity * sizeof(Value);
+        }
+        case HEAP_KIND_OBJECT: {
+            Object *o = rec->ptr;
+            return sizeof(Object) + (size_t)o->capacity * (sizeof(Value) + sizeof(char*));
+        }
+        case HEAP_KIND_BUFFER: {
+            Buffer *b = rec->ptr;
+            return sizeof(Buffer) + (size_t)b->capacity;
+        }
+        default:
+            return rec->bytes;
+    }
+}
+
+static void* value_heap_ptr(Value v) {
+    switch (v.type) {
+        case VAL_STRING: return v.as.as_string;
+        case VAL_ARRAY:  return v.as.as_array;
+        case VAL_OBJECT: return v.as.as_object;
+        case VAL_BUFFER: return v.as.as_buffer;
+        default:         return NULL;
+    }
+}
+
+typedef struct {
+    size_t child;   // Record slot of the referenced value
+    size_t parent;  // Record slot of the container
+} HeapEdge;
+
+static int compare_edges(const void *a, const void *b) {
+    const HeapEdge *ea = a;
+    const HeapEdge *eb = b;
+    if (ea->child != eb->child) return ea->child < eb->child ? -1 : 1;
+    if (ea->parent != eb->parent) return ea->parent < eb->parent ? -1 : 1;
+    return 0;
+}
+
+// Write all live values and their referrers as JSON. Holding the lock keeps
+// every tracked value alive (free paths wait on it), so containers can be
+// walked safely; concurrent mutation by running tasks may still be observed
+// mid-update. Returns 0 on success or an errno value.
+int heap_profiler_snapshot(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return errno ? errno : EIO;
+
+    pthread_mutex_lock(&heap_lock);
+
+    // Sequential ids in table order
+    long *ids = malloc(sizeof(long) * (record_capacity ? record_capacity : 1));
+    long next_id = 1;
+    for (size_t i = 0; i < record_capacity; i++) {
+        ids[i] = records[i].ptr ? next_id++ : 0;
+    }
+
+    // Collect container -> child edges
+    HeapEdge *edges = NULL;
+    size_t edge_count = 0, edge_capacity = 0;
+    for (size_t i = 0; i < record_capacity; i++) {
+        HeapRecord *rec = &records[i];
+        if (!rec->ptr) continue;
+        Value *values = NULL;
+        int n = 0;
+        if (rec->kind == HEAP_KIND_ARRAY) {
+            Array *a = rec->ptr;
+            values = a->elements;
+            n = a->length;
+        } else if (rec->kind == HEAP_KIND_OBJECT) {
+            Object *o = rec->ptr;
+            values = o->field_values;
+            n = o->num_fields;
+        }
+        for (int j = 0; j < n; j++) {
+            void *child_ptr = value_heap_ptr(values[j]);
+            if (!child_ptr) continue;
+            HeapRecord *child = records_find(child_ptr);
+            if (!child) continue;
+            if (edge_count >= edge_capacity) {
+                edge_capacity = edge_capacity == 0 ? 1024 : edge_capacity * HML_GROWTH_FACTOR;
+                edges = realloc(edges, sizeof(HeapEdge) * edge_capacity);
+            }
+            edges[edge_count].child = (size_t)(child - records);
+            edges[edge_count].parent = i;
+            edge_count++;
+        }
+    }
+    if (edge_count > 0) {
+        qsort(edges, edge_count, sizeof(HeapEdge), compare_edges);
+    }
+
+    fprintf(out, "{\n  \"live_objects\": %zu,\n  \"live_bytes\": %ld,\n  \"peak_bytes\": %ld,\n",
+            record_count, live_bytes_total, peak_bytes_total);
+    fprintf(out, "  \"sample_interval\": %d,\n  \"objects\": [", HML_HEAP_SAMPLE_INTERVAL);
+
+    int first_object = 1;
+    size_t e = 0;
+    for (size_t i = 0; i < record_capacity; i++) {
+        HeapRecord *rec = &records[i];
+        if (!rec->ptr) continue;
+
+        int ref_count = 0;
+        switch (rec->kind) {
+            case HEAP_KIND_STRING: ref_count = ((String*)rec->ptr)->ref_count; break;
+            case HEAP_KIND_ARRAY:  ref_count = ((Array*)rec->ptr)->ref_count; break;
+            case HEAP_KIND_OBJECT: ref_count = ((Object*)rec->ptr)->ref_count; break;
+            case HEAP_KIND_BUFFER: ref_count = ((Buffer*)rec->ptr)->ref_count; break;
+        }
+
+        fprintf(out, "%s\n    {\"id\": %ld, \"type\": \"%s\", \"bytes\": %zu, \"refcount\": %d",
+                first_object ? "" : ",", ids[i], kind_names[rec->kind],
+                record_current_bytes(rec), ref_count);
+        first_object = 0;
+
+        if (rec->kind == HEAP_KIND_OBJECT && ((Object*)rec->ptr)->type_name) {
+            fputs(", \"class\": ", out);
+            write_json_string(out, ((Object*)rec->ptr)->type_name, -1);
+        } else if (rec->kind == HEAP_KIND_STRING && ((String*)rec->ptr)->data) {
+            fputs(", \"preview\": ", out);
+            write_json_string(out, ((String*)rec->ptr)->data, HML_HEAP_PREVIEW_LENGTH);
+        }
+
+        fputs(", \"site\": ", out);
+        if (rec->site) {
+            write_json_string(out, sites[rec->site - 1].stack, -1);
+        } else {
+            fputs("null", out);
+        }
+
+        fputs(", \"referrers\": [", out);
+        while (e < edge_count && edges[e].child < i) e++;
+        int first_ref = 1;
+        size_t last_parent = (size_t)-1;
+        for (; e < edge_count && edges[e].child == i; e++) {
+            if (edges[e].parent == last_parent) continue;  // Same container, several slots
+            last_parent = edges[e].parent;
+            fprintf(out, "%s%ld", first_ref ? "" : ", ", ids[edges[e].parent]);
+            first_ref = 0;
+        }
+        fputs("]}", out);
+    }
+    fputs("\n  ]\n}\n", out);
+
+    pthread_mutex_unlock(&heap_lock);
+
+    free(edges);
+    free(ids);
+    int failed = ferror(out);
+    if (fclose(out) != 0 || failed) return EIO;
+    return 0;
+}
+
+// ========== LIFECYCLE ==========
+
+static void heap_profiler_report(void) {
+    HeapKindStats stats[HEAP_KIND_COUNT];
+    long peak = 0;
+    HeapSiteStats *top = NULL;
+    int num_top = 0;
+    heap_profiler_stats(stats, &peak, &top, &num_top, HML_PROFILE_TOP_N);
+
+    long live = 0;
+    for (int k = 0; k < HEAP_KIND_COUNT; k++) live += stats[k].live_bytes;
+
+    fflush(stdout);  // Keep program output ahead of the summary
+    fprintf(stderr, "\n=== Heap profile: %ld bytes live at exit, %ld peak ===\n", live, peak);
+    fprintf(stderr, "%-8s %10s %12s %10s %12s\n", "type", "live", "live bytes", "allocs", "alloc bytes");
+    for (int k = 0; k < HEAP_KIND_COUNT; k++) {
+        fprintf(stderr, "%-8s %10ld %12ld %10ld %12ld\n", kind_names[k],
+                stats[k].live, stats[k].live_bytes, stats[k].allocs, stats[k].alloc_bytes);
+    }
+    if (num_top > 0) {
+        fprintf(stderr, "\nSampled allocation sites (1 in %d), by live bytes:\n", HML_HEAP_SAMPLE_INTERVAL);
+        fprintf(stderr, "%10s %12s %10s  %s\n", "live", "live bytes", "allocs", "stack");
+        for (int i = 0; i < num_top; i++) {
+            fprintf(stderr, "%10ld %12ld %10ld  %s\n",
+                    top[i].live, top[i].live_bytes, top[i].allocs, top[i].stack);
+        }
+    }
+    heap_sites_free(top, num_top);
+}
+
+void heap_profiler_enable(ExecutionContext *ctx, int report_at_exit) {
+    heap_thread_stack = &ctx->call_stack;
+    heap_thread_label = "<main>";
+    if (heap_tracking_enabled) return;
+    heap_tracking_enabled = 1;
+    if (report_at_exit) {
+        atexit(heap_profiler_report);
+    }
+}
+
+void heap_profiler_thread_start(ExecutionContext *ctx) {
+    if (!heap_tracking_enabled) return;
+    heap_thread_stack = &ctx->call_stack;
+    heap_thread_label = "<task>";
+}
+
+// Called from exec_context_free so sampling never reads a freed CallStack
+void heap_profiler_context_freed(ExecutionContext *ctx) {
+    if (heap_thread_stack == &ctx->call_stack) {
+        heap_thread_stack = NULL;
+    }
+}
@@ -8,25 +8,38 @@
 
 // ========== CONTROL FLOW STATE ==========
 
+// Which unwinding, if any, is in progress. The flags share one word, so
+// code that only needs to know whether to stop tests flow.any with a single
+// load and branch.
+typedef union {
+    struct {
+        uint8_t is_returning;
+        uint8_t is_breaking;
+        uint8_t is_continuing;
+        uint8_t is_throwing;
+    };
+    uint32_t any;
+} ControlFlow;
+
+// Nothing is unwinding on the common path; these keep the handling out of line
+#define FLOW_UNWINDING(ctx) __builtin_expect((ctx)->flow.any != 0, 0)
+#define FLOW_THROWING(ctx) __builtin_expect((ctx)->flow.is_throwing != 0, 0)
+
 typedef struct {
-    int is_returning;
     Value return_value;
 } ReturnState;
 
 typedef struct {
-    int is_breaking;
-    int is_continuing;
-} LoopState;
-
-typedef struct {
-    int is_throwing;
     Value exception_value;
 } ExceptionState;
 
-// Defer stack - stores deferred expressions (function calls) to execute later
+// Defer stack - deferred calls waiting for their function to return. The
+// calls point into the AST. A deferred call runs its bound form in an
+// environment of just its operands, evaluated at the defer; any other
+// deferred expression runs in the (retained) scope it was deferred in.
 typedef struct {
-    Expr **calls;       // Array of deferred expressions
-    Environment **envs; // Array of environments (captured for each defer)
+    Expr **calls;       // Array of deferred calls
+    Environment **envs; // Environment each call is evaluated in
     int count;
     int capacity;
 } DeferStack;
@@ -54,8 +67,8 @@ typedef struct {
 // Each async task will have its own context (future async support)
 // Note: ExecutionContext is forward-declared in interpreter.h
 struct ExecutionContext {
+    ControlFlow flow;
     ReturnState return_state;
-    LoopState loop_state;
     ExceptionState exception_state;
     CallStack call_stack;
     DeferStack defer_stack;
@@ -103,18 +116,26 @@ extern EnumTypeRegistry enum_types;
 
 // ========== VISITED SET (for cycle detection) ==========
 
-// Internal structure for tracking visited objects/arrays during cycle detection
-// Used by both environment.c (cycle breaking) and values.c (cycle-safe deallocation)
+// Open-addressing hash set of object/array pointers, used for cycle
+// detection by env_break_cycles(), serialize(), value_deep_copy() and
+// printing. The first HML_INITIAL_VISITED_SET_CAPACITY slots are inline, so
+// sets declared on the stack only allocate for larger graphs. A set can also
+// map each pointer to a value (visited_set_put/get).
 typedef struct {
-    void **pointers;
+    void **keys;        // NULL marks an empty slot
+    void **values;      // Parallel to keys, allocated by the first put
     int count;
-    int capacity;
+    int capacity;       // Power of two, at most half full
+    void *inline_keys[HML_INITIAL_VISITED_SET_CAPACITY];
 } VisitedSet;
 
-VisitedSet* visited_set_new(void);
-void visited_set_free(VisitedSet *set);
+void visited_set_init(VisitedSet *set);
+void visited_set_destroy(VisitedSet *set);
 int visited_set_contains(VisitedSet *set, void *ptr);
-void visited_set_add(VisitedSet *set, void *ptr);
+int visited_set_add(VisitedSet *set, void *ptr);  // Returns 0 if already present
+void visited_set_remove(VisitedSet *set, void *ptr);
+void visited_set_put(VisitedSet *set, void *ptr, void *value);
+void* visited_set_get(VisitedSet *set, void *ptr);
 
 // ========== ENVIRONMENT (environment.c) ==========
 
@@ -124,8 +145,11 @@ uint32_t hash_string(const char *str);
 Environment* env_new(Environment *parent);
 void env_free(Environment *env);
 void env_clear(Environment *env);  // Clear variables without deallocating (for loop reuse)
+Environment* env_fork(Environment *env);  // Same parent, copied variables and slots
+Environment* env_capture(Environment *env, char **names, ResolvedVar *captures, int count);  // Flat closure env
 void env_retain(Environment *env);
 void env_release(Environment *env);
+void env_mark_captured(Environment *env);
 void env_define(Environment *env, const char *name, Value value, int is_const, ExecutionContext *ctx);
 // Fast variant that borrows the name string without strdup - caller must ensure name outlives env
 void env_define_borrowed(Environment *env, const char *name, Value value, int is_const, ExecutionContext *ctx);
@@ -133,6 +157,9 @@ void env_define_borrowed(Environment *env, const char *name, Value value, int is
 void env_define_param(Environment *env, const char *name, uint32_t hash, Value value);
 void env_set(Environment *env, const char *name, Value value, ExecutionContext *ctx);
 Value env_get(Environment *env, const char *name, ExecutionContext *ctx);
+// In-place updates: NULL if the variable is const or undefined
+Value *env_assignable_slot(Environment *env, const char *name);
+Value *env_assignable_slot_resolved(Environment *env, int depth, int slot);
 
 // ========== VALUES (values.c) ==========
 
@@ -157,9 +184,18 @@ Value val_function(Function *fn);
 Value val_null(void);
 
 // String operations
+// Every String header is a STRING_BLOCK_SIZE slab block; strings of up to
+// STRING_INLINE_CAPACITY - 1 bytes keep their data right after the header
+#define STRING_BLOCK_SIZE 48
+#define STRING_INLINE_CAPACITY (STRING_BLOCK_SIZE - (int)sizeof(String))
+#define STRING_IS_INLINE(str) ((str)->data == (char *)((str) + 1))
+String* string_alloc(int length);
 String* string_new(const char *cstr);
 String* string_copy(String *str);
 String* string_concat(String *a, String *b);
+// Append a string, rune, number, bool or null to a string nothing else
+// references; returns 0 (and leaves str alone) for other types
+int string_append_value(String *str, Value val);
 void string_free(String *str);
 Value val_string(const char *str);
 Value val_string_take(char *data, int length, int capacity);
@@ -202,6 +238,13 @@ void websocket_free(WebSocketHandle *ws);
 void websocket_retain(WebSocketHandle *ws);
 void websocket_release(WebSocketHandle *ws);
 
+// Buffered writer operations
+WriterHandle *writer_new(FileHandle *file, int fd, int capacity);
+Value val_writer(WriterHandle *writer);
+void writer_free(WriterHandle *writer);
+void writer_retain(WriterHandle *writer);
+void writer_release(WriterHandle *writer);
+
 // Value cleanup and reference counting
 void value_free(Value val);
 void value_retain(Value val);
@@ -211,6 +254,7 @@ void value_release(Value val);
 Reference* reference_new_variable(Environment *env, const char *name);
 Reference* reference_new_array_index(Array *array, int index);
 Reference* reference_new_object_property(Object *object, const char *property);
+Reference* reference_new_arg(Expr *arg_expr, Environment *env, ExecutionContext *ctx);
 void reference_free(Reference *ref);
 Value ref_deref(Reference *ref, ExecutionContext *ctx);
 void ref_assign(Reference *ref, Value value, ExecutionContext *ctx);
@@ -230,6 +274,7 @@ Value val_ref(Reference *ref);
 // Printing
 void print_value(Value val);
 char* value_to_string(Value val);  // Caller must free result
+int value_format_number(Value val, char *dst);  // dst holds STR_NUMBER_MAX bytes
 
 // ========== TYPES (types.c) ==========
 
@@ -278,7 +323,7 @@ Value builtin_join(Value *args, int num_args, ExecutionContext *ctx);
 // Function call utilities
 Value builtin_apply(Value *args, int num_args, ExecutionContext *ctx);
 
-// ========== UTF-8 UTILITIES (utf8.c) ==========
+// ========== UTF-8 UTILITIES (utf8.c, str_kernels.c) ==========
 
 int utf8_count_codepoints(const char *data, int byte_length);
 int utf8_byte_offset(const char *data, int byte_length, int char_index);
@@ -289,6 +334,39 @@ int utf8_char_byte_length(unsigned char first_byte);
 int utf8_validate(const char *data, int byte_length);
 int utf8_is_ascii(const char *data, int byte_length);
 
+// ========== STRING KERNELS (str_kernels.c) ==========
+
+int str_find(const char *hay, int hay_len, const char *needle, int needle_len);
+int str_count(const char *hay, int hay_len, const char *needle, int needle_len);
+void str_ascii_upper(char *dst, const char *src, int len);
+void str_ascii_lower(char *dst, const char *src, int len);
+
+// Codec errors (negative results of the decoders)
+#define STR_CODEC_BAD_CHAR (-1)
+#define STR_CODEC_BAD_PADDING (-2)
+#define STR_CODEC_TRUNCATED (-3)
+
+// Percent-encoding byte classes
+#define STR_PERCENT_KEEP 0
+#define STR_PERCENT_ESCAPE 1
+#define STR_PERCENT_PLUS 2
+
+size_t str_base64_encode(char *dst, const unsigned char *src, size_t len);
+long str_base64_decode(unsigned char *dst, const char *src, size_t len);
+void str_hex_encode(char *dst, const unsigned char *src, size_t len);
+long str_hex_decode(unsigned char *dst, const char *src, size_t len);
+size_t str_percent_encoded_length(const unsigned char *src, size_t len, const unsigned char *classes);
+void str_percent_encode(char *dst, const unsigned char *src, size_t len,
+                        const unsigned char *classes, int upper);
+long str_percent_decode(unsigned char *dst, const char *src, size_t len, int plus_space);
+
+// Room for any formatted number: a 20-digit u64 or a "%g" double
+#define STR_NUMBER_MAX 32
+
+int str_format_u64(char *dst, uint64_t v);
+int str_format_i64(char *dst, int64_t v);
+int str_format_f64(char *dst, double v);
+
 // ========== I/O (io.c) ==========
 
 // Value comparison
@@ -296,6 +374,7 @@ int values_equal(Value a, Value b);
 
 Value call_file_method(FileHandle *file, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 Value call_socket_method(SocketHandle *sock, const char *method, Value *args, int num_args, ExecutionContext *ctx);
+Value call_writer_method(WriterHandle *writer, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 Value call_array_method(Array *arr, const char *method, Value *args, int num_args, int line, ExecutionContext *ctx);
 Value call_string_method(String *str, const char *method, Value *args, int num_args, int line, ExecutionContext *ctx);
 Value call_channel_method(Channel *ch, const char *method, Value *args, int num_args, ExecutionContext *ctx);
@@ -308,6 +387,7 @@ Value get_socket_property(SocketHandle *sock, const char *property, ExecutionCon
 Value builtin_read_line(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_eprint(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_mmap_file(Value *args, int num_args, ExecutionContext *ctx);
 
 // ========== FFI (ffi.c) ==========
 
@@ -392,6 +472,7 @@ const char* get_current_source_file(void);
 // Defer stack helpers
 void defer_stack_init(DeferStack *stack);
 void defer_stack_push(DeferStack *stack, Expr *call, Environment *env);
+void defer_stack_push_bound(DeferStack *stack, Stmt *defer, Environment *env, ExecutionContext *ctx);
 void defer_stack_execute(DeferStack *stack, ExecutionContext *ctx);
 void defer_stack_free(DeferStack *stack);
 
@@ -402,6 +483,191 @@ void runtime_error(ExecutionContext *ctx, const char *format, ...);
 // Runtime error with line number (for better error reporting)
 void runtime_error_at(ExecutionContext *ctx, int line, const char *format, ...);
 
+// ========== PROFILER (profiler.c) ==========
+
+// Start sampling the calling thread (and any task threads that register).
+// output_path: folded stack file written at exit (NULL = default)
+// hz: samples per second of CPU time (<= 0 = default)
+int profiler_start(const char *output_path, int hz, ExecutionContext *ctx);
+
+// Stop sampling and fold samples into owned strings. Must run before the
+// AST is freed since frame names point into it. Safe to call repeatedly.
+void profiler_stop(void);
+int profiler_is_active(void);
+
+// Register/unregister a task thread's call stack for sampling
+void profiler_thread_start(ExecutionContext *ctx);
+void profiler_thread_stop(void);
+
+// ========== HEAP PROFILER (heap_profiler.c) ==========
+
+typedef enum {
+    HEAP_KIND_STRING,
+    HEAP_KIND_ARRAY,
+    HEAP_KIND_OBJECT,
+    HEAP_KIND_BUFFER,
+    HEAP_KIND_COUNT
+} HeapKind;
+
+typedef struct {
+    long live;          // Values currently alive
+    long live_bytes;    // Bytes held by live values (size at allocation)
+    long allocs;        // Allocations since tracking started
+    long alloc_bytes;   // Bytes allocated since tracking started
+} HeapKindStats;
+
+typedef struct {
+    char *stack;        // Folded call stack, "<main>;caller;callee"
+    long allocs;        // Sampled allocations from this stack
+    long bytes;
+    long live;          // Of those, still alive
+    long live_bytes;
+} HeapSiteStats;
+
+// Nonzero once --heap-profile / HEMLOCK_HEAP_PROFILE turned tracking on
+extern int heap_tracking_enabled;
+
+void heap_track_alloc(void *ptr, HeapKind kind, size_t bytes);
+void heap_track_free(void *ptr);
+
+// Hooks for value constructors and free paths: one branch when tracking is off
+#define HEAP_TRACK_ALLOC(ptr, kind, bytes) do { \
+    if (__builtin_expect(heap_tracking_enabled, 0)) heap_track_alloc((ptr), (kind), (bytes)); \
+} while (0)
+#define HEAP_TRACK_FREE(ptr) do { \
+    if (__builtin_expect(heap_tracking_enabled, 0)) heap_track_free(ptr); \
+} while (0)
+
+void heap_profiler_enable(ExecutionContext *ctx, int report_at_exit);
+void heap_profiler_thread_start(ExecutionContext *ctx);
+void heap_profiler_context_freed(ExecutionContext *ctx);
+const char* heap_kind_name(HeapKind kind);
+
+// Copy counters and the top max_sites allocation sites by live bytes
+// (free the sites with heap_sites_free)
+void heap_profiler_stats(HeapKindStats out[HEAP_KIND_COUNT], long *peak_bytes,
+                         HeapSiteStats **top_sites, int *num_sites, int max_sites);
+void heap_sites_free(HeapSiteStats *top_sites, int num_sites);
+
+// Write live values and their referrers as JSON; returns 0 or an errno value
+int heap_profiler_snapshot(const char *path);
+
+// ========== CYCLE COLLECTOR (gc.c) ==========
+
+// Containers the collector traces. Objects, arrays and functions can be
+// reached from values; environments from functions and other environments.
+typedef enum {
+    GC_KIND_OBJECT,
+    GC_KIND_ARRAY,
+    GC_KIND_FUNCTION,
+    GC_KIND_ENV
+} GCKind;
+
+// Container allocations since the last collection, and the count that
+// triggers the next one (read without locking; an occasional lost update
+// only shifts a collection slightly)
+extern int gc_allocations;
+extern int gc_threshold;
+
+// Add a container whose refcount is about to drop to a nonzero value to
+// the candidate buffer; remove one that is being freed
+void gc_buffer_candidate(void *ptr, GCKind kind);
+void gc_forget(void *ptr, GCKind kind);
+
+// Tasks that have been spawned and have not finished. Collection only runs
+// while this is zero, so no other thread can change a refcount under it.
+void gc_task_started(void);
+void gc_task_finished(void);
+
+// Run a collection now; returns the number of containers freed, or -1 if
+// tasks are running
+int gc_collect(void);
+
+// Called at container allocation: collect once enough have been allocated
+void gc_collect_if_due(void);
+
+typedef struct {
+    long collections;
+    long collected;        // Containers freed by the collector, all runs
+    int candidates;        // Containers currently buffered
+    int traced;            // Containers examined by the last collection
+    int threshold;
+    double pause_ms;       // Total time spent collecting
+} GCStats;
+
+void gc_get_stats(GCStats *out);
+
+// Candidate buffering for *_release(): gc_buffered holds the container's
+// buffer index + 1, so already buffered containers skip the call
+#define GC_POSSIBLE_ROOT(ptr, kind) do { \
+    if (!__atomic_load_n(&(ptr)->gc_buffered, __ATOMIC_RELAXED)) gc_buffer_candidate((ptr), (kind)); \
+} while (0)
+#define GC_FORGET(ptr, kind) do { \
+    if (__atomic_load_n(&(ptr)->gc_buffered, __ATOMIC_RELAXED)) gc_forget((ptr), (kind)); \
+} while (0)
+#define GC_NOTE_ALLOCATION() do { \
+    int gc_n_ = __atomic_load_n(&gc_allocations, __ATOMIC_RELAXED) + 1; \
+    __atomic_store_n(&gc_allocations, gc_n_, __ATOMIC_RELAXED); \
+    if (__builtin_expect(gc_n_ >= gc_threshold, 0)) gc_collect_if_due(); \
+} while (0)
+
+// ========== SLAB ALLOCATOR (slab.c) ==========
+
+// Largest request served from slabs (value headers, inline strings)
+#define SLAB_MAX_SIZE 64
+
+// Thread-cached fixed-size blocks. slab_free() must be passed the size
+// given to slab_alloc(); slab_alloc() returns NULL when out of memory.
+void *slab_alloc(size_t size);
+void slab_free(void *ptr, size_t size);
+void slab_note_inline_string(void);
+
+typedef struct {
+    int enabled;           // 0 in sanitizer builds (plain malloc)
+    long allocs;
+    long frees;
+    long inline_strings;   // Strings created with their data inline
+    long depot_blocks;     // Free blocks shared between threads
+    long reserved_bytes;   // Chunk memory obtained from malloc
+} SlabStats;
+
+void slab_get_stats(SlabStats *out);
+
+// ========== CONCURRENCY TRACER (tracer.c) ==========
+
+// trace_record() flags
+#define TRACE_INSTANT 0x1   // Point event; otherwise a span from start to now
+#define TRACE_ARG_PTR 0x2   // Write the argument as a hex address
+
+// Nonzero once --trace / HEMLOCK_TRACE turned recording on
+extern int trace_enabled;
+
+void trace_start(const char *path);
+void trace_thread_start(const char *label, int id);
+uint64_t trace_now(void);
+void trace_record(const char *cat, const char *name, uint64_t start,
+                  const char *arg_name, int64_t arg, int flags);
+void trace_blocked(uint64_t blocked_at, void *channel);
+void trace_channel_op(const char *method, uint64_t start, void *channel);
+
+// Start timestamp for a span, or 0 when tracing is off
+#define TRACE_NOW() (__builtin_expect(trace_enabled, 0) ? trace_now() : 0)
+#define TRACE_SPAN(cat, name, start, arg_name, arg) do { \
+    if (__builtin_expect(trace_enabled, 0)) trace_record((cat), (name), (start), (arg_name), (int64_t)(arg), 0); \
+} while (0)
+#define TRACE_INSTANT_EVENT(cat, name, arg_name, arg) do { \
+    if (__builtin_expect(trace_enabled, 0)) trace_record((cat), (name), 0, (arg_name), (int64_t)(arg), TRACE_INSTANT); \
+} while (0)
+
+// Around condition-variable wait loops: BEGIN inside the loop marks the
+// first wait, END after the loop records the block span and the wake-up
+#define TRACE_BLOCK_BEGIN(blocked_at) do { \
+    if (__builtin_expect(trace_enabled, 0) && !(blocked_at)) (blocked_at) = trace_now(); \
+} while (0)
+#define TRACE_BLOCK_END(blocked_at, channel) do { \
+    if (blocked_at) { trace_blocked((blocked_at), (channel)); (blocked_at) = 0; } \
+} while (0)
+
 // ========== SANDBOX HELPERS ==========
 
 // Check if a specific sandbox restriction is active
@@ -13,7 +13,7 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
     ctx->exception_state.exception_value = val_string(buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -33,7 +33,7 @@ static Value throw_runtime_error_at(ExecutionContext *ctx, int line, const char
 
     ctx->exception_state.exception_value = val_string(full_buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -63,26 +63,26 @@ static Value call_function_value(Value func, Value *args, int num_args, Executio
         // Type check if parameter has type annotation
         if (fn->param_types[i]) {
             arg_value = convert_to_type(arg_value, fn->param_types[i], call_env, ctx);
-            if (ctx->exception_state.is_throwing) {
+            if (ctx->flow.is_throwing) {
                 env_release(call_env);
                 return val_null();
             }
         }
 
         env_set(call_env, fn->param_names[i], arg_value, ctx);
-        if (ctx->exception_state.is_throwing) {
+        if (ctx->flow.is_throwing) {
             env_release(call_env);
             return val_null();
         }
     }
 
     // Execute body
-    ctx->return_state.is_returning = 0;
+    ctx->flow.is_returning = 0;
     eval_stmt(fn->body, call_env, ctx);
 
     // Get return value
-    Value result = ctx->return_state.is_returning ? ctx->return_state.return_value : val_null();
-    ctx->return_state.is_returning = 0;
+    Value result = ctx->flow.is_returning ? ctx->return_state.return_value : val_null();
+    ctx->flow.is_returning = 0;
 
     // Clean up
     env_release(call_env);
@@ -182,13 +182,13 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
                 return throw_runtime_error(ctx, "serialize() expects no arguments");
             }
 
-            SerializeVisitedSet visited;
-            serialize_visited_init(&visited);
+            VisitedSet visited;
+            visited_set_init(&visited);
 
             Value arr_val = val_array(arr);
             char *json = serialize_value(arr_val, &visited, ctx);
 
-            serialize_visited_free(&visited);
+            visited_set_destroy(&visited);
 
             if (json == NULL) {
                 // Exception was already thrown by serialize_value
@@ -250,7 +250,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
             }
             // Check type constraint
             Value check_result = check_array_element_type_for_method(arr, args[0], ctx);
-            if (ctx->exception_state.is_throwing) {
+            if (ctx->flow.is_throwing) {
                 return check_result;
             }
 
@@ -297,7 +297,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
             }
             // Check type constraint
             Value check_result = check_array_element_type_for_method(arr, args[1], ctx);
-            if (ctx->exception_state.is_throwing) {
+            if (ctx->flow.is_throwing) {
                 return check_result;
             }
 
@@ -410,7 +410,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
 
                 // Call the reducer function
                 Value new_accumulator = call_function_value(args[0], reducer_args, 2, ctx);
-                if (ctx->exception_state.is_throwing) {
+                if (ctx->flow.is_throwing) {
                     value_release(accumulator);
                     return val_null();
                 }
@@ -455,7 +455,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
 
                 // Call the predicate function
                 Value predicate_result = call_function_value(args[0], callback_args, 1, ctx);
-                if (ctx->exception_state.is_throwing) {
+                if (ctx->flow.is_throwing) {
                     // Clean up and propagate exception
                     return val_null();
                 }
@@ -649,7 +649,7 @@ Value call_array_method(Array *arr, const char *method, Value *args, int num_arg
 
                 // Call the callback function
                 Value mapped = call_function_value(args[0], callback_args, 1, ctx);
-                if (ctx->exception_state.is_throwing) {
+                if (ctx->flow.is_throwing) {
                     // Clean up and propagate exception
                     return val_null();
                 }
@@ -14,7 +14,7 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
     ctx->exception_state.exception_value = val_string(buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -52,9 +52,12 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
             pthread_cond_signal(not_empty);
 
             // Wait for receiver to pick up the value
+            uint64_t blocked_at = 0;
             while (ch->sender_waiting && !ch->closed) {
+                TRACE_BLOCK_BEGIN(blocked_at);
                 pthread_cond_wait(rendezvous, mutex);
             }
+            TRACE_BLOCK_END(blocked_at, ch);
 
             // Check if we were woken because channel closed
             if (ch->closed && ch->sender_waiting) {
@@ -70,9 +73,12 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
         }
 
         // Buffered channel - wait while buffer is full
+        uint64_t blocked_at = 0;
         while (ch->count >= ch->capacity && !ch->closed) {
+            TRACE_BLOCK_BEGIN(blocked_at);
             pthread_cond_wait(not_full, mutex);
         }
+        TRACE_BLOCK_END(blocked_at, ch);
 
         // Check again if closed after waking up
         if (ch->closed) {
@@ -106,9 +112,12 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
         if (ch->capacity == 0) {
             // Unbuffered channel - rendezvous with sender
             // Wait for sender to have data available
+            uint64_t blocked_at = 0;
             while (!ch->sender_waiting && !ch->closed) {
+                TRACE_BLOCK_BEGIN(blocked_at);
                 pthread_cond_wait(not_empty, mutex);
             }
+            TRACE_BLOCK_END(blocked_at, ch);
 
             // If channel is closed and no sender waiting, return null
             if (!ch->sender_waiting && ch->closed) {
@@ -129,9 +138,12 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
         }
 
         // Buffered channel - wait while buffer is empty
+        uint64_t blocked_at = 0;
         while (ch->count == 0 && !ch->closed) {
+            TRACE_BLOCK_BEGIN(blocked_at);
             pthread_cond_wait(not_empty, mutex);
         }
+        TRACE_BLOCK_END(blocked_at, ch);
 
         // If channel is closed and empty, return null
         if (ch->count == 0 && ch->closed) {
@@ -180,13 +192,17 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
             pthread_cond_t *rendezvous = (pthread_cond_t*)ch->rendezvous;
 
             // Wait for sender to have data available (with timeout)
+            uint64_t blocked_at = 0;
             while (!ch->sender_waiting && !ch->closed) {
+                TRACE_BLOCK_BEGIN(blocked_at);
                 int rc = pthread_cond_timedwait(not_empty, mutex, &deadline);
                 if (rc == ETIMEDOUT) {
                     pthread_mutex_unlock(mutex);
+                    TRACE_BLOCK_END(blocked_at, ch);
                     return val_null();  // Timeout
                 }
             }
+            TRACE_BLOCK_END(blocked_at, ch);
 
             // If channel is closed and no sender waiting, return null
             if (!ch->sender_waiting && ch->closed) {
@@ -207,13 +223,17 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
         }
 
         // Wait while buffer is empty and channel not closed
+        uint64_t blocked_at = 0;
         while (ch->count == 0 && !ch->closed) {
+            TRACE_BLOCK_BEGIN(blocked_at);
             int rc = pthread_cond_timedwait(not_empty, mutex, &deadline);
             if (rc == ETIMEDOUT) {
                 pthread_mutex_unlock(mutex);
+                TRACE_BLOCK_END(blocked_at, ch);
                 return val_null();  // Timeout
             }
         }
+        TRACE_BLOCK_END(blocked_at, ch);
 
         // If channel is closed and empty, return null
         if (ch->count == 0 && ch->closed) {
@@ -277,7 +297,9 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
             pthread_cond_signal(not_empty);
 
             // Wait for receiver to pick up the value (with timeout)
+            uint64_t blocked_at = 0;
             while (ch->sender_waiting && !ch->closed) {
+                TRACE_BLOCK_BEGIN(blocked_at);
                 int rc = pthread_cond_timedwait(rendezvous, mutex, &deadline);
                 if (rc == ETIMEDOUT) {
                     // Timeout - clean up and return failure
@@ -285,9 +307,11 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
                     value_release(*(ch->unbuffered_value));
                     *(ch->unbuffered_value) = val_null();
                     pthread_mutex_unlock(mutex);
+                    TRACE_BLOCK_END(blocked_at, ch);
                     return val_bool(0);  // Timeout - send failed
                 }
             }
+            TRACE_BLOCK_END(blocked_at, ch);
 
             // Check if we were woken because channel closed
             if (ch->closed && ch->sender_waiting) {
@@ -303,13 +327,17 @@ Value call_channel_method(Channel *ch, const char *method, Value *args, int num_
         }
 
         // Wait while buffer is full
+        uint64_t blocked_at = 0;
         while (ch->count >= ch->capacity && !ch->closed) {
+            TRACE_BLOCK_BEGIN(blocked_at);
             int rc = pthread_cond_timedwait(not_full, mutex, &deadline);
             if (rc == ETIMEDOUT) {
                 pthread_mutex_unlock(mutex);
+                TRACE_BLOCK_END(blocked_at, ch);
                 return val_bool(0);  // Timeout - send failed
             }
         }
+        TRACE_BLOCK_END(blocked_at, ch);
 
         // Check again if closed after waking up
         if (ch->closed) {
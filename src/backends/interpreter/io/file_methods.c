@@ -1,6 +1,14 @@
 #include "internal.h"
 #include <stdarg.h>
 #include <stdatomic.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// stdio buffer for files opened for reading; read_line() scans it with memchr
+#define FILE_READ_BUFFER_SIZE (64 * 1024)
 
 // ========== RUNTIME ERROR HELPER ==========
 
@@ -13,10 +21,40 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
     ctx->exception_state.exception_value = val_string(buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
+// ========== LINE READING ==========
+
+// Read the next line into the handle's line buffer, without the trailing
+// "\n" or "\r\n". Returns the line length, -1 at end of file, or -2 on error
+// (with an exception set).
+static long file_next_line(FileHandle *file, ExecutionContext *ctx) {
+    ssize_t read = getdelim(&file->line_buf, &file->line_cap, '\n', file->fp);
+    if (read == -1) {
+        if (ferror(file->fp)) {
+            throw_runtime_error(ctx, "Read error on file '%s': %s", file->path, strerror(errno));
+            return -2;
+        }
+        return -1;
+    }
+    if (read > 0 && file->line_buf[read - 1] == '\n') read--;
+    if (read > 0 && file->line_buf[read - 1] == '\r') read--;
+    if (read > INT_MAX - 1) {
+        throw_runtime_error(ctx, "Line too long in file '%s'", file->path);
+        return -2;
+    }
+    return (long)read;
+}
+
+static Value string_from_span(const char *data, int length) {
+    String *str = string_alloc(length);
+    if (length > 0) memcpy(str->data, data, length);
+    str->data[length] = '\0';
+    return (Value){ .type = VAL_STRING, .as.as_string = str };
+}
+
 // ========== FILE METHOD HANDLING ==========
 
 Value call_file_method(FileHandle *file, const char *method, Value *args, int num_args, ExecutionContext *ctx) {
@@ -55,14 +93,7 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
                             file->path, strerror(errno));
                 }
 
-                String *str = malloc(sizeof(String));
-                str->data = buffer;
-                str->length = read_bytes;
-                str->char_length = -1;
-                str->capacity = size + 1;
-                str->ref_count = 1;
-
-                return (Value){ .type = VAL_STRING, .as.as_string = str };
+                return val_string_take(buffer, read_bytes, size + 1);
             } else {
                 // Non-seekable stream (stdin, pipe, socket): read in chunks
                 size_t capacity = 4096;
@@ -100,14 +131,7 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
 
                 buffer[total_read] = '\0';
 
-                String *str = malloc(sizeof(String));
-                str->data = buffer;
-                str->length = total_read;
-                str->char_length = -1;
-                str->capacity = capacity;
-                str->ref_count = 1;
-
-                return (Value){ .type = VAL_STRING, .as.as_string = str };
+                return val_string_take(buffer, total_read, capacity);
             }
         } else if (num_args == 1) {
             // Read specified number of bytes
@@ -133,14 +157,7 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
                         file->path, strerror(errno));
             }
 
-            String *str = malloc(sizeof(String));
-            str->data = buffer;
-            str->length = read_bytes;
-            str->char_length = -1;
-            str->capacity = size + 1;
-            str->ref_count = 1;  // Start with 1 - caller owns the first reference
-
-            return (Value){ .type = VAL_STRING, .as.as_string = str };
+            return val_string_take(buffer, read_bytes, size + 1);
         } else {
             return throw_runtime_error(ctx, "read() expects 0-1 arguments");
         }
@@ -158,12 +175,14 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
 
         int size = value_to_int(args[0]);
         if (size <= 0) {
-            Buffer *buf = malloc(sizeof(Buffer));
+            Buffer *buf = slab_alloc(sizeof(Buffer));
             buf->data = malloc(1);
             buf->length = 0;
             buf->capacity = 0;
             buf->ref_count = 1;  // Start with 1 - caller owns the first reference
             atomic_store(&buf->freed, 0);  // Not freed
+            buf->mapped = 0;
+            HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
             return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
         }
 
@@ -179,13 +198,15 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
                     file->path, strerror(errno));
         }
 
-        Buffer *buf = malloc(sizeof(Buffer));
+        Buffer *buf = slab_alloc(sizeof(Buffer));
         buf->data = data;
         buf->length = read_bytes;
         buf->capacity = size;
         buf->ref_count = 1;  // Start with 1 - caller owns the first reference
         atomic_store(&buf->freed, 0);  // Not freed
+        buf->mapped = 0;
 
+        HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
         return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
     }
 
@@ -290,6 +311,43 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
         return val_i32((int32_t)pos);
     }
 
+    // read_line(): string | null - next line without its terminator, null at EOF
+    if (strcmp(method, "read_line") == 0) {
+        if (file->closed) {
+            return throw_runtime_error(ctx, "Cannot read from closed file '%s'", file->path);
+        }
+        if (num_args != 0) {
+            return throw_runtime_error(ctx, "read_line() expects no arguments");
+        }
+
+        long len = file_next_line(file, ctx);
+        if (len < 0) return val_null();
+        return string_from_span(file->line_buf, (int)len);
+    }
+
+    // lines(): array - remaining lines of the file
+    if (strcmp(method, "lines") == 0) {
+        if (file->closed) {
+            return throw_runtime_error(ctx, "Cannot read from closed file '%s'", file->path);
+        }
+        if (num_args != 0) {
+            return throw_runtime_error(ctx, "lines() expects no arguments");
+        }
+
+        Array *lines = array_new();
+        long len;
+        while ((len = file_next_line(file, ctx)) >= 0) {
+            Value line = string_from_span(file->line_buf, (int)len);
+            array_push(lines, line);
+            value_release(line);
+        }
+        if (len == -2) {
+            array_free(lines);
+            return val_null();
+        }
+        return val_array(lines);
+    }
+
     // close() - close file (idempotent)
     if (strcmp(method, "close") == 0) {
         if (num_args != 0) {
@@ -301,6 +359,11 @@ Value call_file_method(FileHandle *file, const char *method, Value *args, int nu
             fclose(file->fp);
             file->fp = NULL;
             file->closed = 1;
+            free(file->stdio_buf);
+            file->stdio_buf = NULL;
+            free(file->line_buf);
+            file->line_buf = NULL;
+            file->line_cap = 0;
         }
         return val_null();
     }
@@ -315,7 +378,7 @@ Value builtin_read_line(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 0) {
         ctx->exception_state.exception_value = val_string("read_line() expects no arguments");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -338,20 +401,14 @@ Value builtin_read_line(Value *args, int num_args, ExecutionContext *ctx) {
         read--;
     }
 
-    String *str = malloc(sizeof(String));
-    str->data = line;
-    str->length = read;
-    str->capacity = len;
-    str->ref_count = 1;  // Start with 1 - caller owns the first reference
-
-    return (Value){ .type = VAL_STRING, .as.as_string = str };
+    return val_string_take(line, read, len);
 }
 
 Value builtin_eprint(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args != 1) {
         ctx->exception_state.exception_value = val_string("eprint() expects 1 argument");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -399,18 +456,51 @@ Value builtin_eprint(Value *args, int num_args, ExecutionContext *ctx) {
     return val_null();
 }
 
+// Wrap an open stream as a file value
+Value file_wrap(FILE *fp, const char *path, const char *mode) {
+    FileHandle *file = malloc(sizeof(FileHandle));
+    file->fp = fp;
+    file->path = strdup(path);
+    file->mode = strdup(mode);
+    file->closed = 0;
+    file->stdio_buf = NULL;
+    file->line_buf = NULL;
+    file->line_cap = 0;
+
+    // Larger reads mean fewer syscalls for read_line() and lines()
+    if (mode[0] == 'r') {
+        file->stdio_buf = malloc(FILE_READ_BUFFER_SIZE);
+        if (file->stdio_buf && setvbuf(fp, file->stdio_buf, _IOFBF, FILE_READ_BUFFER_SIZE) != 0) {
+            free(file->stdio_buf);
+            file->stdio_buf = NULL;
+        }
+    }
+
+    return val_file(file);
+}
+
+// Wrap a descriptor (such as a pipe end) as a file value; closing the file
+// closes fd. Returns null with errno set if fd cannot be opened as a stream.
+Value file_from_fd(int fd, const char *mode, const char *name) {
+    FILE *fp = fdopen(fd, mode);
+    if (!fp) {
+        return val_null();
+    }
+    return file_wrap(fp, name, mode);
+}
+
 Value builtin_open(Value *args, int num_args, ExecutionContext *ctx) {
     if (num_args < 1 || num_args > 2) {
         ctx->exception_state.exception_value = val_string("open() expects 1-2 arguments (path, [mode])");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
     if (args[0].type != VAL_STRING) {
         ctx->exception_state.exception_value = val_string("open() path must be a string");
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
@@ -421,7 +511,7 @@ Value builtin_open(Value *args, int num_args, ExecutionContext *ctx) {
         if (args[1].type != VAL_STRING) {
             ctx->exception_state.exception_value = val_string("open() mode must be a string");
             value_retain(ctx->exception_state.exception_value);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
             return val_null();
         }
         mode = args[1].as.as_string->data;
@@ -447,15 +537,71 @@ Value builtin_open(Value *args, int num_args, ExecutionContext *ctx) {
                 path, mode, strerror(errno));
         ctx->exception_state.exception_value = val_string(error_msg);
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
         return val_null();
     }
 
-    FileHandle *file = malloc(sizeof(FileHandle));
-    file->fp = fp;
-    file->path = strdup(path);
-    file->mode = strdup(mode);
-    file->closed = 0;
+    return file_wrap(fp, path, mode);
+}
 
-    return val_file(file);
+// mmap_file(path) - a whole file as a private, writable buffer. Writes are
+// copy-on-write: they change only the buffer and never reach the file.
+Value builtin_mmap_file(Value *args, int num_args, ExecutionContext *ctx) {
+    if (num_args != 1 || args[0].type != VAL_STRING) {
+        return throw_runtime_error(ctx, "mmap_file() expects 1 string argument (path)");
+    }
+    const char *path = args[0].as.as_string->data;
+
+    if (!sandbox_path_allowed(ctx, path, 0)) {
+        sandbox_error(ctx, "file read outside sandbox root");
+        return val_null();
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return throw_runtime_error(ctx, "Failed to open '%s': %s", path, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        return throw_runtime_error(ctx, "Failed to stat '%s': %s", path, strerror(err));
+    }
+    if (!S_ISREG(st.st_mode)) {
+        close(fd);
+        return throw_runtime_error(ctx, "mmap_file() requires a regular file: '%s'", path);
+    }
+    if (st.st_size > INT_MAX) {
+        close(fd);
+        return throw_runtime_error(ctx, "File '%s' is too large to map (limit is 2GB)", path);
+    }
+
+    int size = (int)st.st_size;
+    void *data;
+    int mapped = 0;
+    if (size == 0) {
+        // Zero-length mappings are not allowed
+        data = malloc(1);
+    } else {
+        data = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            return throw_runtime_error(ctx, "Failed to map '%s': %s", path, strerror(err));
+        }
+        posix_madvise(data, (size_t)size, POSIX_MADV_SEQUENTIAL);
+        mapped = 1;
+    }
+    close(fd);
+
+    Buffer *buf = slab_alloc(sizeof(Buffer));
+    buf->data = data;
+    buf->length = size;
+    buf->capacity = size;
+    buf->ref_count = 1;  // Start with 1 - caller owns the first reference
+    atomic_store(&buf->freed, 0);  // Not freed
+    buf->mapped = mapped;
+
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer));
+    return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
 }
@@ -10,14 +10,6 @@
 
 // ========== SERIALIZATION SUPPORT ==========
 
-// Cycle detection for JSON serialization (uses Object** specifically)
-// Note: This is distinct from VisitedSet in internal.h which uses void** for general cycle detection
-typedef struct {
-    Object **visited;
-    int count;
-    int capacity;
-} SerializeVisitedSet;
-
 // JSON parsing
 typedef struct {
     const char *input;
@@ -25,12 +17,8 @@ typedef struct {
 } JSONParser;
 
 // Serialization functions
-void serialize_visited_init(SerializeVisitedSet *set);
-int serialize_visited_contains(SerializeVisitedSet *set, Object *obj);
-void serialize_visited_add(SerializeVisitedSet *set, Object *obj);
-void serialize_visited_free(SerializeVisitedSet *set);
 char* escape_json_string(const char *str);
-char* serialize_value(Value val, SerializeVisitedSet *visited, ExecutionContext *ctx);
+char* serialize_value(Value val, VisitedSet *visited, ExecutionContext *ctx);
 
 // JSON parsing functions
 void json_skip_whitespace(JSONParser *p);
@@ -48,6 +36,8 @@ int values_equal(Value a, Value b);
 // ========== METHOD HANDLERS ==========
 
 // File methods
+Value file_wrap(FILE *fp, const char *path, const char *mode);
+Value file_from_fd(int fd, const char *mode, const char *name);
 Value call_file_method(FileHandle *file, const char *method, Value *args, int num_args, ExecutionContext *ctx);
 
 // Array methods
@@ -67,5 +57,6 @@ Value call_object_method(Object *obj, const char *method, Value *args, int num_a
 Value builtin_read_line(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_eprint(Value *args, int num_args, ExecutionContext *ctx);
 Value builtin_open(Value *args, int num_args, ExecutionContext *ctx);
+Value builtin_mmap_file(Value *args, int num_args, ExecutionContext *ctx);
 
 #endif // HEMLOCK_IO_INTERNAL_H
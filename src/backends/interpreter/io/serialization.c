@@ -14,7 +14,7 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
     ctx->exception_state.exception_value = val_string(buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -124,10 +124,10 @@ static inline void jbuf_append_escaped_string(JsonBuffer *buf, const char *str,
 }
 
 // Forward declaration for recursive serialization
-static int serialize_to_buffer(Value val, JsonBuffer *buf, SerializeVisitedSet *visited, ExecutionContext *ctx);
+static int serialize_to_buffer(Value val, JsonBuffer *buf, VisitedSet *visited, ExecutionContext *ctx);
 
 // Recursive serialization that writes directly to buffer
-static int serialize_to_buffer(Value val, JsonBuffer *buf, SerializeVisitedSet *visited, ExecutionContext *ctx) {
+static int serialize_to_buffer(Value val, JsonBuffer *buf, VisitedSet *visited, ExecutionContext *ctx) {
     char tmp[32];
 
     switch (val.type) {
@@ -184,11 +184,10 @@ static int serialize_to_buffer(Value val, JsonBuffer *buf, SerializeVisitedSet *
             Object *obj = val.as.as_object;
 
             // Check for cycles
-            if (serialize_visited_contains(visited, obj)) {
+            if (!visited_set_add(visited, obj)) {
                 throw_runtime_error(ctx, "serialize() detected circular reference");
                 return 0;
             }
-            serialize_visited_add(visited, obj);
 
             jbuf_append_char(buf, '{');
 
@@ -213,11 +212,10 @@ static int serialize_to_buffer(Value val, JsonBuffer *buf, SerializeVisitedSet *
             Array *arr = val.as.as_array;
 
             // Check for cycles
-            if (serialize_visited_contains(visited, (Object*)arr)) {
+            if (!visited_set_add(visited, arr)) {
                 throw_runtime_error(ctx, "serialize() detected circular reference");
                 return 0;
             }
-            serialize_visited_add(visited, (Object*)arr);
 
             jbuf_append_char(buf, '[');
 
@@ -238,35 +236,6 @@ static int serialize_to_buffer(Value val, JsonBuffer *buf, SerializeVisitedSet *
     }
 }
 
-// ========== SERIALIZATION VISITED SET ==========
-
-void serialize_visited_init(SerializeVisitedSet *set) {
-    set->capacity = 16;
-    set->count = 0;
-    set->visited = malloc(sizeof(Object*) * set->capacity);
-}
-
-int serialize_visited_contains(SerializeVisitedSet *set, Object *obj) {
-    for (int i = 0; i < set->count; i++) {
-        if (set->visited[i] == obj) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
-void serialize_visited_add(SerializeVisitedSet *set, Object *obj) {
-    if (set->count >= set->capacity) {
-        set->capacity *= 2;
-        set->visited = realloc(set->visited, sizeof(Object*) * set->capacity);
-    }
-    set->visited[set->count++] = obj;
-}
-
-void serialize_visited_free(SerializeVisitedSet *set) {
-    free(set->visited);
-}
-
 // Helper to escape strings for JSON (legacy - kept for compatibility)
 char* escape_json_string(const char *str) {
     int escape_count = 0;
@@ -305,7 +274,7 @@ char* escape_json_string(const char *str) {
 }
 
 // Optimized serialize_value using the buffer-based approach
-char* serialize_value(Value val, SerializeVisitedSet *visited, ExecutionContext *ctx) {
+char* serialize_value(Value val, VisitedSet *visited, ExecutionContext *ctx) {
     JsonBuffer buf;
     jbuf_init(&buf, 256);
 
@@ -535,7 +504,7 @@ Value json_parse_object(JSONParser *p, ExecutionContext *ctx) {
     // Handle empty object
     if (p->input[p->pos] == '}') {
         p->pos++;
-        Object *obj = malloc(sizeof(Object));
+        Object *obj = slab_alloc(sizeof(Object));
         obj->field_names = field_names;
         obj->field_values = field_values;
         obj->num_fields = 0;
@@ -543,8 +512,11 @@ Value json_parse_object(JSONParser *p, ExecutionContext *ctx) {
         obj->type_name = NULL;
         obj->ref_count = 1;  // Start with 1 - caller owns the first reference
         atomic_store(&obj->freed, 0);  // Not freed
+    obj->gc_buffered = 0;
         obj->hash_table = NULL;  // No hash table for empty objects
         obj->hash_capacity = 0;
+        HEAP_TRACK_ALLOC(obj, HEAP_KIND_OBJECT,
+                         sizeof(Object) + obj->capacity * (sizeof(Value) + sizeof(char*)));
         return val_object(obj);
     }
 
@@ -553,7 +525,7 @@ Value json_parse_object(JSONParser *p, ExecutionContext *ctx) {
 
         // Parse field name (must be a string)
         Value name_val = json_parse_string(p, ctx);
-        if (ctx->exception_state.is_throwing) {
+        if (ctx->flow.is_throwing) {
             // Clean up and propagate error
             for (int i = 0; i < num_fields; i++) {
                 free(field_names[i]);
@@ -585,7 +557,7 @@ Value json_parse_object(JSONParser *p, ExecutionContext *ctx) {
 
         // Parse field value
         field_values[num_fields] = json_parse_value(p, ctx);
-        if (ctx->exception_state.is_throwing) {
+        if (ctx->flow.is_throwing) {
             // Clean up and propagate error
             for (int i = 0; i < num_fields; i++) {
                 free(field_names[i]);
@@ -626,7 +598,7 @@ Value json_parse_object(JSONParser *p, ExecutionContext *ctx) {
     }
     p->pos++;  // skip closing brace
 
-    Object *obj = malloc(sizeof(Object));
+    Object *obj = slab_alloc(sizeof(Object));
     obj->field_names = field_names;
     obj->field_values = field_values;
     obj->num_fields = num_fields;
@@ -634,8 +606,11 @@ Value json_parse_object(JSONParser *p, ExecutionContext *ctx) {
     obj->type_name = NULL;
     obj->ref_count = 1;  // Start with 1 - caller owns the first reference
     atomic_store(&obj->freed, 0);  // Not freed
+    obj->gc_buffered = 0;
     obj->hash_table = NULL;  // No hash table - use linear search fallback
     obj->hash_capacity = 0;
+    HEAP_TRACK_ALLOC(obj, HEAP_KIND_OBJECT,
+                     sizeof(Object) + obj->capacity * (sizeof(Value) + sizeof(char*)));
     return val_object(obj);
 }
 
@@ -660,7 +635,7 @@ Value json_parse_array(JSONParser *p, ExecutionContext *ctx) {
 
         // Parse element value
         Value element = json_parse_value(p, ctx);
-        if (ctx->exception_state.is_throwing) {
+        if (ctx->flow.is_throwing) {
             // Error already set, just return
             return val_null();
         }
@@ -771,13 +746,13 @@ Value call_object_method(Object *obj, const char *method, Value *args, int num_a
             return throw_runtime_error(ctx, "serialize() expects no arguments");
         }
 
-        SerializeVisitedSet visited;
-        serialize_visited_init(&visited);
+        VisitedSet visited;
+        visited_set_init(&visited);
 
         Value obj_val = val_object(obj);
         char *json = serialize_value(obj_val, &visited, ctx);
 
-        serialize_visited_free(&visited);
+        visited_set_destroy(&visited);
 
         if (json == NULL) {
             // Exception was already thrown by serialize_value
@@ -1,6 +1,7 @@
 #include "internal.h"
 #include <stdarg.h>
 #include <stdatomic.h>
+#include <limits.h>
 
 // ========== RUNTIME ERROR HELPER ==========
 
@@ -13,7 +14,7 @@ static Value throw_runtime_error(ExecutionContext *ctx, const char *format, ...)
 
     ctx->exception_state.exception_value = val_string(buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -33,7 +34,7 @@ static Value throw_runtime_error_at(ExecutionContext *ctx, int line, const char
 
     ctx->exception_state.exception_value = val_string(full_buffer);
     value_retain(ctx->exception_state.exception_value);
-    ctx->exception_state.is_throwing = 1;
+    ctx->flow.is_throwing = 1;
     return val_null();
 }
 
@@ -42,6 +43,14 @@ static __thread int current_line = 0;
 
 // ========== STRING METHOD HANDLING ==========
 
+// New string holding a copy of len bytes (inline when short)
+static Value string_from_span(const char *data, int len) {
+    String *result = string_alloc(len);
+    memcpy(result->data, data, len);
+    result->data[len] = '\0';
+    return (Value){ .type = VAL_STRING, .as.as_string = result };
+}
+
 Value call_string_method(String *str, const char *method, Value *args, int num_args, int line, ExecutionContext *ctx) {
     current_line = line;  // Store for potential use in nested error messages
     // Fast dispatch by first character to reduce strcmp calls
@@ -89,21 +98,9 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
                 return throw_runtime_error(ctx, "contains() argument must be a string");
             }
 
+            // Empty string is always contained
             String *needle = args[0].as.as_string;
-            if (needle->length == 0) {
-                return val_bool(1);  // Empty string is always contained
-            }
-            if (needle->length > str->length) {
-                return val_bool(0);
-            }
-
-            // Search for needle
-            for (int i = 0; i <= str->length - needle->length; i++) {
-                if (memcmp(str->data + i, needle->data, needle->length) == 0) {
-                    return val_bool(1);
-                }
-            }
-            return val_bool(0);
+            return val_bool(str_find(str->data, str->length, needle->data, needle->length) >= 0);
         }
         // char_at(index) - get character at index (returns rune)
         if (method[1] == 'h' && method[2] == 'a' && method[3] == 'r' && method[4] == '_' && strcmp(method, "char_at") == 0) {
@@ -171,7 +168,7 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
             Value result = json_parse_value(&parser, ctx);
 
             // Check if parsing threw an error
-            if (ctx->exception_state.is_throwing) {
+            if (ctx->flow.is_throwing) {
                 return val_null();  // Error already set in ctx
             }
 
@@ -214,21 +211,9 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
                 return throw_runtime_error(ctx, "find() argument must be a string");
             }
 
+            // Empty string found at position 0, -1 if not found
             String *needle = args[0].as.as_string;
-            if (needle->length == 0) {
-                return val_i32(0);  // Empty string found at position 0
-            }
-            if (needle->length > str->length) {
-                return val_i32(-1);  // Needle longer than haystack
-            }
-
-            // Search for needle in haystack
-            for (int i = 0; i <= str->length - needle->length; i++) {
-                if (memcmp(str->data + i, needle->data, needle->length) == 0) {
-                    return val_i32(i);
-                }
-            }
-            return val_i32(-1);  // Not found
+            return val_i32(str_find(str->data, str->length, needle->data, needle->length));
         }
         break;
 
@@ -245,33 +230,24 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
             String *old = args[0].as.as_string;
             String *new = args[1].as.as_string;
 
-            // Find first occurrence
-            int pos = -1;
-            for (int i = 0; i <= str->length - old->length; i++) {
-                if (memcmp(str->data + i, old->data, old->length) == 0) {
-                    pos = i;
-                    break;
-                }
-            }
-
-            // If not found, return original string
+            // If not found, return a copy of the original string
+            int pos = str_find(str->data, str->length, old->data, old->length);
             if (pos == -1) {
-                return val_string(str->data);
+                return (Value){ .type = VAL_STRING, .as.as_string = string_copy(str) };
+            }
+            if (new->length - old->length > INT_MAX - str->length) {
+                return throw_runtime_error(ctx, "replace() result too large");
             }
 
             // Build new string with replacement
             int new_len = str->length - old->length + new->length;
-            char *result = malloc(new_len + 1);
-            if (result == NULL) {
-                return throw_runtime_error(ctx, "replace() out of memory");
-            }
+            String *result = string_alloc(new_len);
+            memcpy(result->data, str->data, pos);
+            memcpy(result->data + pos, new->data, new->length);
+            memcpy(result->data + pos + new->length, str->data + pos + old->length, str->length - pos - old->length);
+            result->data[new_len] = '\0';
 
-            memcpy(result, str->data, pos);
-            memcpy(result + pos, new->data, new->length);
-            memcpy(result + pos + new->length, str->data + pos + old->length, str->length - pos - old->length);
-            result[new_len] = '\0';
-
-            return val_string_take(result, new_len, new_len + 1);
+            return (Value){ .type = VAL_STRING, .as.as_string = result };
         }
         // replace_all(old, new) - replace all occurrences
         if (method[1] == 'e' && method[2] == 'p' && method[3] == 'l' && strcmp(method, "replace_all") == 0) {
@@ -285,44 +261,34 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
             String *old = args[0].as.as_string;
             String *new = args[1].as.as_string;
 
-            if (old->length == 0) {
-                return val_string(str->data);  // Cannot replace empty string
-            }
-
-            // Count occurrences
-            int count = 0;
-            for (int i = 0; i <= str->length - old->length; i++) {
-                if (memcmp(str->data + i, old->data, old->length) == 0) {
-                    count++;
-                    i += old->length - 1;  // Skip past this occurrence
-                }
-            }
-
+            // Cannot replace empty string; no matches needs no replacements
+            int count = old->length == 0 ? 0 : str_count(str->data, str->length, old->data, old->length);
             if (count == 0) {
-                return val_string(str->data);  // No replacements needed
+                return (Value){ .type = VAL_STRING, .as.as_string = string_copy(str) };
             }
 
-            // Build new string
-            int new_len = str->length - (count * old->length) + (count * new->length);
-            char *result = malloc(new_len + 1);
-            if (result == NULL) {
-                return throw_runtime_error(ctx, "replace_all() out of memory");
+            int64_t new_len64 = (int64_t)str->length + (int64_t)count * (new->length - old->length);
+            if (new_len64 > INT_MAX - 1) {
+                return throw_runtime_error(ctx, "replace_all() result too large");
             }
-            int result_pos = 0;
 
-            for (int i = 0; i < str->length; ) {
-                // Check for match
-                if (i <= str->length - old->length && memcmp(str->data + i, old->data, old->length) == 0) {
-                    memcpy(result + result_pos, new->data, new->length);
-                    result_pos += new->length;
-                    i += old->length;
-                } else {
-                    result[result_pos++] = str->data[i++];
-                }
-            }
-            result[new_len] = '\0';
-
-            return val_string_take(result, new_len, new_len + 1);
+            // Copy the text between matches, then the replacement
+            int new_len = (int)new_len64;
+            String *result = string_alloc(new_len);
+            int result_pos = 0;
+            int i = 0;
+            for (int k = 0; k < count; k++) {
+                int at = i + str_find(str->data + i, str->length - i, old->data, old->length);
+                memcpy(result->data + result_pos, str->data + i, at - i);
+                result_pos += at - i;
+                memcpy(result->data + result_pos, new->data, new->length);
+                result_pos += new->length;
+                i = at + old->length;
+            }
+            memcpy(result->data + result_pos, str->data + i, str->length - i);
+            result->data[new_len] = '\0';
+
+            return (Value){ .type = VAL_STRING, .as.as_string = result };
         }
         // repeat(count) - repeat string n times
         if (method[1] == 'e' && method[2] == 'p' && method[3] == 'e' && strcmp(method, "repeat") == 0) {
@@ -460,48 +426,22 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
             if (delim->length == 0) {
                 // Empty delimiter: split into individual characters
                 for (int i = 0; i < str->length; i++) {
-                    char *char_str = malloc(2);
-                    if (char_str == NULL) {
-                        // Clean up already allocated array elements
-                        VALUE_RELEASE(val_array(result));
-                        return throw_runtime_error(ctx, "split() out of memory");
-                    }
-                    char_str[0] = str->data[i];
-                    char_str[1] = '\0';
-                    array_push(result, val_string_take(char_str, 1, 2));
+                    array_push(result, string_from_span(str->data + i, 1));
                 }
                 return val_array(result);
             }
 
-            // Split by delimiter
+            // Split by delimiter, one block search per part
             int start = 0;
-            for (int i = 0; i <= str->length - delim->length; i++) {
-                if (memcmp(str->data + i, delim->data, delim->length) == 0) {
-                    // Found delimiter, extract substring
-                    int len = i - start;
-                    char *part = malloc(len + 1);
-                    if (part == NULL) {
-                        VALUE_RELEASE(val_array(result));
-                        return throw_runtime_error(ctx, "split() out of memory");
-                    }
-                    memcpy(part, str->data + start, len);
-                    part[len] = '\0';
-                    array_push(result, val_string_take(part, len, len + 1));
-                    i += delim->length - 1;  // Skip past delimiter
-                    start = i + 1;
-                }
+            for (;;) {
+                int at = str_find(str->data + start, str->length - start, delim->data, delim->length);
+                if (at < 0) break;
+                array_push(result, string_from_span(str->data + start, at));
+                start += at + delim->length;
             }
 
             // Add remaining part
-            int len = str->length - start;
-            char *part = malloc(len + 1);
-            if (part == NULL) {
-                VALUE_RELEASE(val_array(result));
-                return throw_runtime_error(ctx, "split() out of memory");
-            }
-            memcpy(part, str->data + start, len);
-            part[len] = '\0';
-            array_push(result, val_string_take(part, len, len + 1));
+            array_push(result, string_from_span(str->data + start, str->length - start));
 
             return val_array(result);
         }
@@ -544,19 +484,9 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
                 end--;
             }
 
+            // Empty when all whitespace
             int len = end - start + 1;
-            if (len <= 0) {
-                return val_string("");  // All whitespace
-            }
-
-            char *trimmed = malloc(len + 1);
-            if (trimmed == NULL) {
-                return throw_runtime_error(ctx, "trim() out of memory");
-            }
-            memcpy(trimmed, str->data + start, len);
-            trimmed[len] = '\0';
-
-            return val_string_take(trimmed, len, len + 1);
+            return string_from_span(str->data + start, len > 0 ? len : 0);
         }
         // to_upper() - convert to uppercase
         if (method[1] == 'o' && method[2] == '_' && method[3] == 'u' && strcmp(method, "to_upper") == 0) {
@@ -564,21 +494,13 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
                 return throw_runtime_error(ctx, "to_upper() expects no arguments");
             }
 
-            char *upper = malloc(str->length + 1);
-            if (upper == NULL) {
-                return throw_runtime_error(ctx, "to_upper() out of memory");
-            }
-            for (int i = 0; i < str->length; i++) {
-                char c = str->data[i];
-                if (c >= 'a' && c <= 'z') {
-                    upper[i] = c - HML_ASCII_CASE_OFFSET;  // Convert to uppercase
-                } else {
-                    upper[i] = c;
-                }
-            }
-            upper[str->length] = '\0';
+            // Case folding keeps the codepoint count
+            String *upper = string_alloc(str->length);
+            str_ascii_upper(upper->data, str->data, str->length);
+            upper->data[str->length] = '\0';
+            upper->char_length = str->char_length;
 
-            return val_string_take(upper, str->length, str->length + 1);
+            return (Value){ .type = VAL_STRING, .as.as_string = upper };
         }
         // to_lower() - convert to lowercase
         if (method[1] == 'o' && method[2] == '_' && method[3] == 'l' && strcmp(method, "to_lower") == 0) {
@@ -586,21 +508,12 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
                 return throw_runtime_error(ctx, "to_lower() expects no arguments");
             }
 
-            char *lower = malloc(str->length + 1);
-            if (lower == NULL) {
-                return throw_runtime_error(ctx, "to_lower() out of memory");
-            }
-            for (int i = 0; i < str->length; i++) {
-                char c = str->data[i];
-                if (c >= 'A' && c <= 'Z') {
-                    lower[i] = c + HML_ASCII_CASE_OFFSET;  // Convert to lowercase
-                } else {
-                    lower[i] = c;
-                }
-            }
-            lower[str->length] = '\0';
+            String *lower = string_alloc(str->length);
+            str_ascii_lower(lower->data, str->data, str->length);
+            lower->data[str->length] = '\0';
+            lower->char_length = str->char_length;
 
-            return val_string_take(lower, str->length, str->length + 1);
+            return (Value){ .type = VAL_STRING, .as.as_string = lower };
         }
         // to_bytes() - convert string to buffer
         if (method[1] == 'o' && method[2] == '_' && method[3] == 'b' && strcmp(method, "to_bytes") == 0) {
@@ -608,13 +521,13 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
                 return throw_runtime_error(ctx, "to_bytes() expects no arguments");
             }
 
-            Buffer *buf = malloc(sizeof(Buffer));
+            Buffer *buf = slab_alloc(sizeof(Buffer));
             if (buf == NULL) {
                 return throw_runtime_error(ctx, "to_bytes() out of memory");
             }
             buf->data = malloc(str->length);
             if (buf->data == NULL) {
-                free(buf);
+                slab_free(buf, sizeof(Buffer));
                 return throw_runtime_error(ctx, "to_bytes() out of memory");
             }
             memcpy(buf->data, str->data, str->length);
@@ -622,7 +535,9 @@ Value call_string_method(String *str, const char *method, Value *args, int num_a
             buf->capacity = str->length;
             buf->ref_count = 1;  // Start with 1 - caller owns the first reference
             atomic_store(&buf->freed, 0);  // Not freed
+            buf->mapped = 0;
 
+            HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
             return (Value){ .type = VAL_BUFFER, .as.as_buffer = buf };
         }
         break;
@@ -3,6 +3,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <errno.h>
 #include <zlib.h>
 #include "lexer.h"
 #include "parser.h"
@@ -28,6 +29,69 @@
 extern void ffi_init(void);
 extern void ffi_cleanup(void);
 
+// Folded stack output path when --profile is given (NULL = profiling off)
+static const char *profile_output = NULL;
+
+// Set by --heap-profile (HEMLOCK_HEAP_PROFILE=1 also enables it)
+static int heap_profile = 0;
+
+// Trace-event output path when --trace is given (HEMLOCK_TRACE=FILE also sets it)
+static const char *trace_output = NULL;
+
+// stdout buffer size from --stdout-buffer (HEMLOCK_STDOUT_BUFFER also sets it)
+static long long stdout_buffer = 0;
+
+// Parse a byte count with an optional K/M/G suffix; -1 if malformed
+static long long parse_size(const char *text) {
+    char *end;
+    errno = 0;
+    long long n = strtoll(text, &end, 10);
+    if (errno != 0 || end == text || n < 0) return -1;
+    switch (*end) {
+        case 'k': case 'K': n *= 1024LL; end++; break;
+        case 'm': case 'M': n *= 1024LL * 1024; end++; break;
+        case 'g': case 'G': n *= 1024LL * 1024 * 1024; end++; break;
+        default: break;
+    }
+    if (*end == 'b' || *end == 'B') end++;
+    return *end == '\0' ? n : -1;
+}
+
+// Give stdout a larger buffer: fully buffered when redirected, flushed per
+// line on a TTY, and flushed by stdio at exit
+static void setup_stdout_buffer(void) {
+    const char *env = getenv("HEMLOCK_STDOUT_BUFFER");
+    if (stdout_buffer == 0 && env && env[0]) {
+        stdout_buffer = parse_size(env);
+    }
+    if (stdout_buffer <= 0) return;
+
+    // setvbuf ignores the size when stdio allocates the buffer itself
+    char *buf = malloc((size_t)stdout_buffer);
+    if (!buf) return;
+    int mode = isatty(STDOUT_FILENO) ? _IOLBF : _IOFBF;
+    if (setvbuf(stdout, buf, mode, (size_t)stdout_buffer) != 0) {
+        free(buf);
+    }
+}
+
+static void start_profiler_if_enabled(ExecutionContext *ctx) {
+    if (profile_output != NULL) {
+        profiler_start(profile_output, 0, ctx);
+    }
+    const char *heap_env = getenv("HEMLOCK_HEAP_PROFILE");
+    if (heap_profile || (heap_env && heap_env[0] && strcmp(heap_env, "0") != 0)) {
+        heap_profiler_enable(ctx, 1);
+    }
+    const char *trace_env = getenv("HEMLOCK_TRACE");
+    if (trace_output == NULL && trace_env && trace_env[0]) {
+        trace_output = trace_env;
+    }
+    if (trace_output != NULL) {
+        trace_start(trace_output);
+    }
+}
+
 // Read entire file into a string (caller must free)
 static char* read_file(const char *path) {
     FILE *file = fopen(path, "rb");
@@ -103,8 +167,10 @@ static void run_source(const char *source, int argc, char **argv, int stack_dept
     }
 
     register_builtins(env, argc, argv, ctx);
+    start_profiler_if_enabled(ctx);
 
     eval_program(statements, stmt_count, env, ctx);
+    profiler_stop();
 
     // Cleanup
     exec_context_free(ctx);
@@ -254,9 +320,11 @@ static int run_embedded_payload(uint8_t *payload, size_t payload_size, int argc,
     Environment *env = env_new(NULL);
     ExecutionContext *ctx = exec_context_new();
     register_builtins(env, argc, argv, ctx);
+    start_profiler_if_enabled(ctx);
 
     // Execute
     eval_program(statements, stmt_count, env, ctx);
+    profiler_stop();
 
     // Cleanup
     exec_context_free(ctx);
@@ -327,6 +395,7 @@ static void run_file(const char *path, int argc, char **argv, int stack_depth, i
         // Need to set up builtins in a global environment first
         Environment *global_env = env_new(NULL);
         register_builtins(global_env, argc, argv, ctx);
+        start_profiler_if_enabled(ctx);
 
         // Execute with module system
         int result = execute_file_with_modules(path, global_env, argc, argv, ctx);
@@ -808,6 +877,7 @@ static void run_hmlc_file(const char *path, int argc, char **argv, int stack_dep
 
     // Execute
     eval_program(statements, stmt_count, env, ctx);
+    profiler_stop();
 
     // Cleanup
     exec_context_free(ctx);
@@ -949,6 +1019,15 @@ static void print_help(const char *program) {
     printf("    --debug              Include line numbers in compiled output\n");
     printf("    --verbose            Print progress during bundling/packaging\n");
     printf("    --stack-depth <N>    Set maximum call stack depth (default: 10000)\n");
+    printf("    --profile[=FILE]     Sample CPU usage; write folded stacks to FILE\n");
+    printf("                         (default: hemlock-profile.folded) and print a summary\n");
+    printf("    --heap-profile       Track live strings/arrays/objects/buffers; print a\n");
+    printf("                         heap summary at exit (enables heap_snapshot())\n");
+    printf("    --trace[=FILE]       Record task/channel events as Chrome trace JSON\n");
+    printf("                         (default: hemlock-trace.json)\n");
+    printf("    --stdout-buffer=<SIZE>\n");
+    printf("                         Buffer stdout with SIZE bytes (e.g. 64K, 1M); flushed\n");
+    printf("                         at exit, and per line when stdout is a terminal\n");
     printf("    --sandbox [DIR]      Run in sandbox mode (restricts dangerous operations)\n");
     printf("                         Disables: FFI, network, process spawning, file writes\n");
     printf("                         If DIR provided, restricts file reads to that directory\n\n");
@@ -967,6 +1046,7 @@ static void print_help(const char *program) {
     printf("    %s --package app.hml --no-compress -o myapp\n", program);
     printf("    %s --info app.hmlc         # Show compiled file info\n", program);
     printf("    %s --stack-depth 50000 script.hml  # Run with larger stack\n", program);
+    printf("    %s --profile=out.folded script.hml # Profile script.hml\n", program);
     printf("    %s lsp                 # Start LSP server (stdio)\n", program);
     printf("    %s lsp --tcp 6969      # Start LSP server (TCP)\n", program);
     printf("    %s --sandbox script.hml    # Run in sandbox mode\n", program);
@@ -1119,6 +1199,30 @@ int main(int argc, char **argv) {
                 return 1;
             }
             i++;  // Skip the value argument
+        } else if (strcmp(argv[i], "--profile") == 0) {
+            profile_output = HML_PROFILE_DEFAULT_OUTPUT;
+        } else if (strncmp(argv[i], "--profile=", 10) == 0) {
+            profile_output = argv[i] + 10;
+            if (profile_output[0] == '\0') {
+                fprintf(stderr, "Error: --profile= requires a file path\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            trace_output = HML_TRACE_DEFAULT_OUTPUT;
+        } else if (strncmp(argv[i], "--trace=", 8) == 0) {
+            trace_output = argv[i] + 8;
+            if (trace_output[0] == '\0') {
+                fprintf(stderr, "Error: --trace= requires a file path\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--heap-profile") == 0) {
+            heap_profile = 1;
+        } else if (strncmp(argv[i], "--stdout-buffer=", 16) == 0) {
+            stdout_buffer = parse_size(argv[i] + 16);
+            if (stdout_buffer <= 0) {
+                fprintf(stderr, "Error: Invalid --stdout-buffer size '%s'\n", argv[i] + 16);
+                return 1;
+            }
         } else if (strcmp(argv[i], "--info") == 0) {
             info_mode = 1;
             if (i + 1 >= argc) {
@@ -1169,6 +1273,8 @@ int main(int argc, char **argv) {
         }
     }
 
+    setup_stdout_buffer();
+
     // Execute based on what was specified
 
     // Handle compile mode
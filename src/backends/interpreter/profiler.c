@@ -0,0 +1,425 @@
+/*
+ * Hemlock Sampling CPU Profiler
+ *
+ * Enabled with `hemlock --profile[=FILE] script.hml`.
+ *
+ * A SIGPROF interval timer (ITIMER_PROF, CPU time) interrupts whichever
+ * thread is running Hemlock code. The signal handler snapshots that thread's
+ * CallStack - the same frames used for stack traces - into a preallocated
+ * sample buffer. Nothing in the handler allocates or locks; it only reserves
+ * slots with an atomic add and copies frame name pointers.
+ *
+ * Frame names point into the AST, so samples must be folded into owned
+ * strings (profiler_stop) before the program's statements are freed. At exit
+ * the folded stacks are written in the flamegraph.pl / speedscope "folded"
+ * format and a top-N self/total table is printed to stderr.
+ */
+
+#include "internal.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+// Sample record layout in the buffer: [depth][thread label][frame 0 (root)] ... [frame depth-1 (leaf)]
+#define PROFILE_RECORD_HEADER 2
+#define PROFILE_RECORD_END UINTPTR_MAX
+
+static const char *profile_output_path = NULL;
+static int profile_interval_us = 0;
+
+static uintptr_t *sample_buffer = NULL;
+static atomic_size_t sample_cursor = 0;
+static atomic_long samples_dropped = 0;
+static atomic_int handlers_in_flight = 0;
+static atomic_int profiler_active = 0;
+static int profiler_started = 0;
+static int profiler_stopped = 0;
+static struct sigaction previous_sigprof;
+
+// Each thread registers the call stack it is executing on
+static __thread CallStack *profiled_stack = NULL;
+static __thread const char *profiled_label = NULL;
+
+// ========== SIGNAL HANDLER ==========
+
+static void profiler_sigprof_handler(int sig) {
+    (void)sig;
+    int saved_errno = errno;
+
+    atomic_fetch_add(&handlers_in_flight, 1);
+    if (!atomic_load(&profiler_active) || profiled_stack == NULL) {
+        atomic_fetch_sub(&handlers_in_flight, 1);
+        errno = saved_errno;
+        return;
+    }
+
+    CallStack *stack = profiled_stack;
+    int depth = stack->count;
+    int first = 0;
+    if (depth > HML_PROFILE_MAX_DEPTH) {
+        // Keep the leaf-most frames: they carry the self time
+        first = depth - HML_PROFILE_MAX_DEPTH;
+        depth = HML_PROFILE_MAX_DEPTH;
+    }
+
+    size_t need = (size_t)depth + PROFILE_RECORD_HEADER;
+    size_t pos = atomic_fetch_add(&sample_cursor, need);
+    if (pos + need > HML_PROFILE_BUFFER_SLOTS) {
+        // Only the record straddling the end owns slots in the buffer;
+        // mark it so folding stops there
+        if (pos < HML_PROFILE_BUFFER_SLOTS) {
+            sample_buffer[pos] = PROFILE_RECORD_END;
+        }
+        atomic_fetch_add(&samples_dropped, 1);
+    } else {
+        uintptr_t *rec = sample_buffer + pos;
+        rec[0] = (uintptr_t)depth;
+        rec[1] = (uintptr_t)profiled_label;
+        for (int i = 0; i < depth; i++) {
+            rec[PROFILE_RECORD_HEADER + i] = (uintptr_t)stack->frames[first + i].function_name;
+        }
+    }
+
+    atomic_fetch_sub(&handlers_in_flight, 1);
+    errno = saved_errno;
+}
+
+// ========== FOLDED STACK AGGREGATION ==========
+
+typedef struct {
+    char *key;
+    long count;
+} FoldedEntry;
+
+typedef struct {
+    char *name;
+    long self;
+    long total;
+} FunctionEntry;
+
+// Entries live in growable arrays; an open-addressing index of array
+// positions (+1, 0 = empty) keyed by string hash makes lookups O(1).
+typedef struct {
+    int *slots;
+    int capacity;  // Power of two
+} NameIndex;
+
+static FoldedEntry *folded = NULL;
+static int folded_count = 0;
+static int folded_capacity = 0;
+static NameIndex folded_index = {NULL, 0};
+
+static FunctionEntry *functions = NULL;
+static int function_count = 0;
+static int function_capacity = 0;
+static NameIndex function_index = {NULL, 0};
+
+static long total_samples = 0;
+
+static uint32_t profile_hash(const char *s) {
+    uint32_t h = HML_DJB2_HASH_SEED;
+    while (*s) h = ((h << 5) + h) + (unsigned char)*s++;
+    return h;
+}
+
+// Return the entry position for key, or -1 with *slot_out set to the empty slot to fill
+static int name_index_find(NameIndex *index, const char *key, const char *(*key_at)(int), int *slot_out) {
+    uint32_t mask = (uint32_t)index->capacity - 1;
+    uint32_t i = profile_hash(key) & mask;
+    while (index->slots[i] != 0) {
+        int pos = index->slots[i] - 1;
+        if (strcmp(key_at(pos), key) == 0) return pos;
+        i = (i + 1) & mask;
+    }
+    *slot_out = (int)i;
+    return -1;
+}
+
+// Keep the load factor under 1/2; rebuilds the index from the entry array
+static void name_index_reserve(NameIndex *index, int count, const char *(*key_at)(int)) {
+    if (index->capacity != 0 && (count + 1) * 2 <= index->capacity) return;
+    int capacity = index->capacity == 0 ? 256 : index->capacity * HML_GROWTH_FACTOR;
+    free(index->slots);
+    index->slots = calloc(capacity, sizeof(int));
+    index->capacity = capacity;
+    for (int pos = 0; pos < count; pos++) {
+        int slot = 0;
+        name_index_find(index, key_at(pos), key_at, &slot);
+        index->slots[slot] = pos + 1;
+    }
+}
+
+static const char* folded_key_at(int pos) { return folded[pos].key; }
+static const char* function_key_at(int pos) { return functions[pos].name; }
+
+static void folded_add(const char *key, long count) {
+    name_index_reserve(&folded_index, folded_count, folded_key_at);
+    int slot = 0;
+    int pos = name_index_find(&folded_index, key, folded_key_at, &slot);
+    if (pos >= 0) {
+        folded[pos].count += count;
+        return;
+    }
+    if (folded_count >= folded_capacity) {
+        folded_capacity = folded_capacity == 0 ? 64 : folded_capacity * HML_GROWTH_FACTOR;
+        folded = realloc(folded, sizeof(FoldedEntry) * folded_capacity);
+    }
+    folded[folded_count].key = strdup(key);
+    folded[folded_count].count = count;
+    folded_index.slots[slot] = ++folded_count;
+}
+
+static FunctionEntry* function_lookup(const char *name) {
+    name_index_reserve(&function_index, function_count, function_key_at);
+    int slot = 0;
+    int pos = name_index_find(&function_index, name, function_key_at, &slot);
+    if (pos >= 0) return &functions[pos];
+    if (function_count >= function_capacity) {
+        function_capacity = function_capacity == 0 ? 64 : function_capacity * HML_GROWTH_FACTOR;
+        functions = realloc(functions, sizeof(FunctionEntry) * function_capacity);
+    }
+    FunctionEntry *entry = &functions[function_count];
+    entry->name = strdup(name);
+    entry->self = 0;
+    entry->total = 0;
+    function_index.slots[slot] = ++function_count;
+    return entry;
+}
+
+// Fold the raw sample buffer into "root;caller;leaf count" lines.
+// Consecutive identical stacks (the common case in hot loops) are merged
+// before the hash lookup.
+static void profiler_fold_samples(void) {
+    size_t end = atomic_load(&sample_cursor);
+    if (end > HML_PROFILE_BUFFER_SLOTS) end = HML_PROFILE_BUFFER_SLOTS;
+
+    size_t key_capacity = 256;
+    char *key = malloc(key_capacity);
+    char *prev_key = NULL;
+    long prev_count = 0;
+    const char *seen[HML_PROFILE_MAX_DEPTH + 1];
+
+    size_t pos = 0;
+    while (pos + PROFILE_RECORD_HEADER <= end) {
+        uintptr_t *rec = sample_buffer + pos;
+        if (rec[0] == PROFILE_RECORD_END) break;
+        int depth = (int)rec[0];
+        if (pos + PROFILE_RECORD_HEADER + (size_t)depth > end) break;
+        pos += PROFILE_RECORD_HEADER + (size_t)depth;
+
+        // Build the folded key, root first
+        const char *label = rec[1] ? (const char*)rec[1] : "<main>";
+        size_t len = 0;
+        for (int i = -1; i < depth; i++) {
+            const char *name = i < 0 ? label : (const char*)rec[PROFILE_RECORD_HEADER + i];
+            if (!name) name = "<anonymous>";
+            size_t name_len = strlen(name);
+            if (len + name_len + 2 > key_capacity) {
+                while (len + name_len + 2 > key_capacity) key_capacity *= HML_GROWTH_FACTOR;
+                key = realloc(key, key_capacity);
+            }
+            if (i >= 0) key[len++] = ';';
+            memcpy(key + len, name, name_len);
+            len += name_len;
+        }
+        key[len] = '\0';
+
+        if (prev_key && strcmp(prev_key, key) == 0) {
+            prev_count++;
+        } else {
+            if (prev_key) {
+                folded_add(prev_key, prev_count);
+                free(prev_key);
+            }
+            prev_key = strdup(key);
+            prev_count = 1;
+        }
+
+        // Self time goes to the leaf; total time once per distinct function
+        // on the stack so recursion is not double counted
+        const char *leaf = depth > 0 ? (const char*)rec[PROFILE_RECORD_HEADER + depth - 1] : label;
+        function_lookup(leaf ? leaf : "<anonymous>")->self++;
+        int seen_count = 0;
+        for (int i = -1; i < depth; i++) {
+            const char *name = i < 0 ? label : (const char*)rec[PROFILE_RECORD_HEADER + i];
+            if (!name) name = "<anonymous>";
+            int dup = 0;
+            for (int j = 0; j < seen_count; j++) {
+                if (seen[j] == name || strcmp(seen[j], name) == 0) {
+                    dup = 1;
+                    break;
+                }
+            }
+            if (!dup) {
+                seen[seen_count++] = name;
+                function_lookup(name)->total++;
+            }
+        }
+        total_samples++;
+    }
+
+    if (prev_key) {
+        folded_add(prev_key, prev_count);
+        free(prev_key);
+    }
+    free(key);
+}
+
+// ========== REPORTING ==========
+
+static int compare_self_desc(const void *a, const void *b) {
+    const FunctionEntry *fa = a;
+    const FunctionEntry *fb = b;
+    if (fa->self != fb->self) return fa->self < fb->self ? 1 : -1;
+    if (fa->total != fb->total) return fa->total < fb->total ? 1 : -1;
+    return strcmp(fa->name, fb->name);
+}
+
+static void profiler_report(void) {
+    if (!profiler_started) return;
+    profiler_stop();
+    fflush(stdout);  // Keep program output ahead of the summary
+
+    FILE *out = fopen(profile_output_path, "w");
+    if (out) {
+        for (int i = 0; i < folded_count; i++) {
+            fprintf(out, "%s %ld\n", folded[i].key, folded[i].count);
+        }
+        fclose(out);
+    } else {
+        fprintf(stderr, "Warning: Could not write profile to '%s': %s\n",
+                profile_output_path, strerror(errno));
+    }
+
+    qsort(functions, function_count, sizeof(FunctionEntry), compare_self_desc);
+
+    double interval_ms = profile_interval_us / 1000.0;
+    fprintf(stderr, "\n=== Profile: %ld samples (%.1fms interval), %ld dropped -> %s ===\n",
+            total_samples, interval_ms, atomic_load(&samples_dropped), profile_output_path);
+    if (total_samples > 0) {
+        fprintf(stderr, "%8s %7s %8s %7s  %s\n", "self", "self%", "total", "total%", "function");
+        int shown = function_count < HML_PROFILE_TOP_N ? function_count : HML_PROFILE_TOP_N;
+        for (int i = 0; i < shown; i++) {
+            FunctionEntry *fe = &functions[i];
+            fprintf(stderr, "%8ld %6.1f%% %8ld %6.1f%%  %s\n",
+                    fe->self, 100.0 * fe->self / total_samples,
+                    fe->total, 100.0 * fe->total / total_samples, fe->name);
+        }
+    }
+
+    for (int i = 0; i < folded_count; i++) free(folded[i].key);
+    free(folded);
+    folded = NULL;
+    folded_count = folded_capacity = 0;
+    for (int i = 0; i < function_count; i++) free(functions[i].name);
+    free(functions);
+    functions = NULL;
+    function_count = function_capacity = 0;
+    free(folded_index.slots);
+    free(function_index.slots);
+    folded_index = (NameIndex){NULL, 0};
+    function_index = (NameIndex){NULL, 0};
+    free(sample_buffer);
+    sample_buffer = NULL;
+    profiler_started = 0;
+}
+
+// ========== PUBLIC API ==========
+
+int profiler_start(const char *output_path, int hz, ExecutionContext *ctx) {
+    if (profiler_started) return 0;
+    if (hz <= 0) hz = HML_PROFILE_DEFAULT_HZ;
+
+    sample_buffer = malloc(sizeof(uintptr_t) * HML_PROFILE_BUFFER_SLOTS);
+    if (!sample_buffer) {
+        fprintf(stderr, "Error: Failed to allocate profiler sample buffer\n");
+        return -1;
+    }
+
+    profile_output_path = output_path ? output_path : HML_PROFILE_DEFAULT_OUTPUT;
+    profile_interval_us = 1000000 / hz;
+    if (profile_interval_us <= 0) profile_interval_us = 1;
+
+    profiled_stack = &ctx->call_stack;
+    profiled_label = "<main>";
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = profiler_sigprof_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, &previous_sigprof) != 0) {
+        fprintf(stderr, "Error: Failed to install profiler signal handler: %s\n", strerror(errno));
+        free(sample_buffer);
+        sample_buffer = NULL;
+        return -1;
+    }
+
+    profiler_started = 1;
+    profiler_stopped = 0;
+    atomic_store(&profiler_active, 1);
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = profile_interval_us / 1000000;
+    timer.it_interval.tv_usec = profile_interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    // Covers exit() paths (uncaught exceptions, exit()) that skip profiler_stop
+    atexit(profiler_report);
+    return 0;
+}
+
+void profiler_thread_start(ExecutionContext *ctx) {
+    if (!atomic_load(&profiler_active)) return;
+
+    profiled_label = "<task>";
+    profiled_stack = &ctx->call_stack;
+
+    // Task threads block every signal; let SIGPROF through so they get sampled
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    pthread_sigmask(SIG_UNBLOCK, &set, NULL);
+}
+
+void profiler_thread_stop(void) {
+    if (profiled_stack == NULL) return;
+
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+    profiled_stack = NULL;
+}
+
+int profiler_is_active(void) {
+    return atomic_load(&profiler_active);
+}
+
+void profiler_stop(void) {
+    if (!profiler_started || profiler_stopped) return;
+    profiler_stopped = 1;
+
+    struct itimerval off;
+    memset(&off, 0, sizeof(off));
+    setitimer(ITIMER_PROF, &off, NULL);
+    atomic_store(&profiler_active, 0);
+
+    // Let any handler that already passed the active check finish its copy
+    while (atomic_load(&handlers_in_flight) > 0) {
+        struct timespec ts = {0, 100000};
+        nanosleep(&ts, NULL);
+    }
+    sigaction(SIGPROF, &previous_sigprof, NULL);
+    profiled_stack = NULL;
+
+    // Frame names still point into the AST here - copy them out now
+    profiler_fold_samples();
+}
@@ -10,6 +10,28 @@
 #include <stdio.h>
 #include "resolver.h"
 
+/*
+ * Grow a resolver array to hold at least one more element.
+ */
+static void *grow_array(void *items, int count, int *capacity, size_t size) {
+    if (count < *capacity) return items;
+    *capacity = *capacity ? *capacity * 2 : 8;
+    return realloc(items, size * (size_t)*capacity);
+}
+
+/*
+ * Add name to a list of borrowed names unless it is already there.
+ * Returns its index.
+ */
+static int name_list_add(const char ***names, int *count, int *capacity, const char *name) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp((*names)[i], name) == 0) return i;
+    }
+    *names = grow_array(*names, *count, capacity, sizeof(char *));
+    (*names)[*count] = name;
+    return (*count)++;
+}
+
 /*
  * Create a new resolver scope.
  */
@@ -18,6 +40,8 @@ static ResolverScope *scope_new(ResolverScope *parent) {
     scope->count = 0;
     scope->capacity = 8;
     scope->names = malloc(sizeof(char *) * scope->capacity);
+    scope->bindings = malloc(sizeof(int) * scope->capacity);
+    scope->first_function = 0;
     scope->parent = parent;
     return scope;
 }
@@ -31,6 +55,7 @@ static void scope_free(ResolverScope *scope) {
         free(scope->names[i]);
     }
     free(scope->names);
+    free(scope->bindings);
     free(scope);
 }
 
@@ -38,7 +63,7 @@ static void scope_free(ResolverScope *scope) {
  * Create a new resolver context.
  */
 ResolverContext *resolver_new(void) {
-    ResolverContext *ctx = malloc(sizeof(ResolverContext));
+    ResolverContext *ctx = calloc(1, sizeof(ResolverContext));
     ctx->current = scope_new(NULL);  // Global scope
     ctx->scope_depth = 0;
     return ctx;
@@ -56,6 +81,15 @@ void resolver_free(ResolverContext *ctx) {
         scope_free(scope);
         scope = parent;
     }
+    for (int i = 0; i < ctx->num_functions; i++) {
+        free(ctx->functions[i].captures);
+        free(ctx->functions[i].capture_bindings);
+        free(ctx->functions[i].unresolved);
+    }
+    free(ctx->functions);
+    free(ctx->active);
+    free(ctx->binding_flags);
+    free(ctx->dynamic_names);
     free(ctx);
 }
 
@@ -64,6 +98,7 @@ void resolver_free(ResolverContext *ctx) {
  */
 void resolver_enter_scope(ResolverContext *ctx) {
     ctx->current = scope_new(ctx->current);
+    ctx->current->first_function = ctx->num_functions;
     ctx->scope_depth++;
 }
 
@@ -76,6 +111,21 @@ void resolver_exit_scope(ResolverContext *ctx) {
         return;
     }
     ResolverScope *old = ctx->current;
+
+    // A function inside this scope that used a name before the scope defined
+    // it finds that variable by name at runtime, so it needs the real chain
+    for (int f = old->first_function; f < ctx->num_functions && old->count > 0; f++) {
+        ResolverFunction *fn = &ctx->functions[f];
+        for (int u = 0; u < fn->num_unresolved && !fn->keep_chain; u++) {
+            for (int i = 0; i < old->count; i++) {
+                if (strcmp(old->names[i], fn->unresolved[u]) == 0) {
+                    fn->keep_chain = 1;
+                    break;
+                }
+            }
+        }
+    }
+
     ctx->current = old->parent;
     ctx->scope_depth--;
     scope_free(old);
@@ -92,10 +142,16 @@ int resolver_define(ResolverContext *ctx, const char *name) {
     if (scope->count >= scope->capacity) {
         scope->capacity *= 2;
         scope->names = realloc(scope->names, sizeof(char *) * scope->capacity);
+        scope->bindings = realloc(scope->bindings, sizeof(int) * scope->capacity);
     }
 
+    ctx->binding_flags = grow_array(ctx->binding_flags, ctx->num_bindings,
+                                    &ctx->binding_capacity, sizeof(unsigned char));
+    ctx->binding_flags[ctx->num_bindings] = 0;
+
     int slot = scope->count;
-    scope->names[scope->count++] = strdup(name);
+    scope->names[scope->count] = strdup(name);
+    scope->bindings[scope->count++] = ctx->num_bindings++;
     return slot;
 }
 
@@ -130,6 +186,176 @@ int resolver_lookup(ResolverContext *ctx, const char *name, int *depth, int *slo
 static void resolve_stmt_internal(ResolverContext *ctx, Stmt *stmt);
 static void resolve_expr_internal(ResolverContext *ctx, Expr *expr);
 
+/*
+ * Set a flag on the binding at (depth, slot).
+ */
+static void mark_binding(ResolverContext *ctx, int depth, int slot, unsigned char flag) {
+    ResolverScope *scope = ctx->current;
+    for (int d = 0; d < depth; d++) {
+        scope = scope->parent;
+    }
+    ctx->binding_flags[scope->bindings[slot]] |= flag;
+}
+
+/*
+ * Record a variable reference for the functions being resolved. A variable
+ * from a non-global scope outside a function is one of its captures; a name
+ * that no scope defines yet is looked up by name when the function runs.
+ */
+static void note_use(ResolverContext *ctx, const char *name, int found, int depth, int slot) {
+    if (ctx->flatten || ctx->num_active == 0) return;
+
+    if (!found) {
+        for (int i = 0; i < ctx->num_active; i++) {
+            ResolverFunction *fn = &ctx->functions[ctx->active[i]];
+            name_list_add(&fn->unresolved, &fn->num_unresolved, &fn->unresolved_capacity, name);
+            // An enclosing method's 'self' lives in its call environment
+            if (i > 0 && strcmp(name, "self") == 0) {
+                fn->keep_chain = 1;
+            }
+        }
+        return;
+    }
+
+    int defined_at = ctx->scope_depth - depth;
+    if (defined_at == 0) return;  // Globals are looked up by name
+
+    ResolverScope *scope = ctx->current;
+    for (int d = 0; d < depth; d++) {
+        scope = scope->parent;
+    }
+    int binding = scope->bindings[slot];
+
+    for (int i = ctx->num_active - 1; i >= 0; i--) {
+        ResolverFunction *fn = &ctx->functions[ctx->active[i]];
+        if (defined_at >= fn->param_depth) break;
+        int count = fn->num_captures;
+        int index = name_list_add(&fn->captures, &fn->num_captures, &fn->capture_capacity, name);
+        if (index == count) {
+            fn->capture_bindings = realloc(fn->capture_bindings, sizeof(int) * fn->capture_capacity);
+            fn->capture_bindings[index] = binding;
+        }
+    }
+}
+
+/*
+ * Record a name the runtime defines in a non-global environment without a
+ * resolver slot (enums, extern functions, implicit assignments).
+ */
+static void note_dynamic_name(ResolverContext *ctx, const char *name) {
+    if (ctx->flatten || ctx->scope_depth == 0) return;
+    name_list_add(&ctx->dynamic_names, &ctx->num_dynamic, &ctx->dynamic_capacity, name);
+}
+
+/*
+ * Record that a variable may be written other than by its declaration.
+ */
+static void note_write(ResolverContext *ctx, Expr *target, unsigned char flag) {
+    int depth, slot;
+    if (ctx->flatten || target->type != EXPR_IDENT) return;
+    if (resolver_lookup(ctx, target->as.ident.name, &depth, &slot)) {
+        mark_binding(ctx, depth, slot, flag);
+    }
+}
+
+/*
+ * On the final pass, point a flat function's capture list at the variables
+ * in the defining scope and make a scope holding just those captures, with
+ * the global scope as its parent, the current one. Returns 0 (leaving the
+ * scopes alone) if a capture cannot be found there.
+ */
+static int enter_capture_scope(ResolverContext *ctx, Expr *expr) {
+    for (int i = 0; i < expr->as.function.num_captures; i++) {
+        int depth, slot;
+        if (!resolver_lookup(ctx, expr->as.function.capture_names[i], &depth, &slot) ||
+            ctx->scope_depth - depth == 0) {
+            return 0;
+        }
+        expr->as.function.captures[i].is_resolved = 1;
+        expr->as.function.captures[i].depth = depth;
+        expr->as.function.captures[i].slot = slot;
+    }
+
+    ResolverScope *global = ctx->current;
+    while (global->parent) {
+        global = global->parent;
+    }
+    ctx->current = scope_new(global);
+    ctx->current->first_function = ctx->num_functions;
+    ctx->scope_depth = 1;
+    for (int i = 0; i < expr->as.function.num_captures; i++) {
+        resolver_define(ctx, expr->as.function.capture_names[i]);
+    }
+    return 1;
+}
+
+/*
+ * Resolve a function expression. Default parameter values are evaluated in
+ * the closure environment, so they resolve outside the parameter scope.
+ */
+static void resolve_function(ResolverContext *ctx, Expr *expr) {
+    ResolverScope *saved_scope = ctx->current;
+    int saved_depth = ctx->scope_depth;
+    int index = -1;
+
+    if (ctx->flatten) {
+        if (expr->as.function.is_flat && !enter_capture_scope(ctx, expr)) {
+            expr->as.function.is_flat = 0;
+        }
+    } else {
+        ctx->functions = grow_array(ctx->functions, ctx->num_functions,
+                                    &ctx->function_capacity, sizeof(ResolverFunction));
+        index = ctx->num_functions++;
+        ResolverFunction *fn = &ctx->functions[index];
+        memset(fn, 0, sizeof(ResolverFunction));
+        fn->expr = expr;
+        fn->param_depth = ctx->scope_depth + 1;
+
+        ctx->active = grow_array(ctx->active, ctx->num_active, &ctx->active_capacity, sizeof(int));
+        ctx->active[ctx->num_active++] = index;
+
+        for (int i = 0; i < expr->as.function.num_params; i++) {
+            if (expr->as.function.param_is_ref && expr->as.function.param_is_ref[i]) {
+                ctx->ref_args = 1;
+            }
+        }
+    }
+
+    // Resolve default parameter expressions
+    for (int i = 0; i < expr->as.function.num_params; i++) {
+        if (expr->as.function.param_defaults && expr->as.function.param_defaults[i]) {
+            resolve_expr_internal(ctx, expr->as.function.param_defaults[i]);
+        }
+    }
+
+    // Enter a new scope for the function
+    resolver_enter_scope(ctx);
+
+    // Define parameters (use param_names not params)
+    for (int i = 0; i < expr->as.function.num_params; i++) {
+        resolver_define(ctx, expr->as.function.param_names[i]);
+    }
+
+    // Define rest parameter if present
+    if (expr->as.function.rest_param) {
+        resolver_define(ctx, expr->as.function.rest_param);
+    }
+
+    // Resolve the function body
+    resolve_stmt_internal(ctx, expr->as.function.body);
+
+    resolver_exit_scope(ctx);
+
+    if (ctx->current != saved_scope) {
+        scope_free(ctx->current);
+        ctx->current = saved_scope;
+        ctx->scope_depth = saved_depth;
+    }
+    if (index >= 0) {
+        ctx->num_active--;
+    }
+}
+
 /*
  * Resolve an expression.
  */
@@ -139,8 +365,10 @@ static void resolve_expr_internal(ResolverContext *ctx, Expr *expr) {
     switch (expr->type) {
         case EXPR_IDENT: {
             // Look up the variable and store resolution info
-            int depth, slot;
-            if (resolver_lookup(ctx, expr->as.ident.name, &depth, &slot)) {
+            int depth = 0, slot = 0;
+            int found = resolver_lookup(ctx, expr->as.ident.name, &depth, &slot);
+            note_use(ctx, expr->as.ident.name, found, depth, slot);
+            if (found) {
                 // Only use resolved lookup if we're inside a function scope.
                 // At depth 0 (global scope), builtins share the environment so slot
                 // indices don't match the resolver's expectations.
@@ -166,8 +394,13 @@ static void resolve_expr_internal(ResolverContext *ctx, Expr *expr) {
             resolve_expr_internal(ctx, expr->as.assign.value);
 
             // Then look up the variable being assigned
-            int depth, slot;
-            if (resolver_lookup(ctx, expr->as.assign.name, &depth, &slot)) {
+            int depth = 0, slot = 0;
+            int found = resolver_lookup(ctx, expr->as.assign.name, &depth, &slot);
+            note_use(ctx, expr->as.assign.name, found, depth, slot);
+            if (found) {
+                if (!ctx->flatten) {
+                    mark_binding(ctx, depth, slot, RESOLVER_BINDING_ASSIGNED);
+                }
                 // Only use resolved assignment if inside a function scope
                 int defining_scope_depth = ctx->scope_depth - depth;
                 if (defining_scope_depth > 0) {
@@ -181,6 +414,7 @@ static void resolve_expr_internal(ResolverContext *ctx, Expr *expr) {
             } else {
                 // Variable not found - implicit declaration or builtin
                 expr->as.assign.resolved.is_resolved = 0;
+                note_dynamic_name(ctx, expr->as.assign.name);
             }
             break;
         }
@@ -204,6 +438,8 @@ static void resolve_expr_internal(ResolverContext *ctx, Expr *expr) {
             resolve_expr_internal(ctx, expr->as.call.func);
             for (int i = 0; i < expr->as.call.num_args; i++) {
                 resolve_expr_internal(ctx, expr->as.call.args[i]);
+                // The callee may take it as a ref parameter
+                note_write(ctx, expr->as.call.args[i], RESOLVER_BINDING_PASSED);
             }
             break;
 
@@ -227,33 +463,9 @@ static void resolve_expr_internal(ResolverContext *ctx, Expr *expr) {
             resolve_expr_internal(ctx, expr->as.index_assign.value);
             break;
 
-        case EXPR_FUNCTION: {
-            // Enter a new scope for the function
-            resolver_enter_scope(ctx);
-
-            // Define parameters (use param_names not params)
-            for (int i = 0; i < expr->as.function.num_params; i++) {
-                resolver_define(ctx, expr->as.function.param_names[i]);
-            }
-
-            // Define rest parameter if present
-            if (expr->as.function.rest_param) {
-                resolver_define(ctx, expr->as.function.rest_param);
-            }
-
-            // Resolve default parameter expressions
-            for (int i = 0; i < expr->as.function.num_params; i++) {
-                if (expr->as.function.param_defaults && expr->as.function.param_defaults[i]) {
-                    resolve_expr_internal(ctx, expr->as.function.param_defaults[i]);
-                }
-            }
-
-            // Resolve the function body
-            resolve_stmt_internal(ctx, expr->as.function.body);
-
-            resolver_exit_scope(ctx);
+        case EXPR_FUNCTION:
+            resolve_function(ctx, expr);
             break;
-        }
 
         case EXPR_ARRAY_LITERAL:
             for (int i = 0; i < expr->as.array_literal.num_elements; i++) {
@@ -269,18 +481,22 @@ static void resolve_expr_internal(ResolverContext *ctx, Expr *expr) {
 
         case EXPR_PREFIX_INC:
             resolve_expr_internal(ctx, expr->as.prefix_inc.operand);
+            note_write(ctx, expr->as.prefix_inc.operand, RESOLVER_BINDING_ASSIGNED);
             break;
 
         case EXPR_PREFIX_DEC:
             resolve_expr_internal(ctx, expr->as.prefix_dec.operand);
+            note_write(ctx, expr->as.prefix_dec.operand, RESOLVER_BINDING_ASSIGNED);
             break;
 
         case EXPR_POSTFIX_INC:
             resolve_expr_internal(ctx, expr->as.postfix_inc.operand);
+            note_write(ctx, expr->as.postfix_inc.operand, RESOLVER_BINDING_ASSIGNED);
             break;
 
         case EXPR_POSTFIX_DEC:
             resolve_expr_internal(ctx, expr->as.postfix_dec.operand);
+            note_write(ctx, expr->as.postfix_dec.operand, RESOLVER_BINDING_ASSIGNED);
             break;
 
         case EXPR_AWAIT:
@@ -407,18 +623,15 @@ static void resolve_stmt_internal(ResolverContext *ctx, Stmt *stmt) {
         }
 
         case STMT_FOR_IN: {
-            // For-in loop creates TWO scopes at runtime (like regular for):
-            // 1. loop_env: intermediate scope (empty at runtime)
-            // 2. iter_env: holds iterator variables and body's local variables
-            // The iterable is evaluated BEFORE these scopes are created.
+            // For-in loop creates ONE scope at runtime (iter_env) holding
+            // the key variable in slot 0 and the value variable after it;
+            // the loop stores each step's key and value straight into those
+            // slots. The iterable is evaluated BEFORE the scope is created.
 
             // Resolve iterable in current (parent) scope first
             resolve_expr_internal(ctx, stmt->as.for_in.iterable);
 
-            // Enter outer scope (matches loop_env at runtime)
-            resolver_enter_scope(ctx);
-
-            // Enter inner scope for iterator variables and body (matches iter_env)
+            // Enter scope for iterator variables and body (matches iter_env)
             resolver_enter_scope(ctx);
 
             // Define the key variable if present
@@ -434,7 +647,6 @@ static void resolve_stmt_internal(ResolverContext *ctx, Stmt *stmt) {
             // Resolve the body
             resolve_stmt_internal(ctx, stmt->as.for_in.body);
 
-            resolver_exit_scope(ctx);
             resolver_exit_scope(ctx);
             break;
         }
@@ -495,8 +707,14 @@ static void resolve_stmt_internal(ResolverContext *ctx, Stmt *stmt) {
             break;
 
         case STMT_IMPORT:
+            // Imports/exports handled at module level. Only the standard
+            // library is known to declare no ref parameters.
+            if (strncmp(stmt->as.import_stmt.module_path, "@stdlib/", 8) != 0) {
+                ctx->ref_args = 1;
+            }
+            break;
+
         case STMT_EXPORT:
-            // Imports/exports handled at module level
             break;
 
         case STMT_DEFINE_OBJECT:
@@ -509,6 +727,7 @@ static void resolve_stmt_internal(ResolverContext *ctx, Stmt *stmt) {
             break;
 
         case STMT_ENUM:
+            note_dynamic_name(ctx, stmt->as.enum_decl.name);
             // Enum definitions - resolve explicit values
             for (int i = 0; i < stmt->as.enum_decl.num_variants; i++) {
                 if (stmt->as.enum_decl.variant_values && stmt->as.enum_decl.variant_values[i]) {
@@ -518,9 +737,12 @@ static void resolve_stmt_internal(ResolverContext *ctx, Stmt *stmt) {
             break;
 
         case STMT_IMPORT_FFI:
-        case STMT_EXTERN_FN:
             // FFI declarations - no expressions to resolve
             break;
+
+        case STMT_EXTERN_FN:
+            note_dynamic_name(ctx, stmt->as.extern_fn.function_name);
+            break;
     }
 }
 
@@ -538,6 +760,46 @@ void resolve_expr(ResolverContext *ctx, Expr *expr) {
     resolve_expr_internal(ctx, expr);
 }
 
+/*
+ * Mark the functions the analysis pass found to be safe as flat closures: no
+ * capture is ever reassigned (or possibly passed to a ref parameter), and
+ * every name left unresolved will be found among the globals.
+ */
+static void mark_flat_functions(ResolverContext *ctx) {
+    for (int f = 0; f < ctx->num_functions; f++) {
+        ResolverFunction *fn = &ctx->functions[f];
+        int flat = !fn->keep_chain;
+
+        for (int i = 0; i < fn->num_captures && flat; i++) {
+            unsigned char flags = ctx->binding_flags[fn->capture_bindings[i]];
+            if ((flags & RESOLVER_BINDING_ASSIGNED) ||
+                ((flags & RESOLVER_BINDING_PASSED) && ctx->ref_args)) {
+                flat = 0;
+            }
+        }
+        for (int u = 0; u < fn->num_unresolved && flat; u++) {
+            for (int i = 0; i < ctx->num_dynamic; i++) {
+                if (strcmp(fn->unresolved[u], ctx->dynamic_names[i]) == 0) {
+                    flat = 0;
+                    break;
+                }
+            }
+        }
+        if (!flat) continue;
+
+        Expr *expr = fn->expr;
+        expr->as.function.is_flat = 1;
+        expr->as.function.num_captures = fn->num_captures;
+        if (fn->num_captures > 0) {
+            expr->as.function.capture_names = malloc(sizeof(char *) * fn->num_captures);
+            expr->as.function.captures = calloc(fn->num_captures, sizeof(ResolvedVar));
+            for (int i = 0; i < fn->num_captures; i++) {
+                expr->as.function.capture_names[i] = strdup(fn->captures[i]);
+            }
+        }
+    }
+}
+
 /*
  * Resolve all variables in a program.
  */
@@ -547,6 +809,14 @@ void resolve_program(Stmt **statements, int count) {
     for (int i = 0; i < count; i++) {
         resolve_stmt_internal(ctx, statements[i]);
     }
+    mark_flat_functions(ctx);
+    resolver_free(ctx);
 
+    // Resolve again now that flat closures have their capture scopes
+    ctx = resolver_new();
+    ctx->flatten = 1;
+    for (int i = 0; i < count; i++) {
+        resolve_stmt_internal(ctx, statements[i]);
+    }
     resolver_free(ctx);
 }
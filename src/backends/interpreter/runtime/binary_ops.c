@@ -11,6 +11,7 @@
 
 // Forward declaration for recursive expression evaluation
 Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx);
+static Value binary_apply(Expr *expr, Value left, Value right, ExecutionContext *ctx);
 
 /*
  * Evaluate a binary expression.
@@ -54,6 +55,51 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
     // Evaluate both operands
     Value left = eval_expr(expr->as.binary.left, env, ctx);
     Value right = eval_expr(expr->as.binary.right, env, ctx);
+    return binary_apply(expr, left, right, ctx);
+}
+
+/*
+ * Evaluate the right-hand side of x = x + a + b ... (see
+ * is_append_assign). While x holds a string that no other value
+ * references, each operand is appended to it in place, so building a
+ * string in a loop is amortized O(n) instead of copying the whole string
+ * on every step. Operands are still evaluated left to right, and the
+ * variable is rechecked after each one in case it was reassigned.
+ */
+Value eval_append_assign(Expr *assign, Environment *env, ExecutionContext *ctx) {
+    Expr *chain[APPEND_CHAIN_MAX];
+    int n = 0;
+    Expr *leftmost = assign->as.assign.value;
+    while (leftmost->type == EXPR_BINARY && leftmost->as.binary.op == OP_ADD) {
+        chain[n++] = leftmost;
+        leftmost = leftmost->as.binary.left;
+    }
+
+    Value acc = eval_expr(leftmost, env, ctx);
+    for (int i = n - 1; i >= 0; i--) {
+        Value right = eval_expr(chain[i]->as.binary.right, env, ctx);
+
+        // One reference is the variable's, the other is acc
+        if (acc.type == VAL_STRING && !ctx->flow.is_throwing &&
+            __atomic_load_n(&acc.as.as_string->ref_count, __ATOMIC_ACQUIRE) == 2) {
+            Value *slot = assign->as.assign.resolved.is_resolved
+                ? env_assignable_slot_resolved(env, assign->as.assign.resolved.depth, assign->as.assign.resolved.slot)
+                : env_assignable_slot(env, assign->as.assign.name);
+            if (slot && slot->type == VAL_STRING && slot->as.as_string == acc.as.as_string &&
+                string_append_value(acc.as.as_string, right)) {
+                VALUE_RELEASE(right);
+                continue;
+            }
+        }
+        acc = binary_apply(chain[i], acc, right, ctx);
+    }
+    return acc;
+}
+
+/*
+ * Apply a binary operator to evaluated operands; releases both.
+ */
+static Value binary_apply(Expr *expr, Value left, Value right, ExecutionContext *ctx) {
     Value binary_result = val_null();  // Initialize to avoid undefined behavior
 
     // FAST PATH: i32 operations (most common case in benchmarks)
@@ -166,6 +212,14 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         }
     }
 
+    // A temporary string nothing else references is extended in place
+    if (expr->as.binary.op == OP_ADD && left.type == VAL_STRING &&
+        __atomic_load_n(&left.as.as_string->ref_count, __ATOMIC_ACQUIRE) == 1 &&
+        string_append_value(left.as.as_string, right)) {
+        VALUE_RELEASE(right);
+        return left;
+    }
+
     // String concatenation
     if (expr->as.binary.op == OP_ADD && left.type == VAL_STRING && right.type == VAL_STRING) {
         String *result = string_concat(left.as.as_string, right.as.as_string);
@@ -183,7 +237,7 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         // Create temporary string from rune
         String *rune_str = string_new(rune_bytes);
         String *result = string_concat(left.as.as_string, rune_str);
-        free(rune_str);  // Free temporary string
+        string_free(rune_str);  // Free temporary string
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
@@ -198,7 +252,7 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         // Create temporary string from rune
         String *rune_str = string_new(rune_bytes);
         String *result = string_concat(rune_str, right.as.as_string);
-        free(rune_str);  // Free temporary string
+        string_free(rune_str);  // Free temporary string
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
@@ -209,7 +263,7 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         String *right_string = string_new(right_str);
         free(right_str);
         String *result = string_concat(left.as.as_string, right_string);
-        free(right_string);
+        string_free(right_string);
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
@@ -220,17 +274,17 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         String *left_string = string_new(left_str);
         free(left_str);
         String *result = string_concat(left_string, right.as.as_string);
-        free(left_string);
+        string_free(left_string);
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
 
     // String + object/array concatenation (auto-serialize to JSON)
     if (expr->as.binary.op == OP_ADD && left.type == VAL_STRING && (right.type == VAL_OBJECT || right.type == VAL_ARRAY)) {
-        SerializeVisitedSet visited;
-        serialize_visited_init(&visited);
+        VisitedSet visited;
+        visited_set_init(&visited);
         char *right_json = serialize_value(right, &visited, ctx);
-        serialize_visited_free(&visited);
+        visited_set_destroy(&visited);
         if (right_json == NULL) {
             // Serialization failed (exception already thrown)
             goto binary_cleanup;
@@ -238,17 +292,17 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         String *right_string = string_new(right_json);
         free(right_json);
         String *result = string_concat(left.as.as_string, right_string);
-        free(right_string);
+        string_free(right_string);
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
 
     // Object/array + string concatenation (auto-serialize to JSON)
     if (expr->as.binary.op == OP_ADD && (left.type == VAL_OBJECT || left.type == VAL_ARRAY) && right.type == VAL_STRING) {
-        SerializeVisitedSet visited;
-        serialize_visited_init(&visited);
+        VisitedSet visited;
+        visited_set_init(&visited);
         char *left_json = serialize_value(left, &visited, ctx);
-        serialize_visited_free(&visited);
+        visited_set_destroy(&visited);
         if (left_json == NULL) {
             // Serialization failed (exception already thrown)
             goto binary_cleanup;
@@ -256,7 +310,7 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         String *left_string = string_new(left_json);
         free(left_json);
         String *result = string_concat(left_string, right.as.as_string);
-        free(left_string);
+        string_free(left_string);
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
@@ -265,7 +319,7 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
     if (expr->as.binary.op == OP_ADD && left.type == VAL_STRING && right.type == VAL_NULL) {
         String *null_str = string_new("null");
         String *result = string_concat(left.as.as_string, null_str);
-        free(null_str);
+        string_free(null_str);
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
@@ -274,7 +328,7 @@ Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
     if (expr->as.binary.op == OP_ADD && left.type == VAL_NULL && right.type == VAL_STRING) {
         String *null_str = string_new("null");
         String *result = string_concat(null_str, right.as.as_string);
-        free(null_str);
+        string_free(null_str);
         binary_result = (Value){ .type = VAL_STRING, .as.as_string = result };
         goto binary_cleanup;
     }
@@ -1,4 +1,5 @@
 #include "internal.h"
+#include <stdatomic.h>
 #include <unistd.h>
 
 // ========== CURRENT SOURCE FILE TRACKING ==========
@@ -27,11 +28,8 @@ ExecutionContext* exec_context_new(void) {
         fprintf(stderr, "Fatal error: Failed to allocate execution context\n");
         exit(1);
     }
-    ctx->return_state.is_returning = 0;
+    ctx->flow.any = 0;
     ctx->return_state.return_value = val_null();
-    ctx->loop_state.is_breaking = 0;
-    ctx->loop_state.is_continuing = 0;
-    ctx->exception_state.is_throwing = 0;
     ctx->exception_state.exception_value = val_null();
     ctx->max_stack_depth = DEFAULT_MAX_STACK_DEPTH;
     ctx->sandbox_flags = HML_SANDBOX_RESTRICT_NONE;  // No restrictions by default
@@ -43,6 +41,7 @@ ExecutionContext* exec_context_new(void) {
 
 void exec_context_free(ExecutionContext *ctx) {
     if (ctx) {
+        heap_profiler_context_freed(ctx);
         call_stack_free(&ctx->call_stack);
         defer_stack_free(&ctx->defer_stack);
         if (ctx->sandbox_root) {
@@ -81,19 +80,28 @@ void call_stack_push_full(CallStack *stack, const char *function_name, const cha
     }
 
     if (stack->count >= stack->capacity) {
-        stack->capacity *= 2;
-        CallFrame *new_frames = realloc(stack->frames, sizeof(CallFrame) * stack->capacity);
+        // Copy instead of realloc so the profiler's SIGPROF handler, which may
+        // interrupt this thread mid-grow, never sees a freed frames array
+        int new_capacity = stack->capacity * 2;
+        CallFrame *new_frames = malloc(sizeof(CallFrame) * new_capacity);
         if (!new_frames) {
             fprintf(stderr, "Fatal error: Failed to grow call stack\n");
             exit(1);
         }
+        memcpy(new_frames, stack->frames, sizeof(CallFrame) * stack->count);
+        CallFrame *old_frames = stack->frames;
         stack->frames = new_frames;
+        atomic_signal_fence(memory_order_seq_cst);
+        stack->capacity = new_capacity;
+        free(old_frames);
     }
 
     // Store pointers directly - no need to strdup since AST strings outlive the call
     stack->frames[stack->count].function_name = (char*)function_name;
     stack->frames[stack->count].source_file = (char*)source_file;
     stack->frames[stack->count].line = line;
+    // Publish the frame only once it is fully written (profiler samples count)
+    atomic_signal_fence(memory_order_seq_cst);
     stack->count++;
 }
 
@@ -165,7 +173,8 @@ void defer_stack_init(DeferStack *stack) {
     }
 }
 
-void defer_stack_push(DeferStack *stack, Expr *call, Environment *env) {
+// Add a call, taking over the caller's reference to env
+static void defer_stack_add(DeferStack *stack, Expr *call, Environment *env) {
     if (stack->capacity == 0) {
         defer_stack_init(stack);
     }
@@ -182,35 +191,86 @@ void defer_stack_push(DeferStack *stack, Expr *call, Environment *env) {
         stack->envs = new_envs;
     }
 
-    // Clone the expression and retain the environment
-    stack->calls[stack->count] = expr_clone(call);
+    // The call is part of the function body, which outlives the call
+    stack->calls[stack->count] = call;
     stack->envs[stack->count] = env;
-    env_retain(env);  // Increment reference count
     stack->count++;
 }
 
+void defer_stack_push(DeferStack *stack, Expr *call, Environment *env) {
+    env_retain(env);  // Keep the scope alive until the call runs
+    defer_stack_add(stack, call, env);
+}
+
+// The function a bound call will run, if it is known from its callee (or
+// method receiver) value
+static Function *deferred_function(Value target, Expr *bound_func) {
+    if (bound_func->type == EXPR_GET_PROPERTY) {
+        if (target.type != VAL_OBJECT) return NULL;
+        int idx = object_lookup_field(target.as.as_object, bound_func->as.get_property.property);
+        if (idx < 0) return NULL;
+        target = target.as.as_object->field_values[idx];
+    }
+    return target.type == VAL_FUNCTION ? target.as.as_function : NULL;
+}
+
+// Evaluate the callee (or method receiver) and arguments of a defer now and
+// push its bound call over them, so the enclosing scope is not kept
+void defer_stack_push_bound(DeferStack *stack, Stmt *defer, Environment *env, ExecutionContext *ctx) {
+    Expr *call = defer->as.defer_stmt.call;
+    Expr *bound = defer->as.defer_stmt.bound_call;
+    Expr *bound_func = bound->as.call.func;
+    Expr *target = call->as.call.func;
+    Expr *slot0 = bound_func;
+    if (bound_func->type == EXPR_GET_PROPERTY) {
+        target = target->as.get_property.object;
+        slot0 = bound_func->as.get_property.object;
+    }
+
+    Environment *operands = env_new(NULL);
+    Function *fn = NULL;
+    for (int i = 0; i <= call->as.call.num_args; i++) {
+        Expr *operand = i == 0 ? target : call->as.call.args[i - 1];
+        Expr *slot = i == 0 ? slot0 : bound->as.call.args[i - 1];
+        Value value = eval_expr(operand, env, ctx);
+        if (ctx->flow.is_throwing) {
+            env_release(operands);
+            return;
+        }
+        if (i == 0) {
+            fn = deferred_function(value, bound_func);
+        } else if (fn && fn->param_is_ref && i - 1 < fn->num_params && fn->param_is_ref[i - 1]) {
+            // A ref parameter refers to the caller's location, not the value
+            Reference *ref = reference_new_arg(operand, env, ctx);
+            VALUE_RELEASE(value);
+            value = ref ? val_ref(ref) : val_null();
+        }
+        env_define_borrowed(operands, slot->as.ident.name, value, 0, ctx);
+        VALUE_RELEASE(value);
+    }
+    defer_stack_add(stack, bound, operands);
+}
+
 void defer_stack_execute(DeferStack *stack, ExecutionContext *ctx) {
     // Execute deferred calls in LIFO order (last defer executes first)
     for (int i = stack->count - 1; i >= 0; i--) {
         // Save current exception state
-        int was_throwing = ctx->exception_state.is_throwing;
+        int was_throwing = ctx->flow.is_throwing;
         Value saved_exception = ctx->exception_state.exception_value;
 
         // Temporarily clear exception state to allow defer to run
-        ctx->exception_state.is_throwing = 0;
+        ctx->flow.is_throwing = 0;
 
         // Execute the deferred call
         eval_expr(stack->calls[i], stack->envs[i], ctx);
 
         // If defer itself threw, propagate that exception (overrides previous)
         // Otherwise, restore the saved exception state
-        if (!ctx->exception_state.is_throwing) {
-            ctx->exception_state.is_throwing = was_throwing;
+        if (!ctx->flow.is_throwing) {
+            ctx->flow.is_throwing = was_throwing;
             ctx->exception_state.exception_value = saved_exception;
         }
 
-        // Clean up the deferred expression and release environment
-        expr_free(stack->calls[i]);
         env_release(stack->envs[i]);
     }
 
@@ -221,7 +281,6 @@ void defer_stack_execute(DeferStack *stack, ExecutionContext *ctx) {
 void defer_stack_free(DeferStack *stack) {
     // Free any remaining deferred calls (shouldn't happen in normal execution)
     for (int i = 0; i < stack->count; i++) {
-        expr_free(stack->calls[i]);
         env_release(stack->envs[i]);
     }
     free(stack->calls);
@@ -244,7 +303,7 @@ void runtime_error(ExecutionContext *ctx, const char *format, ...) {
     if (ctx) {
         ctx->exception_state.exception_value = val_string(buffer);
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
     } else {
         // No context - print error and exit
         fprintf(stderr, "Runtime error: %s\n", buffer);
@@ -272,7 +331,7 @@ void runtime_error_at(ExecutionContext *ctx, int line, const char *format, ...)
     if (ctx) {
         ctx->exception_state.exception_value = val_string(full_buffer);
         value_retain(ctx->exception_state.exception_value);
-        ctx->exception_state.is_throwing = 1;
+        ctx->flow.is_throwing = 1;
     } else {
         // No context - print error and exit
         fprintf(stderr, "Runtime error: %s\n", full_buffer);
@@ -2,6 +2,19 @@
 
 // Forward declaration for binary operations (in binary_ops.c)
 Value eval_binary_expr(Expr *expr, Environment *env, ExecutionContext *ctx);
+Value eval_append_assign(Expr *assign, Environment *env, ExecutionContext *ctx);
+// String interpolation (in interpolation.c)
+Value eval_string_interpolation(Expr *expr, Environment *env, ExecutionContext *ctx);
+
+// Is this x = x + ... with at most APPEND_CHAIN_MAX additions?
+static int is_append_assign(Expr *assign) {
+    Expr *e = assign->as.assign.value;
+    for (int n = 0; e->type == EXPR_BINARY && e->as.binary.op == OP_ADD; n++) {
+        if (n == APPEND_CHAIN_MAX) return 0;
+        e = e->as.binary.left;
+    }
+    return e->type == EXPR_IDENT && strcmp(e->as.ident.name, assign->as.assign.name) == 0;
+}
 
 // ========== HELPER FUNCTIONS ==========
 
@@ -33,6 +46,7 @@ static const char* get_value_type_name(Value val) {
         case VAL_TASK: return "task";
         case VAL_CHANNEL: return "channel";
         case VAL_SOCKET: return "socket";
+        case VAL_WRITER: return "writer";
         default: return "unknown";
     }
 }
@@ -69,6 +83,62 @@ static Value value_sub_one(Value val, ExecutionContext *ctx) {
 
 // ========== EXPRESSION EVALUATION ==========
 
+/*
+ * The reference passed for a ref parameter: a variable, array element or
+ * object property of the caller. Returns NULL after reporting an error.
+ */
+Reference* reference_new_arg(Expr *arg_expr, Environment *env, ExecutionContext *ctx) {
+    Reference *ref = NULL;
+
+    if (arg_expr->type == EXPR_IDENT) {
+        // A ref parameter passed on refers to the caller's location
+        Value current = env_get(env, arg_expr->as.ident.name, ctx);
+        if (current.type == VAL_REF) {
+            return current.as.as_ref;
+        }
+        VALUE_RELEASE(current);
+        // Reference to a variable
+        ref = reference_new_variable(env, arg_expr->as.ident.name);
+    } else if (arg_expr->type == EXPR_INDEX) {
+        // Reference to an array element
+        Value arr_val = eval_expr(arg_expr->as.index.object, env, ctx);
+        Value idx_val = eval_expr(arg_expr->as.index.index, env, ctx);
+        if (arr_val.type == VAL_ARRAY) {
+            int64_t index = 0;
+            switch (idx_val.type) {
+                case VAL_I8: index = idx_val.as.as_i8; break;
+                case VAL_I16: index = idx_val.as.as_i16; break;
+                case VAL_I32: index = idx_val.as.as_i32; break;
+                case VAL_I64: index = idx_val.as.as_i64; break;
+                case VAL_U8: index = idx_val.as.as_u8; break;
+                case VAL_U16: index = idx_val.as.as_u16; break;
+                case VAL_U32: index = idx_val.as.as_u32; break;
+                case VAL_U64: index = (int64_t)idx_val.as.as_u64; break;
+                default:
+                    runtime_error_at(ctx, arg_expr->line, "Array index must be an integer");
+                    break;
+            }
+            ref = reference_new_array_index(arr_val.as.as_array, (int)index);
+        } else {
+            runtime_error_at(ctx, arg_expr->line, "ref argument must be an array element");
+        }
+        VALUE_RELEASE(arr_val);
+        VALUE_RELEASE(idx_val);
+    } else if (arg_expr->type == EXPR_GET_PROPERTY) {
+        // Reference to an object property
+        Value obj_val = eval_expr(arg_expr->as.get_property.object, env, ctx);
+        if (obj_val.type == VAL_OBJECT) {
+            ref = reference_new_object_property(obj_val.as.as_object, arg_expr->as.get_property.property);
+        } else {
+            runtime_error_at(ctx, arg_expr->line, "ref argument must be an object property");
+        }
+        VALUE_RELEASE(obj_val);
+    } else {
+        runtime_error_at(ctx, arg_expr->line, "ref argument must be a variable, array element, or object property");
+    }
+    return ref;
+}
+
 Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
     switch (expr->type) {
         case EXPR_NUMBER:
@@ -191,7 +261,14 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
         }
 
         case EXPR_ASSIGN: {
-            Value new_value = eval_expr(expr->as.assign.value, env, ctx);
+            Expr *rhs = expr->as.assign.value;
+            Value new_value;
+            if (rhs->type == EXPR_BINARY && rhs->as.binary.op == OP_ADD && is_append_assign(expr)) {
+                // x = x + y: may append to x's string in place
+                new_value = eval_append_assign(expr, env, ctx);
+            } else {
+                new_value = eval_expr(rhs, env, ctx);
+            }
             // Check if target is a reference (from ref parameter)
             Value target;
             if (expr->as.assign.resolved.is_resolved) {
@@ -226,6 +303,10 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
             if (expr->as.call.func->type == EXPR_GET_PROPERTY) {
                 is_method_call = 1;
                 method_self = eval_expr(expr->as.call.func->as.get_property.object, env, ctx);
+                if (ctx->flow.is_throwing) {
+                    VALUE_RELEASE(method_self);
+                    return val_null();
+                }
 
                 // Special handling for file methods
                 if (method_self.type == VAL_FILE) {
@@ -279,6 +360,32 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                     return result;
                 }
 
+                // Special handling for buffered writer methods
+                if (method_self.type == VAL_WRITER) {
+                    const char *method = expr->as.call.func->as.get_property.property;
+
+                    // Evaluate arguments (stack-allocated for small counts)
+                    Value method_stack_args[8];
+                    Value *args = NULL;
+                    if (expr->as.call.num_args > 0) {
+                        args = (expr->as.call.num_args <= 8) ? method_stack_args : malloc(sizeof(Value) * expr->as.call.num_args);
+                        for (int i = 0; i < expr->as.call.num_args; i++) {
+                            args[i] = eval_expr(expr->as.call.args[i], env, ctx);
+                        }
+                    }
+
+                    Value result = call_writer_method(method_self.as.as_writer, method, args, expr->as.call.num_args, ctx);
+                    // Release argument values (writer methods don't retain them)
+                    if (args) {
+                        for (int i = 0; i < expr->as.call.num_args; i++) {
+                            VALUE_RELEASE(args[i]);
+                        }
+                        if (args != method_stack_args) free(args);
+                    }
+                    VALUE_RELEASE(method_self);  // Release method receiver
+                    return result;
+                }
+
                 // Special handling for array methods
                 if (method_self.type == VAL_ARRAY) {
                     const char *method = expr->as.call.func->as.get_property.property;
@@ -366,7 +473,9 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                         }
                     }
 
+                    uint64_t trace_start_ns = TRACE_NOW();
                     Value result = call_channel_method(method_self.as.as_channel, method, args, expr->as.call.num_args, ctx);
+                    if (trace_start_ns) trace_channel_op(method, trace_start_ns, method_self.as.as_channel);
                     // Release argument values (channel methods don't retain them)
                     if (args) {
                         for (int i = 0; i < expr->as.call.num_args; i++) {
@@ -558,50 +667,7 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
 
                     if (is_ref_param && i < expr->as.call.num_args) {
                         // For ref parameters, create a reference to the original location
-                        Expr *arg_expr = expr->as.call.args[i];
-                        Reference *ref = NULL;
-
-                        if (arg_expr->type == EXPR_IDENT) {
-                            // Reference to a variable
-                            ref = reference_new_variable(env, arg_expr->as.ident.name);
-                        } else if (arg_expr->type == EXPR_INDEX) {
-                            // Reference to an array element
-                            Value arr_val = eval_expr(arg_expr->as.index.object, env, ctx);
-                            Value idx_val = eval_expr(arg_expr->as.index.index, env, ctx);
-                            if (arr_val.type == VAL_ARRAY) {
-                                int64_t index = 0;
-                                switch (idx_val.type) {
-                                    case VAL_I8: index = idx_val.as.as_i8; break;
-                                    case VAL_I16: index = idx_val.as.as_i16; break;
-                                    case VAL_I32: index = idx_val.as.as_i32; break;
-                                    case VAL_I64: index = idx_val.as.as_i64; break;
-                                    case VAL_U8: index = idx_val.as.as_u8; break;
-                                    case VAL_U16: index = idx_val.as.as_u16; break;
-                                    case VAL_U32: index = idx_val.as.as_u32; break;
-                                    case VAL_U64: index = (int64_t)idx_val.as.as_u64; break;
-                                    default:
-                                        runtime_error_at(ctx, arg_expr->line, "Array index must be an integer");
-                                        break;
-                                }
-                                ref = reference_new_array_index(arr_val.as.as_array, (int)index);
-                            } else {
-                                runtime_error_at(ctx, arg_expr->line, "ref argument must be an array element");
-                            }
-                            VALUE_RELEASE(arr_val);
-                            VALUE_RELEASE(idx_val);
-                        } else if (arg_expr->type == EXPR_GET_PROPERTY) {
-                            // Reference to an object property
-                            Value obj_val = eval_expr(arg_expr->as.get_property.object, env, ctx);
-                            if (obj_val.type == VAL_OBJECT) {
-                                ref = reference_new_object_property(obj_val.as.as_object, arg_expr->as.get_property.property);
-                            } else {
-                                runtime_error_at(ctx, arg_expr->line, "ref argument must be an object property");
-                            }
-                            VALUE_RELEASE(obj_val);
-                        } else {
-                            runtime_error_at(ctx, arg_expr->line, "ref argument must be a variable, array element, or object property");
-                        }
-
+                        Reference *ref = reference_new_arg(expr->as.call.args[i], env, ctx);
                         if (ref) {
                             arg_value = val_ref(ref);
                             // Release the eagerly evaluated value since we're using a ref
@@ -661,7 +727,7 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                 int defer_depth_before = ctx->defer_stack.count;
 
                 // Execute body
-                ctx->return_state.is_returning = 0;
+                ctx->flow.is_returning = 0;
                 eval_stmt(fn->body, call_env, ctx);
 
                 // Execute deferred calls (in LIFO order) before returning
@@ -685,23 +751,23 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                 result = ctx->return_state.return_value;
 
                 // Check return type if specified (but not if exception is being thrown)
-                if (fn->return_type && !ctx->exception_state.is_throwing) {
+                if (fn->return_type && !ctx->flow.is_throwing) {
                     // null return type allows functions to not return a value explicitly
-                    if (!ctx->return_state.is_returning && fn->return_type->kind != TYPE_NULL) {
+                    if (!ctx->flow.is_returning && fn->return_type->kind != TYPE_NULL) {
                         runtime_error(ctx, "Function with return type must return a value");
                     }
                     result = convert_to_type(result, fn->return_type, call_env, ctx);
                 }
 
                 // Reset return state
-                ctx->return_state.is_returning = 0;
+                ctx->flow.is_returning = 0;
 
                 // Retain result for the caller (so it survives call_env cleanup)
                 // The caller now owns this reference
                 VALUE_RETAIN(result);
 
                 // Pop call from stack trace (but not if exception is active - preserve stack for error reporting)
-                if (!ctx->exception_state.is_throwing) {
+                if (!ctx->flow.is_throwing) {
                     call_stack_pop(&ctx->call_stack);
                 }
 
@@ -842,8 +908,10 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                             bound_fn->return_type = orig_fn->return_type;
                             bound_fn->body = orig_fn->body;
                             bound_fn->closure_env = bound_env;
+                            env_mark_captured(bound_env);
                             bound_fn->ref_count = 1;
                             bound_fn->is_bound = 1;  // Mark as bound - don't free param arrays
+                            bound_fn->gc_buffered = 0;
 
                             // Note: object is retained by env_define above
                             // Note: result (orig_fn) was retained at line 1186
@@ -1104,9 +1172,10 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                     new_data[new_total] = '\0';
 
                     // Replace string data
-                    free(str->data);
+                    if (!STRING_IS_INLINE(str)) free(str->data);
                     str->data = new_data;
                     str->length = new_total;
+                    str->capacity = new_total + 1;
                     str->char_length = -1;  // Invalidate cached character count
                 }
 
@@ -1262,15 +1331,25 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
             // Store body AST (shared, not copied)
             fn->body = expr->as.function.body;
 
-            // CRITICAL: Capture current environment and retain it
-            fn->closure_env = env;
-            env_retain(env);  // Increment ref count since closure captures env
+            // CRITICAL: Capture the environment. A flat closure copies just
+            // the variables it uses; any other closure retains the whole chain.
+            if (expr->as.function.is_flat) {
+                fn->closure_env = env_capture(env, expr->as.function.capture_names,
+                                              expr->as.function.captures,
+                                              expr->as.function.num_captures);
+            } else {
+                fn->closure_env = env;
+                env_retain(env);  // Increment ref count since closure captures env
+            }
+            env_mark_captured(fn->closure_env);
 
             // Initialize reference count to 1 (creator owns the first reference)
             // This ensures that when stored in the environment and later retained by tasks,
             // the function isn't prematurely freed when the environment is cleaned up
             fn->ref_count = 1;
             fn->is_bound = 0;  // Not a bound method - owns param arrays
+            fn->gc_buffered = 0;
+            GC_NOTE_ALLOCATION();
 
             return val_function(fn);
         }
@@ -1609,46 +1688,8 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
             return val_null();  // Unreachable, but silences fallthrough warning
         }
 
-        case EXPR_STRING_INTERPOLATION: {
-            // Evaluate string interpolation: "prefix ${expr1} middle ${expr2} suffix"
-            // Build the final string by concatenating string parts and evaluated expressions
-
-            int num_parts = expr->as.string_interpolation.num_parts;
-            char **string_parts = expr->as.string_interpolation.string_parts;
-            Expr **expr_parts = expr->as.string_interpolation.expr_parts;
-
-            // Calculate total length needed
-            int total_len = 0;
-            for (int i = 0; i <= num_parts; i++) {
-                total_len += strlen(string_parts[i]);
-            }
-
-            // Evaluate expression parts and convert to strings
-            char **expr_strings = malloc(sizeof(char*) * num_parts);
-            for (int i = 0; i < num_parts; i++) {
-                Value expr_val = eval_expr(expr_parts[i], env, ctx);
-                expr_strings[i] = value_to_string(expr_val);
-                VALUE_RELEASE(expr_val);  // Release after converting to string
-                total_len += strlen(expr_strings[i]);
-            }
-
-            // Build final string
-            char *result = malloc(total_len + 1);
-            result[0] = '\0';
-
-            for (int i = 0; i < num_parts; i++) {
-                strcat(result, string_parts[i]);
-                strcat(result, expr_strings[i]);
-                free(expr_strings[i]);
-            }
-            strcat(result, string_parts[num_parts]);  // Final string part
-
-            free(expr_strings);
-
-            Value val = val_string(result);
-            free(result);
-            return val;
-        }
+        case EXPR_STRING_INTERPOLATION:
+            return eval_string_interpolation(expr, env, ctx);
 
         case EXPR_AWAIT: {
             // Evaluate the expression
@@ -1771,12 +1812,12 @@ Value eval_expr(Expr *expr, Environment *env, ExecutionContext *ctx) {
                     }
 
                     // Execute body
-                    ctx->return_state.is_returning = 0;
+                    ctx->flow.is_returning = 0;
                     eval_stmt(fn->body, call_env, ctx);
 
                     // Get return value
-                    result = ctx->return_state.is_returning ? ctx->return_state.return_value : val_null();
-                    ctx->return_state.is_returning = 0;
+                    result = ctx->flow.is_returning ? ctx->return_state.return_value : val_null();
+                    ctx->flow.is_returning = 0;
 
                     // Clean up
                     env_release(call_env);
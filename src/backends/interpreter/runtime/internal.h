@@ -10,4 +10,13 @@
 #include <stdarg.h>
 #include <limits.h>
 
+// Longest x = x + a + b ... chain that eval_append_assign() handles
+#define APPEND_CHAIN_MAX 16
+
+// Does something besides the loop hold env? A closure created in the body
+// keeps its scope, and through it the loop's scopes, alive.
+static inline int env_captured(Environment *env, int loop_refs) {
+    return __atomic_load_n(&env->ref_count, __ATOMIC_ACQUIRE) > loop_refs;
+}
+
 #endif // HEMLOCK_RUNTIME_INTERNAL_H
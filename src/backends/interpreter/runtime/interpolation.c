@@ -0,0 +1,133 @@
+/*
+ * String interpolation
+ *
+ * `prefix ${a} middle ${b} suffix` is built in one buffer: the literal
+ * parts are copied and each evaluated part is formatted straight after
+ * them, numbers without an intermediate string. The buffer lives on the
+ * stack until it fills up, and is kept out of eval_expr() so recursion
+ * does not pay for it on every frame.
+ */
+
+#include "internal.h"
+
+// Bytes formatted on the stack before the buffer moves to the heap
+#define INTERP_STACK_SIZE 256
+
+typedef struct {
+    char *data;
+    int length;
+    int capacity;
+    char stack[INTERP_STACK_SIZE];
+} InterpBuf;
+
+// Ensure room for extra more bytes plus the terminator
+static void interp_reserve(InterpBuf *out, int extra) {
+    if (out->length > INT_MAX - 1 - extra) {
+        fprintf(stderr, "Runtime error: String concatenation overflow - result too large\n");
+        exit(1);
+    }
+    int needed = out->length + extra + 1;
+    if (needed <= out->capacity) {
+        return;
+    }
+    int new_capacity = out->capacity < INT_MAX / 2 ? out->capacity * 2 : INT_MAX;
+    if (new_capacity < needed) new_capacity = needed;
+    char *data;
+    if (out->data == out->stack) {
+        data = malloc(new_capacity);
+        if (data) memcpy(data, out->stack, out->length);
+    } else {
+        data = realloc(out->data, new_capacity);
+    }
+    if (!data) {
+        fprintf(stderr, "Runtime error: Memory allocation failed\n");
+        exit(1);
+    }
+    out->data = data;
+    out->capacity = new_capacity;
+}
+
+static void interp_write(InterpBuf *out, const char *bytes, int len) {
+    interp_reserve(out, len);
+    memcpy(out->data + out->length, bytes, len);
+    out->length += len;
+}
+
+// Append a value as value_to_string() would write it
+static void interp_append_value(InterpBuf *out, Value val) {
+    switch (val.type) {
+        case VAL_STRING:
+            interp_write(out, val.as.as_string->data, val.as.as_string->length);
+            return;
+        case VAL_RUNE:
+            // U+0000 appends nothing, as in the string + rune operator
+            if (val.as.as_rune != 0) {
+                interp_reserve(out, 4);
+                out->length += utf8_encode(val.as.as_rune, out->data + out->length);
+            }
+            return;
+        case VAL_BOOL:
+            if (val.as.as_bool) {
+                interp_write(out, "true", 4);
+            } else {
+                interp_write(out, "false", 5);
+            }
+            return;
+        case VAL_NULL:
+            interp_write(out, "null", 4);
+            return;
+        case VAL_I8: case VAL_I16: case VAL_I32: case VAL_I64:
+        case VAL_U8: case VAL_U16: case VAL_U32: case VAL_U64:
+        case VAL_F32: case VAL_F64:
+            // Numbers are formatted in place
+            interp_reserve(out, STR_NUMBER_MAX);
+            out->length += value_format_number(val, out->data + out->length);
+            return;
+        default: {
+            char *str = value_to_string(val);
+            interp_write(out, str, strlen(str));
+            free(str);
+            return;
+        }
+    }
+}
+
+// The result string: short ones are copied into inline string storage,
+// heap buffers are handed over as they are
+static Value interp_finish(InterpBuf *out) {
+    int length = out->length;
+    if (length < STRING_INLINE_CAPACITY || out->data == out->stack) {
+        String *str = string_alloc(length);
+        memcpy(str->data, out->data, length);
+        str->data[length] = '\0';
+        if (out->data != out->stack) free(out->data);
+        return (Value){ .type = VAL_STRING, .as.as_string = str };
+    }
+    out->data[length] = '\0';
+    return val_string_take(out->data, length, out->capacity);
+}
+
+Value eval_string_interpolation(Expr *expr, Environment *env, ExecutionContext *ctx) {
+    int num_parts = expr->as.string_interpolation.num_parts;
+    char **string_parts = expr->as.string_interpolation.string_parts;
+    Expr **expr_parts = expr->as.string_interpolation.expr_parts;
+
+    InterpBuf out;
+    out.data = out.stack;
+    out.length = 0;
+    out.capacity = INTERP_STACK_SIZE;
+
+    for (int i = 0; i < num_parts; i++) {
+        interp_write(&out, string_parts[i], strlen(string_parts[i]));
+        Value part = eval_expr(expr_parts[i], env, ctx);
+        if (ctx->flow.is_throwing) {
+            VALUE_RELEASE(part);
+            if (out.data != out.stack) free(out.data);
+            return val_null();
+        }
+        interp_append_value(&out, part);
+        VALUE_RELEASE(part);
+    }
+    interp_write(&out, string_parts[num_parts], strlen(string_parts[num_parts]));
+    return interp_finish(&out);
+}
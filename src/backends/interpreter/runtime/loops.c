@@ -0,0 +1,144 @@
+/*
+ * For-in loops
+ *
+ * The loop variables live in fixed slots of one iteration scope (key in
+ * slot 0, value after it), which each step overwrites directly. The scope
+ * is only replaced when a closure created in the body has captured it.
+ * Kept out of eval_stmt() so its locals stay off every statement's frame.
+ */
+
+#include "internal.h"
+
+// Iteration scope of a for-in loop. The key variable is slot 0 and the
+// value variable the next slot, as the resolver numbers them, so each
+// step stores straight into the slots.
+static Environment *for_in_scope(Environment *env, Stmt *stmt) {
+    Environment *iter_env = env_new(env);
+    const char *key_var = stmt->as.for_in.key_var;
+    const char *value_var = stmt->as.for_in.value_var;
+    if (key_var) {
+        env_define_param(iter_env, key_var, hash_string(key_var), val_null());
+    }
+    env_define_param(iter_env, value_var, hash_string(value_var), val_null());
+    return iter_env;
+}
+
+static inline void for_in_bind(Environment *iter_env, int slot, Value value) {
+    Value old = iter_env->values[slot];
+    VALUE_RETAIN(value);
+    iter_env->values[slot] = value;
+    VALUE_RELEASE(old);
+}
+
+// Bind an object key. The previous key string is rewritten in place when
+// only the loop variable still holds it, so iterating allocates no strings.
+static void for_in_bind_key(Environment *iter_env, const char *name) {
+    Value *slot = &iter_env->values[0];
+    int len = (int)strlen(name);
+    if (slot->type == VAL_STRING) {
+        String *str = slot->as.as_string;
+        if (__atomic_load_n(&str->ref_count, __ATOMIC_ACQUIRE) == 1 && len < str->capacity) {
+            memcpy(str->data, name, len + 1);
+            str->length = len;
+            str->char_length = -1;
+            return;
+        }
+    }
+    String *str = string_alloc(len);
+    memcpy(str->data, name, len + 1);
+    Value key = { .type = VAL_STRING, .as.as_string = str };
+    VALUE_RELEASE(*slot);
+    *slot = key;
+}
+
+void eval_for_in(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
+    Value iterable = eval_expr(stmt->as.for_in.iterable, env, ctx);
+
+    // Check for exception after evaluating iterable
+    if (FLOW_THROWING(ctx)) {
+        VALUE_RELEASE(iterable);
+        return;
+    }
+
+    // Validate iterable type before creating loop environment
+    if (iterable.type != VAL_ARRAY && iterable.type != VAL_OBJECT && iterable.type != VAL_STRING) {
+        VALUE_RELEASE(iterable);
+        ctx->exception_state.exception_value = val_string("for-in requires array, object, or string");
+        ctx->flow.is_throwing = 1;
+        return;
+    }
+
+    // One iteration scope, reused until a closure captures it
+    int has_key = stmt->as.for_in.key_var != NULL;
+    int value_slot = has_key ? 1 : 0;
+    Environment *iter_env = for_in_scope(env, stmt);
+
+    // Strings are walked by byte offset; a character assignment that
+    // changes the string's length sends the walk back to the index
+    String *str = NULL;
+    int byte_pos = 0;
+    int str_length = 0;
+    if (iterable.type == VAL_STRING) {
+        str = iterable.as.as_string;
+        if (str->char_length < 0) {
+            str->char_length = utf8_count_codepoints(str->data, str->length);
+        }
+        str_length = str->length;
+        byte_pos = utf8_byte_offset(str->data, str->length, 0);
+    }
+
+    for (int i = 0; ; i++) {
+        // Bind the variables for this step; arrays and objects may
+        // grow while the loop runs
+        if (iterable.type == VAL_ARRAY) {
+            Array *arr = iterable.as.as_array;
+            if (i >= arr->length) break;
+            if (has_key) for_in_bind(iter_env, 0, val_i32(i));
+            for_in_bind(iter_env, value_slot, arr->elements[i]);
+        } else if (iterable.type == VAL_OBJECT) {
+            Object *obj = iterable.as.as_object;
+            if (i >= obj->num_fields) break;
+            if (has_key) for_in_bind_key(iter_env, obj->field_names[i]);
+            for_in_bind(iter_env, value_slot, obj->field_values[i]);
+        } else {
+            if (i >= str->char_length) break;
+            if (str->length != str_length) {
+                str_length = str->length;
+                byte_pos = utf8_byte_offset(str->data, str->length, i);
+            }
+            if (byte_pos >= str->length) break;
+            uint32_t codepoint = utf8_decode_at(str->data, byte_pos);
+            // On to the next start byte, as utf8_byte_offset() counts
+            do {
+                byte_pos++;
+            } while (byte_pos < str->length && ((unsigned char)str->data[byte_pos] & 0xC0) == 0x80);
+            if (has_key) for_in_bind(iter_env, 0, val_i32(i));
+            for_in_bind(iter_env, value_slot, val_rune(codepoint));
+        }
+
+        // Execute body
+        eval_stmt(stmt->as.for_in.body, iter_env, ctx);
+
+        // Check break/continue/return/exception
+        if (FLOW_UNWINDING(ctx)) {
+            if (ctx->flow.is_breaking) {
+                ctx->flow.is_breaking = 0;
+                break;
+            }
+            ctx->flow.is_continuing = 0;
+            if (ctx->flow.any) {
+                break;  // Return or exception
+            }
+        }
+
+        // A closure from this step keeps its variables; the next
+        // step gets a scope of its own
+        if (env_captured(iter_env, 1)) {
+            env_release(iter_env);
+            iter_env = for_in_scope(env, stmt);
+        }
+    }
+
+    env_release(iter_env);
+    VALUE_RELEASE(iterable);  // Release iterable after loop completes
+}
@@ -1,6 +1,9 @@
 #include "internal.h"
 #include <stdatomic.h>
 
+// For-in loops (in loops.c)
+void eval_for_in(Stmt *stmt, Environment *env, ExecutionContext *ctx);
+
 // ========== STATEMENT EVALUATION ==========
 
 void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
@@ -8,7 +11,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
         case STMT_LET: {
             Value value = eval_expr(stmt->as.let.value, env, ctx);
             // Check for exception after evaluating value
-            if (ctx->exception_state.is_throwing) {
+            if (FLOW_THROWING(ctx)) {
                 VALUE_RELEASE(value);
                 break;
             }
@@ -16,7 +19,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             if (stmt->as.let.type_annotation != NULL) {
                 value = convert_to_type(value, stmt->as.let.type_annotation, env, ctx);
                 // Check for exception after type conversion
-                if (ctx->exception_state.is_throwing) {
+                if (FLOW_THROWING(ctx)) {
                     VALUE_RELEASE(value);
                     break;
                 }
@@ -29,7 +32,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
         case STMT_CONST: {
             Value value = eval_expr(stmt->as.const_stmt.value, env, ctx);
             // Check for exception after evaluating value
-            if (ctx->exception_state.is_throwing) {
+            if (FLOW_THROWING(ctx)) {
                 VALUE_RELEASE(value);
                 break;
             }
@@ -37,7 +40,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             if (stmt->as.const_stmt.type_annotation != NULL) {
                 value = convert_to_type(value, stmt->as.const_stmt.type_annotation, env, ctx);
                 // Check for exception after type conversion
-                if (ctx->exception_state.is_throwing) {
+                if (FLOW_THROWING(ctx)) {
                     VALUE_RELEASE(value);
                     break;
                 }
@@ -56,7 +59,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
         case STMT_IF: {
             Value condition = eval_expr(stmt->as.if_stmt.condition, env, ctx);
             // Check for exception after evaluating condition
-            if (ctx->exception_state.is_throwing) {
+            if (FLOW_THROWING(ctx)) {
                 VALUE_RELEASE(condition);
                 break;
             }
@@ -80,7 +83,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             for (;;) {
                 Value condition = eval_expr(stmt->as.while_stmt.condition, env, ctx);
                 // Check for exception after evaluating condition
-                if (ctx->exception_state.is_throwing) {
+                if (FLOW_THROWING(ctx)) {
                     VALUE_RELEASE(condition);
                     break;
                 }
@@ -97,16 +100,16 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                 eval_stmt(stmt->as.while_stmt.body, iter_env, ctx);
 
                 // Check for break/continue/return/exception
-                if (ctx->loop_state.is_breaking) {
-                    ctx->loop_state.is_breaking = 0;
-                    break;
-                }
-                if (ctx->loop_state.is_continuing) {
-                    ctx->loop_state.is_continuing = 0;
-                    continue;
-                }
-                if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
-                    break;
+                if (FLOW_UNWINDING(ctx)) {
+                    if (ctx->flow.is_breaking) {
+                        ctx->flow.is_breaking = 0;
+                        break;
+                    }
+                    if (ctx->flow.is_continuing) {
+                        ctx->flow.is_continuing = 0;
+                        continue;
+                    }
+                    break;  // Return or exception
                 }
             }
             env_release(iter_env);
@@ -121,7 +124,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             if (stmt->as.for_loop.initializer) {
                 eval_stmt(stmt->as.for_loop.initializer, loop_env, ctx);
                 // Check for exception/return after initializer
-                if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
+                if (FLOW_UNWINDING(ctx)) {
                     env_release(loop_env);
                     break;
                 }
@@ -136,7 +139,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                 if (stmt->as.for_loop.condition) {
                     Value cond = eval_expr(stmt->as.for_loop.condition, loop_env, ctx);
                     // Check for exception after condition evaluation
-                    if (ctx->exception_state.is_throwing) {
+                    if (FLOW_THROWING(ctx)) {
                         VALUE_RELEASE(cond);  // Release condition before breaking
                         break;
                     }
@@ -152,16 +155,25 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                 eval_stmt(stmt->as.for_loop.body, iter_env, ctx);
 
                 // Check for break/continue/return/exception
-                if (ctx->loop_state.is_breaking) {
-                    ctx->loop_state.is_breaking = 0;
-                    break;
-                }
-                if (ctx->loop_state.is_continuing) {
-                    ctx->loop_state.is_continuing = 0;
-                    // Fall through to increment
+                if (FLOW_UNWINDING(ctx)) {
+                    if (ctx->flow.is_breaking) {
+                        ctx->flow.is_breaking = 0;
+                        break;
+                    }
+                    ctx->flow.is_continuing = 0;  // Fall through to increment
+                    if (ctx->flow.any) {
+                        break;  // Return or exception
+                    }
                 }
-                if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
-                    break;
+
+                // A closure from this iteration keeps its loop variables;
+                // the next iteration continues in a copy of them
+                if (env_captured(iter_env, 1) || env_captured(loop_env, 2)) {
+                    Environment *next_env = env_fork(loop_env);
+                    env_release(iter_env);
+                    env_release(loop_env);
+                    loop_env = next_env;
+                    iter_env = env_new(loop_env);
                 }
 
                 // Execute increment
@@ -169,7 +181,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                     Value incr_result = eval_expr(stmt->as.for_loop.increment, loop_env, ctx);
                     VALUE_RELEASE(incr_result);  // Release increment expression result
                     // Check for exception after increment
-                    if (ctx->exception_state.is_throwing) {
+                    if (FLOW_THROWING(ctx)) {
                         break;
                     }
                 }
@@ -180,162 +192,16 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             break;
         }
 
-        case STMT_FOR_IN: {
-            Value iterable = eval_expr(stmt->as.for_in.iterable, env, ctx);
-
-            // Check for exception after evaluating iterable
-            if (ctx->exception_state.is_throwing) {
-                VALUE_RELEASE(iterable);  // Release iterable before breaking
-                break;
-            }
-
-            // Validate iterable type before creating loop environment
-            if (iterable.type != VAL_ARRAY && iterable.type != VAL_OBJECT && iterable.type != VAL_STRING) {
-                VALUE_RELEASE(iterable);  // Release iterable before breaking
-                ctx->exception_state.exception_value = val_string("for-in requires array, object, or string");
-                ctx->exception_state.is_throwing = 1;
-                break;
-            }
-
-            Environment *loop_env = env_new(env);
-            // Create iteration environment once, reuse each iteration
-            Environment *iter_env = env_new(loop_env);
-
-            if (iterable.type == VAL_ARRAY) {
-                Array *arr = iterable.as.as_array;
-
-                for (int i = 0; i < arr->length; i++) {
-                    // Clear and reuse iteration environment
-                    env_clear(iter_env);
-
-                    // Bind variables
-                    if (stmt->as.for_in.key_var) {
-                        env_set(iter_env, stmt->as.for_in.key_var, val_i32(i), ctx);
-                        // Check for exception from env_set
-                        if (ctx->exception_state.is_throwing) {
-                            break;
-                        }
-                    }
-                    env_set(iter_env, stmt->as.for_in.value_var, arr->elements[i], ctx);
-                    // Check for exception from env_set
-                    if (ctx->exception_state.is_throwing) {
-                        break;
-                    }
-
-                    // Execute body
-                    eval_stmt(stmt->as.for_in.body, iter_env, ctx);
-
-                    // Check break/continue/return/exception
-                    if (ctx->loop_state.is_breaking) {
-                        ctx->loop_state.is_breaking = 0;
-                        break;
-                    }
-                    if (ctx->loop_state.is_continuing) {
-                        ctx->loop_state.is_continuing = 0;
-                        continue;
-                    }
-                    if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
-                        break;
-                    }
-                }
-            } else if (iterable.type == VAL_OBJECT) {
-                Object *obj = iterable.as.as_object;
-
-                for (int i = 0; i < obj->num_fields; i++) {
-                    // Clear and reuse iteration environment
-                    env_clear(iter_env);
-
-                    // Bind variables
-                    if (stmt->as.for_in.key_var) {
-                        env_set(iter_env, stmt->as.for_in.key_var, val_string(obj->field_names[i]), ctx);
-                        // Check for exception from env_set
-                        if (ctx->exception_state.is_throwing) {
-                            break;
-                        }
-                    }
-                    env_set(iter_env, stmt->as.for_in.value_var, obj->field_values[i], ctx);
-                    // Check for exception from env_set
-                    if (ctx->exception_state.is_throwing) {
-                        break;
-                    }
-
-                    // Execute body
-                    eval_stmt(stmt->as.for_in.body, iter_env, ctx);
-
-                    // Check break/continue/return/exception
-                    if (ctx->loop_state.is_breaking) {
-                        ctx->loop_state.is_breaking = 0;
-                        break;
-                    }
-                    if (ctx->loop_state.is_continuing) {
-                        ctx->loop_state.is_continuing = 0;
-                        continue;
-                    }
-                    if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
-                        break;
-                    }
-                }
-            } else if (iterable.type == VAL_STRING) {
-                String *str = iterable.as.as_string;
-
-                // Compute character length if not cached
-                if (str->char_length < 0) {
-                    str->char_length = utf8_count_codepoints(str->data, str->length);
-                }
-
-                for (int i = 0; i < str->char_length; i++) {
-                    // Clear and reuse iteration environment
-                    env_clear(iter_env);
-
-                    // Bind index if key_var is specified
-                    if (stmt->as.for_in.key_var) {
-                        env_set(iter_env, stmt->as.for_in.key_var, val_i32(i), ctx);
-                        // Check for exception from env_set
-                        if (ctx->exception_state.is_throwing) {
-                            break;
-                        }
-                    }
-
-                    // Get the rune at position i
-                    int byte_pos = utf8_byte_offset(str->data, str->length, i);
-                    uint32_t codepoint = utf8_decode_at(str->data, byte_pos);
-
-                    env_set(iter_env, stmt->as.for_in.value_var, val_rune(codepoint), ctx);
-                    // Check for exception from env_set
-                    if (ctx->exception_state.is_throwing) {
-                        break;
-                    }
-
-                    // Execute body
-                    eval_stmt(stmt->as.for_in.body, iter_env, ctx);
-
-                    // Check break/continue/return/exception
-                    if (ctx->loop_state.is_breaking) {
-                        ctx->loop_state.is_breaking = 0;
-                        break;
-                    }
-                    if (ctx->loop_state.is_continuing) {
-                        ctx->loop_state.is_continuing = 0;
-                        continue;
-                    }
-                    if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
-                        break;
-                    }
-                }
-            }
-
-            env_release(iter_env);
-            env_release(loop_env);
-            VALUE_RELEASE(iterable);  // Release iterable after loop completes
+        case STMT_FOR_IN:
+            eval_for_in(stmt, env, ctx);
             break;
-        }
 
         case STMT_BREAK:
-            ctx->loop_state.is_breaking = 1;
+            ctx->flow.is_breaking = 1;
             break;
 
         case STMT_CONTINUE:
-            ctx->loop_state.is_continuing = 1;
+            ctx->flow.is_continuing = 1;
             break;
 
         case STMT_BLOCK: {
@@ -346,8 +212,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             for (int i = 0; i < stmt->as.block.count; i++) {
                 eval_stmt(stmt->as.block.statements[i], block_env, ctx);
                 // Check if a return/break/continue/exception happened
-                if (ctx->return_state.is_returning || ctx->loop_state.is_breaking ||
-                    ctx->loop_state.is_continuing || ctx->exception_state.is_throwing) {
+                if (FLOW_UNWINDING(ctx)) {
                     break;
                 }
             }
@@ -360,7 +225,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             if (stmt->as.return_stmt.value) {
                 ctx->return_state.return_value = eval_expr(stmt->as.return_stmt.value, env, ctx);
                 // Check for exception - don't set is_returning if exception occurred
-                if (ctx->exception_state.is_throwing) {
+                if (FLOW_THROWING(ctx)) {
                     VALUE_RELEASE(ctx->return_state.return_value);
                     ctx->return_state.return_value = val_null();
                     break;
@@ -368,7 +233,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             } else {
                 ctx->return_state.return_value = val_null();
             }
-            ctx->return_state.is_returning = 1;
+            ctx->flow.is_returning = 1;
             break;
         }
 
@@ -433,7 +298,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                     // Explicit value - evaluate the expression
                     Value val = eval_expr(stmt->as.enum_decl.variant_values[i], env, ctx);
                     // Check for exception after evaluating variant value
-                    if (ctx->exception_state.is_throwing) {
+                    if (FLOW_THROWING(ctx)) {
                         VALUE_RELEASE(val);
                         had_error = 1;
                         break;
@@ -470,7 +335,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             register_enum_type(type);
 
             // Create a namespace object with the enum variants
-            Object *obj = malloc(sizeof(Object));
+            Object *obj = slab_alloc(sizeof(Object));
             obj->type_name = strdup(type->name);
             obj->num_fields = type->num_variants;
             obj->capacity = type->num_variants;
@@ -478,8 +343,11 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             obj->field_values = malloc(sizeof(Value) * type->num_variants);
             obj->ref_count = 1;
             atomic_store(&obj->freed, 0);  // Not freed
+            obj->gc_buffered = 0;
             obj->hash_table = NULL;  // No hash table - use linear search fallback
             obj->hash_capacity = 0;
+            HEAP_TRACK_ALLOC(obj, HEAP_KIND_OBJECT,
+                             sizeof(Object) + obj->capacity * (sizeof(Value) + sizeof(char*)));
 
             for (int i = 0; i < type->num_variants; i++) {
                 obj->field_names[i] = strdup(type->variant_names[i]);
@@ -496,13 +364,19 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
         }
 
         case STMT_TRY: {
+            // Frames left by the throw are kept for uncaught stack traces;
+            // a catch unwinds them back to the try's depth
+            int saved_stack_depth = ctx->call_stack.count;
+
             // Execute try block
             eval_stmt(stmt->as.try_stmt.try_block, env, ctx);
 
             // Check if exception was thrown
-            if (ctx->exception_state.is_throwing) {
+            if (FLOW_THROWING(ctx)) {
                 // Exception thrown - execute catch block if present
                 if (stmt->as.try_stmt.catch_block != NULL) {
+                    ctx->call_stack.count = saved_stack_depth;
+
                     // Create new scope for catch parameter
                     Environment *catch_env = env_new(env);
                     // Use env_define (not env_set) to create a new variable that shadows outer scope
@@ -511,7 +385,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                     // Clear exception state and release the exception value
                     // (env_set retained it, so we can release the context's reference)
                     VALUE_RELEASE(ctx->exception_state.exception_value);
-                    ctx->exception_state.is_throwing = 0;
+                    ctx->flow.is_throwing = 0;
 
                     // Execute catch block
                     eval_stmt(stmt->as.try_stmt.catch_block, catch_env, ctx);
@@ -523,31 +397,21 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             // Execute finally block if present (always executes)
             if (stmt->as.try_stmt.finally_block != NULL) {
                 // Save current state (return/exception/break/continue)
-                int was_returning = ctx->return_state.is_returning;
+                ControlFlow saved_flow = ctx->flow;
                 Value saved_return = ctx->return_state.return_value;
-                int was_throwing = ctx->exception_state.is_throwing;
                 Value saved_exception = ctx->exception_state.exception_value;
-                int was_breaking = ctx->loop_state.is_breaking;
-                int was_continuing = ctx->loop_state.is_continuing;
 
                 // Clear states before finally
-                ctx->return_state.is_returning = 0;
-                ctx->exception_state.is_throwing = 0;
-                ctx->loop_state.is_breaking = 0;
-                ctx->loop_state.is_continuing = 0;
+                ctx->flow.any = 0;
 
                 // Execute finally block
                 eval_stmt(stmt->as.try_stmt.finally_block, env, ctx);
 
                 // If finally didn't throw/return/break/continue, restore previous state
-                if (!ctx->return_state.is_returning && !ctx->exception_state.is_throwing &&
-                    !ctx->loop_state.is_breaking && !ctx->loop_state.is_continuing) {
-                    ctx->return_state.is_returning = was_returning;
+                if (!ctx->flow.any) {
+                    ctx->flow = saved_flow;
                     ctx->return_state.return_value = saved_return;
-                    ctx->exception_state.is_throwing = was_throwing;
                     ctx->exception_state.exception_value = saved_exception;
-                    ctx->loop_state.is_breaking = was_breaking;
-                    ctx->loop_state.is_continuing = was_continuing;
                 }
             }
             break;
@@ -558,7 +422,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             // (so it survives past environment cleanups during unwinding)
             ctx->exception_state.exception_value = eval_expr(stmt->as.throw_stmt.value, env, ctx);
             VALUE_RETAIN(ctx->exception_state.exception_value);
-            ctx->exception_state.is_throwing = 1;
+            ctx->flow.is_throwing = 1;
 
             // Push throw location onto stack trace
             call_stack_push_line(&ctx->call_stack, "<throw>", stmt->line);
@@ -569,7 +433,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
             // Evaluate the switch expression
             Value switch_value = eval_expr(stmt->as.switch_stmt.expr, env, ctx);
             // Check for exception after evaluating switch expression
-            if (ctx->exception_state.is_throwing) {
+            if (FLOW_THROWING(ctx)) {
                 VALUE_RELEASE(switch_value);
                 break;
             }
@@ -586,7 +450,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                     // Evaluate case value and compare
                     Value case_value = eval_expr(stmt->as.switch_stmt.case_values[i], env, ctx);
                     // Check for exception after evaluating case value
-                    if (ctx->exception_state.is_throwing) {
+                    if (FLOW_THROWING(ctx)) {
                         VALUE_RELEASE(case_value);
                         VALUE_RELEASE(switch_value);
                         break;
@@ -601,7 +465,7 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                 }
             }
             // Check if we broke out of the loop due to an exception
-            if (ctx->exception_state.is_throwing) {
+            if (FLOW_THROWING(ctx)) {
                 break;
             }
 
@@ -615,16 +479,10 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
                 for (int i = matched_case; i < stmt->as.switch_stmt.num_cases; i++) {
                     eval_stmt(stmt->as.switch_stmt.case_bodies[i], env, ctx);
 
-                    // Check for break, return, continue, or exception
-                    if (ctx->loop_state.is_breaking) {
-                        ctx->loop_state.is_breaking = 0;
-                        break;
-                    }
-                    if (ctx->loop_state.is_continuing) {
-                        // Continue propagates up to enclosing loop, exit switch
-                        break;
-                    }
-                    if (ctx->return_state.is_returning || ctx->exception_state.is_throwing) {
+                    // Check for break, return, continue, or exception.
+                    // Continue propagates up to the enclosing loop.
+                    if (FLOW_UNWINDING(ctx)) {
+                        ctx->flow.is_breaking = 0;
                         break;
                     }
                 }
@@ -637,7 +495,11 @@ void eval_stmt(Stmt *stmt, Environment *env, ExecutionContext *ctx) {
         case STMT_DEFER: {
             // Push the deferred call onto the defer stack
             // It will be executed when the function returns (or exits with exception)
-            defer_stack_push(&ctx->defer_stack, stmt->as.defer_stmt.call, env);
+            if (stmt->as.defer_stmt.bound_call) {
+                defer_stack_push_bound(&ctx->defer_stack, stmt, env, ctx);
+            } else {
+                defer_stack_push(&ctx->defer_stack, stmt->as.defer_stmt.call, env);
+            }
             break;
         }
 
@@ -670,7 +532,7 @@ void eval_program(Stmt **stmts, int count, Environment *env, ExecutionContext *c
         eval_stmt(stmts[i], env, ctx);
 
         // Check for uncaught exception
-        if (ctx->exception_state.is_throwing) {
+        if (FLOW_THROWING(ctx)) {
             // Convert exception value to string for stderr output
             char *error_msg = value_to_string(ctx->exception_state.exception_value);
             fprintf(stderr, "Uncaught exception: %s\n", error_msg);
@@ -4,23 +4,8 @@
 
 // ========== UTF-8 UTILITY IMPLEMENTATIONS ==========
 
-// Count number of Unicode codepoints in a UTF-8 string
-int utf8_count_codepoints(const char *data, int byte_length) {
-    int count = 0;
-    int pos = 0;
-
-    while (pos < byte_length) {
-        unsigned char byte = (unsigned char)data[pos];
-
-        // Skip continuation bytes (10xxxxxx)
-        if ((byte & 0xC0) != 0x80) {
-            count++;
-        }
-        pos++;
-    }
-
-    return count;
-}
+// utf8_count_codepoints, utf8_validate and utf8_is_ascii are block kernels
+// in str_kernels.c
 
 // Find byte offset of the i-th codepoint (0-indexed)
 int utf8_byte_offset(const char *data, int byte_length, int char_index) {
@@ -158,50 +143,3 @@ int utf8_encode(uint32_t codepoint, char *buffer) {
         exit(1);
     }
 }
-
-// Validate that a buffer contains valid UTF-8
-int utf8_validate(const char *data, int byte_length) {
-    int pos = 0;
-
-    while (pos < byte_length) {
-        unsigned char b = (unsigned char)data[pos];
-        int char_len;
-
-        if ((b & 0x80) == 0) {
-            // 1-byte character
-            char_len = 1;
-        } else if ((b & 0xE0) == 0xC0) {
-            // 2-byte character
-            char_len = 2;
-        } else if ((b & 0xF0) == 0xE0) {
-            // 3-byte character
-            char_len = 3;
-        } else if ((b & 0xF8) == 0xF0) {
-            // 4-byte character
-            char_len = 4;
-        } else {
-            return 0;  // Invalid start byte
-        }
-
-        // Check continuation bytes
-        for (int i = 1; i < char_len; i++) {
-            if (pos + i >= byte_length) return 0;  // Truncated sequence
-            unsigned char cont = (unsigned char)data[pos + i];
-            if ((cont & 0xC0) != 0x80) return 0;  // Invalid continuation byte
-        }
-
-        pos += char_len;
-    }
-
-    return 1;  // Valid UTF-8
-}
-
-// Check if string contains only ASCII characters
-int utf8_is_ascii(const char *data, int byte_length) {
-    for (int i = 0; i < byte_length; i++) {
-        if ((unsigned char)data[i] & 0x80) {
-            return 0;  // Non-ASCII byte found
-        }
-    }
-    return 1;  // All ASCII
-}
@@ -28,7 +28,8 @@ int utf8_encode(uint32_t codepoint, char *buffer);
 // Get the byte length of a UTF-8 character from its first byte
 int utf8_char_byte_length(unsigned char first_byte);
 
-// Validate that a buffer contains valid UTF-8
+// Validate that a buffer contains valid UTF-8 (RFC 3629: no overlong forms,
+// surrogates or codepoints above U+10FFFF)
 // Returns 1 if valid, 0 if invalid
 int utf8_validate(const char *data, int byte_length);
 
@@ -6,19 +6,22 @@
 #include <pthread.h>
 #include <stdatomic.h>
 #include <limits.h>
+#include <sys/mman.h>
 
 // ========== FORWARD DECLARATIONS FOR CYCLE DETECTION ==========
 
-// VisitedSet typedef is in internal.h
-static void object_free_internal(Object *obj, VisitedSet *visited);
-static void array_free_internal(Array *arr, VisitedSet *visited);
+static void object_free_internal(Object *obj);
+static void array_free_internal(Array *arr);
 
 // ========== STRING OPERATIONS ==========
 
 void string_free(String *str) {
     if (str) {
-        free(str->data);
-        free(str);
+        HEAP_TRACK_FREE(str);
+        if (!STRING_IS_INLINE(str)) {
+            free(str->data);
+        }
+        slab_free(str, STRING_BLOCK_SIZE);
     }
 }
 
@@ -37,44 +40,45 @@ void string_release(String *str) {
     }
 }
 
-String* string_new(const char *cstr) {
-    int len = strlen(cstr);
-    String *str = malloc(sizeof(String));
+// Allocate a string with room for length bytes plus the terminator; the
+// caller fills in data. Short strings get their bytes inline.
+String* string_alloc(int length) {
+    String *str = slab_alloc(STRING_BLOCK_SIZE);
     if (!str) {
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
     }
-    str->length = len;
+    str->length = length;
     str->char_length = -1;  // Cache not yet computed
-    str->capacity = len + 1;
     str->ref_count = 1;  // Start with 1 - caller owns the first reference
-    str->data = malloc(str->capacity);
-    if (!str->data) {
-        free(str);
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
+    if (length < STRING_INLINE_CAPACITY) {
+        str->data = (char *)(str + 1);
+        str->capacity = STRING_INLINE_CAPACITY;
+        slab_note_inline_string();
+    } else {
+        str->capacity = length + 1;
+        str->data = malloc(str->capacity);
+        if (!str->data) {
+            slab_free(str, STRING_BLOCK_SIZE);
+            fprintf(stderr, "Runtime error: Memory allocation failed\n");
+            exit(1);
+        }
     }
+    HEAP_TRACK_ALLOC(str, HEAP_KIND_STRING, sizeof(String) + str->capacity);
+    return str;
+}
+
+String* string_new(const char *cstr) {
+    int len = strlen(cstr);
+    String *str = string_alloc(len);
     memcpy(str->data, cstr, len);
     str->data[len] = '\0';
     return str;
 }
 
 String* string_copy(String *str) {
-    String *copy = malloc(sizeof(String));
-    if (!copy) {
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
-    }
-    copy->length = str->length;
+    String *copy = string_alloc(str->length);
     copy->char_length = str->char_length;  // Copy cached value
-    copy->capacity = str->capacity;
-    copy->ref_count = 1;  // Start with 1 - caller owns the first reference
-    copy->data = malloc(copy->capacity);
-    if (!copy->data) {
-        free(copy);
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
-    }
     memcpy(copy->data, str->data, str->length + 1);
     return copy;
 }
@@ -86,21 +90,7 @@ String* string_concat(String *a, String *b) {
         exit(1);
     }
     int new_len = a->length + b->length;
-    String *result = malloc(sizeof(String));
-    if (!result) {
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
-    }
-    result->length = new_len;
-    result->char_length = -1;  // Cache invalidated after concatenation
-    result->capacity = new_len + 1;
-    result->ref_count = 1;  // Start with 1 - caller owns the first reference
-    result->data = malloc(result->capacity);
-    if (!result->data) {
-        free(result);
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
-    }
+    String *result = string_alloc(new_len);  // Cache invalidated after concatenation
 
     memcpy(result->data, a->data, a->length);
     memcpy(result->data + a->length, b->data, b->length);
@@ -129,21 +119,7 @@ String* string_concat_many(String **strings, int count) {
     }
 
     // Allocate result string
-    String *result = malloc(sizeof(String));
-    if (!result) {
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
-    }
-    result->length = total_len;
-    result->char_length = -1;  // Cache invalidated after concatenation
-    result->capacity = total_len + 1;
-    result->ref_count = 1;  // Start with 1 - caller owns the first reference
-    result->data = malloc(result->capacity);
-    if (!result->data) {
-        free(result);
-        fprintf(stderr, "Runtime error: Memory allocation failed\n");
-        exit(1);
-    }
+    String *result = string_alloc(total_len);
 
     // Copy all strings in one pass
     int offset = 0;
@@ -156,6 +132,63 @@ String* string_concat_many(String **strings, int count) {
     return result;
 }
 
+int string_append_value(String *str, Value val) {
+    char scratch[STR_NUMBER_MAX];
+    const char *bytes;
+    int len;
+
+    if (val.type == VAL_STRING) {
+        bytes = val.as.as_string->data;
+        len = val.as.as_string->length;
+    } else if (val.type == VAL_RUNE) {
+        // U+0000 appends nothing, as in the string + rune operator
+        len = val.as.as_rune == 0 ? 0 : utf8_encode(val.as.as_rune, scratch);
+        bytes = scratch;
+    } else if (is_numeric(val)) {
+        len = value_format_number(val, scratch);
+        bytes = scratch;
+    } else if (val.type == VAL_BOOL) {
+        bytes = val.as.as_bool ? "true" : "false";
+        len = val.as.as_bool ? 4 : 5;
+    } else if (val.type == VAL_NULL) {
+        bytes = "null";
+        len = 4;
+    } else {
+        return 0;
+    }
+
+    // SECURITY: Check for integer overflow before adding lengths
+    if (str->length > INT_MAX - 1 - len) {
+        fprintf(stderr, "Runtime error: String concatenation overflow - result too large\n");
+        exit(1);
+    }
+    int new_len = str->length + len;
+    if (new_len + 1 > str->capacity) {
+        // Grow geometrically so repeated appends stay amortized O(1)
+        int new_capacity = str->capacity < INT_MAX / 2 ? str->capacity * 2 : INT_MAX;
+        if (new_capacity < new_len + 1) new_capacity = new_len + 1;
+        char *data;
+        if (STRING_IS_INLINE(str)) {
+            data = malloc(new_capacity);
+            if (data) memcpy(data, str->data, str->length);
+        } else {
+            data = realloc(str->data, new_capacity);
+        }
+        if (!data) {
+            fprintf(stderr, "Runtime error: Memory allocation failed\n");
+            exit(1);
+        }
+        str->data = data;
+        str->capacity = new_capacity;
+    }
+
+    memcpy(str->data + str->length, bytes, len);
+    str->length = new_len;
+    str->data[new_len] = '\0';
+    str->char_length = -1;
+    return 1;
+}
+
 Value val_string(const char *str) {
     Value v = {0};  // Zero-initialize entire struct
     v.type = VAL_STRING;
@@ -166,7 +199,7 @@ Value val_string(const char *str) {
 Value val_string_take(char *data, int length, int capacity) {
     Value v = {0};  // Zero-initialize entire struct
     v.type = VAL_STRING;
-    String *str = malloc(sizeof(String));
+    String *str = slab_alloc(STRING_BLOCK_SIZE);
     if (!str) {
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
@@ -176,6 +209,7 @@ Value val_string_take(char *data, int length, int capacity) {
     str->char_length = -1;  // Cache not yet computed
     str->capacity = capacity;
     str->ref_count = 1;  // Start with 1 - caller owns the first reference
+    HEAP_TRACK_ALLOC(str, HEAP_KIND_STRING, sizeof(String) + str->capacity);
     v.as.as_string = str;
     return v;
 }
@@ -195,8 +229,13 @@ Value val_rune(uint32_t codepoint) {
 
 void buffer_free(Buffer *buf) {
     if (buf) {
-        free(buf->data);
-        free(buf);
+        HEAP_TRACK_FREE(buf);
+        if (buf->mapped) {
+            munmap(buf->data, (size_t)buf->capacity);
+        } else {
+            free(buf->data);
+        }
+        slab_free(buf, sizeof(Buffer));
     }
 }
 
@@ -222,13 +261,13 @@ Value val_buffer(int size) {
         exit(1);
     }
 
-    Buffer *buf = malloc(sizeof(Buffer));
+    Buffer *buf = slab_alloc(sizeof(Buffer));
     if (!buf) {
         return val_null();
     }
     buf->data = malloc(size);
     if (buf->data == NULL) {
-        free(buf);
+        slab_free(buf, sizeof(Buffer));
         return val_null();
     }
 
@@ -238,6 +277,8 @@ Value val_buffer(int size) {
     buf->capacity = size;
     buf->ref_count = 1;  // Start with 1 - caller owns the first reference
     atomic_store(&buf->freed, 0);  // Not freed
+    buf->mapped = 0;
+    HEAP_TRACK_ALLOC(buf, HEAP_KIND_BUFFER, sizeof(Buffer) + buf->capacity);
     v.as.as_buffer = buf;
     return v;
 }
@@ -252,7 +293,7 @@ Value val_file(FileHandle *file) {
 // ========== ARRAY OPERATIONS ==========
 
 Array* array_new(void) {
-    Array *arr = malloc(sizeof(Array));
+    Array *arr = slab_alloc(sizeof(Array));
     if (!arr) {
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
@@ -262,28 +303,21 @@ Array* array_new(void) {
     arr->ref_count = 1;  // Start with 1 - caller owns the first reference
     arr->element_type = NULL;  // Untyped array
     atomic_store(&arr->freed, 0);  // Not freed
+    arr->gc_buffered = 0;
     arr->elements = malloc(sizeof(Value) * arr->capacity);
     if (!arr->elements) {
-        free(arr);
+        slab_free(arr, sizeof(Array));
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
     }
+    HEAP_TRACK_ALLOC(arr, HEAP_KIND_ARRAY, sizeof(Array) + arr->capacity * sizeof(Value));
+    GC_NOTE_ALLOCATION();
     return arr;
 }
 
-// Public API for array_free - handles circular references
+// Public API for array_free
 void array_free(Array *arr) {
-    if (!arr) return;
-
-    // Create visited set for cycle detection
-    VisitedSet *visited = visited_set_new();
-    if (!visited) {
-        fprintf(stderr, "Runtime error: Failed to allocate visited set for array_free\n");
-        exit(1);
-    }
-
-    array_free_internal(arr, visited);
-    visited_set_free(visited);
+    array_free_internal(arr);
 }
 
 void array_retain(Array *arr) {
@@ -296,6 +330,9 @@ void array_release(Array *arr) {
     if (!arr) return;
     // Skip if already manually freed via builtin_free()
     if (atomic_load(&arr->freed)) return;
+    // Buffer before the decrement so a concurrent final release always
+    // sees the flag and unbuffers before freeing
+    if (__atomic_load_n(&arr->ref_count, __ATOMIC_RELAXED) > 1) GC_POSSIBLE_ROOT(arr, GC_KIND_ARRAY);
     int old_count = __atomic_sub_fetch(&arr->ref_count, 1, __ATOMIC_SEQ_CST);
     if (old_count == 0) {
         array_free(arr);
@@ -435,6 +472,8 @@ void file_free(FileHandle *file) {
         if (file->fp && !file->closed) {
             fclose(file->fp);
         }
+        free(file->stdio_buf);
+        free(file->line_buf);
         if (file->path) free(file->path);
         if (file->mode) free(file->mode);
         free(file);
@@ -443,19 +482,9 @@ void file_free(FileHandle *file) {
 
 // ========== OBJECT OPERATIONS ==========
 
-// Public API for object_free - handles circular references
+// Public API for object_free
 void object_free(Object *obj) {
-    if (!obj) return;
-
-    // Create visited set for cycle detection
-    VisitedSet *visited = visited_set_new();
-    if (!visited) {
-        fprintf(stderr, "Runtime error: Failed to allocate visited set for object_free\n");
-        exit(1);
-    }
-
-    object_free_internal(obj, visited);
-    visited_set_free(visited);
+    object_free_internal(obj);
 }
 
 void object_retain(Object *obj) {
@@ -468,6 +497,7 @@ void object_release(Object *obj) {
     if (!obj) return;
     // Skip if already manually freed via builtin_free()
     if (atomic_load(&obj->freed)) return;
+    if (__atomic_load_n(&obj->ref_count, __ATOMIC_RELAXED) > 1) GC_POSSIBLE_ROOT(obj, GC_KIND_OBJECT);
     int old_count = __atomic_sub_fetch(&obj->ref_count, 1, __ATOMIC_SEQ_CST);
     if (old_count == 0) {
         object_free(obj);
@@ -478,6 +508,7 @@ void object_release(Object *obj) {
 
 void function_free(Function *fn) {
     if (!fn) return;
+    GC_FORGET(fn, GC_KIND_FUNCTION);
 
     // Bound methods share param arrays with their original function, don't free them
     if (!fn->is_bound) {
@@ -530,6 +561,7 @@ void function_retain(Function *fn) {
 
 void function_release(Function *fn) {
     if (fn) {
+        if (__atomic_load_n(&fn->ref_count, __ATOMIC_RELAXED) > 1) GC_POSSIBLE_ROOT(fn, GC_KIND_FUNCTION);
         int old_count = __atomic_sub_fetch(&fn->ref_count, 1, __ATOMIC_SEQ_CST);
         if (old_count == 0) {
             function_free(fn);
@@ -609,7 +641,7 @@ int object_lookup_field(Object *obj, const char *name) {
 }
 
 Object* object_new(char *type_name, int initial_capacity) {
-    Object *obj = malloc(sizeof(Object));
+    Object *obj = slab_alloc(sizeof(Object));
     if (!obj) {
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
@@ -617,14 +649,14 @@ Object* object_new(char *type_name, int initial_capacity) {
     obj->type_name = type_name ? strdup(type_name) : NULL;
     obj->field_names = malloc(sizeof(char*) * initial_capacity);
     if (!obj->field_names) {
-        free(obj);
+        slab_free(obj, sizeof(Object));
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
     }
     obj->field_values = malloc(sizeof(Value) * initial_capacity);
     if (!obj->field_values) {
         free(obj->field_names);
-        free(obj);
+        slab_free(obj, sizeof(Object));
         fprintf(stderr, "Runtime error: Memory allocation failed\n");
         exit(1);
     }
@@ -632,11 +664,14 @@ Object* object_new(char *type_name, int initial_capacity) {
     obj->capacity = initial_capacity;
     obj->ref_count = 1;  // Start with 1 - caller owns the first reference
     atomic_store(&obj->freed, 0);  // Not freed
+    obj->gc_buffered = 0;
 
     // Hash table is built lazily on first lookup for efficiency
     obj->hash_table = NULL;
     obj->hash_capacity = 0;
 
+    HEAP_TRACK_ALLOC(obj, HEAP_KIND_OBJECT, sizeof(Object) + obj->capacity * (sizeof(Value) + sizeof(char*)));
+    GC_NOTE_ALLOCATION();
     return obj;
 }
 
@@ -966,6 +1001,27 @@ Value val_null(void) {
     return v;
 }
 
+// Print an array, showing one already on the path from the outermost array
+// as [...] so self-referencing arrays terminate
+static void print_array(Array *arr, VisitedSet *path) {
+    if (!visited_set_add(path, arr)) {
+        printf("[...]");
+        return;
+    }
+    printf("[");
+    for (int i = 0; i < arr->length; i++) {
+        if (i > 0) printf(", ");
+        Value elem = arr->elements[i];
+        if (elem.type == VAL_ARRAY) {
+            print_array(elem.as.as_array, path);
+        } else {
+            print_value(elem);
+        }
+    }
+    printf("]");
+    visited_set_remove(path, arr);
+}
+
 void print_value(Value val) {
     switch (val.type) {
         case VAL_I8:
@@ -1024,13 +1080,10 @@ void print_value(Value val) {
                    val.as.as_buffer->capacity);
             break;
         case VAL_ARRAY: {
-            Array *arr = val.as.as_array;
-            printf("[");
-            for (int i = 0; i < arr->length; i++) {
-                if (i > 0) printf(", ");
-                print_value(arr->elements[i]);
-            }
-            printf("]");
+            VisitedSet path;
+            visited_set_init(&path);
+            print_array(val.as.as_array, &path);
+            visited_set_destroy(&path);
             break;
         }
         case VAL_FILE: {
@@ -1066,6 +1119,10 @@ void print_value(Value val) {
             }
             break;
         }
+        case VAL_WRITER:
+            printf("<writer buffered=%d%s>", val.as.as_writer->length,
+                   val.as.as_writer->closed ? " closed" : "");
+            break;
         case VAL_OBJECT:
             if (val.as.as_object->type_name) {
                 printf("<object:%s>", val.as.as_object->type_name);
@@ -1104,6 +1161,63 @@ void print_value(Value val) {
 }
 
 // Convert value to string (caller must free the result)
+// Array representation, with an array already on the path from the
+// outermost array shown as [...]
+static char* array_to_string(Array *arr, VisitedSet *path) {
+    if (!visited_set_add(path, arr)) {
+        return strdup("[...]");
+    }
+    size_t total_len = 2;  // [ and ]
+    char **parts = malloc(sizeof(char*) * (arr->length > 0 ? arr->length : 1));
+    size_t *part_lens = malloc(sizeof(size_t) * (arr->length > 0 ? arr->length : 1));
+    for (int i = 0; i < arr->length; i++) {
+        Value elem = arr->elements[i];
+        parts[i] = elem.type == VAL_ARRAY ? array_to_string(elem.as.as_array, path)
+                                          : value_to_string(elem);
+        part_lens[i] = strlen(parts[i]);
+        total_len += part_lens[i];
+        if (i > 0) total_len += 2;  // ", "
+    }
+
+    // SECURITY: Use memcpy with explicit position tracking instead of strcat
+    char *result = malloc(total_len + 1);
+    size_t pos = 0;
+    result[pos++] = '[';
+    for (int i = 0; i < arr->length; i++) {
+        if (i > 0) {
+            memcpy(result + pos, ", ", 2);
+            pos += 2;
+        }
+        memcpy(result + pos, parts[i], part_lens[i]);
+        pos += part_lens[i];
+        free(parts[i]);
+    }
+    result[pos++] = ']';
+    result[pos] = '\0';
+    free(parts);
+    free(part_lens);
+    visited_set_remove(path, arr);
+    return result;
+}
+
+// A number as value_to_string() writes it, into dst of STR_NUMBER_MAX bytes
+// without a terminator; returns the length
+int value_format_number(Value val, char *dst) {
+    switch (val.type) {
+        case VAL_I8: return str_format_i64(dst, val.as.as_i8);
+        case VAL_I16: return str_format_i64(dst, val.as.as_i16);
+        case VAL_I32: return str_format_i64(dst, val.as.as_i32);
+        case VAL_I64: return str_format_i64(dst, val.as.as_i64);
+        case VAL_U8: return str_format_u64(dst, val.as.as_u8);
+        case VAL_U16: return str_format_u64(dst, val.as.as_u16);
+        case VAL_U32: return str_format_u64(dst, val.as.as_u32);
+        case VAL_U64: return str_format_u64(dst, val.as.as_u64);
+        case VAL_F32: return str_format_f64(dst, val.as.as_f32);
+        case VAL_F64: return str_format_f64(dst, val.as.as_f64);
+        default: return 0;
+    }
+}
+
 char* value_to_string(Value val) {
     char buffer[1024];  // Temporary buffer for formatting
 
@@ -1175,35 +1289,10 @@ char* value_to_string(Value val) {
                    val.as.as_buffer->capacity);
             return strdup(buffer);
         case VAL_ARRAY: {
-            // Simple array representation
-            Array *arr = val.as.as_array;
-            size_t total_len = 2;  // [ and ]
-            char **parts = malloc(sizeof(char*) * (arr->length > 0 ? arr->length : 1));
-            size_t *part_lens = malloc(sizeof(size_t) * (arr->length > 0 ? arr->length : 1));
-            for (int i = 0; i < arr->length; i++) {
-                parts[i] = value_to_string(arr->elements[i]);
-                part_lens[i] = strlen(parts[i]);
-                total_len += part_lens[i];
-                if (i > 0) total_len += 2;  // ", "
-            }
-
-            // SECURITY: Use memcpy with explicit position tracking instead of strcat
-            char *result = malloc(total_len + 1);
-            size_t pos = 0;
-            result[pos++] = '[';
-            for (int i = 0; i < arr->length; i++) {
-                if (i > 0) {
-                    memcpy(result + pos, ", ", 2);
-                    pos += 2;
-                }
-                memcpy(result + pos, parts[i], part_lens[i]);
-                pos += part_lens[i];
-                free(parts[i]);
-            }
-            result[pos++] = ']';
-            result[pos] = '\0';
-            free(parts);
-            free(part_lens);
+            VisitedSet path;
+            visited_set_init(&path);
+            char *result = array_to_string(val.as.as_array, &path);
+            visited_set_destroy(&path);
             return result;
         }
         case VAL_FILE: {
@@ -1243,6 +1332,11 @@ char* value_to_string(Value val) {
                 return strdup(buffer);
             }
         }
+        case VAL_WRITER:
+            snprintf(buffer, sizeof(buffer), "<writer buffered=%d%s>",
+                   val.as.as_writer->length,
+                   val.as.as_writer->closed ? " closed" : "");
+            return strdup(buffer);
         case VAL_OBJECT:
             if (val.as.as_object->type_name) {
                 snprintf(buffer, sizeof(buffer), "<object:%s>", val.as.as_object->type_name);
@@ -1276,81 +1370,139 @@ char* value_to_string(Value val) {
     return strdup("<unknown>");
 }
 
-// ========== VALUE CLEANUP ==========
+// ========== VISITED SET ==========
 
-// ========== CYCLE DETECTION FOR DEALLOCATION ==========
+// Linear probing over a power-of-two table. Keys are never NULL, so NULL
+// marks an empty slot and removal shifts the rest of the probe run back
+// instead of leaving tombstones.
 
-// Shared VisitedSet implementation (declared in internal.h)
-// Used by both values.c and environment.c for cycle detection
-VisitedSet* visited_set_new(void) {
-    VisitedSet *set = malloc(sizeof(VisitedSet));
-    if (!set) return NULL;
+static inline int visited_home(const VisitedSet *set, void *ptr) {
+    uint64_t h = (uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ULL;
+    return (int)(h >> 32) & (set->capacity - 1);
+}
+
+// Slot holding ptr, or the empty slot where it would go
+static inline int visited_find(const VisitedSet *set, void *ptr) {
+    int mask = set->capacity - 1;
+    int slot = visited_home(set, ptr);
+    while (set->keys[slot] && set->keys[slot] != ptr) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void visited_set_init(VisitedSet *set) {
+    set->keys = set->inline_keys;
+    set->values = NULL;
+    set->count = 0;
     set->capacity = HML_INITIAL_VISITED_SET_CAPACITY;
+    memset(set->inline_keys, 0, sizeof(set->inline_keys));
+}
+
+void visited_set_destroy(VisitedSet *set) {
+    if (set->keys != set->inline_keys) free(set->keys);
+    free(set->values);
+    set->keys = set->inline_keys;
+    set->values = NULL;
     set->count = 0;
-    set->pointers = malloc(sizeof(void*) * set->capacity);
-    if (!set->pointers) {
-        free(set);
-        return NULL;
-    }
-    return set;
 }
 
-void visited_set_free(VisitedSet *set) {
-    if (set) {
-        free(set->pointers);
-        free(set);
+static void visited_set_grow(VisitedSet *set) {
+    // SECURITY: Check for integer overflow before doubling
+    if (set->capacity > INT_MAX / 2) {
+        fprintf(stderr, "Runtime error: Visited set capacity overflow\n");
+        exit(1);
+    }
+    int old_capacity = set->capacity;
+    void **old_keys = set->keys;
+    void **old_values = set->values;
+
+    set->capacity = old_capacity * 2;
+    set->keys = calloc((size_t)set->capacity, sizeof(void*));
+    set->values = old_values ? calloc((size_t)set->capacity, sizeof(void*)) : NULL;
+    if (!set->keys || (old_values && !set->values)) {
+        fprintf(stderr, "Runtime error: Memory allocation failed during visited set growth\n");
+        exit(1);
     }
+    for (int i = 0; i < old_capacity; i++) {
+        if (!old_keys[i]) continue;
+        int slot = visited_find(set, old_keys[i]);
+        set->keys[slot] = old_keys[i];
+        if (old_values) set->values[slot] = old_values[i];
+    }
+    if (old_keys != set->inline_keys) free(old_keys);
+    free(old_values);
 }
 
 int visited_set_contains(VisitedSet *set, void *ptr) {
-    for (int i = 0; i < set->count; i++) {
-        if (set->pointers[i] == ptr) {
-            return 1;
-        }
+    return set->keys[visited_find(set, ptr)] != NULL;
+}
+
+int visited_set_add(VisitedSet *set, void *ptr) {
+    int slot = visited_find(set, ptr);
+    if (set->keys[slot]) return 0;
+    if ((set->count + 1) * 2 > set->capacity) {
+        visited_set_grow(set);
+        slot = visited_find(set, ptr);
     }
-    return 0;
+    set->keys[slot] = ptr;
+    set->count++;
+    return 1;
 }
 
-void visited_set_add(VisitedSet *set, void *ptr) {
-    if (set->count >= set->capacity) {
-        // SECURITY: Check for integer overflow before doubling
-        if (set->capacity > INT_MAX / 2) {
-            fprintf(stderr, "Runtime error: Visited set capacity overflow\n");
-            exit(1);
-        }
-        int new_capacity = set->capacity * 2;
-        if ((size_t)new_capacity > SIZE_MAX / sizeof(void*)) {
-            fprintf(stderr, "Runtime error: Visited set allocation overflow\n");
-            exit(1);
+void visited_set_remove(VisitedSet *set, void *ptr) {
+    int mask = set->capacity - 1;
+    int hole = visited_find(set, ptr);
+    if (!set->keys[hole]) return;
+
+    // Move each later entry of the run whose home is at or before the hole
+    for (int next = (hole + 1) & mask; set->keys[next]; next = (next + 1) & mask) {
+        int home = visited_home(set, set->keys[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            set->keys[hole] = set->keys[next];
+            if (set->values) set->values[hole] = set->values[next];
+            hole = next;
         }
-        void **new_pointers = realloc(set->pointers, sizeof(void*) * (size_t)new_capacity);
-        if (!new_pointers) {
+    }
+    set->keys[hole] = NULL;
+    if (set->values) set->values[hole] = NULL;
+    set->count--;
+}
+
+void visited_set_put(VisitedSet *set, void *ptr, void *value) {
+    if (!set->values) {
+        set->values = calloc((size_t)set->capacity, sizeof(void*));
+        if (!set->values) {
             fprintf(stderr, "Runtime error: Memory allocation failed during visited set growth\n");
             exit(1);
         }
-        set->capacity = new_capacity;
-        set->pointers = new_pointers;
     }
-    set->pointers[set->count++] = ptr;
+    visited_set_add(set, ptr);
+    set->values[visited_find(set, ptr)] = value;
 }
 
-// Forward declarations for internal versions
-static void value_free_internal(Value val, VisitedSet *visited);
+void* visited_set_get(VisitedSet *set, void *ptr) {
+    int slot = visited_find(set, ptr);
+    if (!set->keys[slot] || !set->values) return NULL;
+    return set->values[slot];
+}
 
-// Internal version of object_free with cycle detection
-static void object_free_internal(Object *obj, VisitedSet *visited) {
+// ========== VALUE CLEANUP ==========
+
+// Containers release their children rather than freeing them, so each
+// child is freed by its own release once nothing else holds it. Members of
+// a cycle never reach zero here (the cycle collector handles those), so
+// freeing needs no visited set.
+
+// Internal version of object_free
+static void object_free_internal(Object *obj) {
     if (!obj) return;
 
     // Check if manually freed via builtin_free()
     if (atomic_load(&obj->freed)) return;
 
-    // Check if already visited (cycle detected)
-    if (visited_set_contains(visited, obj)) {
-        return;  // Already freeing this object - skip to prevent infinite recursion
-    }
-
-    // Mark as visited
-    visited_set_add(visited, obj);
+    HEAP_TRACK_FREE(obj);
+    GC_FORGET(obj, GC_KIND_OBJECT);
 
     // Free object contents
     if (obj->type_name) free(obj->type_name);
@@ -1363,23 +1515,18 @@ static void object_free_internal(Object *obj, VisitedSet *visited) {
     free(obj->field_values);
     // Free hash table
     if (obj->hash_table) free(obj->hash_table);
-    free(obj);
+    slab_free(obj, sizeof(Object));
 }
 
-// Internal version of array cleanup with cycle detection
-static void array_free_internal(Array *arr, VisitedSet *visited) {
+// Internal version of array cleanup
+static void array_free_internal(Array *arr) {
     if (!arr) return;
 
     // Check if manually freed via builtin_free()
     if (atomic_load(&arr->freed)) return;
 
-    // Check if already visited (cycle detected)
-    if (visited_set_contains(visited, arr)) {
-        return;  // Already freeing this array - skip to prevent infinite recursion
-    }
-
-    // Mark as visited
-    visited_set_add(visited, arr);
+    HEAP_TRACK_FREE(arr);
+    GC_FORGET(arr, GC_KIND_ARRAY);
 
     // Release each element (decrements ref_counts)
     for (int i = 0; i < arr->length; i++) {
@@ -1392,11 +1539,11 @@ static void array_free_internal(Array *arr, VisitedSet *visited) {
         type_free(arr->element_type);
     }
 
-    free(arr);
+    slab_free(arr, sizeof(Array));
 }
 
-// Internal version of value_free with cycle detection
-static void value_free_internal(Value val, VisitedSet *visited) {
+// Internal version of value_free
+static void value_free_internal(Value val) {
     switch (val.type) {
         case VAL_STRING:
             if (val.as.as_string) {
@@ -1413,7 +1560,7 @@ static void value_free_internal(Value val, VisitedSet *visited) {
             break;
         case VAL_ARRAY:
             if (val.as.as_array) {
-                array_free_internal(val.as.as_array, visited);
+                array_free_internal(val.as.as_array);
             }
             break;
         case VAL_FILE:
@@ -1431,9 +1578,14 @@ static void value_free_internal(Value val, VisitedSet *visited) {
                 websocket_free(val.as.as_websocket);
             }
             break;
+        case VAL_WRITER:
+            if (val.as.as_writer) {
+                writer_free(val.as.as_writer);
+            }
+            break;
         case VAL_OBJECT:
             if (val.as.as_object) {
-                object_free_internal(val.as.as_object, visited);
+                object_free_internal(val.as.as_object);
             }
             break;
         case VAL_FUNCTION:
@@ -1485,16 +1637,9 @@ static void value_free_internal(Value val, VisitedSet *visited) {
     }
 }
 
-// Public API - recursively free a Value and all its heap-allocated contents
-// Now handles circular references safely
+// Public API - free a Value and release its heap-allocated contents
 void value_free(Value val) {
-    VisitedSet *visited = visited_set_new();
-    if (!visited) {
-        fprintf(stderr, "Runtime error: Failed to allocate visited set for value_free\n");
-        exit(1);
-    }
-    value_free_internal(val, visited);
-    visited_set_free(visited);
+    value_free_internal(val);
 }
 
 // Fast path check - most values don't need refcounting
@@ -1502,7 +1647,7 @@ static inline int value_needs_refcount(ValueType type) {
     // Only heap-allocated types need refcounting
     return type == VAL_STRING || type == VAL_BUFFER || type == VAL_ARRAY ||
            type == VAL_OBJECT || type == VAL_FUNCTION || type == VAL_TASK ||
-           type == VAL_CHANNEL || type == VAL_REF;
+           type == VAL_CHANNEL || type == VAL_WRITER || type == VAL_REF;
 }
 
 // Public API - increment reference count for heap-allocated values
@@ -1546,6 +1691,11 @@ void value_retain(Value val) {
                 channel_retain(val.as.as_channel);
             }
             break;
+        case VAL_WRITER:
+            if (val.as.as_writer) {
+                writer_retain(val.as.as_writer);
+            }
+            break;
         case VAL_REF:
             if (val.as.as_ref) {
                 __atomic_add_fetch(&val.as.as_ref->ref_count, 1, __ATOMIC_SEQ_CST);
@@ -1598,6 +1748,11 @@ void value_release(Value val) {
                 channel_release(val.as.as_channel);
             }
             break;
+        case VAL_WRITER:
+            if (val.as.as_writer) {
+                writer_release(val.as.as_writer);
+            }
+            break;
         case VAL_REF:
             if (val.as.as_ref) {
                 reference_free(val.as.as_ref);
@@ -1611,9 +1766,24 @@ void value_release(Value val) {
 
 // ========== VALUE DEEP COPY (for thread isolation) ==========
 
+static Value value_deep_copy_internal(Value val, VisitedSet *copies);
+
 // Deep copy a value for passing to spawned tasks
-// This ensures tasks don't share mutable state with the parent thread
+// This ensures tasks don't share mutable state with the parent thread.
+// Arrays and objects reached more than once are copied once, so shared
+// substructure stays shared and cycles are reproduced in the copy.
 Value value_deep_copy(Value val) {
+    if (val.type != VAL_ARRAY && val.type != VAL_OBJECT) {
+        return value_deep_copy_internal(val, NULL);
+    }
+    VisitedSet copies;
+    visited_set_init(&copies);
+    Value result = value_deep_copy_internal(val, &copies);
+    visited_set_destroy(&copies);
+    return result;
+}
+
+static Value value_deep_copy_internal(Value val, VisitedSet *copies) {
     Value result = {0};
 
     switch (val.type) {
@@ -1658,7 +1828,15 @@ Value value_deep_copy(Value val) {
         case VAL_ARRAY:
             if (val.as.as_array) {
                 Array *src = val.as.as_array;
-                Array *dst = array_new();
+                Array *dst = visited_set_get(copies, src);
+                if (dst) {
+                    array_retain(dst);
+                    result.type = VAL_ARRAY;
+                    result.as.as_array = dst;
+                    break;
+                }
+                dst = array_new();
+                visited_set_put(copies, src, dst);
                 // Copy element type if present
                 if (src->element_type) {
                     dst->element_type = malloc(sizeof(Type));
@@ -1668,7 +1846,7 @@ Value value_deep_copy(Value val) {
                 }
                 // Deep copy each element
                 for (int i = 0; i < src->length; i++) {
-                    Value elem_copy = value_deep_copy(src->elements[i]);
+                    Value elem_copy = value_deep_copy_internal(src->elements[i], copies);
                     array_push(dst, elem_copy);
                     value_release(elem_copy);  // array_push retains
                 }
@@ -1682,7 +1860,15 @@ Value value_deep_copy(Value val) {
         case VAL_OBJECT:
             if (val.as.as_object) {
                 Object *src = val.as.as_object;
-                Object *dst = object_new(src->type_name, src->capacity);
+                Object *dst = visited_set_get(copies, src);
+                if (dst) {
+                    object_retain(dst);
+                    result.type = VAL_OBJECT;
+                    result.as.as_object = dst;
+                    break;
+                }
+                dst = object_new(src->type_name, src->capacity);
+                visited_set_put(copies, src, dst);
                 // Deep copy each field
                 for (int i = 0; i < src->num_fields; i++) {
                     // Grow if needed
@@ -1704,9 +1890,8 @@ Value value_deep_copy(Value val) {
                         dst->field_values = new_values;
                     }
                     dst->field_names[dst->num_fields] = strdup(src->field_names[i]);
-                    Value field_copy = value_deep_copy(src->field_values[i]);
-                    value_retain(field_copy);
-                    dst->field_values[dst->num_fields] = field_copy;
+                    // The copy's reference is handed to the field
+                    dst->field_values[dst->num_fields] = value_deep_copy_internal(src->field_values[i], copies);
                     dst->num_fields++;
                 }
                 result.type = VAL_OBJECT;
@@ -1737,6 +1922,19 @@ Value value_deep_copy(Value val) {
             // We share by reference (no deep copy needed)
             return val;
 
+        case VAL_WRITER: {
+            // The task gets its own empty writer for the same target, so
+            // two threads never fill one buffer
+            WriterHandle *src = val.as.as_writer;
+            WriterHandle *dst = writer_new(src->file, src->fd, src->capacity);
+            if (!dst) {
+                fprintf(stderr, "Runtime error: Memory allocation failed\n");
+                exit(1);
+            }
+            dst->closed = src->closed;
+            return val_writer(dst);
+        }
+
         case VAL_FUNCTION:
             // Functions are retained (shared) but their closure env is isolated
             // The spawn function will handle this specially
@@ -1,5 +1,6 @@
 #include "ast.h"
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 
 // ========== EXPRESSION CONSTRUCTORS ==========
@@ -188,6 +189,10 @@ Expr* expr_function(int is_async, char **param_names, Type **param_types, Expr *
     expr->as.function.rest_param_type = rest_param_type;
     expr->as.function.return_type = return_type;
     expr->as.function.body = body;
+    expr->as.function.is_flat = 0;
+    expr->as.function.num_captures = 0;
+    expr->as.function.capture_names = NULL;
+    expr->as.function.captures = NULL;
     return expr;
 }
 
@@ -527,12 +532,51 @@ Stmt* stmt_switch(Expr *expr, Expr **case_values, Stmt **case_bodies, int num_ca
     return stmt;
 }
 
+/*
+ * The call a defer runs at function exit, rebuilt to read its callee (or
+ * method receiver) from slot 0 and its arguments from slots 1..n of an
+ * environment holding just those operands, which the interpreter evaluates
+ * when the defer statement runs. Returns NULL for an expression that is not
+ * a call.
+ */
+Expr* expr_defer_binding(Expr *call) {
+    if (call->type != EXPR_CALL) {
+        return NULL;
+    }
+    Expr *func = call->as.call.func;
+    int num_args = call->as.call.num_args;
+
+    // The callee keeps its name for stack traces
+    Expr *target = expr_ident(func->type == EXPR_IDENT ? func->as.ident.name
+                              : func->type == EXPR_GET_PROPERTY ? "$0" : "<anonymous>");
+    target->as.ident.resolved.is_resolved = 1;
+    Expr *bound_func = target;
+    if (func->type == EXPR_GET_PROPERTY) {
+        bound_func = expr_get_property(target, func->as.get_property.property);
+    }
+
+    Expr **args = num_args > 0 ? malloc(sizeof(Expr*) * num_args) : NULL;
+    for (int i = 0; i < num_args; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "$%d", i + 1);
+        args[i] = expr_ident(name);
+        args[i]->as.ident.resolved.is_resolved = 1;
+        args[i]->as.ident.resolved.slot = i + 1;
+    }
+
+    Expr *bound = expr_call(bound_func, args, num_args);
+    bound->line = call->line;
+    bound->column = call->column;
+    return bound;
+}
+
 Stmt* stmt_defer(Expr *call) {
     Stmt *stmt = malloc(sizeof(Stmt));
     stmt->type = STMT_DEFER;
     stmt->line = 0;
     stmt->column = 0;
     stmt->as.defer_stmt.call = call;
+    stmt->as.defer_stmt.bound_call = expr_defer_binding(call);
     return stmt;
 }
 
@@ -924,6 +968,11 @@ void expr_free(Expr *expr) {
             }
             // Free body
             stmt_free(expr->as.function.body);
+            for (int i = 0; i < expr->as.function.num_captures; i++) {
+                free(expr->as.function.capture_names[i]);
+            }
+            free(expr->as.function.capture_names);
+            free(expr->as.function.captures);
             break;
         case EXPR_ARRAY_LITERAL:
             // Free array elements
@@ -1100,6 +1149,7 @@ void stmt_free(Stmt *stmt) {
             break;
         case STMT_DEFER:
             expr_free(stmt->as.defer_stmt.call);
+            expr_free(stmt->as.defer_stmt.bound_call);
             break;
         case STMT_IMPORT:
             free(stmt->as.import_stmt.namespace_name);
@@ -614,6 +614,10 @@ static Expr* deserialize_expr(DeserializeContext *ctx) {
             }
             expr->as.function.return_type = deserialize_type(ctx);
             expr->as.function.body = deserialize_stmt(ctx);
+            expr->as.function.is_flat = 0;
+            expr->as.function.num_captures = 0;
+            expr->as.function.capture_names = NULL;
+            expr->as.function.captures = NULL;
             break;
         }
 
@@ -1072,6 +1076,7 @@ static Stmt* deserialize_stmt(DeserializeContext *ctx) {
 
         case STMT_DEFER:
             stmt->as.defer_stmt.call = deserialize_expr(ctx);
+            stmt->as.defer_stmt.bound_call = expr_defer_binding(stmt->as.defer_stmt.call);
             break;
 
         case STMT_IMPORT: {
@@ -952,7 +952,7 @@ void execute_module(Module *module, ModuleCache *cache, Environment *global_env,
         }
 
         // Check for uncaught exception after each statement
-        if (ctx->exception_state.is_throwing) {
+        if (ctx->flow.is_throwing) {
             // Convert exception value to string for stderr output
             char *error_msg = value_to_string(ctx->exception_state.exception_value);
             fprintf(stderr, "Uncaught exception: %s\n", error_msg);
@@ -1004,6 +1004,9 @@ int execute_file_with_modules(const char *file_path, Environment *global_env, in
     // Execute the main module (and all its dependencies in topological order)
     execute_module(main_module, cache, global_env, ctx);
 
+    // Profile frames point into module ASTs - fold them before the cache goes
+    profiler_stop();
+
     // Cleanup
     module_cache_free(cache);
 
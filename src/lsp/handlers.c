@@ -577,7 +577,7 @@ JSONValue *handle_completion(LSPServer *server, JSONValue *params) {
     const char *builtins[] = {
         "print", "println", "typeof", "sizeof", "len",
         "alloc", "free", "memset", "memcpy", "realloc",
-        "open", "read_file", "write_file",
+        "open", "mmap_file", "read_file", "write_file",
         "channel", "send", "recv", "close",
         "signal", "raise", "exit", "exec",
         "panic", "assert"
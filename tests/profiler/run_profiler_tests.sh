@@ -0,0 +1,281 @@
+#!/bin/bash
+# Profiler Test Suite
+# Tests `hemlock --profile` and `hemlockc --profile` sampling output,
+# plus the heap profiler (`--heap-profile` / HEMLOCK_HEAP_PROFILE=1)
+
+HEMLOCK="./hemlock"
+HEMLOCKC="./hemlockc"
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+PASSED=0
+FAILED=0
+
+# Color codes
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # No Color
+
+pass() {
+    echo -e "${GREEN}PASS${NC}: $1"
+    ((PASSED++))
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC}: $1"
+    echo "  $2"
+    ((FAILED++))
+}
+
+echo "=== Hemlock Profiler Test Suite ==="
+echo ""
+
+# CPU-bound workload: hot_loop should dominate self time, called via outer
+cat > "$TMPDIR/workload.hml" << 'EOF'
+fn hot_loop(n) {
+    let s = 0;
+    for (let i = 0; i < n; i++) {
+        s = s + i % 7;
+    }
+    return s;
+}
+
+fn outer() {
+    let total = 0;
+    for (let k = 0; k < 20; k++) {
+        total = total + hot_loop(20000);
+    }
+    return total;
+}
+
+fn thrower(n) {
+    if (n == 0) {
+        throw "done";
+    }
+    return thrower(n - 1);
+}
+
+// Caught exceptions must not leave stale frames on the sampled stack
+try { thrower(10); } catch (e) { }
+print(outer());
+EOF
+
+# Test 1: Interpreter writes folded stacks to the requested file
+echo "Test 1: Interpreter --profile=FILE"
+OUTPUT=$($HEMLOCK --profile="$TMPDIR/interp.folded" "$TMPDIR/workload.hml" 2>"$TMPDIR/interp.err")
+if [ "$OUTPUT" = "1199940" ]; then
+    pass "Program output unchanged under --profile"
+else
+    fail "Program output under --profile" "Got: $OUTPUT"
+fi
+if [ -s "$TMPDIR/interp.folded" ] && grep -q "^<main>;outer;hot_loop [0-9]*$" "$TMPDIR/interp.folded"; then
+    pass "Folded stacks contain <main>;outer;hot_loop"
+else
+    fail "Folded stacks" "$(head -5 "$TMPDIR/interp.folded" 2>/dev/null)"
+fi
+if grep -q "thrower;" "$TMPDIR/interp.folded" && grep "thrower;" "$TMPDIR/interp.folded" | grep -q "hot_loop"; then
+    fail "Caught exception frames" "hot_loop sampled under stale thrower frames"
+else
+    pass "Caught exceptions unwind sampled frames"
+fi
+
+# Test 2: Summary table goes to stderr
+echo "Test 2: Interpreter summary table"
+if grep -q "=== Profile:" "$TMPDIR/interp.err" && grep -q "hot_loop" "$TMPDIR/interp.err"; then
+    pass "Summary table printed to stderr"
+else
+    fail "Summary table" "$(cat "$TMPDIR/interp.err")"
+fi
+
+# Test 3: Default output path
+echo "Test 3: Interpreter --profile default path"
+(cd "$TMPDIR" && "$OLDPWD/$HEMLOCK" --profile workload.hml >/dev/null 2>&1)
+if [ -s "$TMPDIR/hemlock-profile.folded" ]; then
+    pass "Default output hemlock-profile.folded written"
+else
+    fail "Default output path" "hemlock-profile.folded missing"
+fi
+
+# Test 4: Uncaught exception still writes the profile
+echo "Test 4: Profile written on uncaught exception"
+cat > "$TMPDIR/uncaught.hml" << 'EOF'
+fn spin() {
+    let s = 0;
+    for (let i = 0; i < 200000; i++) { s = s + 1; }
+    return s;
+}
+spin();
+throw "boom";
+EOF
+$HEMLOCK --profile="$TMPDIR/uncaught.folded" "$TMPDIR/uncaught.hml" >/dev/null 2>&1
+if [ -f "$TMPDIR/uncaught.folded" ]; then
+    pass "Profile written after uncaught exception"
+else
+    fail "Uncaught exception profile" "No output file"
+fi
+
+# Test 5: Task threads are sampled under <task>
+echo "Test 5: Task threads sampled"
+cat > "$TMPDIR/tasks.hml" << 'EOF'
+async fn crunch(n) {
+    let s = 0;
+    for (let i = 0; i < n; i++) { s = s + i % 3; }
+    return s;
+}
+let a = spawn(crunch, 300000);
+let b = spawn(crunch, 300000);
+print(join(a) + join(b));
+EOF
+$HEMLOCK --profile="$TMPDIR/tasks.folded" "$TMPDIR/tasks.hml" >/dev/null 2>&1
+if grep -q "^<task>" "$TMPDIR/tasks.folded"; then
+    pass "Task samples recorded under <task>"
+else
+    fail "Task sampling" "$(head -5 "$TMPDIR/tasks.folded" 2>/dev/null)"
+fi
+
+# Test 6: Compiled binary built with --profile
+echo "Test 6: hemlockc --profile"
+if [ -x "$HEMLOCKC" ]; then
+    if $HEMLOCKC --profile="$TMPDIR/compiled.folded" "$TMPDIR/workload.hml" -o "$TMPDIR/workload_bin" 2>/dev/null; then
+        OUTPUT=$("$TMPDIR/workload_bin" 2>/dev/null)
+        if [ "$OUTPUT" = "1199940" ] && [ -f "$TMPDIR/compiled.folded" ]; then
+            pass "Compiled binary writes folded stacks"
+        else
+            fail "Compiled profile" "Output: $OUTPUT"
+        fi
+        if [ -s "$TMPDIR/compiled.folded" ] && ! grep -v "^<main>" "$TMPDIR/compiled.folded" | grep -q .; then
+            pass "Compiled folded stacks are rooted at <main>"
+        else
+            fail "Compiled folded stacks" "$(head -5 "$TMPDIR/compiled.folded" 2>/dev/null)"
+        fi
+    else
+        fail "Compiled profile" "hemlockc --profile failed"
+    fi
+else
+    echo -e "${YELLOW}SKIP${NC}: hemlockc not built"
+fi
+
+# Heap profiler workload: a reference cycle that outlives its variables
+cat > "$TMPDIR/heap.hml" << 'EOF'
+fn make_pair() {
+    let a = { name: "left" };
+    let b = { name: "right", peer: a };
+    a.peer = b;
+    return null;
+}
+make_pair();
+let keep = [];
+for (let i = 0; i < 200; i++) { keep.push("item" + i); }
+let s = heap_stats();
+print(`${s.enabled} ${s.by_type["string"].live >= 200} ${s.peak_bytes >= s.live_bytes}`);
+heap_snapshot(args[1]);
+EOF
+
+# Test 7: Heap profiling is off by default
+echo "Test 7: heap_stats() without --heap-profile"
+OUTPUT=$($HEMLOCK "$TMPDIR/heap.hml" "$TMPDIR/off.json" 2>&1)
+if echo "$OUTPUT" | grep -q "^false false true" && echo "$OUTPUT" | grep -q "requires heap profiling"; then
+    pass "Tracking off by default; heap_snapshot() refuses"
+else
+    fail "Heap profiling default" "Got: $OUTPUT"
+fi
+
+# Test 8: Interpreter --heap-profile counts, snapshot and summary
+echo "Test 8: Interpreter --heap-profile"
+OUTPUT=$($HEMLOCK --heap-profile "$TMPDIR/heap.hml" "$TMPDIR/interp_heap.json" 2>"$TMPDIR/interp_heap.err")
+if [ "$OUTPUT" = "true true true" ]; then
+    pass "heap_stats() reports live strings"
+else
+    fail "heap_stats() under --heap-profile" "Got: $OUTPUT"
+fi
+if grep -q '"preview": "right"' "$TMPDIR/interp_heap.json" && grep -q '"type": "object".*"referrers": \[[0-9]' "$TMPDIR/interp_heap.json"; then
+    pass "Snapshot lists leaked cycle with referrers"
+else
+    fail "Heap snapshot" "$(head -5 "$TMPDIR/interp_heap.json" 2>/dev/null)"
+fi
+if grep -q "=== Heap profile:" "$TMPDIR/interp_heap.err" && grep -q "^string " "$TMPDIR/interp_heap.err"; then
+    pass "Heap summary printed to stderr"
+else
+    fail "Heap summary" "$(cat "$TMPDIR/interp_heap.err")"
+fi
+
+# Test 9: Compiled binary with HEMLOCK_HEAP_PROFILE=1
+echo "Test 9: Compiled HEMLOCK_HEAP_PROFILE=1"
+if [ -x "$HEMLOCKC" ] && $HEMLOCKC "$TMPDIR/heap.hml" -o "$TMPDIR/heap_bin" 2>/dev/null; then
+    OUTPUT=$(HEMLOCK_HEAP_PROFILE=1 "$TMPDIR/heap_bin" "$TMPDIR/compiled_heap.json" 2>/dev/null)
+    if [ "$OUTPUT" = "true true true" ] && grep -q '"preview": "right"' "$TMPDIR/compiled_heap.json"; then
+        pass "Compiled binary tracks heap and writes snapshot"
+    else
+        fail "Compiled heap profile" "Output: $OUTPUT"
+    fi
+else
+    echo -e "${YELLOW}SKIP${NC}: hemlockc not built"
+fi
+
+# Tracer workload: a producer blocking on an unbuffered channel
+cat > "$TMPDIR/trace.hml" << 'EOF'
+import { sleep } from "@stdlib/time";
+async fn producer(ch) {
+    for (let i = 0; i < 3; i++) { ch.send(i); }
+    return null;
+}
+let ch = channel(0);
+let t = spawn(producer, ch);
+sleep(0.01);
+let total = 0;
+for (let i = 0; i < 3; i++) { total = total + ch.recv(); }
+join(t);
+print(total);
+EOF
+
+check_trace() {
+    local file="$1"
+    grep -q '"traceEvents"' "$file" &&
+        grep -q '"name": "task 1"' "$file" &&
+        grep -q '"name": "spawn"' "$file" &&
+        grep -q '"name": "join"' "$file" &&
+        grep -q '"name": "send"' "$file" &&
+        grep -q '"name": "recv"' "$file" &&
+        grep -q '"name": "block"' "$file" &&
+        grep -q '"name": "wake"' "$file"
+}
+
+# Test 10: Interpreter --trace=FILE
+echo "Test 10: Interpreter --trace"
+OUTPUT=$($HEMLOCK --trace="$TMPDIR/interp_trace.json" "$TMPDIR/trace.hml" 2>&1)
+if [ "$OUTPUT" = "3" ] && check_trace "$TMPDIR/interp_trace.json"; then
+    pass "Trace has task track and channel block/wake events"
+else
+    fail "Interpreter --trace" "Output: $OUTPUT"
+fi
+if command -v python3 > /dev/null; then
+    if python3 -c "import json,sys; json.load(open(sys.argv[1]))" "$TMPDIR/interp_trace.json" 2>/dev/null; then
+        pass "Trace is valid JSON"
+    else
+        fail "Trace JSON" "$(head -5 "$TMPDIR/interp_trace.json")"
+    fi
+fi
+
+# Test 11: Compiled binary with HEMLOCK_TRACE=FILE
+echo "Test 11: Compiled HEMLOCK_TRACE"
+if [ -x "$HEMLOCKC" ] && $HEMLOCKC "$TMPDIR/trace.hml" -o "$TMPDIR/trace_bin" 2>/dev/null; then
+    OUTPUT=$(HEMLOCK_TRACE="$TMPDIR/compiled_trace.json" "$TMPDIR/trace_bin" 2>&1)
+    if [ "$OUTPUT" = "3" ] && check_trace "$TMPDIR/compiled_trace.json"; then
+        pass "Compiled binary writes trace"
+    else
+        fail "Compiled trace" "Output: $OUTPUT"
+    fi
+else
+    echo -e "${YELLOW}SKIP${NC}: hemlockc not built"
+fi
+
+echo ""
+echo "=== Results ==="
+echo -e "Passed: ${GREEN}$PASSED${NC}"
+echo -e "Failed: ${RED}$FAILED${NC}"
+
+if [ $FAILED -gt 0 ]; then
+    exit 1
+fi
+exit 0
@@ -114,9 +114,10 @@ for test_file in $TEST_FILES; do
     category=$(dirname "$test_file" | cut -d'/' -f2)
     test_name="${test_file#tests/}"
 
-    # Skip HTTP/WebSocket tests if lws_wrapper.so doesn't exist
+    # Skip HTTP/WebSocket tests if lws_wrapper.so doesn't exist, unless
+    # HEMLOCK_REQUIRE_LWS=1 (CI), where a missing library is a failure
     if [[ "$category" == "stdlib_http" || "$category" == "stdlib_websocket" ]]; then
-        if [ ! -f "$PROJECT_ROOT/stdlib/c/lws_wrapper.so" ]; then
+        if [ ! -f "$PROJECT_ROOT/stdlib/c/lws_wrapper.so" ] && [ "$HEMLOCK_REQUIRE_LWS" != "1" ]; then
             # Only print the skip message once per category
             if [ "$category" != "$CURRENT_CATEGORY" ]; then
                 if [ -n "$CURRENT_CATEGORY" ]; then
@@ -140,6 +141,14 @@ for test_file in $TEST_FILES; do
         CURRENT_CATEGORY="$category"
     fi
 
+    if [[ "$category" == "stdlib_http" || "$category" == "stdlib_websocket" ]] &&
+       [ ! -f "$PROJECT_ROOT/stdlib/c/lws_wrapper.so" ]; then
+        echo -e "${RED}✗${NC} $test_name ${RED}(libwebsockets required but not built)${NC}"
+        FAILED_TESTS+=("$test_name|HEMLOCK_REQUIRE_LWS=1 but stdlib/c/lws_wrapper.so is missing|")
+        ((FAIL_COUNT++))
+        continue
+    fi
+
     # Run the test with timeout and capture output, exit code, and timing
     start_time=$(get_time_ms)
     output=$(timeout 60 "$PROJECT_ROOT/hemlock" "$test_file" 2>&1)